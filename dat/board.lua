@@ -8,6 +8,7 @@ local der = require "common.derelict"
 
 local board_lootOne -- forward-declared function, defined at bottom of file
 local loot_mod
+local loot_cache = {} -- loot tables precomputed on disable; keyed by pilot id
 local special_col = {0.7, 0.45, 0.22} -- Dark Gold
 
 local function slotTypeColour( stype )
@@ -202,6 +203,23 @@ local function compute_lootables ( plt )
    return lootables
 end
 
+--[[
+   Precomputes and caches a pilot's loot table. Called from C when the
+   pilot becomes disabled, so board() can open straight from the cache
+   instead of running the loot computation while the player waits.
+--]]
+function board_precompute( plt )
+   if not plt:exists() then return end
+   -- Prune entries of pilots that are gone.
+   for id,c in pairs(loot_cache) do
+      if not c.plt:exists() then
+         loot_cache[id] = nil
+      end
+   end
+   loot_mod = player.pilot():shipstat("loot_mod", true)
+   loot_cache[ plt:id() ] = { plt = plt, loot = compute_lootables( plt ) }
+end
+
 local wgtBoard = {}
 setmetatable( wgtBoard, { __index = luatk.Widget } )
 local wgtBoard_mt = { __index = wgtBoard }
@@ -432,7 +450,16 @@ function board( plt )
    der.sfx.board:play()
    board_plt = plt
    loot_mod = player.pilot():shipstat("loot_mod", true)
-   local lootables = compute_lootables( plt )
+   -- Use the loot table precomputed when the pilot got disabled, if any;
+   -- consume it so a re-board after looting recomputes.
+   local cached = loot_cache[ plt:id() ]
+   loot_cache[ plt:id() ] = nil
+   local lootables
+   if cached then
+      lootables = cached.loot
+   else
+      lootables = compute_lootables( plt )
+   end
 
    local pp = player.pilot()
    if player.shipvarPeek("cannibal2") then
@@ -2,15 +2,16 @@
 
 uniform vec4 color;
 uniform vec2 dimensions;
-uniform int parami;
 
 in vec2 pos;
 out vec4 color_out;
 
 void main(void) {
    float d = sdCircle( pos*dimensions, dimensions.x-1.0 );
-   if (parami==0)
-      d = abs(d);
+   /* The filled variant is compiled separately with CIRCLE_FILLED set. */
+#ifndef CIRCLE_FILLED
+   d = abs(d);
+#endif
    /*
    float alpha = smoothstep(-m, 0.0, -d);
    float beta  = smoothstep(-2.0*m, -m, -d);
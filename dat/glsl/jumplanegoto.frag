@@ -3,7 +3,6 @@
 uniform vec4 color;
 uniform vec2 dimensions;
 uniform float paramf;
-uniform int parami;
 uniform float dt;
 
 in vec2 pos;
@@ -14,7 +13,9 @@ void main(void) {
    float m = 1.0 / dimensions.x;
    float d = sdBox( uv, dimensions-vec2(1.0) );
 
-   if (parami != 0) {
+   /* The animated variant is compiled separately with JUMPLANE_ACTIVE set. */
+#ifdef JUMPLANE_ACTIVE
+   {
       vec2 uvs = uv;
       uvs.y  = abs(uvs.y);
       uvs.x -= dt*dimensions.y*0.8;
@@ -22,6 +23,7 @@ void main(void) {
       float ds = -0.2*abs(uvs.x-0.5*uvs.y) + 2.0/3.0;
       d = max( d, ds );
    }
+#endif
 
    float alpha    = smoothstep(-1.0, 0.0, -d);
    color_out      = color;
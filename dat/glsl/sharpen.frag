@@ -0,0 +1,33 @@
+uniform sampler2D MainTex;
+uniform vec4 love_ScreenSize;
+in vec4 VaryingTexCoord;
+out vec4 color_out;
+
+/* Contrast-adaptive sharpening for the reduced-resolution scene upscale.
+ * Samples the bilinear upscale plus its 4-neighbourhood and pushes the
+ * centre away from the local average, scaled down where local contrast is
+ * already high to avoid ringing on bright edges. */
+
+const float SHARPEN_STRENGTH = 0.35;
+
+void main (void)
+{
+   vec2 uv    = VaryingTexCoord.st;
+   vec2 texel = 1.0 / love_ScreenSize.xy;
+
+   vec3 c  = texture( MainTex, uv ).rgb;
+   vec3 n  = texture( MainTex, uv + vec2( 0.0,  texel.y) ).rgb;
+   vec3 s  = texture( MainTex, uv + vec2( 0.0, -texel.y) ).rgb;
+   vec3 e  = texture( MainTex, uv + vec2( texel.x, 0.0) ).rgb;
+   vec3 w  = texture( MainTex, uv + vec2(-texel.x, 0.0) ).rgb;
+
+   vec3 mn = min( c, min( min(n,s), min(e,w) ) );
+   vec3 mx = max( c, max( max(n,s), max(e,w) ) );
+
+   /* Less sharpening where the neighbourhood already spans a wide range. */
+   vec3 contrast = mx - mn;
+   vec3 amount   = SHARPEN_STRENGTH * (1.0 - clamp( contrast, 0.0, 1.0 ));
+
+   vec3 sharpened = c + amount * (4.0*c - n - s - e - w);
+   color_out = vec4( clamp( sharpened, mn, mx ), 1.0 );
+}
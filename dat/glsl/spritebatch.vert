@@ -0,0 +1,12 @@
+in vec2 vertex;
+in vec2 tex_uv;
+in vec4 vertex_color;
+uniform mat4 projection;
+out vec2 tex_coord;
+out vec4 color;
+
+void main(void) {
+   tex_coord = tex_uv;
+   color = vertex_color;
+   gl_Position = projection * vec4(vertex, 0.0, 1.0);
+}
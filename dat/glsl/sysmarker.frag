@@ -2,7 +2,6 @@
 
 uniform vec4 color;
 uniform vec2 dimensions;
-uniform int parami;
 
 in vec2 pos;
 out vec4 color_out;
@@ -14,8 +13,10 @@ void main(void) {
 
    float d = sdEgg( pos, b-2.0*m );
    vec2 cpos = pos+c;
-   if (parami==1)
-      d = max( -sdSegment( cpos, vec2(0.0), vec2(1.0,0.0) )+0.15, d );
+   /* The slashed variant is compiled separately with SYSMARKER_SLASHED set. */
+#ifdef SYSMARKER_SLASHED
+   d = max( -sdSegment( cpos, vec2(0.0), vec2(1.0,0.0) )+0.15, d );
+#endif
    d = max( -sdCircle( cpos, 0.5 ), d );
    d = min( sdCircle( cpos, 0.2 ), d );
 
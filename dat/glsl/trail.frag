@@ -20,17 +20,13 @@ subroutine uniform trail_func_prototype trail_func;
 
 // For ideas: https://thebookofshaders.com/05/
 
-uniform vec4 c1;  // Start colour
-uniform vec4 c2;  // End colour
-uniform float t1; // Start time [0,1]
-uniform float t2; // End time [0,1]
 uniform float dt; // Current time (in seconds)
-uniform vec2 pos1;// Start position
-uniform vec2 pos2;// End position
 uniform float r;  // Unique value per trail [0,1]
 uniform vec3 nebu_col; // Base colour of the nebula, only changes when entering new system
 
-in vec2 pos;
+in vec4 color;   // Style colour, interpolated along the trail
+in vec2 pos_tex; // x = timer [0,1], y = across-trail coordinate [-1,1]
+in vec2 pos_px;  // Noise-space coordinates
 out vec4 color_out;
 
 /* Has a peak at 1/k */
@@ -231,14 +227,7 @@ vec4 trail_bubbles( vec4 color, vec2 pos_tex, vec2 pos_px )
 }
 
 void main(void) {
-   vec2 pos_tex, pos_px;
-
-   // Interpolate
-   color_out = mix( c1, c2, pos.x );
-   pos_px    = mix( pos1, pos2, pos );
-   pos_px.y *= pos.y;
-   pos_tex.x = mix( t1, t2, pos.x );
-   pos_tex.y = 2. * pos.y - 1.;
+   color_out = color;
 
 #ifdef HAS_GL_ARB_shader_subroutine
    // Use subroutines
@@ -0,0 +1,24 @@
+uniform mat4 projection; // Game-to-screen transformation
+uniform float dt;   // Current trail time (in seconds)
+uniform float ttl;  // Time to live of the trail (in seconds)
+uniform float zoom; // Camera zoom
+
+in vec4 vertex;       // xy = control point (game coords), zw = unit normal
+in vec4 vertex_color; // Style colour at this control point
+in vec4 vertex_data;  // x = emission time, y = thickness, z = arc length, w = side (-1 or 1)
+
+out vec4 color;
+out vec2 pos_tex; // x = timer [0,1], y = across-trail coordinate [-1,1]
+out vec2 pos_px;  // Noise-space coordinates
+
+void main(void) {
+   float thick = vertex_data.y;
+   float side  = vertex_data.w;
+
+   color     = vertex_color;
+   pos_tex.x = clamp( 1.0 - (dt - vertex_data.x) / ttl, 0.0, 1.0 );
+   pos_tex.y = side;
+   pos_px.x  = vertex_data.z * zoom;
+   pos_px.y  = thick * (0.5*side + 0.5);
+   gl_Position = projection * vec4( vertex.xy + vertex.zw * thick * side, 0.0, 1.0 );
+}
@@ -0,0 +1,35 @@
+#include "lib/sdf.glsl"
+
+/* Window chrome in a single draw: background fill, thick dark border and
+ * light inner outline, which toolkit.c used to issue as three separate
+ * primitive batches per window. The quad is the window rect expanded by
+ * 2 px so the border's outer pixel isn't clipped; geometry matches the
+ * old toolkit_drawRect + toolkit_drawOutlineThick( b=1, thick=2 ) +
+ * toolkit_drawOutline( x+3, y+2, w-5, h-5 ) calls. */
+
+uniform vec4 color;        /* Background fill (toolkit_col). */
+uniform vec4 colour_dark;  /* Thick border (toolkit_colDark). */
+uniform vec4 colour_light; /* Inner outline (toolkit_colLight). */
+uniform vec2 dimensions;   /* Half extents of the quad in px. */
+
+in vec2 pos;
+out vec4 color_out;
+
+void main(void) {
+   vec2 uv = pos * dimensions;
+   vec2 hw = dimensions - vec2(2.0); /* Window rect half extents. */
+
+   /* Background. */
+   float d_bg = sdBox( uv, hw );
+   vec4 col   = color * smoothstep( 0.5, -0.5, d_bg );
+
+   /* Thick dark border hugging the edge, 1 px to each side. */
+   float d_brd = abs( d_bg ) - 1.0;
+   col = mix( col, colour_dark, colour_dark.a * smoothstep( 0.5, -0.5, d_brd ) );
+
+   /* 1 px light outline inset asymmetrically like the old draw. */
+   float d_in = abs( sdBox( uv - vec2(0.5,-0.5), hw - vec2(1.5) ) ) - 0.5;
+   col = mix( col, colour_light, colour_light.a * smoothstep( 0.5, -0.5, d_in ) );
+
+   color_out = col;
+}
@@ -92,30 +92,34 @@ local goodness_special = {
 --]]
 local special_ships = {}
 special_ships["Drone"] = function( p )
-   for k,o in ipairs{
-      "Milspec Orion 2301 Core System",
-      "Nexus Dart 150 Engine",
-      "Nexus Light Stealth Plating",
-      "Neutron Disruptor",
-      "Neutron Disruptor",
-      "Neutron Disruptor",
-   } do
-      p:outfitAdd( o, 1, true )
-   end
+   p:outfitBatch( function ()
+      for k,o in ipairs{
+         "Milspec Orion 2301 Core System",
+         "Nexus Dart 150 Engine",
+         "Nexus Light Stealth Plating",
+         "Neutron Disruptor",
+         "Neutron Disruptor",
+         "Neutron Disruptor",
+      } do
+         p:outfitAdd( o, 1, true )
+      end
+   end )
 end
 special_ships["Drone (Hyena)"] = special_ships["Drone"]
 special_ships["Heavy Drone"] = function( p )
-   for k,o in ipairs{
-      "Milspec Thalos 3602 Core System",
-      "Unicorp Hawk 350 Engine",
-      choose_one{"Nexus Light Stealth Plating", "S&K Light Combat Plating"},
-      "Shatterer Launcher",
-      "Shatterer Launcher",
-      "Heavy Neutron Disruptor",
-      "Heavy Neutron Disruptor",
-   } do
-      p:outfitAdd( o, 1, true )
-   end
+   p:outfitBatch( function ()
+      for k,o in ipairs{
+         "Milspec Thalos 3602 Core System",
+         "Unicorp Hawk 350 Engine",
+         choose_one{"Nexus Light Stealth Plating", "S&K Light Combat Plating"},
+         "Shatterer Launcher",
+         "Shatterer Launcher",
+         "Heavy Neutron Disruptor",
+         "Heavy Neutron Disruptor",
+      } do
+         p:outfitAdd( o, 1, true )
+      end
+   end )
 end
 
 
@@ -256,13 +260,15 @@ function optimize.optimize( p, cores, outfit_list, params )
       -- Don't actually have to remove cores as it should overwrite default
       -- cores as necessary
       --p:outfitRm( "cores" )
-      -- Put cores
-      for k,v in ipairs( cores ) do
-         local q = p:outfitAdd( v, 1, true )
-         if q < 1 then
-            warn(string.format(_("Unable to equip core '%s' on '%s'!"), v, p:name()))
+      -- Put cores; batched so stats recompute once at the end
+      p:outfitBatch( function ()
+         for k,v in ipairs( cores ) do
+            local q = p:outfitAdd( v, 1, true )
+            if q < 1 then
+               warn(string.format(_("Unable to equip core '%s' on '%s'!"), v, p:name()))
+            end
          end
-      end
+      end )
    end
 
    -- Global ship stuff
@@ -653,19 +659,21 @@ function optimize.optimize( p, cores, outfit_list, params )
          return false
       end
 
-      -- Interpret results
-      c = 1
-      for i,s in ipairs(slots) do
-         for j,o in ipairs(s.outfits) do
-            if x[c] == 1 then
-               local q = p:outfitAdd( o, 1, true )
-               if q < 1 then
-                  warn(string.format(_("Unable to equip outfit '%s' on '%s'!"), o,  p:name()))
+      -- Interpret results; batched so a full loadout recomputes stats once
+      p:outfitBatch( function ()
+         c = 1
+         for i,s in ipairs(slots) do
+            for j,o in ipairs(s.outfits) do
+               if x[c] == 1 then
+                  local q = p:outfitAdd( o, 1, true )
+                  if q < 1 then
+                     warn(string.format(_("Unable to equip outfit '%s' on '%s'!"), o,  p:name()))
+                  end
                end
+               c = c + 1
             end
-            c = c + 1
          end
-      end
+      end )
 
       -- Due to the approximation, sometimes they end up with not enough
       -- energy, we'll try again with larger energy constraints
@@ -221,16 +221,10 @@ String interpolation, inspired by <a href="https://github.com/hishamhm/f-strings
    @tparam table tab Argument table.
 --]]
 function format.f( str, tab )
-   return (str:gsub("%b{}", function(block)
-      local key, fmt = block:match("{(.*):(.*)}")
-      key = key or block:match("{(.*)}")
-      key = tonumber(key) or key  -- Support {1} for printing the first member of the table, etc.
-      local val = tab[key]
-      if val==nil then
-         warn(string.format(_("fmt.f: string '%s' has '%s'==nil!"), str, key))
-      end
-      return fmt and string.format('%'..fmt, val) or tostring(val)
-   end))
+   -- Single-pass expansion in C; see nlua_interp. The old gsub("%b{}", ...)
+   -- re-scanned the string and entered a Lua closure per placeholder, which
+   -- added up in dialogue-heavy missions.
+   return string.interp( str, tab )
 end
 
 return format
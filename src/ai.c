@@ -457,21 +457,23 @@ int ai_pinit( Pilot *p, const char *ai )
    }
    p->ai = prof;
 
-   /* Adds a new pilot memory in the memory table. */
-   lua_newtable(naevL);              /* m  */
-
-   /* Copy defaults over from the global memory table. */
-   lua_rawgeti( naevL, LUA_REGISTRYINDEX, prof->lua_mem ); /* m, d */
-   lua_pushnil(naevL);               /* m, d, nil */
-   while (lua_next(naevL,-2) != 0) { /* m, d, k, v */
-      lua_pushvalue(naevL,-2);       /* m, d, k, v, k */
-      lua_pushvalue(naevL,-2);       /* m, d, k, v, k, v */
-      lua_remove(naevL, -3);         /* m, d, k, k, v */
-      lua_settable(naevL,-5);        /* m, d, k */
-   }                                 /* m, d */
-   lua_pop(naevL,1);                 /* m */
+   /* Adds a new pilot memory in the memory table.  Instead of copying the
+    * profile defaults into each pilot's table, the table falls back to the
+    * profile's template through __index: reads of untouched keys share the
+    * template and writes land in the per-pilot table.  Note that nested
+    * tables were already shared by reference under the old shallow copy. */
+   lua_newtable(naevL);              /* m */
+   lua_newtable(naevL);              /* m, mt */
+   lua_rawgeti( naevL, LUA_REGISTRYINDEX, prof->lua_mem ); /* m, mt, d */
+   lua_setfield( naevL, -2, "__index" ); /* m, mt */
+   lua_setmetatable( naevL, -2 );    /* m */
    p->lua_mem = luaL_ref( naevL, LUA_REGISTRYINDEX ); /* */
 
+   /* Bulk spawns run the expensive equip/create Lua a few pilots per
+    * frame instead; see pilots_update(). */
+   if (pilot_isFlag(p, PILOT_AI_DEFER))
+      return 0;
+
    /* Create the pilot. */
    ai_create( p );
    pilot_setFlag(p, PILOT_CREATED_AI);
@@ -479,6 +481,17 @@ int ai_pinit( Pilot *p, const char *ai )
    return 0;
 }
 
+/**
+ * @brief Finishes a deferred pilot initialization by running the create Lua.
+ *
+ *    @param p Pilot whose initialization was deferred at ai_pinit() time.
+ */
+void ai_pinitFinish( Pilot *p )
+{
+   ai_create( p );
+   pilot_setFlag(p, PILOT_CREATED_AI);
+}
+
 /**
  * @brief Clears the pilot's tasks.
  *
@@ -570,6 +583,67 @@ int ai_load (void)
    return ai_loadEquip();
 }
 
+/**
+ * @brief Reloads the AI profile scripts in place (devmode hot-reload).
+ *
+ * Each profile's file is re-run inside its existing environment, so the
+ *  function definitions get swapped while the environment state carries
+ *  over: the "mem" template is re-seeded with the script's defaults and
+ *  every pilot keeps its own memory table. Tasks already on a pilot's
+ *  stack keep referencing the old function objects until they get
+ *  pushed again.
+ *
+ *    @return 0 on success.
+ */
+int ai_reload (void)
+{
+   int ret = 0;
+
+   for (int i=0; i<array_size(profiles); i++) {
+      AI_Profile *prof = &profiles[i];
+      char path[PATH_MAX], *buf;
+      size_t bufsize;
+
+      snprintf( path, sizeof(path), AI_PATH"%s"AI_SUFFIX, prof->name );
+      buf = ndata_read( path, &bufsize );
+      if (buf == NULL) {
+         WARN( _("Error reloading AI file: %s"), path );
+         ret = -1;
+         continue;
+      }
+
+      /* Point "mem" back at the template so top-level defaults go there
+       * and not into whatever pilot memory the var last pointed at. */
+      lua_rawgeti( naevL, LUA_REGISTRYINDEX, prof->lua_mem ); /* m */
+      nlua_setenv( naevL, prof->env, "mem" ); /* */
+
+      if (nlua_dobufenv( prof->env, buf, bufsize, path ) != 0) {
+         WARN( _("Error reloading AI file: %s\n"
+             "%s\n"
+             "Most likely Lua file has improper syntax, please check"),
+               path, lua_tostring(naevL,-1));
+         free(buf);
+         ret = -1;
+         continue;
+      }
+      free(buf);
+
+      /* Swap the cached function references. */
+      luaL_unref( naevL, LUA_REGISTRYINDEX, prof->ref_control );
+      luaL_unref( naevL, LUA_REGISTRYINDEX, prof->ref_control_manual );
+      luaL_unref( naevL, LUA_REGISTRYINDEX, prof->ref_refuel );
+      prof->ref_control = nlua_refenvtype( prof->env, "control", LUA_TFUNCTION );
+      prof->ref_control_manual = nlua_refenvtype( prof->env, "control_manual", LUA_TFUNCTION );
+      prof->ref_refuel = nlua_refenvtype( prof->env, "refuel", LUA_TFUNCTION );
+   }
+
+   /* The equipment script keeps no state; recreate it outright. */
+   if (ai_loadEquip() != 0)
+      ret = -1;
+
+   return ret;
+}
+
 /**
  * @brief Loads the equipment selector script.
  */
@@ -56,12 +56,14 @@ AI_Profile* ai_getProfile( const char *name );
  * init/exit
  */
 int ai_load (void);
+int ai_reload (void);
 void ai_exit (void);
 
 /*
  * Init, destruction.
  */
 int ai_pinit( Pilot *p, const char *ai );
+void ai_pinitFinish( Pilot *p );
 void ai_destroy( Pilot* p );
 
 /*
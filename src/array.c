@@ -10,10 +10,60 @@
 
 #include "array.h"
 
+#include "log.h"
 #include "nstring.h"
 
-void *_array_create_helper(size_t e_size, size_t capacity)
+#if DEBUGGING
+static size_t _array_reallocs = 0;    /**< Growth reallocations performed. */
+static size_t _array_bytes_moved = 0; /**< Payload bytes those reallocations may have copied. */
+
+/**
+ * @brief Live allocation accounting for one creating callsite.
+ */
+typedef struct ArrayTag_ {
+   const char *tag; /**< Creating file, from __FILE__. */
+   size_t live;     /**< Bytes currently allocated from there. */
+   size_t mark;     /**< Live bytes at the last array_tagMark(). */
+} ArrayTag;
+/* Plain malloc table: the tracker can not use the arrays it tracks. */
+static ArrayTag *_array_tags = NULL; /**< Known callsites. */
+static int _array_tags_n     = 0;    /**< Number of known callsites. */
+
+/**
+ * @brief Adds bytes to a callsite's live total, registering it if new.
+ */
+static void _array_tagAdd( const char *tag, ptrdiff_t bytes )
+{
+   ArrayTag *t = NULL;
+   for (int i=0; i<_array_tags_n; i++) {
+      /* Tags are __FILE__ literals so identical ones usually share a pointer. */
+      if ((_array_tags[i].tag == tag) || (strcmp(_array_tags[i].tag, tag)==0)) {
+         t = &_array_tags[i];
+         break;
+      }
+   }
+   if (t == NULL) {
+      _array_tags = realloc( _array_tags, (_array_tags_n+1) * sizeof(ArrayTag) );
+      t = &_array_tags[ _array_tags_n++ ];
+      t->tag  = tag;
+      t->live = 0;
+      t->mark = 0;
+   }
+   t->live += bytes;
+}
+
+/**
+ * @brief Total allocation of a container, including the header.
+ */
+static size_t _array_tagBytes( const _private_container *c )
+{
+   return sizeof(_private_container) + c->_esize * c->_reserved;
+}
+#endif /* DEBUGGING */
+
+void *_array_create_helper(size_t e_size, size_t capacity, const char *tag)
 {
+   (void) tag;
    if ( capacity <= 0 )
       capacity = 1;
 
@@ -21,8 +71,15 @@ void *_array_create_helper(size_t e_size, size_t capacity)
 #if DEBUG_ARRAYS
    c->_sentinel = ARRAY_SENTINEL;
 #endif
+#if DEBUGGING
+   c->_tag   = tag;
+   c->_esize = e_size;
+#endif /* DEBUGGING */
    c->_reserved = capacity;
    c->_size = 0;
+#if DEBUGGING
+   _array_tagAdd( tag, _array_tagBytes(c) );
+#endif /* DEBUGGING */
    return c->_array;
 }
 
@@ -32,11 +89,20 @@ static void _array_resize_container(_private_container **c_, size_t e_size, size
    _private_container *c = *c_;
 
    if (new_size > c->_reserved) {
-      /* increases the reserved space */
+#if DEBUGGING
+      size_t old_reserved = c->_reserved;
+#endif /* DEBUGGING */
+      /* increases the reserved space; small arrays jump straight to 4
+       * elements as the first doublings are pure realloc churn */
       do
-         c->_reserved *= 2;
+         c->_reserved = (c->_reserved < 4) ? 4 : c->_reserved * 2;
       while (new_size > c->_reserved);
 
+#if DEBUGGING
+      _array_reallocs++;
+      _array_bytes_moved += e_size * c->_size;
+      _array_tagAdd( c->_tag, e_size * (c->_reserved - old_reserved) );
+#endif /* DEBUGGING */
       c = realloc(c, sizeof(_private_container) + e_size * c->_reserved);
    }
 
@@ -55,8 +121,18 @@ void *_array_grow_helper(void **a, size_t e_size)
 {
    _private_container *c = _array_private_container(*a);
    if (c->_size == c->_reserved) {
-      /* Array full, doubles the reserved memory */
-      c->_reserved *= 2;
+#if DEBUGGING
+      size_t old_reserved = c->_reserved;
+#endif /* DEBUGGING */
+      /* Array full, doubles the reserved memory; small arrays jump
+       * straight to 4 elements as the first doublings are pure realloc
+       * churn */
+      c->_reserved = (c->_reserved < 4) ? 4 : c->_reserved * 2;
+#if DEBUGGING
+      _array_reallocs++;
+      _array_bytes_moved += e_size * c->_size;
+      _array_tagAdd( c->_tag, e_size * (c->_reserved - old_reserved) );
+#endif /* DEBUGGING */
       c = realloc(c, sizeof(_private_container) + e_size * c->_reserved);
       *a = c->_array;
    }
@@ -83,6 +159,9 @@ void _array_erase_helper(void **a, size_t e_size, void *first, void *last)
 void _array_shrink_helper(void **a, size_t e_size)
 {
    _private_container *c = _array_private_container(*a);
+#if DEBUGGING
+   size_t old_reserved = c->_reserved;
+#endif /* DEBUGGING */
    if (c->_size != 0) {
       c = realloc(c, sizeof(_private_container) + e_size * c->_size);
       c->_reserved = c->_size;
@@ -90,20 +169,96 @@ void _array_shrink_helper(void **a, size_t e_size)
       c = realloc(c, sizeof(_private_container) + e_size);
       c->_reserved = 1;
    }
+#if DEBUGGING
+   _array_tagAdd( c->_tag, -(ptrdiff_t)(e_size * (old_reserved - c->_reserved)) );
+#endif /* DEBUGGING */
    *a = c->_array;
 }
 
+/**
+ * @brief Reports the array growth statistics gathered so far.
+ */
+void array_reportStats (void)
+{
+#if DEBUGGING
+   DEBUG( _("array: %zu growth reallocs, %zu bytes moved"),
+         _array_reallocs, _array_bytes_moved );
+#endif /* DEBUGGING */
+}
+
+/**
+ * @brief Number of callsites the allocation tracker has seen.
+ */
+int array_tagCount (void)
+{
+#if DEBUGGING
+   return _array_tags_n;
+#else /* DEBUGGING */
+   return 0;
+#endif /* DEBUGGING */
+}
+
+/**
+ * @brief Reads one callsite's accounting.
+ *
+ *    @param idx Callsite index, below array_tagCount().
+ *    @param[out] tag Creating file.
+ *    @param[out] live Bytes currently allocated from there.
+ *    @param[out] growth Change in live bytes since the last array_tagMark().
+ *    @return 0 on success.
+ */
+int array_tagStats( int idx, const char **tag, size_t *live, ptrdiff_t *growth )
+{
+#if DEBUGGING
+   const ArrayTag *t;
+   if ((idx < 0) || (idx >= _array_tags_n))
+      return -1;
+   t = &_array_tags[idx];
+   *tag    = t->tag;
+   *live   = t->live;
+   *growth = (ptrdiff_t)t->live - (ptrdiff_t)t->mark;
+   return 0;
+#else /* DEBUGGING */
+   (void) idx;
+   (void) tag;
+   (void) live;
+   (void) growth;
+   return -1;
+#endif /* DEBUGGING */
+}
+
+/**
+ * @brief Marks the current live totals as the baseline for growth reporting.
+ */
+void array_tagMark (void)
+{
+#if DEBUGGING
+   for (int i=0; i<_array_tags_n; i++)
+      _array_tags[i].mark = _array_tags[i].live;
+#endif /* DEBUGGING */
+}
+
 void _array_free_helper(void *a)
 {
    if (a==NULL)
       return;
+#if DEBUGGING
+   {
+      _private_container *c = _array_private_container(a);
+      _array_tagAdd( c->_tag, -(ptrdiff_t)_array_tagBytes(c) );
+   }
+#endif /* DEBUGGING */
    free(_array_private_container(a));
 }
 
 void *_array_copy_helper(size_t e_size, void *a)
 {
    _private_container *c = _array_private_container(a);
-   void *copy = _array_create_helper( e_size, c->_size );
+#if DEBUGGING
+   void *copy = _array_create_helper( e_size, c->_size, c->_tag );
+#else /* DEBUGGING */
+   void *copy = _array_create_helper( e_size, c->_size, NULL );
+#endif /* DEBUGGING */
    _array_resize_helper( &copy, e_size, c->_size );
    return memcpy( copy, a, e_size * c->_size );
 }
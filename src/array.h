@@ -53,12 +53,16 @@ typedef struct {
 #if DEBUG_ARRAYS
    int _sentinel;         /**< Sentinel for when debugging. */
 #endif /* DEBUG_ARRAYS */
+#if DEBUGGING
+   const char *_tag;      /**< Callsite file that created the array. */
+   size_t _esize;         /**< Element size, for accounting on free. */
+#endif /* DEBUGGING */
    size_t _reserved;      /**< Number of elements reserved */
    size_t _size;          /**< Number of elements in the array */
    char alignas(max_align_t) _array[0];  /**< Begin of the array */
 } _private_container;
 
-void *_array_create_helper(size_t e_size, size_t initial_size);
+void *_array_create_helper(size_t e_size, size_t initial_size, const char *tag);
 void *_array_grow_helper(void **a, size_t e_size);
 void _array_resize_helper(void **a, size_t e_size, size_t new_size);
 void _array_erase_helper(void **a, size_t e_size, void *first, void *last);
@@ -66,6 +70,18 @@ void _array_shrink_helper(void **a, size_t e_size);
 void _array_free_helper(void *a);
 void *_array_copy_helper(size_t e_size, void *a);
 
+/* Logs total growth reallocs and bytes moved; no-op unless DEBUGGING. */
+void array_reportStats (void);
+
+/*
+ * Live allocation accounting by creating callsite; returns nothing unless
+ * DEBUGGING. Counters are not synchronized, so numbers read while loader
+ * threads run are indicative only.
+ */
+int array_tagCount (void);
+int array_tagStats( int idx, const char **tag, size_t *live, ptrdiff_t *growth );
+void array_tagMark (void);
+
 /**
  * @brief Gets the container of an array.
  *
@@ -85,13 +101,32 @@ static inline _private_container *_array_private_container(void *a)
    return c;
 }
 
+/**
+ * @brief Grows the array by one element, staying inline when capacity allows.
+ *
+ * The common push fits in the reserved space and compiles down to a size
+ * bump in release builds; only an actual reallocation calls out of line.
+ * Opt-in DEBUG_ARRAYS builds keep the sentinel check on every push.
+ *
+ *    @param a Pointer to the array being grown.
+ *    @param e_size Element size.
+ *    @return Pointer to the new (uninitialized) last element.
+ */
+ALWAYS_INLINE static inline void *_array_grow_inline(void **a, size_t e_size)
+{
+   _private_container *c = _array_private_container(*a);
+   if (c->_size < c->_reserved)
+      return c->_array + (c->_size++) * e_size;
+   return _array_grow_helper(a, e_size);
+}
+
 /**
  * @brief Creates a new dynamic array of `basic_type'
  *
  *    @param basic_type Type of the array to create.
  */
 #define array_create(basic_type) \
-      ((basic_type *)(_array_create_helper(sizeof(basic_type), 1)))
+      ((basic_type *)(_array_create_helper(sizeof(basic_type), 1, __FILE__)))
 
 /**
  * @brief Creates a new dynamic array of `basic_type' with an initial capacity
@@ -100,7 +135,7 @@ static inline _private_container *_array_private_container(void *a)
  *    @param capacity Initial size.
  */
 #define array_create_size(basic_type, capacity) \
-      ((basic_type *)(_array_create_helper(sizeof(basic_type), capacity)))
+      ((basic_type *)(_array_create_helper(sizeof(basic_type), capacity, __FILE__)))
 /**
  * @brief Resizes the array to accomodate new_size elements.
  *
@@ -117,7 +152,7 @@ static inline _private_container *_array_private_container(void *a)
  * @note Invalidates all iterators.
  */
 #define array_grow(ptr_array) \
-      (*(__typeof__((ptr_array)[0]))_array_grow_helper((void **)(ptr_array), sizeof((ptr_array)[0][0])))
+      (*(__typeof__((ptr_array)[0]))_array_grow_inline((void **)(ptr_array), sizeof((ptr_array)[0][0])))
 /**
  * @brief Adds a new element at the end of the array.
  *
@@ -22,6 +22,8 @@
 #include "opengl.h"
 #include "toolkit.h"
 #include "ndata.h"
+#include "pilot.h"
+#include "pilot_grid.h"
 #include "player.h"
 #include "nlua_asteroid.h"
 
@@ -39,11 +41,46 @@ typedef struct Debris_ {
 
 const double DEBRIS_BUFFER = 1000.; /**< Buffer to smooth appearance of debris */
 
+/*
+ * Debris is purely visual, so it carries no per-frame state: the screen
+ * position is derived at render time from the seed position, velocity,
+ * elapsed time and how far the camera has moved, wrapped around the
+ * buffered screen box. Only the field fade (alpha) is stateful, and it
+ * refreshes at a coarse cadence instead of every frame.
+ */
+#define DEBRIS_ALPHA_INTERVAL 0.1 /**< Seconds between debris fade refreshes. */
+static double debris_time = 0.; /**< Game time since system entry. */
+static double debris_alphaDt = 0.; /**< Time since the last fade refresh. */
+static vec2 debris_camOrigin; /**< Camera position at system entry. */
+
+#define ASTEROID_LOD_DIST 3e3 /**< Distance past the field margin at which per-asteroid simulation is suspended. */
+
+#define ASTEROID_ARMED_TIME 3. /**< Seconds a field stays in the weapon collision layer after a probe. */
+
 static const double SCAN_FADE = 10.; /**< 1/time it takes to fade in/out scanning text. */
 
 static Debris *debris_stack = NULL; /**< All the debris in the current system (array.h). */
 static glTexture **debris_gfx = NULL; /**< Graphics to use for debris. */
 
+/*
+ * Conservative field-lookup grid. asteroids_inField() gets asked per
+ * pilot (ewarfare), per debris particle (fade) and per spawn attempt,
+ * and each query walked every field and exclusion zone. The system's
+ * fields are static, so at entry each cell of a coarse grid over their
+ * bounding box is classified as definitely outside, definitely inside a
+ * given field, or on a boundary; only boundary cells still pay for the
+ * exact test.
+ */
+#define ASTGRID_DIM        128   /**< Maximum cells per axis. */
+#define ASTGRID_MIN_CELL   256.  /**< Minimum cell size in game units. */
+#define ASTGRID_MIXED      -2    /**< Cell straddles a boundary; do the exact test. */
+static int8_t *ast_grid = NULL;  /**< Cell classification: field index, -1 or ASTGRID_MIXED. */
+static double ast_grid_x0 = 0.;  /**< Grid origin. */
+static double ast_grid_y0 = 0.;  /**< Grid origin. */
+static double ast_grid_cell = 0.;/**< Cell size. */
+static int ast_grid_w = 0;       /**< Cells along X. */
+static int ast_grid_h = 0;       /**< Cells along Y. */
+
 /*
  * Useful data for asteroids.
  */
@@ -63,6 +100,9 @@ static void asteroid_renderSingle( const Asteroid *a );
 static void debris_renderSingle( const Debris *d, double cx, double cy );
 static void debris_init( Debris *deb );
 static int asteroid_init( Asteroid *ast, const AsteroidAnchor *field );
+static int asteroids_fieldActive( const AsteroidAnchor *ast );
+static void asteroids_fieldWake( AsteroidAnchor *ast );
+static void asteroids_gridBuild (void);
 
 
 /**
@@ -77,6 +117,19 @@ void asteroids_update( double dt )
       int has_exclusion = 0;
       AsteroidAnchor *ast = &cur_system->asteroids[i];
 
+      /* Fields far from both the camera and all pilots only update
+       * statistically: the elapsed time accumulates and the respawn
+       * timers get caught up in bulk when something approaches. */
+      if (!asteroids_fieldActive( ast )) {
+         ast->active = 0;
+         ast->armed  = 0.;
+         ast->dormant_dt += dt;
+         continue;
+      }
+      ast->armed = MAX( 0., ast->armed - dt );
+      if (!ast->active)
+         asteroids_fieldWake( ast );
+
       for (int k=0; k<array_size(cur_system->astexclude); k++) {
          AsteroidExclusion *exc = &cur_system->astexclude[k];
          if (vec2_dist2( &ast->pos, &exc->pos ) < pow2(ast->radius+exc->radius)) {
@@ -192,40 +245,80 @@ void asteroids_update( double dt )
       }
    }
 
-   /* Only have to update stuff if not simulating. */
+   /* Rebuild the weapon collision layer over the armed fields. */
+   astgrid_rebuild();
+
+   /* Debris positions are stateless; just advance the clocks. */
    if (!space_isSimulation()) {
-      double dx, dy;
-      cam_getDPos( &dx, &dy );
-
-      for (int j=0; j<array_size(debris_stack); j++) {
-         Debris *d = &debris_stack[j];
-         int infield;
-         vec2 v;
-
-         d->pos.x += d->vel.x * dt - dx;
-         d->pos.y += d->vel.y * dt - dy;
-
-         /* Check boundaries */
-         if (d->pos.x > SCREEN_W + DEBRIS_BUFFER)
-            d->pos.x -= SCREEN_W + 2.*DEBRIS_BUFFER;
-         else if (d->pos.y > SCREEN_H + DEBRIS_BUFFER)
-            d->pos.y -= SCREEN_H + 2.*DEBRIS_BUFFER;
-         else if (d->pos.x < -DEBRIS_BUFFER)
-            d->pos.x += SCREEN_W + 2.*DEBRIS_BUFFER;
-         else if (d->pos.y < -DEBRIS_BUFFER)
-            d->pos.y += SCREEN_H + 2.*DEBRIS_BUFFER;
-
-         /* Set alpha based on position. */
-         /* TODO there seems to be some offset mistake or something going on
-            * here, not too big of an issue though. */
-         gl_screenToGameCoords( &v.x, &v.y, d->pos.x, d->pos.y );
-         infield = asteroids_inField( &v );
-         if (infield>=0)
-            d->alpha = MIN( 1.0, d->alpha + 0.5 * dt );
-         else
-            d->alpha = MAX( 0.0, d->alpha - 0.5 * dt );
-      }
+      debris_time    += dt;
+      debris_alphaDt += dt;
+   }
+}
+
+/**
+ * @brief Arms a field: keeps it in the weapon collision layer for a while.
+ *
+ * Called by the weapon collision pass for fields a weapon got close to.
+ *  Arming a field that was disarmed inserts its asteroids right away so
+ *  the arming shot can still hit this frame.
+ *
+ *    @param ast Field to arm.
+ */
+void asteroids_arm( AsteroidAnchor *ast )
+{
+   int was_armed = (ast->armed > 0.);
+   ast->armed = ASTEROID_ARMED_TIME;
+   if (!was_armed)
+      astgrid_insertAnchor( ast );
+}
+
+/**
+ * @brief Derives the wrapped screen position of a debris at the current time.
+ */
+static void debris_screenPos( const Debris *d, double *x, double *y )
+{
+   const double bw = SCREEN_W + 2.*DEBRIS_BUFFER;
+   const double bh = SCREEN_H + 2.*DEBRIS_BUFFER;
+   double cx, cy;
+
+   cam_getPos( &cx, &cy );
+   *x = fmod( d->pos.x + d->vel.x*debris_time - (cx-debris_camOrigin.x)
+         + DEBRIS_BUFFER, bw );
+   if (*x < 0.)
+      *x += bw;
+   *x -= DEBRIS_BUFFER;
+   *y = fmod( d->pos.y + d->vel.y*debris_time - (cy-debris_camOrigin.y)
+         + DEBRIS_BUFFER, bh );
+   if (*y < 0.)
+      *y += bh;
+   *y -= DEBRIS_BUFFER;
+}
+
+/**
+ * @brief Fades debris in and out of asteroid fields at a coarse cadence.
+ */
+static void debris_updateAlpha (void)
+{
+   if (debris_alphaDt < DEBRIS_ALPHA_INTERVAL)
+      return;
+
+   for (int j=0; j<array_size(debris_stack); j++) {
+      Debris *d = &debris_stack[j];
+      double x, y;
+      int infield;
+      vec2 v;
+
+      debris_screenPos( d, &x, &y );
+      /* TODO there seems to be some offset mistake or something going on
+         * here, not too big of an issue though. */
+      gl_screenToGameCoords( &v.x, &v.y, x, y );
+      infield = asteroids_inField( &v );
+      if (infield>=0)
+         d->alpha = MIN( 1.0, d->alpha + 0.5 * debris_alphaDt );
+      else
+         d->alpha = MAX( 0.0, d->alpha - 0.5 * debris_alphaDt );
    }
+   debris_alphaDt = 0.;
 }
 
 /**
@@ -237,6 +330,9 @@ void asteroids_init (void)
    int ndebris;
    asteroid_creating = 1;
 
+   /* The placement loop below leans on asteroids_inField(). */
+   asteroids_gridBuild();
+
    if (debris_gfx==NULL)
       debris_gfx = array_create( glTexture* );
    array_erase( &debris_gfx, array_begin(debris_gfx), array_end(debris_gfx) );
@@ -244,7 +340,10 @@ void asteroids_init (void)
    /* Set up asteroids. */
    for (int i=0; i<array_size(cur_system->asteroids); i++) {
       AsteroidAnchor *ast = &cur_system->asteroids[i];
-      ast->id = i;
+      ast->id         = i;
+      ast->active     = 1;
+      ast->dormant_dt = 0.;
+      ast->armed      = 0.;
 
       /* Add graphics to debris. */
       for (int j=0; j<array_size(ast->groups); j++) {
@@ -291,6 +390,11 @@ void asteroids_init (void)
    for (int j=0; j<array_size(debris_stack); j++)
       debris_init( &debris_stack[j] );
 
+   /* Restart the stateless-position clocks for the new system. */
+   debris_time    = 0.;
+   debris_alphaDt = 0.;
+   cam_getPos( &debris_camOrigin.x, &debris_camOrigin.y );
+
    asteroid_creating = 0;
 }
 
@@ -367,6 +471,67 @@ static int asteroid_init( Asteroid *ast, const AsteroidAnchor *field )
    return 0;
 }
 
+/**
+ * @brief Checks whether a field is near enough to simulate per-asteroid.
+ *
+ *    @param ast Field to check.
+ *    @return 1 if the camera or any pilot is near the field, 0 otherwise.
+ */
+static int asteroids_fieldActive( const AsteroidAnchor *ast )
+{
+   vec2 cam;
+   Pilot *const* pilot_stack;
+   double r2 = pow2( ast->radius + ast->margin + ASTEROID_LOD_DIST );
+
+   cam_getPos( &cam.x, &cam.y );
+   if (vec2_dist2( &cam, &ast->pos ) < r2)
+      return 1;
+
+   pilot_stack = pilot_getAll();
+   for (int i=0; i<array_size(pilot_stack); i++)
+      if (vec2_dist2( &pilot_stack[i]->solid->pos, &ast->pos ) < r2)
+         return 1;
+
+   return 0;
+}
+
+/**
+ * @brief Wakes up a dormant field, catching up the respawn timers in bulk.
+ *
+ * Asteroids whose timer would have expired while the field was dormant get
+ *  redrawn lazily from the field distribution, like asteroids_init does; the
+ *  others just have their timers advanced.
+ *
+ *    @param ast Field to wake up.
+ */
+static void asteroids_fieldWake( AsteroidAnchor *ast )
+{
+   for (int j=0; j<ast->nb; j++) {
+      Asteroid *a = &ast->asteroids[j];
+      double r;
+
+      if (a->timer >= ast->dormant_dt) {
+         a->timer -= ast->dormant_dt;
+         continue;
+      }
+
+      r = RNGF();
+      if (asteroid_init( a, ast ))
+         continue;
+      if (r > 0.6)
+         a->state = ASTEROID_FG;
+      else if (r > 0.8)
+         a->state = ASTEROID_XB;
+      else if (r > 0.9)
+         a->state = ASTEROID_BX;
+      else
+         a->state = ASTEROID_XX;
+      a->timer = a->timer_max = 30.*RNGF();
+   }
+   ast->active     = 1;
+   ast->dormant_dt = 0.;
+}
+
 /**
  * @brief Initializes a debris.
  *    @param deb Debris to initialize.
@@ -705,12 +870,15 @@ void asteroids_renderOverlay (void)
    cx -= SCREEN_W/2.;
    cy -= SCREEN_H/2.;
 
+   debris_updateAlpha();
+
    /* Render the debris. */
    for (int j=0; j<array_size(debris_stack); j++) {
       Debris *d = &debris_stack[j];
       if (d->height > 1.)
          debris_renderSingle( d, cx, cy );
    }
+   gl_renderSpriteBatchFlush();
 }
 
 /**
@@ -723,6 +891,8 @@ void asteroids_render (void)
    cx -= SCREEN_W/2.;
    cy -= SCREEN_H/2.;
 
+   debris_updateAlpha();
+
    /* Render the asteroids & debris. */
    for (int i=0; i<array_size(cur_system->asteroids); i++) {
       AsteroidAnchor *ast = &cur_system->asteroids[i];
@@ -736,6 +906,7 @@ void asteroids_render (void)
       if (d->height <= 1.)
          debris_renderSingle( d, cx, cy );
    }
+   gl_renderSpriteBatchFlush();
 
    /* Render gatherable stuff. */
    gatherable_render();
@@ -785,11 +956,14 @@ static void asteroid_renderSingle( const Asteroid *a )
    }
 
    at = a->type;
-   gl_renderSpriteRotate( a->gfx, a->pos.x, a->pos.y, a->ang, 0, 0, &col );
+   gl_renderSpriteBatchScaleRotate( a->gfx, a->pos.x, a->pos.y, 1., 1.,
+         a->ang, 0, 0, &col );
 
    /* Add the commodities if scanned. */
    if (!a->scanned)
       return;
+   /* Text renders immediately, so the queued quads have to go first. */
+   gl_renderSpriteBatchFlush();
    col = cFontWhite;
    col.a = a->scan_alpha;
    gl_gameToScreenCoords( &nx, &ny, a->pos.x, a->pos.y );
@@ -813,8 +987,11 @@ static void debris_renderSingle( const Debris *d, double cx, double cy )
 {
    const double scale = 0.5;
    const glColour col = COL_ALPHA( cInert, d->alpha );
+   double x, y;
 
-   gl_renderSpriteScaleRotate( d->gfx, d->pos.x+cx, d->pos.y+cy, scale, scale, d->ang, 0, 0, &col );
+   debris_screenPos( d, &x, &y );
+   gl_renderSpriteBatchScaleRotate( d->gfx, x+cx, y+cy,
+         scale, scale, d->ang, 0, 0, &col );
 }
 
 /**
@@ -868,10 +1045,86 @@ void asteroids_free (void)
    array_free( debris_stack );
    debris_stack = NULL;
 
+   /* Clean up the field-lookup grid. */
+   free( ast_grid );
+   ast_grid = NULL;
+
    /* Free the gatherable stack. */
    gatherable_free();
 }
 
+/**
+ * @brief Classifies each cell of the lookup grid against the current
+ *        system's fields and exclusion zones.
+ */
+static void asteroids_gridBuild (void)
+{
+   double minx, miny, maxx, maxy, hd;
+
+   free( ast_grid );
+   ast_grid = NULL;
+   if (array_size(cur_system->asteroids) <= 0)
+      return;
+
+   /* Bounding box over the fields; anything outside can't be in one. */
+   minx = miny = HUGE_VAL;
+   maxx = maxy = -HUGE_VAL;
+   for (int i=0; i<array_size(cur_system->asteroids); i++) {
+      const AsteroidAnchor *a = &cur_system->asteroids[i];
+      minx = MIN( minx, a->pos.x - a->radius );
+      maxx = MAX( maxx, a->pos.x + a->radius );
+      miny = MIN( miny, a->pos.y - a->radius );
+      maxy = MAX( maxy, a->pos.y + a->radius );
+   }
+
+   ast_grid_cell = MAX( ASTGRID_MIN_CELL,
+         MAX( maxx-minx, maxy-miny ) / (double)ASTGRID_DIM );
+   ast_grid_x0 = minx;
+   ast_grid_y0 = miny;
+   ast_grid_w  = (int)ceil( (maxx-minx) / ast_grid_cell );
+   ast_grid_h  = (int)ceil( (maxy-miny) / ast_grid_cell );
+   ast_grid    = malloc( (size_t)ast_grid_w * ast_grid_h );
+   hd          = ast_grid_cell * M_SQRT1_2; /* Half-diagonal of a cell. */
+
+   for (int cy=0; cy<ast_grid_h; cy++) {
+      for (int cx=0; cx<ast_grid_w; cx++) {
+         vec2 c;
+         int8_t v;
+         int mixed = 0;
+         c.x = ast_grid_x0 + ((double)cx + 0.5) * ast_grid_cell;
+         c.y = ast_grid_y0 + ((double)cy + 0.5) * ast_grid_cell;
+
+         /* Exclusion zones dominate, like in the exact test. */
+         v = -1;
+         for (int i=0; i<array_size(cur_system->astexclude); i++) {
+            const AsteroidExclusion *e = &cur_system->astexclude[i];
+            double d = vec2_dist( &c, &e->pos );
+            if (d + hd <= e->radius) {
+               mixed = 0; /* Fully excluded; nothing else matters. */
+               break;
+            }
+            if (d - hd <= e->radius)
+               mixed = 1; /* Straddles the exclusion edge. */
+         }
+         if (!mixed && (v == -1)) {
+            for (int i=0; i<array_size(cur_system->asteroids); i++) {
+               const AsteroidAnchor *a = &cur_system->asteroids[i];
+               double d = vec2_dist( &c, &a->pos );
+               if (d + hd <= a->radius) {
+                  v = (int8_t)i; /* First containing field wins. */
+                  break;
+               }
+               if (d - hd <= a->radius) {
+                  mixed = 1;
+                  break;
+               }
+            }
+         }
+         ast_grid[ cy*ast_grid_w + cx ] = mixed ? ASTGRID_MIXED : v;
+      }
+   }
+}
+
 /**
  * @brief See if the position is in an asteroid field.
  *
@@ -880,6 +1133,19 @@ void asteroids_free (void)
  */
 int asteroids_inField( const vec2 *p )
 {
+   /* Grid fast path: most queries land in a cell that is definitely
+    * inside one field or definitely outside them all. */
+   if (ast_grid != NULL) {
+      int cx = (int)floor( (p->x - ast_grid_x0) / ast_grid_cell );
+      int cy = (int)floor( (p->y - ast_grid_y0) / ast_grid_cell );
+      if ((cx < 0) || (cx >= ast_grid_w) || (cy < 0) || (cy >= ast_grid_h))
+         return -1; /* Outside the bounding box of all fields. */
+      if (ast_grid[ cy*ast_grid_w + cx ] != ASTGRID_MIXED)
+         return ast_grid[ cy*ast_grid_w + cx ];
+   }
+   else if (array_size(cur_system->asteroids) <= 0)
+      return -1;
+
    /* Always return -1 if in an exclusion zone */
    for (int i=0; i<array_size(cur_system->astexclude); i++) {
       AsteroidExclusion *e = &cur_system->astexclude[i];
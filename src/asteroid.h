@@ -107,6 +107,9 @@ typedef struct AsteroidAnchor_ {
    double maxspeed;/**< Maxmimum speed the asteroids can have in the field. */
    double thrust; /**< Thrust applied when out of radius towards center. */
    double margin; /**< Extra margin to use when doing distance computations. */
+   int active;    /**< Whether the field is near enough to simulate per-asteroid. */
+   double dormant_dt; /**< Time accumulated while the field was dormant. */
+   double armed;  /**< Time left in the weapon collision layer; 0 when no weapon probed recently. */
 } AsteroidAnchor;
 
 /**
@@ -140,5 +143,6 @@ AsteroidTypeGroup *astgroup_getName( const char *name );
 /* Misc functions. */
 int asteroids_inField( const vec2 *p );
 void asteroids_computeInternals( AsteroidAnchor *a );
+void asteroids_arm( AsteroidAnchor *ast );
 void asteroid_hit( Asteroid *a, const Damage *dmg, int max_rarity, double mine_bonus );
 void asteroid_explode( Asteroid *a, int max_rarity, double mine_bonus );
@@ -46,6 +46,7 @@ typedef struct background_image_s {
    double scale; /**< How the image should be scaled. */
    double angle; /**< Rotation (in radians). */
    glColour col; /**< Colour to use. */
+   glColour ucol; /**< col with conf.bg_brightness baked in; refreshed when conf changes. */
 } background_image_t;
 static background_image_t *bkg_image_arr_bk = NULL; /**< Background image array to display (behind stars). */
 static background_image_t *bkg_image_arr_ft = NULL; /**< Background image array to display (in front of stars). */
@@ -201,7 +202,7 @@ void background_renderDust( const double dt )
    h += conf.zoom_stars * (h / conf.zoom_far - 1.);
 
    /* Common shader stuff. */
-   glUseProgram(shaders.stars.program);
+   gl_useProgram(shaders.stars.program);
    gl_uniformMat4(shaders.stars.projection, &projection);
    glUniform2f(shaders.stars.star_xy, star_x, star_y);
    glUniform3f(shaders.stars.dims, w, h, 1. / gl_screen.scale);
@@ -233,7 +234,7 @@ void background_renderDust( const double dt )
    glDisableVertexAttribArray( shaders.stars.vertex );
    glDisableVertexAttribArray( shaders.stars.brightness );
 
-   glUseProgram(0);
+   gl_useProgram(0);
 
    /* Check for errors. */
    gl_checkErr();
@@ -346,6 +347,10 @@ unsigned int background_addImage( glTexture *image, double x, double y,
    bkg->scale  = scale;
    bkg->angle  = angle;
    bkg->col    = (col!=NULL) ? *col : cWhite;
+   bkg->ucol.r = bkg->col.r * conf.bg_brightness;
+   bkg->ucol.g = bkg->col.g * conf.bg_brightness;
+   bkg->ucol.b = bkg->col.b * conf.bg_brightness;
+   bkg->ucol.a = bkg->col.a;
 
    /* Sort if necessary. */
    bkg_sort( *arr );
@@ -365,7 +370,6 @@ static void background_renderImages( background_image_t *bkg_arr )
    /* Render images in order. */
    for (int i=0; i<array_size(bkg_arr); i++) {
       double cx,cy, x,y, gx,gy, z, m;
-      glColour col;
       background_image_t *bkg = &bkg_arr[i];
 
       cam_getPos( &cx, &cy );
@@ -375,12 +379,7 @@ static void background_renderImages( background_image_t *bkg_arr )
       x  = (bkg->x - cx) * m - z*bkg->image->sw/2. + gx + SCREEN_W/2.;
       y  = (bkg->y - cy) * m - z*bkg->image->sh/2. + gy + SCREEN_H/2.;
 
-      col.r = bkg->col.r * conf.bg_brightness;
-      col.g = bkg->col.g * conf.bg_brightness;
-      col.b = bkg->col.b * conf.bg_brightness;
-      col.a = bkg->col.a;
-
-      gl_renderTexture( bkg->image, x, y, z*bkg->image->sw, z*bkg->image->sh, 0., 0., bkg->image->srw, bkg->image->srh, &col, bkg->angle );
+      gl_renderTexture( bkg->image, x, y, z*bkg->image->sw, z*bkg->image->sh, 0., 0., bkg->image->srw, bkg->image->srh, &bkg->ucol, bkg->angle );
    }
 }
 
@@ -430,6 +429,23 @@ static nlua_env background_create( const char *name )
    return env;
 }
 
+/**
+ * @brief Rebakes the brightness-adjusted image colours when conf changes.
+ */
+static void background_confChanged (void)
+{
+   background_image_t *arrs[2] = { bkg_image_arr_bk, bkg_image_arr_ft };
+   for (int l=0; l<2; l++) {
+      for (int i=0; i<array_size(arrs[l]); i++) {
+         background_image_t *bkg = &arrs[l][i];
+         bkg->ucol.r = bkg->col.r * conf.bg_brightness;
+         bkg->ucol.g = bkg->col.g * conf.bg_brightness;
+         bkg->ucol.b = bkg->col.b * conf.bg_brightness;
+         bkg->ucol.a = bkg->col.a;
+      }
+   }
+}
+
 /**
  * @brief Initializes the background system.
  */
@@ -437,6 +453,7 @@ int background_init (void)
 {
    /* Load Lua. */
    bkg_def_env = background_create( "default" );
+   conf_addChangeListener( background_confChanged );
    return 0;
 }
 
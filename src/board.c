@@ -36,6 +36,11 @@ static int board_stopboard = 0; /**< Whether or not to unboard. */
 static int board_boarded   = 0; /**< Whether or not the player is boarded. */
 static nlua_env board_env  = LUA_NOREF; /**< Lua environment to do the boarding. */
 
+/*
+ * Prototypes.
+ */
+static int board_loadEnv (void);
+
 /**
  * @brief Gets if the player is boarded.
  */
@@ -44,6 +49,66 @@ int player_isBoarded (void)
    return board_boarded;
 }
 
+/**
+ * @brief Lazily sets up the boarding Lua environment.
+ *
+ *    @return 0 on success.
+ */
+static int board_loadEnv (void)
+{
+   size_t bufsize;
+   char *buf;
+
+   if (board_env != LUA_NOREF)
+      return 0;
+
+   board_env = nlua_newEnv();
+   nlua_loadStandard( board_env );
+
+   buf = ndata_read( BOARD_PATH, &bufsize );
+   if (nlua_dobufenv(board_env, buf, bufsize, BOARD_PATH) != 0) {
+      WARN( _("Error loading file: %s\n"
+          "%s\n"
+          "Most likely Lua file has improper syntax, please check"),
+            BOARD_PATH, lua_tostring(naevL,-1));
+      free(buf);
+      return -1;
+   }
+   free(buf);
+   return 0;
+}
+
+/**
+ * @brief Precomputes a pilot's boarding loot, off the interaction path.
+ *
+ * Runs the board script's board_precompute function, which computes and
+ *  caches the loot table. Called when a pilot becomes disabled so the
+ *  boarding window later opens from the cache instead of running the
+ *  loot scripts while the player waits.
+ *
+ *    @param p Pilot to precompute the loot of.
+ */
+void board_precompute( Pilot *p )
+{
+   /* Boarding own escorts just reactivates them; see board_hook. */
+   if (pilot_isWithPlayer( p ))
+      return;
+
+   if (board_loadEnv() != 0)
+      return;
+
+   nlua_getenv( naevL, board_env, "board_precompute" );
+   if (lua_isnil( naevL, -1 )) {
+      lua_pop( naevL, 1 );
+      return;
+   }
+   lua_pushpilot( naevL, p->id );
+   if (nlua_pcall( board_env, 1, 0 )) {
+      WARN( _("Board: '%s'"), lua_tostring(naevL,-1));
+      lua_pop( naevL, 1 );
+   }
+}
+
 int board_hook( void *data )
 {
    HookParam hparam[2];
@@ -76,22 +141,9 @@ int board_hook( void *data )
    }
 
    /* Set up environment first time. */
-   if (board_env == LUA_NOREF) {
-      board_env = nlua_newEnv();
-      nlua_loadStandard( board_env );
-
-      size_t bufsize;
-      char *buf = ndata_read( BOARD_PATH, &bufsize );
-      if (nlua_dobufenv(board_env, buf, bufsize, BOARD_PATH) != 0) {
-         WARN( _("Error loading file: %s\n"
-             "%s\n"
-             "Most likely Lua file has improper syntax, please check"),
-               BOARD_PATH, lua_tostring(naevL,-1));
-         board_boarded = 0;
-         free(buf);
-         return -1;
-      }
-      free(buf);
+   if (board_loadEnv() != 0) {
+      board_boarded = 0;
+      return -1;
    }
 
    /* Run Lua. */
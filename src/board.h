@@ -16,4 +16,5 @@ int player_isBoarded (void);
 int player_tryBoard( int noisy );
 void board_unboard (void);
 int pilot_board( Pilot *p );
+void board_precompute( Pilot *p );
 void pilot_boardComplete( Pilot *p );
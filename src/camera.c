@@ -19,6 +19,7 @@
 #include "log.h"
 #include "nebula.h"
 #include "pause.h"
+#include "physics.h"
 #include "player.h"
 #include "space.h"
 
@@ -37,6 +38,10 @@ static double camera_VY    = 0.;
 /* Old is used to compensate pilot movement. */
 static double old_X        = 0.; /**< Old X positiion. */
 static double old_Y        = 0.; /**< Old Y position. */
+/* Position at the start of the last update, for render interpolation. */
+static double pre_X        = 0.; /**< X position before the last update. */
+static double pre_Y        = 0.; /**< Y position before the last update. */
+static double pre_Z        = 1.; /**< Zoom before the last update. */
 /* Target is used why flying over with a target set. */
 static double target_Z     = 0.; /**< Target zoom. */
 static double target_X     = 0.; /**< Target X position. */
@@ -73,6 +78,7 @@ void cam_zoomOverride( int enable )
 void cam_setZoom( double zoom )
 {
    camera_Z = CLAMP( conf.zoom_far, conf.zoom_near, zoom );
+   pre_Z    = camera_Z; /* Hard set; don't glide into it. */
 }
 
 /**
@@ -96,7 +102,12 @@ void cam_setZoomTarget( double zoom, double speed )
  */
 double cam_getZoom (void)
 {
-   return camera_Z;
+   /* Smoothed render-side zoom: interpolated between the last two
+    * update steps just like the position, so it stays fluid however
+    * coarse the simulation rate is. Update code sees the raw value
+    * since the factor is forced to 1. during updates. */
+   double a = solid_getRenderInterp();
+   return pre_Z + (camera_Z - pre_Z) * a;
 }
 
 /**
@@ -117,8 +128,11 @@ double cam_getZoomTarget (void)
  */
 void cam_getPos( double *x, double *y )
 {
-   *x = camera_X;
-   *y = camera_Y;
+   /* Interpolate between the last two physics steps; the factor is 1.
+    * (no-op) unless the decoupled fixed-step simulation is in use. */
+   double a = solid_getRenderInterp();
+   *x = pre_X + (camera_X - pre_X) * a;
+   *y = pre_Y + (camera_Y - pre_Y) * a;
 }
 
 /**
@@ -163,6 +177,8 @@ void cam_setTargetPilot( unsigned int follow, int soft_over )
             camera_Y = y;
             old_X    = x;
             old_Y    = y;
+            pre_X    = x;
+            pre_Y    = y;
          }
       }
       camera_fly = 0;
@@ -190,6 +206,8 @@ void cam_setTargetPos( double x, double y, int soft_over )
       camera_Y = y;
       old_X    = x;
       old_Y    = y;
+      pre_X    = x;
+      pre_Y    = y;
       camera_fly = 0;
    }
    else {
@@ -223,6 +241,11 @@ void cam_update( double dt )
    Pilot *p;
    double ox, oy;
 
+   /* Remember where we were for render interpolation. */
+   pre_X = camera_X;
+   pre_Y = camera_Y;
+   pre_Z = camera_Z;
+
    /* Calculate differential. */
    camera_DX = camera_X;
    camera_DY = camera_Y;
@@ -31,7 +31,40 @@ struct Claim_s {
       exclusive claims. */
 };
 
-static char **claimed_strs = NULL; /**< Global claimed strings. */
+/**
+ * @brief One globally claimed string, with its hash precomputed so tests
+ *  only strcmp on a hash match.
+ */
+typedef struct ClaimedStr_ {
+   uint32_t hash; /**< Hash of the string. */
+   char *str;     /**< The claimed string. */
+} ClaimedStr;
+static ClaimedStr *claimed_strs = NULL; /**< Global claimed strings. */
+
+/**
+ * @brief djb2 string hash; claim strings are short and few, collisions
+ *  just cost a strcmp.
+ */
+static uint32_t claim_strHash( const char *str )
+{
+   uint32_t hash = 5381;
+   for (const char *c=str; *c != '\0'; c++)
+      hash = hash*33 + (uint32_t)*c;
+   return hash;
+}
+
+/**
+ * @brief Whether a string is currently claimed globally.
+ */
+static int claim_strClaimed( const char *str )
+{
+   uint32_t hash = claim_strHash( str );
+   for (int i=0; i<array_size(claimed_strs); i++)
+      if ((claimed_strs[i].hash == hash) &&
+            (strcmp( claimed_strs[i].str, str )==0))
+         return 1;
+   return 0;
+}
 
 /**
  * @brief Creates a system claim.
@@ -128,16 +161,45 @@ int claim_test( const Claim_t *claim )
    }
 
    /* Check strings. */
-   for (int i=0; i<array_size(claim->strs); i++) {
-      for (int j=0; j<array_size(claimed_strs); j++) {
-         if (strcmp( claim->strs[i], claimed_strs[j] )==0)
-            return 1;
-      }
-   }
+   for (int i=0; i<array_size(claim->strs); i++)
+      if (claim_strClaimed( claim->strs[i] ))
+         return 1;
 
    return 0;
 }
 
+/**
+ * @brief Tests whether a single system could be claimed, without building
+ *  a claim object.
+ *
+ * Equivalent to claim_test() on a one-system claim; lets the mission
+ *  computer evaluation sweep test its candidates allocation-free.
+ *
+ *    @param sys Id of the system to test.
+ *    @param exclusive Whether the would-be claim is exclusive.
+ *    @return 0 if the system could be claimed, 1 on collision.
+ */
+int claim_testOneSys( int sys, int exclusive )
+{
+   const StarSystem *ss = system_getIndex( sys );
+   if (ss == NULL)
+      return 0;
+   return sys_isFlag( ss, SYSTEM_CLAIMED ) ||
+         (exclusive && (ss->claims_soft > 0));
+}
+
+/**
+ * @brief Tests whether a single string could be claimed, without building
+ *  a claim object.
+ *
+ *    @param str String to test.
+ *    @return 0 if the string could be claimed, 1 on collision.
+ */
+int claim_testOneStr( const char *str )
+{
+   return claim_strClaimed( str );
+}
+
 /**
  * @brief Tests to see if a system is claimed by a system claim.
  *
@@ -201,9 +263,11 @@ void claim_destroy( Claim_t *claim )
 
    for (int i=0; i<array_size(claim->strs); i++) {
       if (claim->active) {
+         uint32_t hash = claim_strHash( claim->strs[i] );
          for (int j=0; j<array_size(claimed_strs); j++) {
-            if (strcmp(claim->strs[i], claimed_strs[j])==0) {
-               free( claimed_strs[j] );
+            if ((claimed_strs[j].hash == hash) &&
+                  (strcmp(claim->strs[i], claimed_strs[j].str)==0)) {
+               free( claimed_strs[j].str );
                array_erase( &claimed_strs, &claimed_strs[j], &claimed_strs[j+1] );
                break;
             }
@@ -228,7 +292,7 @@ void claim_clear (void)
    }
 
    for (int i=0; i<array_size(claimed_strs); i++)
-      free(claimed_strs[i]);
+      free(claimed_strs[i].str);
    array_free(claimed_strs);
    claimed_strs = NULL;
 }
@@ -261,9 +325,14 @@ void claim_activate( Claim_t *claim )
 
    /* Add strings. */
    if ((claimed_strs == NULL) && (array_size(claim->strs) > 0))
-      claimed_strs = array_create( char* );
-   for (int i=0; i<array_size(claim->strs); i++)
-      array_push_back( &claimed_strs, strdup( claim->strs[i] ) );
+      claimed_strs = array_create( ClaimedStr );
+   for (int i=0; i<array_size(claim->strs); i++) {
+      ClaimedStr cs = {
+         .hash = claim_strHash( claim->strs[i] ),
+         .str  = strdup( claim->strs[i] ),
+      };
+      array_push_back( &claimed_strs, cs );
+   }
    claim->active = 1;
 }
 
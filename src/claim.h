@@ -16,6 +16,8 @@ Claim_t *claim_create( int exclusive );
 int claim_addStr( Claim_t *claim, const char *str );
 int claim_addSys( Claim_t *claim, int ss_id );
 int claim_test( const Claim_t *claim );
+int claim_testOneSys( int sys, int exclusive );
+int claim_testOneStr( const char *str );
 int claim_testStr( const Claim_t *claim, const char *str );
 int claim_testSys( const Claim_t *claim, int sys );
 void claim_destroy( Claim_t *claim );
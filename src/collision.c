@@ -22,6 +22,10 @@ static int pointInPolygon( const CollPoly* at, const vec2* ap,
       float x, float y );
 static int LineOnPolygon( const CollPoly* at, const vec2* ap,
       float x1, float y1, float x2, float y2, vec2* crash );
+static double SegmentPointDist2( double x1, double y1, double x2, double y2,
+      double px, double py );
+static void PolyAccel( CollPoly *polygon );
+static int PolyPointCmp( const void *p1, const void *p2 );
 
 /**
  * @brief Loads a polygon from an xml node.
@@ -31,6 +35,7 @@ static int LineOnPolygon( const CollPoly* at, const vec2* ap,
  */
 void LoadPolygon( CollPoly* polygon, xmlNodePtr node )
 {
+   float r2;
    xmlNodePtr cur = node->children;
    do {
       if (xml_isNode(cur,"x")) {
@@ -74,9 +79,204 @@ void LoadPolygon( CollPoly* polygon, xmlNodePtr node )
       }
    } while (xml_nextNode(cur));
 
+   (void) r2;
+   PolyAccel( polygon );
    return;
 }
 
+/**
+ * @brief Computes the coarse-phase acceleration data of a polygon.
+ *
+ * Needs x, y, npt and the extremes to be set.
+ *
+ *    @param polygon Polygon to compute the data of.
+ */
+static void PolyAccel( CollPoly *polygon )
+{
+   float r2;
+
+   /* Bounding circle: centered on the bounding box, radius covering the
+    * farthest vertex. Used as the coarse-phase rejection test. */
+   polygon->cx = (polygon->xmin + polygon->xmax) / 2.;
+   polygon->cy = (polygon->ymin + polygon->ymax) / 2.;
+   r2 = 0.;
+   for (int i=0; i<polygon->npt; i++) {
+      float d2 = pow2( polygon->x[i] - polygon->cx ) +
+                 pow2( polygon->y[i] - polygon->cy );
+      r2 = MAX( r2, d2 );
+   }
+   polygon->radius = sqrtf( r2 );
+
+   /* Group the edges and store a bounding box per group, so the edge loops
+    * can skip COLLPOLY_EDGE_GROUP edges at a time. Edge k goes from point k
+    * to point (k+1)%npt. */
+   polygon->ngroup = (polygon->npt + COLLPOLY_EDGE_GROUP-1) / COLLPOLY_EDGE_GROUP;
+   polygon->gxmin = malloc( sizeof(float) * polygon->ngroup );
+   polygon->gxmax = malloc( sizeof(float) * polygon->ngroup );
+   polygon->gymin = malloc( sizeof(float) * polygon->ngroup );
+   polygon->gymax = malloc( sizeof(float) * polygon->ngroup );
+   for (int g=0; g<polygon->ngroup; g++) {
+      int kend = MIN( (g+1)*COLLPOLY_EDGE_GROUP, polygon->npt );
+      float xmin, xmax, ymin, ymax;
+      xmin = xmax = polygon->x[ g*COLLPOLY_EDGE_GROUP ];
+      ymin = ymax = polygon->y[ g*COLLPOLY_EDGE_GROUP ];
+      for (int k=g*COLLPOLY_EDGE_GROUP; k<kend; k++) {
+         int kp = (k+1==polygon->npt) ? 0 : k+1;
+         xmin = MIN( xmin, polygon->x[kp] );
+         xmax = MAX( xmax, polygon->x[kp] );
+         ymin = MIN( ymin, polygon->y[kp] );
+         ymax = MAX( ymax, polygon->y[kp] );
+      }
+      polygon->gxmin[g] = xmin;
+      polygon->gxmax[g] = xmax;
+      polygon->gymin[g] = ymin;
+      polygon->gymax[g] = ymax;
+   }
+}
+
+/**
+ * @brief Builds a polygon from raw point lists.
+ *
+ *    @param[out] polygon Polygon to build.
+ *    @param x X coordinates of the points.
+ *    @param y Y coordinates of the points.
+ *    @param npt Number of points.
+ */
+void GenPolygonFromPoints( CollPoly *polygon, const float *x, const float *y, int npt )
+{
+   polygon->npt = npt;
+   polygon->x = malloc( sizeof(float) * npt );
+   polygon->y = malloc( sizeof(float) * npt );
+   polygon->xmin = polygon->xmax = x[0];
+   polygon->ymin = polygon->ymax = y[0];
+   for (int i=0; i<npt; i++) {
+      polygon->x[i] = x[i];
+      polygon->y[i] = y[i];
+      polygon->xmin = MIN( polygon->xmin, x[i] );
+      polygon->xmax = MAX( polygon->xmax, x[i] );
+      polygon->ymin = MIN( polygon->ymin, y[i] );
+      polygon->ymax = MAX( polygon->ymax, y[i] );
+   }
+   PolyAccel( polygon );
+}
+
+/**
+ * @brief Compares two points lexicographically for the convex hull.
+ */
+static int PolyPointCmp( const void *p1, const void *p2 )
+{
+   const float *a = p1;
+   const float *b = p2;
+   if (a[0] < b[0]) return -1;
+   if (a[0] > b[0]) return +1;
+   if (a[1] < b[1]) return -1;
+   if (a[1] > b[1]) return +1;
+   return 0;
+}
+
+/**
+ * @brief Generates a convex collision polygon from a sprite's alpha channel.
+ *
+ * Fallback for ships without pregenerated polygon data: the opaque extent
+ * of each pixel row gives boundary points whose convex hull becomes the
+ * polygon. Coordinates are relative to the sprite centre, with row 0 of
+ * the alpha buffer mapping to the top of the sprite.
+ *
+ *    @param[out] polygon Polygon to generate.
+ *    @param alpha Alpha channel of the sprite, sw*sh bytes.
+ *    @param sw Sprite width.
+ *    @param sh Sprite height.
+ */
+void GenPolygonFromAlpha( CollPoly *polygon, const unsigned char *alpha, int sw, int sh )
+{
+   float (*pts)[2], (*hull)[2];
+   float *hx, *hy;
+   int n, nh;
+
+   /* Opaque extremes of each row are the only possible hull points. */
+   pts = malloc( sizeof(float[2]) * 2*sh );
+   n = 0;
+   for (int v=0; v<sh; v++) {
+      int first = -1, last = -1;
+      for (int u=0; u<sw; u++) {
+         if (alpha[ v*sw+u ] < 128)
+            continue;
+         if (first < 0)
+            first = u;
+         last = u;
+      }
+      if (first < 0)
+         continue;
+      pts[n][0] = (float)first - (float)sw/2. + .5;
+      pts[n][1] = (float)sh/2. - (float)v - .5;
+      n++;
+      if (last != first) {
+         pts[n][0] = (float)last - (float)sw/2. + .5;
+         pts[n][1] = (float)sh/2. - (float)v - .5;
+         n++;
+      }
+   }
+
+   /* Fully transparent sprite; leave a degenerate point so the structure
+    * stays valid. It can not collide with anything. */
+   if (n <= 0) {
+      pts[0][0] = pts[0][1] = 0.;
+      n = 1;
+   }
+
+   /* Monotone chain convex hull. */
+   qsort( pts, n, sizeof(float[2]), PolyPointCmp );
+   hull = malloc( sizeof(float[2]) * (2*n+1) );
+   nh = 0;
+   for (int i=0; i<n; i++) { /* Lower hull. */
+      while ((nh >= 2) &&
+            ((hull[nh-1][0]-hull[nh-2][0]) * (pts[i][1]-hull[nh-2][1]) -
+             (hull[nh-1][1]-hull[nh-2][1]) * (pts[i][0]-hull[nh-2][0]) <= 0.))
+         nh--;
+      hull[nh][0] = pts[i][0];
+      hull[nh][1] = pts[i][1];
+      nh++;
+   }
+   for (int i=n-2, l=nh+1; i>=0; i--) { /* Upper hull. */
+      while ((nh >= l) &&
+            ((hull[nh-1][0]-hull[nh-2][0]) * (pts[i][1]-hull[nh-2][1]) -
+             (hull[nh-1][1]-hull[nh-2][1]) * (pts[i][0]-hull[nh-2][0]) <= 0.))
+         nh--;
+      hull[nh][0] = pts[i][0];
+      hull[nh][1] = pts[i][1];
+      nh++;
+   }
+   if (nh > 1)
+      nh--; /* Last point repeats the first. */
+
+   hx = malloc( sizeof(float) * nh );
+   hy = malloc( sizeof(float) * nh );
+   for (int i=0; i<nh; i++) {
+      hx[i] = hull[i][0];
+      hy[i] = hull[i][1];
+   }
+   GenPolygonFromPoints( polygon, hx, hy, nh );
+   free( hx );
+   free( hy );
+   free( hull );
+   free( pts );
+}
+
+/**
+ * @brief Frees the data allocated by LoadPolygon.
+ *
+ *    @param polygon Polygon to free (not the pointer itself).
+ */
+void FreePolygon( CollPoly* polygon )
+{
+   free( polygon->x );
+   free( polygon->y );
+   free( polygon->gxmin );
+   free( polygon->gxmax );
+   free( polygon->gymin );
+   free( polygon->gymax );
+}
+
 /**
  * @brief Checks whether or not two sprites collide.
  *
@@ -149,17 +349,36 @@ int CollideSprite( const glTexture* at, const int asx, const int asy, const vec2
    bbx =  bsx*(int)(bt->sw) - bx1;
    bby = rbsy*(int)(bt->sh) - by1;
 
-   for (y=inter_y0; y<=inter_y1; y++)
-      for (x=inter_x0; x<=inter_x1; x++)
+   for (y=inter_y0; y<=inter_y1; y++) {
+      x = inter_x0;
+      while (x <= inter_x1) {
          /* compute offsets for surface before pass to TransparentPixel test */
-         if ((!gl_isTrans(at, abx + x, aby + y)) &&
-               (!gl_isTrans(bt, bbx + x, bby + y))) {
+         int axp = abx + x, ayp = aby + y;
+         int bxp = bbx + x, byp = bby + y;
+
+         /* Fully transparent 8x8 blocks in either sprite reject the rest
+          * of the block's row in one step; large sprites are mostly empty
+          * corners, so this is where almost all iterations go. */
+         if (gl_isTransBlock( at, axp, ayp )) {
+            x += 8 - (axp % 8);
+            continue;
+         }
+         if (gl_isTransBlock( bt, bxp, byp )) {
+            x += 8 - (bxp % 8);
+            continue;
+         }
+
+         if ((!gl_isTrans(at, axp, ayp)) &&
+               (!gl_isTrans(bt, bxp, byp))) {
 
             /* Set the crash position. */
             crash->x = x;
             crash->y = y;
             return 1;
          }
+         x++;
+      }
+   }
 
    return 0;
 }
@@ -195,6 +414,12 @@ int CollideSpritePolygon( const CollPoly* at, const vec2* ap,
    }
 #endif /* DEBUGGING */
 
+   /* Coarse bounding circle test; most pairs get rejected here. */
+   if (pow2( (VX(*ap) + at->cx) - VX(*bp) ) +
+       pow2( (VY(*ap) + at->cy) - VY(*bp) ) >
+         pow2( at->radius + sqrt( pow2(bt->sw) + pow2(bt->sh) ) / 2. ))
+      return 0;
+
    /* a - cube coordinates */
    ax1 = (int)VX(*ap) + (int)(at->xmin);
    ay1 = (int)VY(*ap) + (int)(at->ymin);
@@ -259,6 +484,12 @@ int CollidePolygon( const CollPoly* at, const vec2* ap,
    int inter_x0, inter_x1, inter_y0, inter_y1;
    float xabs, yabs, x1, y1, x2, y2;
 
+   /* Coarse bounding circle test; most pairs get rejected here. */
+   if (pow2( (VX(*ap) + at->cx) - (VX(*bp) + bt->cx) ) +
+       pow2( (VY(*ap) + at->cy) - (VY(*bp) + bt->cy) ) >
+         pow2( at->radius + bt->radius ))
+      return 0;
+
    /* a - cube coordinates */
    ax1 = (int)VX(*ap) + (int)(at->xmin);
    ay1 = (int)VY(*ap) + (int)(at->ymin);
@@ -330,6 +561,12 @@ int pointInPolygon( const CollPoly* at, const vec2* ap,
    float vprod, sprod, angle;
    float dxi, dxip, dyi, dyip;
 
+   /* Quick rejection against the bounding box; the winding sum below is
+    * always zero outside of it. */
+   if ((x < at->xmin + VX(*ap)) || (x > at->xmax + VX(*ap)) ||
+       (y < at->ymin + VY(*ap)) || (y > at->ymax + VY(*ap)))
+      return 0;
+
    /* See if the pixel is inside the polygon:
       We increment the angle when doing a loop along all the points
       If the final angle is 0, we are outside the polygon
@@ -373,28 +610,66 @@ int pointInPolygon( const CollPoly* at, const vec2* ap,
 int LineOnPolygon( const CollPoly* at, const vec2* ap,
       float x1, float y1, float x2, float y2, vec2* crash )
 {
-   float xi, xip, yi, yip;
+   float sxmin, sxmax, symin, symax;
 
    /* In this function, we are only looking for one collision point. */
 
-   xi  = at->x[at->npt-1] + ap->x;
-   xip = at->x[0]         + ap->x;
-   yi  = at->y[at->npt-1] + ap->y;
-   yip = at->y[0]         + ap->y;
-   if ( CollideLineLine(x1, y1, x2, y2, xi, yi, xip, yip, crash) == 1 )
-      return 1;
-   for (int i=0; i<=at->npt-2; i++) {
-      xi  = at->x[i]   + ap->x;
-      xip = at->x[i+1] + ap->x;
-      yi  = at->y[i]   + ap->y;
-      yip = at->y[i+1] + ap->y;
-      if ( CollideLineLine(x1, y1, x2, y2, xi, yi, xip, yip, crash) == 1 )
-         return 1;
+   /* Bounding box of the segment, for testing against the edge groups. */
+   sxmin = MIN( x1, x2 );
+   sxmax = MAX( x1, x2 );
+   symin = MIN( y1, y2 );
+   symax = MAX( y1, y2 );
+
+   for (int g=0; g<at->ngroup; g++) {
+      int kend;
+
+      /* Skip the whole edge group if its box misses the segment's box. */
+      if ((at->gxmax[g] + ap->x < sxmin) || (at->gxmin[g] + ap->x > sxmax) ||
+          (at->gymax[g] + ap->y < symin) || (at->gymin[g] + ap->y > symax))
+         continue;
+
+      kend = MIN( (g+1)*COLLPOLY_EDGE_GROUP, at->npt );
+      for (int k=g*COLLPOLY_EDGE_GROUP; k<kend; k++) {
+         int kp = (k+1==at->npt) ? 0 : k+1;
+         float xi  = at->x[k]  + ap->x;
+         float xip = at->x[kp] + ap->x;
+         float yi  = at->y[k]  + ap->y;
+         float yip = at->y[kp] + ap->y;
+         if ( CollideLineLine(x1, y1, x2, y2, xi, yi, xip, yip, crash) == 1 )
+            return 1;
+      }
    }
 
    return 0;
 }
 
+/**
+ * @brief Computes the squared distance between a segment and a point.
+ *
+ *    @param[in] x1 Coordiante of segment point 1.
+ *    @param[in] y1 Coordinate of segment point 1.
+ *    @param[in] x2 Coordiante of segment point 2.
+ *    @param[in] y2 Coordinate of segment point 2.
+ *    @param[in] px Coordinate of the point.
+ *    @param[in] py Coordinate of the point.
+ *    @return The squared distance.
+ */
+static double SegmentPointDist2( double x1, double y1, double x2, double y2,
+      double px, double py )
+{
+   double dx = x2 - x1;
+   double dy = y2 - y1;
+   double l2 = pow2(dx) + pow2(dy);
+   double t;
+
+   if (l2 > 0.) {
+      t = CLAMP( 0., 1., ((px-x1)*dx + (py-y1)*dy) / l2 );
+      x1 += t * dx;
+      y1 += t * dy;
+   }
+   return pow2(px-x1) + pow2(py-y1);
+}
+
 /**
  * @brief Checks to see if two lines collide.
  *
@@ -616,7 +891,7 @@ int CollideLinePolygon( const vec2* ap, double ad, double al,
       const CollPoly* bt, const vec2* bp, vec2 crash[2] )
 {
    double ep[2], bl[2], tr[2];
-   double xi, yi, xip, yip;
+   double sxmin, sxmax, symin, symax;
    int hits, real_hits;
    vec2 tmp_crash;
 
@@ -624,6 +899,13 @@ int CollideLinePolygon( const vec2* ap, double ad, double al,
    ep[0] = ap->x + al*cos(ad);
    ep[1] = ap->y + al*sin(ad);
 
+   /* Coarse bounding circle test; most beam/target pairs get rejected
+    * here without touching the edge loop. */
+   if (SegmentPointDist2( ap->x, ap->y, ep[0], ep[1],
+         bp->x + (double)bt->cx, bp->y + (double)bt->cy ) >
+            pow2( (double)bt->radius ))
+      return 0;
+
    real_hits = 0;
    vectnull( &tmp_crash );
 
@@ -684,32 +966,37 @@ int CollideLinePolygon( const vec2* ap, double ad, double al,
    }
 
    /*
-    * Now we check any line of the polygon
+    * Now we check any line of the polygon, one edge group at a time.
     */
-   xi  = (double)bt->x[bt->npt-1] + bp->x;
-   xip = (double)bt->x[0]         + bp->x;
-   yi  = (double)bt->y[bt->npt-1] + bp->y;
-   yip = (double)bt->y[0]         + bp->y;
-   if ( CollideLineLine(ap->x, ap->y, ep[0], ep[1],
-        xi, yi, xip, yip, &tmp_crash) ) {
-      crash[real_hits].x = tmp_crash.x;
-      crash[real_hits].y = tmp_crash.y;
-      real_hits++;
-      if (real_hits == 2)
-         return 1;
-   }
-   for (int i=0; i<=bt->npt-2; i++) {
-      xi  = (double)bt->x[i]   + bp->x;
-      xip = (double)bt->x[i+1] + bp->x;
-      yi  = (double)bt->y[i]   + bp->y;
-      yip = (double)bt->y[i+1] + bp->y;
-      if ( CollideLineLine(ap->x, ap->y, ep[0], ep[1],
-           xi, yi, xip, yip, &tmp_crash) ) {
-         crash[real_hits].x = tmp_crash.x;
-         crash[real_hits].y = tmp_crash.y;
-         real_hits++;
-         if (real_hits == 2)
-            return 1;
+   sxmin = MIN( ap->x, ep[0] );
+   sxmax = MAX( ap->x, ep[0] );
+   symin = MIN( ap->y, ep[1] );
+   symax = MAX( ap->y, ep[1] );
+   for (int g=0; g<bt->ngroup; g++) {
+      int kend;
+
+      /* Skip the whole edge group if its box misses the segment's box. */
+      if (((double)bt->gxmax[g] + bp->x < sxmin) ||
+          ((double)bt->gxmin[g] + bp->x > sxmax) ||
+          ((double)bt->gymax[g] + bp->y < symin) ||
+          ((double)bt->gymin[g] + bp->y > symax))
+         continue;
+
+      kend = MIN( (g+1)*COLLPOLY_EDGE_GROUP, bt->npt );
+      for (int k=g*COLLPOLY_EDGE_GROUP; k<kend; k++) {
+         int kp = (k+1==bt->npt) ? 0 : k+1;
+         double xi  = (double)bt->x[k]  + bp->x;
+         double xip = (double)bt->x[kp] + bp->x;
+         double yi  = (double)bt->y[k]  + bp->y;
+         double yip = (double)bt->y[kp] + bp->y;
+         if ( CollideLineLine(ap->x, ap->y, ep[0], ep[1],
+              xi, yi, xip, yip, &tmp_crash) ) {
+            crash[real_hits].x = tmp_crash.x;
+            crash[real_hits].y = tmp_crash.y;
+            real_hits++;
+            if (real_hits == 2)
+               return 1;
+         }
       }
    }
 
@@ -7,6 +7,8 @@
 #include "opengl.h"
 #include "physics.h"
 
+#define COLLPOLY_EDGE_GROUP 8 /**< Edges per bounding box group of a CollPoly. */
+
 /**
  * @brief Represents a polygon used for collision detection.
  */
@@ -18,10 +20,25 @@ typedef struct CollPoly_ {
    float ymin; /**< Min of y. */
    float ymax; /**< Max of y. */
    int npt; /**< Nb of points in the polygon. */
+   /* Coarse-phase acceleration data, computed by LoadPolygon. */
+   float cx; /**< X of the bounding circle center. */
+   float cy; /**< Y of the bounding circle center. */
+   float radius; /**< Radius of the bounding circle. */
+   float* gxmin; /**< Min of x per edge group. */
+   float* gxmax; /**< Max of x per edge group. */
+   float* gymin; /**< Min of y per edge group. */
+   float* gymax; /**< Max of y per edge group. */
+   int ngroup; /**< Nb of edge groups. */
 } CollPoly;
 
 /* Loads a polygon data from xml. */
 void LoadPolygon( CollPoly* polygon, xmlNodePtr node );
+/* Builds a polygon from raw point lists. */
+void GenPolygonFromPoints( CollPoly *polygon, const float *x, const float *y, int npt );
+/* Generates a convex polygon from a sprite's alpha channel. */
+void GenPolygonFromAlpha( CollPoly *polygon, const unsigned char *alpha, int sw, int sh );
+/* Frees the data allocated by LoadPolygon. */
+void FreePolygon( CollPoly* polygon );
 
 /* Returns 1 if collision is detected */
 int CollideSprite( const glTexture* at, const int asx, const int asy, const vec2* ap,
@@ -196,3 +196,19 @@ void col_blend( glColour *blend, const glColour *fg, const glColour *bg, float a
    blend->b = (1. - alpha) * bg->b + alpha * fg->b;
    blend->a = (1. - alpha) * bg->a + alpha * fg->a;
 }
+
+/**
+ * @brief Indexes a baked gradient ramp by blend factor.
+ *
+ * The ramps are generated by colours_c_gen.py with the same interpolation as
+ *  col_blend(), so this replaces the per-frame blend with a table lookup.
+ *
+ *    @param ramp Ramp to index (COL_RAMP_LEN entries).
+ *    @param t Blend factor (0 is the background end, 1 the foreground end).
+ *    @return Pointer to the nearest baked colour.
+ */
+const glColour* col_ramp( const glColour ramp[], double t )
+{
+   int i = (int)round( t * (double)(COL_RAMP_LEN-1) );
+   return &ramp[ CLAMP( 0, COL_RAMP_LEN-1, i ) ];
+}
@@ -35,3 +35,4 @@ void col_gammaToLinear( glColour *c );
 void col_hsv2rgb( glColour *c, float h, float s, float v );
 void col_rgb2hsv( float *h, float *s, float *v, float r, float g, float b );
 void col_blend( glColour *blend, const glColour *fg, const glColour *bg, float alpha );
+const glColour* col_ramp( const glColour ramp[], double t );
@@ -20,6 +20,34 @@ class Colour:
         f.write(f"const glColour c{self.name} = {{ .r={self.r}, .g={self.g}, .b={self.b}, .a={self.a} }};\n")
 
 
+RAMP_LEN = 32
+
+class Ramp:
+    """Baked gradient between two palette colours. Entry 0 is the background
+    colour and entry RAMP_LEN-1 the foreground, interpolated linearly the same
+    way col_blend() does at runtime; use col_ramp() to index by blend factor."""
+    def __init__(self, name, bg, fg):
+        self.name = name
+        self.bg = bg
+        self.fg = fg
+
+    def write_header(self, f):
+        f.write(f"extern const glColour cRamp{self.name}[ COL_RAMP_LEN ];\n")
+
+    def write_source(self, f, coldict):
+        bg = coldict[self.bg]
+        fg = coldict[self.fg]
+        f.write(f"const glColour cRamp{self.name}[ COL_RAMP_LEN ] = {{\n")
+        for i in range(RAMP_LEN):
+            t = i / (RAMP_LEN - 1)
+            r = (1. - t) * bg.r + t * fg.r
+            g = (1. - t) * bg.g + t * fg.g
+            b = (1. - t) * bg.b + t * fg.b
+            a = (1. - t) * bg.a + t * fg.a
+            f.write(f"   {{ .r={r}, .g={g}, .b={b}, .a={a} }},\n")
+        f.write("};\n")
+
+
 COLOURS = [
     Colour( "White",  1.00, 1.00, 1.00 ),
     Colour( "Grey90", 0.90, 0.90, 0.90 ),
@@ -113,6 +141,14 @@ COLOURS = [
     Colour( "FontWhite",    0.95, 0.95, 0.95 ),
 ]
 
+# Gradient ramps recomputed every frame in render paths; baked here so the
+# hot paths index a table instead of blending.
+RAMPS = [
+    Ramp( "RedYellow",        "Red",        "Yellow" ),     # Stealth / lock-on heat.
+    Ramp( "FontYellowBlue",   "FontYellow", "FontBlue" ),   # Map commodity profit.
+    Ramp( "FontYellowOrange", "FontYellow", "FontOrange" ), # Map commodity loss.
+]
+
 def write_header(f):
     f.write(f"/* FILE GENERATED BY {__file__} */")
 
@@ -125,6 +161,11 @@ def generate_h_file(f):
 """)
     for col in COLOURS:
         col.write_header( f )
+    f.write(f"""
+#define COL_RAMP_LEN {RAMP_LEN} /* Entries per baked gradient ramp. */
+""")
+    for ramp in RAMPS:
+        ramp.write_header( f )
     f.write("""
 const glColour* col_fromName( const char* name );
 """)
@@ -141,6 +182,11 @@ def generate_c_file(f):
     for col in COLOURS:
         col.write_source( f )
 
+    coldict = { col.name: col for col in COLOURS }
+    f.write("\n")
+    for ramp in RAMPS:
+        ramp.write_source( f, coldict )
+
     # TODO optimize this part. Should be possible to speed it up immensely,
     # although it probably won't impact Naev performance at all
     f.write("""
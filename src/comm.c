@@ -209,6 +209,7 @@ int comm_openSpob( Spob *spob )
    }
 
    /* Lua stuff. */
+   spob_luaEnsure( spob );
    if (spob->lua_comm != LUA_NOREF) {
       spob_luaInitMem( spob );
       lua_rawgeti(naevL, LUA_REGISTRYINDEX, spob->lua_comm); /* f */
@@ -296,7 +296,7 @@ static int commodity_parse( Commodity *temp, const char *filename )
       }
       if (xml_isNode(node,"gfx_store")) {
          temp->gfx_store = xml_parseTexture( node,
-               COMMODITY_GFX_PATH"%s", 1, 1, OPENGL_TEX_MIPMAPS );
+               COMMODITY_GFX_PATH"%s", 1, 1, OPENGL_TEX_MIPMAPS | OPENGL_TEX_ATLAS );
          continue;
       }
       if (xml_isNode(node, "standard")) {
@@ -351,7 +351,7 @@ static int commodity_parse( Commodity *temp, const char *filename )
    if ((temp->price > 0) || (temp->price_ref != NULL)) {
       if (temp->gfx_store == NULL) {
          WARN(_("No <gfx_store> node found, using default texture for commodity \"%s\""), temp->name);
-         temp->gfx_store = gl_newImage( COMMODITY_GFX_PATH"_default.webp", 0 );
+         temp->gfx_store = gl_newImage( COMMODITY_GFX_PATH"_default.webp", OPENGL_TEX_ATLAS );
       }
    }
    if (temp->gfx_space == NULL)
@@ -12,12 +12,37 @@
 
 #include "cond.h"
 
+#include "array.h"
 #include "log.h"
 #include "nlua.h"
 #include "nluadef.h"
+#include "nstring.h"
 
 static nlua_env cond_env = LUA_NOREF; /** Conditional Lua env. */
 
+/**
+ * @brief A conditional expression compiled into a Lua function.
+ *
+ * Conditionals get re-evaluated for every candidate mission, event or
+ * tech item on every land/enter, so each distinct expression is compiled
+ * once and the chunk reused; identical expressions share one entry.
+ */
+typedef struct CondChunk_ {
+   char *cond; /**< Expression text. */
+   int ref;    /**< Registry reference of the compiled function. */
+} CondChunk;
+static CondChunk *cond_chunks = NULL; /**< Array (array.h): compiled conditionals, sorted by text. */
+
+/**
+ * @brief Compares two compiled conditionals by expression text.
+ */
+static int cond_cmp( const void *p1, const void *p2 )
+{
+   const CondChunk *c1 = p1;
+   const CondChunk *c2 = p2;
+   return strcmp( c1->cond, c2->cond );
+}
+
 /**
  * @brief Initializes the conditional subsystem.
  */
@@ -40,10 +65,63 @@ int cond_init (void)
  */
 void cond_exit (void)
 {
+   for (int i=0; i<array_size(cond_chunks); i++) {
+      luaL_unref( naevL, LUA_REGISTRYINDEX, cond_chunks[i].ref );
+      free( cond_chunks[i].cond );
+   }
+   array_free( cond_chunks );
+   cond_chunks = NULL;
+
    nlua_freeEnv(cond_env);
    cond_env = LUA_NOREF;
 }
 
+/**
+ * @brief Gets the compiled function for a conditional, compiling on first use.
+ *
+ *    @param cond Condition to compile.
+ *    @return Registry reference of the function, or LUA_NOREF on error.
+ */
+static int cond_compile( const char *cond )
+{
+   CondChunk *cc, nc;
+   char *buf;
+   int ret;
+   const CondChunk q = { .cond = (char*)cond };
+
+   if (cond_chunks == NULL)
+      cond_chunks = array_create( CondChunk );
+
+   cc = bsearch( &q, cond_chunks, array_size(cond_chunks),
+         sizeof(CondChunk), cond_cmp );
+   if (cc != NULL)
+      return cc->ref;
+
+   /* Append "return" first if necessary. */
+   if (strstr( cond, "return" ) != NULL)
+      buf = strdup( cond );
+   else
+      asprintf( &buf, "return %s", cond );
+
+   ret = luaL_loadbuffer( naevL, buf, strlen(buf), "Lua Conditional" );
+   free( buf );
+   if (ret != 0) {
+      WARN(_("Lua conditional syntax error: %s"), lua_tostring(naevL, -1));
+      lua_pop(naevL, 1);
+      return LUA_NOREF;
+   }
+
+   /* Run in the conditional environment. */
+   nlua_pushenv(naevL, cond_env);
+   lua_setfenv(naevL, -2);
+
+   nc.cond = strdup( cond );
+   nc.ref  = luaL_ref( naevL, LUA_REGISTRYINDEX );
+   array_push_back( &cond_chunks, nc );
+   qsort( cond_chunks, array_size(cond_chunks), sizeof(CondChunk), cond_cmp );
+   return nc.ref;
+}
+
 /**
  * @brief Checks to see if a condition is true.
  *
@@ -52,24 +130,15 @@ void cond_exit (void)
  */
 int cond_check( const char *cond )
 {
-   int ret;
+   int ret, ref;
 
-   /* Load the string directly. */
-   if (strstr( cond, "return" ) != NULL) {
-      lua_pushstring(naevL, cond);
-   }
-   else {
-      /* Append "return" first. */
-      lua_pushstring(naevL, "return ");
-      lua_pushstring(naevL, cond);
-      lua_concat(naevL, 2);
-   }
-   ret = nlua_dobufenv(cond_env, lua_tostring(naevL,-1),
-                       lua_strlen(naevL,-1), "Lua Conditional");
+   ref = cond_compile( cond );
+   if (ref == LUA_NOREF)
+      goto cond_err;
+
+   lua_rawgeti( naevL, LUA_REGISTRYINDEX, ref );
+   ret = nlua_pcall( cond_env, 0, 1 );
    switch (ret) {
-      case  LUA_ERRSYNTAX:
-         WARN(_("Lua conditional syntax error: %s"), lua_tostring(naevL, -1));
-         goto cond_err;
       case LUA_ERRRUN:
          WARN(_("Lua Conditional had a runtime error: %s"), lua_tostring(naevL, -1));
          goto cond_err;
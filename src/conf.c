@@ -13,6 +13,7 @@
 
 #include "conf.h"
 
+#include "array.h"
 #include "env.h"
 #include "background.h"
 #include "input.h"
@@ -103,6 +104,7 @@ static void print_usage( void )
    LOG(_("   -s f, --svol f        sets the sound volume to f"));
    LOG(_("   -d, --datapath        adds a new datapath to be mounted (i.e., appends it to the search path for game assets)"));
    LOG(_("   -X, --scale           defines the scale factor"));
+   LOG(_("   --benchmark n         simulate n seconds at fixed dt, dump timings and exit"));
 #ifdef DEBUGGING
    LOG(_("   --devmode             enables dev mode perks like the editors"));
 #endif /* DEBUGGING */
@@ -241,6 +243,9 @@ void conf_setVideoDefaults (void)
    conf.explicit_dim = 0; /* No need for a define, this is only for first-run. */
    conf.scalefactor  = SCALE_FACTOR_DEFAULT;
    conf.nebu_scale   = NEBULA_SCALE_FACTOR_DEFAULT;
+   conf.render_scale = RENDER_SCALE_DEFAULT;
+   conf.nebu_autoscale = NEBU_AUTOSCALE_DEFAULT;
+   conf.texture_cache = TEXTURE_CACHE_DEFAULT;
    conf.minimize     = MINIMIZE_DEFAULT;
    conf.colorblind   = COLORBLIND_DEFAULT;
    conf.bg_brightness = BG_BRIGHTNESS_DEFAULT;
@@ -255,17 +260,50 @@ void conf_setVideoDefaults (void)
    /* FPS. */
    conf.fps_show     = SHOW_FPS_DEFAULT;
    conf.fps_max      = FPS_MAX_DEFAULT;
+   conf.fps_pace     = 0;
+   conf.fixed_physics = FIXED_PHYSICS_DEFAULT;
+   conf.radar_fps    = RADAR_FPS_DEFAULT;
+   conf.profiler     = 0;
+   conf.benchmark    = 0;
+   conf.stats_port   = 0;
 
    /* Pause. */
    conf.pause_show   = SHOW_PAUSE_DEFAULT;
 }
 
+static ConfChangeCallback *conf_listeners = NULL; /**< array.h: Change-notification callbacks. */
+
+/**
+ * @brief Registers a callback fired whenever the configuration changes.
+ *
+ * Subsystems that derive values from conf should recompute them in the
+ * callback instead of rereading conf every frame. Listeners stay registered
+ * until shutdown.
+ */
+void conf_addChangeListener( ConfChangeCallback cb )
+{
+   if (conf_listeners == NULL)
+      conf_listeners = array_create( ConfChangeCallback );
+   array_push_back( &conf_listeners, cb );
+}
+
+/**
+ * @brief Fires all change listeners; called after conf is modified in bulk.
+ */
+void conf_notifyChange (void)
+{
+   for (int i=0; i<array_size(conf_listeners); i++)
+      conf_listeners[i]();
+}
+
 /*
  * Frees some memory the conf allocated.
  */
 void conf_cleanup (void)
 {
    conf_free( &conf );
+   array_free( conf_listeners );
+   conf_listeners = NULL;
 }
 
 /*
@@ -331,6 +369,9 @@ int conf_loadConfig ( const char* file )
       }
       conf_loadFloat( lEnv, "scalefactor", conf.scalefactor );
       conf_loadFloat( lEnv, "nebu_scale", conf.nebu_scale );
+      conf_loadFloat( lEnv, "render_scale", conf.render_scale );
+      conf_loadBool( lEnv, "nebu_autoscale", conf.nebu_autoscale );
+      conf_loadInt( lEnv, "texture_cache", conf.texture_cache );
       conf_loadBool( lEnv, "fullscreen", conf.fullscreen );
       conf_loadBool( lEnv, "modesetting", conf.modesetting );
       conf_loadBool( lEnv, "notresizable", conf.notresizable );
@@ -345,6 +386,11 @@ int conf_loadConfig ( const char* file )
       /* FPS */
       conf_loadBool( lEnv, "showfps", conf.fps_show );
       conf_loadInt( lEnv, "maxfps", conf.fps_max );
+      conf_loadBool( lEnv, "fps_pace", conf.fps_pace );
+      conf_loadBool( lEnv, "fixed_physics", conf.fixed_physics );
+      conf_loadInt( lEnv, "radar_fps", conf.radar_fps );
+      conf_loadBool( lEnv, "profiler", conf.profiler );
+      conf_loadInt( lEnv, "stats_port", conf.stats_port );
 
       /*  Pause */
       conf_loadBool( lEnv, "showpause", conf.pause_show );
@@ -529,6 +575,7 @@ int conf_loadConfig ( const char* file )
 
    conf.loaded = 1;
    nlua_freeEnv( lEnv );
+   conf_notifyChange();
    return 0;
 }
 
@@ -551,6 +598,7 @@ void conf_parseCLI( int argc, char** argv )
       { "mvol", required_argument, 0, 'm' },
       { "svol", required_argument, 0, 's' },
       { "scale", required_argument, 0, 'X' },
+      { "benchmark", required_argument, 0, 'B' },
 #ifdef DEBUGGING
       { "devmode", no_argument, 0, 'D' },
 #endif /* DEBUGGING */
@@ -614,6 +662,10 @@ void conf_parseCLI( int argc, char** argv )
          case 'X':
             conf.scalefactor = atof(optarg);
             break;
+         case 'B':
+            conf.benchmark = atoi(optarg);
+            conf.profiler  = 1; /* Timings are the whole point. */
+            break;
 #ifdef DEBUGGING
          case 'D':
             conf.devmode = 1;
@@ -856,11 +908,24 @@ int conf_saveConfig ( const char* file )
    conf_saveFloat("scalefactor",conf.scalefactor);
    conf_saveEmptyLine();
 
+   conf_saveComment(_("Fraction of the resolution to render the world at (0.5 to 1)."));
+   conf_saveComment(_("The scene is sharpened back up to native resolution; the GUI and fonts stay native."));
+   conf_saveFloat("render_scale",conf.render_scale);
+   conf_saveEmptyLine();
+
    conf_saveComment(_("Scale factor for rendered nebula backgrounds."));
    conf_saveComment(_("Larger values can save time but lead to a blurrier appearance."));
    conf_saveFloat("nebu_scale",conf.nebu_scale);
    conf_saveEmptyLine();
 
+   conf_saveComment(_("Automatically halve the nebula resolution when the frame time exceeds the budget"));
+   conf_saveBool("nebu_autoscale",conf.nebu_autoscale);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("MiB of no longer referenced textures to keep in VRAM for reuse (0 disables)"));
+   conf_saveInt("texture_cache",conf.texture_cache);
+   conf_saveEmptyLine();
+
    conf_saveComment(_("Run Naev in full-screen mode"));
    conf_saveBool("fullscreen",conf.fullscreen);
    conf_saveEmptyLine();
@@ -910,6 +975,26 @@ int conf_saveConfig ( const char* file )
    conf_saveInt("maxfps",conf.fps_max);
    conf_saveEmptyLine();
 
+   conf_saveComment(_("Sleep the frame-rate-cap idle time before input is sampled to reduce input latency"));
+   conf_saveBool("fps_pace",conf.fps_pace);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("Run the simulation at a fixed 60 Hz step decoupled from the frame rate"));
+   conf_saveBool("fixed_physics",conf.fixed_physics);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("Rate the GUI radar contents are redrawn at (0 redraws every frame)"));
+   conf_saveInt("radar_fps",conf.radar_fps);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("Display per-subsystem frame timings and dump them as CSV on exit"));
+   conf_saveBool("profiler",conf.profiler);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("Publish runtime statistics as JSON lines on this local TCP port (0 disables)"));
+   conf_saveInt("stats_port",conf.stats_port);
+   conf_saveEmptyLine();
+
    /* Pause */
    conf_saveComment(_("Show 'PAUSED' on screen while paused"));
    conf_saveBool("showpause",conf.pause_show);
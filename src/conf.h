@@ -37,8 +37,13 @@
 #define VSYNC_DEFAULT                  0     /**< Whether to wait for vertical sync. */
 #define SCALE_FACTOR_DEFAULT           1.    /**< Default scale factor. */
 #define NEBULA_SCALE_FACTOR_DEFAULT    4.    /**< Default scale factor for nebula rendering. */
+#define RENDER_SCALE_DEFAULT           1.    /**< Default fraction of the resolution to render the world at. */
+#define NEBU_AUTOSCALE_DEFAULT         1     /**< Whether to automatically lower nebula resolution under load. */
+#define TEXTURE_CACHE_DEFAULT          256   /**< Default size of the unreferenced texture cache in MiB. */
 #define SHOW_FPS_DEFAULT               0     /**< Whether to display FPS on screen. */
 #define FPS_MAX_DEFAULT                60    /**< Maximum FPS. */
+#define FIXED_PHYSICS_DEFAULT          0     /**< Whether to decouple the simulation step from the frame rate. */
+#define RADAR_FPS_DEFAULT              10    /**< Default radar cache refresh rate. */
 #define SHOW_PAUSE_DEFAULT             1     /**< Whether to display pause status. */
 #define MINIMIZE_DEFAULT               1     /**< Whether to minimize on focus loss. */
 #define COLORBLIND_DEFAULT             0     /**< Whether to enable colorblindness simulation. */
@@ -87,6 +92,9 @@ typedef struct PlayerConf_s {
    int explicit_dim; /**< Dimension is explicit. */
    double scalefactor; /**< Amount to reduce resolution by. */
    double nebu_scale; /**< Downscaling factor for the expensively rendered nebula. */
+   double render_scale; /**< Fraction of the resolution to render the world at; GUI stays native. */
+   int nebu_autoscale; /**< Automatically step the nebula resolution down when over frame budget. */
+   int texture_cache; /**< MiB of unreferenced textures to keep resident (0 disables). */
    int fullscreen; /**< Whether or not game is fullscreen. */
    int modesetting; /**< Whether to use modesetting for fullscreen. */
    int notresizable; /**< Whether or not the window is resizable. */
@@ -108,6 +116,12 @@ typedef struct PlayerConf_s {
    /* FPS. */
    int fps_show; /**< Whether or not FPS should be shown */
    int fps_max; /**< Maximum FPS to limit to. */
+   int fps_pace; /**< Sleep the FPS-cap idle time before input sampling to cut latency. */
+   int fixed_physics; /**< Run the simulation at a fixed step decoupled from the frame rate. */
+   int radar_fps; /**< Rate the GUI radar contents are redrawn at (0 = every frame). */
+   int profiler; /**< Whether to collect and display per-subsystem frame timings. */
+   int benchmark; /**< Simulated seconds to run at fixed dt before quitting (0 = off, CLI only). */
+   int stats_port; /**< Local TCP port to publish runtime statistics on (0 = disabled). */
 
    /* Pause. */
    int pause_show; /**< Whether pause status should be shown. */
@@ -180,6 +194,15 @@ int conf_loadConfig( const char* file );
 void conf_parseCLI( int argc, char** argv );
 void conf_cleanup (void);
 
+/*
+ * Change notification. Fired after conf is modified in bulk (config file
+ * load, options apply/cancel) so subsystems can recompute derived values
+ * instead of rereading conf every frame.
+ */
+typedef void (*ConfChangeCallback) (void);
+void conf_addChangeListener( ConfChangeCallback cb );
+void conf_notifyChange (void);
+
 /*
  * Some handling.
  */
@@ -39,6 +39,7 @@
 #include "nlua_tk.h"
 #include "nluadef.h"
 #include "nstring.h"
+#include "opengl.h"
 #include "toolkit.h"
 
 #define BUTTON_WIDTH    50 /**< Button width. */
@@ -64,17 +65,37 @@ static glFont *cli_font     = NULL; /**< CLI font to use. */
 #define CLI_MAX_LINES (CLI_CONSOLE_HEIGHT/(cli_font->h+5)-2)
 static char **cli_buffer; /**< CLI buffer. */
 static char *cli_prompt; /**< Prompt string (allocated). */
+static char **cli_hist; /**< Command history, oldest first. */
 static int cli_history     = 0; /**< Position in history. */
 static int cli_scroll_pos  = -1; /**< Position in scrolling through output */
 static int cli_firstOpen   = 1; /**< First time opening. */
 static int cli_firstline   = 1; /**< Original CLI: Is this the first line? */
 
+/*
+ * History persistence.
+ */
+#define CLI_HISTORY_FILE   "console_history" /**< History file in the config dir. */
+#define CLI_HISTORY_MAX    500 /**< Commands kept across sessions. */
+
+/**
+ * @brief Sorted string keys of a Lua table, for completion queries.
+ */
+typedef struct CliCompTable_ {
+   const void *tab;  /**< Table identity the names were read from. */
+   char **names;     /**< Sorted array of the table's string keys. */
+} CliCompTable;
+static CliCompTable *cli_comp = NULL; /**< Completion index, invalidated on command execution. */
+
 /*
  * CLI stuff.
  */
 static int cli_script( lua_State *L );
+static int cli_capture( lua_State *L );
+static int cli_memstats( lua_State *L );
 static const luaL_Reg cli_methods[] = {
    { "script", cli_script },
+   { "capture", cli_capture },
+   { "memstats", cli_memstats },
    { "warn", cli_warn },
    {NULL, NULL}
 }; /**< Console only functions. */
@@ -89,6 +110,11 @@ static int cli_printCore( lua_State *L, int cli_only, int escape );
 static void cli_addMessage( const char *msg );
 static void cli_addMessageMax( const char *msg, const int l );
 void cli_tabComplete( unsigned int wid );
+static int cli_compCmp( const void *a, const void *b );
+static char **cli_compNames (void);
+static void cli_compClear (void);
+static void cli_historyLoad (void);
+static void cli_historySave (void);
 static int cli_initLua (void);
 
 static char* cli_escapeString( int *len_out, const char *s, int len )
@@ -236,6 +262,54 @@ static int cli_script( lua_State *L )
    return lua_gettop(L) - n;
 }
 
+/**
+ * @brief Toggles continuous frame capture.
+ *
+ * Frames are written as screenshots/captureNNN_FFFFFF.png; see
+ * gl_captureToggle().
+ */
+static int cli_capture( lua_State *L )
+{
+   (void) L;
+   if (gl_captureToggle())
+      cli_addMessage( _("#gCapture started.") );
+   else
+      cli_addMessage( _("Capture stopped.") );
+   return 0;
+}
+
+/**
+ * @brief Dumps live array allocation bytes by creating callsite.
+ *
+ * Shows the change since the previous dump next to each total, so two dumps
+ *  spaced across a long session point at whichever system keeps growing.
+ *  Only gathers data on debug builds.
+ *
+ * @luafunc memstats
+ */
+static int cli_memstats( lua_State *L )
+{
+   (void) L;
+   int n = array_tagCount();
+   if (n == 0) {
+      cli_addMessage( _("No allocation data; tracking requires a debug build.") );
+      return 0;
+   }
+   cli_addMessage( _("#n      live      growth  callsite#0") );
+   for (int i=0; i<n; i++) {
+      const char *tag;
+      size_t live;
+      ptrdiff_t growth;
+      char buf[STRMAX_SHORT];
+      if (array_tagStats( i, &tag, &live, &growth ))
+         continue;
+      snprintf( buf, sizeof(buf), "%10zu  %+10td  %s", live, growth, tag );
+      cli_addMessage( buf );
+   }
+   array_tagMark();
+   return 0;
+}
+
 /**
  * @brief Adds a message to the buffer.
  *
@@ -249,7 +323,6 @@ static void cli_addMessage( const char *msg )
       return;
    buf = strdup((msg != NULL) ? msg : "");
    array_grow(&cli_buffer) = buf;
-   cli_history = array_size(cli_buffer) - 1;
 }
 
 /**
@@ -266,7 +339,6 @@ static void cli_addMessageMax( const char *msg, const int l )
       return;
    buf = strndup((msg != NULL) ? msg : "", l);
    array_grow(&cli_buffer) = buf;
-   cli_history = array_size(cli_buffer) - 1;
 }
 
 /**
@@ -299,42 +371,23 @@ static int cli_keyhandler( unsigned int wid, SDL_Keycode key, SDL_Keymod mod )
 
       /* Go up in history. */
       case SDLK_UP:
-         for (int i=cli_history; i>=0; i--) {
-            if (strncmp(cli_buffer[i], "#C>", 3) == 0) {
-               /* Strip escape codes from beginning and end */
-               char *str = strndup(cli_buffer[i]+5, strlen(cli_buffer[i])-7);
-               if (i == cli_history &&
-                  strcmp(window_getInput(wid, "inpInput"), str) == 0) {
-                  free(str);
-                  continue;
-               }
-               window_setInput( wid, "inpInput", str );
-               free(str);
-               cli_history = i;
-               return 1;
-            }
+         if (cli_history > 0) {
+            cli_history--;
+            window_setInput( wid, "inpInput", cli_hist[cli_history] );
          }
          return 1;
 
       /* Go down in history. */
       case SDLK_DOWN:
-         /* Clears buffer. */
-         if (cli_history >= array_size(cli_buffer)-1) {
-            window_setInput( wid, "inpInput", NULL );
-            return 1;
+         if (cli_history < array_size(cli_hist)-1) {
+            cli_history++;
+            window_setInput( wid, "inpInput", cli_hist[cli_history] );
          }
-
-         /* Find next buffer. */
-         for (int i=cli_history+1; i<array_size(cli_buffer); i++) {
-            if (strncmp(cli_buffer[i], "#C>", 3) == 0) {
-               char *str = strndup(cli_buffer[i]+5, strlen(cli_buffer[i])-7);
-               window_setInput( wid, "inpInput", str );
-               free(str);
-               return 1;
-            }
+         else {
+            /* Clears buffer. */
+            cli_history = array_size(cli_hist);
+            window_setInput( wid, "inpInput", NULL );
          }
-         cli_history = array_size(cli_buffer)-1;
-         window_setInput( wid, "inpInput", NULL );
          return 1;
 
       /* Scroll up */
@@ -410,27 +463,134 @@ void cli_tabComplete( unsigned int wid )
    }
 
    if (strlen(cur) > 0) {
-      lua_pushnil(naevL);
-      while (lua_next(naevL, -2) != 0) {
-         if (lua_isstring(naevL, -2)) {
-            match = lua_tostring(naevL, -2);
-            if (strncmp(cur, match, strlen(cur)) == 0) {
-               new = malloc(strlen(old) + strlen(match) - strlen(cur) + 1);
-               strcpy(new, old);
-               strcat(new, match + strlen(cur));
-               window_setInput( wid, "inpInput", new);
-               free(new);
-               lua_pop(naevL, 2);
-               break;
-            }
-         }
-         lua_pop(naevL, 1);
+      /* Lower bound of the prefix in the sorted key names. */
+      char **names = cli_compNames();
+      int lo = 0, hi = array_size(names);
+      while (lo < hi) {
+         int mid = (lo + hi) / 2;
+         if (strcmp( names[mid], cur ) < 0)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      if ((lo < array_size(names)) &&
+            (strncmp(cur, names[lo], strlen(cur)) == 0)) {
+         match = names[lo];
+         new = malloc(strlen(old) + strlen(match) - strlen(cur) + 1);
+         strcpy(new, old);
+         strcat(new, match + strlen(cur));
+         window_setInput( wid, "inpInput", new);
+         free(new);
       }
    }
    free(str);
    lua_pop(naevL, 1);
 }
 
+/**
+ * @brief strcmp wrapper for sorting completion names.
+ */
+static int cli_compCmp( const void *a, const void *b )
+{
+   const char * const *sa = a;
+   const char * const *sb = b;
+   return strcmp( *sa, *sb );
+}
+
+/**
+ * @brief Gets the sorted string keys of the table on top of the Lua stack.
+ *
+ * Built once per table with lua_next and cached until the next command runs,
+ *  so repeated tab presses only binary search.
+ *
+ *    @return Array (array.h) of the table's keys, sorted.
+ */
+static char **cli_compNames (void)
+{
+   CliCompTable *ct;
+   const void *tab = lua_topointer( naevL, -1 );
+
+   for (int i=0; i<array_size(cli_comp); i++)
+      if (cli_comp[i].tab == tab)
+         return cli_comp[i].names;
+
+   if (cli_comp == NULL)
+      cli_comp = array_create( CliCompTable );
+   ct        = &array_grow( &cli_comp );
+   ct->tab   = tab;
+   ct->names = array_create( char* );
+   lua_pushnil(naevL);
+   while (lua_next(naevL, -2) != 0) {
+      if (lua_type(naevL, -2) == LUA_TSTRING)
+         array_push_back( &ct->names, strdup( lua_tostring(naevL, -2) ) );
+      lua_pop(naevL, 1);
+   }
+   qsort( ct->names, array_size(ct->names), sizeof(char*), cli_compCmp );
+   return ct->names;
+}
+
+/**
+ * @brief Invalidates the completion index.
+ */
+static void cli_compClear (void)
+{
+   for (int i=0; i<array_size(cli_comp); i++) {
+      for (int j=0; j<array_size(cli_comp[i].names); j++)
+         free( cli_comp[i].names[j] );
+      array_free( cli_comp[i].names );
+   }
+   array_free( cli_comp );
+   cli_comp = NULL;
+}
+
+/**
+ * @brief Loads the cross-session command history from the config dir.
+ */
+static void cli_historyLoad (void)
+{
+   char file[PATH_MAX], *buf, *l;
+   size_t len;
+
+   snprintf( file, sizeof(file), "%s"CLI_HISTORY_FILE, nfile_configPath() );
+   buf = nfile_readFile( &len, file );
+   if (buf == NULL)
+      return;
+   l = buf;
+   for (size_t i=0; i<len; i++) {
+      if (buf[i] != '\n')
+         continue;
+      buf[i] = '\0';
+      if (l[0] != '\0')
+         array_push_back( &cli_hist, strdup(l) );
+      l = &buf[i+1];
+   }
+   free(buf);
+   cli_history = array_size(cli_hist);
+}
+
+/**
+ * @brief Saves the last CLI_HISTORY_MAX commands to the config dir.
+ */
+static void cli_historySave (void)
+{
+   char file[PATH_MAX], *out;
+   int start;
+
+   if (cli_hist == NULL)
+      return;
+   start = MAX( 0, array_size(cli_hist) - CLI_HISTORY_MAX );
+   out   = array_create( char );
+   for (int i=start; i<array_size(cli_hist); i++) {
+      for (const char *c=cli_hist[i]; *c!='\0'; c++)
+         array_push_back( &out, *c );
+      array_push_back( &out, '\n' );
+   }
+   snprintf( file, sizeof(file), "%s"CLI_HISTORY_FILE, nfile_configPath() );
+   if (nfile_writeFile( out, array_size(out), file ) < 0)
+      WARN(_("Failed to write console history to '%s'."), file);
+   array_free( out );
+}
+
 static int cli_initLua (void)
 {
    int status;
@@ -502,6 +662,10 @@ int cli_init (void)
    /* Allocate the buffer. */
    cli_buffer = array_create(char*);
 
+   /* Load the cross-session history. */
+   cli_hist = array_create(char*);
+   cli_historyLoad();
+
    cli_initLua();
 
    return 0;
@@ -522,6 +686,14 @@ void cli_exit (void)
    free( cli_font );
    cli_font = NULL;
 
+   /* Save and free the history. */
+   cli_historySave();
+   for (int i=0; i<array_size(cli_hist); i++)
+      free(cli_hist[i]);
+   array_free(cli_hist);
+   cli_hist = NULL;
+   cli_compClear();
+
    /* Free the buffer. */
    for (int i=0; i<array_size(cli_buffer); i++)
       free(cli_buffer[i]);
@@ -562,6 +734,14 @@ static void cli_input( unsigned int wid, const char *unused )
    free(escaped);
    cli_printCoreString( buf, 0 );
 
+   /* Remember the command. */
+   if (str[0] != '\0') {
+      int n = array_size(cli_hist);
+      if ((n == 0) || (strcmp(cli_hist[n-1], str) != 0))
+         array_push_back( &cli_hist, strdup(str) );
+   }
+   cli_history = array_size(cli_hist);
+
    if (conf.lua_repl) {
       /* Resume the REPL. */
       lua_pushstring( cli_thread, str );
@@ -639,6 +819,9 @@ static void cli_input( unsigned int wid, const char *unused )
       }
    }
 
+   /* Commands can redefine anything; drop the completion index. */
+   cli_compClear();
+
    /* Clear the box now. */
    window_setInput( wid, "inpInput", NULL );
 
@@ -0,0 +1,273 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file dev_graph.c
+ *
+ * @brief Exports the linked system graph as a flat binary for external tools.
+ *
+ * The export covers the data out-of-band tooling otherwise has to scrape out
+ *  of the ssys XML: systems and their positions, jump edges, spobs with their
+ *  presences, accumulated system presences and the calculated safe lanes.
+ *
+ * Format (version 1): everything is little-endian; offsets are from the start
+ *  of the file and sections are 8-byte aligned with fixed-size records, so a
+ *  reader can mmap the file and index sections directly. Strings live in a
+ *  table at the end of the file and records refer to them by byte offset into
+ *  that table; offset 0 is always the empty string.
+ *
+ *   header:    "NGPH", u32 version, u32 nsystems, u32 njumps, u32 nspobs,
+ *              u32 npresences, u32 nlanes, u32 osystems, u32 ojumps,
+ *              u32 ospobs, u32 opresences, u32 olanes, u32 ostrings,
+ *              u32 strings_size
+ *   system:    u32 name, u32 pad, f64 x, f64 y, f64 radius
+ *   jump:      u32 from, u32 to, u32 flags, u32 pad, f64 hide
+ *   spob:      u32 id, u32 system, u32 name, u32 faction, u32 range,
+ *              u32 pad, f64 x, f64 y, f64 base, f64 bonus
+ *   presence:  u32 system, u32 faction, f64 base, f64 bonus
+ *   lane:      u32 system, u32 faction, u32 type[2], u32 id[2]
+ *
+ * Systems and spobs appear in id order so the u32 ids double as record
+ *  indices; lane endpoint types and ids are as safelanes_get() reports them.
+ */
+/** @cond */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "dev_graph.h"
+
+#include "array.h"
+#include "conf.h"
+#include "faction.h"
+#include "log.h"
+#include "safelanes.h"
+#include "space.h"
+
+#define DGRAPH_VERSION  1  /**< Current version of the export format. */
+
+#define DGRAPH_HEADER_SIZE    56 /**< Size of the file header. */
+#define DGRAPH_SYSTEM_SIZE    32 /**< Size of a system record. */
+#define DGRAPH_JUMP_SIZE      24 /**< Size of a jump record. */
+#define DGRAPH_SPOB_SIZE      56 /**< Size of a spob record. */
+#define DGRAPH_PRESENCE_SIZE  24 /**< Size of a presence record. */
+#define DGRAPH_LANE_SIZE      24 /**< Size of a lane record. */
+
+/*
+ * Prototypes.
+ */
+static void dgraph_wu32( FILE *f, uint32_t v );
+static void dgraph_wf64( FILE *f, double v );
+static uint32_t dgraph_addStr( char **tab, const char *s );
+static uint32_t dgraph_addFaction( char **tab, int f );
+
+/**
+ * @brief Writes a little-endian 32 bit integer.
+ */
+static void dgraph_wu32( FILE *f, uint32_t v )
+{
+   for (int i=0; i<4; i++)
+      fputc( (v >> (8*i)) & 0xFF, f );
+}
+
+/**
+ * @brief Writes a little-endian IEEE 754 double.
+ */
+static void dgraph_wf64( FILE *f, double v )
+{
+   uint64_t u;
+   memcpy( &u, &v, sizeof(u) );
+   for (int i=0; i<8; i++)
+      fputc( (u >> (8*i)) & 0xFF, f );
+}
+
+/**
+ * @brief Appends a string to the string table.
+ *
+ *    @param tab String table (array.h of char).
+ *    @param s String to add, NULL counts as empty.
+ *    @return Byte offset of the string in the table.
+ */
+static uint32_t dgraph_addStr( char **tab, const char *s )
+{
+   uint32_t off;
+   if ((s == NULL) || (s[0] == '\0'))
+      return 0; /* Table starts with the empty string. */
+   off = (uint32_t)array_size( *tab );
+   for (const char *c=s; *c!='\0'; c++)
+      array_push_back( tab, *c );
+   array_push_back( tab, '\0' );
+   return off;
+}
+
+/**
+ * @brief Adds a faction's name to the string table, empty when invalid.
+ */
+static uint32_t dgraph_addFaction( char **tab, int f )
+{
+   if (!faction_isFaction(f))
+      return 0;
+   return dgraph_addStr( tab, faction_name(f) );
+}
+
+/**
+ * @brief Exports the system graph, presences and safe lanes as a binary file.
+ *
+ * Writes "universe.graph" into the system save path (conf.dev_save_sys).
+ *
+ *    @return 0 on success.
+ */
+int dgraph_save (void)
+{
+   char *file, *tab;
+   FILE *f;
+   StarSystem *sys_stack = system_getAll();
+   uint32_t nsystems, njumps, nspobs, npresences, nlanes;
+   uint32_t osystems, ojumps, ospobs, opresences, olanes, ostrings;
+   SafeLane **lanes;
+
+   /* Count everything up front so the header offsets can be computed. */
+   nsystems   = (uint32_t)array_size( sys_stack );
+   njumps     = 0;
+   nspobs     = 0;
+   npresences = 0;
+   nlanes     = 0;
+   lanes      = malloc( nsystems * sizeof(SafeLane*) );
+   for (uint32_t i=0; i<nsystems; i++) {
+      const StarSystem *sys = &sys_stack[i];
+      njumps     += (uint32_t)array_size( sys->jumps );
+      nspobs     += (uint32_t)array_size( sys->spobs );
+      npresences += (uint32_t)array_size( sys->presence );
+      if (safelanes_calculated()) {
+         lanes[i] = safelanes_get( -1, 0, sys );
+         nlanes  += (uint32_t)array_size( lanes[i] );
+      }
+      else
+         lanes[i] = NULL;
+   }
+
+   osystems   = DGRAPH_HEADER_SIZE;
+   ojumps     = osystems   + nsystems   * DGRAPH_SYSTEM_SIZE;
+   ospobs     = ojumps     + njumps     * DGRAPH_JUMP_SIZE;
+   opresences = ospobs     + nspobs     * DGRAPH_SPOB_SIZE;
+   olanes     = opresences + npresences * DGRAPH_PRESENCE_SIZE;
+   ostrings   = olanes     + nlanes     * DGRAPH_LANE_SIZE;
+
+   asprintf( &file, "%s/universe.graph", conf.dev_save_sys );
+   f = fopen( file, "wb" );
+   if (f == NULL) {
+      WARN("Failed writing '%s'!", file);
+      for (uint32_t i=0; i<nsystems; i++)
+         array_free( lanes[i] );
+      free( lanes );
+      free( file );
+      return -1;
+   }
+
+   /* The string table accumulates while the records get written. */
+   tab = array_create( char );
+   array_push_back( &tab, '\0' ); /* Offset 0 is the empty string. */
+
+   /* Header. */
+   fputs( "NGPH", f );
+   dgraph_wu32( f, DGRAPH_VERSION );
+   dgraph_wu32( f, nsystems );
+   dgraph_wu32( f, njumps );
+   dgraph_wu32( f, nspobs );
+   dgraph_wu32( f, npresences );
+   dgraph_wu32( f, nlanes );
+   dgraph_wu32( f, osystems );
+   dgraph_wu32( f, ojumps );
+   dgraph_wu32( f, ospobs );
+   dgraph_wu32( f, opresences );
+   dgraph_wu32( f, olanes );
+   dgraph_wu32( f, ostrings );
+   dgraph_wu32( f, 0 ); /* strings_size gets patched in at the end. */
+
+   /* Systems. */
+   for (uint32_t i=0; i<nsystems; i++) {
+      const StarSystem *sys = &sys_stack[i];
+      dgraph_wu32( f, dgraph_addStr( &tab, sys->name ) );
+      dgraph_wu32( f, 0 );
+      dgraph_wf64( f, sys->pos.x );
+      dgraph_wf64( f, sys->pos.y );
+      dgraph_wf64( f, sys->radius );
+   }
+
+   /* Jump edges. */
+   for (uint32_t i=0; i<nsystems; i++) {
+      const StarSystem *sys = &sys_stack[i];
+      for (int j=0; j<array_size(sys->jumps); j++) {
+         const JumpPoint *jp = &sys->jumps[j];
+         dgraph_wu32( f, i );
+         dgraph_wu32( f, (uint32_t)jp->targetid );
+         dgraph_wu32( f, jp->flags );
+         dgraph_wu32( f, 0 );
+         dgraph_wf64( f, jp->hide );
+      }
+   }
+
+   /* Spobs with their presences. */
+   for (uint32_t i=0; i<nsystems; i++) {
+      const StarSystem *sys = &sys_stack[i];
+      for (int j=0; j<array_size(sys->spobs); j++) {
+         const Spob *p = sys->spobs[j];
+         dgraph_wu32( f, (uint32_t)p->id );
+         dgraph_wu32( f, i );
+         dgraph_wu32( f, dgraph_addStr( &tab, p->name ) );
+         dgraph_wu32( f, dgraph_addFaction( &tab, p->presence.faction ) );
+         dgraph_wu32( f, (uint32_t)p->presence.range );
+         dgraph_wu32( f, 0 );
+         dgraph_wf64( f, p->pos.x );
+         dgraph_wf64( f, p->pos.y );
+         dgraph_wf64( f, p->presence.base );
+         dgraph_wf64( f, p->presence.bonus );
+      }
+   }
+
+   /* Accumulated system presences. */
+   for (uint32_t i=0; i<nsystems; i++) {
+      const StarSystem *sys = &sys_stack[i];
+      for (int j=0; j<array_size(sys->presence); j++) {
+         const SystemPresence *sp = &sys->presence[j];
+         dgraph_wu32( f, i );
+         dgraph_wu32( f, dgraph_addFaction( &tab, sp->faction ) );
+         dgraph_wf64( f, sp->base );
+         dgraph_wf64( f, sp->bonus );
+      }
+   }
+
+   /* Safe lanes. */
+   for (uint32_t i=0; i<nsystems; i++) {
+      for (int j=0; j<array_size(lanes[i]); j++) {
+         const SafeLane *l = &lanes[i][j];
+         dgraph_wu32( f, i );
+         dgraph_wu32( f, dgraph_addFaction( &tab, l->faction ) );
+         dgraph_wu32( f, (uint32_t)l->point_type[0] );
+         dgraph_wu32( f, (uint32_t)l->point_type[1] );
+         dgraph_wu32( f, (uint32_t)l->point_id[0] );
+         dgraph_wu32( f, (uint32_t)l->point_id[1] );
+      }
+      array_free( lanes[i] );
+   }
+   free( lanes );
+
+   /* String table. */
+   fwrite( tab, 1, array_size(tab), f );
+
+   /* Patch the string table size into the header. */
+   fseek( f, DGRAPH_HEADER_SIZE - 4, SEEK_SET );
+   dgraph_wu32( f, (uint32_t)array_size(tab) );
+
+   fclose( f );
+   DEBUG( _("Exported system graph to '%s'."), file );
+
+   array_free( tab );
+   free( file );
+
+   return 0;
+}
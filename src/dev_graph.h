@@ -0,0 +1,6 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+int dgraph_save (void);
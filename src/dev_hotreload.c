@@ -0,0 +1,100 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file dev_hotreload.c
+ *
+ * @brief Polls watched script sources and reloads them in place (devmode).
+ *
+ * Only runs with conf.devmode set. The AI profiles are the scripts that
+ *  cache compiled state (ai.c keeps their environments and function
+ *  references for the lifetime of the process), so editing them normally
+ *  requires a restart; the watcher polls their modification times once a
+ *  second and calls ai_reload() when anything changed. Mission and event
+ *  sources are read from disk each time an instance starts, so edits to
+ *  those are picked up without any help from here.
+ */
+/** @cond */
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "dev_hotreload.h"
+
+#include "ai.h"
+#include "conf.h"
+#include "log.h"
+#include "ndata.h"
+
+#define DEVHOT_POLL_INTERVAL  1. /**< Seconds between modification time scans. */
+
+static double devhot_accum = 0.; /**< Time since the last scan. */
+static PHYSFS_sint64 devhot_ai_mtime = -1; /**< Latest AI file modification time seen. */
+
+/*
+ * Prototypes.
+ */
+static PHYSFS_sint64 devhot_scanDir( const char *dir, const char *suffix );
+
+/**
+ * @brief Gets the latest modification time of matching files in a directory.
+ *
+ *    @param dir PhysicsFS directory to scan.
+ *    @param suffix File suffix to match.
+ *    @return Latest modification time or 0 when nothing matched.
+ */
+static PHYSFS_sint64 devhot_scanDir( const char *dir, const char *suffix )
+{
+   char **files = PHYSFS_enumerateFiles( dir );
+   PHYSFS_sint64 latest = 0;
+   size_t suflen = strlen( suffix );
+
+   for (size_t i=0; files[i]!=NULL; i++) {
+      char path[PATH_MAX];
+      PHYSFS_Stat stat;
+      size_t flen = strlen( files[i] );
+      if ((flen <= suflen) || strcmp( &files[i][flen-suflen], suffix ))
+         continue;
+      snprintf( path, sizeof(path), "%s%s", dir, files[i] );
+      if (!PHYSFS_stat( path, &stat ))
+         continue;
+      if (stat.modtime > latest)
+         latest = stat.modtime;
+   }
+   PHYSFS_freeList( files );
+
+   return latest;
+}
+
+/**
+ * @brief Checks the watched sources and hot-reloads what changed.
+ *
+ * Meant to be called every frame; scans at most once per
+ *  DEVHOT_POLL_INTERVAL and does nothing outside devmode.
+ *
+ *    @param dt Real elapsed time in seconds.
+ */
+void devhot_update( double dt )
+{
+   PHYSFS_sint64 mtime;
+
+   if (!conf.devmode)
+      return;
+
+   devhot_accum += dt;
+   if (devhot_accum < DEVHOT_POLL_INTERVAL)
+      return;
+   devhot_accum = 0.;
+
+   mtime = devhot_scanDir( AI_PATH, ".lua" );
+   if (devhot_ai_mtime < 0)
+      devhot_ai_mtime = mtime; /* Baseline on the first scan. */
+   else if (mtime > devhot_ai_mtime) {
+      devhot_ai_mtime = mtime;
+      if (ai_reload() == 0)
+         DEBUG( _("Hot-reloaded AI profiles.") );
+      else
+         WARN( _("AI profile hot-reload failed; see above.") );
+   }
+}
@@ -0,0 +1,6 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+void devhot_update( double dt );
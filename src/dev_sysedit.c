@@ -761,7 +761,7 @@ static void sysedit_render( double bx, double by, double w, double h, void *data
       rh = 9.;
 
       /* Render. */
-      glUseProgram(shaders.safelane.program);
+      gl_useProgram(shaders.safelane.program);
       gl_renderShader( (x1+x2)/2., (y1+y2)/2., rw, rh, r, &shaders.safelane, &col, 1 );
    }
 
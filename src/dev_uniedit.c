@@ -16,6 +16,7 @@
 
 #include "array.h"
 #include "conf.h"
+#include "dev_graph.h"
 #include "dev_spob.h"
 #include "dev_sysedit.h"
 #include "dev_system.h"
@@ -319,6 +320,7 @@ static void uniedit_save( unsigned int wid_unused, const char *unused )
 
    dsys_saveAll();
    dpl_saveAll();
+   dgraph_save();
 }
 
 /*
@@ -513,7 +515,7 @@ static void uniedit_renderFactionDisks( double x, double y, double r )
       /* draws the disk representing the faction */
       sr = 0.5*M_PI*sqrt(presence) * uniedit_zoom;
 
-      //glUseProgram(shaders.factiondisk.program);
+      //gl_useProgram(shaders.factiondisk.program);
       //glUniform1f(shaders.factiondisk.paramf, r / sr );
       //gl_renderShader( tx, ty, sr, sr, 0., &shaders.factiondisk, &c, 1 );
       (void) r;
@@ -730,7 +732,7 @@ static void uniedit_render( double bx, double by, double w, double h, void *data
    /* Render the selected system selections. */
    for (int i=0; i<array_size(uniedit_sys); i++) {
       StarSystem *sys = uniedit_sys[i];
-      glUseProgram( shaders.selectspob.program );
+      gl_useProgram( shaders.selectspob.program );
       glUniform1f( shaders.selectspob.dt, uniedit_dt );
       gl_renderShader( x + sys->pos.x * uniedit_zoom, y + sys->pos.y * uniedit_zoom,
             1.5*r, 1.5*r, 0., &shaders.selectspob, &cWhite, 1 );
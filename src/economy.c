@@ -27,6 +27,7 @@
 
 #include "array.h"
 #include "log.h"
+#include "map.h"
 #include "ndata.h"
 #include "nstring.h"
 #include "ntime.h"
@@ -57,9 +58,29 @@ extern Commodity* commodity_stack;
  */
 static int econ_initialized   = 0; /**< Is economy system initialized? */
 static int econ_queued        = 0; /**< Whether there are any queued updates. */
+static int econ_prices_dirty  = 0; /**< Whether commodity prices must be recomputed before use. */
 static cs *econ_G             = NULL; /**< Admittance matrix. */
 int *econ_comm         = NULL; /**< Commodities to calculate. */
 
+/*
+ * Dynamic trade shifts. Player trading pushes a relative price shift on
+ * the local system which then diffuses along jump routes and decays back
+ * to the baseline, one tick per in-game period (same scheme as the
+ * worldsim presence tier). Queries just scale the sinusoidal price by the
+ * system's shift, so the per-tick cost is O(jumps * commodities) and the
+ * query cost is unchanged.
+ */
+#define ECON_SIM_TICK      ntime_create( 0, 1, 0 ) /**< One period per tick. */
+#define ECON_SIM_MAX_CATCHUP 32 /**< Ticks to run at once before saturating. */
+#define ECON_SIM_MAX       0.3   /**< Maximum relative price shift. */
+#define ECON_SIM_SPILL     0.05  /**< Per-tick pull towards neighbouring shifts. */
+#define ECON_SIM_DECAY     0.02  /**< Per-tick relaxation back to baseline. */
+#define ECON_SIM_TRADE     0.001 /**< Shift per tonne bought (negative when sold). */
+static double *econ_shift  = NULL; /**< Current shifts, nsystems * ncommodities. */
+static double *econ_dshift = NULL; /**< Scratch for the two-pass tick. */
+static int econ_shift_n    = 0;    /**< Allocated size of the shift tables. */
+static ntime_t econ_sim_accum = 0; /**< Time not yet simulated. */
+
 /*
  * Prototypes.
  */
@@ -67,6 +88,10 @@ int *econ_comm         = NULL; /**< Commodities to calculate. */
 //static double econ_calcJumpR( StarSystem *A, StarSystem *B );
 //static double econ_calcSysI( unsigned int dt, StarSystem *sys, int price );
 //static int econ_createGMatrix (void);
+static void economy_checkPrices (void);
+static void economy_simAlloc (void);
+static void economy_simTick (void);
+static int econ_commIndex( const Commodity *com );
 
 /*
  * Externed prototypes.
@@ -82,6 +107,29 @@ int economy_sysLoad( xmlNodePtr parent );
  *    @param p Spob to get price of commodity.
  *    @return The price of the commodity.
  */
+/**
+ * @brief Marks the commodity prices as in need of recomputation.
+ *
+ * Used when a diff changes price-relevant universe state; the actual
+ * recompute is deferred until the next price query instead of redoing
+ * the whole universe per applied diff.
+ */
+void economy_invalidatePrices (void)
+{
+   econ_prices_dirty = 1;
+   map_commodCacheInvalidate();
+}
+
+/**
+ * @brief Recomputes the commodity prices if they have been invalidated.
+ */
+static void economy_checkPrices (void)
+{
+   if (!econ_prices_dirty)
+      return;
+   economy_initialiseCommodityPrices();
+}
+
 credits_t economy_getPrice( const Commodity *com,
       const StarSystem *sys, const Spob *p )
 {
@@ -101,12 +149,14 @@ credits_t economy_getPrice( const Commodity *com,
 credits_t economy_getPriceAtTime( const Commodity *com,
       const StarSystem *sys, const Spob *p, ntime_t tme )
 {
-   (void) sys;
-   int i, k;
+   int i, ec;
    double price;
    double t;
    CommodityPrice *commPrice;
 
+   /* Recompute lazily if a diff invalidated the prices. */
+   economy_checkPrices();
+
    /* If commodity is using a reference, just return that. */
    if (com->price_ref != NULL) {
       const Commodity *ref = commodity_get( com->price_ref );
@@ -126,16 +176,9 @@ credits_t economy_getPriceAtTime( const Commodity *com,
     * Journey with a single jump takes approx 3e7, so about 3 periods. */
    t = ntime_convertSeconds( tme ) / NT_PERIOD_SECONDS;
 
-   /* Get position in stack. */
-   k = com - commodity_stack;
-
    /* Find what commodity that is. */
-   for (i=0; i<array_size(econ_comm); i++)
-      if (econ_comm[i] == k)
-         break;
-
-   /* Check if found. */
-   if (i >= array_size(econ_comm)) {
+   ec = econ_commIndex( com );
+   if (ec < 0) {
       WARN(_("Price for commodity '%s' not known."), com->name);
       return 0;
    }
@@ -157,9 +200,29 @@ credits_t economy_getPriceAtTime( const Commodity *com,
          * sin(2. * M_PI * t / commPrice->sysPeriod)
          + commPrice->spobVariation
          * sin(2. * M_PI * t / commPrice->spobPeriod));
+
+   /* Apply the system's dynamic trade shift. */
+   if ((econ_shift != NULL) && (sys != NULL))
+      price *= 1. + econ_shift[ sys->id * array_size(econ_comm) + ec ];
+
    return (credits_t) (price+0.5);/* +0.5 to round */
 }
 
+/**
+ * @brief Gets the index of a commodity in the traded commodity list.
+ *
+ *    @param com Commodity to look up.
+ *    @return Index into econ_comm or -1 when not traded.
+ */
+static int econ_commIndex( const Commodity *com )
+{
+   int k = com - commodity_stack;
+   for (int i=0; i<array_size(econ_comm); i++)
+      if (econ_comm[i] == k)
+         return i;
+   return -1;
+}
+
 /**
  * @brief Gets the average price of a good on a spob in a system, using a rolling average over the times the player has landed here.
  *
@@ -458,6 +521,9 @@ int economy_init (void)
       systems_stack[i].prices = calloc(array_size(econ_comm), sizeof(double));
    }
 
+   /* Allocate the dynamic trade shifts. */
+   economy_simAlloc();
+
    /* Mark economy as initialized. */
    econ_initialized = 1;
 
@@ -502,12 +568,88 @@ int economy_refresh (void)
    //if (econ_createGMatrix())
    //   return -1;
 
+   /* The universe may have changed shape under the shift tables. */
+   economy_simAlloc();
+
    /* Initialize the prices. */
    economy_update( 0 );
 
    return 0;
 }
 
+/**
+ * @brief (Re)allocates the dynamic trade shift tables.
+ *
+ * Existing shifts are dropped when the universe changes size; that only
+ *  happens from the editors and diffs that rebuild systems anyway.
+ */
+static void economy_simAlloc (void)
+{
+   int n = array_size(systems_stack) * array_size(econ_comm);
+   if ((econ_shift != NULL) && (n == econ_shift_n))
+      return;
+   free( econ_shift );
+   free( econ_dshift );
+   econ_shift   = calloc( n, sizeof(double) );
+   econ_dshift  = calloc( n, sizeof(double) );
+   econ_shift_n = n;
+}
+
+/**
+ * @brief Advances the trade shift diffusion by one tick.
+ *
+ * Two passes so the update order doesn't bias the diffusion: shifts pull
+ *  towards the mean of the jump-connected systems and decay towards the
+ *  baseline.
+ */
+static void economy_simTick (void)
+{
+   int ncomm = array_size(econ_comm);
+   for (int i=0; i<array_size(systems_stack); i++) {
+      const StarSystem *sys = &systems_stack[i];
+      for (int j=0; j<ncomm; j++) {
+         double cur = econ_shift[ i*ncomm + j ];
+         double mean = 0.;
+         int n = 0;
+         for (int k=0; k<array_size(sys->jumps); k++) {
+            mean += econ_shift[ sys->jumps[k].targetid * ncomm + j ];
+            n++;
+         }
+         if (n > 0)
+            mean /= (double)n;
+         econ_dshift[ i*ncomm + j ] = ECON_SIM_SPILL * (mean - cur)
+               - ECON_SIM_DECAY * cur;
+      }
+   }
+   for (int i=0; i<econ_shift_n; i++)
+      econ_shift[i] = CLAMP( -ECON_SIM_MAX, ECON_SIM_MAX,
+            econ_shift[i] + econ_dshift[i] );
+}
+
+/**
+ * @brief Applies the local price effect of a trade.
+ *
+ * Buying drives the local price up, selling drives it down; the shift
+ *  then diffuses to neighbouring systems over the following ticks.
+ *
+ *    @param sys System the trade happened in.
+ *    @param com Commodity traded.
+ *    @param q Tonnes bought (negative when sold).
+ */
+void economy_tradeModify( const StarSystem *sys, const Commodity *com, int q )
+{
+   int ec;
+   double *shift;
+   if ((econ_shift == NULL) || (sys == NULL))
+      return;
+   ec = econ_commIndex( com );
+   if (ec < 0)
+      return; /* Mission cargo and the likes. */
+   shift = &econ_shift[ sys->id * array_size(econ_comm) + ec ];
+   *shift = CLAMP( -ECON_SIM_MAX, ECON_SIM_MAX,
+         *shift + (double)q * ECON_SIM_TRADE );
+}
+
 /**
  * @brief Updates the economy.
  *
@@ -515,7 +657,25 @@ int economy_refresh (void)
  */
 int economy_update( unsigned int dt )
 {
-   (void)dt;
+   int ticks;
+
+   /* Economy must be initialized. */
+   if (econ_initialized == 0) {
+      econ_queued = 0;
+      return 0;
+   }
+
+   /* Advance the trade shift diffusion, one tick per period. */
+   econ_sim_accum += (ntime_t)dt;
+   ticks = 0;
+   while ((econ_sim_accum >= ECON_SIM_TICK) && (ticks < ECON_SIM_MAX_CATCHUP)) {
+      economy_simTick();
+      econ_sim_accum -= ECON_SIM_TICK;
+      ticks++;
+   }
+   if (ticks >= ECON_SIM_MAX_CATCHUP)
+      econ_sim_accum = 0; /* Saturated on a huge time skip. */
+
 #if 0
    int i, j;
    double *X;
@@ -606,6 +766,14 @@ void economy_destroy (void)
    cs_spfree( econ_G );
    econ_G = NULL;
 
+   /* Destroy the trade shifts. */
+   free( econ_shift );
+   free( econ_dshift );
+   econ_shift   = NULL;
+   econ_dshift  = NULL;
+   econ_shift_n = 0;
+   econ_sim_accum = 0;
+
    /* Economy is now deinitialized. */
    econ_initialized = 0;
 }
@@ -862,6 +1030,10 @@ void economy_initialiseCommodityPrices(void)
    StarSystem *sys;
    Commodity *com;
    CommodityModifier *this, *next;
+
+   /* Prices are being recomputed, so they are no longer dirty. */
+   econ_prices_dirty = 0;
+
    /* First use spob attributes to set prices and variability */
    for (k=0; k<array_size(systems_stack); k++) {
       sys = &systems_stack[k];
@@ -941,6 +1113,7 @@ void economy_averageSeenPrices( const Spob *p )
          cp->sum2 += price*price;
       }
    }
+   map_commodCacheInvalidate();
 }
 
 void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate )
@@ -958,6 +1131,7 @@ void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate )
          cp->sum2 += price*price;
       }
    }
+   map_commodCacheInvalidate();
 }
 
 /**
@@ -1057,6 +1231,24 @@ int economy_sysLoad( xmlNodePtr parent )
                   c->lastPurchasePrice = xml_getLong(cur);
                   free(str);
                }
+            } else if (xml_isNode(cur, "shift")) {
+               const StarSystem *sys;
+               const Commodity *com;
+               int ec;
+               if (econ_shift == NULL)
+                  continue;
+               xmlr_attr_strd(cur, "system", str);
+               sys = (str != NULL) ? system_get(str) : NULL;
+               free(str);
+               xmlr_attr_strd(cur, "commodity", str);
+               com = (str != NULL) ? commodity_get(str) : NULL;
+               free(str);
+               if ((sys == NULL) || (com == NULL))
+                  continue;
+               ec = econ_commIndex( com );
+               if (ec < 0)
+                  continue;
+               econ_shift[ sys->id * array_size(econ_comm) + ec ] = xml_getFloat(cur);
             }
          } while (xml_nextNode(cur));
       }
@@ -1116,6 +1308,23 @@ int economy_sysSave( xmlTextWriterPtr writer )
       if (doneSys==1)
          xmlw_endElem(writer); /* system */
    }
+   /* Save the dynamic trade shifts. */
+   for (int i=0; i<array_size(systems_stack); i++) {
+      const StarSystem *sys = &systems_stack[i];
+      for (int j=0; j<array_size(econ_comm); j++) {
+         double shift;
+         if (econ_shift == NULL)
+            break;
+         shift = econ_shift[ sys->id * array_size(econ_comm) + j ];
+         if (fabs(shift) < 1e-4)
+            continue;
+         xmlw_startElem(writer, "shift");
+         xmlw_attr(writer,"system","%s",sys->name);
+         xmlw_attr(writer,"commodity","%s",commodity_stack[ econ_comm[j] ].name);
+         xmlw_str(writer,"%f",shift);
+         xmlw_endElem(writer); /* shift */
+      }
+   }
    xmlw_endElem(writer); /* economy */
    return 0;
 }
@@ -30,10 +30,12 @@ void economy_averageSeenPrices( const Spob *p );
 void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate );
 credits_t economy_getPrice( const Commodity *com, const StarSystem *sys, const Spob *p );
 credits_t economy_getPriceAtTime( const Commodity *com, const StarSystem *sys, const Spob *p, ntime_t t );
+void economy_tradeModify( const StarSystem *sys, const Commodity *com, int q );
 
 /*
  * Calculating the sinusoidal economy values
  */
 void economy_initialiseCommodityPrices(void);
+void economy_invalidatePrices (void);
 int economy_getAveragePrice( const Commodity *com, credits_t *mean, double *std );
 void economy_initialiseSingleSystem( StarSystem *sys, Spob *spob );
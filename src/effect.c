@@ -81,7 +81,7 @@ static int effect_parse( EffectData *efx, const char *file )
       xmlr_int(node, "priority", efx->priority);
       xmlr_float(node, "duration", efx->duration);
       if (xml_isNode(node,"icon")) {
-         efx->icon = xml_parseTexture( node, "%s", 1, 1, OPENGL_TEX_MIPMAPS );
+         efx->icon = xml_parseTexture( node, "%s", 1, 1, OPENGL_TEX_MIPMAPS | OPENGL_TEX_ATLAS );
          continue;
       }
       if (xml_isNode(node,"shader")) {
@@ -496,7 +496,7 @@ static void equipment_renderColumn( double x, double y, double w, double h,
             (lst[i].sslot->slot.type == o->slot.type)) {
          /* Render a thick frame with a yes/no color, and geometric cue. */
          int ok = (!lst[i].sslot->locked && pilot_canEquip( p, &lst[i], o ) == NULL);
-         glUseProgram( shaders.status.program );
+         gl_useProgram( shaders.status.program );
          glUniform1f( shaders.status.paramf, ok );
          gl_renderShader( x, y, w, h, 0., &shaders.status, NULL, 0 );
       }
@@ -775,6 +775,16 @@ static void equipment_renderOverlayColumn( double x, double y, double h,
  *    @param bh Height of the widget.
  *    @param data Custom widget data.
  */
+/*
+ * Hover alt-text memoization: the overlay regenerated the outfit
+ * description (outfit_altText() walks the whole stat list) every rendered
+ * frame while the mouse sat on a slot. The text only depends on the slot
+ * and its outfit, so it is rebuilt just when those change.
+ */
+static const PilotOutfitSlot *eq_altSlot = NULL; /**< Slot the cached text is for. */
+static const Outfit *eq_altOutfit = NULL; /**< Outfit the cached text is for. */
+static char eq_altText[STRMAX]; /**< Cached hover text. */
+
 static void equipment_renderOverlaySlots( double bx, double by, double bw, double bh,
       void *data )
 {
@@ -866,16 +876,20 @@ static void equipment_renderOverlaySlots( double bx, double by, double bw, doubl
    /* Get text. */
    if (o->desc_short == NULL)
       return;
-   outfit_altText( alt, sizeof(alt), o );
-
-   /* Display temporary bonuses. */
-   if (slot->lua_mem != LUA_NOREF) {
-      slen = strlen(alt);
-      ss_statsDesc( &slot->lua_stats, &alt[slen], sizeof(alt)-slen, 1 );
+   if ((slot != eq_altSlot) || (o != eq_altOutfit)) {
+      eq_altSlot   = slot;
+      eq_altOutfit = o;
+      scnprintf( eq_altText, sizeof(eq_altText), "%s", outfit_altTextCached( o ) );
+
+      /* Display temporary bonuses. */
+      if (slot->lua_mem != LUA_NOREF) {
+         slen = strlen(eq_altText);
+         ss_statsDesc( &slot->lua_stats, &eq_altText[slen], sizeof(eq_altText)-slen, 1 );
+      }
    }
 
    /* Draw the text. */
-   toolkit_drawAltText( bx + wgt->altx, by + wgt->alty, alt );
+   toolkit_drawAltText( bx + wgt->altx, by + wgt->alty, eq_altText );
 }
 
 /**
@@ -960,7 +974,7 @@ static void equipment_renderShip( double bx, double by,
       v.y *= ph / p->ship->gfx_space->sh;
 
       /* Render it. */
-      glUseProgram(shaders.crosshairs.program);
+      gl_useProgram(shaders.crosshairs.program);
       glUniform1f(shaders.crosshairs.paramf, 2.);
       gl_renderShader( px+v.x, py+v.y, 7., 7., 0., &shaders.crosshairs, &cRadar_player, 1 );
    }
@@ -1235,6 +1249,10 @@ static int equipment_swapSlot( unsigned int wid, Pilot *p, PilotOutfitSlot *slot
  */
 void equipment_regenLists( unsigned int wid, int outfits, int ships )
 {
+   /* Slot contents may have moved under the memoized hover text. */
+   eq_altSlot   = NULL;
+   eq_altOutfit = NULL;
+
    int nship, noutfit;
    double offship, offoutfit;
    char *selship;
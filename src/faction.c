@@ -8,6 +8,7 @@
  */
 /** @cond */
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "naev.h"
@@ -20,6 +21,7 @@
 #include "colour.h"
 #include "hook.h"
 #include "log.h"
+#include "map.h"
 #include "ndata.h"
 #include "nlua.h"
 #include "nluadef.h"
@@ -104,9 +106,34 @@ typedef struct Faction_ {
 } Faction;
 
 static Faction* faction_stack = NULL; /**< Faction stack. */
-static int* faction_grid = NULL; /**< Grid of faction status. */
+
+/*
+ * Faction ids are indices into faction_stack, so the stack itself can
+ * never be sorted by name. Name lookups instead go through a side index
+ * of stack positions sorted by name, rebuilt lazily whenever the stack
+ * changes (load, dynamic factions).
+ */
+static int *faction_sorted = NULL; /**< Array (array.h): stack indices sorted by name. */
+static int faction_sorted_dirty = 1; /**< Whether the sorted index needs a rebuild. */
+static int8_t* faction_grid = NULL; /**< Grid of faction status; one byte per pair keeps the hot lookups cache-dense. */
 static size_t faction_mgrid = 0; /**< Allocated memory. */
 
+/**
+ * @brief A combat standing hit waiting to be applied.
+ *
+ * Kills and distress calls are batched: a massacre used to run the
+ * standing Lua, the "standing" hooks and the ally/enemy propagation
+ * once per dead pilot in a single frame. The deltas are summed per
+ * (faction, source) pair instead and flushed once per frame, so each
+ * involved faction sees one standing:hit call and one hook run.
+ */
+typedef struct FactionDelta_ {
+   int f;              /**< Faction being hit. */
+   double mod;         /**< Summed modifier. */
+   const char *source; /**< Source of the hit; always a static string. */
+} FactionDelta;
+static FactionDelta *faction_deltas = NULL; /**< Array (array.h): pending combat hits. */
+
 /*
  * Prototypes
  */
@@ -123,6 +150,30 @@ static void faction_computeGrid (void);
 int pfaction_save( xmlTextWriterPtr writer );
 int pfaction_load( xmlNodePtr parent );
 
+static int faction_sortedCmp( const void *p1, const void *p2 )
+{
+   const int *i1 = p1, *i2 = p2;
+   return strcmp( faction_stack[*i1].name, faction_stack[*i2].name );
+}
+
+static int faction_sortedSearchCmp( const void *key, const void *elem )
+{
+   return strcmp( (const char*)key, faction_stack[*(const int*)elem].name );
+}
+
+/**
+ * @brief Rebuilds the name-sorted lookup index.
+ */
+static void faction_rebuildSorted (void)
+{
+   array_free( faction_sorted );
+   faction_sorted = array_create_size( int, array_size(faction_stack) );
+   for (int i=0; i<array_size(faction_stack); i++)
+      array_push_back( &faction_sorted, i );
+   qsort( faction_sorted, array_size(faction_sorted), sizeof(int), faction_sortedCmp );
+   faction_sorted_dirty = 0;
+}
+
 static int faction_cmp( const void *p1, const void *p2 )
 {
    const Faction *f1, *f2;
@@ -144,20 +195,13 @@ static int faction_getRaw( const char* name )
       return FACTION_PLAYER;
 
    if (name != NULL) {
-      int i;
-      for (i=0; i<array_size(faction_stack); i++)
-         if (strcmp(faction_stack[i].name, name)==0)
-            break;
-
-      if (i != array_size(faction_stack))
-         return i;
-
-      /* Dynamic factions are why we can't have nice things.
-      const Faction f = { .name = (char*)name };
-      Faction *found = bsearch( &f, faction_stack, array_size(faction_stack), sizeof(Faction), faction_cmp );
+      const int *found;
+      if (faction_sorted_dirty)
+         faction_rebuildSorted();
+      found = bsearch( name, faction_sorted, array_size(faction_sorted),
+            sizeof(int), faction_sortedSearchCmp );
       if (found != NULL)
-         return found - faction_stack;
-      */
+         return *found;
    }
    return -1;
 }
@@ -747,6 +791,54 @@ static void faction_sanitizePlayer( Faction* faction )
    faction->player = CLAMP( -100., 100., faction->player );
 }
 
+/**
+ * @brief Classifies a standing value into the band the derived data cares about.
+ *
+ * Land permissions, lane colouring and the map tint all key off the same
+ * friend / neutral / enemy classification, so this is the granularity at
+ * which they need refreshing.
+ *
+ *    @param faction Faction the standing belongs to.
+ *    @param standing Standing value to classify.
+ *    @return -1 if hostile, 1 if friendly, 0 otherwise.
+ */
+static int faction_standingBand( const Faction *faction, double standing )
+{
+   if (standing < 0.)
+      return -1;
+   if (standing >= faction->friendly_at)
+      return 1;
+   return 0;
+}
+
+/**
+ * @brief Refreshes standing-derived data after a player standing change.
+ *
+ * Only fires the broad invalidations (land permissions, GUI faction state,
+ * map tint) when the standing actually crossed a friend / neutral / enemy
+ * threshold; grinding standing within a band leaves the caches alone.
+ *
+ *    @param f Faction whose standing changed.
+ *    @param old Standing value before the change.
+ */
+static void faction_updatePlayerDerived( int f, double old )
+{
+   const Faction *faction = &faction_stack[f];
+
+   if (faction_standingBand( faction, old ) ==
+         faction_standingBand( faction, faction->player ))
+      return;
+
+   /* Only spobs of this faction derive their land permission from it. */
+   space_invalidateLandFaction( f );
+
+   /* Tell space the faction changed. */
+   space_factionChange();
+
+   /* Faction disk tint on the map follows the same classification. */
+   map_cacheInvalidate();
+}
+
 /**
  * @brief Mods player using the power of Lua.
  */
@@ -809,8 +901,8 @@ static void faction_modPlayerLua( int f, double mod, const char *source, int sec
       hparam[2].type    = HOOK_PARAM_SENTINEL;
       hooks_runParam( "standing", hparam );
 
-      /* Tell space the faction changed. */
-      space_factionChange();
+      /* Refresh derived data if a threshold was crossed. */
+      faction_updatePlayerDerived( f, old );
    }
 }
 
@@ -837,6 +929,28 @@ void faction_modPlayer( int f, double mod, const char *source )
       WARN(_("Faction id '%d' is invalid."), f);
       return;
    }
+
+   /* Combat sources get batched and applied once per frame by
+    * faction_modPlayerFlush(); scripts see their changes immediately
+    * since missions tend to read the standing right back. */
+   if ((strcmp(source,"kill")==0) || (strcmp(source,"distress")==0)) {
+      FactionDelta *d;
+      if (faction_deltas == NULL)
+         faction_deltas = array_create( FactionDelta );
+      for (int i=0; i<array_size(faction_deltas); i++) {
+         d = &faction_deltas[i];
+         if ((d->f == f) && (strcmp(d->source,source)==0)) {
+            d->mod += mod;
+            return;
+         }
+      }
+      d = &array_grow( &faction_deltas );
+      d->f      = f;
+      d->mod    = mod;
+      d->source = source;
+      return;
+   }
+
    faction = &faction_stack[f];
 
    /* Modify faction standing with parent faction. */
@@ -853,6 +967,33 @@ void faction_modPlayer( int f, double mod, const char *source )
       faction_modPlayerLua( faction->enemies[i], -mod, source, 1 );
 }
 
+/**
+ * @brief Applies the combat standing hits batched up over the frame.
+ *
+ * Run once per frame from the update loop, after the pilots have been
+ * updated.
+ */
+void faction_modPlayerFlush (void)
+{
+   for (int i=0; i<array_size(faction_deltas); i++) {
+      const FactionDelta *d = &faction_deltas[i];
+      const Faction *faction = &faction_stack[d->f];
+
+      /* Modify faction standing with parent faction. */
+      faction_modPlayerLua( d->f, d->mod, d->source, 0 );
+
+      /* Now mod allies to a lesser degree */
+      for (int j=0; j<array_size(faction->allies); j++)
+         faction_modPlayerLua( faction->allies[j], d->mod, d->source, 1 );
+
+      /* Now mod enemies */
+      for (int j=0; j<array_size(faction->enemies); j++)
+         faction_modPlayerLua( faction->enemies[j], -d->mod, d->source, 1 );
+   }
+   if (faction_deltas != NULL)
+      array_erase( &faction_deltas, array_begin(faction_deltas), array_end(faction_deltas) );
+}
+
 /**
  * @brief Modifies the player's standing without affecting others.
  *
@@ -893,6 +1034,7 @@ void faction_modPlayerRaw( int f, double mod )
 {
    Faction *faction;
    HookParam hparam[3];
+   double old;
 
    if (!faction_isFaction(f)) {
       WARN(_("Faction id '%d' is invalid."), f);
@@ -900,6 +1042,7 @@ void faction_modPlayerRaw( int f, double mod )
    }
 
    faction = &faction_stack[f];
+   old = faction->player;
    faction->player += mod;
    /* Run hook if necessary. */
    hparam[0].type    = HOOK_PARAM_FACTION;
@@ -912,8 +1055,8 @@ void faction_modPlayerRaw( int f, double mod )
    /* Sanitize just in case. */
    faction_sanitizePlayer( faction );
 
-   /* Tell space the faction changed. */
-   space_factionChange();
+   /* Refresh derived data if a threshold was crossed. */
+   faction_updatePlayerDerived( f, old );
 }
 
 /**
@@ -947,8 +1090,8 @@ void faction_setPlayer( int f, double value )
    /* Sanitize just in case. */
    faction_sanitizePlayer( faction );
 
-   /* Tell space the faction changed. */
-   space_factionChange();
+   /* Refresh derived data if a threshold was crossed. */
+   faction_updatePlayerDerived( f, value - mod );
 }
 
 /**
@@ -1319,7 +1462,8 @@ static int faction_parse( Faction* temp, const char *file )
          if (temp->logo != NULL)
             WARN(_("Faction '%s' has duplicate 'logo' tag."), temp->name);
          snprintf( buf, sizeof(buf), FACTION_LOGO_PATH"%s.webp", xml_get(node) );
-         temp->logo = gl_newImage(buf, 0);
+         /* Logos only show up in menus; decode in the background. */
+         temp->logo = gl_newImageAsync( buf, 0, NULL, NULL );
          continue;
       }
 
@@ -1349,7 +1493,7 @@ static int faction_parse( Faction* temp, const char *file )
             if (xml_isNode(cur, "tag")) {
                char *tmp = xml_get(cur);
                if (tmp != NULL)
-                  array_push_back( &temp->tags, strdup(tmp) );
+                  array_push_back( &temp->tags, (char*)strintern(tmp) );
                continue;
             }
             WARN(_("Faction '%s' has unknown node in tags '%s'."), temp->name, cur->name );
@@ -1564,6 +1708,7 @@ void factions_reset (void)
       faction_stack[i].player = faction_stack[i].player_def;
       faction_stack[i].flags = faction_stack[i].oflags;
    }
+   space_invalidateLand();
 }
 
 /**
@@ -1597,12 +1742,14 @@ int factions_load (void)
          if (ret == 0) {
             nf.oflags = nf.flags;
             array_push_back( &faction_stack, nf );
+            faction_sorted_dirty = 1;
          }
       }
    }
 
    /* Sort by name. */
    qsort( faction_stack, array_size(faction_stack), sizeof(Faction), faction_cmp );
+   faction_sorted_dirty = 1;
    faction_player = faction_get("Player");
 
    /* Second pass - sets allies and enemies */
@@ -1682,9 +1829,7 @@ static void faction_freeOne( Faction *f )
    nlua_freeEnv( f->env );
    if (!faction_isFlag(f, FACTION_DYNAMIC))
       nlua_freeEnv( f->equip_env );
-   for (int i=0; i<array_size(f->tags); i++)
-      free(f->tags[i]);
-   array_free(f->tags);
+   array_free(f->tags); /* Tags are interned. */
 }
 
 /**
@@ -1697,6 +1842,11 @@ void factions_free (void)
       faction_freeOne( &faction_stack[i] );
    array_free(faction_stack);
    faction_stack = NULL;
+   array_free(faction_sorted);
+   faction_sorted = NULL;
+   faction_sorted_dirty = 1;
+   array_free(faction_deltas);
+   faction_deltas = NULL;
 
    /* Clean up faction grid. */
    free( faction_grid );
@@ -1777,6 +1927,7 @@ int pfaction_load( xmlNodePtr parent )
       }
    } while (xml_nextNode(node));
 
+   space_invalidateLand();
    return 0;
 }
 
@@ -1853,6 +2004,7 @@ void factions_clearDynamic (void)
          i--;
       }
    }
+   faction_sorted_dirty = 1;
    faction_computeGrid();
 }
 
@@ -1904,6 +2056,7 @@ int faction_dynAdd( int base, const char* name, const char* display, const char*
    }
 
    /* TODO make this incremental. */
+   faction_sorted_dirty = 1;
    faction_computeGrid();
 
    return f-faction_stack;
@@ -1917,11 +2070,11 @@ static void faction_computeGrid (void)
    size_t n = array_size(faction_stack);
    if (faction_mgrid < n) {
       free( faction_grid );
-      faction_grid = malloc( n * n * sizeof(int) );
+      faction_grid = malloc( n * n * sizeof(int8_t) );
       faction_mgrid = n;
    }
    n = faction_mgrid;
-   memset( faction_grid, 0, n*n*sizeof(int) );
+   memset( faction_grid, 0, n*n*sizeof(int8_t) );
    for (int i=0; i<array_size(faction_stack); i++) {
       Faction *fa = &faction_stack[i];
       for (int k=0; k<array_size(fa->allies); k++) {
@@ -60,6 +60,7 @@ int faction_setKnown( int id, int state );
 void faction_modPlayer( int f, double mod, const char *source );
 void faction_modPlayerSingle( int f, double mod, const char *source );
 void faction_modPlayerRaw( int f, double mod );
+void faction_modPlayerFlush (void);
 void faction_setPlayer( int f, double value );
 double faction_getPlayer( int f );
 double faction_getPlayerDef( int f );
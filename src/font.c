@@ -16,6 +16,8 @@
 #include FT_FREETYPE_H
 #include FT_GLYPH_H
 #include FT_MODULE_H
+#include <stdint.h>
+#include <stdio.h>
 #include <wctype.h>
 #include "linebreak.h"
 #include "linebreakdef.h"
@@ -141,6 +143,8 @@ typedef struct glFontStash_s {
    /* Freetype stuff. */
    glFontStashFreetype *ft;
 
+   FILE *cachefile; /**< Persistent glyph cache, open for appending. NULL if disabled. */
+
    int refcount; /**< Reference counting. */
 } glFontStash;
 
@@ -158,6 +162,37 @@ glFont gl_defFontMono; /**< Default mono font. */
 static const glColour *font_lastCol    = NULL; /**< Stores last colour used (activated by FONT_COLOUR_CODE). */
 static int font_restoreLast      = 0; /**< Restore last colour. */
 
+/*
+ * Shaped-run cache. Static UI labels get printed with identical text every
+ * frame, so the result of shaping (glyph lookup, kerning, colour escapes)
+ * is cached per stash and replayed, instead of walking the UTF-8 string
+ * and querying FreeType again each time.
+ */
+#define FONT_RUN_CACHE_SIZE 256 /**< Maximum number of shaped runs kept. */
+
+/**
+ * @brief One step of a shaped run: either a glyph or a colour change.
+ */
+typedef struct glFontRunItem_ {
+   int glyph;           /**< Index into the stash glyph array, -1 for a colour change. */
+   GLfloat kern;        /**< Kerning advance applied before the glyph. */
+   const glColour *col; /**< Colour to switch to, NULL restores the base colour. */
+} glFontRunItem;
+
+/**
+ * @brief A cached shaped run of text.
+ */
+typedef struct glFontRun_ {
+   glFontStash *stsh;   /**< Stash the run was shaped for. */
+   uint32_t hash;       /**< Hash of the text. */
+   char *text;          /**< Copy of the text, to handle hash collisions. */
+   glFontRunItem *items;/**< Array (array.h): shaped items. */
+   unsigned int lastuse;/**< Value of the use counter at the last hit, for LRU eviction. */
+} glFontRun;
+
+static glFontRun *font_runs = NULL; /**< Array (array.h): shaped-run cache. */
+static unsigned int font_runuse = 0; /**< Monotonic counter for LRU eviction. */
+
 /*
  * prototypes
  */
@@ -167,6 +202,9 @@ static const glColour* gl_fontGetColour( uint32_t ch );
 static uint32_t font_nextChar( const char *s, size_t *i );
 /* Get unicode glyphs from cache. */
 static glFontGlyph* gl_fontGetGlyph( glFontStash *stsh, uint32_t ch );
+static glFontGlyph* gl_fontAddGlyph( glFontStash *stsh, font_char_t *ft_char, uint32_t ch );
+static void gl_fontCacheOpen( glFontStash *stsh );
+static void gl_fontCacheAppend( glFontStash *stsh, const font_char_t *c, uint32_t ch );
 /* Render.
  * TODO this should be changed to be more like font-stash (https://github.com/akrinke/Font-Stash)
  * In particular, instead of writing char by char, they should be batched up by textures and rendered
@@ -174,12 +212,16 @@ static glFontGlyph* gl_fontGetGlyph( glFontStash *stsh, uint32_t ch );
  */
 static void gl_fontRenderStart( const glFontStash *stsh, double x, double y, const glColour *c, double outlineR );
 static void gl_fontRenderStartH( const glFontStash* stsh, const mat4 *H, const glColour *c, double outlineR );
-static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch, const glColour *c, int state );
 static void gl_fontRenderEnd (void);
 /* Fussy layout concerns. */
 static void gl_fontKernStart (void);
 static int gl_fontKernGlyph( glFontStash* stsh, uint32_t ch, glFontGlyph* glyph );
 static void gl_fontstashftDestroy( glFontStashFreetype *ft );
+/* Shaped-run cache. */
+static void gl_fontRunShape( glFontRun *run, glFontStash *stsh );
+static glFontRun* gl_fontRunGet( glFontStash *stsh, const char *text, size_t len );
+static void gl_fontRenderRun( glFontStash *stsh, const char *text, size_t len, const glColour *c );
+static void gl_fontRunPurge( const glFontStash *stsh );
 
 /**
  * @brief Gets the font stash corresponding to a font.
@@ -616,20 +658,13 @@ static uint32_t font_nextChar( const char *s, size_t *i )
 void gl_printRaw( const glFont *ft_font, double x, double y, const glColour* c,
       double outlineR, const char *text )
 {
-   int s;
-   size_t i;
-   uint32_t ch;
-
    if (ft_font == NULL)
       ft_font = &gl_defFont;
    glFontStash *stsh = gl_fontGetStash( ft_font );
 
    /* Render it. */
-   s = 0;
-   i = 0;
    gl_fontRenderStart( stsh, x, y, c, outlineR );
-   while ((ch = u8_nextchar( text, &i )))
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   gl_fontRenderRun( stsh, text, strlen(text), c );
    gl_fontRenderEnd();
 }
 
@@ -647,20 +682,13 @@ void gl_printRaw( const glFont *ft_font, double x, double y, const glColour* c,
 void gl_printRawH( const glFont *ft_font, const mat4 *H,
       const glColour* c, const double outlineR , const char *text )
 {
-   int s;
-   size_t i;
-   uint32_t ch;
-
    if (ft_font == NULL)
       ft_font = &gl_defFont;
    glFontStash *stsh = gl_fontGetStash( ft_font );
 
    /* Render it. */
-   s = 0;
-   i = 0;
    gl_fontRenderStartH( stsh, H, c, outlineR );
-   while ((ch = u8_nextchar( text, &i )))
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   gl_fontRenderRun( stsh, text, strlen(text), c );
    gl_fontRenderEnd();
 }
 
@@ -720,9 +748,7 @@ void gl_print( const glFont *ft_font,
 int gl_printMaxRaw( const glFont *ft_font, const int max, double x, double y,
       const glColour* c, double outlineR, const char *text)
 {
-   int s;
-   size_t ret, i;
-   uint32_t ch;
+   size_t ret;
 
    if (ft_font == NULL)
       ft_font = &gl_defFont;
@@ -732,11 +758,8 @@ int gl_printMaxRaw( const glFont *ft_font, const int max, double x, double y,
    ret = font_limitSize( stsh, NULL, text, max );
 
    /* Render it. */
-   s = 0;
    gl_fontRenderStart( stsh, x, y, c, outlineR );
-   i = 0;
-   while ((ch = u8_nextchar( text, &i )) && (i <= ret))
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   gl_fontRenderRun( stsh, text, ret, c );
    gl_fontRenderEnd();
 
    return ret;
@@ -794,9 +817,8 @@ int gl_printMidRaw(
       const char *text
       )
 {
-   int n, s;
-   size_t ret, i;
-   uint32_t ch;
+   int n;
+   size_t ret;
 
    if (ft_font == NULL)
       ft_font = &gl_defFont;
@@ -808,11 +830,8 @@ int gl_printMidRaw(
    x += (double)(width - n)/2.;
 
    /* Render it. */
-   s = 0;
    gl_fontRenderStart( stsh, x, y, c, outlineR );
-   i = 0;
-   while ((ch = u8_nextchar( text, &i )) && (i <= ret))
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   gl_fontRenderRun( stsh, text, ret, c );
    gl_fontRenderEnd();
 
    return ret;
@@ -875,9 +894,7 @@ int gl_printTextRaw( const glFont *ft_font,
     )
 {
    glPrintLineIterator iter;
-   int s;
    double x,y;
-   uint32_t ch;
 
    if (ft_font == NULL)
       ft_font = &gl_defFont;
@@ -893,7 +910,6 @@ int gl_printTextRaw( const glFont *ft_font,
    /* Clears restoration. */
    gl_printRestoreClear();
 
-   s = 0;
    gl_printLineIteratorInit( &iter, ft_font, text, width );
    while ((y - by > -1e-5) && gl_printLineIteratorNext( &iter )) {
       /* Must restore stuff. */
@@ -901,10 +917,7 @@ int gl_printTextRaw( const glFont *ft_font,
 
       /* Render it. */
       gl_fontRenderStart( stsh, x, y, c, outlineR );
-      for (size_t i = iter.l_begin; i < iter.l_end; ) {
-         ch = u8_nextchar( text, &i );
-         s = gl_fontRenderGlyph( stsh, ch, c, s );
-      }
+      gl_fontRenderRun( stsh, &text[iter.l_begin], iter.l_end - iter.l_begin, c );
       gl_fontRenderEnd();
 
       y -= line_height; /* move position down */
@@ -1239,7 +1252,7 @@ static void gl_fontRenderStartH( const glFontStash* stsh, const mat4 *H, const g
    else
       col = c;
 
-   glUseProgram(shaders.font.program);
+   gl_useProgram(shaders.font.program);
    gl_uniformAColor(shaders.font.color, col, a);
    if (outlineR == 0.)
       gl_uniformAColor(shaders.font.outline_color, col, 0.);
@@ -1340,18 +1353,42 @@ static glFontGlyph* gl_fontGetGlyph( glFontStash *stsh, uint32_t ch )
    /* Glyph not found, have to generate. */
    glFontGlyph *glyph;
    font_char_t ft_char;
-   int idx;
 
    /* Load data from freetype. */
    if (font_makeChar( stsh, &ft_char, ch ))
       return NULL;
 
+   glyph = gl_fontAddGlyph( stsh, &ft_char, ch );
+
+   /* Remember the rasterized data so the next launch skips this. */
+   gl_fontCacheAppend( stsh, &ft_char, ch );
+
+   free(ft_char.data);
+   free(ft_char.dataf);
+
+   return glyph;
+}
+
+/**
+ * @brief Adds a prepared character to the glyph table and texture atlas.
+ *
+ *    @param stsh Stash to add the glyph to.
+ *    @param ft_char Prepared character data.
+ *    @param ch Codepoint of the character.
+ *    @return The new glyph.
+ */
+static glFontGlyph* gl_fontAddGlyph( glFontStash *stsh, font_char_t *ft_char, uint32_t ch )
+{
+   glFontGlyph *glyph;
+   int i, idx;
+   unsigned int h = hashint(ch) & (HASH_LUT_SIZE-1);
+
    /* Create new character. */
    glyph = &array_grow( &stsh->glyphs );
    glyph->codepoint = ch;
-   glyph->adv_x = ft_char.adv_x;
-   glyph->m = ft_char.m;
-   glyph->ft_index = ft_char.ft_index;
+   glyph->adv_x = ft_char->adv_x;
+   glyph->m = ft_char->m;
+   glyph->ft_index = ft_char->ft_index;
    glyph->next  = -1;
    idx = glyph - stsh->glyphs;
 
@@ -1371,14 +1408,165 @@ static glFontGlyph* gl_fontGetGlyph( glFontStash *stsh, uint32_t ch )
    }
 
    /* Find empty texture and render char. */
-   gl_fontAddGlyphTex( stsh, &ft_char, glyph );
-
-   free(ft_char.data);
-   free(ft_char.dataf);
+   gl_fontAddGlyphTex( stsh, ft_char, glyph );
 
    return glyph;
 }
 
+/*
+ * Persistent glyph cache: rasterizing a glyph means a FreeType render plus a
+ * signed-distance-field transform, which makes the first draw of e.g. CJK
+ * text stall noticeably and repeats every launch. Each stash appends newly
+ * generated glyphs to a cache file in the write directory and replays it at
+ * startup, pre-baking the atlas; generation stays as the fallback for
+ * anything not yet cached. The header ties the cache to the font height and
+ * the primary font file size so font changes invalidate it.
+ */
+#define FONT_CACHE_MAGIC   0x464c474e /**< "NGLF" */
+#define FONT_CACHE_VERSION 1 /**< Bump to invalidate old caches. */
+
+/**
+ * @brief Builds the cache file path for a stash.
+ */
+static void gl_fontCachePath( const glFontStash *stsh, char *buf, size_t len )
+{
+   uint32_t hash = 5381;
+   for (const char *c = stsh->fname; *c != '\0'; c++)
+      hash = hash*33 + (unsigned char)*c;
+   snprintf( buf, len, "%sglyphs-%08x-%d.dat", nfile_cachePath(), hash, stsh->h );
+}
+
+/**
+ * @brief Appends a rasterized character to the stash's glyph cache.
+ */
+static void gl_fontCacheAppend( glFontStash *stsh, const font_char_t *c, uint32_t ch )
+{
+   uint32_t head[7];
+   float fhead[2];
+   uint8_t isfloat = (c->dataf != NULL);
+
+   if (stsh->cachefile == NULL)
+      return;
+
+   head[0] = ch;
+   head[1] = (uint32_t)c->ft_index;
+   head[2] = (uint32_t)c->w;
+   head[3] = (uint32_t)c->h;
+   head[4] = (uint32_t)c->off_x;
+   head[5] = (uint32_t)c->off_y;
+   head[6] = isfloat;
+   fhead[0] = c->adv_x;
+   fhead[1] = c->m;
+   if ((fwrite( head, sizeof(head), 1, stsh->cachefile ) != 1) ||
+         (fwrite( fhead, sizeof(fhead), 1, stsh->cachefile ) != 1) ||
+         (fwrite( isfloat ? (const void*)c->dataf : (const void*)c->data,
+               isfloat ? sizeof(GLfloat) : sizeof(GLubyte),
+               c->w*c->h, stsh->cachefile ) != (size_t)(c->w*c->h))) {
+      /* Disk trouble; stop caching rather than corrupt the file further. */
+      fclose( stsh->cachefile );
+      stsh->cachefile = NULL;
+   }
+}
+
+/**
+ * @brief Loads the glyph cache for a stash and leaves it open for appending.
+ *
+ * Pre-bakes every previously seen glyph into the texture atlas. A cache
+ * whose header doesn't match the current fonts is discarded.
+ */
+static void gl_fontCacheOpen( glFontStash *stsh )
+{
+   char file[PATH_MAX];
+   FILE *f;
+   uint32_t hdr[4];
+   int valid;
+
+   if (array_size(stsh->ft) <= 0)
+      return;
+   gl_fontCachePath( stsh, file, sizeof(file) );
+
+   valid = 0;
+   f = fopen( file, "rb" );
+   if (f != NULL) {
+      if ((fread( hdr, sizeof(hdr), 1, f ) == 1) &&
+            (hdr[0] == FONT_CACHE_MAGIC) && (hdr[1] == FONT_CACHE_VERSION) &&
+            (hdr[2] == (uint32_t)stsh->h) &&
+            (hdr[3] == (uint32_t)stsh->ft[0].file->datasize))
+         valid = 1;
+
+      while (valid) {
+         uint32_t head[7];
+         float fhead[2];
+         font_char_t c;
+         size_t n;
+
+         if (fread( head, sizeof(head), 1, f ) != 1)
+            break; /* Clean end of cache. */
+         if (fread( fhead, sizeof(fhead), 1, f ) != 1) {
+            valid = 0; /* Truncated record; discard the cache. */
+            break;
+         }
+
+         memset( &c, 0, sizeof(c) );
+         c.w        = (int)head[2];
+         c.h        = (int)head[3];
+         c.ft_index = (int)head[1];
+         c.off_x    = (int32_t)head[4];
+         c.off_y    = (int32_t)head[5];
+         c.adv_x    = fhead[0];
+         c.m        = fhead[1];
+         n          = (size_t)c.w * (size_t)c.h;
+         if ((c.w < 0) || (c.h < 0) || (n > (size_t)stsh->tw*stsh->th)) {
+            valid = 0;
+            break;
+         }
+         if (head[6]) {
+            c.dataf = malloc( n * sizeof(GLfloat) );
+            valid = (fread( c.dataf, sizeof(GLfloat), n, f ) == n);
+         }
+         else {
+            c.data = malloc( n * sizeof(GLubyte) );
+            valid = (fread( c.data, sizeof(GLubyte), n, f ) == n);
+         }
+         /* Skip glyphs from fallback fonts that aren't loaded (yet) and
+          * duplicates from interrupted runs. */
+         if (valid && (c.ft_index < array_size(stsh->ft))) {
+            int found = 0, j = stsh->lut[ hashint(head[0]) & (HASH_LUT_SIZE-1) ];
+            while (j != -1) {
+               if (stsh->glyphs[j].codepoint == head[0]) {
+                  found = 1;
+                  break;
+               }
+               j = stsh->glyphs[j].next;
+            }
+            if (!found)
+               gl_fontAddGlyph( stsh, &c, head[0] );
+         }
+         free( c.data );
+         free( c.dataf );
+      }
+      fclose( f );
+   }
+
+   if (valid)
+      /* Keep extending the existing cache. */
+      stsh->cachefile = fopen( file, "ab" );
+   else {
+      /* Start a fresh cache with the current header. */
+      stsh->cachefile = fopen( file, "wb" );
+      if (stsh->cachefile != NULL) {
+         hdr[0] = FONT_CACHE_MAGIC;
+         hdr[1] = FONT_CACHE_VERSION;
+         hdr[2] = (uint32_t)stsh->h;
+         hdr[3] = (uint32_t)stsh->ft[0].file->datasize;
+         if (fwrite( hdr, sizeof(hdr), 1, stsh->cachefile ) != 1) {
+            fclose( stsh->cachefile );
+            stsh->cachefile = NULL;
+         }
+      }
+   }
+}
+
 /**
  * @brief Call at the start of a string/line.
  */
@@ -1409,76 +1597,191 @@ static int gl_fontKernGlyph( glFontStash* stsh, uint32_t ch, glFontGlyph* glyph
 }
 
 /**
- * @brief Renders a character.
+ * @brief Ends the rendering engine.
  */
-static int gl_fontRenderGlyph( glFontStash* stsh, uint32_t ch, const glColour *c, int state )
+static void gl_fontRenderEnd (void)
 {
-   double scale;
-   int kern_adv_x;
-   glFontGlyph *glyph;
+   glDisableVertexAttribArray( shaders.font.vertex );
+   glDisableVertexAttribArray( shaders.font.tex_coord );
+   gl_useProgram(0);
 
-   /* Handle escape sequences. */
-   if ((ch == FONT_COLOUR_CODE) && (state==0)) { /* Start sequence. */
-      return 1;
-   }
-   if ((state == 1) && (ch != FONT_COLOUR_CODE)) {
-      const glColour *col = gl_fontGetColour( ch );
-      double a = (c==NULL) ? 1. : c->a;
-      if (col != NULL)
-         gl_uniformAColor(shaders.font.color, col, a );
-      else if (c==NULL)
-         gl_uniformColor(shaders.font.color, &cWhite);
-      else
-         gl_uniformColor(shaders.font.color, c);
-      font_lastCol = col;
-      return 0;
+   glDisable( GL_DEPTH_TEST );
+
+   /* Check for errors. */
+   gl_checkErr();
+}
+
+/**
+ * @brief Hash function for strings (djb2).
+ */
+static uint32_t hashstr( const char *s, size_t len )
+{
+   uint32_t h = 5381;
+   for (size_t i=0; i<len; i++)
+      h = h*33 + (unsigned char)s[i];
+   return h;
+}
+
+/**
+ * @brief Shapes the text of a run into its item list.
+ *
+ * Walks the UTF-8 string once, resolving glyphs, kerning and colour escape
+ *  sequences without touching any GL state, so the result can be replayed
+ *  every frame.
+ */
+static void gl_fontRunShape( glFontRun *run, glFontStash *stsh )
+{
+   size_t i = 0;
+   int s = 0;
+   uint32_t ch;
+
+   run->items = array_create( glFontRunItem );
+   gl_fontKernStart();
+   while ((ch = u8_nextchar( run->text, &i ))) {
+      glFontRunItem *it;
+      glFontGlyph *glyph;
+
+      /* Handle escape sequences. */
+      if ((ch == FONT_COLOUR_CODE) && (s == 0)) {
+         s = 1;
+         continue;
+      }
+      if ((s == 1) && (ch != FONT_COLOUR_CODE)) {
+         it = &array_grow( &run->items );
+         it->glyph = -1;
+         it->kern  = 0.;
+         it->col   = gl_fontGetColour( ch );
+         s = 0;
+         continue;
+      }
+      s = 0;
+
+      glyph = gl_fontGetGlyph( stsh, ch );
+      if (glyph == NULL) {
+         WARN(_("Unable to find glyph '%d'!"), ch );
+         continue;
+      }
+      it = &array_grow( &run->items );
+      it->glyph = glyph - stsh->glyphs;
+      it->kern  = gl_fontKernGlyph( stsh, ch, glyph );
+      it->col   = NULL;
    }
+}
 
-   /* Unicode goes here.
-    * First try to find the glyph. */
-   glyph = gl_fontGetGlyph( stsh, ch );
-   if (glyph == NULL) {
-      WARN(_("Unable to find glyph '%d'!"), ch );
-      return -1;
+/**
+ * @brief Looks a shaped run up in the cache, shaping and caching it on a miss.
+ *
+ *    @param stsh Stash to shape with.
+ *    @param text Text of the run.
+ *    @param len Length of the run in bytes.
+ *    @return The cached run.
+ */
+static glFontRun* gl_fontRunGet( glFontStash *stsh, const char *text, size_t len )
+{
+   uint32_t hash = hashstr( text, len );
+   glFontRun *run;
+
+   if (font_runs == NULL)
+      font_runs = array_create_size( glFontRun, FONT_RUN_CACHE_SIZE );
+
+   /* Look it up. */
+   for (int i=0; i<array_size(font_runs); i++) {
+      glFontRun *r = &font_runs[i];
+      if ((r->stsh == stsh) && (r->hash == hash) &&
+            (strncmp( r->text, text, len ) == 0) && (r->text[len] == '\0')) {
+         r->lastuse = ++font_runuse;
+         return r;
+      }
    }
 
-   /* Kern if possible. */
-   scale = (double)stsh->h / FONT_DISTANCE_FIELD_SIZE;
-   kern_adv_x = gl_fontKernGlyph( stsh, ch, glyph );
-   if (kern_adv_x) {
-      mat4_translate( &font_projection_mat,
-            kern_adv_x/scale, 0, 0 );
+   /* Not found; evict the least recently used entry if the cache is full. */
+   if (array_size(font_runs) < FONT_RUN_CACHE_SIZE)
+      run = &array_grow( &font_runs );
+   else {
+      run = &font_runs[0];
+      for (int i=1; i<array_size(font_runs); i++)
+         if (font_runs[i].lastuse < run->lastuse)
+            run = &font_runs[i];
+      free( run->text );
+      array_free( run->items );
    }
 
-   /* Activate texture. */
-   glBindTexture(GL_TEXTURE_2D, stsh->tex[glyph->tex_index].id);
+   run->stsh = stsh;
+   run->hash = hash;
+   run->text = malloc( len+1 );
+   memcpy( run->text, text, len );
+   run->text[len] = '\0';
+   run->lastuse = ++font_runuse;
+   gl_fontRunShape( run, stsh );
+   return run;
+}
+
+/**
+ * @brief Renders a shaped run with the current render state.
+ *
+ * Must be called between gl_fontRenderStart and gl_fontRenderEnd.
+ *
+ *    @param stsh Stash to render with.
+ *    @param text Text of the run.
+ *    @param len Length of the run in bytes.
+ *    @param c Base colour being rendered with.
+ */
+static void gl_fontRenderRun( glFontStash *stsh, const char *text, size_t len, const glColour *c )
+{
+   const glFontRun *run;
+   double scale = (double)stsh->h / FONT_DISTANCE_FIELD_SIZE;
+
+   if (len == 0)
+      return;
+   run = gl_fontRunGet( stsh, text, len );
+
+   for (int i=0; i<array_size(run->items); i++) {
+      const glFontRunItem *it = &run->items[i];
+      const glFontGlyph *glyph;
+
+      /* Colour change. */
+      if (it->glyph < 0) {
+         double a = (c==NULL) ? 1. : c->a;
+         if (it->col != NULL)
+            gl_uniformAColor(shaders.font.color, it->col, a);
+         else if (c==NULL)
+            gl_uniformColor(shaders.font.color, &cWhite);
+         else
+            gl_uniformColor(shaders.font.color, c);
+         font_lastCol = it->col;
+         continue;
+      }
+
+      glyph = &stsh->glyphs[it->glyph];
+      if (it->kern != 0.)
+         mat4_translate( &font_projection_mat, it->kern/scale, 0, 0 );
 
-   glUniform1f(shaders.font.m, glyph->m);
-   gl_uniformMat4(shaders.font.projection, &font_projection_mat);
+      /* Activate texture. */
+      glBindTexture(GL_TEXTURE_2D, stsh->tex[glyph->tex_index].id);
 
-   /* Draw the element. */
-   glDrawArrays( GL_TRIANGLE_STRIP, glyph->vbo_id, 4 );
+      glUniform1f(shaders.font.m, glyph->m);
+      gl_uniformMat4(shaders.font.projection, &font_projection_mat);
 
-   /* Translate matrix. */
-   mat4_translate( &font_projection_mat,
-         glyph->adv_x/scale, 0, 0 );
+      /* Draw the element. */
+      glDrawArrays( GL_TRIANGLE_STRIP, glyph->vbo_id, 4 );
 
-   return 0;
+      /* Translate matrix. */
+      mat4_translate( &font_projection_mat, glyph->adv_x/scale, 0, 0 );
+   }
 }
 
 /**
- * @brief Ends the rendering engine.
+ * @brief Drops all cached runs belonging to a stash.
  */
-static void gl_fontRenderEnd (void)
+static void gl_fontRunPurge( const glFontStash *stsh )
 {
-   glDisableVertexAttribArray( shaders.font.vertex );
-   glDisableVertexAttribArray( shaders.font.tex_coord );
-   glUseProgram(0);
-
-   glDisable( GL_DEPTH_TEST );
-
-   /* Check for errors. */
-   gl_checkErr();
+   for (int i=array_size(font_runs)-1; i>=0; i--) {
+      if ((stsh != NULL) && (font_runs[i].stsh != stsh))
+         continue;
+      free( font_runs[i].text );
+      array_free( font_runs[i].items );
+      array_erase( &font_runs, &font_runs[i], &font_runs[i+1] );
+   }
 }
 
 /**
@@ -1603,6 +1906,9 @@ int gl_fontInit( glFont* font, const char *fname, const unsigned int h, const ch
    stsh->vbo_tex  = gl_vboCreateStatic( sizeof(GLfloat)*8*stsh->mvbo,  stsh->vbo_tex_data );
    stsh->vbo_vert = gl_vboCreateStatic( sizeof(GLshort)*8*stsh->mvbo, stsh->vbo_vert_data );
 
+   /* Pre-bake previously rasterized glyphs from the persistent cache. */
+   gl_fontCacheOpen( stsh );
+
    return 0;
 }
 
@@ -1669,7 +1975,7 @@ static int gl_fontstashAddFallback( glFontStash* stsh, const char *fname, unsign
       ft.file = malloc( sizeof( glFontFile ) );
       ft.file->name = strdup( fname );
       ft.file->refcount = 1;
-      ft.file->data = (FT_Byte*) ndata_read( fname, &ft.file->datasize );
+      ft.file->data = (FT_Byte*) ndata_map( fname, &ft.file->datasize );
       if (ft.file->data == NULL) {
          WARN(_("Unable to read font: %s"), fname );
          gl_fontstashftDestroy( &ft );
@@ -1731,6 +2037,9 @@ void gl_freeFont( glFont* font )
       return;
    /* Not references and must eliminate. */
 
+   /* Cached runs reference the stash glyphs. */
+   gl_fontRunPurge( stsh );
+
    for (int i=0; i<array_size(stsh->ft); i++)
       gl_fontstashftDestroy( &stsh->ft[i] );
    array_free( stsh->ft );
@@ -1740,6 +2049,9 @@ void gl_freeFont( glFont* font )
       glDeleteTextures( 1, &stsh->tex->id );
    array_free( stsh->tex );
 
+   if (stsh->cachefile != NULL)
+      fclose( stsh->cachefile );
+
    array_free( stsh->glyphs );
    gl_vboDestroy(stsh->vbo_tex);
    gl_vboDestroy(stsh->vbo_vert);
@@ -1757,7 +2069,7 @@ static void gl_fontstashftDestroy( glFontStashFreetype *ft )
 {
    if (--ft->file->refcount == 0) {
       free(ft->file->name);
-      free(ft->file->data);
+      ndata_unmap(ft->file->data);
       free(ft->file);
    }
    FT_Done_Face(ft->face);
@@ -1769,6 +2081,9 @@ static void gl_fontstashftDestroy( glFontStashFreetype *ft )
  */
 void gl_fontExit (void)
 {
+   gl_fontRunPurge( NULL );
+   array_free( font_runs );
+   font_runs = NULL;
    FT_Done_FreeType( font_library );
    font_library = NULL;
    array_free( avail_fonts );
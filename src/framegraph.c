@@ -0,0 +1,195 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file framegraph.c
+ *
+ * @brief Declarative scheduling of frame update stages.
+ *
+ * Stages declare what they read and what they write; two stages conflict
+ * when one writes state the other touches. Compilation walks the declared
+ * order once, assigns each stage to the earliest "wave" that keeps it
+ * after every conflicting predecessor, and fg_run() then executes wave by
+ * wave: stages flagged FG_MAIN_THREAD run on the caller while the rest of
+ * the wave goes to the threadpool, joining at the wave boundary.
+ *
+ * The point is making update_all's implicit ordering explicit and cheap
+ * to relax: adding a dependency is editing a stage's read/write sets
+ * rather than moving calls around, and a stage later audited as
+ * thread-safe gets overlapped just by dropping its FG_MAIN_THREAD flag.
+ * Since the declared sets are static the schedule is compiled exactly
+ * once, so the per-frame cost is a few array walks.
+ */
+/** @cond */
+#include <stdlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "framegraph.h"
+
+#include "log.h"
+#include "nstring.h"
+#include "profiler.h"
+#include "threadpool.h"
+
+/**
+ * @brief Per-stage scratch handed to threadpool workers.
+ */
+typedef struct FGJob_ {
+   const FGStage *stage; /**< Stage to run. */
+   double dt;            /**< Delta tick for the stage. */
+   double real_dt;       /**< Real (uncompressed) delta tick. */
+} FGJob;
+
+/**
+ * @brief A compiled frame graph.
+ */
+struct FrameGraph_ {
+   FGStage *stages;  /**< Stage copies, in declared order. */
+   int n;            /**< Number of stages. */
+   int *wave;        /**< Wave index assigned to each stage. */
+   int nwaves;       /**< Total number of waves. */
+   FGJob *jobs;      /**< Worker dispatch scratch, one slot per stage. */
+};
+
+/**
+ * @brief Whether running b before/with a could observe different state.
+ */
+static int fg_conflicts( const FGStage *a, const FGStage *b )
+{
+   return ((a->writes & (b->reads | b->writes)) != 0) ||
+          ((a->reads  &  b->writes) != 0);
+}
+
+/**
+ * @brief Compiles a frame graph from a declared stage list.
+ *
+ *    @param stages Stages in the order conflicts should respect.
+ *    @param n Number of stages.
+ *    @return The compiled graph.
+ */
+FrameGraph* fg_create( const FGStage *stages, int n )
+{
+   FrameGraph *fg = malloc( sizeof(FrameGraph) );
+   fg->stages  = malloc( n * sizeof(FGStage) );
+   fg->wave    = malloc( n * sizeof(int) );
+   fg->jobs    = malloc( n * sizeof(FGJob) );
+   fg->n       = n;
+   fg->nwaves  = 0;
+   memcpy( fg->stages, stages, n * sizeof(FGStage) );
+
+   for (int i=0; i<n; i++) {
+      FGStage *st = &fg->stages[i];
+      int w = 0;
+
+      /* Scripts mean the global Lua state, which lives on the main thread. */
+      if (((st->reads | st->writes) & FG_RES_LUA) &&
+            !(st->flags & FG_MAIN_THREAD)) {
+         WARN(_("Frame stage '%s' touches Lua but was not declared main-thread; pinning it."),
+               st->name );
+         st->flags |= FG_MAIN_THREAD;
+      }
+
+      /* Earliest wave after every conflicting predecessor. */
+      for (int j=0; j<i; j++)
+         if (fg_conflicts( &fg->stages[j], st ) && (fg->wave[j] >= w))
+            w = fg->wave[j] + 1;
+      fg->wave[i] = w;
+      if (w+1 > fg->nwaves)
+         fg->nwaves = w+1;
+   }
+
+   return fg;
+}
+
+/**
+ * @brief Frees a compiled frame graph.
+ */
+void fg_destroy( FrameGraph *fg )
+{
+   if (fg == NULL)
+      return;
+   free( fg->stages );
+   free( fg->wave );
+   free( fg->jobs );
+   free( fg );
+}
+
+/**
+ * @brief Runs a stage on the calling thread with its profiler bucket.
+ */
+static void fg_stageMain( const FGStage *st, double dt, double real_dt )
+{
+   if (st->prof >= 0)
+      prof_begin( (ProfBucket) st->prof );
+   st->func( dt, real_dt );
+   if (st->prof >= 0)
+      prof_end( (ProfBucket) st->prof );
+}
+
+/**
+ * @brief Threadpool entry point for a worker-run stage.
+ *
+ * No profiler scope here: the timer state is not thread-safe, and the
+ * wave join on the main thread accounts the time anyway.
+ */
+static int fg_runJob( void *data )
+{
+   FGJob *job = data;
+   job->stage->func( job->dt, job->real_dt );
+   return 0;
+}
+
+/**
+ * @brief Runs all stages of the graph for one update.
+ *
+ *    @param fg Graph to run.
+ *    @param dt Game delta tick to hand the stages.
+ *    @param real_dt Real delta tick to hand the stages.
+ */
+void fg_run( FrameGraph *fg, double dt, double real_dt )
+{
+   for (int w=0; w<fg->nwaves; w++) {
+      ThreadQueue *q = NULL;
+      int npinned = 0, nworker = 0;
+
+      for (int i=0; i<fg->n; i++) {
+         if (fg->wave[i] != w)
+            continue;
+         if (fg->stages[i].flags & FG_MAIN_THREAD)
+            npinned++;
+         else
+            nworker++;
+      }
+
+      /* Hand the thread-safe stages of the wave to the pool, unless a
+       * stage is alone in its wave and dispatch would buy nothing. */
+      for (int i=0; i<fg->n; i++) {
+         const FGStage *st = &fg->stages[i];
+         if ((fg->wave[i] != w) || (st->flags & FG_MAIN_THREAD))
+            continue;
+         if ((npinned == 0) && (nworker == 1)) {
+            fg_stageMain( st, dt, real_dt );
+            continue;
+         }
+         fg->jobs[i].stage   = st;
+         fg->jobs[i].dt      = dt;
+         fg->jobs[i].real_dt = real_dt;
+         if (q == NULL)
+            q = vpool_create();
+         vpool_enqueue( q, fg_runJob, &fg->jobs[i] );
+      }
+
+      /* The caller runs its pinned stages while the workers go. */
+      for (int i=0; i<fg->n; i++) {
+         const FGStage *st = &fg->stages[i];
+         if ((fg->wave[i] != w) || !(st->flags & FG_MAIN_THREAD))
+            continue;
+         fg_stageMain( st, dt, real_dt );
+      }
+
+      if (q != NULL)
+         vpool_wait( q );
+   }
+}
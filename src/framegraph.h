@@ -0,0 +1,54 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/**
+ * @brief Resources a frame stage may read or write.
+ *
+ * Coarse on purpose: a bit covers a whole subsystem's state, and a stage
+ * touching any of it must declare the bit. FG_RES_LUA stands for the single
+ * global Lua state; any stage that can run scripts must declare it, which
+ * serializes it against every other scripting stage and pins it to the
+ * main thread.
+ */
+typedef enum FGResource_ {
+   FG_RES_TIME    = 1<<0, /**< Game time (ntime). */
+   FG_RES_SPACE   = 1<<1, /**< Current system: spobs, asteroids, gatherables. */
+   FG_RES_PILOTS  = 1<<2, /**< Pilot stack, their solids and outfits. */
+   FG_RES_WEAPONS = 1<<3, /**< Weapon layers. */
+   FG_RES_SPFX    = 1<<4, /**< Special effects, trails and screen shake. */
+   FG_RES_CAMERA  = 1<<5, /**< Camera position and zoom. */
+   FG_RES_FACTION = 1<<6, /**< Faction standings. */
+   FG_RES_LUA     = 1<<7  /**< The global Lua state (hooks, AI, scripts). */
+} FGResource;
+
+/** @brief Stage must run on the calling thread (GL, Lua, SDL event use). */
+#define FG_MAIN_THREAD  (1<<0)
+
+/**
+ * @brief One stage of the frame.
+ */
+typedef struct FGStage_ {
+   const char *name; /**< Human-readable name for diagnostics. */
+   void (*func)( double dt, double real_dt ); /**< Stage entry point. */
+   unsigned int reads;  /**< FGResource bits the stage only reads. */
+   unsigned int writes; /**< FGResource bits the stage mutates. */
+   unsigned int flags;  /**< FG_MAIN_THREAD and friends. */
+   int prof; /**< ProfBucket to account the stage under, or -1 for none. */
+} FGStage;
+
+struct FrameGraph_;
+typedef struct FrameGraph_ FrameGraph;
+
+/*
+ * Creation and destruction. The schedule is compiled once at creation;
+ * the declared stage order is kept for conflicting stages.
+ */
+FrameGraph* fg_create( const FGStage *stages, int n );
+void fg_destroy( FrameGraph *fg );
+
+/*
+ * Runs all stages, overlapping non-conflicting neighbours on the threadpool.
+ */
+void fg_run( FrameGraph *fg, double dt, double real_dt );
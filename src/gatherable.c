@@ -18,15 +18,24 @@
 
 #include "array.h"
 #include "hook.h"
+#include "pilot.h"
+#include "pilot_grid.h"
 #include "player.h"
 
 /* Gatherables */
-#define GATHER_DIST 30. /**< Maximum distance a gatherable can be gathered. */
+#define GATHER_DIST        30.  /**< Maximum distance a gatherable can be gathered. */
+#define GATHER_WAKE_DIST   500. /**< Extra radius around a gatherable that keeps it awake. */
+#define GATHER_SLEEP_DT    0.25 /**< How long an idle gatherable skips pickup checks. */
 
 /* gatherables stack */
 static Gatherable* gatherable_stack = NULL; /**< Contains the gatherable stuff floating around. */
 static float noscoop_timer = 1.; /**< Timer for the "full cargo" message . */
 
+/*
+ * Prototypes.
+ */
+static int gatherable_tryGather( Gatherable *gat );
+
 int gatherable_load (void)
 {
    gatherable_stack = array_create( Gatherable );
@@ -60,6 +69,7 @@ int gatherable_init( const Commodity* com, vec2 pos, vec2 vel, double lifeleng,
    g->sx = RNG( 0, com->gfx_space->sx );
    g->sy = RNG( 0, com->gfx_space->sy );
    g->player_only = player_only;
+   g->sleep = 0.;
 
    if (lifeleng < 0.)
       g->lifeleng = RNGF()*100. + 50.;
@@ -89,6 +99,19 @@ void gatherable_update( double dt )
       if (g->timer > g->lifeleng) {
          array_erase( &gatherable_stack, g, g+1 );
          i--;
+         continue;
+      }
+
+      /* Idle gatherables skip the pickup check until their sleep expires. */
+      if (g->sleep > 0.) {
+         g->sleep -= dt;
+         continue;
+      }
+
+      /* Got scooped up. */
+      if (gatherable_tryGather( g )) {
+         array_erase( &gatherable_stack, g, g+1 );
+         i--;
       }
    }
 }
@@ -161,48 +184,66 @@ int gatherable_getPos( vec2* pos, vec2* vel, int id )
 }
 
 /**
- * @brief See if the pilot can gather anything
+ * @brief Tries to find a nearby pilot to gather a gatherable.
  *
- *    @param p Pilot to try to gather for.
+ * Only the pilots whose cells overlap the gatherable are tested; if none
+ * is even close the gatherable goes to sleep for a while so subsequent
+ * frames skip the query entirely.
+ *
+ *    @param gat Gatherable to try to hand off.
+ *    @return 1 if a pilot gathered it (caller must remove it), 0 otherwise.
  */
-void gatherable_gather( Pilot *p )
+static int gatherable_tryGather( Gatherable *gat )
 {
-   for (int i=0; i < array_size(gatherable_stack); i++) {
-      Gatherable *gat = &gatherable_stack[i];
+   Pilot *const* candidates = pilotgrid_queryCircle( &gat->pos, GATHER_DIST + GATHER_WAKE_DIST );
+
+   /* Nobody even remotely close: doze off. */
+   if (array_size(candidates) == 0) {
+      gat->sleep = GATHER_SLEEP_DT;
+      return 0;
+   }
+
+   for (int i=0; i < array_size(candidates); i++) {
+      Pilot *p = candidates[i];
+      int q;
+
+      if (pilot_isDisabled(p) || pilot_isFlag( p, PILOT_DEAD ))
+         continue;
 
       /* Only player can gather player only stuff. */
       if (gat->player_only && !pilot_isPlayer(p))
          continue;
 
-      if (vec2_dist( &p->solid->pos, &gat->pos ) < GATHER_DIST ) {
-         /* Add cargo to pilot. */
-         int q = pilot_cargoAdd( p, gat->type, gat->quantity, 0 );
-
-         if (q>0) {
-            if (pilot_isPlayer(p)) {
-               HookParam hparam[3];
-               player_message( n_("%d ton of %s gathered", "%d tons of %s gathered", q), q, _(gat->type->name) );
-
-               /* Run hooks. */
-               hparam[0].type    = HOOK_PARAM_STRING;
-               hparam[0].u.str   = gat->type->name;
-               hparam[1].type    = HOOK_PARAM_NUMBER;
-               hparam[1].u.num   = q;
-               hparam[2].type    = HOOK_PARAM_SENTINEL;
-               hooks_runParam( "gather", hparam );
-            }
-
-            /* Remove the object from space. */
-            array_erase( &gatherable_stack, gat, gat+1 );
-
-            /* Test if there is still cargo space */
-            if ((pilot_cargoFree(p) < 1) && (pilot_isPlayer(p)))
-               player_message( _("No more cargo space available") );
-         }
-         else if ((pilot_isPlayer(p)) && (noscoop_timer > 2.)) {
-            noscoop_timer = 0.;
-            player_message( _("Cannot gather material: no more cargo space available") );
+      if (vec2_dist( &p->solid->pos, &gat->pos ) >= GATHER_DIST)
+         continue;
+
+      /* Add cargo to pilot. */
+      q = pilot_cargoAdd( p, gat->type, gat->quantity, 0 );
+
+      if (q>0) {
+         if (pilot_isPlayer(p)) {
+            HookParam hparam[3];
+            player_message( n_("%d ton of %s gathered", "%d tons of %s gathered", q), q, _(gat->type->name) );
+
+            /* Run hooks. */
+            hparam[0].type    = HOOK_PARAM_STRING;
+            hparam[0].u.str   = gat->type->name;
+            hparam[1].type    = HOOK_PARAM_NUMBER;
+            hparam[1].u.num   = q;
+            hparam[2].type    = HOOK_PARAM_SENTINEL;
+            hooks_runParam( "gather", hparam );
          }
+
+         /* Test if there is still cargo space */
+         if ((pilot_cargoFree(p) < 1) && (pilot_isPlayer(p)))
+            player_message( _("No more cargo space available") );
+
+         return 1;
+      }
+      else if ((pilot_isPlayer(p)) && (noscoop_timer > 2.)) {
+         noscoop_timer = 0.;
+         player_message( _("Cannot gather material: no more cargo space available") );
       }
    }
+   return 0;
 }
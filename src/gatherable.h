@@ -4,7 +4,7 @@
 #pragma once
 
 #include "commodity.h"
-#include "pilot.h"
+#include "physics.h"
 
 /**
  * @struct Gatherable
@@ -21,6 +21,7 @@ typedef struct Gatherable_ {
    int sx;                   /**< X sprite to use. */
    int sy;                   /**< Y sprite to use. */
    unsigned int player_only; /**< Can only be gathered by player. */
+   double sleep;             /**< Time left before checking for nearby pilots again. */
 } Gatherable;
 
 /*
@@ -38,4 +39,3 @@ int gatherable_getClosest( vec2 pos, double rad );
 int gatherable_getPos( vec2* pos, vec2* vel, int id );
 void gatherable_free( void );
 void gatherable_update( double dt );
-void gatherable_gather( Pilot *p );
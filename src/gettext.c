@@ -76,7 +76,7 @@ void gettext_exit (void)
          free( gettext_translations->chain_lang[i] );
       array_free( gettext_translations->chain_lang );
       for (int i = 0; i < array_size(gettext_translations->chain); i++)
-         free( (void*) gettext_translations->chain[i].map );
+         ndata_unmap( (void*) gettext_translations->chain[i].map );
       array_free( gettext_translations->chain );
       free( gettext_translations->language );
       gettext_activeTranslation = gettext_translations->next;
@@ -149,7 +149,7 @@ void gettext_setLanguage( const char* lang )
       snprintf( root, sizeof(root), GETTEXT_PATH"%s", lang_match );
       paths = ndata_listRecursive( root );
       for (int i=0; i<array_size(paths); i++) {
-         const char *map = ndata_read( paths[i], &map_size );
+         const char *map = ndata_map( paths[i], &map_size );
          if (map != NULL) {
             msgcat_init( &array_grow( &newtrans->chain ), map, map_size );
             array_push_back( &newtrans->chain_lang, strdup( lang_match ) );
@@ -50,7 +50,7 @@
 #include "opengl.h"
 #include "pause.h"
 #include "pilot.h"
-#include "pilot.h"
+#include "pilot_grid.h"
 #include "player.h"
 #include "render.h"
 #include "rng.h"
@@ -106,13 +106,26 @@ typedef struct Radar_ {
    double y; /**< Y position. */
    RadarShape shape; /**< Shape */
    double res; /**< Resolution */
+   /* Cached rendering; the contents are redrawn at conf.radar_fps and the
+    * texture is blitted in between. */
+   GLuint fbo; /**< Cache FBO (screen-sized, like gl_screen.fbo). */
+   GLuint tex; /**< Cache texture. */
+   int fbo_w; /**< Width the FBO was created at. */
+   int fbo_h; /**< Height the FBO was created at. */
+   double accum; /**< Time since the cache was last redrawn. */
+   int valid; /**< Whether the cache contents are usable. */
 } Radar;
 /* radar resolutions */
 #define RADAR_RES_MAX      300. /**< Maximum radar resolution. */
 #define RADAR_RES_REF      100. /**< Reference radar resolution. */
 #define RADAR_RES_MIN      10. /**< Minimum radar resolution. */
 #define RADAR_RES_INTERVAL 10. /**< Steps used to increase/decrease resolution. */
+#define RADAR_NEAR_FRAC    0.33 /**< Fraction of the radar range below which blips
+                                     bypass the cache and update every frame. */
 static Radar gui_radar;
+static unsigned int *radar_live = NULL; /**< Array (array.h): ids of the near-range
+                                             pilots captured at the last cache redraw;
+                                             these render live on top of the cache. */
 
 /* needed to render properly */
 static double gui_xoff = 0.; /**< X Offset that GUI introduces. */
@@ -131,6 +144,7 @@ static const double mesg_timeout = 15.; /**< Timeout length. */
 typedef struct Mesg_ {
    char *str; /**< The message (allocated). */
    double t; /**< Time to live for the message. */
+   double dy; /**< Render height, cached at emit so drawing does no layout. */
    glFontRestore restore; /**< Hack for font restoration. */
 } Mesg;
 static Mesg* mesg_stack = NULL; /**< Stack of messages, will be of mesg_max size. */
@@ -185,6 +199,7 @@ static void gui_renderBorder( double dt );
 static void gui_renderMessages( double dt );
 static const glColour *gui_getSpobColour( int i );
 static void gui_renderRadarOutOfRange( RadarShape sh, int w, int h, int cx, int cy, const glColour *col );
+static void gui_radarRedraw (void);
 static void gui_blink( double cx, double cy, double vr, const glColour *col, double blinkInterval, double blinkVar );
 static const glColour* gui_getPilotColour( const Pilot* p );
 static void gui_calcBorders (void);
@@ -211,6 +226,13 @@ void gui_setDefaults (void)
  */
 void gui_messageInit( int width, int x, int y )
 {
+   /* Stored messages were laid out for the old width. */
+   if ((mesg_stack != NULL) && (width != gui_mesg_w))
+      for (int i=0; i<mesg_max; i++)
+         if (mesg_stack[i].str != NULL)
+            mesg_stack[i].dy = gl_printHeightRaw( &gl_smallFont, width,
+                  (mesg_stack[i].str[0] == '\t') ? &mesg_stack[i].str[1] : mesg_stack[i].str ) + 6;
+
    gui_mesg_w = width;
    gui_mesg_x = x;
    gui_mesg_y = y;
@@ -317,6 +339,8 @@ void player_messageRaw( const char *str )
          gl_printStoreMax( &mesg_stack[mesg_pointer].restore, str, iter.l_begin );
       }
       mesg_stack[mesg_pointer].t = mesg_timeout;
+      mesg_stack[mesg_pointer].dy = gl_printHeightRaw( &gl_smallFont, gui_mesg_w,
+            (iter.l_begin == 0) ? mesg_stack[mesg_pointer].str : &mesg_stack[mesg_pointer].str[1] ) + 6;
 
       iter.width = gui_mesg_w - 45; /* Remaining lines are tabbed so it's shorter. */
    }
@@ -422,7 +446,7 @@ static void gui_renderTargetReticles( const SimpleShader *shd, double x, double
    gl_gameToScreenCoords( &rx, &ry, x, y );
    r = (double)radius *  1.2 * cam_getZoom();
 
-   glUseProgram(shd->program);
+   gl_useProgram(shd->program);
    glUniform1f(shd->dt, animation_dt);
    glUniform1f(shd->paramf, radius);
    gl_renderShader( rx, ry, r, r, angle, shd, c, 1 );
@@ -743,6 +767,7 @@ void gui_render( double dt )
     * Countdown timers.
     */
    animation_dt   += dt / dt_mod;
+   gui_radar.accum += dt / dt_mod;
    blink_pilot    -= dt / dt_mod;
    if (blink_pilot < 0.)
       blink_pilot += RADAR_BLINK_PILOT;
@@ -805,7 +830,7 @@ void gui_render( double dt )
       mat4 projection = gl_view_matrix;
 
       /* Set up the program. */
-      glUseProgram( shaders.jump.program );
+      gl_useProgram( shaders.jump.program );
       glEnableVertexAttribArray( shaders.jump.vertex );
       gl_vboActivateAttribOffset( gl_squareVBO, shaders.jump.vertex, 0, 2, GL_FLOAT, 0 );
 
@@ -831,7 +856,7 @@ void gui_render( double dt )
 
       /* Clear state. */
       glDisableVertexAttribArray( shaders.jump.vertex );
-      glUseProgram(0);
+      gl_useProgram(0);
 
       /* Check errors. */
       gl_checkErr();
@@ -864,6 +889,7 @@ int gui_radarInit( int circle, int w, int h )
    gui_radar.shape   = circle ? RADAR_CIRCLE : RADAR_RECT;
    gui_radar.w       = w;
    gui_radar.h       = h;
+   gui_radar.valid   = 0; /* Force a cache redraw. */
    gui_setRadarResolution( player.radar_res );
    return 0;
 }
@@ -876,15 +902,100 @@ int gui_radarInit( int circle, int w, int h )
  */
 void gui_radarRender( double x, double y )
 {
-   int f;
+   Radar *radar = &gui_radar;
+   mat4 view_matrix_prev;
+   Pilot *pt;
+   double bx, by, bw, bh;
+
+   gui_radar.x = x;
+   gui_radar.y = y;
+
+   /* (Re)create the cache FBO as necessary; it is screen-sized so the
+    * contents can be drawn with the unmodified radar code. */
+   if ((radar->fbo == 0) || (radar->fbo_w != gl_screen.rw) || (radar->fbo_h != gl_screen.rh)) {
+      if (radar->fbo != 0) {
+         glDeleteFramebuffers( 1, &radar->fbo );
+         glDeleteTextures( 1, &radar->tex );
+      }
+      gl_fboCreate( &radar->fbo, &radar->tex, gl_screen.rw, gl_screen.rh );
+      radar->fbo_w = gl_screen.rw;
+      radar->fbo_h = gl_screen.rh;
+      radar->valid = 0;
+   }
+
+   /* Redraw the contents at conf.radar_fps; in between the cached texture
+    * is blitted as-is. */
+   if (!radar->valid || (conf.radar_fps <= 0) ||
+         (radar->accum >= 1./(double)conf.radar_fps)) {
+      gui_radarRedraw();
+      radar->accum = 0.;
+      radar->valid = 1;
+   }
+
+   /* Blit the cached radar area. */
+   if (radar->shape==RADAR_RECT) {
+      bx = x;
+      by = y;
+      bw = radar->w;
+      bh = radar->h;
+   }
+   else { /* RADAR_CIRCLE is centered on (x,y). */
+      bx = x - radar->w;
+      by = y - radar->w;
+      bw = 2.*radar->w;
+      bh = 2.*radar->w;
+   }
+   gl_renderTextureRaw( radar->tex, 0, bx, by, bw, bh,
+         bx / gl_screen.nw, by / gl_screen.nh,
+         bw / gl_screen.nw, bh / gl_screen.nh, NULL, 0. );
+
+   /* Near-range blips and the target render live on top of the cache;
+    * the set was captured at the last redraw so every pilot is drawn
+    * exactly once per frame. */
+   view_matrix_prev = gl_view_matrix;
+   if (radar->shape==RADAR_RECT) {
+      gl_clipRect( x, y, radar->w, radar->h );
+      mat4_translate( &gl_view_matrix,
+            x + radar->w/2., y + radar->h/2., 0 );
+   }
+   else if (radar->shape==RADAR_CIRCLE)
+      mat4_translate( &gl_view_matrix,
+            x, y, 0 );
+   for (int i=0; i<array_size(radar_live); i++) {
+      const Pilot *p = pilot_get( radar_live[i] );
+      if ((p == NULL) || (p->id == player.p->target))
+         continue;
+      gui_renderPilot( p, radar->shape, radar->w, radar->h, radar->res, 0 );
+   }
+   /* The targeted pilot goes on top, even when out of range so the
+    * out-of-range marker still shows. */
+   pt = (player.p->target != player.p->id) ? pilot_get( player.p->target ) : NULL;
+   if (pt != NULL)
+      gui_renderPilot( pt, radar->shape, radar->w, radar->h, radar->res, 0 );
+   gui_renderPlayer( radar->res, 0 );
+   gl_view_matrix = view_matrix_prev;
+   if (radar->shape==RADAR_RECT)
+      gl_unclipRect();
+}
+
+/**
+ * @brief Redraws the radar contents into the cache FBO.
+ */
+static void gui_radarRedraw (void)
+{
    Radar *radar;
    mat4 view_matrix_prev;
-   Pilot *const* pilot_stack;
+   Pilot *const* candidates;
+   double x, y, range;
 
    /* The global radar. */
    radar = &gui_radar;
-   gui_radar.x = x;
-   gui_radar.y = y;
+   x = radar->x;
+   y = radar->y;
+
+   glBindFramebuffer( GL_FRAMEBUFFER, radar->fbo );
+   glClearColor( 0., 0., 0., 0. );
+   glClear( GL_COLOR_BUFFER_BIT );
 
    /* TODO: modifying gl_view_matrix like this is a bit of a hack */
    /* TODO: use stensil test for RADAR_CIRCLE */
@@ -924,18 +1035,29 @@ void gui_radarRender( double x, double y )
    weapon_minimap( radar->res, radar->w, radar->h,
          radar->shape, 1. );
 
-   /* render the pilot */
-   pilot_stack = pilot_getAll();
-   f = 0;
-   for (int i=1; i<array_size(pilot_stack); i++) { /* skip the player */
-      if (pilot_stack[i]->id == player.p->target)
-         f = i;
-      else
-         gui_renderPilot( pilot_stack[i], radar->shape, radar->w, radar->h, radar->res, 0 );
+   /* Render the pilots; the grid query only returns the ones whose blips
+    * can fall within the radar span. */
+   if (radar->shape==RADAR_RECT)
+      range = 0.5 * hypot( radar->w, radar->h ) * radar->res;
+   else
+      range = radar->w * radar->res;
+   candidates = pilotgrid_queryCircleOrdered( &player.p->solid->pos, range );
+   if (radar_live == NULL)
+      radar_live = array_create( unsigned int );
+   array_resize( &radar_live, 0 );
+   for (int i=0; i<array_size(candidates); i++) {
+      Pilot *p = candidates[i];
+      if (pilot_isFlag( p, PILOT_PLAYER ) || (p->id == player.p->target))
+         continue;
+      /* Near-range blips carry most of the information; they get captured
+       * into the live list and drawn every frame instead of being cached. */
+      if (vec2_dist2( &p->solid->pos, &player.p->solid->pos ) <
+            pow2( RADAR_NEAR_FRAC * range )) {
+         array_push_back( &radar_live, p->id );
+         continue;
+      }
+      gui_renderPilot( p, radar->shape, radar->w, radar->h, radar->res, 0 );
    }
-   /* render the targeted pilot */
-   if (f != 0)
-      gui_renderPilot( pilot_stack[f], radar->shape, radar->w, radar->h, radar->res, 0 );
 
    /* render the asteroids */
    for (int i=0; i<array_size(cur_system->asteroids); i++) {
@@ -944,13 +1066,13 @@ void gui_radarRender( double x, double y )
          gui_renderAsteroid( &ast->asteroids[j], radar->w, radar->h, radar->res, 0 );
    }
 
-   /* Render the player. */
-   gui_renderPlayer( radar->res, 0 );
-
    /* Undo the horrible hack. */
    gl_view_matrix = view_matrix_prev;
    if (radar->shape==RADAR_RECT)
       gl_unclipRect();
+
+   glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+   glClearColor( 0., 0., 0., 1. );
 }
 
 /**
@@ -1027,13 +1149,12 @@ static void gui_renderMessages( double dt )
 
          /* Only handle non-NULL messages. */
          if (mesg_stack[m].str != NULL) {
+            dy = mesg_stack[m].dy; /* Laid out when the message was emitted. */
             if (mesg_stack[m].str[0] == '\t') {
                gl_printRestore( &mesg_stack[m].restore );
-               dy = gl_printHeightRaw( &gl_smallFont, gui_mesg_w, &mesg_stack[m].str[1]) + 6;
                gl_renderRect( x-4., y-1., gui_mesg_w-13., dy, &msgc );
                gl_printMaxRaw( &gl_smallFont, gui_mesg_w - 45., x + 30, y + 3, &cFontWhite, -1., &mesg_stack[m].str[1] );
             } else {
-               dy = gl_printHeightRaw( &gl_smallFont, gui_mesg_w, mesg_stack[m].str) + 6;
                gl_renderRect( x-4., y-1., gui_mesg_w-13., dy, &msgc );
                gl_printMaxRaw( &gl_smallFont, gui_mesg_w - 15., x, y + 3, &cFontWhite, -1., mesg_stack[m].str );
             }
@@ -1141,12 +1262,12 @@ void gui_renderPilot( const Pilot* p, RadarShape shape, double w, double h, doub
    if (pilot_isFlag(p, PILOT_HILIGHT)) {
       glColour highlighted = cRadar_hilight;
       highlighted.a = 0.3;
-      glUseProgram( shaders.hilight.program );
+      gl_useProgram( shaders.hilight.program );
       glUniform1f( shaders.hilight.dt, animation_dt );
       gl_renderShader( x, y, scale*2.0, scale*2.0, 0., &shaders.hilight, &highlighted, 1 );
    }
 
-   glUseProgram(shaders.pilotmarker.program);
+   gl_useProgram(shaders.pilotmarker.program);
    gl_renderShader( x, y, scale, scale, p->solid->dir, &shaders.pilotmarker, col, 1 );
 
    /* Draw selection if targeted. */
@@ -1224,7 +1345,7 @@ void gui_renderAsteroid( const Asteroid* a, double w, double h, double res, int
 
    //gl_renderRect( px, py, MIN( 2*sx, w-px ), MIN( 2*sy, h-py ), col );
    r = (sx+sy)/2.0+1.5;
-   glUseProgram(shaders.asteroidmarker.program);
+   gl_useProgram(shaders.asteroidmarker.program);
    gl_renderShader( px, py, r, r, 0., &shaders.asteroidmarker, col, 1 );
 
    if (targeted)
@@ -1253,7 +1374,7 @@ void gui_renderPlayer( double res, int overlay )
       r = MAX( 11., r );
    }
 
-   glUseProgram(shaders.playermarker.program);
+   gl_useProgram(shaders.playermarker.program);
    gl_renderShader( x, y, r, r, player.p->solid->dir, &shaders.playermarker, &cRadar_player, 1 );
 }
 
@@ -1292,7 +1413,7 @@ static void gui_blink( double cx, double cy, double vr, const glColour *col, dou
 {
    if (blinkVar > blinkInterval/2.)
       return;
-   glUseProgram(shaders.blinkmarker.program);
+   gl_useProgram(shaders.blinkmarker.program);
    gl_renderShader( cx, cy, vr, vr, 0., &shaders.blinkmarker, col, 1 );
 }
 
@@ -1401,7 +1522,7 @@ void gui_renderSpob( int ind, RadarShape shape, double w, double h, double res,
    if (spob_isKnown( spob ) && spob_isFlag( spob, SPOB_MARKED )) {
       glColour highlighted = cRadar_hilight;
       highlighted.a = 0.3;
-      glUseProgram( shaders.hilight.program );
+      gl_useProgram( shaders.hilight.program );
       glUniform1f( shaders.hilight.dt, animation_dt );
       gl_renderShader( cx, cy, vr*3.0, vr*3.0, 0., &shaders.hilight, &highlighted, 1 );
    }
@@ -1421,7 +1542,7 @@ void gui_renderSpob( int ind, RadarShape shape, double w, double h, double res,
    else
       shd = &shaders.spobmarker_empty;
 
-   glUseProgram(shd->program);
+   gl_useProgram(shd->program);
    gl_renderShader( cx, cy, vr, vr, 0., shd, &col, 1 );
 
    if (overlay) {
@@ -1500,7 +1621,7 @@ void gui_renderJumpPoint( int ind, RadarShape shape, double w, double h, double
    if (sys_isMarked(s)) {
       glColour highlighted = cRadar_hilight;
       highlighted.a = 0.3;
-      glUseProgram( shaders.hilight.program );
+      gl_useProgram( shaders.hilight.program );
       glUniform1f( shaders.hilight.dt, animation_dt );
       gl_renderShader( cx, cy, vr*3.0, vr*3.0, 0., &shaders.hilight, &highlighted, 1 );
    }
@@ -1513,7 +1634,7 @@ void gui_renderJumpPoint( int ind, RadarShape shape, double w, double h, double
       col = cGreen;
    col.a *= alpha;
 
-   glUseProgram(shaders.jumpmarker.program);
+   gl_useProgram(shaders.jumpmarker.program);
    gl_renderShader( cx, cy, vr*1.5, vr*1.5, M_PI-jp->angle, &shaders.jumpmarker, &col, 1 );
 
    /* Blink ontop. */
@@ -1931,6 +2052,9 @@ void gui_cleanup (void)
    gui_xoff = 0.;
    gui_yoff = 0.;
 
+   /* Free the retained HUD draw batch. */
+   gui_batchCleanup();
+
    /* Destroy lua. */
    nlua_freeEnv( gui_env );
    gui_env = LUA_NOREF;
@@ -1978,6 +2102,15 @@ void gui_free (void)
    gl_vboDestroy( gui_radar_select_vbo );
    gui_radar_select_vbo = NULL;
 
+   if (gui_radar.fbo != 0) {
+      glDeleteFramebuffers( 1, &gui_radar.fbo );
+      glDeleteTextures( 1, &gui_radar.tex );
+      gui_radar.fbo = 0;
+      gui_radar.tex = 0;
+   }
+   array_free( radar_live );
+   radar_live = NULL;
+
    osd_exit();
 
    gl_freeTexture( gui_ico_hail );
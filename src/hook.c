@@ -22,6 +22,7 @@
 /** @cond */
 #include <assert.h>
 #include <stdlib.h>
+#include "SDL.h"
 
 #include "naev.h"
 /** @endcond */
@@ -30,6 +31,7 @@
 
 #include "array.h"
 #include "claim.h"
+#include "conf.h"
 #include "event.h"
 #include "gatherable.h"
 #include "log.h"
@@ -41,6 +43,7 @@
 #include "nstring.h"
 #include "nxml.h"
 #include "player.h"
+#include "profiler.h"
 #include "space.h"
 
 /**
@@ -73,6 +76,7 @@ typedef enum HookType_e {
  */
 typedef struct Hook_ {
    struct Hook_ *next; /**< Linked list. */
+   struct Hook_ *stacknext; /**< Next hook in the same stack (dispatch index chain). */
 
    unsigned int id; /**< unique id */
    char *stack; /**< stack it's a part of */
@@ -112,9 +116,21 @@ typedef struct Hook_ {
  */
 static unsigned int hook_id   = 0; /**< Unique hook id generator. */
 static Hook* hook_list        = NULL; /**< Stack of hooks. */
+/**
+ * @brief Maps a stack name to the chain of hooks belonging to it.
+ */
+typedef struct HookStackIndex_ {
+   char *stack; /**< Name of the stack. */
+   Hook *head; /**< Head of the chain of hooks in the stack. */
+} HookStackIndex;
+static HookStackIndex *hook_stacks = NULL; /**< Dispatch index, so running a stack only touches its own hooks. */
 static int hook_runningstack  = 0; /**< Check if stack is running. */
 static int hook_loadingstack  = 0; /**< Check if the hooks are being loaded. */
 
+#define HOOK_BUDGET_MS 5. /**< Per-run time budget; overruns get warned about
+                               (with the profiler on) so offender scripts are
+                               identifiable in the field. */
+
 /*
  * prototypes
  */
@@ -123,7 +139,11 @@ static int hooks_executeParam( const char* stack, const HookParam *param );
 static void hooks_updateDateExecute( ntime_t change );
 /* intern */
 static void hook_rmRaw( Hook *h );
+static Hook** hook_stackHead( const char *stack, int create );
+static void hook_stackAdd( Hook *h );
+static void hook_stackRm( Hook *h );
 static void hooks_purgeList (void);
+static void hook_profName( Hook *hook, char *buf, size_t len );
 static Hook* hook_get( unsigned int id );
 static unsigned int hook_genID (void);
 static Hook* hook_new( HookType_t type, const char *stack );
@@ -388,6 +408,30 @@ static int hook_runEvent( Hook *hook, const HookParam *param, int claims )
    return 0;
 }
 
+/**
+ * @brief Formats a profiling label identifying the hook's script and function.
+ */
+static void hook_profName( Hook *hook, char *buf, size_t len )
+{
+   const Mission *misn;
+   switch (hook->type) {
+      case HOOK_TYPE_MISN:
+         misn = hook_getMission( hook );
+         snprintf( buf, len, "%s:%s",
+               (misn != NULL) ? misn->data->name : "?", hook->u.misn.func );
+         break;
+
+      case HOOK_TYPE_EVENT:
+         snprintf( buf, len, "%s:%s",
+               event_getData( hook->u.event.parent ), hook->u.event.func );
+         break;
+
+      default:
+         snprintf( buf, len, "C:%s", (hook->stack != NULL) ? hook->stack : "?" );
+         break;
+   }
+}
+
 /**
  * @brief Runs a hook.
  *
@@ -399,6 +443,8 @@ static int hook_runEvent( Hook *hook, const HookParam *param, int claims )
 static int hook_run( Hook *hook, const HookParam *param, int claims )
 {
    int ret;
+   char label[96];
+   Uint64 t0 = 0;
 
    /* Do not run if pending deletion. */
    if (hook->delete)
@@ -408,6 +454,13 @@ static int hook_run( Hook *hook, const HookParam *param, int claims )
    if (menu_isOpen(MENU_MAIN))
       return 0;
 
+   /* Label and time the run with the profiler on; the label has to be
+    * built up front since the mission/event may finish inside the run. */
+   if (conf.profiler) {
+      hook_profName( hook, label, sizeof(label) );
+      t0 = SDL_GetPerformanceCounter();
+   }
+
    switch (hook->type) {
       case HOOK_TYPE_MISN:
          ret = hook_runMisn(hook, param, claims);
@@ -431,6 +484,15 @@ static int hook_run( Hook *hook, const HookParam *param, int claims )
          return -1;
    }
 
+   if (t0 != 0) {
+      double ms = 1e3 * (double)(SDL_GetPerformanceCounter() - t0)
+            / (double)SDL_GetPerformanceFrequency();
+      prof_hookTime( label, ms );
+      if (ms > HOOK_BUDGET_MS)
+         WARN(_("Hook [%s] '%s' took %.1f ms (budget %.0f ms)"),
+               hook->stack, label, ms, HOOK_BUDGET_MS );
+   }
+
    return ret;
 }
 
@@ -455,6 +517,67 @@ static unsigned int hook_genID (void)
    return id;
 }
 
+/**
+ * @brief Gets the chain head for a stack from the dispatch index.
+ *
+ *    @param stack Name of the stack to look up.
+ *    @param create Whether or not to create the index entry if it is missing.
+ *    @return Pointer to the chain head or NULL if not found and not creating.
+ */
+static Hook** hook_stackHead( const char *stack, int create )
+{
+   HookStackIndex *hs;
+
+   if (hook_stacks == NULL) {
+      if (!create)
+         return NULL;
+      hook_stacks = array_create( HookStackIndex );
+   }
+
+   for (int i=0; i<array_size(hook_stacks); i++)
+      if (strcmp( hook_stacks[i].stack, stack )==0)
+         return &hook_stacks[i].head;
+
+   if (!create)
+      return NULL;
+
+   hs        = &array_grow( &hook_stacks );
+   hs->stack = strdup( stack );
+   hs->head  = NULL;
+   return &hs->head;
+}
+
+/**
+ * @brief Adds a hook to its stack's dispatch chain.
+ *
+ *    @param h Hook to add.
+ */
+static void hook_stackAdd( Hook *h )
+{
+   Hook **head  = hook_stackHead( h->stack, 1 );
+   /* Prepend like hook_list so relative order matches. */
+   h->stacknext = *head;
+   *head        = h;
+}
+
+/**
+ * @brief Removes a hook from its stack's dispatch chain.
+ *
+ *    @param h Hook to remove.
+ */
+static void hook_stackRm( Hook *h )
+{
+   Hook **head = hook_stackHead( h->stack, 0 );
+   if (head == NULL)
+      return;
+   for (Hook **p=head; *p!=NULL; p=&(*p)->stacknext)
+      if (*p == h) {
+         *p = h->stacknext;
+         h->stacknext = NULL;
+         return;
+      }
+}
+
 /**
  * @brief Generates and allocates a new hook.
  *
@@ -484,6 +607,9 @@ static Hook* hook_new( HookType_t type, const char *stack )
    if (strcmp(stack,"safe")==0)
       new_hook->once = 1;
 
+   /* Index by stack so dispatch only touches relevant hooks. */
+   hook_stackAdd( new_hook );
+
    return new_hook;
 }
 
@@ -614,6 +740,7 @@ static void hooks_purgeList (void)
 
          /* Free. */
          h->next = NULL;
+         hook_stackRm( h );
          hook_free( h );
 
          /* Last. */
@@ -859,22 +986,27 @@ int hook_hasEventParent( unsigned int parent )
 static int hooks_executeParam( const char* stack, const HookParam *param )
 {
    int run;
+   Hook **head;
 
    /* Don't update if player is dead. */
    if ((player.p == NULL) || player_isFlag(PLAYER_DESTROYED))
       return 0;
 
+   /* No hooks on this stack, nothing to do. */
+   head = hook_stackHead( stack, 0 );
+   if (head == NULL)
+      return 0;
+
    /* Reset the current stack's ran and creation flags. */
-   for (Hook *h=hook_list; h!=NULL; h=h->next)
-      if (strcmp(stack, h->stack)==0) {
-         h->ran_once = 0;
-         h->created = 0;
-      }
+   for (Hook *h=*head; h!=NULL; h=h->stacknext) {
+      h->ran_once = 0;
+      h->created = 0;
+   }
 
    run = 0;
    hook_runningstack++; /* running hooks */
    for (int j=1; j>=0; j--) {
-      for (Hook *h=hook_list; h!=NULL; h=h->next) {
+      for (Hook *h=*head; h!=NULL; h=h->stacknext) {
          /* Should be deleted. */
          if (h->delete)
             continue;
@@ -884,9 +1016,6 @@ static int hooks_executeParam( const char* stack, const HookParam *param )
          /* Don't update newly created hooks. */
          if (h->created != 0)
             continue;
-         /* Doesn't match stack. */
-         if (strcmp(stack, h->stack) != 0)
-            continue;
 
          /* Run hook. */
          hook_run( h, param, j );
@@ -1096,6 +1225,12 @@ void hook_cleanup (void)
    }
    /* safe defaults just in case */
    hook_list  = NULL;
+
+   /* Tear down the dispatch index. */
+   for (int i=0; i<array_size(hook_stacks); i++)
+      free( hook_stacks[i].stack );
+   array_free( hook_stacks );
+   hook_stacks = NULL;
 }
 
 /**
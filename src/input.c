@@ -30,6 +30,7 @@
 #include "pause.h"
 #include "pilot.h"
 #include "player.h"
+#include "profiler.h"
 #include "toolkit.h"
 #include "weapon.h"
 #include "utf8.h"
@@ -1165,6 +1166,36 @@ static void input_mouseMove( SDL_Event* event )
    player.mousey = my;
 }
 
+/**
+ * @brief Refreshes the mouse aim position between physics substeps.
+ *
+ * The main loop only drains the event queue once per frame, so at low
+ * frame rates mouse flying aims at a position a whole frame stale. This
+ * peeks the newest pending motion event — without consuming it, so the
+ * regular event loop still sees everything as before — and applies it
+ * so aiming tracks at substep cadence. Coalescing falls out naturally:
+ * only the latest position matters.
+ *
+ * Key events deliberately stay queued until the main loop: their
+ * handlers can open windows and nested main loops, which is not safe in
+ * the middle of an update.
+ */
+void input_pollSubstep (void)
+{
+   SDL_Event events[16];
+   int n;
+
+   /* Only mouse flying consumes the aim position mid-update. */
+   if (!player_isFlag( PLAYER_MFLY ))
+      return;
+
+   SDL_PumpEvents();
+   n = SDL_PeepEvents( events, 16, SDL_PEEKEVENT,
+         SDL_MOUSEMOTION, SDL_MOUSEMOTION );
+   if (n > 0)
+      input_mouseMove( &events[n-1] );
+}
+
 /**
  * @brief Handles a click event.
  */
@@ -1487,6 +1518,9 @@ void input_handle( SDL_Event* event )
 {
    int ismouse;
 
+   /* Stamp for the input-to-present latency harness. */
+   prof_inputEvent( event->common.timestamp );
+
    /* Special case mouse stuff. */
    if ((event->type == SDL_MOUSEMOTION)  ||
          (event->type == SDL_MOUSEBUTTONDOWN) ||
@@ -75,6 +75,7 @@ void input_exit (void);
  * Updating.
  */
 void input_update( double dt );
+void input_pollSubstep (void);
 
 /*
  * Mouse.
@@ -87,6 +87,8 @@ static glTexture *gfx_exterior = NULL; /**< Exterior graphic of the landed spob.
  */
 static Mission* mission_computer = NULL; /**< Missions at the computer. */
 static int mission_ncomputer = 0; /**< Number of missions at the computer. */
+static MissionGen misn_computer_gen; /**< In-progress computer mission generation. */
+static int misn_computer_pending = 0; /**< Whether generation is still running. */
 
 /*
  * Bar stuff.
@@ -120,6 +122,7 @@ static int land_gc( void *unused );
 static int land_hasLocalMap (void);
 static void land_createMainTab( unsigned int wid );
 static void land_setupTabs (void);
+static void land_openTab( int window );
 static void land_cleanupWindow( unsigned int wid, const char *name );
 static void land_changeTab( unsigned int wid, const char *wgt, int old, int tab );
 /* spaceport bar */
@@ -137,6 +140,36 @@ static void misn_accept( unsigned int wid, const char *str );
 static void misn_genList( unsigned int wid, int first );
 static void misn_update( unsigned int wid, const char *str );
 
+/* Landing data pregenerated at landing approach so the land window has it
+ * ready the moment it opens. */
+static Spob *land_prepared = NULL; /**< Spob the data below was prepared for. */
+static glTexture *land_prepared_gfx = NULL; /**< Pre-loaded exterior graphic. */
+
+/**
+ * @brief Pregenerates landing data while the landing animation runs.
+ *
+ * Called when landing is initiated; the landing delay hides the exterior
+ * graphic load and the news generation that land() would otherwise do
+ * synchronously when the window opens.
+ *
+ *    @param p Spob the player is landing on.
+ */
+void land_prepare( Spob *p )
+{
+   if ((p == NULL) || (p == land_prepared))
+      return;
+
+   /* Drop whatever was prepared for another spob. */
+   gl_freeTexture( land_prepared_gfx );
+   land_prepared_gfx = NULL;
+
+   land_prepared = p;
+   if (p->gfx_exterior != NULL)
+      land_prepared_gfx = gl_newImage( p->gfx_exterior, 0 );
+   if (spob_hasService( p, SPOB_SERVICE_BAR ))
+      generate_news( p->presence.faction );
+}
+
 /**
  * @brief Queue a takeoff.
  */
@@ -453,6 +486,8 @@ void bar_regen (void)
       return;
    if (!land_loaded)
       return;
+   if (!land_tabGenerated(LAND_WINDOW_BAR))
+      return; /* Gets built fresh when first opened. */
    bar_genList( land_getWid(LAND_WINDOW_BAR) );
 }
 /**
@@ -601,6 +636,13 @@ static void misn_open( unsigned int wid )
 {
    int w,h, y;
 
+   /* The background generation may not have finished yet. */
+   if (misn_computer_pending) {
+      mission_computer = missions_genListFinish( &misn_computer_gen,
+            &mission_ncomputer );
+      misn_computer_pending = 0;
+   }
+
    /* Mark as generated. */
    land_tabGenerate(LAND_WINDOW_MISSION);
 
@@ -816,7 +858,7 @@ void land_refuel (void)
    player.p->fuel = player.p->fuel_max;
 
    w = land_getWid( LAND_WINDOW_EQUIPMENT );
-   if (w > 0)
+   if ((w > 0) && land_tabGenerated(LAND_WINDOW_EQUIPMENT))
       equipment_updateShips( w, NULL ); /* Must update counter. */
 }
 
@@ -848,7 +890,7 @@ static void spaceport_buyMap( unsigned int wid, const char *str )
 
    /* Update map quantity in outfitter. */
    w = land_getWid( LAND_WINDOW_OUTFITS );
-   if (w > 0)
+   if ((w > 0) && land_tabGenerated(LAND_WINDOW_OUTFITS))
       outfits_regenList( w, NULL );
 
    /* Update main tab. */
@@ -1103,41 +1145,20 @@ void land_genWindows( int load, int changetab )
       /* Generate bar missions first for claims. */
       if (spob_hasService(land_spob, SPOB_SERVICE_BAR))
          npc_generateMissions(); /* Generate bar npc. */
-      if (spob_hasService(land_spob, SPOB_SERVICE_MISSIONS))
-         mission_computer = missions_genList( &mission_ncomputer,
+      if (spob_hasService(land_spob, SPOB_SERVICE_MISSIONS)) {
+         /* Computer missions evaluate their cond/create Lua over the
+          * following frames (land_update()) instead of freezing this
+          * one; opening the tab early finishes the remainder. */
+         missions_genListStart( &misn_computer_gen,
                land_spob->presence.faction, land_spob, cur_system,
                MIS_AVAIL_COMPUTER );
+         misn_computer_pending = 1;
+      }
    }
 
-   /* 4) Create other tabs. */
-#define should_open(s, w) \
-   (spob_hasService(land_spob, s) && (!land_tabGenerated(w)))
-
-   /* Things get a bit hairy here. Hooks may have triggered a GUI reload via
-    * e.g. player.swapShip, so the land tabs may have been generated already
-    * and we need to check that before regenerating them.
-    */
-
-   /* Basic - bar + missions */
-   if (should_open( SPOB_SERVICE_BAR, LAND_WINDOW_BAR ))
-      bar_open( land_getWid(LAND_WINDOW_BAR) );
-   if (should_open( SPOB_SERVICE_MISSIONS, LAND_WINDOW_MISSION ))
-      misn_open( land_getWid(LAND_WINDOW_MISSION) );
-   /* Outfits. */
-   if (should_open( SPOB_SERVICE_OUTFITS, LAND_WINDOW_OUTFITS ))
-      outfits_open( land_getWid(LAND_WINDOW_OUTFITS), NULL );
-   /* Shipyard. */
-   if (should_open( SPOB_SERVICE_SHIPYARD, LAND_WINDOW_SHIPYARD ))
-      shipyard_open( land_getWid(LAND_WINDOW_SHIPYARD) );
-   /* Equipment. */
-   if ((spob_hasService(land_spob, SPOB_SERVICE_OUTFITS) ||
-         spob_hasService(land_spob, SPOB_SERVICE_SHIPYARD)) &&
-         !land_tabGenerated( LAND_WINDOW_EQUIPMENT ))
-      equipment_open( land_getWid(LAND_WINDOW_EQUIPMENT) );
-   /* Commodity. */
-   if (should_open( SPOB_SERVICE_COMMODITY, LAND_WINDOW_COMMODITY ))
-      commodity_exchange_open( land_getWid(LAND_WINDOW_COMMODITY) );
-#undef should_open
+   /* 4) Other tabs get generated lazily on first activation (see
+    * land_openTab()); only the restored tab below pays its cost now, so
+    * landing shows the main tab as soon as the hooks are done. */
 
    if (!regen) {
       /* Reset markers if needed. */
@@ -1227,16 +1248,22 @@ void land( Spob* p, int load )
    player.p->nav_spob = -1;
    gui_setNav();
 
-   /* Load stuff */
+   /* Load stuff; landing approach may have prepared it already. */
    land_spob = p;
-   gfx_exterior = gl_newImage( p->gfx_exterior, 0 );
+   if ((land_prepared == p) && (land_prepared_gfx != NULL)) {
+      gfx_exterior = land_prepared_gfx;
+      land_prepared_gfx = NULL;
+   }
+   else
+      gfx_exterior = gl_newImage( p->gfx_exterior, 0 );
 
    /* Run outfits as necessary. */
    pilot_outfitLOnland( player.p );
 
-   /* Generate the news. */
-   if (spob_hasService(land_spob, SPOB_SERVICE_BAR))
+   /* Generate the news unless the approach already did. */
+   if ((land_prepared != p) && spob_hasService(land_spob, SPOB_SERVICE_BAR))
       news_load();
+   land_prepared = NULL;
 
    /* Average economy prices that player has seen */
    economy_averageSeenPrices( p );
@@ -1359,6 +1386,46 @@ static void land_createMainTab( unsigned int wid )
    }
 }
 
+/**
+ * @brief Generates a tab's content the first time it gets activated.
+ *
+ * The tabbed window itself is created up front by land_setupTabs(); the
+ *  widgets and lists of everything but the main tab are built here on
+ *  demand so landing only pays for the tabs that actually get used.
+ *
+ *    @param window Land window to generate (LAND_WINDOW_MAIN ignored).
+ */
+static void land_openTab( int window )
+{
+   unsigned int w;
+   if (land_tabGenerated( window ))
+      return;
+   w = land_getWid( window );
+   switch (window) {
+      case LAND_WINDOW_BAR:
+         bar_open( w );
+         break;
+      case LAND_WINDOW_MISSION:
+         misn_open( w );
+         break;
+      case LAND_WINDOW_OUTFITS:
+         outfits_open( w, NULL );
+         break;
+      case LAND_WINDOW_SHIPYARD:
+         shipyard_open( w );
+         break;
+      case LAND_WINDOW_EQUIPMENT:
+         equipment_open( w );
+         break;
+      case LAND_WINDOW_COMMODITY:
+         commodity_exchange_open( w );
+         break;
+
+      default:
+         break;
+   }
+}
+
 /**
  * @brief Saves the last place the player was.
  *
@@ -1382,6 +1449,9 @@ static void land_changeTab( unsigned int wid, const char *wgt, int old, int tab
       if (land_windowsMap[i] != tab)
          continue;
       last_window = i;
+
+      /* Lazily generate the tab on first activation. */
+      land_openTab( i );
       w = land_getWid( i );
 
       /* Must regenerate outfits. */
@@ -1437,7 +1507,7 @@ static void land_changeTab( unsigned int wid, const char *wgt, int old, int tab
    {
       /* Run hooks, run after music in case hook wants to change music. */
       if (torun_hook != NULL)
-         if (hooks_run( torun_hook ) > 0)
+         if ((hooks_run( torun_hook ) > 0) && land_tabGenerated(LAND_WINDOW_BAR))
             bar_genList( land_getWid(LAND_WINDOW_BAR) );
 
       visited(to_visit);
@@ -1605,6 +1675,10 @@ void takeoff( int delay, int nosave )
 
    /* Reset speed */
    player_autonavResetSpeed();
+
+   /* Full collection pass; the pause is invisible during the takeoff
+    * animation. Run in a hook since takeoff can be called from Lua. */
+   hook_addFunc( land_gc, NULL, "safe" );
 }
 
 /**
@@ -1613,7 +1687,7 @@ void takeoff( int delay, int nosave )
 static void land_stranded (void)
 {
    /* Nothing to do if there's no rescue script. */
-   if (!PHYSFS_exists(RESCUE_PATH))
+   if (!ndata_exists(RESCUE_PATH))
       return;
 
    if (rescue_env == LUA_NOREF) {
@@ -1648,6 +1722,36 @@ static void land_stranded (void)
    }
 }
 
+/**
+ * @brief Per-frame upkeep while landed.
+ *
+ * Advances the background mission computer generation by a small time
+ * slice; by the time the player opens the tab it has usually completed.
+ */
+void land_update (void)
+{
+   if (!landed || !misn_computer_pending)
+      return;
+   if (!missions_genListStep( &misn_computer_gen, 0.002 ))
+      return;
+   mission_computer = missions_genListFinish( &misn_computer_gen,
+         &mission_ncomputer );
+   misn_computer_pending = 0;
+}
+
+/**
+ * @brief Whether the landed state is quiescent.
+ *
+ * True when the player is landed and no background work remains, so the
+ * main loop can drop to event-driven rendering.
+ *
+ *    @return 1 when landed and idle.
+ */
+int land_isIdle (void)
+{
+   return landed && !misn_computer_pending;
+}
+
 /**
  * @brief Cleans up some land-related variables.
  */
@@ -1670,10 +1774,19 @@ void land_cleanup (void)
       gl_freeTexture( gfx_exterior );
    gfx_exterior   = NULL;
 
+   /* Drop unconsumed approach data. */
+   gl_freeTexture( land_prepared_gfx );
+   land_prepared_gfx = NULL;
+   land_prepared  = NULL;
+
    /* Remove computer markers just in case. */
    space_clearComputerMarkers();
 
    /* Clean up mission computer. */
+   if (misn_computer_pending) {
+      missions_genListAbort( &misn_computer_gen );
+      misn_computer_pending = 0;
+   }
    for (int i=0; i<mission_ncomputer; i++)
       mission_cleanup( &mission_computer[i] );
    free(mission_computer);
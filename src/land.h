@@ -52,6 +52,7 @@ extern unsigned int land_generated;
 /*
  * Main interface.
  */
+void land_prepare( Spob *p );
 void land_queueTakeoff (void);
 void land_needsTakeoff( int delay );
 int land_canSave (void);
@@ -59,6 +60,8 @@ int land_doneLoading (void);
 void land( Spob* p, int load );
 void land_genWindows( int load, int changetab );
 void takeoff( int delay, int nosave );
+void land_update (void);
+int land_isIdle (void);
 void land_cleanup (void);
 void land_exit (void);
 int land_setWindow( int window );
@@ -62,6 +62,7 @@ static void outfits_renderMod( double bx, double by, double w, double h, void *d
 static void outfits_rmouse( unsigned int wid, const char* widget_name );
 static void outfits_find( unsigned int wid, const char *str );
 static const char *outfit_getPrice( const Outfit *outfit, credits_t *price, int *canbuy, int *cansell );
+static char* outfits_altTextCell( const void *data );
 static void outfit_Popdown( unsigned int wid, const char* str );
 static void outfits_genList( unsigned int wid );
 static void outfits_changeTab( unsigned int wid, const char *wgt, int old, int tab );
@@ -523,15 +524,20 @@ void outfits_updateEquipmentOutfits( void )
 {
    if (landed && land_doneLoading()) {
       if (spob_hasService(land_spob, SPOB_SERVICE_OUTFITS)) {
-         int ow = land_getWid( LAND_WINDOW_OUTFITS );
-         outfits_regenList( ow, NULL );
+         /* Non-generated tabs get built fresh when first opened. */
+         if (land_tabGenerated(LAND_WINDOW_OUTFITS)) {
+            int ow = land_getWid( LAND_WINDOW_OUTFITS );
+            outfits_regenList( ow, NULL );
+         }
       }
       else if (!spob_hasService(land_spob, SPOB_SERVICE_SHIPYARD))
          return;
 
-      int ew = land_getWid( LAND_WINDOW_EQUIPMENT );
       equipment_addAmmo();
-      equipment_regenLists( ew, 1, 0 );
+      if (land_tabGenerated(LAND_WINDOW_EQUIPMENT)) {
+         int ew = land_getWid( LAND_WINDOW_EQUIPMENT );
+         equipment_regenLists( ew, 1, 0 );
+      }
    }
 }
 
@@ -645,6 +651,49 @@ static const char *outfit_getPrice( const Outfit *outfit, credits_t *price, int
    return pricestr;
 }
 
+/*
+ * Formatting the alt text walks the whole stat list through
+ * ss_statsDesc(), which showed up in landed-screen profiles since the
+ * image-array cells regenerate it on every list rebuild. The formatted
+ * result only depends on the outfit and the locale, so it is kept per
+ * outfit and thrown away when the language changes; the draws
+ * themselves already go through the shaped-run cache in font.c.
+ */
+static char **outfits_alt_cache = NULL; /**< Array (array.h): cached alt text, parallel to outfit_getAll(). */
+
+/**
+ * @brief Gets the cached alt text of an outfit, formatting it on a miss.
+ */
+const char *outfit_altTextCached( const Outfit *o )
+{
+   const Outfit *stack = outfit_getAll();
+   ptrdiff_t idx = o - stack;
+
+   if (outfits_alt_cache == NULL) {
+      outfits_alt_cache = array_create_size( char*, array_size(stack) );
+      for (int i=0; i<array_size(stack); i++)
+         array_push_back( &outfits_alt_cache, NULL );
+   }
+
+   if (outfits_alt_cache[idx] == NULL) {
+      char buf[STRMAX];
+      outfit_altText( buf, sizeof(buf), o );
+      outfits_alt_cache[idx] = strdup( buf );
+   }
+   return outfits_alt_cache[idx];
+}
+
+/**
+ * @brief Throws away the cached alt texts; meant for language changes.
+ */
+void outfits_altCacheClear (void)
+{
+   for (int i=0; i<array_size(outfits_alt_cache); i++)
+      free( outfits_alt_cache[i] );
+   array_free( outfits_alt_cache );
+   outfits_alt_cache = NULL;
+}
+
 /**
  * @brief Computes the alt text for an outfit.
  */
@@ -677,6 +726,17 @@ int outfit_altText( char *buf, int n, const Outfit *o )
    return 0;
 }
 
+/**
+ * @brief Generates the alt text for an outfit cell on demand.
+ *
+ *    @param data Outfit the cell represents.
+ *    @return Newly allocated alt text.
+ */
+static char* outfits_altTextCell( const void *data )
+{
+   return strdup( outfit_altTextCached( data ) );
+}
+
 /**
  * @brief Generates image array cells corresponding to outfits.
  */
@@ -707,12 +767,10 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits )
             c = &cBlack;
          col_blend( &coutfits[i].bg, c, &cGrey70, 1 );
 
-         /* Short description. */
-         if (o->desc_short == NULL)
-            coutfits[i].alt = NULL;
-         else {
-            coutfits[i].alt = malloc( STRMAX );
-            outfit_altText( coutfits[i].alt, STRMAX, o );
+         /* Short description, generated lazily on first hover. */
+         if (o->desc_short != NULL) {
+            coutfits[i].altfunc = outfits_altTextCell;
+            coutfits[i].altdata = o;
          }
 
          /* Slot type. */
@@ -1090,4 +1148,5 @@ void outfits_cleanup(void)
       free(iar_outfits);
       iar_outfits = NULL;
    }
+   outfits_altCacheClear();
 }
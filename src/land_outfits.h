@@ -8,6 +8,8 @@
 #include "tk/widget/imagearray.h"
 
 int outfit_altText( char *buf, int n, const Outfit *o );
+const char *outfit_altTextCached( const Outfit *o );
+void outfits_altCacheClear (void);
 
 void outfits_open( unsigned int wid, const Outfit **outfits );
 void outfits_regenList( unsigned int wid, const char *str );
@@ -580,7 +580,8 @@ static void shipyard_trade( unsigned int wid, const char* str )
    wid = land_getWid(LAND_WINDOW_SHIPYARD);
 
    /* Update shipyard. */
-   shipyard_update(wid, NULL);
+   if (land_tabGenerated(LAND_WINDOW_SHIPYARD))
+      shipyard_update(wid, NULL);
 }
 
 /**
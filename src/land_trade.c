@@ -353,6 +353,7 @@ void commodity_buy( unsigned int wid, const char *str )
 
    /* Make the buy. */
    q = pfleet_cargoAdd( com, q );
+   economy_tradeModify( cur_system, com, (int)q );
    com->lastPurchasePrice = price; /* To show the player how much they paid for it */
    price *= q;
    player_modCredits( -price );
@@ -394,6 +395,7 @@ void commodity_sell( unsigned int wid, const char *str )
 
    /* Remove commodity. */
    q = pfleet_cargoRm( com, q, 0 );
+   economy_tradeModify( cur_system, com, -(int)q );
    price = price * (credits_t)q;
    player_modCredits( price );
    if (pfleet_cargoOwned( com ) == 0) /* None left, set purchase price to zero, in case missions add cargo. */
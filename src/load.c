@@ -9,6 +9,7 @@
 
 /** @cond */
 #include "physfs.h"
+#include "SDL.h"
 
 #include "naev.h"
 /** @endcond */
@@ -39,6 +40,7 @@
 #include "shiplog.h"
 #include "start.h"
 #include "space.h"
+#include "threadpool.h"
 #include "toolkit.h"
 #include "unidiff.h"
 
@@ -65,6 +67,8 @@ static player_saves_t *load_saves = NULL; /**< Array of saves */
 static player_saves_t *load_player = NULL; /**< Points to current element in load_saves. */
 static int old_saves_detected = 0, player_warned = 0;
 static char *selected_player = NULL;
+static SDL_sem *load_scan_done = NULL; /**< Posted when the background scan finishes. */
+static int load_scan_pending   = 0;    /**< Whether a background scan is in flight. */
 extern int save_loaded; /**< From save.c */
 
 /*
@@ -103,6 +107,9 @@ static void load_snapshot_menu_save( unsigned int wdw, const char *str );
 static void display_save_info( unsigned int wid, const nsave_t *ns );
 static void move_old_save( const char *path, const char *fname, const char *ext, const char *new_name );
 static int load_load( nsave_t *save, const char *path );
+static int load_parse( nsave_t *save, const char *path, xmlDocPtr doc );
+static int load_indexFresh( const char *path, const char *idxpath );
+static void load_indexWrite( const nsave_t *ns, const char *idxpath );
 static int load_game( nsave_t *ns );
 static int load_gameInternal( const char* file, const char* version );
 static int load_enumerateCallback( void* data, const char* origdir, const char* fname );
@@ -112,10 +119,18 @@ static const char* load_compatibilityString( const nsave_t *ns );
 static SaveCompatibility load_compatibility( const nsave_t *ns );
 static int load_sortComparePlayers( const void *p1, const void *p2 );
 static int load_sortCompare( const void *p1, const void *p2 );
+static int load_scanJob( void *data );
+static void load_scanSync (void);
 static xmlDocPtr load_xml_parsePhysFS( const char* filename );
 
 /**
  * @brief Loads an individual save.
+ *
+ * Reads the sidecar index when it is up to date; the index repeats just
+ *  the header fields the load menu shows, so refreshing a large save
+ *  directory doesn't parse every full save document. Saves without a
+ *  usable index get parsed in full once and indexed on the spot.
+ *
  * @param[out] save Structure to populate.
  * @param path PhysicsFS path (i.e., relative path starting with "saves/").
  * @return 0 on success.
@@ -123,21 +138,52 @@ static xmlDocPtr load_xml_parsePhysFS( const char* filename );
 static int load_load( nsave_t *save, const char *path )
 {
    xmlDocPtr doc;
-   xmlNodePtr root, parent, node, cur;
-   int cycles, periods, seconds;
+   char idxpath[PATH_MAX];
+   int ret;
 
    memset( save, 0, sizeof(nsave_t) );
 
-   /* Load the XML. */
+   /* Try the index first. */
+   snprintf( idxpath, sizeof(idxpath), "%s.idx", path );
+   if (load_indexFresh( path, idxpath )) {
+      doc = load_xml_parsePhysFS( idxpath );
+      if (doc != NULL) {
+         ret = load_parse( save, path, doc );
+         xmlFreeDoc(doc);
+         if (ret == 0)
+            return 0;
+      }
+   }
+
+   /* No usable index; parse the save proper and index it for next time. */
    doc = load_xml_parsePhysFS( path );
    if (doc == NULL) {
       WARN( _("Unable to parse save path '%s'."), path);
       return -1;
    }
+   ret = load_parse( save, path, doc );
+   xmlFreeDoc(doc);
+   if (ret == 0)
+      load_indexWrite( save, idxpath );
+   return ret;
+}
+
+/**
+ * @brief Parses the header fields of a save (or index) document.
+ * @param[out] save Structure to populate.
+ * @param path PhysicsFS path of the save proper.
+ * @param doc Parsed document; both full saves and indexes work as the
+ *            index mirrors the header layout of the save.
+ * @return 0 on success.
+ */
+static int load_parse( nsave_t *save, const char *path, xmlDocPtr doc )
+{
+   xmlNodePtr root, parent, node, cur;
+   int cycles, periods, seconds;
+
    root = doc->xmlChildrenNode; /* base node */
    if (root == NULL) {
       WARN( _("Unable to get child node of save '%s'."), path);
-      xmlFreeDoc(doc);
       return -1;
    }
 
@@ -220,20 +266,108 @@ static int load_load( nsave_t *save, const char *path )
 
    save->compatible = load_compatibility( save );
 
-   /* Clean up. */
-   xmlFreeDoc(doc);
-
    return 0;
 }
 
+/**
+ * @brief Checks whether a save's sidecar index is up to date.
+ *    @param path PhysicsFS path of the save.
+ *    @param idxpath PhysicsFS path of its index.
+ *    @return 1 when the index can be used instead of the save.
+ */
+static int load_indexFresh( const char *path, const char *idxpath )
+{
+   PHYSFS_Stat s, si;
+   if (!PHYSFS_stat( idxpath, &si ))
+      return 0;
+   if (!PHYSFS_stat( path, &s ))
+      return 0;
+   return si.modtime >= s.modtime;
+}
+
+/**
+ * @brief Writes the sidecar index of a save.
+ *
+ * The index is a tiny XML document with the same header layout as the
+ *  save itself, so load_parse() handles both.
+ *
+ *    @param ns Parsed save to index.
+ *    @param idxpath PhysicsFS path to write the index to.
+ */
+static void load_indexWrite( const nsave_t *ns, const char *idxpath )
+{
+   char file[PATH_MAX];
+   xmlDocPtr doc = NULL;
+   xmlTextWriterPtr writer = xmlNewTextWriterDoc( &doc, 0 );
+   if (writer == NULL)
+      return;
+   xmlw_setParams( writer );
+
+   xmlw_start(writer);
+   xmlw_startElem(writer,"naev_save");
+
+   xmlw_startElem(writer,"version");
+   if (ns->version != NULL)
+      xmlw_elem( writer, "naev", "%s", ns->version );
+   if (ns->data != NULL)
+      xmlw_elem( writer, "data", "%s", ns->data );
+   xmlw_endElem(writer); /* "version" */
+
+   xmlw_startElem(writer,"plugins");
+   for (int i=0; i<array_size(ns->plugins); i++)
+      xmlw_elem( writer, "plugin", "%s", ns->plugins[i] );
+   xmlw_endElem(writer); /* "plugins" */
+
+   xmlw_startElem(writer,"player");
+   xmlw_attr(writer,"name","%s",ns->player_name);
+   if (ns->spob != NULL)
+      xmlw_elem( writer, "location", "%s", ns->spob );
+   xmlw_elem( writer, "credits", "%"CREDITS_PRI, ns->credits );
+   if (ns->chapter != NULL)
+      xmlw_elem( writer, "chapter", "%s", ns->chapter );
+   if (ns->difficulty != NULL)
+      xmlw_elem( writer, "difficulty", "%s", ns->difficulty );
+   xmlw_startElem(writer,"time");
+   xmlw_elem(writer,"SCU","%d", ntime_getCycles(ns->date));
+   xmlw_elem(writer,"STP","%d", ntime_getPeriods(ns->date));
+   xmlw_elem(writer,"STU","%d", ntime_getSeconds(ns->date));
+   xmlw_endElem(writer); /* "time" */
+   xmlw_startElem(writer,"ship");
+   if (ns->shipname != NULL)
+      xmlw_attr(writer,"name","%s",ns->shipname);
+   if (ns->shipmodel != NULL)
+      xmlw_attr(writer,"model","%s",ns->shipmodel);
+   xmlw_endElem(writer); /* "ship" */
+   xmlw_endElem(writer); /* "player" */
+
+   xmlw_endElem(writer); /* "naev_save" */
+   xmlw_done(writer);
+   xmlFreeTextWriter(writer);
+
+   snprintf( file, sizeof(file), "%s/%s", PHYSFS_getWriteDir(), idxpath );
+   if (xmlSaveFileEnc( file, doc, "UTF-8" ) < 0)
+      WARN( _("Unable to write save index '%s'."), idxpath );
+   xmlFreeDoc(doc);
+}
+
 /**
  * @brief Loads or refreshes saved games for the player.
  */
 int load_refresh (void)
 {
+   /* A background scan may already have produced the list. */
+   if (load_scan_pending) {
+      load_scanSync();
+      if (load_saves != NULL)
+         return 0;
+   }
+
    if (load_saves != NULL)
       load_free();
 
+   /* An asynchronous autosave may still be writing. */
+   save_sync();
+
    /* load the saves */
    load_saves = array_create( player_saves_t );
    PHYSFS_enumerate( "saves", load_enumerateCallback, NULL );
@@ -242,6 +376,51 @@ int load_refresh (void)
    return 0;
 }
 
+/**
+ * @brief Worker body of the background save scan; same work as
+ *        load_refresh(), including old-save migration and index writing.
+ */
+static int load_scanJob( void *data )
+{
+   (void) data;
+   load_saves = array_create( player_saves_t );
+   PHYSFS_enumerate( "saves", load_enumerateCallback, NULL );
+   qsort( load_saves, array_size(load_saves), sizeof(player_saves_t), load_sortComparePlayers );
+   SDL_SemPost( load_scan_done );
+   return 0;
+}
+
+/**
+ * @brief Scans, migrates and indexes the save directory on a worker thread.
+ *
+ * Meant to be kicked off while the data loading screen is up: old save
+ *  folders can carry years of unindexed files whose first parse takes
+ *  seconds, and doing it in parallel with data loading keeps the first
+ *  load_refresh() fast. Readers go through load_refresh(), which waits
+ *  for the scan before touching the list.
+ */
+void load_scanAsync (void)
+{
+   if (load_scan_pending || (load_saves != NULL))
+      return;
+   save_sync();
+   if (load_scan_done == NULL)
+      load_scan_done = SDL_CreateSemaphore( 0 );
+   load_scan_pending = 1;
+   threadpool_newJob( load_scanJob, NULL );
+}
+
+/**
+ * @brief Waits for a pending background save scan.
+ */
+static void load_scanSync (void)
+{
+   if (!load_scan_pending)
+      return;
+   SDL_SemWait( load_scan_done ); /* Blocks until the worker posts. */
+   load_scan_pending = 0;
+}
+
 static int load_enumerateCallbackPlayer( void* data, const char* origdir, const char* fname )
 {
    char *path;
@@ -260,7 +439,14 @@ static int load_enumerateCallbackPlayer( void* data, const char* origdir, const
    else if (stat.filetype == PHYSFS_FILETYPE_REGULAR) {
       player_saves_t *ps = (player_saves_t*) data;
       nsave_t ns;
-      int ret = load_load( &ns, path );
+      int ret;
+      size_t name_len = strlen( fname );
+      /* Skip the sidecar indexes living next to the saves. */
+      if ((name_len < 4) || strcmp( &fname[name_len-3], ".ns" )) {
+         free( path );
+         return PHYSFS_ENUM_OK;
+      }
+      ret = load_load( &ns, path );
       if (ret == 0) {
          ns.save_name = strdup( fname );
          ns.save_name[ strlen(ns.save_name)-3 ] = '\0';
@@ -449,6 +635,9 @@ static int load_sortCompare( const void *p1, const void *p2 )
  */
 void load_free (void)
 {
+   /* The background scan may still own the list. */
+   load_scanSync();
+
    for (int i=0; i<array_size(load_saves); i++) {
       player_saves_t *ps = &load_saves[i];
       free( ps->name );
@@ -924,9 +1113,12 @@ static void load_menu_delete( unsigned int wdw, const char *str )
 
    /* Remove it. */
    n = array_size( load_saves[pos].saves );
-   for (int i = 0; i < n; i++)
+   for (int i = 0; i < n; i++) {
+      snprintf( path, sizeof(path), "%s.idx", load_saves[pos].saves[i].path );
+      PHYSFS_delete( path ); /* Best effort; may not exist. */
       if (!PHYSFS_delete( load_saves[pos].saves[i].path ))
          dialogue_alert( _("Unable to delete %s"), load_saves[pos].saves[i].path );
+   }
    snprintf(path, sizeof(path), "saves/%s", load_saves[pos].name);
    if (!PHYSFS_delete( path ))
       dialogue_alert( _("Unable to delete '%s' directory"), load_saves[pos].name );
@@ -959,6 +1151,11 @@ static void load_snapshot_menu_delete( unsigned int wdw, const char *str )
 
    /* Remove it. */
    pos = toolkit_getListPos( wid, "lstSaves" );
+   {
+      char path[PATH_MAX];
+      snprintf( path, sizeof(path), "%s.idx", load_player->saves[pos].path );
+      PHYSFS_delete( path ); /* Best effort; may not exist. */
+   }
    PHYSFS_delete( load_player->saves[pos].path );
 
    load_refresh();
@@ -1096,8 +1293,11 @@ static int load_gameInternal( const char* file, const char* version )
       return -1;
    }
 
-   /* Load the XML. */
-   doc = load_xml_parsePhysFS( file );
+   /* Reuse the in-memory save snapshot when reloading the last save
+    * (death and the like), skipping the disk read and XML parse. */
+   doc = save_snapshotClaim( file );
+   if (doc == NULL)
+      doc = load_xml_parsePhysFS( file );
    if (doc == NULL)
       goto err;
    node  = doc->xmlChildrenNode; /* base node */
@@ -52,5 +52,6 @@ int load_gameDiff( const char* file );
 int load_gameFile( const char* file );
 
 int load_refresh (void);
+void load_scanAsync (void);
 void load_free (void);
 const nsave_t *load_getList( const char *name );
@@ -36,7 +36,6 @@
 
 #define BUTTON_WIDTH    100 /**< Map button width. */
 #define BUTTON_HEIGHT   30 /**< Map button height. */
-#define MAP_LOOP_PROT   1000 /**< Number of iterations max in pathfinding before aborting. */
 #define MAP_TEXT_INDENT   45 /**< Indentation of the text below the titles. */
 #define MAP_MARKER_CYCLE  750 /**< Time of a mission marker's animation cycle in milliseconds. */
 #define MAP_MOVE_THRESHOLD 20. /**< Mouse movement distance threshold */
@@ -93,6 +92,19 @@ static Commodity **commod_known = NULL; /**< index of known commodities */
 static char** map_modes       = NULL;   /**< Array (array.h) of the map modes' names, e.g. "Gold: Cost". */
 static int listMapModeVisible = 0;      /**< Whether the map mode list widget is visible. */
 static double commod_av_gal_price = 0;  /**< Average price across the galaxy. */
+
+/**
+ * @brief Precomputed per-system entry of the commodity display layer.
+ */
+typedef struct CommodLayer_ {
+   char sold;     /**< Commodity is priced somewhere in the system. */
+   char below;    /**< Price-difference mode: a loss, label drawn below. */
+   double value;  /**< Figure for the label: price, or best/worst profit. */
+   glColour col;  /**< Circle colour off the ramp; alpha applied at render. */
+} CommodLayer;
+static CommodLayer *commod_layer = NULL; /**< Layer over systems_stack; NULL when stale. */
+static int commod_layer_n = 0;          /**< Systems the layer was built over. */
+static int commod_layer_ignorance = 0;  /**< Selected system had no price info. */
 static double map_dt          = 0.;     /**< Nebula animation stuff. */
 static int map_minimal_mode   = 0;      /**< Map is in minimal mode. */
 static double map_flyto_speed = 1500.;  /**< Linear speeed at which the map flies to a location. */
@@ -100,6 +112,19 @@ static double map_mx          = 0.;     /**< X mouse position */
 static double map_my          = 0.;     /**< Y mouse position */
 static char map_show_notes    = 0;      /**< Boolean for showing system notes */
 
+/*
+ * Static layer cache.  Systems, jump lines, faction territory and the
+ * other layers that only change on pan/zoom/mode get rendered once into
+ * a texture and composited per frame; see map_render.
+ */
+static GLuint map_cacheFBO    = GL_INVALID_VALUE; /**< Static layer framebuffer. */
+static GLuint map_cacheTex    = GL_INVALID_VALUE; /**< Static layer texture. */
+static GLsizei map_cacheW     = 0;      /**< Width the cache was created at. */
+static GLsizei map_cacheH     = 0;      /**< Height the cache was created at. */
+static int map_cacheValid     = 0;      /**< Whether the cache can be composited. */
+static double map_cacheKey[10];         /**< Pan/zoom/geometry/alphas the cache was rendered with. */
+static int map_cacheMode      = 0;      /**< Display mode the cache was rendered with. */
+
 /*
  * extern
  */
@@ -145,6 +170,7 @@ static void map_buttonCommodity( unsigned int wid, const char* str );
 static void map_selectCur (void);
 static void map_genModeList(void);
 static void map_update_commod_av_price();
+static void map_commodCacheBuild (void);
 static void map_onClose( unsigned int wid, const char *str );
 
 /**
@@ -162,6 +188,15 @@ int map_init (void)
  */
 void map_exit (void)
 {
+   if (map_cacheFBO != GL_INVALID_VALUE) {
+      glDeleteFramebuffers( 1, &map_cacheFBO );
+      glDeleteTextures( 1, &map_cacheTex );
+      map_cacheFBO = GL_INVALID_VALUE;
+      map_cacheTex = GL_INVALID_VALUE;
+      map_cacheValid = 0;
+   }
+   free( commod_layer );
+   commod_layer = NULL;
    if (decorator_stack != NULL) {
       for (int i=0; i<array_size(decorator_stack); i++)
          gl_freeTexture( decorator_stack[i].image );
@@ -248,6 +283,9 @@ void map_open (void)
    const char *title = _("Star Map");
    const glColour cBG = { 0., 0., 0., 0.95 };
 
+   /* Anything may have changed since the map was last open. */
+   map_cacheInvalidate();
+
    map_minimal_mode = player.map_minimal;
    listMapModeVisible = 0;
 
@@ -428,6 +466,11 @@ static void map_update_commod_av_price (void)
 {
    Commodity *c;
 
+   /* The precomputed display layer depends on the commodity, mode and
+    * selection, all of which route through here; rebuild it lazily. */
+   free( commod_layer );
+   commod_layer = NULL;
+
    if (cur_commod == -1 || map_selected == -1) {
       commod_av_gal_price = 0;
       return;
@@ -931,25 +974,52 @@ static void map_drawMarker( double x, double y, double zoom,
    if (type==5) {
       col = cFontOrange;
       col.a *= a;
-      glUseProgram(shaders.notemarker.program);
+      gl_useProgram(shaders.notemarker.program);
       gl_renderShader( x, y, r, r, alpha, &shaders.notemarker, &col, 1 );
       return;
    }
 
-   glUseProgram(shaders.sysmarker.program);
+   /* Slashed and plain are separate precompiled variants. */
+   const SimpleShader *shd;
    if (type==0) {
       col_blend( &col, colours[type], &cWhite, MIN(1.0, 0.75 + 0.25*sin(2.0*M_PI*map_dt)) );
       x += 0.25*r * cos(alpha);
       y += 0.25*r * sin(alpha);
       r *= 1.25;
-      glUniform1i( shaders.sysmarker.parami, 1 );
+      shd = &shaders.sysmarker_slashed;
    }
    else {
       col_blend( &col, colours[type], &cWhite, MIN(1.0, 1.0 + 0.25*sin(2.0*M_PI*map_dt)) );
-      glUniform1i( shaders.sysmarker.parami, 0 );
+      shd = &shaders.sysmarker;
    }
+   gl_useProgram( shd->program );
    col.a *= a;
-   gl_renderShader( x, y, r, r, alpha, &shaders.sysmarker, &col, 1 );
+   gl_renderShader( x, y, r, r, alpha, shd, &col, 1 );
+}
+
+/**
+ * @brief Invalidates the static layer cache of the map.
+ *
+ * Call when the underlying map data changes (diffs, new knowledge);
+ *  pan, zoom, resizes and mode switches are detected automatically.
+ */
+void map_cacheInvalidate (void)
+{
+   map_cacheValid = 0;
+}
+
+/**
+ * @brief Invalidates the precomputed commodity display layer.
+ *
+ * Call when commodity prices change (economy updates); commodity, mode
+ *  and selection switches are handled internally. Also drops the static
+ *  layer cache since the baked circles are stale.
+ */
+void map_commodCacheInvalidate (void)
+{
+   free( commod_layer );
+   commod_layer = NULL;
+   map_cacheValid = 0;
 }
 
 /**
@@ -967,6 +1037,7 @@ static void map_render( double bx, double by, double w, double h, void *data )
    glColour col;
    StarSystem *sys;
    double dt = naev_getrealdt();
+   double key[10];
 
    /* Update timer. */
    map_dt += dt;
@@ -976,42 +1047,82 @@ static void map_render( double bx, double by, double w, double h, void *data )
    map_renderParams( bx, by, cst->xpos, cst->ypos, w, h, cst->zoom, &x, &y, &r );
    z = cst->zoom;
 
-   /* background */
-   gl_renderRect( bx, by, w, h, &cBlack );
+   /* The static layers (background, decorators, faction territory,
+    * environment, jump lines, system nodes, names, commodity info) only
+    * change on pan, zoom, resizes, mode switches and the open/close alpha
+    * transitions, so they composite from a cached texture: a fully
+    * zoomed-out map over hundreds of systems is a static image. */
+   key[0] = cst->xpos; key[1] = cst->ypos; key[2] = cst->zoom;
+   key[3] = bx;        key[4] = by;
+   key[5] = w;         key[6] = h;
+   key[7] = cst->alpha_decorators + 3.*cst->alpha_faction + 9.*cst->alpha_env;
+   key[8] = cst->alpha_names;
+   key[9] = cst->alpha_commod;
+   if (!map_cacheValid || (cst->mode != map_cacheMode) ||
+         (memcmp( key, map_cacheKey, sizeof(key) ) != 0)) {
+      /* (Re)create the cache at the current resolution. */
+      if ((map_cacheFBO == GL_INVALID_VALUE) ||
+            (map_cacheW != gl_screen.rw) || (map_cacheH != gl_screen.rh)) {
+         if (map_cacheFBO != GL_INVALID_VALUE) {
+            glDeleteFramebuffers( 1, &map_cacheFBO );
+            glDeleteTextures( 1, &map_cacheTex );
+         }
+         gl_fboCreate( &map_cacheFBO, &map_cacheTex, gl_screen.rw, gl_screen.rh );
+         map_cacheW = gl_screen.rw;
+         map_cacheH = gl_screen.rh;
+      }
+
+      glBindFramebuffer( GL_FRAMEBUFFER, map_cacheFBO );
+      glClearColor( 0., 0., 0., 0. );
+      glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+      /* background */
+      gl_renderRect( bx, by, w, h, &cBlack );
 
-   if (cst->alpha_decorators > 0.)
-      map_renderDecorators( x, y, z, 0, EASE_ALPHA(cst->alpha_decorators) );
+      if (cst->alpha_decorators > 0.)
+         map_renderDecorators( x, y, z, 0, EASE_ALPHA(cst->alpha_decorators) );
 
-   /* Render faction disks. */
-   if (cst->alpha_faction > 0.)
-      map_renderFactionDisks( x, y, z, r, 0, EASE_ALPHA(cst->alpha_faction) );
+      /* Render faction disks. */
+      if (cst->alpha_faction > 0.)
+         map_renderFactionDisks( x, y, z, r, 0, EASE_ALPHA(cst->alpha_faction) );
 
       /* Render environmental features. */
-   if (cst->alpha_env > 0.)
-      map_renderSystemEnvironment( x, y, z, 0, EASE_ALPHA(cst->alpha_env) );
+      if (cst->alpha_env > 0.)
+         map_renderSystemEnvironment( x, y, z, 0, EASE_ALPHA(cst->alpha_env) );
+
+      /* Render jump routes. */
+      map_renderJumps( x, y, z, r, 0 );
+
+      /* Render systems. */
+      map_renderSystems( bx, by, x, y, z, w, h, r, cst->mode );
+
+      /* Render system names and notes. */
+      if (cst->alpha_names > 0.)
+         map_renderNames( bx, by, x, y, z, w, h, 0, EASE_ALPHA(cst->alpha_names) );
 
-   /* Render jump routes. */
-   map_renderJumps( x, y, z, r, 0 );
+      /* Render commodity info. */
+      if (cst->alpha_commod > 0.)
+         map_renderCommod(  bx, by, x, y, z, w, h, r, 0, EASE_ALPHA(cst->alpha_commod) );
+
+      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+      glClearColor( 0., 0., 0., 1. );
+
+      memcpy( map_cacheKey, key, sizeof(key) );
+      map_cacheMode  = cst->mode;
+      map_cacheValid = 1;
+   }
+
+   /* Composite the static layers. */
+   toolkit_renderFBOTex( map_cacheTex, 1. );
 
    /* Render the player's jump route. */
    if (cst->alpha_path > 0.)
       map_renderPath( x, y, z, r, EASE_ALPHA(cst->alpha_path) );
 
-   /* Render systems. */
-   map_renderSystems( bx, by, x, y, z, w, h, r, cst->mode );
-
    /* Render system markers and notes. */
    if (cst->alpha_markers > 0.)
       map_renderMarkers( x, y, z, r, EASE_ALPHA(cst->alpha_markers) );
 
-   /* Render system names and notes. */
-   if (cst->alpha_names > 0.)
-      map_renderNames( bx, by, x, y, z, w, h, 0, EASE_ALPHA(cst->alpha_names) );
-
-   /* Render commodity info. */
-   if (cst->alpha_commod > 0.)
-      map_renderCommod(  bx, by, x, y, z, w, h, r, 0, EASE_ALPHA(cst->alpha_commod) );
-
    /* We want the notes on top of everything. */
    if (cst->alpha_markers > 0.)
       map_renderNotes( bx, by, x, y, z, w, h, 0, EASE_ALPHA(cst->alpha_markers) );
@@ -1024,7 +1135,7 @@ static void map_render( double bx, double by, double w, double h, void *data )
    /* Selected system. */
    if (map_selected != -1) {
       sys = system_getIndex( map_selected );
-      glUseProgram( shaders.selectspob.program );
+      gl_useProgram( shaders.selectspob.program );
       glUniform1f( shaders.selectspob.dt, map_dt ); /* good enough. */
       gl_renderShader( x + sys->pos.x * z, y + sys->pos.y * z,
             1.7*r, 1.7*r, 0., &shaders.selectspob, &cRadar_tSpob, 1 );
@@ -1105,10 +1216,12 @@ void map_renderDecorators( double x, double y, double zoom, int editor, double a
  */
 void map_renderFactionDisks( double x, double y, double zoom, double r, int editor, double alpha )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<n; i++) {
       glColour c;
       double tx, ty;
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1133,7 +1246,7 @@ void map_renderFactionDisks( double x, double y, double zoom, double r, int edit
          c.b = col->b;
          c.a = 0.6 * alpha;
 
-         glUseProgram(shaders.factiondisk.program);
+         gl_useProgram(shaders.factiondisk.program);
          glUniform1f(shaders.factiondisk.paramf, r / sr );
          gl_renderShader( tx, ty, sr, sr, 0., &shaders.factiondisk, &c, 1 );
       }
@@ -1145,10 +1258,12 @@ void map_renderFactionDisks( double x, double y, double zoom, double r, int edit
  */
 void map_renderSystemEnvironment( double x, double y, double zoom, int editor, double alpha )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<n; i++) {
       double tx, ty;
       /* Fade in the disks to allow toggling between commodity and nothing */
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1173,7 +1288,7 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor, d
          mat4_scale( &projection, sw, sh, 1. );
 
          /* Start the program. */
-         glUseProgram(shaders.nebula_map.program);
+         gl_useProgram(shaders.nebula_map.program);
 
          /* Set shader uniforms. */
          glUniform1f(shaders.nebula_map.hue, sys->nebu_hue);
@@ -1190,7 +1305,7 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor, d
 
          /* Clean up. */
          glDisableVertexAttribArray( shaders.nebula_map.vertex );
-         glUseProgram(0);
+         gl_useProgram(0);
          gl_checkErr();
       }
       else if (sys->map_shader != NULL) {
@@ -1205,7 +1320,7 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor, d
          mat4_scale( &projection, sw, sh, 1. );
 
          /* Start the program. */
-         glUseProgram( sys->ms->program );
+         gl_useProgram( sys->ms->program );
 
          /* Set shader uniforms. */
          gl_uniformMat4(sys->ms->projection, &projection);
@@ -1220,7 +1335,7 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor, d
 
          /* Clean up. */
          glDisableVertexAttribArray( sys->ms->vertex );
-         glUseProgram(0);
+         gl_useProgram(0);
          gl_checkErr();
       }
    }
@@ -1231,9 +1346,11 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor, d
  */
 void map_renderJumps( double x, double y, double zoom, double radius, int editor )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<n; i++) {
       double x1,y1;
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1286,7 +1403,7 @@ void map_renderJumps( double x, double y, double zoom, double radius, int editor
             rh = 1.5;
          }
 
-         glUseProgram( shaders.jumplane.program );
+         gl_useProgram( shaders.jumplane.program );
          gl_uniformColor( shaders.jumplane.paramv, cole );
          glUniform1f( shaders.jumplane.paramf, radius );
          gl_renderShader( (x1+x2)/2., (y1+y2)/2., rw, rh, r, &shaders.jumplane, col, 1 );
@@ -1300,10 +1417,13 @@ void map_renderJumps( double x, double y, double zoom, double radius, int editor
 void map_renderSystems( double bx, double by, double x, double y,
       double zoom, double w, double h, double r, MapMode mode )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   int editor = (mode == MAPMODE_EDITOR);
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<n; i++) {
       const glColour *col;
       double tx, ty;
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1406,11 +1526,13 @@ static void map_renderPath( double x, double y, double zoom, double radius, doub
       rw = (MOD(rx,ry)+radius)/2.;
       rh = 5.;
 
-      glUseProgram( shaders.jumplanegoto.program );
-      glUniform1f( shaders.jumplanegoto.dt, map_dt );
-      glUniform1f( shaders.jumplanegoto.paramf, radius );
-      glUniform1i( shaders.jumplanegoto.parami, (jcur >= 1) );
-      gl_renderShader( (x1+x2)/2., (y1+y2)/2., rw, rh, r, &shaders.jumplanegoto, &col, 1 );
+      /* The animated (still-to-travel) lane is a precompiled variant. */
+      const SimpleShader *shd = (jcur >= 1) ?
+            &shaders.jumplanegoto_active : &shaders.jumplanegoto;
+      gl_useProgram( shd->program );
+      glUniform1f( shd->dt, map_dt );
+      glUniform1f( shd->paramf, radius );
+      gl_renderShader( (x1+x2)/2., (y1+y2)/2., rw, rh, r, shd, &col, 1 );
 
       jcur--;
       sys1 = sys2;
@@ -1433,11 +1555,12 @@ void map_renderNotes( double bx, double by, double x, double y,
       glClear( GL_DEPTH_BUFFER_BIT );
 
    /* Find mouse over system and draw. */
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   for (int i=0; i<array_size(ksys); i++) {
       double tx,ty, tw,th;
       glColour col;
       glFont *font;
-      StarSystem *sys = &systems_stack[i];
+      StarSystem *sys = &systems_stack[ ksys[i] ];
 
       if (!sys_isFlag(sys,SYSTEM_PMARKED))
          continue;
@@ -1489,8 +1612,10 @@ void map_renderNames( double bx, double by, double x, double y,
    if (zoom <= 0.5)
       return;
 
-   for (int i=0; i<array_size(systems_stack); i++) {
-      StarSystem *sys = system_getIndex( i );
+   const int *ksys = space_getKnownSystems();
+   int nsys = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<nsys; i++) {
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1549,10 +1674,11 @@ void map_renderNames( double bx, double by, double x, double y,
  */
 static void map_renderMarkers( double x, double y, double zoom, double r, double a )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   for (int i=0; i<array_size(ksys); i++) {
       double tx, ty;
       int j, n, m;
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( ksys[i] );
 
       /* We only care about marked now. */
       if (!sys_isFlag(sys, SYSTEM_MARKED | SYSTEM_CMARKED | SYSTEM_PMARKED))
@@ -1604,10 +1730,12 @@ static void map_renderMarkers( double x, double y, double zoom, double r, double
  */
 static void map_renderSysBlack( double bx, double by, double x, double y, double zoom, double w, double h, double r, int editor )
 {
-   for (int i=0; i<array_size(systems_stack); i++) {
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? array_size(systems_stack) : array_size(ksys);
+   for (int i=0; i<n; i++) {
       double tx,ty;
       glColour ccol;
-      StarSystem *sys = system_getIndex( i );
+      StarSystem *sys = system_getIndex( editor ? i : ksys[i] );
 
       if (sys_isFlag(sys,SYSTEM_HIDDEN))
          continue;
@@ -1632,19 +1760,23 @@ static void map_renderSysBlack( double bx, double by, double x, double y, double
    }
 }
 
-/*
- * Renders the economy information
+/**
+ * @brief Precomputes the commodity display layer.
+ *
+ * Walks every system's spob prices once and bakes the figure and ramp
+ *  colour per system, so redrawing the layer (every pan frame repaints
+ *  the static cache) only culls, prints and draws circles. Stale on
+ *  commodity/mode/selection switches (map_update_commod_av_price) and on
+ *  economy updates (map_commodCacheInvalidate).
  */
-void map_renderCommod( double bx, double by, double x, double y,
-      double zoom, double w, double h, double r, int editor, double a )
+static void map_commodCacheBuild (void)
 {
    Commodity *c;
-   glColour ccol;
    double best,worst,maxPrice,minPrice,curMaxPrice,curMinPrice,thisPrice;
 
-   /* If not plotting commodities, return */
-   if (cur_commod == -1 || map_selected == -1 || commod_known == NULL)
-      return;
+   commod_layer_n = array_size(systems_stack);
+   commod_layer   = calloc( commod_layer_n, sizeof(CommodLayer) );
+   commod_layer_ignorance = 0;
 
    c = commod_known[cur_commod];
    if (cur_commod_mode == 1) { /*showing price difference to selected system*/
@@ -1664,8 +1796,7 @@ void map_renderCommod( double bx, double by, double x, double y,
             }
          }
          if (k==array_size(land_spob->commodities)) { /* commodity of interest not found */
-            map_renderCommodIgnorance( x, y, zoom, sys, c, a );
-            map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
+            commod_layer_ignorance = 1;
             return;
          }
       }
@@ -1689,154 +1820,178 @@ void map_renderCommod( double bx, double by, double x, double y,
 
             }
             if (maxPrice == 0) { /* no prices are known here */
-               map_renderCommodIgnorance( x, y, zoom, sys, c, a );
-               map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
+               commod_layer_ignorance = 1;
                return;
             }
             curMaxPrice = maxPrice;
             curMinPrice = minPrice;
          }
          else {
-            map_renderCommodIgnorance( x, y, zoom, sys, c, a );
-            map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
+            commod_layer_ignorance = 1;
             return;
          }
       }
-      for (int i=0; i<array_size(systems_stack); i++) {
-         double tx, ty;
+      for (int i=0; i<commod_layer_n; i++) {
+         CommodLayer *cl = &commod_layer[i];
          sys = system_getIndex( i );
 
-         if (sys_isFlag(sys,SYSTEM_HIDDEN))
-            continue;
-
-         /* if system is not known, reachable, or marked. and we are not in the editor */
-         if ((!sys_isKnown(sys) && !sys_isFlag(sys, SYSTEM_MARKED | SYSTEM_CMARKED)
-              && !space_sysReachable(sys)) && !editor)
+         if (!sys_isKnown(sys) || !system_hasSpob(sys))
             continue;
 
-         tx = x + sys->pos.x*zoom;
-         ty = y + sys->pos.y*zoom;
-
-         /* Skip if out of bounds. */
-         if (!rectOverlap(tx - r, ty - r, r, r, bx, by, w, h))
-            continue;
-
-         /* If system is known fill it. */
-         if ((sys_isKnown(sys)) && (system_hasSpob(sys))) {
-            minPrice = HUGE_VAL;
-            maxPrice = 0;
-            for (int j=0; j<array_size(sys->spobs); j++) {
-               Spob *p = sys->spobs[j];
-               for (int k=0; k<array_size(p->commodities); k++) {
-                  if (p->commodities[k] != c)
-                     continue;
-                  if (p->commodityPrice[k].cnt <= 0) /*commodity is not known about */
-                     continue;
-                  thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  maxPrice = MAX( thisPrice, maxPrice );
-                  minPrice = MIN( thisPrice, minPrice );
-                  break;
-               }
+         minPrice = HUGE_VAL;
+         maxPrice = 0;
+         for (int j=0; j<array_size(sys->spobs); j++) {
+            Spob *p = sys->spobs[j];
+            for (int k=0; k<array_size(p->commodities); k++) {
+               if (p->commodities[k] != c)
+                  continue;
+               if (p->commodityPrice[k].cnt <= 0) /*commodity is not known about */
+                  continue;
+               thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+               maxPrice = MAX( thisPrice, maxPrice );
+               minPrice = MIN( thisPrice, minPrice );
+               break;
             }
+         }
 
-            /* Calculate best and worst profits */
-            if (maxPrice > 0) {
-               /* Commodity sold at this system */
-               best = maxPrice - curMinPrice;
-               worst= minPrice - curMaxPrice;
-               if (best >= 0) { /* draw circle above */
-                  ccol = cLightBlue;
-                  ccol.a = a;
-                  gl_print(&gl_smallFont, x + (sys->pos.x+11) * zoom, y + (sys->pos.y-22)*zoom, &ccol, "%.1f",best);
-                  best = tanh ( 2*best / curMinPrice );
-                  col_blend( &ccol, &cFontBlue, &cFontYellow, best );
-                  ccol.a = a;
-                  gl_renderCircle( tx, ty /*+ r*/ , /*(0.1 + best) **/ r, &ccol, 1 );
-               }
-               else {/* draw circle below */
-                  ccol = cOrange;
-                  ccol.a = a;
-                  gl_print(&gl_smallFont, x + (sys->pos.x+12) * zoom, y + (sys->pos.y)*zoom-gl_smallFont.h*0.5, &ccol, _("%.1f ¤"),worst);
-                  worst = tanh ( -2*worst/ curMaxPrice );
-                  col_blend( &ccol, &cFontOrange, &cFontYellow, worst );
-                  ccol.a = a;
-                  gl_renderCircle( tx, ty /*- r*/ , /*(0.1 - worst) **/ r, &ccol, 1 );
-               }
-            }
-            else {
-               /* Commodity not sold here */
-               ccol = cGrey10;
-               ccol.a = a;
-               gl_renderCircle( tx, ty, r, &ccol, 1 );
-            }
+         /* Calculate best and worst profits */
+         if (maxPrice <= 0) /* Commodity not sold here */
+            continue;
+         cl->sold = 1;
+         best = maxPrice - curMinPrice;
+         worst= minPrice - curMaxPrice;
+         if (best >= 0) {
+            cl->value = best;
+            cl->col   = *col_ramp( cRampFontYellowBlue, tanh( 2*best / curMinPrice ) );
+         }
+         else {
+            cl->below = 1;
+            cl->value = worst;
+            cl->col   = *col_ramp( cRampFontYellowOrange, tanh( -2*worst / curMaxPrice ) );
          }
       }
    }
    else { /* cur_commod_mode == 0, showing actual prices */
-      /* First calculate av price in all systems
-       * This has already been done in map_update_commod_av_price
-       * Now display the costs */
-      for (int i=0; i<array_size(systems_stack); i++) {
-         double tx, ty;
+      /* The galaxy average was already computed in map_update_commod_av_price */
+      for (int i=0; i<commod_layer_n; i++) {
+         CommodLayer *cl = &commod_layer[i];
          StarSystem *sys = system_getIndex( i );
+         double sumPrice = 0;
+         int sumCnt = 0;
+         double frac;
 
-         if (sys_isFlag(sys,SYSTEM_HIDDEN))
+         if (!sys_isKnown(sys) || !system_hasSpob(sys))
             continue;
 
-         /* if system is not known, reachable, or marked. and we are not in the editor */
-         if ((!sys_isKnown(sys) && !sys_isFlag(sys, SYSTEM_MARKED | SYSTEM_CMARKED)
-              && !space_sysReachable(sys)) && !editor)
+         for (int j=0; j<array_size(sys->spobs); j++) {
+            Spob *p = sys->spobs[j];
+            for (int k=0; k<array_size(p->commodities); k++) {
+               if (p->commodities[k] != c)
+                  continue;
+               if (p->commodityPrice[k].cnt <= 0) /* commodity is not known about */
+                  continue;
+               thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+               sumPrice += thisPrice;
+               sumCnt += 1;
+               break;
+            }
+         }
+
+         if (sumCnt <= 0) /* Commodity not sold here */
             continue;
+         /* Colour as a % of global average */
+         cl->sold = 1;
+         sumPrice /= sumCnt;
+         cl->value = sumPrice;
+         if (sumPrice < commod_av_gal_price) {
+            frac = tanh(5*(commod_av_gal_price / sumPrice - 1));
+            cl->col = *col_ramp( cRampFontYellowOrange, frac );
+         }
+         else {
+            frac = tanh(5*(sumPrice / commod_av_gal_price - 1));
+            cl->col = *col_ramp( cRampFontYellowBlue, frac );
+         }
+      }
+   }
+}
 
-         tx = x + sys->pos.x*zoom;
-         ty = y + sys->pos.y*zoom;
+/*
+ * Renders the economy information off the precomputed layer.
+ */
+void map_renderCommod( double bx, double by, double x, double y,
+      double zoom, double w, double h, double r, int editor, double a )
+{
+   Commodity *c;
+   glColour ccol;
 
-         /* Skip if out of bounds. */
-         if (!rectOverlap(tx - r, ty - r, r, r, bx, by, w, h))
-            continue;
+   /* If not plotting commodities, return */
+   if (cur_commod == -1 || map_selected == -1 || commod_known == NULL)
+      return;
 
-         /* If system is known fill it. */
-         if ((sys_isKnown(sys)) && (system_hasSpob(sys))) {
-            double sumPrice = 0;
-            int sumCnt = 0;
-            for (int j=0; j<array_size(sys->spobs); j++) {
-               Spob *p = sys->spobs[j];
-               for (int k=0; k<array_size(p->commodities); k++) {
-                  if (p->commodities[k] != c)
-                     continue;
-                  if (p->commodityPrice[k].cnt <= 0) /* commodity is not known about */
-                     continue;
-                  thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  sumPrice += thisPrice;
-                  sumCnt += 1;
-                  break;
-               }
-            }
+   c = commod_known[cur_commod];
+   if ((commod_layer == NULL) || (commod_layer_n != array_size(systems_stack)))
+      map_commodCacheBuild();
 
-            if (sumCnt > 0) {
-               /* Commodity sold at this system */
-               /* Colour as a % of global average */
-               double frac;
-               sumPrice /= sumCnt;
-               if (sumPrice < commod_av_gal_price) {
-                  frac = tanh(5*(commod_av_gal_price / sumPrice - 1));
-                  col_blend( &ccol, &cFontOrange, &cFontYellow, frac );
-               }
-               else {
-                  frac = tanh(5*(sumPrice / commod_av_gal_price - 1));
-                  col_blend( &ccol, &cFontBlue, &cFontYellow, frac );
-               }
-               ccol.a = a;
-               gl_print(&gl_smallFont, x + (sys->pos.x+12)*zoom, y + (sys->pos.y)*zoom - gl_smallFont.h*0.5, &ccol, _("%.1f ¤"),sumPrice);
-               gl_renderCircle( tx, ty, r, &ccol, 1 );
-            }
-            else {
-               /* Commodity not sold here */
-               ccol = cGrey10;
-               ccol.a = a;
-               gl_renderCircle( tx, ty, r, &ccol, 1 );
-            }
+   if (commod_layer_ignorance) { /* no price info in the selected system */
+      StarSystem *sys = system_getIndex( map_selected );
+      map_renderCommodIgnorance( x, y, zoom, sys, c, a );
+      map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
+      return;
+   }
+
+   const int *ksys = space_getKnownSystems();
+   int n = editor ? commod_layer_n : array_size(ksys);
+   for (int k=0; k<n; k++) {
+      const int i = editor ? k : ksys[k];
+      double tx, ty;
+      const CommodLayer *cl = &commod_layer[i];
+      StarSystem *sys = system_getIndex( i );
+
+      if (sys_isFlag(sys,SYSTEM_HIDDEN))
+         continue;
+
+      /* if system is not known, reachable, or marked. and we are not in the editor */
+      if ((!sys_isKnown(sys) && !sys_isFlag(sys, SYSTEM_MARKED | SYSTEM_CMARKED)
+           && !space_sysReachable(sys)) && !editor)
+         continue;
+
+      tx = x + sys->pos.x*zoom;
+      ty = y + sys->pos.y*zoom;
+
+      /* Skip if out of bounds. */
+      if (!rectOverlap(tx - r, ty - r, r, r, bx, by, w, h))
+         continue;
+
+      /* If system is known fill it. */
+      if (!sys_isKnown(sys) || !system_hasSpob(sys))
+         continue;
+
+      if (!cl->sold) {
+         /* Commodity not sold here */
+         ccol = cGrey10;
+         ccol.a = a;
+         gl_renderCircle( tx, ty, r, &ccol, 1 );
+      }
+      else if (cur_commod_mode == 1) { /* price difference to selected system */
+         if (!cl->below) { /* draw circle above */
+            ccol = cLightBlue;
+            ccol.a = a;
+            gl_print(&gl_smallFont, x + (sys->pos.x+11) * zoom, y + (sys->pos.y-22)*zoom, &ccol, "%.1f", cl->value);
+         }
+         else { /* draw circle below */
+            ccol = cOrange;
+            ccol.a = a;
+            gl_print(&gl_smallFont, x + (sys->pos.x+12) * zoom, y + (sys->pos.y)*zoom-gl_smallFont.h*0.5, &ccol, _("%.1f ¤"), cl->value);
          }
+         ccol = cl->col;
+         ccol.a = a;
+         gl_renderCircle( tx, ty, r, &ccol, 1 );
+      }
+      else { /* actual prices, coloured as a % of the global average */
+         ccol = cl->col;
+         ccol.a = a;
+         gl_print(&gl_smallFont, x + (sys->pos.x+12)*zoom, y + (sys->pos.y)*zoom - gl_smallFont.h*0.5, &ccol, _("%.1f ¤"), cl->value);
+         gl_renderCircle( tx, ty, r, &ccol, 1 );
       }
    }
 }
@@ -2197,6 +2352,7 @@ static void map_buttonMarkSystem( unsigned int wid, const char* str )
          sys->note = dialogue_input(_("Add System Note"), 0, 60, _("Write a note about the #o%s#0 system:"), sys->name );
          sys_setFlag(sys, SYSTEM_PMARKED);
       }
+      space_knownInvalidate();
    }
 }
 
@@ -2608,139 +2764,8 @@ void map_toggleNotes()
 {
    map_show_notes = !map_show_notes;
 }
-/*
- * A* algorithm for shortest path finding
- *
- * Note since that we can't actually get an admissible heurestic for A* this is
- * in reality just Djikstras. I've removed the heurestic bit to make sure I
- * don't try to implement an admissible heuristic when I'm pretty sure there is
- * none.
- */
-/**
- * @brief Node structure for A* pathfinding.
- */
-typedef struct SysNode_ {
-   struct SysNode_ *next; /**< Next node */
-   struct SysNode_ *gnext; /**< Next node in the garbage collector. */
-
-   struct SysNode_ *parent; /**< Parent node. */
-   StarSystem* sys; /**< System in node. */
-   int g; /**< step */
-} SysNode; /**< System Node for use in A* pathfinding. */
-static SysNode *A_gc;
 /* prototypes */
-static SysNode* A_newNode( StarSystem* sys );
-static int A_g( SysNode* n );
-static SysNode* A_add( SysNode *first, SysNode *cur );
-static SysNode* A_rm( SysNode *first, StarSystem *cur );
-static SysNode* A_in( SysNode *first, StarSystem *cur );
-static SysNode* A_lowest( SysNode *first );
-static void A_freeList( SysNode *first );
 static int map_decorator_parse( MapDecorator *temp, const char *file );
-/** @brief Creates a new node link to star system. */
-static SysNode* A_newNode( StarSystem* sys )
-{
-   SysNode *n = malloc(sizeof(SysNode));
-
-   n->next  = NULL;
-   n->sys   = sys;
-
-   n->gnext = A_gc;
-   A_gc     = n;
-
-   return n;
-}
-/** @brief Gets the g from a node. */
-static int A_g( SysNode* n )
-{
-   return n->g;
-}
-/** @brief Adds a node to the linked list. */
-static SysNode* A_add( SysNode *first, SysNode *cur )
-{
-   SysNode *n;
-
-   if (first == NULL)
-      return cur;
-
-   n = first;
-   while (n->next != NULL)
-      n = n->next;
-   n->next = cur;
-
-   return first;
-}
-/* @brief Removes a node from a linked list. */
-static SysNode* A_rm( SysNode *first, StarSystem *cur )
-{
-   SysNode *n, *p;
-
-   if (first->sys == cur) {
-      n = first->next;
-      first->next = NULL;
-      return n;
-   }
-
-   p = first;
-   n = p->next;
-   do {
-      if (n->sys == cur) {
-         n->next = NULL;
-         p->next = n->next;
-         break;
-      }
-      p = n;
-   } while ((n=n->next) != NULL);
-
-   return first;
-}
-/** @brief Checks to see if node is in linked list. */
-static SysNode* A_in( SysNode *first, StarSystem *cur )
-{
-   SysNode *n;
-
-   if (first == NULL)
-      return NULL;
-
-   n = first;
-   do {
-      if (n->sys == cur)
-         return n;
-   } while ((n=n->next) != NULL);
-   return NULL;
-}
-/** @brief Returns the lowest ranking node from a linked list of nodes. */
-static SysNode* A_lowest( SysNode *first )
-{
-   SysNode *lowest, *n;
-
-   if (first == NULL)
-      return NULL;
-
-   n = first;
-   lowest = n;
-   do {
-      if (n->g < lowest->g)
-         lowest = n;
-   } while ((n=n->next) != NULL);
-   return lowest;
-}
-/** @brief Frees a linked list. */
-static void A_freeList( SysNode *first )
-{
-   SysNode *p, *n;
-
-   if (first == NULL)
-      return;
-
-   p = NULL;
-   n = first;
-   do {
-      free(p);
-      p = n;
-   } while ((n=n->gnext) != NULL);
-   free(p);
-}
 
 /** @brief Sets map_zoom to zoom and recreates the faction disk texture. */
 void map_setZoom( unsigned int wid, double zoom )
@@ -2762,14 +2787,10 @@ void map_setZoom( unsigned int wid, double zoom )
 StarSystem** map_getJumpPath( const char* sysstart, const char* sysend,
     int ignore_known, int show_hidden, StarSystem** old_data )
 {
-   int j, cost, njumps, ojumps;
+   int njumps, ojumps, nsys, sid, eid, qhead, qtail;
    StarSystem *ssys, *esys, **res;
+   int *dist, *parent, *queue;
 
-   SysNode *cur,   *neighbour;
-   SysNode *open,  *closed;
-   SysNode *ocost, *ccost;
-
-   A_gc = NULL;
    res = old_data;
    ojumps = array_size( old_data );
 
@@ -2794,32 +2815,36 @@ StarSystem** map_getJumpPath( const char* sysstart, const char* sysend,
       return NULL;
    }
 
-   /* start the linked lists */
-   open     = closed = NULL;
-   cur      = A_newNode( ssys );
-   cur->parent = NULL;
-   cur->g   = 0;
-   open     = A_add( open, cur ); /* Initial open node is the start system */
+   /* All jumps cost 1, so the shortest path is a simple breadth-first
+    * search over flat per-system arrays: each system is enqueued at most
+    * once and membership is an indexed load, so a query is O(V+E) even on
+    * large modded universes. */
+   nsys   = array_size(systems_stack);
+   dist   = malloc( nsys * sizeof(int) );
+   parent = malloc( nsys * sizeof(int) );
+   queue  = malloc( nsys * sizeof(int) );
+   for (int i=0; i<nsys; i++)
+      dist[i] = -1;
+
+   sid = system_index( ssys );
+   eid = system_index( esys );
+   dist[sid]   = 0;
+   parent[sid] = -1;
+   qhead = qtail = 0;
+   queue[qtail++] = sid;
+
+   while (qhead < qtail) {
+      int cur = queue[qhead++];
+      const StarSystem *sys_c = system_getIndex( cur );
 
-   j = 0;
-   while ((cur = A_lowest(open))) {
       /* End condition. */
-      if (cur->sys == esys)
-         break;
-
-      /* Break if infinite loop. */
-      j++;
-      if (j > MAP_LOOP_PROT)
+      if (cur == eid)
          break;
 
-      /* Get best from open and toss to closed */
-      open   = A_rm( open, cur->sys );
-      closed = A_add( closed, cur );
-      cost   = A_g(cur) + 1; /* Base unit is jump and always increases by 1. */
-
-      for (int i=0; i<array_size(cur->sys->jumps); i++) {
-         JumpPoint *jp  = &cur->sys->jumps[i];
+      for (int i=0; i<array_size(sys_c->jumps); i++) {
+         const JumpPoint *jp = &sys_c->jumps[i];
          StarSystem *sys = jp->target;
+         int tid;
 
          /* Make sure it's reachable */
          if (!ignore_known) {
@@ -2835,53 +2860,36 @@ StarSystem** map_getJumpPath( const char* sysstart, const char* sysend,
          if (!show_hidden && jp_isFlag( jp, JP_HIDDEN ))
             continue;
 
-         /* Check to see if it's already in the closed set. */
-         ccost = A_in(closed, sys);
-         if ((ccost != NULL) && (cost >= A_g(ccost)))
+         /* Already seen at an equal or lower depth. */
+         tid = system_index( sys );
+         if (dist[tid] >= 0)
             continue;
-            //closed = A_rm( closed, sys );
-
-         /* Remove if it exists and current is better. */
-         ocost = A_in(open, sys);
-         if (ocost != NULL) {
-            if (cost < A_g(ocost))
-               open = A_rm( open, sys ); /* New path is better */
-            else
-               continue; /* This node is worse, so ignore it. */
-         }
 
-         /* Create the node. */
-         neighbour         = A_newNode( sys );
-         neighbour->parent = cur;
-         neighbour->g      = cost;
-         open              = A_add( open, neighbour );
+         dist[tid]   = dist[cur] + 1;
+         parent[tid] = cur;
+         queue[qtail++] = tid;
       }
-
-      /* Safety check in case not linked. */
-      if (open == NULL)
-         break;
    }
 
-   /* Build path backwards if not broken from loop. */
-   if (cur != NULL && esys == cur->sys) {
-      njumps = A_g(cur) + ojumps;
+   /* Build path backwards if the goal was reached. */
+   if (dist[eid] >= 0) {
+      njumps = dist[eid] + ojumps;
       assert( njumps > ojumps );
       if (res == NULL)
          res = array_create_size( StarSystem*, njumps );
       array_resize( &res, njumps );
       /* Build path. */
-      for (int i=0; i<njumps-ojumps; i++) {
-         res[njumps-i-1] = cur->sys;
-         cur = cur->parent;
-      }
+      for (int i=0, cur=eid; i<njumps-ojumps; i++, cur=parent[cur])
+         res[njumps-i-1] = system_getIndex( cur );
    }
    else {
       res = NULL;
       array_free( old_data );
    }
 
-   /* free the linked lists */
-   A_freeList(A_gc);
+   free( dist );
+   free( parent );
+   free( queue );
    return res;
 }
 
@@ -2903,6 +2911,8 @@ int map_map( const Outfit *map )
    for (int i=0; i<array_size(map->u.map->jumps);i++)
       jp_setFlag(map->u.map->jumps[i], JP_KNOWN);
 
+   space_knownInvalidate();
+
    return 1;
 }
 
@@ -2963,6 +2973,7 @@ int localmap_map( const Outfit *lmap )
       if (mod*p->hide <= detect)
          spob_setKnown( p );
    }
+   space_knownInvalidate();
    return 0;
 }
 
@@ -3121,8 +3132,12 @@ static int map_decorator_parse( MapDecorator *temp, const char *file )
       xmlr_float(node, "y", temp->y);
       xmlr_int(node, "detection_radius", temp->detection_radius);
       if (xml_isNode(node,"image")) {
-         temp->image = xml_parseTexture( node,
-               MAP_DECORATOR_GFX_PATH"%s", 1, 1, OPENGL_TEX_MIPMAPS );
+         char buf[PATH_MAX];
+         /* Decorators are only visible with the map open, so decode them in
+          * the background; the placeholder renders as nothing until the
+          * pixels arrive. */
+         snprintf( buf, sizeof(buf), MAP_DECORATOR_GFX_PATH"%s", xml_get(node) );
+         temp->image = gl_newImageAsync( buf, OPENGL_TEX_MIPMAPS, NULL, NULL );
 
          if (temp->image == NULL)
             WARN(_("Could not load map decorator texture '%s'."), xml_get(node));
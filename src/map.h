@@ -34,6 +34,8 @@ void map_exit (void);
 /* open the map window */
 void map_open (void);
 void map_close (void);
+void map_cacheInvalidate (void);
+void map_commodCacheInvalidate (void);
 int map_isOpen (void);
 
 /* misc */
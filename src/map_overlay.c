@@ -63,6 +63,18 @@ static Uint32 ovr_opened = 0; /**< Time last opened. */
 static int ovr_open = 0;      /**< Is the overlay open? */
 static double ovr_res = 10.;  /**< Resolution. */
 static double ovr_dt = 0.; /**< For animations and stuff. */
+
+/* The slow layer of the overlay (spobs, jump points and asteroid blips)
+ * barely changes frame to frame, so it is drawn into a cache texture at
+ * the radar refresh rate (conf.radar_fps) and blitted in between, the
+ * same tiering the GUI radar uses. Pilots, safe lanes and markers render
+ * live on top. */
+static GLuint ovr_fbo = 0;    /**< Cache FBO (screen-sized). */
+static GLuint ovr_tex = 0;    /**< Cache texture. */
+static int ovr_fbo_w = 0;     /**< Width the FBO was created at. */
+static int ovr_fbo_h = 0;     /**< Height the FBO was created at. */
+static double ovr_accum = 0.; /**< Time since the cache was last redrawn. */
+static int ovr_cache_valid = 0; /**< Whether the cache contents are usable. */
 static const double ovr_text_pixbuf = 5.; /**< Extra margin around overlay text. */
 /* Rem: high pix_buffer ovr_text_pixbuff allows to do less iterations. */
 typedef struct OverlayBounds_s {
@@ -77,6 +89,13 @@ typedef struct OverlayBounds_s {
 } OverlayBounds_t;
 static OverlayBounds_t ovr_bounds;
 
+/* Converged label layouts persist in each spob/jump's MapOverlayPos, so a
+ * refresh of the same system can seed the solver from the previous solution
+ * instead of re-running the full placement search. */
+static const StarSystem *ovr_layout_sys = NULL; /**< System the stored layout belongs to. */
+static int ovr_layout_items = 0; /**< Number of items in the stored layout. */
+static double ovr_layout_res = 0.; /**< Overlay resolution of the stored layout. */
+
 /*
  * Prototypes
  */
@@ -84,7 +103,7 @@ static void force_collision( float *ox, float *oy,
       float x, float y, float w, float h,
       float mx, float my, float mw, float mh );
 static void ovr_optimizeLayout( int items, const vec2** pos,
-      MapOverlayPos** mo );
+      MapOverlayPos** mo, int warm );
 static void ovr_refresh_uzawa_overlap( float *forces_x, float *forces_y,
       float x, float y, float w, float h, const vec2** pos,
       MapOverlayPos** mo, int items, int self,
@@ -198,6 +217,7 @@ int ovr_input( SDL_Event *event )
  */
 void ovr_refresh (void)
 {
+   ovr_cache_valid = 0; /* Bounds or resolution may change. */
    double max_x, max_y;
    int items, jumpitems;
    const vec2 **pos;
@@ -254,8 +274,15 @@ void ovr_refresh (void)
    for (int i=0; i<items; i++)
       mo[i]->radius = MAX( 2.+mo[i]->radius / ovr_res, i<jumpitems ? 5. : 7.5 );
 
-   /* Compute text overlap and try to minimize it. */
-   ovr_optimizeLayout( items, pos, mo );
+   /* Compute text overlap and try to minimize it. Seed from the previous
+    * converged layout when it is still valid for this system, so reopening
+    * or marker updates only have to relax, not re-solve. */
+   ovr_optimizeLayout( items, pos, mo,
+         (ovr_layout_sys == cur_system) && (ovr_layout_items == items) &&
+         (ovr_layout_res == ovr_res) );
+   ovr_layout_sys   = cur_system;
+   ovr_layout_items = items;
+   ovr_layout_res   = ovr_res;
 
    /* Free the moos. */
    free( mo );
@@ -265,7 +292,7 @@ void ovr_refresh (void)
 /**
  * @brief Makes a best effort to fit the given spobs' overlay indicators and labels fit without collisions.
  */
-static void ovr_optimizeLayout( int items, const vec2** pos, MapOverlayPos** mo )
+static void ovr_optimizeLayout( int items, const vec2** pos, MapOverlayPos** mo, int warm )
 {
    float cx, cy, r, sx, sy;
    float x, y, w, h, mx, my, mw, mh;
@@ -317,8 +344,18 @@ static void ovr_optimizeLayout( int items, const vec2** pos, MapOverlayPos** mo
    off_0x = calloc( items, sizeof(float) );
    off_0y = calloc( items, sizeof(float) );
 
-   /* Initialize all items. */
-   for (int i=0; i<items; i++) {
+   /* Warm start: seed from the previously converged offsets and let the
+    * Uzawa loop just relax them, skipping the O(n^2) placement search.
+    * The stagnation test then usually breaks out after one iteration. */
+   if (warm) {
+      for (int i=0; i<items; i++) {
+         off_0x[i] = mo[i]->text_offx;
+         off_0y[i] = mo[i]->text_offy;
+      }
+   }
+
+   /* Initialize all items (skipped entirely on a warm start). */
+   for (int i=0; !warm && i<items; i++) {
       /* Test to see what side is best to put the text on.
        * We actually compute the text overlap also so hopefully it will alternate
        * sides when stuff is clustered together. */
@@ -560,6 +597,7 @@ void ovr_setOpen( int open )
       ovr_open = 1;
       input_mouseShow();
       ovr_initAlpha();
+      ovr_cache_valid = 0;
    }
    else if (ovr_open) {
       ovr_open = 0;
@@ -689,7 +727,7 @@ void ovr_render( double dt )
       rh = 9.;
 
       /* Render. */
-      glUseProgram(shaders.safelane.program);
+      gl_useProgram(shaders.safelane.program);
       gl_renderShader( x+rx/2., y+ry/2., rw, rh, r, &shaders.safelane, &col, 1 );
    }
    array_free( ovr_render_safelanes );
@@ -703,40 +741,86 @@ void ovr_render( double dt )
       glColour col = cRadar_hilight;
       col.a = 0.6;
       map_overlayToScreenPos( &x, &y, player.autonav_pos.x, player.autonav_pos.y );
-      glUseProgram( shaders.selectposition.program );
+      gl_useProgram( shaders.selectposition.program );
       gl_renderShader( x, y, 9., 9., 0., &shaders.selectposition, &col, 1 );
       gl_printMarkerRaw( &gl_smallFont, x+10., y-gl_smallFont.h/2., &cRadar_hilight, _("TARGET") );
    }
 
-   /* Render spobs. */
+   /* Advance the fade-in of newly discovered things every frame so the
+    * cached layer can be redrawn while any of them is still fading. */
+   int fading = 0;
    for (int i=0; i<array_size(cur_system->spobs); i++) {
       Spob *pnt = cur_system->spobs[i];
-      if (pnt->map_alpha < 1.0)
+      if (pnt->map_alpha < 1.0) {
          pnt->map_alpha = MIN( pnt->map_alpha+OVERLAY_FADEIN*dt, 1.0 );
-      if (i != player.p->nav_spob)
-         gui_renderSpob( i, RADAR_RECT, w, h, res, pnt->map_alpha, 1 );
+         fading = 1;
+      }
    }
-   if (player.p->nav_spob > -1)
-      gui_renderSpob( player.p->nav_spob, RADAR_RECT, w, h, res, cur_system->spobs[player.p->nav_spob]->map_alpha, 1 );
-
-   /* Render jump points. */
    for (int i=0; i<array_size(cur_system->jumps); i++) {
       JumpPoint *jp = &cur_system->jumps[i];
-      if (jp->map_alpha < 1.0)
+      if (jp->map_alpha < 1.0) {
          jp->map_alpha = MIN( jp->map_alpha+OVERLAY_FADEIN*dt, 1.0 );
-      if ((i != player.p->nav_hyperspace) && !jp_isFlag(jp, JP_EXITONLY))
-         gui_renderJumpPoint( i, RADAR_RECT, w, h, res, jp->map_alpha, 1 );
+         fading = 1;
+      }
    }
-   if (player.p->nav_hyperspace > -1)
-      gui_renderJumpPoint( player.p->nav_hyperspace, RADAR_RECT, w, h, res, cur_system->jumps[player.p->nav_hyperspace].map_alpha, 1 );
-
-   /* Render the asteroids */
-   for (int i=0; i<array_size(cur_system->asteroids); i++) {
-      AsteroidAnchor *ast = &cur_system->asteroids[i];
-      for (int j=0; j<ast->nb; j++)
-         gui_renderAsteroid( &ast->asteroids[j], w, h, res, 1 );
+
+   /* (Re)create the cache FBO as necessary; it is screen-sized so the
+    * contents can be drawn with the unmodified overlay code. */
+   if ((ovr_fbo == 0) || (ovr_fbo_w != gl_screen.rw) || (ovr_fbo_h != gl_screen.rh)) {
+      if (ovr_fbo != 0) {
+         glDeleteFramebuffers( 1, &ovr_fbo );
+         glDeleteTextures( 1, &ovr_tex );
+      }
+      gl_fboCreate( &ovr_fbo, &ovr_tex, gl_screen.rw, gl_screen.rh );
+      ovr_fbo_w = gl_screen.rw;
+      ovr_fbo_h = gl_screen.rh;
+      ovr_cache_valid = 0;
+   }
+
+   /* Redraw the slow layer (spobs, jump points, asteroid blips) at the
+    * radar refresh rate; asteroids drift slowly enough for that. */
+   ovr_accum += dt;
+   if (!ovr_cache_valid || fading || (conf.radar_fps <= 0) ||
+         (ovr_accum >= 1./(double)conf.radar_fps)) {
+      glBindFramebuffer( GL_FRAMEBUFFER, ovr_fbo );
+      glClearColor( 0., 0., 0., 0. );
+      glClear( GL_COLOR_BUFFER_BIT );
+
+      /* Render spobs. */
+      for (int i=0; i<array_size(cur_system->spobs); i++) {
+         if (i != player.p->nav_spob)
+            gui_renderSpob( i, RADAR_RECT, w, h, res, cur_system->spobs[i]->map_alpha, 1 );
+      }
+      if (player.p->nav_spob > -1)
+         gui_renderSpob( player.p->nav_spob, RADAR_RECT, w, h, res, cur_system->spobs[player.p->nav_spob]->map_alpha, 1 );
+
+      /* Render jump points. */
+      for (int i=0; i<array_size(cur_system->jumps); i++) {
+         JumpPoint *jp = &cur_system->jumps[i];
+         if ((i != player.p->nav_hyperspace) && !jp_isFlag(jp, JP_EXITONLY))
+            gui_renderJumpPoint( i, RADAR_RECT, w, h, res, jp->map_alpha, 1 );
+      }
+      if (player.p->nav_hyperspace > -1)
+         gui_renderJumpPoint( player.p->nav_hyperspace, RADAR_RECT, w, h, res, cur_system->jumps[player.p->nav_hyperspace].map_alpha, 1 );
+
+      /* Render the asteroids */
+      for (int i=0; i<array_size(cur_system->asteroids); i++) {
+         AsteroidAnchor *ast = &cur_system->asteroids[i];
+         for (int j=0; j<ast->nb; j++)
+            gui_renderAsteroid( &ast->asteroids[j], w, h, res, 1 );
+      }
+
+      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+      glClearColor( 0., 0., 0., 1. );
+      ovr_accum = 0.;
+      ovr_cache_valid = 1;
    }
 
+   /* Blit the cached layer over the overlay area. */
+   gl_renderTextureRaw( ovr_tex, 0, ovr_bounds.l, ovr_bounds.b, w, h,
+         ovr_bounds.l / gl_screen.nw, ovr_bounds.b / gl_screen.nh,
+         w / gl_screen.nw, h / gl_screen.nh, NULL, 0. );
+
    /* Render pilots. */
    Pilot *const* pstk = pilot_getAll();
    int t = 0;
@@ -766,7 +850,7 @@ void ovr_render( double dt )
             double r;
             map_overlayToScreenPos( &x, &y, ast->pos.x, ast->pos.y );
             r = ast->radius / res;
-            glUseProgram( shaders.astaura.program );
+            gl_useProgram( shaders.astaura.program );
             gl_renderShader( x, y, r, r, 0., &shaders.astaura, &col, 1 );
          }
       }
@@ -778,7 +862,7 @@ void ovr_render( double dt )
          AsteroidExclusion *aexcl = &cur_system->astexclude[i];
          map_overlayToScreenPos( &x, &y, aexcl->pos.x, aexcl->pos.y );
          r = aexcl->radius / res;
-         glUseProgram( shaders.astaura.program );
+         gl_useProgram( shaders.astaura.program );
          gl_renderShader( x, y, r, r, 0., &shaders.astaura, &col, 1 );
       }
 
@@ -790,7 +874,7 @@ void ovr_render( double dt )
             continue;
          map_overlayToScreenPos( &x, &y, jp->pos.x, jp->pos.y );
          r = EW_JUMP_BONUS_RANGE / res;
-         glUseProgram( shaders.astaura.program );
+         gl_useProgram( shaders.astaura.program );
          gl_renderShader( x, y, r, r, 0., &shaders.astaura, &col, 1 );
       }
 
@@ -810,7 +894,7 @@ void ovr_render( double dt )
          map_overlayToScreenPos( &x, &y, pstk[i]->solid->pos.x, pstk[i]->solid->pos.y );
          r = detect * pstk[i]->stats.ew_detect; /* Already divided by res */
          if (r > 0.) {
-            glUseProgram( shaders.stealthaura.program );
+            gl_useProgram( shaders.stealthaura.program );
             gl_renderShader( x, y, r, r, 0., &shaders.stealthaura, &col, 1 );
          }
       }
@@ -820,7 +904,7 @@ void ovr_render( double dt )
       glBindFramebuffer(GL_FRAMEBUFFER, gl_screen.current_fbo);
       glClearColor( 0., 0., 0., 1. );
 
-      glUseProgram(shaders.stealthoverlay.program);
+      gl_useProgram(shaders.stealthoverlay.program);
       glBindTexture( GL_TEXTURE_2D, gl_screen.fbo_tex[2] );
 
       glEnableVertexAttribArray( shaders.stealthoverlay.vertex );
@@ -870,14 +954,14 @@ static void ovr_mrkRenderAll( double res, int fg )
 
          switch (mrk->type) {
             case OVR_MARKER_POINT:
-               glUseProgram( shaders.hilight.program );
+               gl_useProgram( shaders.hilight.program );
                glUniform1f( shaders.hilight.dt, ovr_dt );
                gl_renderShader( x, y, 13., 13., 0., &shaders.hilight, &highlighted, 1 );
                break;
 
             case OVR_MARKER_CIRCLE:
                r = MAX( mrk->u.circle.r / res, 13. ); /* Don't allow to be smaller than a "point" */
-               glUseProgram( shaders.hilight_circle.program );
+               gl_useProgram( shaders.hilight_circle.program );
                glUniform1f( shaders.hilight_circle.dt, ovr_dt );
                gl_renderShader( x, y, r, r, 0., &shaders.hilight_circle, &highlighted, 1 );
                break;
@@ -913,6 +997,15 @@ void ovr_mrkFree (void)
    ovr_markers = NULL;
    array_free( ovr_render_safelanes );
    ovr_render_safelanes = NULL;
+
+   /* Free the cached slow layer. */
+   if (ovr_fbo != 0) {
+      glDeleteFramebuffers( 1, &ovr_fbo );
+      glDeleteTextures( 1, &ovr_tex );
+      ovr_fbo = 0;
+      ovr_tex = 0;
+   }
+   ovr_cache_valid = 0;
 }
 
 /**
@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "SDL.h"
+
 #include "naev.h"
 /** @endcond */
 
@@ -574,8 +576,10 @@ const StarSystem* mission_sysComputerMark( const Mission* misn )
             continue;
       }
 
-      if (sys != NULL)
+      if (sys != NULL) {
          sys_setFlag( sys, SYSTEM_CMARKED );
+         space_knownInvalidate();
+      }
 
       if (firstsys==NULL)
          firstsys = sys;
@@ -845,22 +849,64 @@ static int mission_compare( const void* arg1, const void* arg2 )
 Mission* missions_genList( int *n, int faction,
       const Spob *pnt, const StarSystem *sys, MissionAvailability loc )
 {
-   int m, alloced;
-   int rep;
-   Mission* tmp;
-
-   /* Find available missions. */
-   tmp      = NULL;
-   m        = 0;
-   alloced  = 0;
-   for (int i=0; i<array_size(mission_stack); i++) {
+   MissionGen gen;
+   missions_genListStart( &gen, faction, pnt, sys, loc );
+   return missions_genListFinish( &gen, n );
+}
+
+/**
+ * @brief Starts generating a mission list incrementally.
+ *
+ * The candidate evaluation (mission 'cond' and create Lua) can then be
+ * spread over several frames with missions_genListStep() instead of
+ * freezing a single one; see land_update().
+ *
+ *    @param gen Generation state to initialize.
+ *    @param faction Faction of the spob.
+ *    @param pnt Spob to run on.
+ *    @param sys System to run on.
+ *    @param loc Location to run on.
+ */
+void missions_genListStart( MissionGen *gen, int faction,
+      const Spob *pnt, const StarSystem *sys, MissionAvailability loc )
+{
+   memset( gen, 0, sizeof(MissionGen) );
+   gen->active  = 1;
+   gen->faction = faction;
+   gen->pnt     = pnt;
+   gen->sys     = sys;
+   gen->loc     = loc;
+}
+
+/**
+ * @brief Evaluates mission candidates until a time budget runs out.
+ *
+ *    @param gen Generation state.
+ *    @param budget Seconds to spend at most; 0. for no limit.
+ *    @return 1 when the candidate sweep has completed, 0 otherwise.
+ */
+int missions_genListStep( MissionGen *gen, double budget )
+{
+   const double freq = (double)SDL_GetPerformanceFrequency();
+   Uint64 start = SDL_GetPerformanceCounter();
+
+   if (!gen->active)
+      return 1;
+
+   for (; gen->pos<array_size(mission_stack); gen->pos++) {
       double chance;
-      MissionData *misn = &mission_stack[i];
-      if (misn->avail.loc != loc)
+      int rep;
+      MissionData *misn = &mission_stack[gen->pos];
+
+      if ((budget > 0.) &&
+            ((double)(SDL_GetPerformanceCounter()-start)/freq >= budget))
+         return 0;
+
+      if (misn->avail.loc != gen->loc)
          continue;
 
       /* Must meet requirements. */
-      if (!mission_meetReq( misn, faction, pnt, sys ))
+      if (!mission_meetReq( misn, gen->faction, gen->pnt, gen->sys ))
          continue;
 
       /* Must hit chance. */
@@ -873,32 +919,62 @@ Mission* missions_genList( int *n, int faction,
       for (int j=0; j<rep; j++) {
          if (RNGF() > chance)
             continue;
-         m++;
+         gen->n++;
          /* Extra allocation. */
-         if (m > alloced) {
-            if (alloced == 0)
-               alloced = 32;
+         if (gen->n > gen->alloced) {
+            if (gen->alloced == 0)
+               gen->alloced = 32;
             else
-               alloced *= 2;
-            tmp      = realloc( tmp, sizeof(Mission) * alloced );
+               gen->alloced *= 2;
+            gen->missions = realloc( gen->missions,
+                  sizeof(Mission) * gen->alloced );
          }
          /* Initialize the mission. */
-         if (mission_init( &tmp[m-1], misn, 1, 1, NULL ))
-            m--;
+         if (mission_init( &gen->missions[gen->n-1], misn, 1, 1, NULL ))
+            gen->n--;
       }
    }
+   return 1;
+}
 
-   /* Sort. */
+/**
+ * @brief Completes an incremental generation and returns the sorted list.
+ *
+ *    @param gen Generation state.
+ *    @param[out] n Number of missions in the returned list.
+ *    @return The generated missions (to be freed by the caller).
+ */
+Mission *missions_genListFinish( MissionGen *gen, int *n )
+{
+   Mission *tmp;
+
+   missions_genListStep( gen, 0. );
+
+   tmp = gen->missions;
    if (tmp != NULL) {
-      qsort( tmp, m, sizeof(Mission), mission_compare );
-      (*n) = m;
+      qsort( tmp, gen->n, sizeof(Mission), mission_compare );
+      (*n) = gen->n;
    }
    else
       (*n) = 0;
 
+   memset( gen, 0, sizeof(MissionGen) );
    return tmp;
 }
 
+/**
+ * @brief Drops an unfinished generation, cleaning up what it created.
+ *
+ *    @param gen Generation state.
+ */
+void missions_genListAbort( MissionGen *gen )
+{
+   for (int i=0; i<gen->n; i++)
+      mission_cleanup( &gen->missions[i] );
+   free( gen->missions );
+   memset( gen, 0, sizeof(MissionGen) );
+}
+
 /**
  * @brief Gets location based on a human readable string.
  *
@@ -1138,7 +1214,7 @@ static int mission_parseFile( const char* file, MissionData *temp )
 
 #ifdef DEBUGGING
    /* Check to see if syntax is valid. */
-   int ret = luaL_loadbuffer(naevL, temp->lua, strlen(temp->lua), temp->name );
+   int ret = nlua_loadbuffer(naevL, temp->lua, strlen(temp->lua), temp->name );
    if (ret == LUA_ERRSYNTAX) {
       WARN(_("Mission Lua '%s' syntax error: %s"),
             file, lua_tostring(naevL,-1) );
@@ -109,11 +109,31 @@ typedef struct Mission_ {
  */
 extern Mission **player_missions; /**< Player's active missions. */
 
+/**
+ * @brief State of an incremental mission list generation.
+ */
+typedef struct MissionGen_ {
+   Mission *missions;   /**< Missions generated so far. */
+   int n;               /**< Number of missions generated. */
+   int alloced;         /**< Allocated size of missions. */
+   int pos;             /**< Next mission data index to evaluate. */
+   int active;          /**< Whether a generation is in progress. */
+   int faction;         /**< Faction of the spob. */
+   const Spob *pnt;     /**< Spob to run on. */
+   const StarSystem *sys; /**< System to run on. */
+   MissionAvailability loc; /**< Location to run on. */
+} MissionGen;
+
 /*
  * creates missions for a spob and such
  */
 Mission* missions_genList( int *n, int faction,
       const Spob *pnt, const StarSystem *sys, MissionAvailability loc );
+void missions_genListStart( MissionGen *gen, int faction,
+      const Spob *pnt, const StarSystem *sys, MissionAvailability loc );
+int missions_genListStep( MissionGen *gen, double budget );
+Mission *missions_genListFinish( MissionGen *gen, int *n );
+void missions_genListAbort( MissionGen *gen );
 int mission_accept( Mission* mission ); /* player accepted mission for computer/bar */
 void missions_run( MissionAvailability loc, int faction, const Spob *pnt, const StarSystem *sys );
 int mission_start( const char *name, unsigned int *id );
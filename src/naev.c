@@ -34,6 +34,7 @@
 #include "console.h"
 #include "damagetype.h"
 #include "debug.h"
+#include "dev_hotreload.h"
 #include "dialogue.h"
 #include "difficulty.h"
 #include "economy.h"
@@ -41,6 +42,7 @@
 #include "event.h"
 #include "faction.h"
 #include "font.h"
+#include "framegraph.h"
 #include "gui.h"
 #include "hook.h"
 #include "input.h"
@@ -58,6 +60,7 @@
 #include "nebula.h"
 #include "news.h"
 #include "nfile.h"
+#include "nlua.h"
 #include "nlua_misn.h"
 #include "nlua_var.h"
 #include "nlua_tex.h"
@@ -79,9 +82,11 @@
 #include "pilot.h"
 #include "player.h"
 #include "plugin.h"
+#include "profiler.h"
 #include "render.h"
 #include "rng.h"
 #include "safelanes.h"
+#include "save.h"
 #include "semver.h"
 #include "ship.h"
 #include "slots.h"
@@ -94,13 +99,16 @@
 #include "toolkit.h"
 #include "unidiff.h"
 #include "weapon.h"
+#include "worldsim.h"
 
 #define VERSION_FILE    "VERSION" /**< Version file by default. */
+#define NAEV_IDLE_WAIT  100 /**< Milliseconds to wait per frame for events when idle. */
 
 static int quit               = 0; /**< For primary loop */
 static unsigned int time_ms   = 0; /**< used to calculate FPS and movement. */
 static SDL_Surface *naev_icon = NULL; /**< Icon. */
 static int fps_skipped        = 0; /**< Skipped last frame? */
+static FrameGraph *update_graph = NULL; /**< Update frame graph; see the stage table above update_routine(). */
 /* Version stuff. */
 static semver_t version_binary; /**< Naev binary version. */
 static char version_human[STRMAX_SHORT]; /**< Human readable version. */
@@ -111,11 +119,13 @@ static char version_human[STRMAX_SHORT]; /**< Human readable version. */
 static double fps_dt    = 1.; /**< Display fps accumulator. */
 static double game_dt   = 0.; /**< Current game deltatick (uses dt_mod). */
 static double real_dt   = 0.; /**< Real deltatick. */
+static double benchmark_elapsed = 0.; /**< Simulated seconds run so far in benchmark mode. */
 static double fps       = 0.; /**< FPS to finally display. */
 static double fps_cur   = 0.; /**< FPS accumulator to trigger change. */
 static double fps_x     =  15.; /**< FPS X position. */
 static double fps_y     = -15.; /**< FPS Y position. */
 const double fps_min    = 1./30.; /**< Minimum fps to run at. */
+#define FIXED_PHYSICS_MAX_STEPS  8 /**< Maximum fixed steps per frame before game time dilates. */
 double elapsed_time_mod = 0.; /**< Elapsed modified time. */
 
 static nlua_env load_env = LUA_NOREF; /**< Environment for displaying load messages and stuff. */
@@ -127,6 +137,9 @@ static nlua_env load_env = LUA_NOREF; /**< Environment for displaying load messa
 static void print_SDLversion (void);
 static void loadscreen_load (void);
 static void loadscreen_unload (void);
+static int load_taskSlots( void *unused );
+static int load_taskDTypes( void *unused );
+static int load_taskDiffs( void *unused );
 static void load_all (void);
 static void unload_all (void);
 static void window_caption (void);
@@ -134,6 +147,7 @@ static void window_caption (void);
 static void fps_init (void);
 static double fps_elapsed (void);
 static void fps_control (void);
+static void fps_pace (void);
 static void update_all (void);
 /* Misc. */
 static void loadscreen_render( double done, const char *msg );
@@ -356,6 +370,9 @@ int main( int argc, char** argv )
    cond_init(); /* Initialize conditional subsystem. */
    cli_init(); /* Initialize console. */
 
+   /* Scan and index the save directory while the data loads. */
+   load_scanAsync();
+
    /* Data loading */
    load_all();
 
@@ -373,6 +390,21 @@ int main( int argc, char** argv )
    else
       LOG( _( "Reached main menu" ) );
 
+   /* Benchmark mode: load the most recent save as the scenario, take off
+    * and run the fixed-dt loop for the requested simulated time. */
+   if (conf.benchmark > 0) {
+      const nsave_t *ns;
+      load_refresh();
+      ns = load_getList( NULL );
+      if (ns != NULL) {
+         LOG( _( "Benchmark: loading '%s'" ), ns[0].path );
+         if (load_gameFile( ns[0].path ) == 0)
+            takeoff( 0, 1 );
+      }
+      else
+         LOG( _( "Benchmark: no saved games found, benchmarking the main menu" ) );
+   }
+
    fps_init(); /* initializes the time_ms */
 
    /*
@@ -427,6 +459,15 @@ int main( int argc, char** argv )
 
    /* primary loop */
    while (!quit) {
+      /* Idle governor: landed with no background work left means nothing
+       * on screen moves on its own, so sleep until input arrives (or the
+       * timeout keeps slow things like cursor blink and music serviced)
+       * instead of spinning at the FPS cap all night. */
+      if ((conf.benchmark <= 0) && land_isIdle())
+         SDL_WaitEventTimeout( NULL, NAEV_IDLE_WAIT );
+
+      fps_pace(); /* sleeps the FPS-cap idle time before input is sampled. */
+
       while (!quit && SDL_PollEvent(&event)) { /* event loop */
          if (event.type == SDL_QUIT) {
             if (quit || menu_askQuit()) {
@@ -443,8 +484,24 @@ int main( int argc, char** argv )
       }
 
       main_loop( 1 );
+
+      /* End the benchmark after the requested amount of simulated time. */
+      if (conf.benchmark > 0) {
+         benchmark_elapsed += game_dt;
+         if (benchmark_elapsed >= (double)conf.benchmark) {
+            LOG( _( "Benchmark complete: %d simulated seconds" ), conf.benchmark );
+            quit = 1;
+         }
+      }
    }
 
+   /* Wait for any asynchronous save to finish writing and drop the
+    * in-memory save snapshot. */
+   save_exit();
+
+   /* Dump frame timings if profiling. */
+   prof_exit();
+
    /* Save configuration. */
    conf_saveConfig(conf_file_path);
 
@@ -459,6 +516,8 @@ int main( int argc, char** argv )
    start_cleanup(); /* Cleanup from start.c, not the first cleanup step. :) */
 
    /* exit subsystems */
+   fg_destroy( update_graph ); /* Frees the update frame graph. */
+   update_graph = NULL;
    plugin_exit();
    cli_exit(); /* Clean up the console. */
    map_system_exit(); /* Destroys the solar system map. */
@@ -500,6 +559,7 @@ int main( int argc, char** argv )
    PHYSFS_deinit();
    gl_fontExit();
    gettext_exit();
+   strintern_exit(); /* Interned strings must outlive everything that uses them. */
 
    /* all is well */
    debug_enableLeakSanitizer();
@@ -577,15 +637,63 @@ static void loadscreen_unload (void)
    nlua_freeEnv( load_env );
 }
 
+/*
+ * Parse tasks run on threadpool workers during load_all(). Only loaders
+ * touching neither the OpenGL context nor the shared Lua state may go here.
+ */
+static SDL_sem *loadtask_sem = NULL; /**< Posted once per finished background parse task. */
+#define LOADING_TASKS      3 /**< Amount of background parse tasks. */
+
+/**
+ * @brief Threadpool job: parses the slot properties.
+ */
+static int load_taskSlots( void *unused )
+{
+   (void) unused;
+   sp_load(); /* dep for outfits */
+   SDL_SemPost( loadtask_sem );
+   return 0;
+}
+
+/**
+ * @brief Threadpool job: parses the damage types.
+ */
+static int load_taskDTypes( void *unused )
+{
+   (void) unused;
+   dtype_load(); /* dep for outfits */
+   SDL_SemPost( loadtask_sem );
+   return 0;
+}
+
+/**
+ * @brief Threadpool job: indexes the available unidiffs.
+ */
+static int load_taskDiffs( void *unused )
+{
+   (void) unused;
+   diff_loadAvailable(); /* dep for loading the player */
+   SDL_SemPost( loadtask_sem );
+   return 0;
+}
+
 /**
  * @brief Loads all the data, makes main() simpler.
  */
-#define LOADING_STAGES     17. /**< Amount of loading stages. */
+#define LOADING_STAGES     16. /**< Amount of loading stages. */
 void load_all (void)
 {
    int stage = 0;
-   /* We can do fast stuff here. */
-   sp_load();
+
+   /* Stream the previous run's load order ahead of the loaders. */
+   ndata_prefetchStart();
+
+   /* Kick off the parse tasks that are independent of the loaders below;
+    * they overlap the OpenGL- and Lua-heavy loading on the main thread. */
+   loadtask_sem = SDL_CreateSemaphore( 0 );
+   threadpool_newJob( load_taskSlots, NULL );
+   threadpool_newJob( load_taskDTypes, NULL );
+   threadpool_newJob( load_taskDiffs, NULL );
 
    /* order is very important as they're interdependent */
    loadscreen_render( ++stage/LOADING_STAGES, _("Loading Commodities…") );
@@ -597,8 +705,13 @@ void load_all (void)
    loadscreen_render( ++stage/LOADING_STAGES, _("Loading Effects…") );
    effect_load(); /* no dep */
 
-   loadscreen_render( ++stage/LOADING_STAGES, _("Loading Damage Types…") );
-   dtype_load(); /* dep for outfits */
+   /* Outfits need the slot properties and damage types, so this is the
+    * latest the background parse tasks may finish. */
+   loadscreen_render( ++stage/LOADING_STAGES, _("Loading Core Data…") );
+   for (int i=0; i<LOADING_TASKS; i++)
+      SDL_SemWait( loadtask_sem );
+   SDL_DestroySemaphore( loadtask_sem );
+   loadtask_sem = NULL;
 
    loadscreen_render( ++stage/LOADING_STAGES, _("Loading Outfits…") );
    outfit_load(); /* dep for ships, factions */
@@ -627,9 +740,6 @@ void load_all (void)
    loadscreen_render( ++stage/LOADING_STAGES, _("Loading Missions…") );
    missions_load();
 
-   loadscreen_render( ++stage/LOADING_STAGES, _("Loading the UniDiffs…") );
-   diff_loadAvailable();
-
    loadscreen_render( ++stage/LOADING_STAGES, _("Populating Maps…") );
    outfit_mapParse();
 
@@ -645,11 +755,12 @@ void load_all (void)
    background_init();
    map_load();
    map_system_load();
-   space_loadLua();
    pilots_init();
    weapon_init();
    player_init(); /* Initialize player stuff. */
    loadscreen_render( 1., _("Loading Completed!") );
+   ndata_prefetchFinish();
+   array_reportStats(); /* Loading is where the realloc storms happen. */
 }
 /**
  * @brief Unloads all data, simplifies main().
@@ -661,6 +772,7 @@ void unload_all (void)
    gui_free(); /* cleans up the player's GUI */
    weapon_exit(); /* destroys all active weapons */
    pilots_free(); /* frees the pilots, they were locked up :( */
+   solid_exit(); /* empties the solid reuse pool */
    cond_exit(); /* destroy conditional subsystem. */
    land_exit(); /* Destroys landing vbo and friends. */
    npc_clear(); /* In case exiting while landed. */
@@ -669,6 +781,7 @@ void unload_all (void)
    safelanes_destroy();
    diff_free();
    economy_destroy(); /* must be called before space_exit */
+   worldsim_exit(); /* must be called before space_exit */
    space_exit(); /* cleans up the universe itself */
    tech_free(); /* Frees tech stuff. */
    ships_free();
@@ -692,6 +805,7 @@ void main_loop( int update )
    /*
     * Control FPS.
     */
+   prof_frameBegin();
    fps_control(); /* everyone loves fps control */
 
    /*
@@ -699,7 +813,9 @@ void main_loop( int update )
     */
    input_update( real_dt ); /* handle key repeats. */
    sound_update( real_dt ); /* Update sounds. */
+   devhot_update( real_dt ); /* devmode script hot-reload. */
    toolkit_update(); /* to simulate key repetition and get rid of windows */
+   land_update(); /* advances background work while landed. */
    if (!paused && update) {
       /* Important that we pass real_dt here otherwise we get a dt feedback loop which isn't pretty. */
       player_updateAutonav( real_dt );
@@ -722,11 +838,22 @@ void main_loop( int update )
    if (!quit) { /* So if update sets up a nested main loop, we can end up in a
                    state where things are corrupted when trying to exit the game.
                    Avoid rendering when quitting just in case. */
+      /* Upload any asynchronously decoded textures. */
+      gl_texAsyncPump();
+      /* Hand any finished screenshot readback to the I/O worker. */
+      gl_screenshotPump();
       /* Clear buffer. */
+      prof_begin( PROF_RENDER );
       render_all( game_dt, real_dt );
+      prof_end( PROF_RENDER );
+      /* Queue the frame's readback when continuous capture is on. */
+      gl_captureFrame();
       /* Draw buffer. */
       SDL_GL_SwapWindow( gl_screen.window );
+      /* Input handled this frame is now on its way to the screen. */
+      prof_inputPresent();
    }
+   prof_frameEnd();
 }
 
 /**
@@ -848,11 +975,87 @@ static void fps_control (void)
    real_dt  = fps_elapsed();
    game_dt  = real_dt * dt_mod; /* Apply the modifier. */
 
-   /* if fps is limited */
-   if (!conf.vsync && conf.fps_max != 0) {
+   /* Benchmark runs use a fixed timestep so results are comparable across
+    * machines, and skip the FPS cap to finish as fast as possible. */
+   if (conf.benchmark > 0) {
+      real_dt = 1./60.;
+      game_dt = real_dt * dt_mod;
+      nlua_gcStep( 0. ); /* Collector is manual now; keep it progressing. */
+      return;
+   }
+
+   /* if fps is limited; with pacing on the wait happens in fps_pace()
+    * ahead of input sampling instead. */
+   if (!conf.vsync && (conf.fps_max != 0) && !conf.fps_pace) {
       const double fps_max = 1./(double)conf.fps_max;
       if (real_dt < fps_max) {
          double delay = fps_max - real_dt;
+         /* Spend part of the idle wait advancing the Lua GC so collection
+          * pauses don't land mid-frame. */
+         delay -= nlua_gcStep( delay );
+         if (delay > 0.) {
+#if HAS_POSIX
+            ts.tv_sec  = floor( delay );
+            ts.tv_nsec = fmod( delay, 1. ) * 1e9;
+            nanosleep( &ts, NULL );
+#else /* HAS_POSIX */
+            SDL_Delay( (unsigned int)(delay * 1000) );
+#endif /* HAS_POSIX */
+            fps_dt  += delay; /* makes sure it displays the proper fps */
+         }
+      }
+      else
+         nlua_gcStep( 0. );
+   }
+   else
+      nlua_gcStep( 0. );
+}
+
+static Uint64 pace_t = 0;     /**< Counter value when the last pace sleep ended. */
+static double pace_work = 0.; /**< Smoothed frame work time (s), excluding the sleep. */
+/**
+ * @brief Delays the start of the frame at a capped FPS to cut input latency.
+ *
+ * fps_control() sleeps after input has already been sampled, so at a
+ * capped FPS events age by the whole idle wait before they are acted
+ * on. With the fps_pace option the wait happens here instead, before
+ * the event loop runs: sleep until just enough of the frame period
+ * remains for the expected work, so input is sampled as late as
+ * possible. The work estimate tracks spikes immediately and decays
+ * slowly, and a margin is kept so slow frames do not blow the period.
+ */
+static void fps_pace (void)
+{
+   Uint64 now;
+   double work, delay;
+#if HAS_POSIX
+   struct timespec ts;
+#endif /* HAS_POSIX */
+
+   if (!conf.fps_pace || conf.vsync || (conf.fps_max == 0) ||
+         (conf.benchmark > 0)) {
+      pace_t = 0; /* Resync if toggled back on. */
+      return;
+   }
+
+   now = SDL_GetPerformanceCounter();
+   if (pace_t == 0) { /* First frame; nothing measured yet. */
+      pace_t = now;
+      return;
+   }
+
+   /* Time since the last sleep ended is the previous frame's work. */
+   work = (double)(now - pace_t) / (double)SDL_GetPerformanceFrequency();
+   if (work > pace_work)
+      pace_work = work;
+   else
+      pace_work += 0.05 * (work - pace_work);
+
+   delay = 1./(double)conf.fps_max - pace_work * 1.1;
+   if (delay > 0.) {
+      /* Spend part of the wait on the Lua GC, like fps_control does. */
+      delay -= nlua_gcStep( delay );
+      if (delay > 0.) {
 #if HAS_POSIX
          ts.tv_sec  = floor( delay );
          ts.tv_nsec = fmod( delay, 1. ) * 1e9;
@@ -860,9 +1063,9 @@ static void fps_control (void)
 #else /* HAS_POSIX */
          SDL_Delay( (unsigned int)(delay * 1000) );
 #endif /* HAS_POSIX */
-         fps_dt  += delay; /* makes sure it displays the proper fps */
       }
    }
+   pace_t = SDL_GetPerformanceCounter();
 }
 
 /**
@@ -905,6 +1108,11 @@ void display_fps( const double dt )
    if (dt_mod != dt_mod_base)
       gl_print( &gl_defFontMono, x, y, &cFontWhite, "%3.1fx", dt_mod / dt_mod_base);
 
+   if (conf.profiler) {
+      y -= gl_defFontMono.h + 5.;
+      prof_renderOverlay( x, y );
+   }
+
    if (!paused || !player_paused || !conf.pause_show)
       return;
 
@@ -918,12 +1126,122 @@ void display_fps( const double dt )
  *
  *    @brief Mainly uses game dt.
  */
+/**
+ * Render-only subsystems don't need to run once per physics substep:
+ * during time compression (or fixed-step catch-up) the spfx/trail update
+ * is deferred out of the substep loop and run once per frame with the
+ * total advanced time instead. Set around the substep loops below.
+ */
+static int update_spfx_defer = 0;
+
+/*
+ * The engine section of update_routine() runs through a frame graph: each
+ * stage declares what it reads and writes and the scheduler derives the
+ * ordering from the conflicts (see framegraph.c). Today almost every stage
+ * touches the global Lua state and therefore serializes on the main thread
+ * in the familiar order; the camera stage is pure math over pilot positions
+ * and overlaps the faction standing flush. Stages audited as thread-safe
+ * later join the overlap by dropping FG_MAIN_THREAD here.
+ */
+
+static void update_fgSpace( double dt, double real_dt )
+{
+   space_update( dt, real_dt );
+}
+static void update_fgWeapons( double dt, double real_dt )
+{
+   (void) real_dt;
+   weapons_update( dt );
+}
+static void update_fgSpfx( double dt, double real_dt )
+{
+   if (!update_spfx_defer) /* Coalesced over substeps; see update_all. */
+      spfx_update( dt, real_dt );
+}
+static void update_fgPilots( double dt, double real_dt )
+{
+   (void) real_dt;
+   pilots_update( dt );
+}
+static void update_fgFaction( double dt, double real_dt )
+{
+   (void) dt;
+   (void) real_dt;
+   /* Apply the combat standing hits batched up during the update. */
+   faction_modPlayerFlush();
+}
+static void update_fgCamera( double dt, double real_dt )
+{
+   (void) real_dt;
+   cam_update( dt );
+}
+
+static const FGStage update_stages[] = {
+   { .name="space",   .func=update_fgSpace,
+     .reads=FG_RES_PILOTS | FG_RES_TIME,
+     .writes=FG_RES_SPACE | FG_RES_LUA,
+     .flags=FG_MAIN_THREAD, .prof=PROF_SPACE },
+   { .name="weapons", .func=update_fgWeapons,
+     .reads=FG_RES_SPACE,
+     .writes=FG_RES_WEAPONS | FG_RES_PILOTS | FG_RES_SPFX | FG_RES_LUA,
+     .flags=FG_MAIN_THREAD, .prof=PROF_WEAPONS },
+   { .name="spfx",    .func=update_fgSpfx,
+     .reads=0,
+     .writes=FG_RES_SPFX, /* Trail VBOs and layer worker need the GL thread. */
+     .flags=FG_MAIN_THREAD, .prof=PROF_SPFX },
+   { .name="pilots",  .func=update_fgPilots,
+     .reads=FG_RES_SPACE | FG_RES_WEAPONS,
+     .writes=FG_RES_PILOTS | FG_RES_SPFX | FG_RES_FACTION | FG_RES_LUA,
+     .flags=FG_MAIN_THREAD, .prof=PROF_PILOTS },
+   { .name="faction", .func=update_fgFaction,
+     .reads=FG_RES_PILOTS,
+     .writes=FG_RES_FACTION | FG_RES_LUA,
+     .flags=FG_MAIN_THREAD, .prof=-1 },
+   { .name="camera",  .func=update_fgCamera,
+     .reads=FG_RES_PILOTS,
+     .writes=FG_RES_CAMERA,
+     .flags=0, .prof=-1 },
+};
+
 static void update_all (void)
 {
    if ((real_dt > 0.25) && (fps_skipped==0)) { /* slow timers down and rerun calculations */
       fps_skipped = 1;
       return;
    }
+   else if (conf.fixed_physics) {
+      /* Decoupled fixed-step simulation: the game advances in constant
+       * 60 Hz steps regardless of the frame rate, and rendering
+       * interpolates between the last two steps (see solid_renderPos()).
+       * The accumulator is capped so a GPU-bound frame can't demand ever
+       * more catch-up steps; past the cap game time dilates instead of
+       * death-spiralling. */
+      const double step = 1./60.;
+      static double accum = 0.;
+      double stepped = 0.;
+
+      accum += game_dt;
+      if (accum > (double)FIXED_PHYSICS_MAX_STEPS * step)
+         accum = (double)FIXED_PHYSICS_MAX_STEPS * step;
+
+      solid_setRenderInterp( 1. ); /* Updates must see the real state. */
+      update_spfx_defer = (accum >= 2.*step);
+      while (accum >= step) {
+         input_pollSubstep(); /* Keep mouse aim fresh at low FPS. */
+         update_routine( step, 0 );
+         accum -= step;
+         stepped += step;
+      }
+      if (update_spfx_defer) {
+         update_spfx_defer = 0;
+         prof_begin( PROF_SPFX );
+         spfx_update( stepped, real_dt );
+         prof_end( PROF_SPFX );
+      }
+
+      /* How far into the next step the rendered frame falls. */
+      solid_setRenderInterp( accum / step );
+   }
    else if (game_dt > fps_min) { /* we'll force a minimum FPS for physics to work alright. */
       int n;
       double nf, microdt, accumdt;
@@ -934,8 +1252,10 @@ static void update_all (void)
       n  = (int) nf;
 
       /* Update as much as needed, evenly. */
+      update_spfx_defer = 1;
       accumdt = 0.;
       for (int i=0; i<n; i++) {
+         input_pollSubstep(); /* Keep mouse aim fresh at low FPS. */
          update_routine( microdt, 0 );
          /* OK, so we need a bit of hackish logic here in case we are chopping up a
           * very large dt and it turns out time compression changes so we're now
@@ -948,6 +1268,13 @@ static void update_all (void)
             break;
       }
 
+      /* Effects advance once with the total time instead of per substep,
+       * so compression doesn't multiply their cost. */
+      update_spfx_defer = 0;
+      prof_begin( PROF_SPFX );
+      spfx_update( accumdt, real_dt );
+      prof_end( PROF_SPFX );
+
       /* Note we don't touch game_dt so that fps_display works well */
    }
    else /* Standard, just update with the last dt */
@@ -971,14 +1298,11 @@ void update_routine( double dt, int enter_sys )
       ntime_update( dt );
    }
 
-   /* Update engine stuff. */
-   space_update(dt, real_dt);
-   weapons_update(dt);
-   spfx_update(dt, real_dt);
-   pilots_update(dt);
-
-   /* Update camera. */
-   cam_update( dt );
+   /* Update engine stuff through the frame graph. */
+   if (update_graph == NULL)
+      update_graph = fg_create( update_stages,
+            sizeof(update_stages) / sizeof(update_stages[0]) );
+   fg_run( update_graph, dt, real_dt );
 
    /* Update the elapsed time, should be with all the modifications and such. */
    elapsed_time_mod += dt;
@@ -14,6 +14,11 @@
 #include <stdlib.h>
 #if WIN32
 #include <windows.h>
+#else /* WIN32 */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif /* WIN32 */
 
 #include "physfs.h"
@@ -35,12 +40,71 @@
 #include "nstring.h"
 #include "plugin.h"
 
+/* Manifest of the merged virtual filesystem, built once after everything
+ * (including plugins) is mounted so lookups and directory listings stop
+ * re-walking the archive directory structures. Sorted for binary search.
+ * Files created at runtime in the write directory are not in it, so all
+ * users fall back to PhysicsFS on a miss. */
+static char **ndata_manifest = NULL; /**< Sorted paths of every regular file. */
+
+/**
+ * @brief An outstanding zero-copy view returned by ndata_map.
+ *
+ * Tracked so ndata_unmap can tell mmap'd views apart from the malloc'd
+ * fallback copies without burdening callers with the distinction.
+ */
+typedef struct NdataMapping_ {
+   void *data;  /**< Start of the mapped view. */
+   size_t size; /**< Size of the mapped view. */
+} NdataMapping;
+static NdataMapping *ndata_mappings = NULL; /**< Array (array.h) of live mappings. */
+
+/*
+ * Startup prefetch: the order loaders request files in is recorded during
+ * loading and replayed on the next run by a background thread that streams
+ * the same files into a memory cache ahead of the loaders, turning the
+ * cold-start random reads into one sequential scan. Misses just fall
+ * through to a normal read, so a stale order file costs nothing.
+ */
+#define PREFETCH_ORDER_FILE "%sloadorder" /**< Recorded order, in the cache dir. */
+#define PREFETCH_BUDGET (64*1024*1024) /**< Max bytes fetched but not yet consumed. */
+
+typedef enum PrefetchState_ {
+   PREFETCH_PENDING = 0, /**< Not fetched yet. */
+   PREFETCH_READY,       /**< Fetched and waiting; buf is valid. */
+   PREFETCH_CONSUMED     /**< Handed out, or claimed by a loader directly. */
+} PrefetchState;
+
+/**
+ * @brief One file of the replayed load order.
+ */
+typedef struct PrefetchFile_ {
+   char *path;    /**< File path in the virtual filesystem. */
+   char *buf;     /**< Contents while PREFETCH_READY, else NULL. */
+   size_t size;   /**< Size of buf. */
+   PrefetchState state; /**< Where the file is in its life cycle. */
+} PrefetchFile;
+
+static PrefetchFile *pf_files = NULL; /**< Array (array.h): replayed order. */
+static char **pf_record = NULL; /**< Array (array.h): order being recorded. */
+static SDL_mutex *pf_lock = NULL; /**< Protects all prefetch state. */
+static SDL_Thread *pf_thread = NULL; /**< The streaming I/O thread. */
+static int pf_stop = 0; /**< Tells the thread to wind down. */
+static size_t pf_bytes = 0; /**< Fetched but not yet consumed bytes. */
+static int pf_hint = 0; /**< Entry the consumer search starts at. */
+
 /*
  * Prototypes.
  */
 static void ndata_testVersion (void);
+static void *ndata_readRaw( const char *path, size_t *filesize );
+static void *ndata_prefetchClaim( const char *path, size_t *filesize );
+static int ndata_prefetchThread( void *unused );
 static int ndata_found (void);
 static int ndata_enumerateCallback( void* data, const char* origdir, const char* fname );
+static void ndata_buildManifest (void);
+static int ndata_manifestLower( const char *path );
+static int ndata_manifestHas( const char *path );
 
 /**
  * @brief Checks to see if the physfs search path is enough to find game data.
@@ -141,9 +205,81 @@ void ndata_setupReadDirs (void)
    /* Load plugins I guess. */
    plugin_init();
 
+   /* Index the merged virtual filesystem now that all mounts are up. */
+   ndata_buildManifest();
+
    ndata_testVersion();
 }
 
+/**
+ * @brief Walks every mounted archive once and builds the sorted manifest.
+ */
+static void ndata_buildManifest (void)
+{
+   if (ndata_manifest != NULL) {
+      for (int i=0; i<array_size(ndata_manifest); i++)
+         free( ndata_manifest[i] );
+      array_free( ndata_manifest );
+   }
+   ndata_manifest = array_create( char* );
+   PHYSFS_enumerate( "", ndata_enumerateCallback, &ndata_manifest );
+   /* Same dedup as ndata_listRecursive; union mounts can repeat paths. */
+   qsort( ndata_manifest, array_size(ndata_manifest), sizeof(char*), strsort );
+   for (int i=0; i+1<array_size(ndata_manifest); i++)
+      if (strcmp(ndata_manifest[i], ndata_manifest[i+1]) == 0) {
+         free( ndata_manifest[i] );
+         array_erase( &ndata_manifest, &ndata_manifest[i], &ndata_manifest[i+1] );
+         i--;
+      }
+}
+
+/**
+ * @brief Finds the first manifest entry that is >= path (binary search).
+ */
+static int ndata_manifestLower( const char *path )
+{
+   int lo = 0, hi = array_size(ndata_manifest);
+   while (lo < hi) {
+      int mid = (lo+hi)/2;
+      if (strcmp( ndata_manifest[mid], path ) < 0)
+         lo = mid+1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/**
+ * @brief Whether a path is a regular file according to the manifest.
+ */
+static int ndata_manifestHas( const char *path )
+{
+   int i;
+   if (ndata_manifest == NULL)
+      return 0;
+   i = ndata_manifestLower( path );
+   return (i < array_size(ndata_manifest)) && (strcmp( ndata_manifest[i], path )==0);
+}
+
+/**
+ * @brief Whether a path exists as a regular file in the ndata.
+ *
+ * Once the manifest is built this is a single binary search over the merged
+ *  mount union instead of PhysicsFS probing every mount in priority order,
+ *  and a miss costs the same as a hit.  Files created at runtime in the
+ *  write directory are not in the manifest, so callers interested in those
+ *  have to ask PhysicsFS directly.
+ *
+ *    @param path Path to check.
+ *    @return 1 if the file exists, 0 otherwise.
+ */
+int ndata_exists( const char *path )
+{
+   if (ndata_manifest == NULL)
+      return PHYSFS_exists( path );
+   return ndata_manifestHas( path );
+}
+
 /**
  * @brief Reads a file from the ndata (will be NUL terminated).
  *
@@ -152,6 +288,30 @@ void ndata_setupReadDirs (void)
  *    @return The file data or NULL on error.
  */
 void* ndata_read( const char* path, size_t *filesize )
+{
+   if (pf_lock != NULL) {
+      void *buf;
+
+      /* Remember the order for the next run; hits must be recorded too
+       * or the rewritten loadorder would only keep this run's misses. */
+      if (pf_record != NULL) {
+         SDL_mutexP( pf_lock );
+         array_push_back( &pf_record, strdup(path) );
+         SDL_mutexV( pf_lock );
+      }
+
+      /* The prefetcher may already have this in memory. */
+      buf = ndata_prefetchClaim( path, filesize );
+      if (buf != NULL)
+         return buf;
+   }
+   return ndata_readRaw( path, filesize );
+}
+
+/**
+ * @brief ndata_read() without prefetch-cache involvement.
+ */
+static void *ndata_readRaw( const char *path, size_t *filesize )
 {
    char *buf;
    PHYSFS_file *file;
@@ -159,16 +319,20 @@ void* ndata_read( const char* path, size_t *filesize )
    size_t pos;
    PHYSFS_Stat path_stat;
 
-   if (!PHYSFS_stat( path, &path_stat )) {
-      WARN( _( "Error occurred while opening '%s': %s" ), path,
-            _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
-      *filesize = 0;
-      return NULL;
-   }
-   if (path_stat.filetype != PHYSFS_FILETYPE_REGULAR) {
-      WARN( _( "Error occurred while opening '%s': It is not a regular file" ), path );
-      *filesize = 0;
-      return NULL;
+   /* Indexed files are known regular; only misses (e.g. files created at
+    * runtime in the write directory) have to hit PhysicsFS for the stat. */
+   if (!ndata_manifestHas( path )) {
+      if (!PHYSFS_stat( path, &path_stat )) {
+         WARN( _( "Error occurred while opening '%s': %s" ), path,
+               _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+         *filesize = 0;
+         return NULL;
+      }
+      if (path_stat.filetype != PHYSFS_FILETYPE_REGULAR) {
+         WARN( _( "Error occurred while opening '%s': It is not a regular file" ), path );
+         *filesize = 0;
+         return NULL;
+      }
    }
 
    /* Open file. */
@@ -222,6 +386,237 @@ void* ndata_read( const char* path, size_t *filesize )
    return buf;
 }
 
+/**
+ * @brief Takes a file out of the prefetch cache if it is there.
+ *
+ * A PREFETCH_PENDING hit is claimed too, so the thread skips it once the
+ * loader has gone ahead and read it itself.
+ *
+ *    @param path File being requested.
+ *    @param[out] filesize Size of the returned buffer.
+ *    @return The cached contents, or NULL if the loader has to read it.
+ */
+static void *ndata_prefetchClaim( const char *path, size_t *filesize )
+{
+   char *buf = NULL;
+   int n;
+
+   SDL_mutexP( pf_lock );
+   n = array_size( pf_files );
+   /* The consumption order tracks the recorded order, so searching from
+    * the last hit finds the entry at the first probe almost always. */
+   for (int i=0; i<n; i++) {
+      PrefetchFile *pf = &pf_files[ (pf_hint+i) % n ];
+      if ((pf->state == PREFETCH_CONSUMED) || (strcmp( pf->path, path )!=0))
+         continue;
+      if (pf->state == PREFETCH_READY) {
+         buf         = pf->buf;
+         *filesize   = pf->size;
+         pf->buf     = NULL;
+         pf_bytes   -= pf->size;
+      }
+      pf->state = PREFETCH_CONSUMED;
+      pf_hint   = ((pf_hint+i) % n) + 1;
+      break;
+   }
+   SDL_mutexV( pf_lock );
+   return buf;
+}
+
+/**
+ * @brief Streams the recorded load order into memory ahead of the loaders.
+ */
+static int ndata_prefetchThread( void *unused )
+{
+   (void) unused;
+   for (int i=0; i<array_size(pf_files); i++) {
+      PrefetchFile *pf = &pf_files[i];
+      char *buf;
+      size_t size;
+      int claimed;
+
+      if (pf_stop)
+         break;
+
+      /* Don't run unboundedly far ahead of the loaders. */
+      while ((pf_bytes > PREFETCH_BUDGET) && !pf_stop)
+         SDL_Delay( 10 );
+
+      SDL_mutexP( pf_lock );
+      claimed = (pf->state != PREFETCH_PENDING);
+      SDL_mutexV( pf_lock );
+      if (claimed || !ndata_manifestHas( pf->path ))
+         continue;
+
+      buf = ndata_readRaw( pf->path, &size );
+      if (buf == NULL)
+         continue;
+
+      SDL_mutexP( pf_lock );
+      if (pf->state == PREFETCH_PENDING) {
+         pf->buf   = buf;
+         pf->size  = size;
+         pf->state = PREFETCH_READY;
+         pf_bytes += size;
+         buf       = NULL;
+      }
+      SDL_mutexV( pf_lock );
+      free( buf ); /* The loader got there first. */
+   }
+   return 0;
+}
+
+/**
+ * @brief Starts recording the load order and replaying the previous one.
+ */
+void ndata_prefetchStart (void)
+{
+   char file[PATH_MAX], *data;
+   size_t size;
+
+   if (pf_lock != NULL)
+      return;
+   pf_lock   = SDL_CreateMutex();
+   pf_record = array_create( char* );
+
+   /* Parse the order recorded by the previous run, one path per line. */
+   snprintf( file, sizeof(file), PREFETCH_ORDER_FILE, nfile_cachePath() );
+   data = nfile_readFile( &size, file );
+   if (data == NULL)
+      return;
+   pf_files = array_create( PrefetchFile );
+   for (size_t i=0; i<size; ) {
+      PrefetchFile pf;
+      size_t l = i;
+      while ((l < size) && (data[l] != '\n'))
+         l++;
+      if (l > i) {
+         pf.path  = strndup( &data[i], l-i );
+         pf.buf   = NULL;
+         pf.size  = 0;
+         pf.state = PREFETCH_PENDING;
+         array_push_back( &pf_files, pf );
+      }
+      i = l+1;
+   }
+   free( data );
+
+   if (array_size(pf_files) > 0)
+      pf_thread = SDL_CreateThread( ndata_prefetchThread, "prefetch", NULL );
+}
+
+/**
+ * @brief Stops the prefetcher and writes the newly recorded load order.
+ */
+void ndata_prefetchFinish (void)
+{
+   char file[PATH_MAX], *out;
+
+   if (pf_lock == NULL)
+      return;
+
+   pf_stop = 1;
+   if (pf_thread != NULL)
+      SDL_WaitThread( pf_thread, NULL );
+   pf_thread = NULL;
+
+   /* Always rewrite the order: mounted plugins or data updates change it. */
+   out = array_create( char );
+   for (int i=0; i<array_size(pf_record); i++) {
+      const char *p = pf_record[i];
+      int n = array_size( out );
+      size_t l = strlen( p );
+      array_resize( &out, n + l + 1 );
+      memcpy( &out[n], p, l );
+      out[n+l] = '\n';
+      free( pf_record[i] );
+   }
+   snprintf( file, sizeof(file), PREFETCH_ORDER_FILE, nfile_cachePath() );
+   if (array_size(out) > 0)
+      nfile_writeFile( out, array_size(out), file );
+   array_free( out );
+   array_free( pf_record );
+   pf_record = NULL;
+
+   /* Drop whatever the loaders never asked for. */
+   for (int i=0; i<array_size(pf_files); i++) {
+      free( pf_files[i].path );
+      free( pf_files[i].buf );
+   }
+   array_free( pf_files );
+   pf_files = NULL;
+   pf_bytes = 0;
+   pf_hint  = 0;
+
+   SDL_DestroyMutex( pf_lock );
+   pf_lock = NULL;
+}
+
+/**
+ * @brief Returns a read-only view of a file, avoiding a copy when possible.
+ *
+ * When the file lives in a plain directory mount it is mmap'd straight
+ * from disk; archive members fall back to a regular ndata_read copy.
+ * Unlike ndata_read the view is NOT NUL terminated, so it only suits
+ * callers that track the size explicitly. Release with ndata_unmap.
+ *
+ *    @param path Path of the file to map.
+ *    @param[out] filesize Stores the size of the file.
+ *    @return The read-only view or NULL on error.
+ */
+void* ndata_map( const char* path, size_t *filesize )
+{
+#if !WIN32
+   const char *realdir = PHYSFS_getRealDir( path );
+   if (realdir != NULL) {
+      char real[PATH_MAX];
+      struct stat st;
+      /* Only plain directory mounts resolve to a real file of this name;
+       * for archives the concatenation points inside the archive file. */
+      if ((nfile_concatPaths( real, sizeof(real), realdir, path ) >= 0) &&
+            (stat( real, &st ) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+         int fd = open( real, O_RDONLY );
+         if (fd >= 0) {
+            void *data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            close( fd );
+            if (data != MAP_FAILED) {
+               NdataMapping *m;
+               if (ndata_mappings == NULL)
+                  ndata_mappings = array_create( NdataMapping );
+               m = &array_grow( &ndata_mappings );
+               m->data = data;
+               m->size = st.st_size;
+               *filesize = st.st_size;
+               return data;
+            }
+         }
+      }
+   }
+#endif /* !WIN32 */
+   return ndata_read( path, filesize );
+}
+
+/**
+ * @brief Releases a view returned by ndata_map.
+ *
+ *    @param data View to release (NULL is a no-op).
+ */
+void ndata_unmap( void* data )
+{
+   if (data == NULL)
+      return;
+#if !WIN32
+   for (int i=0; i<array_size(ndata_mappings); i++) {
+      if (ndata_mappings[i].data != data)
+         continue;
+      munmap( data, ndata_mappings[i].size );
+      array_erase( &ndata_mappings, &ndata_mappings[i], &ndata_mappings[i+1] );
+      return;
+   }
+#endif /* !WIN32 */
+   free( data ); /* Was an ndata_read fallback copy. */
+}
+
 /**
  * @brief Lists all the visible files in a directory, at any depth.
  *
@@ -232,6 +627,28 @@ void* ndata_read( const char* path, size_t *filesize )
 char **ndata_listRecursive( const char *path )
 {
    char **files = array_create( char * );
+
+   /* Serve from the manifest when it covers the directory, avoiding the
+    * per-call archive walk. Already sorted and unique. */
+   if (ndata_manifest != NULL) {
+      char prefix[PATH_MAX];
+      size_t len = strlen( path );
+      int i;
+      if ((len > 0) && (path[len-1] != '/'))
+         len = snprintf( prefix, sizeof(prefix), "%s/", path );
+      else
+         len = snprintf( prefix, sizeof(prefix), "%s", path );
+      i = ndata_manifestLower( prefix );
+      for (; i<array_size(ndata_manifest); i++) {
+         if (strncmp( ndata_manifest[i], prefix, len ) != 0)
+            break;
+         array_push_back( &files, strdup( ndata_manifest[i] ) );
+      }
+      if (array_size(files) > 0)
+         return files;
+      /* Nothing indexed there; may have been created after mount time. */
+   }
+
    PHYSFS_enumerate( path, ndata_enumerateCallback, &files );
    /* Ensure unique. PhysicsFS can enumerate a path twice if it's in multiple components of a union. */
    qsort( files, array_size(files), sizeof(char*), strsort );
@@ -255,7 +672,7 @@ static int ndata_enumerateCallback( void* data, const char* origdir, const char*
    PHYSFS_Stat stat;
 
    dir_len = strlen( origdir );
-   fmt = dir_len && origdir[dir_len-1]=='/' ? "%s%s" : "%s/%s";
+   fmt = (dir_len==0 || origdir[dir_len-1]=='/') ? "%s%s" : "%s/%s";
    asprintf( &path, fmt, origdir, fname );
    if (!PHYSFS_stat( path, &stat )) {
       WARN( _("PhysicsFS: Cannot stat %s: %s"), path,
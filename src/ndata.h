@@ -84,7 +84,12 @@
 
 void ndata_setupWriteDir (void);
 void ndata_setupReadDirs (void);
+void ndata_prefetchStart (void);
+void ndata_prefetchFinish (void);
+int ndata_exists( const char *path );
 void* ndata_read( const char* filename, size_t *filesize );
+void* ndata_map( const char* filename, size_t *filesize );
+void ndata_unmap( void* data );
 char** ndata_listRecursive( const char *path );
 int ndata_backupIfExists( const char *path );
 int ndata_copyIfExists( const char *path1, const char *path2 );
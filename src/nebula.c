@@ -42,6 +42,18 @@ static GLfloat nebu_render_w= 0.;
 static GLfloat nebu_render_h= 0.;
 static mat4 nebu_render_P;
 
+/*
+ * Automatic resolution ladder. When the measured frame time blows the
+ * budget in a nebula system the render target is halved a step at a
+ * time on top of conf.nebu_scale, and stepped back up once there's
+ * comfortable headroom again.
+ */
+#define NEBU_LOD_MAX       2  /**< Deepest step; each step halves the resolution. */
+#define NEBU_LOD_INTERVAL  2. /**< Seconds of frames to average per decision. */
+static int nebu_lod        = 0;  /**< Current step down the resolution ladder. */
+static double nebu_lod_dt  = 0.; /**< Frame time accumulated since the last decision. */
+static int nebu_lod_frames = 0;  /**< Frames accumulated since the last decision. */
+
 /**
  * @struct NebulaPuff
  *
@@ -67,6 +79,8 @@ static void nebu_renderPuffs( int below_player );
 /* Nebula render methods. */
 static void nebu_renderBackground( const double dt );
 static void nebu_blitFBO (void);
+static void nebu_brightnessUpdate (void);
+static void nebu_updateLOD (void);
 
 /**
  * @brief Initializes the nebula.
@@ -76,9 +90,25 @@ static void nebu_blitFBO (void);
 int nebu_init (void)
 {
    nebu_time = -1000.0 * RNGF();
+   conf_addChangeListener( nebu_brightnessUpdate );
+   nebu_brightnessUpdate();
    return nebu_resize();
 }
 
+/**
+ * @brief Programs the brightness uniforms; like the projection matrices they
+ *        persist in the programs, so this only runs when conf changes.
+ */
+static void nebu_brightnessUpdate (void)
+{
+   gl_useProgram(shaders.nebula_background.program);
+   glUniform1f(shaders.nebula_background.brightness, conf.nebu_brightness);
+   gl_useProgram(shaders.nebula.program);
+   glUniform1f(shaders.nebula.brightness, conf.nebu_brightness);
+   gl_useProgram(0);
+   gl_checkErr();
+}
+
 /**
  * @brief Handles a screen s
  *
@@ -89,7 +119,7 @@ int nebu_resize (void)
    double scale;
    GLfloat fbo_w, fbo_h;
 
-   scale = conf.nebu_scale * gl_screen.scale;
+   scale = conf.nebu_scale * gl_screen.scale * (double)(1<<nebu_lod);
    fbo_w = round(gl_screen.nw/scale);
    fbo_h = round(gl_screen.nh/scale);
    if (scale == nebu_scale && fbo_w == nebu_render_w && fbo_h == nebu_render_h)
@@ -109,11 +139,11 @@ int nebu_resize (void)
    nebu_render_P = mat4_identity();
    mat4_translate( &nebu_render_P, -nebu_render_w/2., -nebu_render_h/2., 0. );
    mat4_scale( &nebu_render_P, nebu_render_w, nebu_render_h, 1. );
-   glUseProgram(shaders.nebula_background.program);
+   gl_useProgram(shaders.nebula_background.program);
    gl_uniformMat4(shaders.nebula_background.projection, &nebu_render_P);
-   glUseProgram(shaders.nebula.program);
+   gl_useProgram(shaders.nebula.program);
    gl_uniformMat4(shaders.nebula.projection, &nebu_render_P);
-   glUseProgram(0);
+   gl_useProgram(0);
 
    return 0;
 }
@@ -166,12 +196,11 @@ static void nebu_renderBackground( const double dt )
    }
 
    /* Start the program. */
-   glUseProgram(shaders.nebula_background.program);
+   gl_useProgram(shaders.nebula_background.program);
 
    /* Set shader uniforms. */
    glUniform1f(shaders.nebula_background.eddy_scale, nebu_view * cam_getZoom() / nebu_scale);
    glUniform1f(shaders.nebula_background.time, nebu_time);
-   glUniform1f(shaders.nebula_background.brightness, conf.nebu_brightness);
 
    /* Draw. */
    glEnableVertexAttribArray( shaders.nebula_background.vertex );
@@ -181,7 +210,7 @@ static void nebu_renderBackground( const double dt )
 
    /* Clean up. */
    glDisableVertexAttribArray( shaders.nebula_background.vertex );
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 }
 
@@ -195,7 +224,7 @@ static void nebu_blitFBO (void)
 
    glBindFramebuffer(GL_FRAMEBUFFER, gl_screen.current_fbo);
 
-   glUseProgram(shaders.texture.program);
+   gl_useProgram(shaders.texture.program);
 
    glBindTexture( GL_TEXTURE_2D, nebu_tex );
 
@@ -263,6 +292,46 @@ void nebu_update( double dt )
    }
 }
 
+/**
+ * @brief Steps the resolution ladder from the measured frame time.
+ *
+ * Runs once per rendered frame in nebula systems. Decisions are taken
+ * over a couple of seconds of frames so a single hitch doesn't drop the
+ * quality, and the step-up threshold is well below the step-down one so
+ * the ladder doesn't oscillate at the boundary.
+ */
+static void nebu_updateLOD (void)
+{
+   double avg, budget;
+
+   if (!conf.nebu_autoscale) {
+      if (nebu_lod != 0) {
+         nebu_lod = 0;
+         nebu_resize();
+      }
+      return;
+   }
+
+   nebu_lod_dt += naev_getrealdt();
+   nebu_lod_frames++;
+   if (nebu_lod_dt < NEBU_LOD_INTERVAL)
+      return;
+
+   avg    = nebu_lod_dt / (double)nebu_lod_frames;
+   budget = (conf.fps_max > 0) ? 1./(double)conf.fps_max : 1./60.;
+   nebu_lod_dt     = 0.;
+   nebu_lod_frames = 0;
+
+   if ((avg > 1.2*budget) && (nebu_lod < NEBU_LOD_MAX)) {
+      nebu_lod++;
+      nebu_resize();
+   }
+   else if ((avg < 0.7*budget) && (nebu_lod > 0)) {
+      nebu_lod--;
+      nebu_resize();
+   }
+}
+
 /**
  * @brief Renders the nebula overlay (hides what player can't see).
  *
@@ -273,6 +342,9 @@ void nebu_renderOverlay( const double dt )
    (void) dt;
    double gx, gy, z;
 
+   /* Adjust the resolution ladder to the current frame time. */
+   nebu_updateLOD();
+
    /* Get GUI offsets. */
    gui_getOffset( &gx, &gy );
 
@@ -292,13 +364,12 @@ void nebu_renderOverlay( const double dt )
    }
 
    /* Start the program. */
-   glUseProgram(shaders.nebula.program);
+   gl_useProgram(shaders.nebula.program);
 
    /* Set shader uniforms. */
    glUniform1f(shaders.nebula.horizon, nebu_view * z / nebu_scale);
    glUniform1f(shaders.nebula.eddy_scale, nebu_dx * z / nebu_scale);
    glUniform1f(shaders.nebula.time, nebu_time);
-   glUniform1f(shaders.nebula.brightness, conf.nebu_brightness);
 
    /* Draw. */
    glEnableVertexAttribArray(shaders.nebula.vertex);
@@ -309,7 +380,7 @@ void nebu_renderOverlay( const double dt )
    /* Clean up. */
    glDisableVertexAttribArray( shaders.nebula.vertex );
    glClearColor( 0., 0., 0., 1. );
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 
    /* Reset puff movement. */
@@ -348,7 +419,7 @@ static void nebu_renderPuffs( int below_player )
          continue;
 
       /* Render */
-      glUseProgram( shaders.nebula_puff.program );
+      gl_useProgram( shaders.nebula_puff.program );
 
       projection = gl_view_matrix;
       mat4_translate( &projection, x, y, 0. );
@@ -364,7 +435,7 @@ static void nebu_renderPuffs( int below_player )
       glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
 
       glDisableVertexAttribArray(shaders.nebula_puff.vertex);
-      glUseProgram(0);
+      gl_useProgram(0);
       gl_checkErr();
    }
 }
@@ -382,24 +453,31 @@ void nebu_prep( double density, double volatility, double hue )
 
    /* Set the hue. */
    nebu_hue = hue;
-   glUseProgram(shaders.nebula.program);
+   gl_useProgram(shaders.nebula.program);
    glUniform1f(shaders.nebula.hue, nebu_hue);
-   glUseProgram(shaders.nebula_background.program);
+   gl_useProgram(shaders.nebula_background.program);
    glUniform1f(shaders.nebula_background.hue, nebu_hue);
    glUniform1f(shaders.nebula_background.volatility, volatility);
 
    /* Also set the hue for trails */
    col_hsv2rgb( &col, nebu_hue*360., 0.7, 1.0 );
-   glUseProgram(shaders.trail.program);
+   gl_useProgram(shaders.trail.program);
    glUniform3f( shaders.trail.nebu_col, col.r, col.g, col.b );
 
    /* Also set the hue for puffs. */
    col_hsv2rgb( &col, nebu_hue*360., 0.95, 1.0 );
-   glUseProgram(shaders.nebula_puff.program);
+   gl_useProgram(shaders.nebula_puff.program);
    glUniform3f( shaders.nebula_puff.nebu_col, col.r, col.g, col.b );
 
    /* Done setting shaders. */
-   glUseProgram(0);
+   gl_useProgram(0);
+
+   /* Start each system back at full quality; the ladder steps down again
+    * if this machine can't keep up. */
+   nebu_lod        = 0;
+   nebu_lod_dt     = 0.;
+   nebu_lod_frames = 0;
+   nebu_resize();
 
    /* Set density parameters. */
    nebu_density = density;
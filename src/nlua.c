@@ -9,6 +9,7 @@
 
 /** @cond */
 #include "physfs.h"
+#include "SDL.h"
 
 #include "naev.h"
 /** @endcond */
@@ -19,6 +20,7 @@
 #include "conf.h"
 #include "lutf8lib.h"
 #include "ndata.h"
+#include "md5.h"
 #include "nfile.h"
 #include "nlua_cli.h"
 #include "nlua_commodity.h"
@@ -148,6 +150,116 @@ static int nlua_log2( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Single-pass template interpolation backing the dat format library.
+ *
+ * Expands "{key}" and "{key:fmt}" placeholders from a table in one walk over
+ * the string, instead of gsub re-scanning with a Lua closure per match.
+ * Semantics match format.f: keys convertible to numbers index the table
+ * positionally, ":fmt" is applied as string.format('%'..fmt, val), and nil
+ * values emit a warning and expand to tostring(nil).
+ *
+ * @usage s = string.interp( _("Hail {plt} in {sys}"), {plt=p, sys=s} )
+ *    @luatparam string str Template with "{key}"/"{key:fmt}" placeholders.
+ *    @luatparam table tab Table to look the keys up in.
+ *    @luatreturn string The expanded string.
+ * @luafunc interp
+ */
+static int nlua_interp( lua_State *L )
+{
+   size_t len;
+   const char *str = luaL_checklstring( L, 1, &len );
+   luaL_Buffer b;
+   luaL_checktype( L, 2, LUA_TTABLE );
+   lua_settop( L, 2 );
+   luaL_buffinit( L, &b );
+
+   for (size_t i=0; i<len; i++) {
+      size_t j, end, colon;
+      int depth;
+
+      if (str[i] != '{') {
+         luaL_addchar( &b, str[i] );
+         continue;
+      }
+
+      /* Find the matching close brace; gsub used "%b{}" so unbalanced
+       * braces pass through verbatim. */
+      depth = 1;
+      end   = 0;
+      for (j=i+1; j<len; j++) {
+         if (str[j] == '{')
+            depth++;
+         else if (str[j] == '}') {
+            depth--;
+            if (depth == 0) {
+               end = j;
+               break;
+            }
+         }
+      }
+      if (end == 0) {
+         luaL_addchar( &b, '{' );
+         continue;
+      }
+
+      /* Split "key:fmt" on the last colon, as the greedy pattern did. */
+      colon = 0;
+      for (j=end-1; j>i; j--) {
+         if (str[j] == ':') {
+            colon = j;
+            break;
+         }
+      }
+
+      /* Key, converted to a number when possible ({1} indexes the table). */
+      lua_pushlstring( L, &str[i+1], ((colon > 0) ? colon : end)-i-1 ); /* k */
+      if (lua_isnumber( L, -1 )) {
+         lua_Number n = lua_tonumber( L, -1 );
+         lua_pop( L, 1 );           /* */
+         lua_pushnumber( L, n );    /* k */
+      }
+      lua_pushvalue( L, -1 );       /* k, k */
+      lua_gettable( L, 2 );         /* k, v */
+      if (lua_isnil( L, -1 )) {
+         lua_getglobal( L, "warn" );                                 /* k, v, w */
+         lua_getglobal( L, "string" );                               /* k, v, w, s */
+         lua_getfield( L, -1, "format" );                            /* k, v, w, s, f */
+         lua_remove( L, -2 );                                        /* k, v, w, f */
+         lua_pushstring( L, _("fmt.f: string '%s' has '%s'==nil!") );/* k, v, w, f, m */
+         lua_pushvalue( L, 1 );                                      /* k, v, w, f, m, str */
+         lua_pushvalue( L, -6 );                                     /* k, v, w, f, m, str, k */
+         lua_call( L, 3, 1 );                                        /* k, v, w, m */
+         lua_call( L, 1, 0 );                                        /* k, v */
+      }
+      lua_remove( L, -2 );          /* v */
+
+      if (colon > 0) {
+         /* string.format( '%'..fmt, v ) */
+         lua_getglobal( L, "string" );                   /* v, s */
+         lua_getfield( L, -1, "format" );                /* v, s, f */
+         lua_remove( L, -2 );                            /* v, f */
+         lua_insert( L, -2 );                            /* f, v */
+         lua_pushliteral( L, "%" );                      /* f, v, "%" */
+         lua_pushlstring( L, &str[colon+1], end-colon-1 ); /* f, v, "%", fmt */
+         lua_concat( L, 2 );                             /* f, v, fmtspec */
+         lua_insert( L, -2 );                            /* f, fmtspec, v */
+         lua_call( L, 2, 1 );                            /* r */
+      }
+      else {
+         lua_getglobal( L, "tostring" );                 /* v, t */
+         lua_insert( L, -2 );                            /* t, v */
+         lua_call( L, 1, 1 );                            /* r */
+      }
+      luaL_addvalue( &b );          /* */
+
+      i = end;
+   }
+
+   luaL_pushresult( &b );
+   return 1;
+}
+
 /**
  * @brief Implements the Lua function os.getenv. In the sandbox we only make a fake $HOME visible.
  */
@@ -184,6 +296,74 @@ void lua_init (void)
 
    /* Better clean up. */
    lua_atpanic( naevL, nlua_panic );
+
+#if HAVE_LUAJIT
+   /* In developer mode, report scripts that fall off the JIT fast path:
+    * every first trace abort per source location gets logged with the
+    * engine's reason, which is what you need to keep mission code
+    * compileable. Uses only the global jit table so it works inside the
+    * sandbox; the finer-grained jit.util info is attached when the
+    * module is available. */
+   if (conf.devmode) {
+      const char *buf =
+         "local seen = {}\n"
+         "local ok, jutil = pcall( require, 'jit.util' )\n"
+         "local okv, vmdef = pcall( require, 'jit.vmdef' )\n"
+         "jit.attach( function( what, tr, func, pc, otr, oex )\n"
+         "   if what ~= 'abort' then return end\n"
+         "   local loc = 'unknown location'\n"
+         "   if ok then\n"
+         "      local i = jutil.funcinfo( func, pc )\n"
+         "      loc = tostring(i.source)..':'..tostring(i.currentline)\n"
+         "   end\n"
+         "   if seen[loc] then return end\n"
+         "   seen[loc] = true\n"
+         "   local why = okv and vmdef.traceerr[oex] or tostring(oex)\n"
+         "   warn( 'JIT trace abort at '..loc..': '..tostring(why) )\n"
+         "end, 'trace' )\n";
+      if (luaL_dostring( naevL, buf ))
+         WARN( _("Failed to attach JIT trace reporter: %s"),
+               lua_tostring(naevL,-1) );
+   }
+#endif /* HAVE_LUAJIT */
+
+   /* The collector is driven manually from the main loop so collection
+    * work lands in frame slack instead of pausing mid-update. */
+   lua_gc( naevL, LUA_GCSTOP, 0 );
+}
+
+/**
+ * @brief Advances the garbage collector by a time budget.
+ *
+ * Meant to be called once per frame with the measured frame slack; a
+ * small minimum budget keeps the heap from running away when there is
+ * no slack at all. Note that in Lua 5.1 stepping restarts the automatic
+ * collector, so it is stopped again afterwards.
+ *
+ *    @param slack Seconds the frame has to spare.
+ *    @return Seconds actually spent collecting.
+ */
+double nlua_gcStep( double slack )
+{
+   Uint64 start;
+   double budget, spent;
+   const double freq = (double)SDL_GetPerformanceFrequency();
+
+   if (naevL == NULL)
+      return 0.;
+
+   /* Spend at most half the slack so hiccups in the estimate can't blow
+    * the frame budget on their own. */
+   budget = MAX( 100e-6, 0.5*slack );
+   start  = SDL_GetPerformanceCounter();
+   do {
+      if (lua_gc( naevL, LUA_GCSTEP, 5 )) /* Finished a full cycle. */
+         break;
+      spent = (double)(SDL_GetPerformanceCounter()-start) / freq;
+   } while (spent < budget);
+   lua_gc( naevL, LUA_GCSTOP, 0 );
+
+   return (double)(SDL_GetPerformanceCounter()-start) / freq;
 }
 
 /**
@@ -204,6 +384,85 @@ static int luaB_loadstring( lua_State *L )
    }
 }
 
+/**
+ * @brief Accumulator for lua_dump() output.
+ */
+typedef struct LuaDump_ {
+   char *buf;  /**< Dumped bytecode. */
+   size_t sz;  /**< Size of the dumped bytecode. */
+} LuaDump;
+
+/**
+ * @brief lua_Writer that appends chunks to a LuaDump.
+ */
+static int nlua_dumpWriter( lua_State *L, const void *p, size_t sz, void *ud )
+{
+   LuaDump *d = ud;
+   (void) L;
+   d->buf = realloc( d->buf, d->sz + sz );
+   memcpy( &d->buf[ d->sz ], p, sz );
+   d->sz += sz;
+   return 0;
+}
+
+/**
+ * @brief luaL_loadbuffer() with a persistent on-disk bytecode cache.
+ *
+ * Scripts are keyed by an md5 over the chunk name and contents, so any
+ * edit (or plugin override) recompiles. Cached bytecode lives under
+ * "luac/" in the cache path, like the collision maps in opengl_tex.c.
+ *
+ *    @param L Lua state to load the buffer into.
+ *    @param buff Pointer to the buffer.
+ *    @param sz Size of the buffer.
+ *    @param name Name to use in error messages.
+ *    @return 0 on success as per luaL_loadbuffer().
+ */
+int nlua_loadbuffer( lua_State *L, const char *buff, size_t sz, const char *name )
+{
+   md5_state_t md5;
+   md5_byte_t md5val[16];
+   char digest[33];
+   char cachefile[PATH_MAX];
+   int ret;
+
+   /* The chunk name is baked into the dumped debug info, so hash it too. */
+   md5_init( &md5 );
+   md5_append( &md5, (const md5_byte_t*)name, strlen(name) );
+   md5_append( &md5, (const md5_byte_t*)buff, sz );
+   md5_finish( &md5, md5val );
+   for (int i=0; i<16; i++)
+      snprintf( &digest[i*2], 3, "%02x", md5val[i] );
+   snprintf( cachefile, sizeof(cachefile), "%sluac/%s", nfile_cachePath(), digest );
+
+   /* Attempt to load cached bytecode. */
+   if (nfile_fileExists( cachefile )) {
+      size_t cachedsize;
+      char *cached = nfile_readFile( &cachedsize, cachefile );
+      if (cached != NULL) {
+         ret = luaL_loadbuffer( L, cached, cachedsize, name );
+         free( cached );
+         if (ret == 0)
+            return 0;
+         lua_pop( L, 1 ); /* Stale or corrupt entry; recompile below. */
+      }
+   }
+
+   /* Compile from source and stash the bytecode for next time. */
+   ret = luaL_loadbuffer( L, buff, sz, name );
+   if (ret == 0) {
+      LuaDump dump = { .buf = NULL, .sz = 0 };
+      if (lua_dump( L, nlua_dumpWriter, &dump ) == 0) {
+         char dirpath[PATH_MAX];
+         snprintf( dirpath, sizeof(dirpath), "%sluac/", nfile_cachePath() );
+         nfile_dirMakeExist( dirpath );
+         nfile_writeFile( dump.buf, dump.sz, cachefile );
+      }
+      free( dump.buf );
+   }
+   return ret;
+}
+
 /*
  * @brief Closes the global Lua state.
  */
@@ -226,7 +485,7 @@ int nlua_dobufenv( nlua_env env,
                    const char *buff,
                    size_t sz,
                    const char *name) {
-   if (luaL_loadbuffer(naevL, buff, sz, name) != 0)
+   if (nlua_loadbuffer(naevL, buff, sz, name) != 0)
       return -1;
    nlua_pushenv(naevL, env);
    lua_setfenv(naevL, -2);
@@ -320,7 +579,7 @@ nlua_env nlua_newEnv (void)
          WARN(_("Unable to load common script '%s'!"), LUA_COMMON_PATH);
    }
    if (common_script != NULL) {
-      if (luaL_loadbuffer(naevL, common_script, common_sz, LUA_COMMON_PATH) == 0) {
+      if (nlua_loadbuffer(naevL, common_script, common_sz, LUA_COMMON_PATH) == 0) {
          if (nlua_pcall( ref, 0, 0 ) != 0) {
             WARN(_("Failed to run '%s':\n%s"), LUA_COMMON_PATH, lua_tostring(naevL,-1));
             lua_pop(naevL, 1);
@@ -498,6 +757,12 @@ static int nlua_loadBasic( lua_State* L )
    lua_setfield(L,-2,"mod"); /* Get rid of math.mod */
    lua_pop(L,1);
 
+   /* Accelerated template interpolation used by the format library. */
+   lua_getglobal(L,"string");
+   lua_pushcfunction(L, nlua_interp);
+   lua_setfield(L,-2,"interp");
+   lua_pop(L,1);
+
    return 0;
 }
 
@@ -559,7 +824,7 @@ static int nlua_package_loader_lua( lua_State* L )
             path_filename[i] = '/';
 
       /* Try to load the file. */
-      if (PHYSFS_exists( path_filename )) {
+      if (ndata_exists( path_filename )) {
          buf = ndata_read( path_filename, &bufsize );
          if (buf != NULL)
             break;
@@ -576,7 +841,7 @@ static int nlua_package_loader_lua( lua_State* L )
    }
 
    /* Try to process the Lua. It will leave a function or message on the stack, as required. */
-   luaL_loadbuffer(L, buf, bufsize, path_filename);
+   nlua_loadbuffer(L, buf, bufsize, path_filename);
    free(buf);
    return 1;
 }
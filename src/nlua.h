@@ -24,6 +24,7 @@ extern nlua_env __NLUA_CURENV;
  */
 void lua_init (void);
 void lua_exit (void);
+double nlua_gcStep( double slack );
 nlua_env nlua_newEnv (void);
 void nlua_freeEnv(nlua_env env);
 void nlua_pushenv(lua_State* L, nlua_env env);
@@ -31,6 +32,7 @@ void nlua_setenv(lua_State* L, nlua_env env, const char *name);
 void nlua_getenv(lua_State* L, nlua_env env, const char *name);
 void nlua_register(nlua_env env, const char *libname,
                    const luaL_Reg *l, int metatable);
+int nlua_loadbuffer( lua_State *L, const char *buff, size_t sz, const char *name );
 int nlua_dobufenv(nlua_env env,
                   const char *buff,
                   size_t sz,
@@ -124,6 +124,35 @@ static const luaL_Reg audioL_methods[] = {
 static int stream_thread( void *la_data )
 {
    LuaAudio_t *la = (LuaAudio_t*) la_data;
+   ALint alqueued;
+   int pret;
+
+   /* Prime the queue and start the source from here rather than from
+    * audioL_play, so a slow disk open or seek during a track change can
+    * never stall the main loop. */
+   soundLock();
+   pret = 0;
+   alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alqueued );
+   while ((alqueued < 2) && (la->active >= 0)) {
+      pret = stream_loadBuffer( la, la->stream_buffers[ la->active ] );
+      /* stream_loadBuffer unlocks internally, so the audio may have been
+       * gc'd meanwhile; do not touch the buffers if so. */
+      if ((pret < 0) || (la->active < 0))
+         break;
+      alSourceQueueBuffers( la->source, 1, &la->stream_buffers[ la->active ] );
+      la->active = 1-la->active;
+      alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alqueued );
+   }
+   if ((pret < 0) || (la->active < 0)) {
+      la->th = NULL;
+      SDL_CondBroadcast( la->cond );
+      alSourceStop( la->source );
+      soundUnlock();
+      return 0;
+   }
+   alSourcePlay( la->source );
+   al_checkErr();
+   soundUnlock();
 
    while (1) {
       ALint alstate;
@@ -664,26 +693,20 @@ static int audioL_play( lua_State *L )
       return 0;
 
    if ((la->type == LUA_AUDIO_STREAM) && (la->th == NULL)) {
-      int ret = 0;
-      ALint alstate;
+      /* The streaming thread does the priming decode and starts the
+       * source itself; holding the lock across the creation orders the
+       * handle assignment before the thread's first access. */
       soundLock();
-      alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
-      while (alstate < 2) {
-         ret = stream_loadBuffer( la, la->stream_buffers[ la->active ] );
-         if (ret < 0)
-            break;
-         alSourceQueueBuffers( la->source, 1, &la->stream_buffers[ la->active ] );
-         la->active = 1-la->active;
-         alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
-      }
-      if (ret == 0)
-         la->th = SDL_CreateThread( stream_thread, "stream_thread", la );
+      la->th = SDL_CreateThread( stream_thread, "stream_thread", la );
+      al_checkErr();
+      soundUnlock();
    }
-   else
+   else {
       soundLock();
-   alSourcePlay( la->source );
-   al_checkErr();
-   soundUnlock();
+      alSourcePlay( la->source );
+      al_checkErr();
+      soundUnlock();
+   }
 
    lua_pushboolean(L,1);
    return 1;
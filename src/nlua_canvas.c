@@ -248,7 +248,7 @@ static int canvasL_set( lua_State *L )
       previous_fbo_set = 0;
       if (was_scissored)
          glEnable(GL_SCISSOR_TEST);
-      glViewport( 0, 0, gl_screen.rw, gl_screen.rh );
+      glViewport( 0, 0, gl_screen.cvw, gl_screen.cvh );
       glBindFramebuffer(GL_FRAMEBUFFER, gl_screen.current_fbo);
    }
    else
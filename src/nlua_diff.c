@@ -27,10 +27,12 @@
 static int diffL_apply( lua_State *L );
 static int diffL_remove( lua_State *L );
 static int diffL_isapplied( lua_State *L );
+static int diffL_transaction( lua_State *L );
 static const luaL_Reg diffL_methods[] = {
    { "apply", diffL_apply },
    { "remove", diffL_remove },
    { "isApplied", diffL_isapplied },
+   { "transaction", diffL_transaction },
    {0,0}
 }; /**< Unidiff Lua methods. */
 
@@ -101,3 +103,33 @@ static int diffL_isapplied( lua_State *L )
    lua_pushboolean(L,diff_isApplied(name));
    return 1;
 }
+
+/**
+ * @brief Applies a batch of diff changes with a single universe rebuild.
+ *
+ * Each diff.apply and diff.remove normally triggers presence, safe lane
+ * and economy recomputation on its own. Inside a transaction those
+ * rebuilds are deferred and run once when the function returns, so
+ * applying many diffs (e.g. at plugin load) pays the cost a single time.
+ *
+ * @usage diff.transaction( function () for k,v in ipairs(mydiffs) do diff.apply(v) end end )
+ *
+ *    @luatparam function func Function that applies or removes the diffs.
+ * @luafunc transaction
+ */
+static int diffL_transaction( lua_State *L )
+{
+   int ret;
+   int defer = unidiff_universeDeferred();
+
+   luaL_checktype( L, 1, LUA_TFUNCTION );
+   unidiff_universeDefer( 1 );
+   lua_pushvalue( L, 1 );
+   ret = lua_pcall( L, 0, 0, 0 );
+   /* Restoring the old state runs the consolidated rebuild when this is
+    * the outermost transaction, even if the function errored. */
+   unidiff_universeDefer( defer );
+   if (ret != 0)
+      return lua_error( L );
+   return 0;
+}
@@ -190,13 +190,14 @@ static int evtL_npcAdd( lua_State *L )
    /* Handle parameters. */
    func = luaL_checkstring(L, 1);
    name = luaL_checkstring(L, 2);
-   portrait = luaL_validtex(L, 3, GFX_PATH"portraits/");
+   /* Portraits decode in the background; see gl_texAsyncPump(). */
+   portrait = luaL_validtexFlags(L, 3, GFX_PATH"portraits/", OPENGL_TEX_ASYNC);
    desc = luaL_checkstring(L, 4);
 
    /* Optional parameters. */
    priority = luaL_optinteger(L,5,5);
    if (!lua_isnoneornil(L,6))
-      bg = luaL_validtex(L,6,GFX_PATH"portraits/");
+      bg = luaL_validtexFlags(L,6,GFX_PATH"portraits/", OPENGL_TEX_ASYNC);
    else
       bg = NULL;
 
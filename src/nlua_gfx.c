@@ -380,7 +380,7 @@ static int gfxL_renderTexH( lua_State *L )
    col   = luaL_optcolour(L,4,&cWhite);
    TH    = luaL_opttransform( L,5,&ID );
 
-   glUseProgram( shader->program );
+   gl_useProgram( shader->program );
 
    /* Set the vertex. */
    glEnableVertexAttribArray( shader->VertexPosition );
@@ -421,7 +421,7 @@ static int gfxL_renderTexH( lua_State *L )
    /* anything failed? */
    gl_checkErr();
 
-   glUseProgram(0);
+   gl_useProgram(0);
 
    return 0;
 }
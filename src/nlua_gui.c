@@ -21,8 +21,38 @@
 #include "log.h"
 #include "menu.h"
 #include "map_overlay.h"
+#include "array.h"
+#include "nlua_col.h"
 #include "nlua_tex.h"
 #include "nluadef.h"
+#include "opengl.h"
+
+/**
+ * @brief Types of retained HUD draw commands.
+ */
+typedef enum GuiBatchType_ {
+   GUI_BATCH_TEX,    /**< Static sprite. */
+   GUI_BATCH_RECT,   /**< Rectangle, e.g. a bar fill or frame. */
+   GUI_BATCH_CIRCLE  /**< Circle. */
+} GuiBatchType;
+
+/**
+ * @brief A single retained HUD draw command.
+ */
+typedef struct GuiBatchCmd_ {
+   GuiBatchType type;/**< What to draw. */
+   glTexture *tex;   /**< Owned texture reference (GUI_BATCH_TEX only). */
+   double x;         /**< X position. */
+   double y;         /**< Y position. */
+   double w;         /**< Width, or radius for circles. */
+   double h;         /**< Height. */
+   int sx;           /**< X sprite (GUI_BATCH_TEX only). */
+   int sy;           /**< Y sprite (GUI_BATCH_TEX only). */
+   glColour col;     /**< Colour to draw with. */
+   int empty;        /**< Whether rectangles/circles are outlines only. */
+} GuiBatchCmd;
+
+static GuiBatchCmd *gui_batch = NULL; /**< Retained HUD draw commands. */
 
 /* GUI methods. */
 static int guiL_viewport( lua_State *L );
@@ -39,6 +69,15 @@ static int guiL_mouseMoveEnable( lua_State *L );
 static int guiL_menuInfo( lua_State *L );
 static int guiL_menuSmall( lua_State *L );
 static int guiL_setMapOverlayBounds( lua_State *L );
+static int guiL_batchClear( lua_State *L );
+static int guiL_batchTex( lua_State *L );
+static int guiL_batchRect( lua_State *L );
+static int guiL_batchCircle( lua_State *L );
+static int guiL_batchMove( lua_State *L );
+static int guiL_batchDim( lua_State *L );
+static int guiL_batchCol( lua_State *L );
+static int guiL_batchRender( lua_State *L );
+static GuiBatchCmd *gui_batchGet( lua_State *L, int idx );
 static const luaL_Reg guiL_methods[] = {
    { "viewport", guiL_viewport },
    { "fpsPos", guiL_fpsPos },
@@ -54,6 +93,14 @@ static const luaL_Reg guiL_methods[] = {
    { "menuInfo", guiL_menuInfo },
    { "menuSmall", guiL_menuSmall },
    { "setMapOverlayBounds", guiL_setMapOverlayBounds },
+   { "batchClear", guiL_batchClear },
+   { "batchTex", guiL_batchTex },
+   { "batchRect", guiL_batchRect },
+   { "batchCircle", guiL_batchCircle },
+   { "batchMove", guiL_batchMove },
+   { "batchDim", guiL_batchDim },
+   { "batchCol", guiL_batchCol },
+   { "batchRender", guiL_batchRender },
    {0,0}
 }; /**< GUI methods. */
 
@@ -398,3 +445,233 @@ static int guiL_setMapOverlayBounds( lua_State *L )
    ovr_boundsSet( top, right, bottom, left );
    return 0;
 }
+
+/**
+ * @brief Frees the retained HUD draw commands.
+ *
+ * Called when the GUI gets unloaded; themes call gui.batchClear() themselves
+ *  when rebuilding their layout.
+ */
+void gui_batchCleanup (void)
+{
+   for (int i=0; i<array_size(gui_batch); i++)
+      gl_freeTexture( gui_batch[i].tex );
+   array_free( gui_batch );
+   gui_batch = NULL;
+}
+
+/**
+ * @brief Appends a command to the batch, creating it as necessary.
+ */
+static GuiBatchCmd *gui_batchAdd (void)
+{
+   if (gui_batch == NULL)
+      gui_batch = array_create( GuiBatchCmd );
+   return &array_grow( &gui_batch );
+}
+
+/**
+ * @brief Gets a batch command from a 1-based Lua index.
+ */
+static GuiBatchCmd *gui_batchGet( lua_State *L, int idx )
+{
+   int i = luaL_checkinteger( L, idx ) - 1;
+   if ((i < 0) || (i >= array_size(gui_batch))) {
+      NLUA_ERROR( L, _("Batch command %d does not exist."), i+1 );
+      return NULL;
+   }
+   return &gui_batch[i];
+}
+
+/**
+ * @brief Clears all retained batch draw commands.
+ *
+ * @usage gui.batchClear() -- Start declaring the layout from scratch.
+ * @luafunc batchClear
+ */
+static int guiL_batchClear( lua_State *L )
+{
+   (void) L;
+   gui_batchCleanup();
+   return 0;
+}
+
+/**
+ * @brief Adds a texture to the batch.
+ *
+ * The batch holds its own reference, so the theme does not have to keep the
+ *  texture alive.
+ *
+ * @usage id = gui.batchTex( tex, 20, 20 ) -- Declare a static HUD frame once
+ *
+ *    @luatparam Tex tex Texture to draw.
+ *    @luatparam number x X position to draw at.
+ *    @luatparam number y Y position to draw at.
+ *    @luatparam[opt=1] int sprite_x X sprite to draw.
+ *    @luatparam[opt=1] int sprite_y Y sprite to draw.
+ *    @luatparam[opt=white] Colour colour Colour to draw with.
+ *    @luatreturn number Identifier of the command for later updates.
+ * @luafunc batchTex
+ */
+static int guiL_batchTex( lua_State *L )
+{
+   GuiBatchCmd *cmd;
+   glTexture *tex = luaL_checktex( L, 1 );
+
+   cmd       = gui_batchAdd();
+   cmd->type = GUI_BATCH_TEX;
+   cmd->tex  = gl_dupTexture( tex );
+   cmd->x    = luaL_checknumber( L, 2 );
+   cmd->y    = luaL_checknumber( L, 3 );
+   cmd->sx   = luaL_optinteger( L, 4, 1 ) - 1;
+   cmd->sy   = luaL_optinteger( L, 5, 1 ) - 1;
+   cmd->col  = *luaL_optcolour( L, 6, &cWhite );
+   cmd->empty= 0;
+
+   lua_pushinteger( L, array_size(gui_batch) );
+   return 1;
+}
+
+/**
+ * @brief Adds a rectangle to the batch.
+ *
+ * @usage id = gui.batchRect( 30, 30, 100, 10, col ) -- A bar; resize the fill with gui.batchDim
+ *
+ *    @luatparam number x X position to draw at.
+ *    @luatparam number y Y position to draw at.
+ *    @luatparam number w Width of the rectangle.
+ *    @luatparam number h Height of the rectangle.
+ *    @luatparam Colour col Colour to draw with.
+ *    @luatparam[opt=false] boolean empty Whether or not it should be an outline.
+ *    @luatreturn number Identifier of the command for later updates.
+ * @luafunc batchRect
+ */
+static int guiL_batchRect( lua_State *L )
+{
+   GuiBatchCmd *cmd;
+
+   cmd       = gui_batchAdd();
+   cmd->type = GUI_BATCH_RECT;
+   cmd->tex  = NULL;
+   cmd->x    = luaL_checknumber( L, 1 );
+   cmd->y    = luaL_checknumber( L, 2 );
+   cmd->w    = luaL_checknumber( L, 3 );
+   cmd->h    = luaL_checknumber( L, 4 );
+   cmd->col  = *luaL_checkcolour( L, 5 );
+   cmd->empty= lua_toboolean( L, 6 );
+
+   lua_pushinteger( L, array_size(gui_batch) );
+   return 1;
+}
+
+/**
+ * @brief Adds a circle to the batch.
+ *
+ *    @luatparam number x X position to draw at.
+ *    @luatparam number y Y position to draw at.
+ *    @luatparam number r Radius of the circle.
+ *    @luatparam Colour col Colour to draw with.
+ *    @luatparam[opt=false] boolean empty Whether or not it should be an outline.
+ *    @luatreturn number Identifier of the command for later updates.
+ * @luafunc batchCircle
+ */
+static int guiL_batchCircle( lua_State *L )
+{
+   GuiBatchCmd *cmd;
+
+   cmd       = gui_batchAdd();
+   cmd->type = GUI_BATCH_CIRCLE;
+   cmd->tex  = NULL;
+   cmd->x    = luaL_checknumber( L, 1 );
+   cmd->y    = luaL_checknumber( L, 2 );
+   cmd->w    = luaL_checknumber( L, 3 );
+   cmd->h    = 0.;
+   cmd->col  = *luaL_checkcolour( L, 4 );
+   cmd->empty= lua_toboolean( L, 5 );
+
+   lua_pushinteger( L, array_size(gui_batch) );
+   return 1;
+}
+
+/**
+ * @brief Moves a batch command.
+ *
+ *    @luatparam number id Identifier returned when the command was added.
+ *    @luatparam number x New X position.
+ *    @luatparam number y New Y position.
+ * @luafunc batchMove
+ */
+static int guiL_batchMove( lua_State *L )
+{
+   GuiBatchCmd *cmd = gui_batchGet( L, 1 );
+   cmd->x = luaL_checknumber( L, 2 );
+   cmd->y = luaL_checknumber( L, 3 );
+   return 0;
+}
+
+/**
+ * @brief Resizes a batch command, e.g. a bar fill each frame.
+ *
+ * For circles the width is the radius and the height is ignored.
+ *
+ *    @luatparam number id Identifier returned when the command was added.
+ *    @luatparam number w New width.
+ *    @luatparam[opt] number h New height.
+ * @luafunc batchDim
+ */
+static int guiL_batchDim( lua_State *L )
+{
+   GuiBatchCmd *cmd = gui_batchGet( L, 1 );
+   cmd->w = luaL_checknumber( L, 2 );
+   cmd->h = luaL_optnumber( L, 3, cmd->h );
+   return 0;
+}
+
+/**
+ * @brief Changes the colour of a batch command.
+ *
+ *    @luatparam number id Identifier returned when the command was added.
+ *    @luatparam Colour col New colour.
+ * @luafunc batchCol
+ */
+static int guiL_batchCol( lua_State *L )
+{
+   GuiBatchCmd *cmd = gui_batchGet( L, 1 );
+   cmd->col = *luaL_checkcolour( L, 2 );
+   return 0;
+}
+
+/**
+ * @brief Draws all the retained batch commands in declaration order.
+ *
+ * A theme that declares its static geometry once and only updates dynamic
+ *  values does a single Lua call per frame here instead of one per element.
+ *
+ * @usage gui.batchRender() -- In the render() hook
+ * @luafunc batchRender
+ */
+static int guiL_batchRender( lua_State *L )
+{
+   (void) L;
+   for (int i=0; i<array_size(gui_batch); i++) {
+      const GuiBatchCmd *cmd = &gui_batch[i];
+      switch (cmd->type) {
+         case GUI_BATCH_TEX:
+            gl_renderStaticSprite( cmd->tex, cmd->x, cmd->y,
+                  cmd->sx, cmd->sy, &cmd->col );
+            break;
+
+         case GUI_BATCH_RECT:
+            if (cmd->empty)
+               gl_renderRectEmpty( cmd->x, cmd->y, cmd->w, cmd->h, &cmd->col );
+            else
+               gl_renderRect( cmd->x, cmd->y, cmd->w, cmd->h, &cmd->col );
+            break;
+
+         case GUI_BATCH_CIRCLE:
+            gl_renderCircle( cmd->x, cmd->y, cmd->w, &cmd->col, !cmd->empty );
+            break;
+      }
+   }
+   return 0;
+}
@@ -9,3 +9,8 @@
  * Library loading
  */
 int nlua_loadGUI( nlua_env env );
+
+/*
+ * Retained HUD draw batch.
+ */
+void gui_batchCleanup (void);
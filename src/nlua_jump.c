@@ -19,6 +19,7 @@
 #include "nlua_system.h"
 #include "land_outfits.h"
 #include "log.h"
+#include "space.h"
 
 RETURNS_NONNULL static JumpPoint *luaL_validjumpSystem( lua_State *L, int ind, int *offset );
 
@@ -421,8 +422,10 @@ static int jumpL_setKnown( lua_State *L )
       jp_rmFlag( jp, JP_KNOWN );
 
    /* Update outfits image array - in the case it changes map owned status. */
-   if (changed)
+   if (changed) {
+      space_knownInvalidate();
       outfits_updateEquipmentOutfits();
+   }
 
    return 0;
 }
@@ -531,7 +531,8 @@ static int misn_setNPC( lua_State *L )
 
    /* Get parameters. */
    name = luaL_checkstring(L,1);
-   cur_mission->portrait = luaL_validtex(L,2,GFX_PATH"portraits/");
+   cur_mission->portrait = luaL_validtexFlags(L,2,GFX_PATH"portraits/",
+         OPENGL_TEX_ASYNC);
    desc = luaL_checkstring(L,3);
 
    /* Set NPC name and description. */
@@ -909,13 +910,15 @@ static int misn_npcAdd( lua_State *L )
    /* Handle parameters. */
    func = luaL_checkstring(L, 1);
    name = luaL_checkstring(L, 2);
-   portrait = luaL_validtex( L, 3, GFX_PATH"portraits/" );
+   /* Portraits decode in the background so landing with many bar NPCs
+    * doesn't stall on image loads; see gl_texAsyncPump(). */
+   portrait = luaL_validtexFlags( L, 3, GFX_PATH"portraits/", OPENGL_TEX_ASYNC );
    desc = luaL_checkstring(L, 4);
 
    /* Optional parameters. */
    priority = luaL_optinteger(L,5,5);
    if (!lua_isnoneornil(L,6))
-      bg = luaL_validtex( L, 6, GFX_PATH"portraits/" );
+      bg = luaL_validtexFlags( L, 6, GFX_PATH"portraits/", OPENGL_TEX_ASYNC );
    else
       bg = NULL;
 
@@ -15,6 +15,8 @@
 #include "nlua_naev.h"
 
 #include "array.h"
+#include "claim.h"
+#include "conf.h"
 #include "console.h"
 #include "hook.h"
 #include "input.h"
@@ -27,6 +29,7 @@
 #include "nstring.h"
 #include "player.h"
 #include "plugin.h"
+#include "profiler.h"
 #include "semver.h"
 
 static int cache_table = LUA_NOREF; /* No reference. */
@@ -55,6 +58,7 @@ static int naevL_cache( lua_State *L );
 static int naevL_trigger( lua_State *L );
 static int naevL_claimTest( lua_State *L );
 static int naevL_plugins( lua_State *L );
+static int naevL_profileDump( lua_State *L );
 static const luaL_Reg naev_methods[] = {
    { "version", naevL_version },
    { "versionTest", naevL_versionTest },
@@ -79,6 +83,7 @@ static const luaL_Reg naev_methods[] = {
    { "trigger", naevL_trigger },
    { "claimTest", naevL_claimTest },
    { "plugins", naevL_plugins },
+   { "profileDump", naevL_profileDump },
    {0,0}
 }; /**< Naev Lua methods. */
 
@@ -375,6 +380,8 @@ static int naevL_shadersReload( lua_State *L )
    (void) L;
    shaders_unload();
    shaders_load();
+   /* The fresh programs lost their conf-derived uniform state. */
+   conf_notifyChange();
    return 0;
 }
 
@@ -557,7 +564,20 @@ static int naevL_trigger( lua_State *L )
 static int naevL_claimTest( lua_State *L )
 {
    int inclusive = lua_toboolean(L,2);
-   Claim_t *claim = claim_create( !inclusive );
+   Claim_t *claim;
+
+   /* Single system or string: test directly, skipping the claim object.
+    * This is the common case of the mission computer evaluation sweep. */
+   if (lua_issystem(L, 1)) {
+      lua_pushboolean( L, !claim_testOneSys( lua_tosystem( L, 1 ), !inclusive ) );
+      return 1;
+   }
+   else if (lua_isstring(L, 1)) {
+      lua_pushboolean( L, !claim_testOneStr( lua_tostring( L, 1 ) ) );
+      return 1;
+   }
+
+   claim = claim_create( !inclusive );
 
    if (lua_istable(L,1)) {
       /* Iterate over table. */
@@ -627,3 +647,21 @@ static int naevL_plugins( lua_State *L )
    }
    return 1;
 }
+
+/**
+ * @brief Writes the profiler report to the write directory as JSON.
+ *
+ * Only does something when the game was started with profiling enabled
+ * (see the "profiler" conf option).
+ *
+ * @usage naev.profileDump()
+ * @luafunc profileDump
+ */
+static int naevL_profileDump( lua_State *L )
+{
+   (void) L;
+   if (!conf.profiler)
+      NLUA_ERROR( L, _("Profiling is not enabled; start with the 'profiler' conf option set.") );
+   prof_dumpJSON();
+   return 0;
+}
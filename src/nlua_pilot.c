@@ -67,6 +67,8 @@ static int pilotL_clear( lua_State *L );
 static int pilotL_clearSelect( lua_State *L );
 static int pilotL_toggleSpawn( lua_State *L );
 static int pilotL_getPilots( lua_State *L );
+static int pilotL_iterator( lua_State *L );
+static int pilotL_iteratorNext( lua_State *L );
 static int pilotL_getAllies( lua_State *L );
 static int pilotL_getHostiles( lua_State *L );
 static int pilotL_getVisible( lua_State *L );
@@ -133,6 +135,7 @@ static int pilotL_outfitAdd( lua_State *L );
 static int pilotL_outfitRm( lua_State *L );
 static int pilotL_outfitSlot( lua_State *L );
 static int pilotL_outfitAddSlot( lua_State *L );
+static int pilotL_outfitBatch( lua_State *L );
 static int pilotL_outfitRmSlot( lua_State *L );
 static int pilotL_outfitAddIntrinsic( lua_State *L );
 static int pilotL_outfitRmIntrinsic( lua_State *L );
@@ -215,6 +218,7 @@ static const luaL_Reg pilotL_methods[] = {
    { "clone", pilotL_clone },
    { "rm", pilotL_remove },
    { "get", pilotL_getPilots },
+   { "iterator", pilotL_iterator },
    { "getAllies", pilotL_getAllies },
    { "getHostiles", pilotL_getHostiles },
    { "getVisible", pilotL_getVisible },
@@ -306,6 +310,7 @@ static const luaL_Reg pilotL_methods[] = {
    { "outfitRm", pilotL_outfitRm },
    { "outfitSlot", pilotL_outfitSlot },
    { "outfitAddSlot", pilotL_outfitAddSlot },
+   { "outfitBatch", pilotL_outfitBatch },
    { "outfitRmSlot", pilotL_outfitRmSlot },
    { "outfitAddIntrinsic", pilotL_outfitAddIntrinsic },
    { "outfitRmIntrinsic", pilotL_outfitRmIntrinsic },
@@ -467,19 +472,50 @@ Pilot* luaL_validpilot( lua_State *L, int ind )
 
    return p;
 }
+static int pilot_cache_ref = LUA_NOREF; /**< Weak-valued id->userdata cache for lua_pushpilot. */
 /**
  * @brief Pushes a pilot on the stack.
  *
+ * Userdata are cached in a weak-valued table keyed by id, so scripts that
+ * poll pilots every frame reuse the same userdata instead of allocating a
+ * fresh one per push.
+ *
  *    @param L Lua state to push pilot into.
  *    @param pilot Pilot to push.
  *    @return Newly pushed pilot.
  */
 LuaPilot* lua_pushpilot( lua_State *L, LuaPilot pilot )
 {
-   LuaPilot *p = (LuaPilot*) lua_newuserdata(L, sizeof(LuaPilot));
+   LuaPilot *p;
+
+   /* Create the cache table on first use. */
+   if (pilot_cache_ref == LUA_NOREF) {
+      lua_newtable(L);                 /* t */
+      lua_newtable(L);                 /* t, mt */
+      lua_pushstring(L, "v");          /* t, mt, str */
+      lua_setfield(L, -2, "__mode");   /* t, mt */
+      lua_setmetatable(L, -2);         /* t */
+      pilot_cache_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+   }
+
+   lua_rawgeti(L, LUA_REGISTRYINDEX, pilot_cache_ref); /* t */
+   lua_pushnumber(L, pilot);           /* t, id */
+   lua_rawget(L, -2);                  /* t, ud? */
+   if (lua_isuserdata(L, -1)) {
+      p = (LuaPilot*) lua_touserdata(L, -1);
+      lua_remove(L, -2);               /* ud */
+      return p;
+   }
+   lua_pop(L, 1);                      /* t */
+
+   p = (LuaPilot*) lua_newuserdata(L, sizeof(LuaPilot));
    *p = pilot;
    luaL_getmetatable(L, PILOT_METATABLE);
-   lua_setmetatable(L, -2);
+   lua_setmetatable(L, -2);            /* t, ud */
+   lua_pushnumber(L, pilot);           /* t, ud, id */
+   lua_pushvalue(L, -2);               /* t, ud, id, ud */
+   lua_rawset(L, -4);                  /* t, ud */
+   lua_remove(L, -2);                  /* ud */
    return p;
 }
 /**
@@ -910,18 +946,132 @@ static int pilotL_getPilots( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Closure yielding the next pilot for pilot.iterator().
+ *
+ * Iteration is keyed on the monotonically increasing pilot ids, so pilots
+ * spawning or dying mid-iteration just resynchronize the cached stack index
+ * instead of invalidating the iterator.
+ */
+static int pilotL_iteratorNext( lua_State *L )
+{
+   Pilot *const* pilot_stack = pilot_getAll();
+   unsigned int last = (unsigned int) lua_tonumber(L, lua_upvalueindex(1));
+   int i             = lua_tointeger(L, lua_upvalueindex(2));
+   int d             = lua_toboolean(L, lua_upvalueindex(3));
+   const int *factions = (const int*) lua_touserdata(L, lua_upvalueindex(4));
+   int n             = array_size(pilot_stack);
+
+   /* Resynchronize the index hint in case the stack changed under us. */
+   if (i > n)
+      i = n;
+   while ((i > 0) && (pilot_stack[i-1]->id > last))
+      i--;
+   while ((i < n) && (pilot_stack[i]->id <= last))
+      i++;
+
+   for (; i<n; i++) {
+      Pilot *p = pilot_stack[i];
+      if (pilot_isFlag(p, PILOT_DELETE))
+         continue;
+      if (!d && pilot_isDisabled(p))
+         continue;
+      if (factions != NULL) {
+         int match = 0;
+         for (int j=1; j<=factions[0]; j++)
+            if (p->faction == factions[j]) {
+               match = 1;
+               break;
+            }
+         if (!match)
+            continue;
+      }
+
+      /* Remember where we are and yield the pilot. */
+      lua_pushnumber(L, p->id);
+      lua_replace(L, lua_upvalueindex(1));
+      lua_pushinteger(L, i+1);
+      lua_replace(L, lua_upvalueindex(2));
+      lua_pushpilot(L, p->id);
+      return 1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Iterates over the pilots in the system without building a table.
+ *
+ * Takes the same filters as pilot.get(), but returns an iterator instead of
+ * allocating a result table, so per-frame polling generates no garbage. The
+ * iterator stays valid across pilot spawns and deaths.
+ *
+ * @usage for p in pilot.iterator() do p:rename("Dummy") end -- Iterates over all pilots
+ * @usage for p in pilot.iterator( { faction.get("Empire") } ) do ... end -- Only Empire pilots
+ *
+ *    @luatparam Faction|{Faction,...} factions Faction or table of factions to filter by, or nil for all pilots.
+ *    @luatparam boolean disabled Whether or not to get disabled ships (default is off if parameter is omitted).
+ *    @luatreturn function An iterator usable in a for-in loop.
+ * @luafunc iterator
+ */
+static int pilotL_iterator( lua_State *L )
+{
+   int d = lua_toboolean(L,2); /* Whether or not to get disabled. */
+
+   lua_pushnumber(L, 0.);  /* Id of the last yielded pilot. */
+   lua_pushinteger(L, 0);  /* Stack index hint. */
+   lua_pushboolean(L, d);
+
+   /* Bake the faction filter into a userdata so checks are table-free;
+    * slot 0 holds the count. */
+   if (lua_istable(L,1) || lua_isfaction(L,1)) {
+      int *factions;
+      if (lua_isfaction(L,1)) {
+         factions = (int*) lua_newuserdata(L, 2*sizeof(int) );
+         factions[0] = 1;
+         factions[1] = lua_tofaction(L,1);
+      }
+      else {
+         int k = 0;
+         /* Count the entries before allocating. */
+         lua_pushnil(L);
+         while (lua_next(L, 1) != 0) {
+            if (lua_isfaction(L,-1))
+               k++;
+            lua_pop(L,1);
+         }
+         factions = (int*) lua_newuserdata(L, (k+1)*sizeof(int) );
+         factions[0] = k;
+         k = 0;
+         lua_pushnil(L);
+         while (lua_next(L, 1) != 0) {
+            if (lua_isfaction(L,-1))
+               factions[++k] = lua_tofaction(L,-1);
+            lua_pop(L,1);
+         }
+      }
+   }
+   else if ((lua_isnil(L,1)) || (lua_gettop(L) <= 3))
+      lua_pushnil(L);
+   else
+      NLUA_INVALID_PARAMETER(L);
+
+   lua_pushcclosure(L, pilotL_iteratorNext, 4);
+   return 1;
+}
+
 /*
  * Helper to get nearby friends or foes.
  */
 static int pilotL_getFriendOrFoe( lua_State *L, int friend )
 {
-   int k;
+   int k, n;
    double dd, d2;
    Pilot *p;
    double dist;
    int inrange, dis, fighters;
    vec2 *v;
    Pilot *const* pilot_stack;
+   const int *cand;
    LuaFaction lf;
 
    /* Check if using faction. */
@@ -952,12 +1102,17 @@ static int pilotL_getFriendOrFoe( lua_State *L, int friend )
    dd = pow2(dist);
    d2 = -1.;
 
+   /* Hostile queries from a pilot only have to look at the shared
+    * per-faction candidate list; the exact checks below still run. */
+   cand = (!friend && (p != NULL)) ? pilot_enemyCandidates( p ) : NULL;
+
    /* Now put all the matching pilots in a table. */
    pilot_stack = pilot_getAll();
    lua_newtable(L);
    k = 1;
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      Pilot *plt = pilot_stack[i];
+   n = (cand != NULL) ? array_size(cand) : array_size(pilot_stack);
+   for (int j=0; j<n; j++) {
+      Pilot *plt = pilot_stack[ (cand != NULL) ? cand[j] : j ];
 
       /* Check if dead. */
       if (pilot_isFlag(plt, PILOT_DELETE))
@@ -2877,17 +3032,58 @@ static int pilotL_outfitAdd( lua_State *L )
       pilot_calcStats( p );
 
    /* Update the weapon sets. */
-   if ((added > 0) && p->autoweap)
+   if ((added > 0) && p->autoweap && !pilot_isFlag(p, PILOT_OUTFIT_BATCH))
       pilot_weaponAuto(p);
 
    /* Update equipment window if operating on the player's pilot. */
-   if (player.p != NULL && player.p == p && added > 0)
+   if (player.p != NULL && player.p == p && added > 0 &&
+         !pilot_isFlag(p, PILOT_OUTFIT_BATCH))
       outfits_updateEquipmentOutfits();
 
    lua_pushnumber(L,added);
    return 1;
 }
 
+/**
+ * @brief Runs a function with the pilot's refit transaction open.
+ *
+ * Outfit additions and removals made inside the function defer the stat
+ * recompute, weapon set update and equipment-window refresh to a single
+ * pass when the function returns, instead of paying them per outfit.
+ * Reading stats inside the function sees the pre-refit values.
+ *
+ * @usage p:outfitBatch( function () for k,o in ipairs(fit) do p:outfitAdd(o,1,true) end end )
+ *
+ *    @luatparam Pilot p Pilot to refit.
+ *    @luatparam function fn Function to run inside the transaction.
+ * @luafunc outfitBatch
+ */
+static int pilotL_outfitBatch( lua_State *L )
+{
+   Pilot *p = luaL_validpilot(L,1);
+   unsigned int id = p->id;
+   int ret, batching;
+   luaL_checktype( L, 2, LUA_TFUNCTION );
+
+   /* Nested transactions just run in the enclosing one. */
+   batching = pilot_isFlag( p, PILOT_OUTFIT_BATCH );
+   pilot_outfitBatch( p, 1 );
+   lua_pushvalue( L, 2 );
+   ret = lua_pcall( L, 0, 0, 0 );
+
+   /* The function may have removed the pilot; re-validate before closing. */
+   p = pilot_get( id );
+   if ((p != NULL) && !batching)
+      pilot_outfitBatch( p, 0 );
+   if (ret != 0)
+      return lua_error( L ); /* Error message is on the stack. */
+
+   /* Update equipment window once if operating on the player's pilot. */
+   if ((p != NULL) && (player.p == p) && !batching)
+      outfits_updateEquipmentOutfits();
+   return 0;
+}
+
 /**
  * @brief Checks to see outfit a pilot has in a slot.
  *
@@ -2953,11 +3149,12 @@ static int pilotL_outfitAddSlot( lua_State *L )
       pilot_calcStats( p );
 
    /* Update the weapon sets. */
-   if ((added > 0) && p->autoweap)
+   if ((added > 0) && p->autoweap && !pilot_isFlag(p, PILOT_OUTFIT_BATCH))
       pilot_weaponAuto(p);
 
    /* Update equipment window if operating on the player's pilot. */
-   if (player.p != NULL && player.p == p && added > 0)
+   if (player.p != NULL && player.p == p && added > 0 &&
+         !pilot_isFlag(p, PILOT_OUTFIT_BATCH))
       outfits_updateEquipmentOutfits();
 
    lua_pushboolean(L,added);
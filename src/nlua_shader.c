@@ -140,6 +140,7 @@ static int shaderL_gc( lua_State *L )
    if (shader->pp_id > 0)
       render_postprocessRm( shader->pp_id );
    glDeleteProgram( shader->program );
+   gl_stateInvalidate(); /* Program ids can get reused. */
    array_free( shader->tex );
    free(shader->uniforms);
    return 0;
@@ -348,7 +349,7 @@ static int shaderL_sendHelper( lua_State *L, int ignore_missing )
 
    /* With OpenGL 4.1 or ARB_separate_shader_objects, there
     * is no need to set the program first. */
-   glUseProgram( ls->program );
+   gl_useProgram( ls->program );
    idx = 3;
    switch (u->type) {
       case GL_FLOAT:
@@ -393,7 +394,7 @@ static int shaderL_sendHelper( lua_State *L, int ignore_missing )
       default:
          WARN(_("Unsupported shader uniform type '%d' for uniform '%s'. Ignoring."), u->type, u->name );
    }
-   glUseProgram( 0 );
+   gl_useProgram( 0 );
 
    gl_checkErr();
 
@@ -712,8 +712,10 @@ static int spobL_landOverride( lua_State *L )
    p->land_override = !!lua_toboolean(L,2);
 
    /* If the value has changed, re-run the landing Lua next frame. */
-   if (p->land_override != old)
+   if (p->land_override != old) {
+      spob_invalidateLand( p );
       space_factionChange();
+   }
 
    return 0;
 }
@@ -902,6 +902,7 @@ static int systemL_setknown( lua_State *L )
             jp_rmFlag( &sys->jumps[i], JP_KNOWN );
      }
    }
+   space_knownInvalidate();
 
    /* Update outfits image array. */
    outfits_updateEquipmentOutfits();
@@ -113,12 +113,25 @@ glTexture* luaL_checktex( lua_State *L, int ind )
  *    @return Texture found at the index in the state.
  */
 glTexture* luaL_validtex( lua_State *L, int ind, const char *searchpath )
+{
+   return luaL_validtexFlags( L, ind, searchpath, 0 );
+}
+/**
+ * @brief luaL_validtex() with control over the texture load flags.
+ *
+ *    @param L Lua state to get texture from.
+ *    @param ind Index position to find texture.
+ *    @param searchpath Path to search for files.
+ *    @param flags Flags to load a new texture with.
+ *    @return Texture found at the index in the state.
+ */
+glTexture* luaL_validtexFlags( lua_State *L, int ind, const char *searchpath, unsigned int flags )
 {
    char path[PATH_MAX];
    if (lua_istex(L,ind))
       return gl_dupTexture( luaL_checktex(L,ind) );
    ndata_getPathDefault( path, sizeof(path), searchpath, luaL_checkstring(L,ind) );
-   return gl_newImage( path, 0 );
+   return gl_newImage( path, flags );
 }
 /**
  * @brief Pushes a texture on the stack.
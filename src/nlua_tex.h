@@ -21,3 +21,4 @@ glTexture* luaL_checktex( lua_State *L, int ind );
 glTexture** lua_pushtex( lua_State *L, glTexture* tex );
 int lua_istex( lua_State *L, int ind );
 glTexture* luaL_validtex( lua_State *L, int ind, const char *searchpath );
+glTexture* luaL_validtexFlags( lua_State *L, int ind, const char *searchpath, unsigned int flags );
@@ -308,7 +308,9 @@ static int vectorL_add__( lua_State *L )
 
    /* Actually add it */
    vec2_cset( v1, v1->x + x, v1->y + y );
-   lua_pushvector( L, *v1 );
+   /* In-place: return self instead of allocating a copy, so vector-heavy
+    * loops (AI steering, autonav) don't generate garbage. */
+   lua_pushvalue( L, 1 );
 
    return 1;
 }
@@ -382,7 +384,7 @@ static int vectorL_sub__( lua_State *L )
 
    /* Actually add it */
    vec2_cset( v1, v1->x - x, v1->y - y );
-   lua_pushvector( L, *v1 );
+   lua_pushvalue( L, 1 ); /* In-place: return self, no allocation. */
    return 1;
 }
 
@@ -434,7 +436,7 @@ static int vectorL_mul__( lua_State *L )
 
    /* Actually add it */
    vec2_cset( v1, v1->x * mod, v1->y * mod );
-   lua_pushvector( L, *v1 );
+   lua_pushvalue( L, 1 ); /* In-place: return self, no allocation. */
    return 1;
 }
 
@@ -474,7 +476,7 @@ static int vectorL_div__( lua_State *L )
 
    /* Actually add it */
    vec2_cset( v1, v1->x / mod, v1->y / mod );
-   lua_pushvector( L, *v1 );
+   lua_pushvalue( L, 1 ); /* In-place: return self, no allocation. */
    return 1;
 }
 
@@ -679,6 +681,6 @@ static int vectorL_normalize( lua_State *L )
    double m = VMOD(*v);
    v->x /= m;
    v->y /= m;
-   lua_pushvector(L, *v);
+   lua_pushvalue( L, 1 ); /* In-place: return self, no allocation. */
    return 1;
 }
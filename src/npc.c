@@ -520,7 +520,8 @@ glTexture *npc_getBackground( int i )
 
    /* TODO choose the background based on the spob or something. */
    if (npc_array[i].background == NULL)
-      npc_array[i].background = gl_newImage( GFX_PATH"portraits/background.png", 0 );
+      npc_array[i].background = gl_newImage( GFX_PATH"portraits/background.png",
+            OPENGL_TEX_ASYNC );
    return npc_array[i].background;
 }
 
@@ -118,6 +118,109 @@ int strsort_reverse( const void *p1, const void *p2 )
    return strsort( p2, p1 );
 }
 
+/**
+ * @brief An entry in the intern pool; the string is stored inline.
+ */
+typedef struct InternEntry_ {
+   struct InternEntry_ *next; /**< Next entry in the bucket chain. */
+   char str[]; /**< The interned string. */
+} InternEntry;
+
+static InternEntry **intern_buckets = NULL; /**< Intern pool hash buckets. */
+static size_t intern_nbuckets = 0; /**< Number of buckets (power of two). */
+static size_t intern_n = 0;        /**< Number of interned strings. */
+
+/**
+ * @brief FNV-1a hash of a string.
+ */
+static size_t strintern_hash( const char *s )
+{
+   size_t h = 2166136261u;
+   while (*s != '\0') {
+      h ^= (unsigned char) *s++;
+      h *= 16777619u;
+   }
+   return h;
+}
+
+/**
+ * @brief Doubles the intern pool's bucket count, rechaining all entries.
+ */
+static void strintern_grow (void)
+{
+   size_t nbuckets = (intern_nbuckets == 0) ? 256 : intern_nbuckets*2;
+   InternEntry **buckets = calloc( nbuckets, sizeof(InternEntry*) );
+
+   for (size_t i=0; i<intern_nbuckets; i++) {
+      InternEntry *e = intern_buckets[i];
+      while (e != NULL) {
+         InternEntry *next = e->next;
+         size_t b = strintern_hash( e->str ) & (nbuckets-1);
+         e->next    = buckets[b];
+         buckets[b] = e;
+         e = next;
+      }
+   }
+
+   free( intern_buckets );
+   intern_buckets  = buckets;
+   intern_nbuckets = nbuckets;
+}
+
+/**
+ * @brief Interns a string in the global pool.
+ *
+ * Equal strings always return the same pointer, so interned strings can be
+ * compared with == and duplicates share one allocation. The returned string
+ * lives until strintern_exit() and must not be freed or modified.
+ *
+ *    @param s String to intern (not stored; may be freed by the caller).
+ *    @return The canonical copy of \p s.
+ */
+const char *strintern( const char *s )
+{
+   size_t b;
+   InternEntry *e;
+
+   if (s == NULL)
+      return NULL;
+
+   /* Grow at a 75% load factor. */
+   if (intern_n+1 > intern_nbuckets - intern_nbuckets/4)
+      strintern_grow();
+
+   b = strintern_hash( s ) & (intern_nbuckets-1);
+   for (e = intern_buckets[b]; e != NULL; e = e->next)
+      if (strcmp( e->str, s ) == 0)
+         return e->str;
+
+   e = malloc( sizeof(InternEntry) + strlen(s) + 1 );
+   strcpy( e->str, s );
+   e->next = intern_buckets[b];
+   intern_buckets[b] = e;
+   intern_n++;
+   return e->str;
+}
+
+/**
+ * @brief Frees the intern pool. All interned strings become invalid.
+ */
+void strintern_exit (void)
+{
+   for (size_t i=0; i<intern_nbuckets; i++) {
+      InternEntry *e = intern_buckets[i];
+      while (e != NULL) {
+         InternEntry *next = e->next;
+         free( e );
+         e = next;
+      }
+   }
+   free( intern_buckets );
+   intern_buckets  = NULL;
+   intern_nbuckets = 0;
+   intern_n        = 0;
+}
+
 /**
  * @brief Like vsprintf(), but it allocates a large-enough string and returns the pointer in the first argument.
  *        Conforms to GNU and BSD libc semantics.
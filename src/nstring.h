@@ -35,6 +35,10 @@ PRINTF_FORMAT( 3, 4 ) int scnprintf( char* text, size_t maxlen, const char* fmt,
 int strsort( const void *p1, const void *p2 );
 int strsort_reverse( const void *p1, const void *p2 );
 
+/* String interning. */
+const char *strintern( const char *s );
+void strintern_exit (void);
+
 #define NUM2STRLEN   16
 int num2str( char dest[NUM2STRLEN], double n, int decimals );
 const char* num2strU( double n, int decimals );
@@ -42,6 +42,7 @@
 #include "economy.h"
 #include "hook.h"
 #include "nstring.h"
+#include "worldsim.h"
 
 #define NT_SECONDS_DIV   (1000)      /* Divider for extracting seconds. */
 #define NT_SECONDS_DT    (30)        /* Update rate, how many seconds are in a real second. */
@@ -59,6 +60,19 @@ typedef struct NTimeUpdate_s {
 } NTimeUpdate_t;
 static NTimeUpdate_t *ntime_inclist = NULL; /**< Time increment list. */
 
+#define NT_PRETTY_CACHE 4 /**< Recently formatted times kept around. */
+/**
+ * @brief Cached result of formatting a time with ntime_prettyBuf().
+ */
+typedef struct NTimePretty_s {
+   ntime_t t; /**< Time that was formatted. */
+   int d; /**< Number of digits it was formatted with. */
+   char str[64]; /**< Formatted result. */
+} NTimePretty_t;
+static NTimePretty_t ntime_prettyCache[NT_PRETTY_CACHE]; /**< Formatting cache. */
+static int ntime_prettyCached = 0; /**< Number of valid cache entries. */
+static int ntime_prettyNext = 0; /**< Next cache slot to evict. */
+
 static ntime_t naev_time = 0; /**< Contains the current time in milliseconds. */
 static double naev_remainder = 0.; /**< Remainder when updating, to try to keep in perfect sync. */
 static int ntime_enable = 1; /** Allow updates? */
@@ -189,22 +203,40 @@ void ntime_prettyBuf( char *str, int max, ntime_t t, int d )
 {
    ntime_t nt;
    int cycles, periods, seconds;
+   NTimePretty_t *e;
 
    if (t==0)
       nt = naev_time;
    else
       nt = t;
 
+   /* The HUD and landed screens format the same time every frame; reuse
+    * the last few results rather than decomposing and printing again. */
+   for (int i=0; i<ntime_prettyCached; i++) {
+      e = &ntime_prettyCache[i];
+      if ((e->t == nt) && (e->d == d)) {
+         snprintf( str, max, "%s", e->str );
+         return;
+      }
+   }
+   e = &ntime_prettyCache[ ntime_prettyNext ];
+   ntime_prettyNext = (ntime_prettyNext + 1) % NT_PRETTY_CACHE;
+   if (ntime_prettyCached < NT_PRETTY_CACHE)
+      ntime_prettyCached++;
+   e->t = nt;
+   e->d = d;
+
    /* UST (Universal Synchronized Time) - unit is seconds */
    cycles = ntime_getCycles( nt );
    periods = ntime_getPeriods( nt );
    seconds = ntime_getSeconds( nt );
    if ((cycles == 0) && (periods == 0)) /* only seconds */
-      snprintf( str, max, _("%04d s"), seconds );
+      snprintf( e->str, sizeof(e->str), _("%04d s"), seconds );
    else if ((cycles == 0) || (d==0))
-      snprintf( str, max, _("%.*f p"), d, periods + 0.0001 * seconds );
+      snprintf( e->str, sizeof(e->str), _("%.*f p"), d, periods + 0.0001 * seconds );
    else /* UST format */
-      snprintf( str, max, _("UST %d:%.*f"), cycles, d, periods + 0.0001 * seconds );
+      snprintf( e->str, sizeof(e->str), _("UST %d:%.*f"), cycles, d, periods + 0.0001 * seconds );
+   snprintf( str, max, "%s", e->str );
 }
 
 /**
@@ -237,6 +269,7 @@ void ntime_inc( ntime_t t )
 {
    naev_time += t;
    economy_update( t );
+   worldsim_update( t );
 
    /* Run hooks. */
    if (t > 0)
@@ -297,6 +330,7 @@ void ntime_refresh (void)
       /* Run hook stuff and actually update time. */
       naev_time += ntu->inc;
       economy_update( ntu->inc );
+      worldsim_update( ntu->inc );
 
       /* Remove the increment. */
       ntime_inclist = ntu->next;
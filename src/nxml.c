@@ -7,14 +7,40 @@
  * Handles some complex xml parsing.
  */
 /** @cond */
+#include <stdarg.h>
+#include <stdio.h>
+
 #include "naev.h"
 /** @endcond */
 
 #include "nxml.h"
 
+#include "array.h"
+#include "md5.h"
 #include "ndata.h"
+#include "nfile.h"
 #include "nstring.h"
 
+/*
+ * Binary cache of parsed documents. The first time a file is parsed the
+ * resulting tree is flattened into the cache dir; later runs rebuild the
+ * tree from the flat records and skip the XML parser entirely. Entries
+ * are keyed by a hash of the file contents, so edited or modded files
+ * simply miss the cache and get reparsed.
+ */
+#define XML_CACHE_MAGIC    0x4C4D584Eu /**< "NXML" */
+#define XML_CACHE_VERSION  1           /**< Bump when the record format changes. */
+
+/*
+ * Prototypes.
+ */
+static void xml_cachePut( char **buf, const void *data, size_t len );
+static void xml_cachePutStr( char **buf, const xmlChar *s );
+static void xml_cacheWriteNode( char **buf, xmlNodePtr node );
+static int xml_cacheGet( const char **cur, const char *end, void *out, size_t len );
+static char* xml_cacheGetStr( const char **cur, const char *end );
+static xmlNodePtr xml_cacheReadNode( xmlDocPtr doc, const char **cur, const char *end );
+
 /**
  * @brief Parses a texture handling the sx and sy elements.
  *
@@ -97,6 +123,338 @@ xmlDocPtr xml_parsePhysFS( const char* filename )
    return doc;
 }
 
+/**
+ * @brief Appends raw bytes to a cache buffer (array.h).
+ */
+static void xml_cachePut( char **buf, const void *data, size_t len )
+{
+   int n = array_size( *buf );
+   array_resize( buf, n + (int)len );
+   memcpy( &(*buf)[n], data, len );
+}
+
+/**
+ * @brief Appends a length-prefixed string to a cache buffer.
+ */
+static void xml_cachePutStr( char **buf, const xmlChar *s )
+{
+   uint32_t len = (s == NULL) ? 0 : (uint32_t)strlen( (const char*)s );
+   xml_cachePut( buf, &len, sizeof(len) );
+   if (len > 0)
+      xml_cachePut( buf, s, len );
+}
+
+/**
+ * @brief Whether a node type makes it into the cache.
+ *
+ * Comments and processing instructions carry no data.
+ */
+static int xml_cacheable( const xmlNodePtr node )
+{
+   return (node->type == XML_ELEMENT_NODE) ||
+          (node->type == XML_TEXT_NODE) ||
+          (node->type == XML_CDATA_SECTION_NODE);
+}
+
+/**
+ * @brief Recursively flattens a node into cache records.
+ */
+static void xml_cacheWriteNode( char **buf, xmlNodePtr node )
+{
+   uint8_t type = (uint8_t) node->type;
+   xml_cachePut( buf, &type, sizeof(type) );
+
+   if (node->type == XML_ELEMENT_NODE) {
+      uint32_t n;
+
+      xml_cachePutStr( buf, node->name );
+
+      /* Attributes, with entities already resolved. */
+      n = 0;
+      for (xmlAttrPtr a=node->properties; a!=NULL; a=a->next)
+         n++;
+      xml_cachePut( buf, &n, sizeof(n) );
+      for (xmlAttrPtr a=node->properties; a!=NULL; a=a->next) {
+         xmlChar *val = xmlGetProp( node, a->name );
+         xml_cachePutStr( buf, a->name );
+         xml_cachePutStr( buf, val );
+         xmlFree( val );
+      }
+
+      /* Children. */
+      n = 0;
+      for (xmlNodePtr c=node->children; c!=NULL; c=c->next)
+         if (xml_cacheable(c))
+            n++;
+      xml_cachePut( buf, &n, sizeof(n) );
+      for (xmlNodePtr c=node->children; c!=NULL; c=c->next)
+         if (xml_cacheable(c))
+            xml_cacheWriteNode( buf, c );
+   }
+   else
+      xml_cachePutStr( buf, node->content );
+}
+
+/**
+ * @brief Bounds-checked read from a cache buffer.
+ *
+ *    @return 0 on success.
+ */
+static int xml_cacheGet( const char **cur, const char *end, void *out, size_t len )
+{
+   if (*cur + len > end)
+      return -1;
+   memcpy( out, *cur, len );
+   *cur += len;
+   return 0;
+}
+
+/**
+ * @brief Reads a length-prefixed string from a cache buffer.
+ *
+ *    @return Newly allocated string or NULL on corruption.
+ */
+static char* xml_cacheGetStr( const char **cur, const char *end )
+{
+   uint32_t len;
+   char *s;
+
+   if (xml_cacheGet( cur, end, &len, sizeof(len) ))
+      return NULL;
+   if (*cur + len > end)
+      return NULL;
+   s = malloc( len+1 );
+   memcpy( s, *cur, len );
+   s[len] = '\0';
+   *cur += len;
+   return s;
+}
+
+/**
+ * @brief Recursively rebuilds a node from cache records.
+ *
+ *    @return The node, or NULL if the cache is corrupt.
+ */
+static xmlNodePtr xml_cacheReadNode( xmlDocPtr doc, const char **cur, const char *end )
+{
+   uint8_t type;
+   xmlNodePtr node;
+
+   if (xml_cacheGet( cur, end, &type, sizeof(type) ))
+      return NULL;
+
+   if (type == XML_ELEMENT_NODE) {
+      uint32_t n;
+      char *name = xml_cacheGetStr( cur, end );
+      if (name == NULL)
+         return NULL;
+      node = xmlNewDocNode( doc, NULL, (const xmlChar*)name, NULL );
+      free( name );
+
+      if (xml_cacheGet( cur, end, &n, sizeof(n) )) {
+         xmlFreeNode( node );
+         return NULL;
+      }
+      for (uint32_t i=0; i<n; i++) {
+         char *aname = xml_cacheGetStr( cur, end );
+         char *aval  = xml_cacheGetStr( cur, end );
+         if ((aname == NULL) || (aval == NULL)) {
+            free( aname );
+            free( aval );
+            xmlFreeNode( node );
+            return NULL;
+         }
+         xmlNewProp( node, (const xmlChar*)aname, (const xmlChar*)aval );
+         free( aname );
+         free( aval );
+      }
+
+      if (xml_cacheGet( cur, end, &n, sizeof(n) )) {
+         xmlFreeNode( node );
+         return NULL;
+      }
+      for (uint32_t i=0; i<n; i++) {
+         xmlNodePtr child = xml_cacheReadNode( doc, cur, end );
+         if (child == NULL) {
+            xmlFreeNode( node );
+            return NULL;
+         }
+         xmlAddChild( node, child );
+      }
+   }
+   else if ((type == XML_TEXT_NODE) || (type == XML_CDATA_SECTION_NODE)) {
+      char *content = xml_cacheGetStr( cur, end );
+      if (content == NULL)
+         return NULL;
+      node = xmlNewDocText( doc, (const xmlChar*)content );
+      free( content );
+   }
+   else
+      return NULL;
+
+   return node;
+}
+
+/**
+ * @brief Like xml_parsePhysFS, but backed by a binary cache of the parsed tree.
+ *
+ * Meant for the big data loads (ships, outfits, spobs, systems) that
+ * dominate boot time; the cache is invalidated automatically when the
+ * file contents change.
+ *
+ *    @param filename PhysFS file name.
+ *    @return doc (must xmlFreeDoc) on success, NULL on failure (will warn user).
+ */
+xmlDocPtr xml_parsePhysFSCached( const char* filename )
+{
+   char *buf, *cachefile;
+   size_t bufsize, cachesize;
+   xmlDocPtr doc;
+   md5_state_t md5;
+   md5_byte_t md5val[16];
+   char digest[33];
+   uint32_t header[2];
+
+   buf = ndata_read( filename, &bufsize );
+   if (buf == NULL) {
+      WARN( _("Unable to read data from '%s'"), filename );
+      return NULL;
+   }
+   /* Empty file, we ignore these. */
+   if (bufsize==0) {
+      free(buf);
+      return NULL;
+   }
+
+   /* Key the cache off the file contents. */
+   md5_init( &md5 );
+   md5_append( &md5, (md5_byte_t*)filename, strlen(filename) );
+   md5_append( &md5, (md5_byte_t*)buf, bufsize );
+   md5_finish( &md5, md5val );
+   for (int i=0; i<16; i++)
+      snprintf( &digest[i*2], 3, "%02x", md5val[i] );
+   asprintf( &cachefile, "%sxml/%s", nfile_cachePath(), digest );
+
+   /* Try to rebuild the tree from the cache. */
+   if (nfile_fileExists( cachefile )) {
+      char *cache = nfile_readFile( &cachesize, cachefile );
+      if (cache != NULL) {
+         const char *cur = cache;
+         const char *end = cache + cachesize;
+         if ((xml_cacheGet( &cur, end, header, sizeof(header) ) == 0) &&
+               (header[0] == XML_CACHE_MAGIC) &&
+               (header[1] == XML_CACHE_VERSION)) {
+            xmlNodePtr root;
+            doc  = xmlNewDoc( (const xmlChar*)"1.0" );
+            root = xml_cacheReadNode( doc, &cur, end );
+            if ((root != NULL) && (cur == end)) {
+               xmlDocSetRootElement( doc, root );
+               free( cache );
+               free( cachefile );
+               free( buf );
+               return doc;
+            }
+            /* Corrupt cache; fall through and reparse. */
+            xmlFreeDoc( doc );
+         }
+         free( cache );
+      }
+   }
+
+   /* Cache miss; parse and flatten for next time. */
+   doc = xmlParseMemory( buf, bufsize );
+   free( buf );
+   if (doc == NULL) {
+      WARN( _("Unable to parse document '%s'"), filename );
+      free( cachefile );
+      return NULL;
+   }
+
+   if (xmlDocGetRootElement( doc ) != NULL) {
+      char dirpath[PATH_MAX];
+      char *cache = array_create( char );
+      header[0] = XML_CACHE_MAGIC;
+      header[1] = XML_CACHE_VERSION;
+      xml_cachePut( &cache, header, sizeof(header) );
+      xml_cacheWriteNode( &cache, xmlDocGetRootElement( doc ) );
+      snprintf( dirpath, sizeof(dirpath), "%sxml/", nfile_cachePath() );
+      nfile_dirMakeExist( dirpath );
+      nfile_writeFile( cache, array_size(cache), cachefile );
+      array_free( cache );
+   }
+   free( cachefile );
+
+   return doc;
+}
+
+/**
+ * @brief Opens a bulk fragment buffer (array.h) for xmlw_bulkWrite().
+ *
+ * Hot save paths can build a whole element list in memory and hand it to
+ * the writer in a single raw write instead of one writer call per element.
+ */
+char* xmlw_bulkOpen (void)
+{
+   return array_create( char );
+}
+
+/**
+ * @brief Appends formatted raw markup to a bulk fragment.
+ *
+ * Dynamic text must be escaped with xmlw_bulkCatEsc().
+ */
+void xmlw_bulkCat( char **buf, const char *fmt, ... )
+{
+   va_list ap;
+   char tmp[STRMAX];
+   int len, n;
+
+   va_start( ap, fmt );
+   len = vsnprintf( tmp, sizeof(tmp), fmt, ap );
+   va_end( ap );
+   if (len > (int)sizeof(tmp)-1)
+      len = (int)sizeof(tmp)-1;
+
+   n = array_size( *buf );
+   array_resize( buf, n + len );
+   memcpy( &(*buf)[n], tmp, len );
+}
+
+/**
+ * @brief Appends text to a bulk fragment, escaping XML special characters.
+ */
+void xmlw_bulkCatEsc( char **buf, const char *text )
+{
+   for (const char *c = text; *c != '\0'; c++) {
+      switch (*c) {
+         case '&':  xmlw_bulkCat( buf, "&amp;" );  break;
+         case '<':  xmlw_bulkCat( buf, "&lt;" );   break;
+         case '>':  xmlw_bulkCat( buf, "&gt;" );   break;
+         case '"':  xmlw_bulkCat( buf, "&quot;" ); break;
+         default:
+            array_push_back( buf, *c );
+      }
+   }
+}
+
+/**
+ * @brief Writes a bulk fragment through the writer and frees it.
+ *
+ *    @param writer Writer to write the fragment through.
+ *    @param buf Fragment to write; freed and set to NULL.
+ *    @return 0 on success, -1 on failure.
+ */
+int xmlw_bulkWrite( xmlTextWriterPtr writer, char **buf )
+{
+   int ret = 0;
+   if (array_size(*buf) > 0)
+      ret = (xmlTextWriterWriteRawLen( writer, (xmlChar*)*buf,
+            array_size(*buf) ) < 0) ? -1 : 0;
+   array_free( *buf );
+   *buf = NULL;
+   return ret;
+}
+
 int xmlw_saveTime( xmlTextWriterPtr writer, const char *name, time_t t )
 {
    xmlw_elem( writer, name, "%lu", t );
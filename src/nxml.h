@@ -161,6 +161,7 @@ do {if (xmlTextWriterEndDocument(w) < 0) { \
  * Functions for generic complex reading.
  */
 xmlDocPtr xml_parsePhysFS( const char* filename );
+xmlDocPtr xml_parsePhysFSCached( const char* filename );
 glTexture* xml_parseTexture( xmlNodePtr node,
       const char *path, int defsx, int defsy,
       const unsigned int flags );
@@ -171,3 +172,11 @@ int xml_parseTime( xmlNodePtr node, time_t *t );
  */
 void xmlw_setParams( xmlTextWriterPtr writer );
 int xmlw_saveTime( xmlTextWriterPtr writer, const char *name, time_t t );
+
+/*
+ * Bulk raw writing for hot save paths.
+ */
+char* xmlw_bulkOpen (void);
+void xmlw_bulkCat( char **buf, const char *fmt, ... );
+void xmlw_bulkCatEsc( char **buf, const char *text );
+int xmlw_bulkWrite( xmlTextWriterPtr writer, char **buf );
@@ -23,7 +23,9 @@
 #include "camera.h"
 #include "gui.h"
 #include "log.h"
+#include "md5.h"
 #include "ndata.h"
+#include "nfile.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 # define strtok_r strtok_s
@@ -63,8 +65,152 @@ static glTexture *zeroTexture       = NULL;
 static glTexture *oneTexture        = NULL;
 static unsigned int emptyTextureRefs= 0;
 
+/* Binary mesh cache: the parsed, interleaved vertex buffers are stored
+ * keyed by source hash so subsequent loads skip the text parse entirely
+ * and upload straight from the blob; follows the XML parse cache in
+ * nxml.c. Materials are reparsed live since they own GL textures. */
+#define OBJ_CACHE_MAGIC   0x4a424f4e /**< "NOBJ". */
+#define OBJ_CACHE_VERSION 1          /**< Bump when the layout changes. */
+
+/**
+ * @brief Appends raw bytes to a cache fragment buffer (array.h).
+ */
+static void obj_cachePut( char **buf, const void *data, size_t len )
+{
+   int n = array_size( *buf );
+   array_resize( buf, n + (int)len );
+   memcpy( &(*buf)[n], data, len );
+}
+
+/**
+ * @brief Appends a length-prefixed string to a cache fragment buffer.
+ */
+static void obj_cachePutStr( char **buf, const char *s )
+{
+   uint32_t len = (uint32_t)strlen( s );
+   obj_cachePut( buf, &len, sizeof(len) );
+   obj_cachePut( buf, s, len );
+}
+
+/**
+ * @brief Reads raw bytes from a cache buffer, bounds checked.
+ */
+static int obj_cacheGet( const char **cur, const char *end, void *out, size_t len )
+{
+   if (*cur + len > end)
+      return -1;
+   memcpy( out, *cur, len );
+   *cur += len;
+   return 0;
+}
+
+/**
+ * @brief Reads a length-prefixed string; caller frees.
+ */
+static char* obj_cacheGetStr( const char **cur, const char *end )
+{
+   uint32_t len;
+   char *s;
+   if (obj_cacheGet( cur, end, &len, sizeof(len) ))
+      return NULL;
+   if (*cur + len > end)
+      return NULL;
+   s = malloc( len+1 );
+   memcpy( s, *cur, len );
+   s[len] = '\0';
+   *cur += len;
+   return s;
+}
+
+/**
+ * @brief Walks a cache body checking record bounds, without side effects.
+ *
+ *    @return 0 if the stream is structurally sound.
+ */
+static int obj_cacheValidate( const char *cur, const char *end )
+{
+   GLfloat radius;
+   uint32_t n, len, ncorners;
+
+   if (obj_cacheGet( &cur, end, &radius, sizeof(radius) ) ||
+         obj_cacheGet( &cur, end, &n, sizeof(n) ))
+      return -1;
+   for (uint32_t i=0; i<n; i++) {
+      if (obj_cacheGet( &cur, end, &len, sizeof(len) ) || (cur + len > end))
+         return -1;
+      cur += len;
+   }
+   if (obj_cacheGet( &cur, end, &n, sizeof(n) ))
+      return -1;
+   for (uint32_t i=0; i<n; i++) {
+      for (int j=0; j<2; j++) { /* Mesh name, material name. */
+         if (obj_cacheGet( &cur, end, &len, sizeof(len) ) || (cur + len > end))
+            return -1;
+         cur += len;
+      }
+      if (obj_cacheGet( &cur, end, &ncorners, sizeof(ncorners) ) ||
+            (ncorners > (size_t)(end - cur) / sizeof(Vertex)))
+         return -1;
+      cur += ncorners * sizeof(Vertex);
+   }
+   return (cur == end) ? 0 : -1;
+}
+
+/**
+ * @brief Rebuilds an object from a validated cache body.
+ *
+ * Uploads each mesh's vertex blob straight to a static VBO; materials
+ *  are parsed live from their .mtl files and meshes rebound by name.
+ */
+static void obj_cacheApply( Object *object, const char *filename,
+      const char *cur, const char *end )
+{
+   uint32_t n;
+
+   obj_cacheGet( &cur, end, &object->radius, sizeof(object->radius) );
+
+   /* Materials. */
+   obj_cacheGet( &cur, end, &n, sizeof(n) );
+   for (uint32_t i=0; i<n; i++) {
+      char *name = obj_cacheGetStr( &cur, end );
+      char *copy_filename = strdup( filename );
+      char *material_filename;
+      asprintf( &material_filename, "%s/%s", dirname(copy_filename), name );
+      materials_readFromFile( material_filename, &object->materials );
+      free( copy_filename );
+      free( material_filename );
+      free( name );
+   }
+
+   /* Meshes. */
+   obj_cacheGet( &cur, end, &n, sizeof(n) );
+   for (uint32_t i=0; i<n; i++) {
+      char *name    = obj_cacheGetStr( &cur, end );
+      char *matname = obj_cacheGetStr( &cur, end );
+      uint32_t ncorners;
+      int material;
+      Mesh *mesh;
+
+      obj_cacheGet( &cur, end, &ncorners, sizeof(ncorners) );
+      for (material = 0; material < array_size(object->materials); ++material)
+         if (strcmp(matname, object->materials[material].name) == 0)
+            break;
+      if (material == array_size(object->materials))
+         ERR(_("No such material %s"), matname);
+
+      mesh = &array_grow(&object->meshes);
+      mesh->name = name;
+      mesh->vbo = gl_vboCreateStatic( ncorners * sizeof(Vertex), cur );
+      mesh->num_corners = ncorners;
+      mesh->material = material;
+      cur += ncorners * sizeof(Vertex);
+      free( matname );
+   }
+}
+
 static void mesh_create( Mesh **meshes, const char* name,
-                         Vertex *corners, int material )
+                         Vertex *corners, int material,
+                         const Material *materials, char **cache )
 {
    if (array_size(corners) == 0)
       return;
@@ -78,6 +224,15 @@ static void mesh_create( Mesh **meshes, const char* name,
    mesh->vbo = gl_vboCreateStatic(array_size(corners) * sizeof(Vertex), corners);
    mesh->num_corners = array_size(corners);
    mesh->material = material;
+
+   /* Serialize for the mesh cache. */
+   if (cache != NULL) {
+      uint32_t n = array_size(corners);
+      obj_cachePutStr( cache, name );
+      obj_cachePutStr( cache, materials[material].name );
+      obj_cachePut( cache, &n, sizeof(n) );
+      obj_cachePut( cache, corners, n * sizeof(Vertex) );
+   }
    array_resize(&corners, 0);
 }
 
@@ -225,12 +380,14 @@ static void materials_readFromFile( const char *filename, Material **materials )
 Object *object_loadFromFile( const char *filename )
 {
    GLfloat *v;
-   GLfloat *vertex = array_create(GLfloat);   /**< vertex coordinates */
-   GLfloat *texture = array_create(GLfloat);  /**< texture coordinates */
-   GLfloat *normal = array_create(GLfloat);  /**< normal coordinates */
-   Vertex *corners = array_create(Vertex);    /**< corners of the triangle faces */
+   GLfloat *vertex, *texture, *normal;
+   Vertex *corners;
    char *filebuf, *filesaveptr, *line;
+   char *cachefile, *meshcache, **mtllibs;
    size_t filesize;
+   md5_state_t md5;
+   md5_byte_t md5val[16];
+   char digest[33];
 
    filebuf = ndata_read( filename, &filesize );
    if (filebuf == NULL)
@@ -251,6 +408,45 @@ Object *object_loadFromFile( const char *filename )
    object->meshes = array_create(Mesh);
    object->materials = array_create(Material);
 
+   /* Key the cache off the file contents, like the XML parse cache. */
+   md5_init( &md5 );
+   md5_append( &md5, (md5_byte_t*)filename, strlen(filename) );
+   md5_append( &md5, (md5_byte_t*)filebuf, filesize );
+   md5_finish( &md5, md5val );
+   for (int i=0; i<16; i++)
+      snprintf( &digest[i*2], 3, "%02x", md5val[i] );
+   asprintf( &cachefile, "%smesh/%s", nfile_cachePath(), digest );
+
+   /* Upload straight from the cached blob when the source is unchanged. */
+   if (nfile_fileExists( cachefile )) {
+      size_t cachesize;
+      char *cache = nfile_readFile( &cachesize, cachefile );
+      if (cache != NULL) {
+         const char *cur = cache;
+         const char *end = cache + cachesize;
+         uint32_t header[2];
+         if ((obj_cacheGet( &cur, end, header, sizeof(header) ) == 0) &&
+               (header[0] == OBJ_CACHE_MAGIC) &&
+               (header[1] == OBJ_CACHE_VERSION) &&
+               (obj_cacheValidate( cur, end ) == 0)) {
+            obj_cacheApply( object, filename, cur, end );
+            free( cache );
+            free( cachefile );
+            free( filebuf );
+            return object;
+         }
+         /* Corrupt or stale-format cache; fall through and reparse. */
+         free( cache );
+      }
+   }
+
+   vertex    = array_create(GLfloat);   /**< vertex coordinates */
+   texture   = array_create(GLfloat);   /**< texture coordinates */
+   normal    = array_create(GLfloat);   /**< normal coordinates */
+   corners   = array_create(Vertex);    /**< corners of the triangle faces */
+   meshcache = array_create(char);      /**< serialized mesh records */
+   mtllibs   = array_create(char*);     /**< material library names */
+
    line = strtok_r(filebuf, "\n", &filesaveptr);
    while (line != NULL) {
       const char *token;
@@ -267,9 +463,11 @@ Object *object_loadFromFile( const char *filename )
             materials_readFromFile(material_filename, &object->materials);
             free(copy_filename);
             free(material_filename);
+            array_push_back( &mtllibs, strdup(token) );
          }
       } else if (strcmp(token, "o") == 0) {
-         mesh_create(&object->meshes, name, corners, material);
+         mesh_create(&object->meshes, name, corners, material,
+               object->materials, &meshcache);
          token = strtok_r(NULL, DELIM, &saveptr);
          free(name), name = strdup(token);
       } else if (strcmp(token, "v") == 0) {
@@ -310,7 +508,8 @@ Object *object_loadFromFile( const char *filename )
 
          assert("Too few or too many vertices for a face." && (num == 3));
       } else if (strcmp(token, "usemtl") == 0) {
-         mesh_create(&object->meshes, name, corners, material);
+         mesh_create(&object->meshes, name, corners, material,
+               object->materials, &meshcache);
 
          /* a new mesh with the same name */
          token = strtok_r(NULL, DELIM, &saveptr);
@@ -332,7 +531,8 @@ Object *object_loadFromFile( const char *filename )
       line = strtok_r(NULL, "\n", &filesaveptr);
    }
 
-   mesh_create(&object->meshes, name, corners, material);
+   mesh_create(&object->meshes, name, corners, material,
+         object->materials, &meshcache);
    free(name);
 
    /* Calculate maximum mesh size (from center). */
@@ -342,12 +542,38 @@ Object *object_loadFromFile( const char *filename )
    }
    object->radius = sqrt( object->radius );
 
+   /* Write the cache for next time. */
+   {
+      char dirpath[PATH_MAX];
+      char *cache = array_create(char);
+      uint32_t header[2] = { OBJ_CACHE_MAGIC, OBJ_CACHE_VERSION };
+      uint32_t n;
+      obj_cachePut( &cache, header, sizeof(header) );
+      obj_cachePut( &cache, &object->radius, sizeof(object->radius) );
+      n = array_size(mtllibs);
+      obj_cachePut( &cache, &n, sizeof(n) );
+      for (int i=0; i<array_size(mtllibs); i++)
+         obj_cachePutStr( &cache, mtllibs[i] );
+      n = array_size(object->meshes);
+      obj_cachePut( &cache, &n, sizeof(n) );
+      obj_cachePut( &cache, meshcache, array_size(meshcache) );
+      snprintf( dirpath, sizeof(dirpath), "%smesh/", nfile_cachePath() );
+      nfile_dirMakeExist( dirpath );
+      nfile_writeFile( cache, array_size(cache), cachefile );
+      array_free( cache );
+   }
+
    /* cleans up */
    free(filebuf);
+   free(cachefile);
    array_free(vertex);
    array_free(texture);
    array_free(normal);
    array_free(corners);
+   array_free(meshcache);
+   for (int i=0; i<array_size(mtllibs); i++)
+      free(mtllibs[i]);
+   array_free(mtllibs);
 
    return object;
 }
@@ -387,7 +613,8 @@ void object_free( Object *object )
    free(object);
 }
 
-static void object_renderMesh( const Object *object, int part, GLfloat alpha )
+static void object_renderMesh( const Object *object, int part, GLfloat alpha,
+      const Material **lastmat )
 {
    const Mesh *mesh = &object->meshes[part];
 
@@ -409,29 +636,31 @@ static void object_renderMesh( const Object *object, int part, GLfloat alpha )
    Material *material = object->materials + mesh->material;
    //material->Kd[3] = alpha;
 
-   glUniform1f(shaders.material.Ns, material->Ns);
-   glUniform3f(shaders.material.Ka, material->Ka[0], material->Ka[1], material->Ka[2] );
-   glUniform3f(shaders.material.Kd, material->Kd[0], material->Kd[1], material->Kd[2] );
-   glUniform3f(shaders.material.Ks, material->Ks[0], material->Ks[1], material->Ks[2] );
-   glUniform3f(shaders.material.Ke, material->Ke[0], material->Ke[1], material->Ke[2] );
-   glUniform1f(shaders.material.Ni, material->Ni);
-   glUniform1f(shaders.material.d,  material->d * alpha);
-   glUniform1f(shaders.material.bm, material->bm);
-
-   /* binds textures */
-   glUniform1i(shaders.material.map_Kd, 0);
-   glUniform1i(shaders.material.map_Ks, 1);
-   glUniform1i(shaders.material.map_Ke, 2);
-   glUniform1i(shaders.material.map_Bump, 3);
-   glActiveTexture(GL_TEXTURE3);
-   glBindTexture(GL_TEXTURE_2D, material->map_Bump == NULL ? zeroTexture->texture : material->map_Bump->texture);
-   glActiveTexture(GL_TEXTURE2);
-   glBindTexture(GL_TEXTURE_2D, material->map_Ke == NULL ? oneTexture->texture : material->map_Ke->texture);
-   glActiveTexture(GL_TEXTURE1);
-   glBindTexture(GL_TEXTURE_2D, material->map_Ks == NULL ? oneTexture->texture : material->map_Ks->texture);
-   /* Need TEXTURE0 to be last. */
-   glActiveTexture(GL_TEXTURE0);
-   glBindTexture(GL_TEXTURE_2D, material->map_Kd == NULL ? oneTexture->texture : material->map_Kd->texture);
+   /* OBJ meshes are split on usemtl, so consecutive meshes often share a
+    * material and the whole uniform/texture setup can be skipped. */
+   if (material != *lastmat) {
+      *lastmat = material;
+
+      glUniform1f(shaders.material.Ns, material->Ns);
+      glUniform3f(shaders.material.Ka, material->Ka[0], material->Ka[1], material->Ka[2] );
+      glUniform3f(shaders.material.Kd, material->Kd[0], material->Kd[1], material->Kd[2] );
+      glUniform3f(shaders.material.Ks, material->Ks[0], material->Ks[1], material->Ks[2] );
+      glUniform3f(shaders.material.Ke, material->Ke[0], material->Ke[1], material->Ke[2] );
+      glUniform1f(shaders.material.Ni, material->Ni);
+      glUniform1f(shaders.material.d,  material->d * alpha);
+      glUniform1f(shaders.material.bm, material->bm);
+
+      /* binds textures */
+      glActiveTexture(GL_TEXTURE3);
+      glBindTexture(GL_TEXTURE_2D, material->map_Bump == NULL ? zeroTexture->texture : material->map_Bump->texture);
+      glActiveTexture(GL_TEXTURE2);
+      glBindTexture(GL_TEXTURE_2D, material->map_Ke == NULL ? oneTexture->texture : material->map_Ke->texture);
+      glActiveTexture(GL_TEXTURE1);
+      glBindTexture(GL_TEXTURE_2D, material->map_Ks == NULL ? oneTexture->texture : material->map_Ks->texture);
+      /* Need TEXTURE0 to be last. */
+      glActiveTexture(GL_TEXTURE0);
+      glBindTexture(GL_TEXTURE_2D, material->map_Kd == NULL ? oneTexture->texture : material->map_Kd->texture);
+   }
 
    glDrawArrays(GL_TRIANGLES, 0, mesh->num_corners);
 }
@@ -441,6 +670,8 @@ void object_renderSolidPart( const Object *object, const Solid *solid, const cha
    mat4 view, projection, model, ortho;
    const GLfloat od = NAEV_ORTHO_DIST;
    const GLfloat os = NAEV_ORTHO_SCALE / scale;
+   const Material *lastmat = NULL;
+   static int samplers_set = 0;
    double x, y; //, r;
 
    x = solid->pos.x;
@@ -454,7 +685,16 @@ void object_renderSolidPart( const Object *object, const Solid *solid, const cha
       return;
    */
 
-   glUseProgram(shaders.material.program);
+   gl_useProgram(shaders.material.program);
+
+   /* Sampler units never change; program state persists across frames. */
+   if (!samplers_set) {
+      samplers_set = 1;
+      glUniform1i(shaders.material.map_Kd, 0);
+      glUniform1i(shaders.material.map_Ks, 1);
+      glUniform1i(shaders.material.map_Ke, 2);
+      glUniform1i(shaders.material.map_Bump, 3);
+   }
 
    projection = gl_gameToScreenMatrix(gl_view_matrix);
    mat4_translate( &projection, x, y, 0. );
@@ -475,10 +715,10 @@ void object_renderSolidPart( const Object *object, const Solid *solid, const cha
 
    for (int i=0; i < array_size(object->meshes); ++i)
       if (strcmp(part_name, object->meshes[i].name) == 0)
-         object_renderMesh(object, i, alpha);
+         object_renderMesh(object, i, alpha, &lastmat);
 
    /* Restore defaults. */
    glDisable(GL_DEPTH_TEST);
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 }
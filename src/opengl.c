@@ -30,6 +30,7 @@
 /** @cond */
 #include "physfsrwops.h"
 #include "SDL.h"
+#include "SDL_atomic.h"
 #include "SDL_error.h"
 #include "SDL_image.h"
 
@@ -41,6 +42,7 @@
 #include "conf.h"
 #include "log.h"
 #include "render.h"
+#include "threadpool.h"
 
 /*
  * Requirements
@@ -61,6 +63,46 @@ static int gl_view_w = 0; /* Viewport width. */
 static int gl_view_h = 0; /* Viewport height. */
 mat4 gl_view_matrix = {{{{0}}}};
 
+/*
+ * Screenshot write-behind. The pixels are read back into a PBO so the
+ * GPU can copy them without stalling the frame, and the PNG encode and
+ * PhysFS write happen on a threadpool worker.
+ */
+static GLuint screenshot_pbo = 0; /**< PBO the pending readback lands in. */
+static char *screenshot_path = NULL; /**< Destination of the pending screenshot. */
+static int screenshot_w = 0; /**< Width of the pending screenshot. */
+static int screenshot_h = 0; /**< Height of the pending screenshot. */
+
+/**
+ * @brief A screenshot being encoded and written in the background.
+ */
+typedef struct glScreenshotJob_ {
+   GLubyte *pix; /**< Raw RGB pixels, bottom row first. */
+   char *path;   /**< PhysicsFS path to write to. */
+   int w;        /**< Width in pixels. */
+   int h;        /**< Height in pixels. */
+} glScreenshotJob;
+
+/*
+ * Continuous frame capture for trailers and the like. A ring of PBOs
+ * keeps the readback a couple of frames behind the GPU so it never
+ * stalls; the PNG encodes go through the threadpool like single
+ * screenshots. When the workers fall behind, frames are dropped
+ * (leaving gaps in the numbering) instead of blocking the game.
+ */
+#define CAPTURE_RING          3 /**< Frames of readback latency. */
+#define CAPTURE_MAX_INFLIGHT  8 /**< Encode jobs allowed before dropping frames. */
+static GLuint capture_pbo[ CAPTURE_RING ]; /**< Readback ring. */
+static int capture_active  = 0; /**< Whether continuous capture is on. */
+static int capture_head    = 0; /**< Next ring slot to fill. */
+static int capture_filled  = 0; /**< Slots with a readback in flight. */
+static int capture_frame   = 0; /**< Frames elapsed, used for file numbering. */
+static int capture_dropped = 0; /**< Frames dropped under pressure. */
+static int capture_session = 0; /**< Distinguishes capture runs in filenames. */
+static int capture_w       = 0; /**< Capture width in pixels. */
+static int capture_h       = 0; /**< Capture height in pixels. */
+static SDL_atomic_t capture_inflight; /**< Encode jobs not yet finished. */
+
 /*
  * prototypes
  */
@@ -71,50 +113,244 @@ static int gl_getFullscreenMode (void);
 static int gl_getGLInfo (void);
 static int gl_defState (void);
 static int gl_setupScaling (void);
+static int gl_screenshotWorker( void *data );
+static int gl_captureWorker( void *data );
+static void gl_captureHarvest (void);
 
 /*
  *
  * M I S C
  *
  */
+/**
+ * @brief Encodes and writes a screenshot on a threadpool worker.
+ */
+static int gl_screenshotWorker( void *data )
+{
+   glScreenshotJob *job = data;
+   SDL_RWops *rw;
+   SDL_Surface *surface = SDL_CreateRGBSurface( 0, job->w, job->h, 24, RGBAMASK );
+
+   /* Flip the rows; OpenGL reads bottom-up. */
+   for (int i=0; i<job->h; i++)
+      memcpy( (GLubyte*)surface->pixels + i * surface->pitch,
+            &job->pix[ (job->h - i - 1) * (3*job->w) ], 3*job->w );
+
+   /* Save PNG. */
+   if (!(rw = PHYSFSRWOPS_openWrite( job->path )))
+      WARN( _("Aborting screenshot") );
+   else
+      IMG_SavePNG_RW( surface, rw, 1 );
+
+   SDL_FreeSurface( surface );
+   free( job->pix );
+   free( job->path );
+   free( job );
+   return 0;
+}
+
 /**
  * @brief Takes a screenshot.
  *
+ * The actual PNG encode and disk write happen in the background; the
+ * readback is handed off by gl_screenshotPump() on a later frame.
+ *
  *    @param filename PhysicsFS path (e.g., "screenshots/screenshot042.png") of the file to save screenshot as.
  */
 void gl_screenshot( const char *filename )
 {
-   GLubyte *screenbuf;
-   SDL_RWops *rw;
-   SDL_Surface *surface;
    int w, h;
 
-   /* Allocate data. */
-   w           = gl_screen.rw;
-   h           = gl_screen.rh;
-   screenbuf   = malloc( sizeof(GLubyte) * 3 * w*h );
-   surface     = SDL_CreateRGBSurface( 0, w, h, 24, RGBAMASK );
+   /* Finish a previous capture that hasn't been handed off yet. */
+   gl_screenshotPump();
 
-   /* Read pixels from buffer -- SLOW. */
-   glPixelStorei(GL_PACK_ALIGNMENT, 1); /* Force them to pack the bytes. */
-   glReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, screenbuf );
+   w = gl_screen.rw;
+   h = gl_screen.rh;
 
-   /* Convert data. */
-   for (int i=0; i<h; i++)
-      memcpy( (GLubyte*)surface->pixels + i * surface->pitch, &screenbuf[ (h - i - 1) * (3*w) ], 3*w );
-   free( screenbuf );
+   /* Kick off the readback into a PBO; the GPU fills it asynchronously. */
+   glGenBuffers( 1, &screenshot_pbo );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, screenshot_pbo );
+   glBufferData( GL_PIXEL_PACK_BUFFER, 3 * w*h, NULL, GL_STREAM_READ );
+   glPixelStorei( GL_PACK_ALIGNMENT, 1 ); /* Force them to pack the bytes. */
+   glReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, NULL );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
 
-   /* Save PNG. */
-   if (!(rw = PHYSFSRWOPS_openWrite( filename )))
-      WARN( _("Aborting screenshot") );
-   else
-      IMG_SavePNG_RW( surface, rw, 1 );
+   screenshot_path = strdup( filename );
+   screenshot_w    = w;
+   screenshot_h    = h;
 
    /* Check to see if an error occurred. */
    gl_checkErr();
+}
 
-   /* Free memory. */
-   SDL_FreeSurface( surface );
+/**
+ * @brief Hands a finished screenshot readback off to the I/O worker.
+ *
+ * Meant to be called once per frame from the main loop; by then the
+ * readback has completed and mapping the PBO doesn't stall.
+ */
+void gl_screenshotPump (void)
+{
+   glScreenshotJob *job;
+   const GLubyte *map;
+
+   if (screenshot_pbo == 0)
+      return;
+
+   job       = malloc( sizeof(glScreenshotJob) );
+   job->pix  = malloc( sizeof(GLubyte) * 3 * screenshot_w*screenshot_h );
+   job->path = screenshot_path;
+   job->w    = screenshot_w;
+   job->h    = screenshot_h;
+
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, screenshot_pbo );
+   map = glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0,
+         3 * screenshot_w*screenshot_h, GL_MAP_READ_BIT );
+   if (map != NULL) {
+      memcpy( job->pix, map, sizeof(GLubyte) * 3 * screenshot_w*screenshot_h );
+      glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+   }
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+   glDeleteBuffers( 1, &screenshot_pbo );
+   screenshot_pbo  = 0;
+   screenshot_path = NULL;
+
+   if (map == NULL) {
+      WARN( _("Aborting screenshot") );
+      free( job->pix );
+      free( job->path );
+      free( job );
+      return;
+   }
+
+   threadpool_newJob( gl_screenshotWorker, job );
+
+   gl_checkErr();
+}
+
+/**
+ * @brief Like gl_screenshotWorker(), but tracks the encode backlog.
+ */
+static int gl_captureWorker( void *data )
+{
+   gl_screenshotWorker( data );
+   SDL_AtomicAdd( &capture_inflight, -1 );
+   return 0;
+}
+
+/**
+ * @brief Retires the oldest pending capture readback.
+ *
+ * By the time a slot comes back around the ring its readback has long
+ * finished, so the map is just a copy. If the encode workers are
+ * backlogged the frame is dropped rather than queueing unbounded.
+ */
+static void gl_captureHarvest (void)
+{
+   int slot = (capture_head + CAPTURE_RING - capture_filled) % CAPTURE_RING;
+   glScreenshotJob *job;
+   const GLubyte *map;
+   char path[PATH_MAX];
+
+   capture_filled--;
+
+   if (SDL_AtomicGet( &capture_inflight ) >= CAPTURE_MAX_INFLIGHT) {
+      capture_dropped++;
+      capture_frame++;
+      return;
+   }
+
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, capture_pbo[slot] );
+   map = glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0,
+         3 * capture_w*capture_h, GL_MAP_READ_BIT );
+   if (map == NULL) {
+      glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+      capture_dropped++;
+      capture_frame++;
+      return;
+   }
+
+   snprintf( path, sizeof(path), "screenshots/capture%03d_%06d.png",
+         capture_session, capture_frame );
+   job       = malloc( sizeof(glScreenshotJob) );
+   job->pix  = malloc( sizeof(GLubyte) * 3 * capture_w*capture_h );
+   job->path = strdup( path );
+   job->w    = capture_w;
+   job->h    = capture_h;
+   memcpy( job->pix, map, sizeof(GLubyte) * 3 * capture_w*capture_h );
+   glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+   SDL_AtomicAdd( &capture_inflight, 1 );
+   threadpool_newJob( gl_captureWorker, job );
+   capture_frame++;
+}
+
+/**
+ * @brief Queues the current frame's readback while capture mode is on.
+ *
+ * Meant to be called once per frame after rendering, before the buffer
+ * swap.
+ */
+void gl_captureFrame (void)
+{
+   if (!capture_active)
+      return;
+
+   /* Make room in the ring first. */
+   if (capture_filled == CAPTURE_RING)
+      gl_captureHarvest();
+
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, capture_pbo[capture_head] );
+   glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+   glReadPixels( 0, 0, capture_w, capture_h, GL_RGB, GL_UNSIGNED_BYTE, NULL );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+   capture_head = (capture_head + 1) % CAPTURE_RING;
+   capture_filled++;
+
+   gl_checkErr();
+}
+
+/**
+ * @brief Toggles continuous frame capture.
+ *
+ *    @return 1 if capture is now running, 0 if it stopped (or failed to start).
+ */
+int gl_captureToggle (void)
+{
+   if (!capture_active) {
+      if (PHYSFS_mkdir( "screenshots" ) == 0) {
+         WARN( _("Aborting capture") );
+         return 0;
+      }
+      capture_w = gl_screen.rw;
+      capture_h = gl_screen.rh;
+      glGenBuffers( CAPTURE_RING, capture_pbo );
+      for (int i=0; i<CAPTURE_RING; i++) {
+         glBindBuffer( GL_PIXEL_PACK_BUFFER, capture_pbo[i] );
+         glBufferData( GL_PIXEL_PACK_BUFFER, 3 * capture_w*capture_h,
+               NULL, GL_STREAM_READ );
+      }
+      glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+      capture_head    = 0;
+      capture_filled  = 0;
+      capture_frame   = 0;
+      capture_dropped = 0;
+      capture_session++;
+      SDL_AtomicSet( &capture_inflight, 0 );
+      capture_active  = 1;
+      DEBUG( _("Starting capture [%03d]..."), capture_session );
+   }
+   else {
+      while (capture_filled > 0)
+         gl_captureHarvest();
+      glDeleteBuffers( CAPTURE_RING, capture_pbo );
+      capture_active = 0;
+      DEBUG( _("Capture stopped: %d frames written, %d dropped."),
+            capture_frame - capture_dropped, capture_dropped );
+   }
+   gl_checkErr();
+   return capture_active;
 }
 
 /*
@@ -289,6 +525,8 @@ static int gl_createWindow( unsigned int flags )
       gl_screen.fbo[i]     = GL_INVALID_VALUE;
       gl_screen.fbo_tex[i] = GL_INVALID_VALUE;
    }
+   gl_screen.scene_fbo     = GL_INVALID_VALUE;
+   gl_screen.scene_fbo_tex = GL_INVALID_VALUE;
    SDL_GL_GetAttribute( SDL_GL_DEPTH_SIZE, &gl_screen.depth );
    gl_activated = 1; /* Opengl is now activated. */
 
@@ -497,6 +735,24 @@ void gl_resize (void)
       gl_fboCreate( &gl_screen.fbo[i], &gl_screen.fbo_tex[i], gl_screen.rw, gl_screen.rh );
    }
 
+   /* Reduced-resolution scene framebuffer; the world renders here and is
+    * sharpened back up to native resolution while the GUI stays native. */
+   if (gl_screen.scene_fbo != GL_INVALID_VALUE) {
+      glDeleteFramebuffers( 1, &gl_screen.scene_fbo );
+      glDeleteTextures( 1, &gl_screen.scene_fbo_tex );
+      gl_screen.scene_fbo     = GL_INVALID_VALUE;
+      gl_screen.scene_fbo_tex = GL_INVALID_VALUE;
+   }
+   if (conf.render_scale < 1.) {
+      double rs = CLAMP( 0.25, 1., conf.render_scale );
+      gl_screen.scene_rw = round( gl_screen.rw * rs );
+      gl_screen.scene_rh = round( gl_screen.rh * rs );
+      gl_fboCreate( &gl_screen.scene_fbo, &gl_screen.scene_fbo_tex,
+            gl_screen.scene_rw, gl_screen.scene_rh );
+   }
+   gl_screen.cvw = gl_screen.rw;
+   gl_screen.cvh = gl_screen.rh;
+
    gl_checkErr();
 }
 
@@ -632,6 +888,11 @@ void gl_colorblind( int enable )
  */
 void gl_exit (void)
 {
+   /* Don't lose a screenshot that hasn't been handed off yet. */
+   gl_screenshotPump();
+   if (capture_active)
+      gl_captureToggle();
+
    for (int i=0; i<OPENGL_NUM_FBOS; i++) {
       if (gl_screen.fbo[i] != GL_INVALID_VALUE) {
          glDeleteFramebuffers( 1, &gl_screen.fbo[i] );
@@ -640,6 +901,12 @@ void gl_exit (void)
          gl_screen.fbo_tex[i] = GL_INVALID_VALUE;
       }
    }
+   if (gl_screen.scene_fbo != GL_INVALID_VALUE) {
+      glDeleteFramebuffers( 1, &gl_screen.scene_fbo );
+      glDeleteTextures( 1, &gl_screen.scene_fbo_tex );
+      gl_screen.scene_fbo = GL_INVALID_VALUE;
+      gl_screen.scene_fbo_tex = GL_INVALID_VALUE;
+   }
 
    /* Exit the OpenGL subsystems. */
    gl_exitRender();
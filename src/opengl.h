@@ -66,6 +66,12 @@ typedef struct glInfo_ {
    GLuint current_fbo; /**< Current framebuffer. */
    GLuint fbo[OPENGL_NUM_FBOS]; /**< Framebuffers. */
    GLuint fbo_tex[OPENGL_NUM_FBOS]; /**< Texture for framebuffers. */
+   GLuint scene_fbo; /**< Reduced-resolution scene framebuffer (conf.render_scale < 1.). */
+   GLuint scene_fbo_tex; /**< Texture backing the scene framebuffer. */
+   int scene_rw; /**< Scene framebuffer width in real pixels. */
+   int scene_rh; /**< Scene framebuffer height in real pixels. */
+   int cvw; /**< Viewport width of the current render target in real pixels. */
+   int cvh; /**< Viewport height of the current render target in real pixels. */
 } glInfo;
 extern glInfo gl_screen; /* local structure set with gl_init and co */
 
@@ -111,6 +117,9 @@ void gl_colorblind( int enable );
 GLint gl_stringToFilter( const char *s );
 GLint gl_stringToClamp( const char *s );
 void gl_screenshot( const char *filename );
+void gl_screenshotPump (void);
+void gl_captureFrame (void);
+int gl_captureToggle (void);
 #ifdef DEBUGGING
 #define gl_checkErr()   gl_checkHandleError( __func__, __LINE__ )
 void gl_checkHandleError( const char *func, int line );
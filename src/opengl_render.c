@@ -29,6 +29,7 @@
 
 #include "opengl_render.h"
 
+#include "array.h"
 #include "camera.h"
 #include "conf.h"
 #include "gui.h"
@@ -48,9 +49,54 @@ static gl_vbo *gl_triangleVBO = 0;
 static int gl_renderVBOtexOffset = 0; /**< VBO texture offset. */
 static int gl_renderVBOcolOffset = 0; /**< VBO colour offset. */
 
+/*
+ * Sprite batching state. Quads are accumulated per texture and only
+ * submitted when the texture changes or gl_renderSpriteBatchFlush() is
+ * called, cutting draw calls and state changes in busy systems.
+ */
+#define BATCH_VERTEX_FLOATS   8 /**< x, y, u, v, r, g, b, a. */
+static gl_vbo *gl_batchVBO = NULL;     /**< Streaming VBO for batched quads. */
+static GLsizei gl_batchVBOsize = 0;    /**< Current size of the batch VBO. */
+static GLfloat *gl_batchData = NULL;   /**< Array (array.h): pending vertex data. */
+static GLuint gl_batchTex = 0;         /**< Texture of the pending batch. */
+
+/*
+ * Cached GL state. Most draws in a frame bind a program that is already
+ * bound, so gl_useProgram() tracks the last binding and skips repeats.
+ * Anything changing the binding behind the cache's back (raw GL calls,
+ * external libraries) must call gl_stateInvalidate() afterwards, as must
+ * glDeleteProgram call sites since the driver can reuse program ids.
+ */
+static GLuint gl_stateProgram = 0;   /**< Last program bound through the cache. */
+static int gl_stateKnown = 0;        /**< Whether the cached state is valid. */
+
+/**
+ * @brief Binds a shader program, skipping the call when already bound.
+ *
+ *    @param program Program to bind.
+ */
+void gl_useProgram( GLuint program )
+{
+   if (gl_stateKnown && (program == gl_stateProgram))
+      return;
+   glUseProgram( program );
+   gl_stateProgram = program;
+   gl_stateKnown   = 1;
+}
+
+/**
+ * @brief Invalidates the cached GL state.
+ *
+ * Must be called after changing state outside of the cached setters.
+ */
+void gl_stateInvalidate (void)
+{
+   gl_stateKnown = 0;
+}
+
 void gl_beginSolidProgram(mat4 projection, const glColour *c)
 {
-   glUseProgram(shaders.solid.program);
+   gl_useProgram(shaders.solid.program);
    glEnableVertexAttribArray(shaders.solid.vertex);
    gl_uniformColor(shaders.solid.color, c);
    gl_uniformMat4(shaders.solid.projection, &projection);
@@ -59,13 +105,13 @@ void gl_beginSolidProgram(mat4 projection, const glColour *c)
 void gl_endSolidProgram (void)
 {
    glDisableVertexAttribArray(shaders.solid.vertex);
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 }
 
 void gl_beginSmoothProgram(mat4 projection)
 {
-   glUseProgram(shaders.smooth.program);
+   gl_useProgram(shaders.smooth.program);
    glEnableVertexAttribArray(shaders.smooth.vertex);
    glEnableVertexAttribArray(shaders.smooth.vertex_color);
    gl_uniformMat4(shaders.smooth.projection, &projection);
@@ -74,7 +120,7 @@ void gl_beginSmoothProgram(mat4 projection)
 void gl_endSmoothProgram() {
    glDisableVertexAttribArray(shaders.smooth.vertex);
    glDisableVertexAttribArray(shaders.smooth.vertex_color);
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 }
 
@@ -146,7 +192,7 @@ void gl_renderRectH( const mat4 *H, const glColour *c, int filled )
  */
 void gl_renderCross( double x, double y, double r, const glColour *c )
 {
-   glUseProgram(shaders.crosshairs.program);
+   gl_useProgram(shaders.crosshairs.program);
    glUniform1f(shaders.crosshairs.paramf, 1.); /* No outline. */
    gl_renderShader( x, y, r, r, 0., &shaders.crosshairs, c, 1 );
 }
@@ -200,7 +246,7 @@ void gl_renderTextureRaw( GLuint texture, uint8_t flags,
    double hw, hh;
    mat4 projection, tex_mat;
 
-   glUseProgram(shaders.texture.program);
+   gl_useProgram(shaders.texture.program);
 
    /* Bind the texture. */
    glBindTexture( GL_TEXTURE_2D, texture);
@@ -247,7 +293,7 @@ void gl_renderTextureRaw( GLuint texture, uint8_t flags,
    /* anything failed? */
    gl_checkErr();
 
-   glUseProgram(0);
+   gl_useProgram(0);
 }
 
 /**
@@ -270,7 +316,9 @@ void gl_renderTexture( const glTexture* texture,
       double tx, double ty, double tw, double th,
       const glColour *c, double angle )
 {
-   gl_renderTextureRaw( texture->texture, texture->flags, x, y, w, h, tx, ty, tw, th, c, angle );
+   /* Atlas-backed textures live in a sub-region of a shared page. */
+   gl_renderTextureRaw( texture->texture, texture->flags, x, y, w, h,
+         tx + texture->tox, ty + texture->toy, tw, th, c, angle );
 }
 
 /**
@@ -314,7 +362,7 @@ void gl_renderTextureInterpolate(  const glTexture* ta,
 
    mat4 projection, tex_mat;
 
-   glUseProgram(shaders.texture_interpolate.program);
+   gl_useProgram(shaders.texture_interpolate.program);
 
    /* Bind the textures. */
    glActiveTexture( GL_TEXTURE1 );
@@ -356,7 +404,7 @@ void gl_renderTextureInterpolate(  const glTexture* ta,
    /* anything failed? */
    gl_checkErr();
 
-   glUseProgram(0);
+   gl_useProgram(0);
 }
 
 /**
@@ -478,6 +526,237 @@ void gl_renderSprite( const glTexture* sprite, double bx, double by,
  *    @param sy Y position of the sprite to use.
  *    @param c Colour to use (modifies texture colour).
  */
+/**
+ * @brief Queues a sprite quad into the current batch.
+ *
+ * Draw order is preserved within the batch; callers interleaving other
+ * draw paths must call gl_renderSpriteBatchFlush() first so those draws
+ * don't jump ahead of queued quads.
+ *
+ *    @param sprite Sprite to add.
+ *    @param bx X position of the texture relative to the player.
+ *    @param by Y position of the texture relative to the player.
+ *    @param sx X position of the sprite to use.
+ *    @param sy Y position of the sprite to use.
+ *    @param c Colour to use (modifies texture colour).
+ */
+void gl_renderSpriteBatch( const glTexture* sprite, double bx, double by,
+      int sx, int sy, const glColour* c )
+{
+   double x,y, w,h, tx,ty, z;
+   GLfloat x0,y0,x1,y1, u0,v0,u1,v1;
+   GLfloat *v;
+
+   /* Translate coords. */
+   z = cam_getZoom();
+   gl_gameToScreenCoords( &x, &y, bx - sprite->sw/2., by - sprite->sh/2. );
+
+   /* Scaled sprite dimensions. */
+   w = sprite->sw*z;
+   h = sprite->sh*z;
+
+   /* check if inbounds */
+   if ((x < -w) || (x > SCREEN_W+w) ||
+         (y < -h) || (y > SCREEN_H+h))
+      return;
+
+   /* texture coords */
+   tx = sprite->sw*(double)(sx)/sprite->w + sprite->tox;
+   ty = sprite->sh*(sprite->sy-(double)sy-1)/sprite->h + sprite->toy;
+
+   /* Submit pending quads if the texture changes. */
+   if ((gl_batchTex != sprite->texture) && (array_size(gl_batchData) > 0))
+      gl_renderSpriteBatchFlush();
+   gl_batchTex = sprite->texture;
+
+   if (c == NULL)
+      c = &cWhite;
+
+   x0 = (GLfloat) x;
+   y0 = (GLfloat) y;
+   x1 = (GLfloat)(x + w);
+   y1 = (GLfloat)(y + h);
+   u0 = (GLfloat) tx;
+   u1 = (GLfloat)(tx + sprite->srw);
+   /* Bake the vertical flip the uniform path does with tex_mat. */
+   if (sprite->flags & OPENGL_TEX_VFLIP) {
+      v0 = (GLfloat)(1. - ty);
+      v1 = (GLfloat)(1. - (ty + sprite->srh));
+   }
+   else {
+      v0 = (GLfloat) ty;
+      v1 = (GLfloat)(ty + sprite->srh);
+   }
+
+   if (gl_batchData == NULL)
+      gl_batchData = array_create( GLfloat );
+
+   /* Two triangles per quad. */
+   array_resize( &gl_batchData, array_size(gl_batchData) + 6*BATCH_VERTEX_FLOATS );
+   v = &gl_batchData[ array_size(gl_batchData) - 6*BATCH_VERTEX_FLOATS ];
+#define BATCH_VERT( X, Y, U, V ) \
+   do { \
+      *v++ = (X); *v++ = (Y); *v++ = (U); *v++ = (V); \
+      *v++ = c->r; *v++ = c->g; *v++ = c->b; *v++ = c->a; \
+   } while (0)
+   BATCH_VERT( x0, y0, u0, v0 );
+   BATCH_VERT( x1, y0, u1, v0 );
+   BATCH_VERT( x1, y1, u1, v1 );
+   BATCH_VERT( x0, y0, u0, v0 );
+   BATCH_VERT( x1, y1, u1, v1 );
+   BATCH_VERT( x0, y1, u0, v1 );
+#undef BATCH_VERT
+}
+
+/**
+ * @brief Queues a scaled and rotated sprite quad into the current batch.
+ *
+ * The rotation is baked into the vertices so rotated sprites (asteroids,
+ * debris) can share the batch draw call instead of issuing one each.
+ *
+ *    @param sprite Sprite to add.
+ *    @param bx X position of the texture relative to the player.
+ *    @param by Y position of the texture relative to the player.
+ *    @param scalew Scaling of width.
+ *    @param scaleh Scaling of height.
+ *    @param angle Angle to rotate when rendering.
+ *    @param sx X position of the sprite to use.
+ *    @param sy Y position of the sprite to use.
+ *    @param c Colour to use (modifies texture colour).
+ */
+void gl_renderSpriteBatchScaleRotate( const glTexture* sprite,
+      double bx, double by,
+      double scalew, double scaleh, double angle,
+      int sx, int sy, const glColour* c )
+{
+   double x,y, w,h, tx,ty, z, cx,cy, hw,hh, sa,ca;
+   GLfloat px[4], py[4];
+   GLfloat u0,v0,u1,v1;
+   GLfloat *v;
+
+   /* Translate coords. */
+   z = cam_getZoom();
+   gl_gameToScreenCoords( &x, &y, bx - sprite->sw/2., by - sprite->sh/2. );
+
+   /* Scaled sprite dimensions. */
+   w = sprite->sw*z*scalew;
+   h = sprite->sh*z*scaleh;
+
+   /* check if inbounds */
+   if ((x < -w) || (x > SCREEN_W+w) ||
+         (y < -h) || (y > SCREEN_H+h))
+      return;
+
+   /* texture coords */
+   tx = sprite->sw*(double)(sx)/sprite->w + sprite->tox;
+   ty = sprite->sh*(sprite->sy-(double)sy-1)/sprite->h + sprite->toy;
+
+   /* Submit pending quads if the texture changes. */
+   if ((gl_batchTex != sprite->texture) && (array_size(gl_batchData) > 0))
+      gl_renderSpriteBatchFlush();
+   gl_batchTex = sprite->texture;
+
+   if (c == NULL)
+      c = &cWhite;
+
+   /* Rotate the corners around the sprite center, like the uniform path
+    * does with the projection matrix. */
+   hw = w/2.;
+   hh = h/2.;
+   cx = x + hw;
+   cy = y + hh;
+   sa = sin(angle);
+   ca = cos(angle);
+   px[0] = (GLfloat)(cx - hw*ca + hh*sa);
+   py[0] = (GLfloat)(cy - hw*sa - hh*ca);
+   px[1] = (GLfloat)(cx + hw*ca + hh*sa);
+   py[1] = (GLfloat)(cy + hw*sa - hh*ca);
+   px[2] = (GLfloat)(cx + hw*ca - hh*sa);
+   py[2] = (GLfloat)(cy + hw*sa + hh*ca);
+   px[3] = (GLfloat)(cx - hw*ca - hh*sa);
+   py[3] = (GLfloat)(cy - hw*sa + hh*ca);
+
+   u0 = (GLfloat) tx;
+   u1 = (GLfloat)(tx + sprite->srw);
+   /* Bake the vertical flip the uniform path does with tex_mat. */
+   if (sprite->flags & OPENGL_TEX_VFLIP) {
+      v0 = (GLfloat)(1. - ty);
+      v1 = (GLfloat)(1. - (ty + sprite->srh));
+   }
+   else {
+      v0 = (GLfloat) ty;
+      v1 = (GLfloat)(ty + sprite->srh);
+   }
+
+   if (gl_batchData == NULL)
+      gl_batchData = array_create( GLfloat );
+
+   /* Two triangles per quad. */
+   array_resize( &gl_batchData, array_size(gl_batchData) + 6*BATCH_VERTEX_FLOATS );
+   v = &gl_batchData[ array_size(gl_batchData) - 6*BATCH_VERTEX_FLOATS ];
+#define BATCH_VERT( X, Y, U, V ) \
+   do { \
+      *v++ = (X); *v++ = (Y); *v++ = (U); *v++ = (V); \
+      *v++ = c->r; *v++ = c->g; *v++ = c->b; *v++ = c->a; \
+   } while (0)
+   BATCH_VERT( px[0], py[0], u0, v0 );
+   BATCH_VERT( px[1], py[1], u1, v0 );
+   BATCH_VERT( px[2], py[2], u1, v1 );
+   BATCH_VERT( px[0], py[0], u0, v0 );
+   BATCH_VERT( px[2], py[2], u1, v1 );
+   BATCH_VERT( px[3], py[3], u0, v1 );
+#undef BATCH_VERT
+}
+
+/**
+ * @brief Submits all the queued sprite quads in one draw call.
+ */
+void gl_renderSpriteBatchFlush (void)
+{
+   GLsizei size, nverts;
+
+   nverts = array_size(gl_batchData) / BATCH_VERTEX_FLOATS;
+   if (nverts == 0)
+      return;
+
+   /* (Re)allocate the streaming VBO if the batch outgrew it. */
+   size = array_size(gl_batchData) * sizeof(GLfloat);
+   if ((gl_batchVBO == NULL) || (size > gl_batchVBOsize)) {
+      if (gl_batchVBO != NULL)
+         gl_vboDestroy( gl_batchVBO );
+      gl_batchVBO = gl_vboCreateStream( size, gl_batchData );
+      gl_batchVBOsize = size;
+   }
+   else
+      gl_vboData( gl_batchVBO, size, gl_batchData );
+
+   gl_useProgram( shaders.spritebatch.program );
+   glBindTexture( GL_TEXTURE_2D, gl_batchTex );
+
+   glEnableVertexAttribArray( shaders.spritebatch.vertex );
+   glEnableVertexAttribArray( shaders.spritebatch.tex_uv );
+   glEnableVertexAttribArray( shaders.spritebatch.vertex_color );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.spritebatch.vertex,
+         0, 2, GL_FLOAT, BATCH_VERTEX_FLOATS*sizeof(GLfloat) );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.spritebatch.tex_uv,
+         2*sizeof(GLfloat), 2, GL_FLOAT, BATCH_VERTEX_FLOATS*sizeof(GLfloat) );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.spritebatch.vertex_color,
+         4*sizeof(GLfloat), 4, GL_FLOAT, BATCH_VERTEX_FLOATS*sizeof(GLfloat) );
+
+   gl_uniformMat4( shaders.spritebatch.projection, &gl_view_matrix );
+
+   glDrawArrays( GL_TRIANGLES, 0, nverts );
+
+   glDisableVertexAttribArray( shaders.spritebatch.vertex );
+   glDisableVertexAttribArray( shaders.spritebatch.tex_uv );
+   glDisableVertexAttribArray( shaders.spritebatch.vertex_color );
+   gl_useProgram(0);
+   gl_checkErr();
+
+   array_resize( &gl_batchData, 0 );
+   gl_batchTex = 0;
+}
+
 void gl_renderSpriteScale( const glTexture* sprite, double bx, double by,
       double scalew, double scaleh,
       int sx, int sy, const glColour* c )
@@ -912,7 +1191,7 @@ void gl_renderShaderH( const SimpleShader *shd, const mat4 *H, const glColour *c
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
 
    glDisableVertexAttribArray(shd->vertex);
-   glUseProgram(0);
+   gl_useProgram(0);
    gl_checkErr();
 }
 
@@ -948,11 +1227,12 @@ void gl_renderCircleH( const mat4 *H, const glColour *c, int filled )
 {
    // TODO handle shearing and different x/y scaling
    GLfloat r = H->m[0][0] / gl_view_matrix.m[0][0];
+   /* Filled and hollow are separate precompiled variants. */
+   const SimpleShader *shd = filled ? &shaders.circle_filled : &shaders.circle;
 
-   glUseProgram( shaders.circle.program );
-   glUniform2f( shaders.circle.dimensions, r, r );
-   glUniform1i( shaders.circle.parami, filled );
-   gl_renderShaderH( &shaders.circle, H, c, 1 );
+   gl_useProgram( shd->program );
+   glUniform2f( shd->dimensions, r, r );
+   gl_renderShaderH( shd, H, c, 1 );
 }
 
 /**
@@ -970,7 +1250,7 @@ void gl_renderLine( double x1, double y1,
    double a = atan2( y2-y1, x2-x1 );
    double s = hypotf( x2-x1, y2-y1 );
 
-   glUseProgram(shaders.sdfsolid.program);
+   gl_useProgram(shaders.sdfsolid.program);
    glUniform1f(shaders.sdfsolid.paramf, 1.); /* No outline. */
    gl_renderShader( (x1+x2)/2., (y1+y2)/2., s/2.+0.5, 1.0, a, &shaders.sdfsolid, c, 1 );
 }
@@ -1084,4 +1364,10 @@ void gl_exitRender (void)
    gl_vboDestroy( gl_lineVBO );
    gl_vboDestroy( gl_triangleVBO );
    gl_renderVBO = NULL;
+   if (gl_batchVBO != NULL) {
+      gl_vboDestroy( gl_batchVBO );
+      gl_batchVBO = NULL;
+   }
+   array_free( gl_batchData );
+   gl_batchData = NULL;
 }
@@ -42,6 +42,15 @@ void gl_renderTextureInterpolate(  const glTexture* ta,
 void gl_renderSprite( const glTexture* sprite,
       double bx, double by,
       int sx, int sy, const glColour *c );
+/* batched sprite submission; flush before interleaving other draws */
+void gl_renderSpriteBatch( const glTexture* sprite,
+      double bx, double by,
+      int sx, int sy, const glColour *c );
+void gl_renderSpriteBatchScaleRotate( const glTexture* sprite,
+      double bx, double by,
+      double scalew, double scaleh, double angle,
+      int sx, int sy, const glColour *c );
+void gl_renderSpriteBatchFlush (void);
 void gl_renderSpriteScale( const glTexture* sprite, double bx, double by,
       double scalew, double scaleh,
       int sx, int sy, const glColour* c );
@@ -89,6 +98,10 @@ void gl_renderScaleAspect( const glTexture* texture,
 void gl_renderStatic( const glTexture* texture,
       double bx, double by, const glColour *c );
 
+/* Cached GL state; use instead of raw binds so redundant calls get skipped. */
+void gl_useProgram( GLuint program );
+void gl_stateInvalidate (void);
+
 extern gl_vbo *gl_squareVBO;
 extern gl_vbo *gl_circleVBO;
 void gl_beginSolidProgram(mat4 projection, const glColour *c);
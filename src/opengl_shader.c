@@ -9,13 +9,28 @@
 
 #include "conf.h"
 #include "log.h"
+#include "md5.h"
 #include "ndata.h"
+#include "nfile.h"
 #include "nstring.h"
 #include "opengl.h"
 
 #define GLSL_VERSION    "#version 140\n\n" /**< Version to use for all shaders. */
 #define GLSL_SUBROUTINE "#define HAS_GL_ARB_shader_subroutine 1\n" /**< Has subroutines. */
 
+/* GL_ARB_get_program_binary and GL_KHR_parallel_shader_compile postdate our
+ * generated GL 3.1 loader, so the enums and entry points are not in glad.h
+ * and we resolve them at runtime in gl_program_cacheInit. */
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+static void (APIENTRYP nglGetProgramBinary)( GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary ) = NULL;
+static void (APIENTRYP nglProgramBinary)( GLuint program, GLenum binaryFormat, const void *binary, GLsizei length ) = NULL;
+static int gl_program_binary_usable = 0; /**< Whether the driver can save and reload program binaries. */
+
 /*
  * Prototypes.
  */
@@ -27,6 +42,10 @@ static GLuint gl_shader_compile( GLuint type, const char *buf,
 static int gl_program_link( GLuint program );
 static GLuint gl_program_make( GLuint vertex_shader, GLuint fragment_shader );
 static int gl_log_says_anything( const char* log );
+static void gl_program_cacheInit (void);
+static void gl_program_cachePath( char path[PATH_MAX], const char *vert, size_t vert_size, const char *frag, size_t frag_size );
+static GLuint gl_program_cacheLoad( const char *path );
+static void gl_program_cacheSave( const char *path, GLuint program );
 
 /**
  * @brief Loads a GLSL file with some simple preprocessing like adding #version and handling #include.
@@ -218,25 +237,184 @@ static int gl_program_link( GLuint program )
 }
 
 /**
- * @brief Loads a vertex and fragment shader from files.
+ * @brief Resolves the optional program binary and parallel compile extensions.
+ *
+ * Called lazily from the first program build so it runs after the context
+ * exists without having to touch gl_init.
+ */
+static void gl_program_cacheInit (void)
+{
+   static int initialized = 0;
+   if (initialized)
+      return;
+   initialized = 1;
+
+   if (SDL_GL_ExtensionSupported( "GL_ARB_get_program_binary" )) {
+      GLint nformats = 0;
+      nglGetProgramBinary = (void (APIENTRYP)( GLuint, GLsizei, GLsizei*, GLenum*, void* )) SDL_GL_GetProcAddress( "glGetProgramBinary" );
+      nglProgramBinary    = (void (APIENTRYP)( GLuint, GLenum, const void*, GLsizei )) SDL_GL_GetProcAddress( "glProgramBinary" );
+      glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &nformats );
+      /* Some drivers expose the extension but support no formats. */
+      gl_program_binary_usable = (nglGetProgramBinary != NULL) &&
+            (nglProgramBinary != NULL) && (nformats > 0);
+   }
+
+   /* Let the driver compile on background threads when it can; harmless
+    * no-op otherwise. */
+   if (SDL_GL_ExtensionSupported( "GL_KHR_parallel_shader_compile" )) {
+      void (APIENTRYP maxthreads)( GLuint count ) =
+            (void (APIENTRYP)( GLuint )) SDL_GL_GetProcAddress( "glMaxShaderCompilerThreadsKHR" );
+      if (maxthreads != NULL)
+         maxthreads( 0xFFFFFFFF ); /* "As many as you like." */
+   }
+   gl_checkErr();
+}
+
+/**
+ * @brief Computes the cache file path for a preprocessed shader pair.
+ *
+ * The key hashes the fully preprocessed sources plus the renderer and
+ * driver version strings, since program binaries are driver-specific.
+ */
+static void gl_program_cachePath( char path[PATH_MAX], const char *vert, size_t vert_size, const char *frag, size_t frag_size )
+{
+   md5_state_t md5;
+   md5_byte_t md5val[16];
+   char digest[33];
+   const char *renderer = (const char*) glGetString( GL_RENDERER );
+   const char *version  = (const char*) glGetString( GL_VERSION );
+
+   md5_init( &md5 );
+   md5_append( &md5, (const md5_byte_t*)vert, vert_size );
+   md5_append( &md5, (const md5_byte_t*)frag, frag_size );
+   if (renderer != NULL)
+      md5_append( &md5, (const md5_byte_t*)renderer, strlen(renderer) );
+   if (version != NULL)
+      md5_append( &md5, (const md5_byte_t*)version, strlen(version) );
+   md5_finish( &md5, md5val );
+   for (int i=0; i<16; i++)
+      snprintf( &digest[i*2], 3, "%02x", md5val[i] );
+   snprintf( path, PATH_MAX, "%sshaders/%s", nfile_cachePath(), digest );
+}
+
+/**
+ * @brief Tries to build a program from a cached binary.
+ *
+ *    @param[in] path Cache file to load.
+ *    @return The linked program or 0 on a cache miss.
+ */
+static GLuint gl_program_cacheLoad( const char *path )
+{
+   GLuint program;
+   GLint link_status;
+   GLenum format;
+   size_t filesize;
+   char *data;
+
+   if (!gl_program_binary_usable || !nfile_fileExists( path ))
+      return 0;
+   data = nfile_readFile( &filesize, path );
+   if (data == NULL)
+      return 0;
+   if (filesize <= sizeof(GLenum)) {
+      free( data );
+      return 0;
+   }
+
+   /* The binary format enum is stored ahead of the driver blob. */
+   memcpy( &format, data, sizeof(GLenum) );
+   program = glCreateProgram();
+   nglProgramBinary( program, format, &data[sizeof(GLenum)], filesize-sizeof(GLenum) );
+   free( data );
+
+   /* Stale binaries (driver updates and the like) just fail to link;
+    * treat that as a miss and recompile below. */
+   glGetProgramiv( program, GL_LINK_STATUS, &link_status );
+   if (link_status != GL_TRUE) {
+      glDeleteProgram( program );
+      gl_stateInvalidate(); /* Program ids can get reused. */
+      while (glGetError() != GL_NO_ERROR)
+         ; /* Swallow errors from the rejected binary. */
+      return 0;
+   }
+   gl_checkErr();
+   return program;
+}
+
+/**
+ * @brief Stores a freshly linked program's binary in the cache.
+ *
+ *    @param[in] path Cache file to write.
+ *    @param[in] program Linked program to store.
+ */
+static void gl_program_cacheSave( const char *path, GLuint program )
+{
+   GLint len;
+   GLsizei n = 0;
+   GLenum format;
+   char *data, dirpath[PATH_MAX];
+
+   if (!gl_program_binary_usable)
+      return;
+   glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &len );
+   if (len <= 0)
+      return;
+   data = malloc( sizeof(GLenum)+len );
+   nglGetProgramBinary( program, len, &n, &format, &data[sizeof(GLenum)] );
+   if (n <= 0) {
+      free( data );
+      return;
+   }
+   memcpy( data, &format, sizeof(GLenum) );
+   snprintf( dirpath, sizeof(dirpath), "%sshaders/", nfile_cachePath() );
+   nfile_dirMakeExist( dirpath );
+   nfile_writeFile( data, sizeof(GLenum)+n, path );
+   free( data );
+   gl_checkErr();
+}
+
+/**
+ * @brief Loads a vertex and fragment shader from files with extra defines.
+ *
+ * Meant for pre-generating specialized variants of shaders that would
+ * otherwise branch on a uniform at runtime: each feature combination
+ * compiles to its own program with the branches folded away, and the
+ * draw site just picks the right program.
  *
  *    @param[in] vertfile Vertex shader filename.
  *    @param[in] fragfile Fragment shader filename.
+ *    @param[in] defines "#define ...\n" block to prepend, or NULL.
  *    @return The shader compiled program or 0 on failure.
  */
-GLuint gl_program_vert_frag( const char *vertfile, const char *fragfile )
+GLuint gl_program_vert_frag_defines( const char *vertfile, const char *fragfile, const char *defines )
 {
-   char *vert_str, *frag_str, prepend[STRMAX];
+   char *vert_str, *frag_str, prepend[STRMAX], cachefile[PATH_MAX];
    size_t vert_size, frag_size;
    GLuint vertex_shader, fragment_shader, program;
 
+   gl_program_cacheInit();
+
    strncpy( prepend, GLSL_VERSION, sizeof(prepend)-1 );
    if (gl_has( OPENGL_SUBROUTINES ))
       strncat( prepend, GLSL_SUBROUTINE, sizeof(prepend)-strlen(prepend)-1 );
+   if (defines != NULL)
+      strncat( prepend, defines, sizeof(prepend)-strlen(prepend)-1 );
 
    vert_str = gl_shader_loadfile( vertfile, &vert_size, prepend );
    frag_str = gl_shader_loadfile( fragfile, &frag_size, prepend );
 
+   /* Try the program binary cache first so warm startups skip the
+    * driver's compiler entirely. */
+   if (gl_program_binary_usable && (vert_str != NULL) && (frag_str != NULL)) {
+      gl_program_cachePath( cachefile, vert_str, vert_size, frag_str, frag_size );
+      program = gl_program_cacheLoad( cachefile );
+      if (program != 0) {
+         free( vert_str );
+         free( frag_str );
+         return program;
+      }
+   }
+
    vertex_shader     = gl_shader_compile( GL_VERTEX_SHADER, vert_str, vert_size, vertfile );
    fragment_shader   = gl_shader_compile( GL_FRAGMENT_SHADER, frag_str, frag_size, fragfile );
 
@@ -246,10 +424,24 @@ GLuint gl_program_vert_frag( const char *vertfile, const char *fragfile )
    program = gl_program_make( vertex_shader, fragment_shader );
    if (program==0)
       WARN(_("Failed to link vertex shader '%s' and fragment shader '%s'!"), vertfile, fragfile);
+   else if (gl_program_binary_usable)
+      gl_program_cacheSave( cachefile, program );
 
    return program;
 }
 
+/**
+ * @brief Loads a vertex and fragment shader from files.
+ *
+ *    @param[in] vertfile Vertex shader filename.
+ *    @param[in] fragfile Fragment shader filename.
+ *    @return The shader compiled program or 0 on failure.
+ */
+GLuint gl_program_vert_frag( const char *vertfile, const char *fragfile )
+{
+   return gl_program_vert_frag_defines( vertfile, fragfile, NULL );
+}
+
 /**
  * @brief Loads a vertex and fragment shader from strings.
  *
@@ -23,6 +23,7 @@
 #include "nfile.h"
 #include "nstring.h"
 #include "opengl.h"
+#include "threadpool.h"
 
 /*
  * graphic list
@@ -40,9 +41,23 @@ typedef struct glTexList_ {
     * avoid this increase of memory (without sharing other parameters). */
    int sx; /**< X sprites */
    int sy; /**< Y sprites */
+   size_t vram; /**< Estimated VRAM use in bytes. */
+   unsigned int lru; /**< Stamp of the last release, for eviction order. */
 } glTexList;
 static glTexList* texture_list = NULL; /**< Texture list. */
 
+/*
+ * Texture residency cache. Entries whose reference count hits zero are
+ * not deleted right away but kept resident up to conf.texture_cache MiB,
+ * so touring back through systems rehits them instead of decoding from
+ * disk again. When over budget the least recently released entries get
+ * evicted; referenced textures are never touched. A later request for an
+ * evicted texture just goes through the regular (possibly async) load
+ * path again.
+ */
+static size_t tex_cache_used = 0;      /**< Bytes held by unreferenced entries. */
+static unsigned int tex_cache_stamp = 0; /**< Monotonic release counter. */
+
 /*
  * prototypes
  */
@@ -50,6 +65,7 @@ static glTexList* texture_list = NULL; /**< Texture list. */
 static int SDL_IsTrans( SDL_Surface* s, int x, int y );
 static uint8_t* SDL_MapTrans( SDL_Surface* s, int w, int h );
 static size_t gl_transSize( const int w, const int h );
+static uint8_t* gl_transCoarse( const uint8_t *trans, const int w, const int h );
 /* glTexture */
 static GLuint gl_texParameters( unsigned int flags );
 static GLuint gl_loadSurface( SDL_Surface* surface, unsigned int flags, int freesur );
@@ -58,6 +74,15 @@ static glTexture* gl_loadNewImageRWops( const char *path, SDL_RWops *rw, unsigne
 /* List. */
 static glTexture* gl_texExists( const char* path, int sx, int sy );
 static int gl_texAdd( glTexture *tex, int sx, int sy );
+static void gl_texListFree( glTexList *cur, glTexList *last );
+static void gl_texCacheTrim (void);
+static glTexture* gl_loadNewImageAsync( const char *path, unsigned int flags,
+      void (*done)( glTexture*, void* ), void *done_data );
+static int gl_texAsyncWorker( void *data );
+static GLuint gl_loadSurfacePBO( SDL_Surface *surface, unsigned int flags );
+/* Atlas. */
+static glTexture* gl_loadNewImageAtlas( const char *path, unsigned int flags );
+static int gl_atlasAlloc( int w, int h, int *page, int *x, int *y );
 
 /**
  * @brief Checks to see if a position of the surface is transparent.
@@ -156,6 +181,34 @@ static size_t gl_transSize( const int w, const int h )
    return w*h/8 + ((w*h%8)?1:0);
 }
 
+/**
+ * @brief Builds the coarse transparency map from the per-pixel one.
+ *
+ * One bit per 8x8 pixel block, set when any pixel in the block is opaque;
+ *  collision tests reject whole blocks through it before descending to
+ *  pixels. Cheap enough to derive on every load, so it is not cached.
+ *
+ *    @param trans Per-pixel transparency map.
+ *    @param w Width of the image.
+ *    @param h Height of the image.
+ *    @return Newly allocated coarse map.
+ */
+static uint8_t* gl_transCoarse( const uint8_t *trans, const int w, const int h )
+{
+   int cw = (w+7)/8, ch = (h+7)/8;
+   uint8_t *ct = calloc( gl_transSize( cw, ch ), 1 );
+   for (int y=0; y<h; y++) {
+      for (int x=0; x<w; x++) {
+         int i = y*w + x;
+         if (trans[ i/8 ] & (1 << (i%8))) {
+            int ci = (y/8)*cw + (x/8);
+            ct[ ci/8 ] |= 1 << (ci%8);
+         }
+      }
+   }
+   return ct;
+}
+
 /**
  * @brief Sets default texture parameters.
  */
@@ -424,7 +477,8 @@ glTexture* gl_loadImagePadTrans( const char *name, SDL_Surface* surface, SDL_RWo
       texture = gl_loadImagePad( name, surface, flags, w, h, sx, sy, freesur );
    else if (freesur)
       SDL_FreeSurface( surface );
-   texture->trans = trans;
+   texture->trans  = trans;
+   texture->ctrans = gl_transCoarse( trans, w, h );
    return texture;
 }
 
@@ -523,6 +577,10 @@ static glTexture* gl_texExists( const char* path, int sx, int sy )
       if ((cur->sx!=sx) || (cur->sy!=sy))
          continue;
 
+      /* Resurrecting a cached, unreferenced entry. */
+      if (cur->used == 0)
+         tex_cache_used -= cur->vram;
+
       /* Use new texture. */
       cur->used++;
       return cur->tex;
@@ -545,6 +603,11 @@ static int gl_texAdd( glTexture *tex, int sx, int sy )
    new->tex  = tex;
    new->sx   = sx;
    new->sy   = sy;
+   new->lru  = 0;
+   /* RGBA8, plus a third for the mipmap chain. */
+   new->vram = (size_t)(tex->w * tex->h) * 4;
+   if (tex->flags & OPENGL_TEX_MIPMAPS)
+      new->vram += new->vram / 3;
 
    if (texture_list == NULL) /* special condition - creating new list */
       texture_list = new;
@@ -576,6 +639,14 @@ glTexture* gl_newImage( const char* path, const unsigned int flags )
          return t;
    }
 
+   /* Pack into a shared atlas page if asked to. */
+   if (flags & OPENGL_TEX_ATLAS)
+      return gl_loadNewImageAtlas( path, flags );
+
+   /* Decode in the background if asked to. */
+   if (flags & OPENGL_TEX_ASYNC)
+      return gl_loadNewImageAsync( path, flags, NULL, NULL );
+
    /* Load the image */
    return gl_loadNewImage( path, flags );
 }
@@ -672,6 +743,375 @@ static glTexture* gl_loadNewImageRWops( const char *path, SDL_RWops *rw, unsigne
    return texture;
 }
 
+/*
+ * Asynchronous texture loading. The PhysFS read and image decode run on
+ * threadpool workers while the caller gets a 1x1 placeholder at once;
+ * the decoded pixels are uploaded through a PBO on the main thread by
+ * gl_texAsyncPump() at the start of each frame.
+ */
+/**
+ * @brief An in-flight asynchronous texture load.
+ */
+typedef struct glTexAsync_ {
+   char *path;           /**< Path being loaded. */
+   glTexture *tex;       /**< Placeholder texture to fill in. */
+   unsigned int flags;   /**< Flags to load with. */
+   SDL_Surface *surface; /**< Decoded surface, set by the worker. */
+   void (*done)( glTexture*, void* ); /**< Optional completion callback. */
+   void *done_data;      /**< User data for the callback. */
+} glTexAsync;
+static glTexAsync **tex_async_done = NULL; /**< Array (array.h): decoded, pending upload. */
+static SDL_mutex *tex_async_lock = NULL;   /**< Protects tex_async_done. */
+static int tex_async_pending = 0;          /**< Number of jobs in flight. */
+
+/**
+ * @brief Threadpool job: read and decode an image off the main thread.
+ */
+static int gl_texAsyncWorker( void *data )
+{
+   glTexAsync *job = data;
+   SDL_RWops *rw = PHYSFSRWOPS_openRead( job->path );
+   if (rw != NULL)
+      job->surface = IMG_Load_RW( rw, 1 );
+   else
+      job->surface = NULL;
+
+   SDL_mutexP( tex_async_lock );
+   array_push_back( &tex_async_done, job );
+   SDL_mutexV( tex_async_lock );
+   return 0;
+}
+
+/**
+ * @brief Uploads a decoded surface through a pixel buffer object.
+ */
+static GLuint gl_loadSurfacePBO( SDL_Surface *surface, unsigned int flags )
+{
+   GLuint texture, pbo;
+   GLfloat param;
+   size_t size;
+
+   texture = gl_texParameters( flags );
+
+   SDL_LockSurface( surface );
+   size = (size_t)surface->pitch * surface->h;
+   glGenBuffers( 1, &pbo );
+   glBindBuffer( GL_PIXEL_UNPACK_BUFFER, pbo );
+   glBufferData( GL_PIXEL_UNPACK_BUFFER, size, surface->pixels, GL_STREAM_DRAW );
+   glPixelStorei( GL_UNPACK_ALIGNMENT, MIN( surface->pitch&-surface->pitch, 8 ) );
+   glTexImage2D( GL_TEXTURE_2D, 0, GL_SRGB_ALPHA,
+         surface->w, surface->h, 0, surface->format->Amask ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, NULL );
+   glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+   glDeleteBuffers( 1, &pbo );
+   SDL_UnlockSurface( surface );
+
+   if (flags & OPENGL_TEX_MIPMAPS) {
+      if (GLAD_GL_ARB_texture_filter_anisotropic) {
+         glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &param);
+         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, param);
+      }
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 9);
+      glGenerateMipmap(GL_TEXTURE_2D);
+   }
+
+   gl_checkErr();
+   return texture;
+}
+
+/**
+ * @brief Starts loading an image in the background.
+ *
+ * Returns a cached placeholder immediately; the pixels show up once the
+ * decode finishes and gl_texAsyncPump() uploads them.
+ */
+static glTexture* gl_loadNewImageAsync( const char *path, unsigned int flags,
+      void (*done)( glTexture*, void* ), void *done_data )
+{
+   glTexture *texture;
+   glTexAsync *job;
+   const float blank[4] = { 0., 0., 0., 0. };
+
+   if (tex_async_lock == NULL)
+      tex_async_lock = SDL_CreateMutex();
+
+   /* Set up a 1x1 transparent placeholder owning its own GL texture so
+    * it can be swapped out without touching other users. */
+   texture        = calloc( 1, sizeof(glTexture) );
+   texture->name  = strdup( path );
+   texture->w     = texture->h  = 1.;
+   texture->sx    = texture->sy = 1.;
+   texture->sw    = texture->sh = 1.;
+   texture->srw   = texture->srh = 1.;
+   texture->flags = flags;
+   texture->texture = gl_texParameters( flags );
+   glTexImage2D( GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, 1, 1, 0, GL_RGBA, GL_FLOAT, blank );
+   gl_checkErr();
+   gl_texAdd( texture, 1, 1 );
+
+   job = calloc( 1, sizeof(glTexAsync) );
+   job->path  = strdup( path );
+   job->tex   = texture;
+   job->flags = flags;
+   job->done  = done;
+   job->done_data = done_data;
+   tex_async_pending++;
+   threadpool_newJob( gl_texAsyncWorker, job );
+
+   return texture;
+}
+
+/**
+ * @brief Finishes pending asynchronous texture loads.
+ *
+ * Must be called from the main thread with the GL context current;
+ * uploads every decoded surface and fixes up the placeholder textures.
+ */
+void gl_texAsyncPump (void)
+{
+   glTexAsync **done;
+
+   if ((tex_async_pending == 0) || (tex_async_lock == NULL))
+      return;
+
+   SDL_mutexP( tex_async_lock );
+   done = tex_async_done;
+   tex_async_done = NULL;
+   SDL_mutexV( tex_async_lock );
+
+   for (int i=0; i<array_size(done); i++) {
+      glTexAsync *job = done[i];
+      glTexture *tex = job->tex;
+      int alive = 0;
+
+      tex_async_pending--;
+
+      /* Make sure the placeholder wasn't freed while we were decoding. */
+      for (glTexList *cur=texture_list; cur!=NULL; cur=cur->next)
+         if (cur->tex == tex) {
+            alive = 1;
+            break;
+         }
+
+      if (!alive || (job->surface == NULL)) {
+         if (job->surface == NULL)
+            WARN(_("Unable to load image '%s'."), job->path );
+         if (job->surface != NULL)
+            SDL_FreeSurface( job->surface );
+      }
+      else {
+         SDL_Surface *surface = job->surface;
+         glDeleteTextures( 1, &tex->texture );
+         tex->texture = gl_loadSurfacePBO( surface, job->flags | OPENGL_TEX_VFLIP );
+         tex->w   = (double) surface->w;
+         tex->h   = (double) surface->h;
+         tex->sw  = tex->w / tex->sx;
+         tex->sh  = tex->h / tex->sy;
+         tex->srw = tex->sw / tex->w;
+         tex->srh = tex->sh / tex->h;
+         SDL_FreeSurface( surface );
+         if (job->done != NULL)
+            job->done( tex, job->done_data );
+      }
+
+      free( job->path );
+      free( job );
+   }
+   array_free( done );
+}
+
+/**
+ * @brief Like gl_newImage(), but decodes in the background and invokes a
+ *        callback on the main thread once the pixels are in place.
+ *
+ *    @param path Image to load.
+ *    @param flags Flags to control image parameters.
+ *    @param done Callback run after the upload completes (may be NULL).
+ *    @param done_data User data passed to the callback.
+ *    @return Placeholder texture that gets filled in asynchronously.
+ */
+glTexture* gl_newImageAsync( const char *path, const unsigned int flags,
+      void (*done)( glTexture*, void* ), void *done_data )
+{
+   if (!(flags & OPENGL_TEX_SKIPCACHE)) {
+      glTexture *t = gl_texExists( path, 1, 1 );
+      if (t != NULL) {
+         if (done != NULL)
+            done( t, done_data );
+         return t;
+      }
+   }
+   return gl_loadNewImageAsync( path, flags | OPENGL_TEX_ASYNC, done, done_data );
+}
+
+/*
+ * Texture atlas. Small icon-sized images (outfit and commodity store
+ * graphics, GUI elements and the likes) get packed into shared pages so
+ * that the toolkit can render entire lists from a handful of binds
+ * instead of one bind per icon. Entries are never evicted; freeing an
+ * atlas-backed texture only releases the glTexture wrapper.
+ */
+#define ATLAS_PAGE_SIZE 1024  /**< Dimension of an atlas page. */
+#define ATLAS_MAX_DIM   256   /**< Larger images get their own texture. */
+#define ATLAS_PADDING   1     /**< Gap between entries to avoid filter bleed. */
+
+/**
+ * @brief An atlas page with a simple shelf allocator.
+ */
+typedef struct glTexAtlasPage_ {
+   GLuint tex; /**< The page texture. */
+   int x;      /**< Current shelf cursor. */
+   int y;      /**< Current shelf base. */
+   int rowh;   /**< Height of the current shelf. */
+} glTexAtlasPage;
+static glTexAtlasPage *tex_atlas_pages = NULL; /**< Atlas pages (array.h). */
+
+/**
+ * @brief Reserves a w x h region on an atlas page, creating pages as needed.
+ *
+ *    @param[in] w Width to reserve.
+ *    @param[in] h Height to reserve.
+ *    @param[out] page Page the region was placed on.
+ *    @param[out] x X position of the region on the page.
+ *    @param[out] y Y position of the region on the page.
+ *    @return 0 on success.
+ */
+static int gl_atlasAlloc( int w, int h, int *page, int *x, int *y )
+{
+   glTexAtlasPage *p;
+
+   if (tex_atlas_pages == NULL)
+      tex_atlas_pages = array_create( glTexAtlasPage );
+
+   /* Padding keeps linear filtering from sampling the neighbour. */
+   w += ATLAS_PADDING;
+   h += ATLAS_PADDING;
+
+   for (int i=0; i<array_size(tex_atlas_pages); i++) {
+      p = &tex_atlas_pages[i];
+
+      /* Fits on the current shelf (which may grow downwards). */
+      if ((p->x + w <= ATLAS_PAGE_SIZE) &&
+            (p->y + MAX( p->rowh, h ) <= ATLAS_PAGE_SIZE)) {
+         *page = i;
+         *x    = p->x;
+         *y    = p->y;
+         p->x += w;
+         p->rowh = MAX( p->rowh, h );
+         return 0;
+      }
+
+      /* Open a new shelf below the current one. */
+      if (p->y + p->rowh + h <= ATLAS_PAGE_SIZE) {
+         p->y   += p->rowh;
+         p->x    = w;
+         p->rowh = h;
+         *page = i;
+         *x    = 0;
+         *y    = p->y;
+         return 0;
+      }
+   }
+
+   /* No room anywhere; start a new page. */
+   p = &array_grow( &tex_atlas_pages );
+   p->tex  = gl_texParameters( 0 );
+   glTexImage2D( GL_TEXTURE_2D, 0, GL_SRGB_ALPHA,
+         ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+   glBindTexture( GL_TEXTURE_2D, 0 );
+   gl_checkErr();
+   p->x    = w;
+   p->y    = 0;
+   p->rowh = h;
+   *page = array_size(tex_atlas_pages)-1;
+   *x    = 0;
+   *y    = 0;
+   return 0;
+}
+
+/**
+ * @brief Loads an image into an atlas page and wraps it as a sub-texture.
+ *
+ * Falls back to gl_loadNewImage for images that are too large or need
+ * features a shared page can not provide (transparency maps, mipmaps).
+ *
+ *    @param path Image to load.
+ *    @param flags Flags to control image parameters.
+ *    @return Texture loaded from image.
+ */
+static glTexture* gl_loadNewImageAtlas( const char *path, unsigned int flags )
+{
+   glTexture *texture;
+   SDL_Surface *surface;
+   SDL_RWops *rw;
+   int page, x, y;
+
+   /* Transparency maps need the raw surface around; don't atlas those. */
+   if (flags & OPENGL_TEX_MAPTRANS)
+      return gl_loadNewImage( path, flags & ~OPENGL_TEX_ATLAS );
+
+   rw = PHYSFSRWOPS_openRead( path );
+   if (rw == NULL) {
+      WARN(_("Failed to load surface '%s' from ndata."), path);
+      return NULL;
+   }
+   surface = IMG_Load_RW( rw, 1 );
+   if (surface == NULL) {
+      WARN(_("Unable to load image '%s'."), path );
+      return NULL;
+   }
+
+   /* Too big for a shared page; load standalone. */
+   if ((surface->w > ATLAS_MAX_DIM) || (surface->h > ATLAS_MAX_DIM)) {
+      texture = gl_loadImagePad( path, surface, (flags & ~OPENGL_TEX_ATLAS) | OPENGL_TEX_VFLIP,
+            surface->w, surface->h, 1, 1, 1 );
+      return texture;
+   }
+
+   /* The page is uploaded with glTexSubImage2D so the pixels must be RGBA. */
+   if ((surface->format->BytesPerPixel != 4) || (surface->format->Rmask != RMASK)) {
+      SDL_Surface *conv = SDL_CreateRGBSurface( 0, surface->w, surface->h, 32, RGBAMASK );
+      SDL_BlitSurface( surface, NULL, conv, NULL );
+      SDL_FreeSurface( surface );
+      surface = conv;
+   }
+
+   gl_atlasAlloc( surface->w, surface->h, &page, &x, &y );
+
+   glBindTexture( GL_TEXTURE_2D, tex_atlas_pages[page].tex );
+   SDL_LockSurface( surface );
+   glPixelStorei( GL_UNPACK_ALIGNMENT, MIN( surface->pitch&-surface->pitch, 8 ) );
+   glPixelStorei( GL_UNPACK_ROW_LENGTH, surface->pitch / surface->format->BytesPerPixel );
+   glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, surface->w, surface->h,
+         GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels );
+   glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+   SDL_UnlockSurface( surface );
+   glBindTexture( GL_TEXTURE_2D, 0 );
+   gl_checkErr();
+
+   /* Wrap the region as a normal-looking texture. */
+   texture = calloc( 1, sizeof(glTexture) );
+   texture->name  = strdup( path );
+   texture->w     = (double) surface->w;
+   texture->h     = (double) surface->h;
+   texture->sx    = 1.;
+   texture->sy    = 1.;
+   texture->sw    = texture->w;
+   texture->sh    = texture->h;
+   texture->srw   = texture->w / (double)ATLAS_PAGE_SIZE;
+   texture->srh   = texture->h / (double)ATLAS_PAGE_SIZE;
+   texture->tox   = (double)x / (double)ATLAS_PAGE_SIZE;
+   /* The VFLIP texture matrix samples v = 1-(toy+srh*t), so the offset is
+    * measured from the bottom of the page. */
+   texture->toy   = (double)(ATLAS_PAGE_SIZE - y - surface->h) / (double)ATLAS_PAGE_SIZE;
+   texture->texture = tex_atlas_pages[page].tex;
+   texture->flags = (flags & ~OPENGL_TEX_MIPMAPS) | OPENGL_TEX_VFLIP | OPENGL_TEX_ATLAS;
+   gl_texAdd( texture, 1, 1 );
+
+   SDL_FreeSurface( surface );
+   return texture;
+}
+
 /**
  * @brief Loads the texture immediately, but also sets it as a sprite.
  *
@@ -693,8 +1133,9 @@ glTexture* gl_newSprite( const char* path, const int sx, const int sy,
          return texture;
    }
 
-   /* Create new image. */
-   texture = gl_newImage( path, flags | OPENGL_TEX_SKIPCACHE );
+   /* Create new image. Sprite sheets need full-image texture coordinates,
+    * so they can not live on an atlas page. */
+   texture = gl_newImage( path, (flags & ~OPENGL_TEX_ATLAS) | OPENGL_TEX_SKIPCACHE );
    if (texture == NULL)
       return NULL;
 
@@ -765,22 +1206,19 @@ void gl_freeTexture( glTexture *texture )
       if (cur->tex == texture) { /* found it */
          cur->used--;
          if (cur->used <= 0) { /* not used anymore */
-            /* free the texture */
-            glDeleteTextures( 1, &texture->texture );
-            free(texture->trans);
-            free(texture->name);
-            free(texture);
-
-            /* free the list node */
-            if (last == NULL) { /* case there's no texture before it */
-               if (cur->next != NULL)
-                  texture_list = cur->next;
-               else /* case it's the last texture */
-                  texture_list = NULL;
+            /* Nameless and atlas-backed entries can't be rehit through
+             * gl_texExists(), so caching them buys nothing. */
+            if ((conf.texture_cache <= 0) || (texture->name == NULL) ||
+                  (texture->flags & OPENGL_TEX_ATLAS)) {
+               gl_texListFree( cur, last );
+               return;
             }
-            else
-               last->next = cur->next;
-            free(cur);
+
+            /* Keep resident; evicted lazily when over budget. */
+            cur->used = 0;
+            cur->lru  = ++tex_cache_stamp;
+            tex_cache_used += cur->vram;
+            gl_texCacheTrim();
          }
          return; /* we already found it so we can exit */
       }
@@ -792,14 +1230,69 @@ void gl_freeTexture( glTexture *texture )
       WARN(_("Attempting to free texture '%s' not found in stack!"), texture->name);
 
    /* Free anyways */
-   glDeleteTextures( 1, &texture->texture );
+   if (!(texture->flags & OPENGL_TEX_ATLAS))
+      glDeleteTextures( 1, &texture->texture );
    free(texture->trans);
+   free(texture->ctrans);
    free(texture->name);
    free(texture);
 
    gl_checkErr();
 }
 
+/**
+ * @brief Deletes a texture list entry and unlinks it.
+ *
+ *    @param cur Entry to delete.
+ *    @param last Entry before cur, or NULL if cur heads the list.
+ */
+static void gl_texListFree( glTexList *cur, glTexList *last )
+{
+   glTexture *texture = cur->tex;
+
+   /* free the texture; atlas pages are shared and outlive their entries */
+   if (!(texture->flags & OPENGL_TEX_ATLAS))
+      glDeleteTextures( 1, &texture->texture );
+   free(texture->trans);
+   free(texture->ctrans);
+   free(texture->name);
+   free(texture);
+
+   /* free the list node */
+   if (last == NULL)
+      texture_list = cur->next;
+   else
+      last->next = cur->next;
+   free(cur);
+}
+
+/**
+ * @brief Evicts least recently released unreferenced textures until the
+ *        residency cache fits within conf.texture_cache again.
+ */
+static void gl_texCacheTrim (void)
+{
+   const size_t budget = (size_t)conf.texture_cache * 1024*1024;
+
+   while (tex_cache_used > budget) {
+      glTexList *oldest = NULL, *oldest_last = NULL, *last = NULL;
+
+      for (glTexList *cur=texture_list; cur!=NULL; cur=cur->next) {
+         if ((cur->used == 0) &&
+               ((oldest == NULL) || (cur->lru < oldest->lru))) {
+            oldest      = cur;
+            oldest_last = last;
+         }
+         last = cur;
+      }
+      if (oldest == NULL) /* Everything left is referenced. */
+         return;
+
+      tex_cache_used -= oldest->vram;
+      gl_texListFree( oldest, oldest_last );
+   }
+}
+
 /**
  * @brief Duplicates a texture.
  *
@@ -843,6 +1336,21 @@ int gl_isTrans( const glTexture* t, const int x, const int y )
    return !(t->trans[ i/8 ] & (1 << (i%8)));
 }
 
+/**
+ * @brief Checks if the 8x8 block containing a pixel is fully transparent.
+ *
+ *    @param t Texture to check for transparency.
+ *    @param x X position of the pixel.
+ *    @param y Y position of the pixel.
+ *    @return 1 if the whole block is transparent or 0 if it isn't.
+ */
+int gl_isTransBlock( const glTexture* t, const int x, const int y )
+{
+   int cw = ((int)(t->w)+7)/8;
+   int i  = (y/8)*cw + (x/8);
+   return !(t->ctrans[ i/8 ] & (1 << (i%8)));
+}
+
 /**
  * @brief Sets x and y to be the appropriate sprite for glTexture using dir.
  *
@@ -920,6 +1428,34 @@ int gl_initTextures (void)
  */
 void gl_exitTextures (void)
 {
+   if (tex_async_lock != NULL) {
+      SDL_DestroyMutex( tex_async_lock );
+      tex_async_lock = NULL;
+   }
+   array_free( tex_async_done );
+   tex_async_done = NULL;
+
+   /* Free the atlas pages. */
+   for (int i=0; i<array_size(tex_atlas_pages); i++)
+      glDeleteTextures( 1, &tex_atlas_pages[i].tex );
+   array_free( tex_atlas_pages );
+   tex_atlas_pages = NULL;
+
+   /* Flush the residency cache; entries it holds are not leaks. */
+   {
+      glTexList *cur = texture_list, *last = NULL;
+      while (cur != NULL) {
+         glTexList *next = cur->next;
+         if (cur->used == 0) {
+            tex_cache_used -= cur->vram;
+            gl_texListFree( cur, last );
+         }
+         else
+            last = cur;
+         cur = next;
+      }
+   }
+
    /* Make sure there's no texture leak */
    if (texture_list != NULL) {
       DEBUG(_("Texture leak detected!"));
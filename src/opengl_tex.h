@@ -25,6 +25,8 @@
 #define OPENGL_TEX_MIPMAPS    (1<<1) /**< Creates mipmaps. */
 #define OPENGL_TEX_VFLIP      (1<<2) /**< Assume loaded from an image (where positive y means down). */
 #define OPENGL_TEX_SKIPCACHE  (1<<3) /**< Skip caching checks and create new texture. */
+#define OPENGL_TEX_ASYNC      (1<<4) /**< Read and decode on a worker thread; a placeholder is returned until the upload completes. */
+#define OPENGL_TEX_ATLAS      (1<<5) /**< Pack small images into a shared atlas page to cut texture binds. */
 
 /**
  * @brief Abstraction for rendering sprite sheets.
@@ -45,10 +47,13 @@ typedef struct glTexture_ {
    double sh; /**< Height of a sprite. */
    double srw; /**< Sprite render width - equivalent to sw/w. */
    double srh; /**< Sprite render height - equivalent to sh/h. */
+   double tox; /**< Texture u offset within the atlas page (0. when not atlas-backed). */
+   double toy; /**< Texture v offset within the atlas page (0. when not atlas-backed). */
 
    /* data */
    GLuint texture; /**< the opengl texture itself */
    uint8_t* trans; /**< maps the transparency */
+   uint8_t* ctrans; /**< coarse transparency, one bit per 8x8 pixel block */
 
    /* properties */
    uint8_t flags; /**< flags used for texture properties */
@@ -59,6 +64,7 @@ typedef struct glTexture_ {
  */
 int gl_initTextures (void);
 void gl_exitTextures (void);
+void gl_texAsyncPump (void);
 
 /*
  * Creating.
@@ -70,6 +76,8 @@ glTexture* gl_loadImagePadTrans( const char *name, SDL_Surface* surface, SDL_RWo
       unsigned int flags, int w, int h, int sx, int sy, int freesur );
 glTexture* gl_loadImage( SDL_Surface* surface, const unsigned int flags ); /* Frees the surface. */
 glTexture* gl_newImage( const char* path, const unsigned int flags );
+glTexture* gl_newImageAsync( const char *path, const unsigned int flags,
+      void (*done)( glTexture*, void* ), void *done_data );
 glTexture* gl_newImageRWops( const char* path, SDL_RWops *rw, const unsigned int flags ); /* Does not close the RWops. */
 glTexture* gl_newSprite( const char* path, const int sx, const int sy,
       const unsigned int flags );
@@ -91,6 +99,7 @@ int gl_fboCreate( GLuint *fbo, GLuint *tex, GLsizei width, GLsizei height );
  * Misc.
  */
 int gl_isTrans( const glTexture* t, const int x, const int y );
+int gl_isTransBlock( const glTexture* t, const int x, const int y );
 void gl_getSpriteFromDir( int* x, int* y, const glTexture* t, const double dir );
 glTexture** gl_copyTexArray( glTexture **tex, int *n );
 glTexture** gl_addTexArray( glTexture **tex, int *n, glTexture *t );
@@ -23,6 +23,7 @@
 #include "dialogue.h"
 #include "difficulty.h"
 #include "input.h"
+#include "land_outfits.h"
 #include "log.h"
 #include "music.h"
 #include "ndata.h"
@@ -200,6 +201,10 @@ static void opt_close( unsigned int wid, const char *name )
    music_volume( conf.music );
    render_setGamma( conf.gamma_correction );
 
+   /* On OK the applied conf was just copied into local_conf, so this fires
+    * with the new values; on Cancel it fires with the restored ones. */
+   conf_notifyChange();
+
    window_destroy( opt_wid );
    opt_wid = 0;
 
@@ -448,6 +453,7 @@ static int opt_gameplaySave( unsigned int wid, const char *str )
       LOG("conf.language set to %s", conf.language);
       /* Apply setting going forward; advise restart to regen other text. */
       gettext_setLanguage( conf.language );
+      outfits_altCacheClear(); /* Formatted in the old locale. */
       opt_needRestart();
 
       /* Probably have to reload some fonts or it'll hate us. */
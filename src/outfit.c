@@ -34,7 +34,6 @@
 #include "nlua_camera.h"
 #include "nlua_hook.h"
 #include "nstring.h"
-#include "nstring.h"
 #include "nxml.h"
 #include "pilot.h"
 #include "pilot_heat.h"
@@ -42,6 +41,7 @@
 #include "slots.h"
 #include "spfx.h"
 #include "unistd.h"
+#include "xmltags.gen.h"
 
 #define outfit_setProp(o,p)      ((o)->properties |= p) /**< Checks outfit property. */
 
@@ -1113,7 +1113,7 @@ static int outfit_loadPLG( Outfit *temp, const char *buf, unsigned int bolt )
    asprintf( &file, "%s%s.xml", OUTFIT_POLYGON_PATH, buf );
 
    /* See if the file does exist. */
-   if (!PHYSFS_exists(file)) {
+   if (!ndata_exists(file)) {
       WARN(_("%s xml collision polygon does not exist!\n \
                Please use the script 'polygon_from_sprite.py' \
 that can be found in Naev's artwork repo."), file);
@@ -1122,7 +1122,7 @@ that can be found in Naev's artwork repo."), file);
    }
 
    /* Load the XML. */
-   doc  = xml_parsePhysFS( file );
+   doc  = xml_parsePhysFSCached( file );
 
    if (doc == NULL) {
       free(file);
@@ -1200,97 +1200,90 @@ static void outfit_parseSBolt( Outfit* temp, const xmlNodePtr parent )
    node = parent->xmlChildrenNode;
    do { /* load all the data */
       xml_onlyNodes(node);
-      xmlr_float(node,"speed",temp->u.blt.speed);
-      xmlr_float(node,"delay",temp->u.blt.delay);
-      xmlr_float(node,"energy",temp->u.blt.energy);
-      xmlr_float(node,"heatup",temp->u.blt.heatup);
-      xmlr_float(node,"trackmin",temp->u.blt.trackmin);
-      xmlr_float(node,"trackmax",temp->u.blt.trackmax);
-      xmlr_float(node,"swivel",temp->u.blt.swivel);
-      xmlr_float(node,"dispersion",temp->u.blt.dispersion);
-      xmlr_float(node,"speed_dispersion",temp->u.blt.speed_dispersion);
-      xmlr_int(node,"shots",temp->u.blt.shots);
-      xmlr_int(node,"mining_rarity",temp->u.blt.mining_rarity);
-      xmlr_strd(node,"lua",temp->lua_file);
-      if (xml_isNode(node,"range")) {
-         xmlr_attr_strd(node,"blowup",buf);
-         if (buf != NULL) {
-            if (strcmp(buf,"armour")==0)
-               outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_SHIELD);
-            else if (strcmp(buf,"shield")==0)
-               outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR);
-            else
-               WARN(_("Outfit '%s' has invalid blowup property: '%s'"),
-                     temp->name, buf );
-            free(buf);
-         }
-         temp->u.blt.range = xml_getFloat(node);
-         continue;
-      }
-      xmlr_float(node,"falloff",temp->u.blt.falloff);
-
-      /* Graphics. */
-      if (xml_isNode(node,"gfx")) {
-         temp->u.blt.gfx_space = xml_parseTexture( node,
-               OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
-         xmlr_attr_strd(node, "spin", buf);
-         if (buf != NULL) {
-            outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
-            temp->u.blt.spin = atof( buf );
-            free(buf);
-         }
-         /* Load the collision polygon. */
-         buf = xml_get(node);
-         outfit_loadPLG( temp, buf, 1 );
-
-         /* Validity check: there must be 1 polygon per sprite. */
-         if (array_size(temp->u.blt.polygon) != 36) {
-            WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
-                    npolygon = %i and sx*sy = %i"),
-                    temp->name, array_size(temp->u.blt.polygon), 36);
-         }
-         continue;
-      }
-      if (xml_isNode(node,"gfx_end")) {
-         temp->u.blt.gfx_end = xml_parseTexture( node,
-               OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
-         continue;
-      }
-
-      /* Special effects. */
-      if (xml_isNode(node,"spfx_shield")) {
-         temp->u.blt.spfx_shield = spfx_get(xml_get(node));
-         continue;
-      }
-      if (xml_isNode(node,"spfx_armour")) {
-         temp->u.blt.spfx_armour = spfx_get(xml_get(node));
-         continue;
-      }
-
-      /* Misc. */
-      if (xml_isNode(node,"sound")) {
-         temp->u.blt.sound = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"sound_hit")) {
-         temp->u.blt.sound_hit = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"damage")) {
-         outfit_parseDamage( &temp->u.blt.dmg, node );
-         continue;
-      }
-
-      /* Stats. */
-      ll = ss_listFromXML( node );
-      if (ll != NULL) {
-         ll->next    = temp->stats;
-         temp->stats = ll;
-         continue;
+      /* One hash per node instead of a strcmp per candidate tag. */
+      switch (xml_tagId( (const char*)node->name )) {
+         case XML_TAG_SPEED:     temp->u.blt.speed       = xml_getFloat(node); break;
+         case XML_TAG_DELAY:     temp->u.blt.delay       = xml_getFloat(node); break;
+         case XML_TAG_ENERGY:    temp->u.blt.energy      = xml_getFloat(node); break;
+         case XML_TAG_HEATUP:    temp->u.blt.heatup      = xml_getFloat(node); break;
+         case XML_TAG_TRACKMIN:  temp->u.blt.trackmin    = xml_getFloat(node); break;
+         case XML_TAG_TRACKMAX:  temp->u.blt.trackmax    = xml_getFloat(node); break;
+         case XML_TAG_SWIVEL:    temp->u.blt.swivel      = xml_getFloat(node); break;
+         case XML_TAG_DISPERSION: temp->u.blt.dispersion = xml_getFloat(node); break;
+         case XML_TAG_SPEED_DISPERSION: temp->u.blt.speed_dispersion = xml_getFloat(node); break;
+         case XML_TAG_FALLOFF:   temp->u.blt.falloff     = xml_getFloat(node); break;
+         case XML_TAG_SHOTS:     temp->u.blt.shots       = xml_getInt(node); break;
+         case XML_TAG_MINING_RARITY: temp->u.blt.mining_rarity = xml_getInt(node); break;
+         case XML_TAG_LUA:
+            if (temp->lua_file != NULL)
+               WARN("Node '%s' already loaded and being replaced from '%s' to '%s'",
+                     "lua", temp->lua_file, xml_raw(node) );
+            temp->lua_file = xml_getStrd(node);
+            break;
+
+         case XML_TAG_RANGE:
+            xmlr_attr_strd(node,"blowup",buf);
+            if (buf != NULL) {
+               if (strcmp(buf,"armour")==0)
+                  outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_SHIELD);
+               else if (strcmp(buf,"shield")==0)
+                  outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR);
+               else
+                  WARN(_("Outfit '%s' has invalid blowup property: '%s'"),
+                        temp->name, buf );
+               free(buf);
+            }
+            temp->u.blt.range = xml_getFloat(node);
+            break;
+
+         /* Graphics. */
+         case XML_TAG_GFX:
+            temp->u.blt.gfx_space = xml_parseTexture( node,
+                  OUTFIT_GFX_PATH"space/%s", 6, 6,
+                  OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+            xmlr_attr_strd(node, "spin", buf);
+            if (buf != NULL) {
+               outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
+               temp->u.blt.spin = atof( buf );
+               free(buf);
+            }
+            /* Load the collision polygon. */
+            buf = xml_get(node);
+            outfit_loadPLG( temp, buf, 1 );
+
+            /* Validity check: there must be 1 polygon per sprite. */
+            if (array_size(temp->u.blt.polygon) != 36) {
+               WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
+                       npolygon = %i and sx*sy = %i"),
+                       temp->name, array_size(temp->u.blt.polygon), 36);
+            }
+            break;
+         case XML_TAG_GFX_END:
+            temp->u.blt.gfx_end = xml_parseTexture( node,
+                  OUTFIT_GFX_PATH"space/%s", 6, 6,
+                  OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+            break;
+
+         /* Special effects. */
+         case XML_TAG_SPFX_SHIELD: temp->u.blt.spfx_shield = spfx_get(xml_get(node)); break;
+         case XML_TAG_SPFX_ARMOUR: temp->u.blt.spfx_armour = spfx_get(xml_get(node)); break;
+
+         /* Misc. */
+         case XML_TAG_SOUND:     temp->u.blt.sound     = sound_get( xml_get(node) ); break;
+         case XML_TAG_SOUND_HIT: temp->u.blt.sound_hit = sound_get( xml_get(node) ); break;
+         case XML_TAG_DAMAGE:    outfit_parseDamage( &temp->u.blt.dmg, node ); break;
+
+         default:
+            /* Stats. */
+            ll = ss_listFromXML( node );
+            if (ll != NULL) {
+               ll->next    = temp->stats;
+               temp->stats = ll;
+               break;
+            }
+            WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
+            break;
       }
-      WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
    } while (xml_nextNode(node));
 
    /* If not defined assume maximum. */
@@ -1386,74 +1379,65 @@ static void outfit_parseSBeam( Outfit* temp, const xmlNodePtr parent )
    node = parent->xmlChildrenNode;
    do { /* load all the data */
       xml_onlyNodes(node);
-      xmlr_float(node,"range",temp->u.bem.range);
-      xmlr_float(node,"turn",temp->u.bem.turn);
-      xmlr_float(node,"energy",temp->u.bem.energy);
-      xmlr_float(node,"delay",temp->u.bem.delay);
-      xmlr_float(node,"warmup",temp->u.bem.warmup);
-      xmlr_float(node,"heatup",temp->u.bem.heatup);
-      xmlr_float(node,"swivel",temp->u.bem.swivel);
-      xmlr_int(node,"mining_rarity",temp->u.bem.mining_rarity);
-      xmlr_strd(node,"lua",temp->lua_file);
-
-      if (xml_isNode(node, "duration")) {
-         xmlr_attr_float(node, "min", temp->u.bem.min_duration);
-         temp->u.bem.duration = xml_getFloat(node);
-         continue;
-      }
-
-      if (xml_isNode(node,"damage")) {
-         outfit_parseDamage( &temp->u.bem.dmg, node );
-         continue;
-      }
-
-      /* Graphic stuff. */
-      if (xml_isNode(node,"shader")) {
-         xmlr_attr_float(node, "r", temp->u.bem.colour.r);
-         xmlr_attr_float(node, "g", temp->u.bem.colour.g);
-         xmlr_attr_float(node, "b", temp->u.bem.colour.b);
-         xmlr_attr_float(node, "a", temp->u.bem.colour.a);
-         xmlr_attr_float(node, "width", temp->u.bem.width);
-         col_gammaToLinear( &temp->u.bem.colour );
-         shader = xml_get(node);
-         if (gl_has( OPENGL_SUBROUTINES )) {
-            temp->u.bem.shader = glGetSubroutineIndex( shaders.beam.program, GL_FRAGMENT_SHADER, shader );
-            if (temp->u.bem.shader == GL_INVALID_INDEX)
-               WARN("Beam outfit '%s' has unknown shader function '%s'", temp->name, shader);
-         }
-         continue;
-      }
-      if (xml_isNode(node,"spfx_armour")) {
-         temp->u.bem.spfx_armour = spfx_get(xml_get(node));
-         continue;
-      }
-      if (xml_isNode(node,"spfx_shield")) {
-         temp->u.bem.spfx_shield = spfx_get(xml_get(node));
-         continue;
-      }
+      switch (xml_tagId( (const char*)node->name )) {
+         case XML_TAG_RANGE:  temp->u.bem.range  = xml_getFloat(node); break;
+         case XML_TAG_TURN:   temp->u.bem.turn   = xml_getFloat(node); break;
+         case XML_TAG_ENERGY: temp->u.bem.energy = xml_getFloat(node); break;
+         case XML_TAG_DELAY:  temp->u.bem.delay  = xml_getFloat(node); break;
+         case XML_TAG_WARMUP: temp->u.bem.warmup = xml_getFloat(node); break;
+         case XML_TAG_HEATUP: temp->u.bem.heatup = xml_getFloat(node); break;
+         case XML_TAG_SWIVEL: temp->u.bem.swivel = xml_getFloat(node); break;
+         case XML_TAG_MINING_RARITY: temp->u.bem.mining_rarity = xml_getInt(node); break;
+         case XML_TAG_LUA:
+            if (temp->lua_file != NULL)
+               WARN("Node '%s' already loaded and being replaced from '%s' to '%s'",
+                     "lua", temp->lua_file, xml_raw(node) );
+            temp->lua_file = xml_getStrd(node);
+            break;
+
+         case XML_TAG_DURATION:
+            xmlr_attr_float(node, "min", temp->u.bem.min_duration);
+            temp->u.bem.duration = xml_getFloat(node);
+            break;
+
+         case XML_TAG_DAMAGE:
+            outfit_parseDamage( &temp->u.bem.dmg, node );
+            break;
+
+         /* Graphic stuff. */
+         case XML_TAG_SHADER:
+            xmlr_attr_float(node, "r", temp->u.bem.colour.r);
+            xmlr_attr_float(node, "g", temp->u.bem.colour.g);
+            xmlr_attr_float(node, "b", temp->u.bem.colour.b);
+            xmlr_attr_float(node, "a", temp->u.bem.colour.a);
+            xmlr_attr_float(node, "width", temp->u.bem.width);
+            col_gammaToLinear( &temp->u.bem.colour );
+            shader = xml_get(node);
+            if (gl_has( OPENGL_SUBROUTINES )) {
+               temp->u.bem.shader = glGetSubroutineIndex( shaders.beam.program, GL_FRAGMENT_SHADER, shader );
+               if (temp->u.bem.shader == GL_INVALID_INDEX)
+                  WARN("Beam outfit '%s' has unknown shader function '%s'", temp->name, shader);
+            }
+            break;
+         case XML_TAG_SPFX_ARMOUR: temp->u.bem.spfx_armour = spfx_get(xml_get(node)); break;
+         case XML_TAG_SPFX_SHIELD: temp->u.bem.spfx_shield = spfx_get(xml_get(node)); break;
 
-      /* Sound stuff. */
-      if (xml_isNode(node,"sound_warmup")) {
-         temp->u.bem.sound_warmup = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"sound")) {
-         temp->u.bem.sound = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"sound_off")) {
-         temp->u.bem.sound_off = sound_get( xml_get(node) );
-         continue;
-      }
+         /* Sound stuff. */
+         case XML_TAG_SOUND_WARMUP: temp->u.bem.sound_warmup = sound_get( xml_get(node) ); break;
+         case XML_TAG_SOUND:        temp->u.bem.sound        = sound_get( xml_get(node) ); break;
+         case XML_TAG_SOUND_OFF:    temp->u.bem.sound_off    = sound_get( xml_get(node) ); break;
 
-      /* Stats. */
-      ll = ss_listFromXML( node );
-      if (ll != NULL) {
-         ll->next    = temp->stats;
-         temp->stats = ll;
-         continue;
+         default:
+            /* Stats. */
+            ll = ss_listFromXML( node );
+            if (ll != NULL) {
+               ll->next    = temp->stats;
+               temp->stats = ll;
+               break;
+            }
+            WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
+            break;
       }
-      WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
    } while (xml_nextNode(node));
 
    /* Post processing. */
@@ -1537,119 +1521,121 @@ static void outfit_parseSLauncher( Outfit* temp, const xmlNodePtr parent )
    node  = parent->xmlChildrenNode;
    do { /* load all the data */
       xml_onlyNodes(node);
-      xmlr_float(node,"delay",temp->u.lau.delay);
-      xmlr_int(node,"amount",temp->u.lau.amount);
-      xmlr_float(node,"reload_time",temp->u.lau.reload_time);
-      xmlr_float(node,"trackmin",temp->u.lau.trackmin);
-      xmlr_float(node,"trackmax",temp->u.lau.trackmax);
-      xmlr_float(node,"lockon",temp->u.lau.lockon);
-      xmlr_float(node,"iflockon",temp->u.lau.iflockon);
-      xmlr_float(node,"swivel",temp->u.lau.swivel);
-      xmlr_float(node,"dispersion",temp->u.blt.dispersion);
-      xmlr_float(node,"speed_dispersion",temp->u.blt.speed_dispersion);
-      xmlr_int(node,"shots",temp->u.blt.shots);
-      xmlr_int(node,"mining_rarity",temp->u.lau.mining_rarity);
-      xmlr_strd(node,"lua",temp->lua_file);
-
-      if (!outfit_isTurret(temp))
-         xmlr_float(node,"arc",temp->u.lau.arc); /* This is in semi-arc like swivel. */
-
-      /* Ammo stuff. */
-      /* Basic */
-      if (xml_isNode(node,"duration")) {
-         char *buf;
-         xmlr_attr_strd(node,"blowup",buf);
-         if (buf != NULL) {
-            if (strcmp(buf,"armour")==0)
-               outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_SHIELD);
-            else if (strcmp(buf,"shield")==0)
-               outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR);
-            else
-               WARN(_("Outfit '%s' has invalid blowup property: '%s'"),
-                     temp->name, buf );
-            free(buf);
+      switch (xml_tagId( (const char*)node->name )) {
+         case XML_TAG_DELAY:       temp->u.lau.delay       = xml_getFloat(node); break;
+         case XML_TAG_AMOUNT:      temp->u.lau.amount      = xml_getInt(node); break;
+         case XML_TAG_RELOAD_TIME: temp->u.lau.reload_time = xml_getFloat(node); break;
+         case XML_TAG_TRACKMIN:    temp->u.lau.trackmin    = xml_getFloat(node); break;
+         case XML_TAG_TRACKMAX:    temp->u.lau.trackmax    = xml_getFloat(node); break;
+         case XML_TAG_LOCKON:      temp->u.lau.lockon      = xml_getFloat(node); break;
+         case XML_TAG_IFLOCKON:    temp->u.lau.iflockon    = xml_getFloat(node); break;
+         case XML_TAG_SWIVEL:      temp->u.lau.swivel      = xml_getFloat(node); break;
+         case XML_TAG_DISPERSION:  temp->u.blt.dispersion  = xml_getFloat(node); break;
+         case XML_TAG_SPEED_DISPERSION: temp->u.blt.speed_dispersion = xml_getFloat(node); break;
+         case XML_TAG_SHOTS:       temp->u.blt.shots       = xml_getInt(node); break;
+         case XML_TAG_MINING_RARITY: temp->u.lau.mining_rarity = xml_getInt(node); break;
+         case XML_TAG_LUA:
+            if (temp->lua_file != NULL)
+               WARN("Node '%s' already loaded and being replaced from '%s' to '%s'",
+                     "lua", temp->lua_file, xml_raw(node) );
+            temp->lua_file = xml_getStrd(node);
+            break;
+
+         case XML_TAG_ARC: /* This is in semi-arc like swivel. */
+            if (!outfit_isTurret(temp)) {
+               temp->u.lau.arc = xml_getFloat(node);
+               break;
+            }
+            /* Used to fall through to the unknown-node warning for turrets. */
+            WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
+            break;
+
+         /* Ammo stuff. */
+         /* Basic */
+         case XML_TAG_DURATION: {
+            char *buf;
+            xmlr_attr_strd(node,"blowup",buf);
+            if (buf != NULL) {
+               if (strcmp(buf,"armour")==0)
+                  outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_SHIELD);
+               else if (strcmp(buf,"shield")==0)
+                  outfit_setProp(temp, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR);
+               else
+                  WARN(_("Outfit '%s' has invalid blowup property: '%s'"),
+                        temp->name, buf );
+               free(buf);
+            }
+            temp->u.lau.duration = xml_getFloat(node);
+            break;
          }
-         temp->u.lau.duration = xml_getFloat(node);
-         continue;
-      }
-      xmlr_float(node,"resist",temp->u.lau.resist);
-      /* Movement */
-      xmlr_float(node,"thrust",temp->u.lau.thrust);
-      xmlr_float(node,"turn",temp->u.lau.turn);
-      xmlr_float(node,"speed",temp->u.lau.speed);
-      xmlr_float(node,"speed_max",temp->u.lau.speed_max);
-      xmlr_float(node,"energy",temp->u.lau.energy);
-      xmlr_float(node,"ammo_mass",temp->u.lau.ammo_mass);
-      if (xml_isNode(node,"gfx")) {
-         temp->u.lau.gfx_space = xml_parseTexture( node,
-               OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
-         xmlr_attr_float(node, "spin", temp->u.lau.spin);
-         if (temp->u.lau.spin != 0)
-            outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
-         /* Load the collision polygon. */
-         char *buf = xml_get(node);
-         outfit_loadPLG( temp, buf, 0 );
-
-         /* Validity check: there must be 1 polygon per sprite. */
-         if (array_size(temp->u.lau.polygon) != 36) {
-            WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
-                    npolygon = %i and sx*sy = %i"),
-                    temp->name, array_size(temp->u.lau.polygon), 36);
+         case XML_TAG_RESIST:    temp->u.lau.resist    = xml_getFloat(node); break;
+         /* Movement */
+         case XML_TAG_THRUST:    temp->u.lau.thrust    = xml_getFloat(node); break;
+         case XML_TAG_TURN:      temp->u.lau.turn      = xml_getFloat(node); break;
+         case XML_TAG_SPEED:     temp->u.lau.speed     = xml_getFloat(node); break;
+         case XML_TAG_SPEED_MAX: temp->u.lau.speed_max = xml_getFloat(node); break;
+         case XML_TAG_ENERGY:    temp->u.lau.energy    = xml_getFloat(node); break;
+         case XML_TAG_AMMO_MASS: temp->u.lau.ammo_mass = xml_getFloat(node); break;
+
+         case XML_TAG_GFX: {
+            temp->u.lau.gfx_space = xml_parseTexture( node,
+                  OUTFIT_GFX_PATH"space/%s", 6, 6,
+                  OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+            xmlr_attr_float(node, "spin", temp->u.lau.spin);
+            if (temp->u.lau.spin != 0)
+               outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
+            /* Load the collision polygon. */
+            char *buf = xml_get(node);
+            outfit_loadPLG( temp, buf, 0 );
+
+            /* Validity check: there must be 1 polygon per sprite. */
+            if (array_size(temp->u.lau.polygon) != 36) {
+               WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
+                       npolygon = %i and sx*sy = %i"),
+                       temp->name, array_size(temp->u.lau.polygon), 36);
+            }
+            break;
          }
-         continue;
-      }
-      if (xml_isNode(node,"spfx_armour")) {
-         temp->u.lau.spfx_armour = spfx_get(xml_get(node));
-         continue;
-      }
-      if (xml_isNode(node,"spfx_shield")) {
-         temp->u.lau.spfx_shield = spfx_get(xml_get(node));
-         continue;
-      }
-      if (xml_isNode(node,"sound")) {
-         temp->u.lau.sound = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"sound_hit")) {
-         temp->u.lau.sound_hit = sound_get( xml_get(node) );
-         continue;
-      }
-      if (xml_isNode(node,"damage")) {
-         outfit_parseDamage( &temp->u.lau.dmg, node );
-         continue;
-      }
-      if (xml_isNode(node,"trail_generator")) {
-         xmlr_attr_float( node, "x", temp->u.lau.trail_x_offset );
-         char *buf = xml_get(node);
-         if (buf == NULL)
-            buf = "default";
-         temp->u.lau.trail_spec = trailSpec_get( buf );
-         continue;
-      }
-      if (xml_isNode(node,"ai")) {
-         char *buf = xml_get(node);
-         if (buf != NULL) {
-            if (strcmp(buf,"unguided")==0)
-               temp->u.lau.ai = AMMO_AI_UNGUIDED;
-            else if (strcmp(buf,"seek")==0)
-               temp->u.lau.ai = AMMO_AI_SEEK;
-            else if (strcmp(buf,"smart")==0)
-               temp->u.lau.ai = AMMO_AI_SMART;
-            else
-               WARN(_("Ammo '%s' has unknown ai type '%s'."), temp->name, buf);
+         case XML_TAG_SPFX_ARMOUR: temp->u.lau.spfx_armour = spfx_get(xml_get(node)); break;
+         case XML_TAG_SPFX_SHIELD: temp->u.lau.spfx_shield = spfx_get(xml_get(node)); break;
+         case XML_TAG_SOUND:       temp->u.lau.sound       = sound_get( xml_get(node) ); break;
+         case XML_TAG_SOUND_HIT:   temp->u.lau.sound_hit   = sound_get( xml_get(node) ); break;
+         case XML_TAG_DAMAGE:      outfit_parseDamage( &temp->u.lau.dmg, node ); break;
+
+         case XML_TAG_TRAIL_GENERATOR: {
+            xmlr_attr_float( node, "x", temp->u.lau.trail_x_offset );
+            char *buf = xml_get(node);
+            if (buf == NULL)
+               buf = "default";
+            temp->u.lau.trail_spec = trailSpec_get( buf );
+            break;
+         }
+         case XML_TAG_AI: {
+            char *buf = xml_get(node);
+            if (buf != NULL) {
+               if (strcmp(buf,"unguided")==0)
+                  temp->u.lau.ai = AMMO_AI_UNGUIDED;
+               else if (strcmp(buf,"seek")==0)
+                  temp->u.lau.ai = AMMO_AI_SEEK;
+               else if (strcmp(buf,"smart")==0)
+                  temp->u.lau.ai = AMMO_AI_SMART;
+               else
+                  WARN(_("Ammo '%s' has unknown ai type '%s'."), temp->name, buf);
+            }
+            break;
          }
-         continue;
-      }
 
-      /* Stats. */
-      ll = ss_listFromXML( node );
-      if (ll != NULL) {
-         ll->next    = temp->stats;
-         temp->stats = ll;
-         continue;
+         default:
+            /* Stats. */
+            ll = ss_listFromXML( node );
+            if (ll != NULL) {
+               ll->next    = temp->stats;
+               temp->stats = ll;
+               break;
+            }
+            WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
+            break;
       }
-      WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
    } while (xml_nextNode(node));
 
    /* Post processing. */
@@ -1759,29 +1745,35 @@ static void outfit_parseSMod( Outfit* temp, const xmlNodePtr parent )
       ShipStatList *ll;
 
       xml_onlyNodes(node);
-      xmlr_strd(node,"lua",temp->lua_file);
-
-      if (xml_isNode(node,"active")) {
-         xmlr_attr_float(node, "cooldown", temp->u.mod.cooldown);
-         temp->u.mod.active   = 1;
-         temp->u.mod.duration = xml_getFloat(node);
-
-         /* Infinity if no duration specified. */
-         if (temp->u.mod.duration == 0)
-            temp->u.mod.duration = INFINITY;
-
-         continue;
-      }
-
-      /* Stats. */
-      ll = ss_listFromXML( node );
-      if (ll != NULL) {
-         ll->next    = temp->stats;
-         temp->stats = ll;
-         continue;
+      switch (xml_tagId( (const char*)node->name )) {
+         case XML_TAG_LUA:
+            if (temp->lua_file != NULL)
+               WARN("Node '%s' already loaded and being replaced from '%s' to '%s'",
+                     "lua", temp->lua_file, xml_raw(node) );
+            temp->lua_file = xml_getStrd(node);
+            break;
+
+         case XML_TAG_ACTIVE:
+            xmlr_attr_float(node, "cooldown", temp->u.mod.cooldown);
+            temp->u.mod.active   = 1;
+            temp->u.mod.duration = xml_getFloat(node);
+
+            /* Infinity if no duration specified. */
+            if (temp->u.mod.duration == 0)
+               temp->u.mod.duration = INFINITY;
+            break;
+
+         default:
+            /* Stats. */
+            ll = ss_listFromXML( node );
+            if (ll != NULL) {
+               ll->next    = temp->stats;
+               temp->stats = ll;
+               break;
+            }
+            WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
+            break;
       }
-
-      WARN(_("Outfit '%s' has unknown node '%s'"),temp->name, node->name);
    } while (xml_nextNode(node));
 
    /* Set short description. */
@@ -2159,7 +2151,7 @@ static int outfit_parse( Outfit* temp, const char* file )
    const char *cprop;
    int group, l;
 
-   xmlDocPtr doc = xml_parsePhysFS( file );
+   xmlDocPtr doc = xml_parsePhysFSCached( file );
    if (doc == NULL)
       return -1;
 
@@ -2231,7 +2223,7 @@ static int outfit_parse( Outfit* temp, const char* file )
             }
             else if (xml_isNode(cur,"gfx_store")) {
                temp->gfx_store = xml_parseTexture( cur,
-                     OUTFIT_GFX_PATH"store/%s", 1, 1, OPENGL_TEX_MIPMAPS );
+                     OUTFIT_GFX_PATH"store/%s", 1, 1, OPENGL_TEX_MIPMAPS | OPENGL_TEX_ATLAS );
                continue;
             }
             else if (xml_isNode(cur,"gfx_overlays")) {
@@ -2281,7 +2273,7 @@ static int outfit_parse( Outfit* temp, const char* file )
                      if (s==NULL)
                         WARN(_("Empty faction string for outfit '%s' legality!"), temp->name);
                      else
-                        array_push_back( &temp->illegaltoS, strdup(s) );
+                        array_push_back( &temp->illegaltoS, (char*)strintern(s) );
                   }
                } while (xml_nextNode(ccur));
                if (array_size(temp->illegaltoS) <= 0 )
@@ -2319,7 +2311,7 @@ static int outfit_parse( Outfit* temp, const char* file )
             if (xml_isNode(cur, "tag")) {
                char *tmp = xml_get(cur);
                if (tmp != NULL)
-                  array_push_back( &temp->tags, strdup(tmp) );
+                  array_push_back( &temp->tags, (char*)strintern(tmp) );
                continue;
             }
             WARN(_("Outfit '%s' has unknown node in tags '%s'."), temp->name, cur->name );
@@ -2573,7 +2565,6 @@ int outfit_loadPost (void)
          for (int j=0; j<array_size(o->illegaltoS); j++) {
             int f = faction_get( o->illegaltoS[j] );
             array_push_back( &o->illegalto, f );
-            free( o->illegaltoS[j] );
          }
          array_free( o->illegaltoS );
          o->illegaltoS = NULL;
@@ -2620,7 +2611,7 @@ int outfit_mapParse (void)
       if (!outfit_isMap(o))
          continue;
 
-      doc = xml_parsePhysFS( o->filename );
+      doc = xml_parsePhysFSCached( o->filename );
       if (doc == NULL)
          continue;
 
@@ -2705,20 +2696,16 @@ void outfit_free (void)
 
       if (outfit_isLauncher(o)) {
          /* Free collision polygons. */
-         for (int j=0; j<array_size(o->u.lau.polygon); j++) {
-            free(o->u.lau.polygon[j].x);
-            free(o->u.lau.polygon[j].y);
-         }
+         for (int j=0; j<array_size(o->u.lau.polygon); j++)
+            FreePolygon( &o->u.lau.polygon[j] );
          array_free(o->u.lau.polygon);
       }
       /* Type specific. */
       else if (outfit_isBolt(o)) {
          gl_freeTexture(o->u.blt.gfx_end);
          /* Free collision polygons. */
-         for (int j=0; j<array_size(o->u.blt.polygon); j++) {
-            free(o->u.blt.polygon[j].x);
-            free(o->u.blt.polygon[j].y);
-         }
+         for (int j=0; j<array_size(o->u.blt.polygon); j++)
+            FreePolygon( &o->u.blt.polygon[j] );
          array_free(o->u.blt.polygon);
       }
       else if (outfit_isFighterBay(o))
@@ -2753,10 +2740,7 @@ void outfit_free (void)
          gl_freeTexture(o->gfx_overlays[j]);
       array_free(o->gfx_overlays);
 
-      /* Free tags. */
-      for (int j=0; j<array_size(o->tags); j++)
-         free(o->tags[j]);
-      array_free(o->tags);
+      array_free(o->tags); /* Tags are interned. */
    }
 
    array_free(outfit_stack);
@@ -44,6 +44,46 @@ double angle_diff( double ref, double a )
    return d;
 }
 
+static double solid_interp = 1.; /**< Interpolation factor between pre and pos for rendering. */
+
+/**
+ * @brief Sets the render interpolation factor.
+ *
+ * With the fixed-step simulation the frame being rendered generally falls
+ * between two physics steps; this sets how far along the current step it is.
+ * 1. (the default) renders the latest state directly.
+ *
+ *    @param alpha Fraction of the current step that has elapsed, in [0,1].
+ */
+void solid_setRenderInterp( double alpha )
+{
+   solid_interp = CLAMP( 0., 1., alpha );
+}
+
+/**
+ * @brief Gets the current render interpolation factor.
+ */
+double solid_getRenderInterp (void)
+{
+   return solid_interp;
+}
+
+/**
+ * @brief Gets the position a solid should be rendered at.
+ *
+ * Interpolates between the last two physics states using the factor set
+ * by solid_setRenderInterp().
+ *
+ *    @param s Solid to get the render position of.
+ *    @param[out] x X position to render at.
+ *    @param[out] y Y position to render at.
+ */
+void solid_renderPos( const Solid *s, double *x, double *y )
+{
+   *x = s->pre.x + (s->pos.x - s->pre.x) * solid_interp;
+   *y = s->pre.y + (s->pos.y - s->pre.y) * solid_interp;
+}
+
 /**
  * @brief Updates the solid's position using an Euler integration.
  *
@@ -59,11 +99,58 @@ double angle_diff( double ref, double a )
  *   so watch out with big values for dt
  *
  */
+/**
+ * @brief Analytic update for a dormant solid.
+ *
+ * With no thrust and no speed limiting the acceleration is exactly zero, so
+ * the trajectory is a straight line and no numerical integration is needed.
+ * Used by both integrators for drifting objects (debris, disabled ships,
+ * spent projectiles) until a force wakes them.
+ */
+static void solid_update_dormant( Solid *obj, double dt )
+{
+   /* Remember where we were for render interpolation. */
+   obj->pre = obj->pos;
+
+   /* make sure angle doesn't flip */
+   obj->dir += obj->dir_vel*dt;
+   if (obj->dir >= 2.*M_PI)
+      obj->dir -= 2.*M_PI;
+   if (obj->dir < 0.)
+      obj->dir += 2.*M_PI;
+
+   /* p = v*dt, v is constant. */
+   vec2_cset( &obj->pos, obj->pos.x + obj->vel.x*dt,
+         obj->pos.y + obj->vel.y*dt );
+}
+
+/**
+ * @brief Whether a solid can take the dormant analytic path this step.
+ */
+static int solid_isDormant( const Solid *obj )
+{
+   if (obj->thrust != 0.)
+      return 0;
+   /* Speed limiting applies a braking force, so it counts as one. */
+   if ((obj->speed_max >= 0.) &&
+         (MOD( obj->vel.x, obj->vel.y ) > obj->speed_max))
+      return 0;
+   return 1;
+}
+
 static void solid_update_euler( Solid *obj, double dt )
 {
    double px,py, vx,vy, ax,ay, th;
    double cdir, sdir;
 
+   if (solid_isDormant( obj )) {
+      solid_update_dormant( obj, dt );
+      return;
+   }
+
+   /* Remember where we were for render interpolation. */
+   obj->pre = obj->pos;
+
    /* make sure angle doesn't flip */
    obj->dir += obj->dir_vel*dt;
    if (obj->dir >= 2*M_PI)
@@ -132,6 +219,14 @@ static void solid_update_rk4( Solid *obj, double dt )
    int vint;
    int limit; /* limit speed? */
 
+   if (solid_isDormant( obj )) {
+      solid_update_dormant( obj, dt );
+      return;
+   }
+
+   /* Remember where we were for render interpolation. */
+   obj->pre = obj->pos;
+
    /* Initial positions and velocity. */
    px = obj->pos.x;
    py = obj->pos.y;
@@ -205,6 +300,106 @@ static void solid_update_rk4( Solid *obj, double dt )
       obj->dir += 2.*M_PI;
 }
 
+/*
+ * Batched integration: projectiles all use the Euler path with uniform
+ * math, so their solids are integrated in fixed-size blocks through plain
+ * indexed loops over stack SoA buffers that the compiler can vectorize.
+ * Solids with other update methods fall back to their scalar update.
+ */
+#define SOLID_BATCH 8 /**< Solids integrated per kernel block. */
+
+/**
+ * @brief Integrates a block of Euler solids together.
+ *
+ *    @param b Solids to integrate.
+ *    @param h Time step for each solid.
+ *    @param n Number of solids in the block.
+ */
+static void solid_batchEuler( Solid *const *b, const double *h, int n )
+{
+   double px[SOLID_BATCH], py[SOLID_BATCH];
+   double vx[SOLID_BATCH], vy[SOLID_BATCH];
+   double ax[SOLID_BATCH], ay[SOLID_BATCH];
+
+   /* Gather into SoA form; the trig stays scalar. */
+   for (int i=0; i<n; i++) {
+      Solid *obj = b[i];
+      double a, dir;
+
+      /* Remember where we were for render interpolation. */
+      obj->pre = obj->pos;
+
+      /* make sure angle doesn't flip */
+      dir = obj->dir + obj->dir_vel*h[i];
+      if (dir >= 2.*M_PI)
+         dir -= 2.*M_PI;
+      if (dir < 0.)
+         dir += 2.*M_PI;
+      obj->dir = dir;
+
+      a     = obj->thrust / obj->mass;
+      ax[i] = a*cos(dir);
+      ay[i] = a*sin(dir);
+      px[i] = obj->pos.x;
+      py[i] = obj->pos.y;
+      vx[i] = obj->vel.x;
+      vy[i] = obj->vel.y;
+   }
+
+   /* Uniform integration kernel. */
+   for (int i=0; i<n; i++) {
+      /* p = v*dt + 0.5*a*dt^2 */
+      px[i] += vx[i]*h[i] + 0.5*ax[i] * h[i]*h[i];
+      py[i] += vy[i]*h[i] + 0.5*ay[i] * h[i]*h[i];
+      /* v = a*dt */
+      vx[i] += ax[i]*h[i];
+      vy[i] += ay[i]*h[i];
+   }
+
+   /* Scatter back. */
+   for (int i=0; i<n; i++) {
+      vec2_cset( &b[i]->vel, vx[i], vy[i] );
+      vec2_cset( &b[i]->pos, px[i], py[i] );
+   }
+}
+
+/**
+ * @brief Updates a set of solids, batching the uniform Euler ones.
+ *
+ * Equivalent to calling each solid's update method with its step, but
+ * Euler solids are integrated in blocks so the math vectorizes.
+ *
+ *    @param solids Solids to update.
+ *    @param dts Time step for each solid.
+ *    @param n Number of solids.
+ */
+void solid_updateBatch( Solid *const *solids, const double *dts, int n )
+{
+   Solid *batch[SOLID_BATCH];
+   double h[SOLID_BATCH];
+   int k = 0;
+
+   for (int i=0; i<n; i++) {
+      Solid *s = solids[i];
+      if (s->update != solid_update_euler) {
+         (*s->update)( s, dts[i] );
+         continue;
+      }
+      if (solid_isDormant( s )) {
+         solid_update_dormant( s, dts[i] );
+         continue;
+      }
+      batch[k] = s;
+      h[k]     = dts[i];
+      if (++k == SOLID_BATCH) {
+         solid_batchEuler( batch, h, k );
+         k = 0;
+      }
+   }
+   if (k > 0)
+      solid_batchEuler( batch, h, k );
+}
+
 /**
  * @brief Gets the maximum speed of any object with speed and thrust.
  */
@@ -251,6 +446,7 @@ void solid_init( Solid* dest, double mass, double dir,
       vectnull( &dest->pos );
    else
       dest->pos = *pos;
+   dest->pre = dest->pos;
 
    /* Misc. */
    dest->speed_max = -1.; /* Negative is invalid. */
@@ -281,12 +477,27 @@ void solid_init( Solid* dest, double mass, double dir,
  *    @param vel Initial solid velocity.
  *    @return A newly created solid.
  */
+/*
+ * Weapons create and release solids constantly during combat, so freed
+ * solids are kept on a free list and reused instead of hitting the heap.
+ * The first bytes of a pooled solid hold the next link; solid_init
+ * overwrites them on reuse.
+ */
+static Solid *solid_pool = NULL; /**< Free list of solids for reuse. */
+
 Solid* solid_create( double mass, double dir,
       const vec2* pos, const vec2* vel, int update )
 {
-   Solid* dyn = malloc(sizeof(Solid));
-   if (dyn==NULL)
-      ERR(_("Out of Memory"));
+   Solid* dyn;
+   if (solid_pool != NULL) {
+      dyn        = solid_pool;
+      solid_pool = *(Solid**) dyn;
+   }
+   else {
+      dyn = malloc(sizeof(Solid));
+      if (dyn==NULL)
+         ERR(_("Out of Memory"));
+   }
    solid_init( dyn, mass, dir, pos, vel, update );
    return dyn;
 }
@@ -298,5 +509,18 @@ Solid* solid_create( double mass, double dir,
  */
 void solid_free( Solid* src )
 {
-   free(src);
+   *(Solid**) src = solid_pool;
+   solid_pool     = src;
+}
+
+/**
+ * @brief Frees all the solids kept on the reuse pool.
+ */
+void solid_exit (void)
+{
+   while (solid_pool != NULL) {
+      Solid *next = *(Solid**) solid_pool;
+      free( solid_pool );
+      solid_pool = next;
+   }
 }
@@ -20,6 +20,7 @@ typedef struct Solid_ {
    double dir_vel; /**< Velocity at which solid is rotating in rad/s. */
    vec2 vel; /**< Velocity of the solid. */
    vec2 pos; /**< Position of the solid. */
+   vec2 pre; /**< Position before the last update, used for render interpolation. */
    double thrust; /**< Relative X force, basically simplified for our thrust model. */
    double speed_max; /**< Maximum speed. */
    void (*update)( struct Solid_*, double ); /**< Update method. */
@@ -29,11 +30,20 @@ typedef struct Solid_ {
  * solid manipulation
  */
 double solid_maxspeed( const Solid *s, double speed, double thrust );
+void solid_updateBatch( Solid *const *solids, const double *dts, int n );
 void solid_init( Solid* dest, double mass, double dir,
       const vec2* pos, const vec2* vel, int update );
 Solid* solid_create( double mass, double dir,
       const vec2* pos, const vec2* vel, int update );
 void solid_free( Solid* src );
+void solid_exit (void);
+
+/*
+ * render interpolation
+ */
+void solid_setRenderInterp( double alpha );
+double solid_getRenderInterp (void);
+void solid_renderPos( const Solid *s, double *x, double *y );
 
 /*
  * misc
@@ -27,7 +27,6 @@
 #include "explosion.h"
 #include "faction.h"
 #include "font.h"
-#include "gatherable.h"
 #include "gui.h"
 #include "hook.h"
 #include "land.h"
@@ -43,12 +42,16 @@
 #include "ntime.h"
 #include "nxml.h"
 #include "pause.h"
+#include "pilot_grid.h"
 #include "player.h"
 #include "player_autonav.h"
+#include "profiler.h"
 #include "rng.h"
+#include "threadpool.h"
 #include "weapon.h"
 
 #define PILOT_SIZE_MIN 128 /**< Minimum chunks to increment pilot_stack by */
+#define PILOT_RENDER_POINT 4. /**< On-screen size (px) below which pilots render as flat markers. */
 
 /* ID Generators. */
 static unsigned int pilot_id = PLAYER_ID; /**< Stack of pilot ids to assure uniqueness */
@@ -56,6 +59,10 @@ static unsigned int pilot_id = PLAYER_ID; /**< Stack of pilot ids to assure uniq
 /* stack of pilots */
 static Pilot** pilot_stack = NULL; /**< All the pilots in space. (Player may have other Pilot objects, e.g. backup ships.) */
 
+/* deferred spawn initialization; see pilots_updateDeferred(). */
+static int pilot_spawn_defer = 0; /**< Whether newly created pilots defer their init Lua. */
+static unsigned int *pilot_defer_queue = NULL; /**< Array (array.h): ids of pilots awaiting deferred init. */
+
 /* misc */
 static const double pilot_commTimeout  = 15.; /**< Time for text above pilot to time out. */
 static const double pilot_commFade     = 5.; /**< Time for text above pilot to fade out. */
@@ -85,6 +92,173 @@ Pilot*const* pilot_getAll (void)
    return pilot_stack;
 }
 
+/*
+ * Packed hot-path mirror of the pilot stack. The distance-scan loops
+ * only need position, velocity and radius, and the full Pilot struct is
+ * several KiB, so iterating pilot_stack trashes the cache. The mirror
+ * is rebuilt lazily whenever the stack or the solids have changed.
+ */
+static PilotView pilot_view = { .n = 0 }; /**< Exposed view. */
+static double *pv_x      = NULL; /**< Array (array.h): X positions. */
+static double *pv_y      = NULL; /**< Array (array.h): Y positions. */
+static double *pv_vx     = NULL; /**< Array (array.h): X velocities. */
+static double *pv_vy     = NULL; /**< Array (array.h): Y velocities. */
+static double *pv_radius = NULL; /**< Array (array.h): bounding radii. */
+static double *pv_d      = NULL; /**< Array (array.h): distance scratch. */
+static uint32_t *pv_flags = NULL; /**< Array (array.h): packed flags. */
+static unsigned int *pv_id = NULL; /**< Array (array.h): pilot ids. */
+static int pilot_view_dirty = 1; /**< Whether the view needs a rebuild. */
+static unsigned int pilot_view_gen = 1; /**< Bumped on every view rebuild. */
+
+/**
+ * @brief Marks the pilot view as needing a rebuild.
+ */
+void pilots_viewDirty (void)
+{
+   pilot_view_dirty = 1;
+}
+
+/**
+ * @brief Gets the packed mirror of the pilot stack, rebuilding if necessary.
+ *
+ * Entries are in pilot stack order. The view is invalidated by any
+ * change to the stack or by the per-frame update.
+ */
+const PilotView* pilots_getView (void)
+{
+   int n;
+
+   if (!pilot_view_dirty)
+      return &pilot_view;
+
+   if (pv_x == NULL) {
+      pv_x      = array_create( double );
+      pv_y      = array_create( double );
+      pv_vx     = array_create( double );
+      pv_vy     = array_create( double );
+      pv_radius = array_create( double );
+      pv_d      = array_create( double );
+      pv_flags  = array_create( uint32_t );
+      pv_id     = array_create( unsigned int );
+   }
+
+   n = array_size( pilot_stack );
+   array_resize( &pv_x, n );
+   array_resize( &pv_y, n );
+   array_resize( &pv_vx, n );
+   array_resize( &pv_vy, n );
+   array_resize( &pv_radius, n );
+   array_resize( &pv_d, n );
+   array_resize( &pv_flags, n );
+   array_resize( &pv_id, n );
+
+   for (int i=0; i<n; i++) {
+      const Pilot *p = pilot_stack[i];
+      const glTexture *gfx = p->ship->gfx_space;
+      uint32_t f = 0;
+
+      pv_x[i]      = p->solid->pos.x;
+      pv_y[i]      = p->solid->pos.y;
+      pv_vx[i]     = p->solid->vel.x;
+      pv_vy[i]     = p->solid->vel.y;
+      pv_radius[i] = MAX( gfx->sw, gfx->sh ) / 2.;
+      pv_id[i]     = p->id;
+      if (pilot_isFlag( p, PILOT_DELETE ))
+         f |= PILOT_VIEW_DELETE;
+      if (pilot_isFlag( p, PILOT_HIDE ))
+         f |= PILOT_VIEW_HIDE;
+      if (pilot_isDisabled( p ))
+         f |= PILOT_VIEW_DISABLED;
+      pv_flags[i]  = f;
+   }
+
+   pilot_view.n      = n;
+   pilot_view.x      = pv_x;
+   pilot_view.y      = pv_y;
+   pilot_view.vx     = pv_vx;
+   pilot_view.vy     = pv_vy;
+   pilot_view.radius = pv_radius;
+   pilot_view.flags  = pv_flags;
+   pilot_view.id     = pv_id;
+   pilot_view_dirty  = 0;
+   pilot_view_gen++;
+   return &pilot_view;
+}
+
+/*
+ * Per-faction enemy candidate cache. The nearest-enemy queries used to
+ * test hostility against every pilot in the system for every query, but
+ * all pilots of one faction share the same set of possible enemies, so
+ * the filtered index list is built once per view rebuild and shared by
+ * every query that frame. Player-side hostility depends on per-pilot
+ * flags (PILOT_HOSTILE, PILOT_BRIBED, ...), so pilots flying with the
+ * player always stay in the candidate lists and the exact per-pair
+ * check still runs at query time; the lists are a conservative filter,
+ * never the final word.
+ */
+typedef struct PilotEnemyCache_ {
+   int *idx; /**< Array (array.h): stack indices of the possible enemies. */
+   unsigned int gen; /**< View generation the list was built at. */
+} PilotEnemyCache;
+static PilotEnemyCache *pilot_enemy_cache = NULL; /**< Array (array.h): per-faction lists. */
+
+/**
+ * @brief Gets the possible enemies of a pilot as pilot stack indices.
+ *
+ * The returned array (array.h) is shared by all pilots of the same
+ * faction and valid until the view is rebuilt. Callers must still run
+ * the exact hostility/visibility checks per candidate.
+ *
+ *    @param p Pilot to get the enemy candidates of.
+ *    @return Array (array.h) of indices into the pilot stack.
+ */
+const int* pilot_enemyCandidates( const Pilot *p )
+{
+   PilotEnemyCache *c;
+   int f, slot, wp;
+
+   pilots_getView(); /* Makes sure the generation is current. */
+
+   /* Slot 0 holds the player-side list, slot 1 the invalid-faction list
+    * and the rest map the faction ids directly. */
+   wp = pilot_isWithPlayer( p );
+   f  = (!wp && faction_isFaction( p->faction )) ? p->faction : -1;
+   slot = wp ? 0 : (f < 0 ? 1 : f+2);
+
+   if (pilot_enemy_cache == NULL)
+      pilot_enemy_cache = array_create( PilotEnemyCache );
+   while (array_size(pilot_enemy_cache) <= slot) {
+      PilotEnemyCache *nc = &array_grow( &pilot_enemy_cache );
+      nc->idx = NULL;
+      nc->gen = 0;
+   }
+
+   c = &pilot_enemy_cache[slot];
+   if (c->gen == pilot_view_gen)
+      return c->idx;
+
+   if (c->idx == NULL)
+      c->idx = array_create( int );
+   array_resize( &c->idx, 0 );
+   for (int i=0; i<array_size(pilot_stack); i++) {
+      const Pilot *t = pilot_stack[i];
+      if (wp) {
+         /* Player-side hostility is fully captured by pilot_isHostile(). */
+         if (!pilot_isHostile( t ))
+            continue;
+      }
+      else {
+         /* Faction hostility plus anyone on the player's side, whose
+          * hostility is decided per pilot. */
+         if (!pilot_isWithPlayer( t ) && !areEnemies( f, t->faction ))
+            continue;
+      }
+      array_push_back( &c->idx, i );
+   }
+   c->gen = pilot_view_gen;
+   return c->idx;
+}
+
 /**
  * @brief Compare id (for use with bsearch)
  */
@@ -272,6 +446,19 @@ int pilot_validEnemy( const Pilot* p, const Pilot* target )
  * @brief Same as pilot_validEnemy, but able to store the distance too.
  */
 int pilot_validEnemyDist( const Pilot* p, const Pilot* target, double *dist )
+{
+   double d = vec2_dist2( &p->solid->pos, &target->solid->pos );
+   if (dist != NULL)
+      *dist = d;
+   return pilot_validEnemyDist2( p, target, d );
+}
+
+/**
+ * @brief Same as pilot_validEnemy, but with the distance squared supplied.
+ *
+ * Used by the view loops that already ran a batched distance pass.
+ */
+int pilot_validEnemyDist2( const Pilot* p, const Pilot* target, double d2 )
 {
    /* Shouldn't be disabled. */
    if (pilot_isDisabled(target))
@@ -296,7 +483,7 @@ int pilot_validEnemyDist( const Pilot* p, const Pilot* target, double *dist )
       return 0;
 
    /* Must not be fuzzy. */
-   if (pilot_inRangePilot( p, target, dist ) != 1)
+   if (pilot_inRangePilotDist( p, target, d2 ) != 1)
       return 0;
 
    /* They're ok. */
@@ -313,19 +500,20 @@ unsigned int pilot_getNearestEnemy( const Pilot* p )
 {
    unsigned int tp = 0;
    double d = 0.;
-
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      double td;
-
-      if (!pilot_validEnemy( p, pilot_stack[i] ))
+   const int *cand = pilot_enemyCandidates( p );
+   const PilotView *pv = &pilot_view;
+   const double px = p->solid->pos.x;
+   const double py = p->solid->pos.y;
+
+   for (int j=0; j<array_size(cand); j++) {
+      int i = cand[j];
+      double d2 = pow2( px-pv->x[i] ) + pow2( py-pv->y[i] );
+      if (tp && (d2 >= d))
          continue;
-
-      /* Check distance. */
-      td = vec2_dist2(&pilot_stack[i]->solid->pos, &p->solid->pos);
-      if (!tp || (td < d)) {
-         d  = td;
-         tp = pilot_stack[i]->id;
-      }
+      if (!pilot_validEnemyDist2( p, pilot_stack[i], d2 ))
+         continue;
+      d  = d2;
+      tp = pv->id[i];
    }
    return tp;
 }
@@ -342,22 +530,25 @@ unsigned int pilot_getNearestEnemy_size( const Pilot* p, double target_mass_LB,
 {
    unsigned int tp = 0;
    double d = 0.;
-
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      double td;
-
-      if (!pilot_validEnemy( p, pilot_stack[i] ))
+   const int *cand = pilot_enemyCandidates( p );
+   const PilotView *pv = &pilot_view;
+   const double px = p->solid->pos.x;
+   const double py = p->solid->pos.y;
+
+   for (int j=0; j<array_size(cand); j++) {
+      int i = cand[j];
+      double d2 = pow2( px-pv->x[i] ) + pow2( py-pv->y[i] );
+      if (tp && (d2 >= d))
          continue;
 
       if (pilot_stack[i]->solid->mass < target_mass_LB || pilot_stack[i]->solid->mass > target_mass_UB)
          continue;
 
-      /* Check distance. */
-      td = vec2_dist2(&pilot_stack[i]->solid->pos, &p->solid->pos);
-      if (!tp || (td < d)) {
-         d = td;
-         tp = pilot_stack[i]->id;
-      }
+      if (!pilot_validEnemyDist2( p, pilot_stack[i], d2 ))
+         continue;
+
+      d = d2;
+      tp = pv->id[i];
    }
 
    return tp;
@@ -379,17 +570,17 @@ unsigned int pilot_getNearestEnemy_heuristic( const Pilot* p,
 {
    unsigned int tp = 0;
    double current_heuristic_value = 10e3;
+   const int *cand = pilot_enemyCandidates( p );
 
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      double temp;
-      Pilot *target = pilot_stack[i];
+   for (int j=0; j<array_size(cand); j++) {
+      double temp, td;
+      Pilot *target = pilot_stack[ cand[j] ];
 
-      if (!pilot_validEnemy( p, target ))
+      if (!pilot_validEnemyDist( p, target, &td ))
          continue;
 
       /* Check distance. */
-      temp = range_factor *
-               vec2_dist2( &target->solid->pos, &p->solid->pos )
+      temp = range_factor * td
             + FABS( pilot_relsize( p, target ) - mass_factor )
             + FABS( pilot_relhp(   p, target ) - health_factor )
             + FABS( pilot_reldps(  p, target ) - damage_factor );
@@ -492,34 +683,37 @@ unsigned int pilot_getBoss( const Pilot* p )
 double pilot_getNearestPos( const Pilot *p, unsigned int *tp, double x, double y, int disabled )
 {
    double d = 0.;
+   const PilotView *pv = pilots_getView();
+
+   /* Distance pass over the packed arrays; vectorizes cleanly. */
+   for (int i=0; i<pv->n; i++)
+      pv_d[i] = pow2( x-pv->x[i] ) + pow2( y-pv->y[i] );
 
    *tp = PLAYER_ID;
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      double td;
+   for (int i=0; i<pv->n; i++) {
+      if ((*tp!=PLAYER_ID) && (pv_d[i] >= d))
+         continue;
 
       /* Must not be self. */
       if (pilot_stack[i] == p)
          continue;
 
+      /* Shouldn't be disabled. */
+      if (!disabled && (pv->flags[i] & PILOT_VIEW_DISABLED))
+         continue;
+
       /* Player doesn't select escorts (unless disabled is active). */
       if (!disabled && pilot_isPlayer(p) &&
             pilot_isWithPlayer(pilot_stack[i]))
          continue;
 
-      /* Shouldn't be disabled. */
-      if (!disabled && pilot_isDisabled(pilot_stack[i]))
-         continue;
-
       /* Must be a valid target. */
       if (!pilot_validTarget( p, pilot_stack[i] ))
          continue;
 
       /* Minimum distance. */
-      td = pow2(x-pilot_stack[i]->solid->pos.x) + pow2(y-pilot_stack[i]->solid->pos.y);
-      if (((*tp==PLAYER_ID) || (td < d))) {
-         d = td;
-         *tp = pilot_stack[i]->id;
-      }
+      d = pv_d[i];
+      *tp = pv->id[i];
    }
    return d;
 }
@@ -1674,6 +1868,11 @@ void pilot_updateDisable( Pilot* p, unsigned int shooter )
          hparam.type       = HOOK_PARAM_NIL;
       }
       pilot_runHookParam( p, PILOT_HOOK_DISABLE, &hparam, 1 ); /* Already disabled. */
+
+      /* Precompute the boarding loot here, off the interaction path, so
+       * the boarding window later opens straight from the cache. */
+      if (!pilot_isPlayer(p) && !pilot_isFlag(p, PILOT_NOBOARD))
+         board_precompute( p );
    }
    else if (pilot_isFlag(p, PILOT_DISABLED) && (p->armour > p->stress)) { /* Pilot is disabled, but shouldn't be. */
       pilot_rmFlag( p, PILOT_DISABLED ); /* Undisable. */
@@ -1850,7 +2049,7 @@ void pilot_renderFramebuffer( Pilot *p, GLuint fbo, double fw, double fh )
  */
 void pilot_render( Pilot *p )
 {
-   double scale, x,y, w,h, z;
+   double scale, x,y, w,h, z, rx,ry;
    Effect *e = NULL;
    glColour c = {.r=1., .g=1., .b=1., .a=1.};
 
@@ -1862,13 +2061,27 @@ void pilot_render( Pilot *p )
    z = cam_getZoom();
    w = p->ship->gfx_space->sw;
    h = p->ship->gfx_space->sh;
-   gl_gameToScreenCoords( &x, &y, p->solid->pos.x-w/2., p->solid->pos.y-h/2. );
+   solid_renderPos( p->solid, &rx, &ry );
+   gl_gameToScreenCoords( &x, &y, rx-w/2., ry-h/2. );
 
    /* Check if inbounds */
    if ((x < -w) || (x > SCREEN_W+w) ||
          (y < -h) || (y > SCREEN_H+h))
       return;
 
+   /* Pilots covering only a few pixels collapse into a flat marker,
+    * skipping the interpolated sprite shader and texture fetches; the
+    * mipmapped ship sheets handle every size in between. */
+   if (MAX( w, h ) * z < PILOT_RENDER_POINT) {
+      double px, py, ps;
+      if (pilot_isFlag(p, PILOT_STEALTH))
+         c.a = 0.5;
+      ps = MAX( 1., MIN( w, h ) * z );
+      gl_gameToScreenCoords( &px, &py, rx, ry );
+      gl_renderRect( px-ps/2., py-ps/2., ps, ps, &c );
+      return;
+   }
+
    /* Render effects. */
    for (int i=0; i<array_size(p->effects); i++) {
    //for (int i=array_size(p->effects)-1; i>=0; i--) {
@@ -1902,7 +2115,7 @@ void pilot_render( Pilot *p )
       }
       else {
          gl_renderSpriteInterpolateScale( p->ship->gfx_space, p->ship->gfx_engine,
-               1.-p->engine_glow, p->solid->pos.x, p->solid->pos.y,
+               1.-p->engine_glow, rx, ry,
                scale, scale, p->tsx, p->tsy, &c );
       }
    }
@@ -1914,7 +2127,7 @@ void pilot_render( Pilot *p )
       /* Render onto framebuffer. */
       pilot_renderFramebuffer( p, gl_screen.fbo[2], gl_screen.nw, gl_screen.nh );
 
-      glUseProgram( ed->program );
+      gl_useProgram( ed->program );
 
       glActiveTexture( GL_TEXTURE0 );
       glBindTexture( GL_TEXTURE_2D, gl_screen.fbo_tex[2] );
@@ -2045,7 +2258,6 @@ void pilot_update( Pilot* pilot, double dt )
    int cooling, nchg;
    Pilot *target;
    double a, px,py, vx,vy;
-   double Q;
 
    /* Modify the dt with speedup. */
    dt *= pilot->stats.time_speedup;
@@ -2096,7 +2308,6 @@ void pilot_update( Pilot* pilot, double dt )
    }
    /* Update heat. */
    a = -1.;
-   Q = 0.;
    nchg = 0; /* Number of outfits that change state, processed at the end. */
    for (int i=0; i<array_size(pilot->outfits); i++) {
       PilotOutfitSlot *o = pilot->outfits[i];
@@ -2164,22 +2375,19 @@ void pilot_update( Pilot* pilot, double dt )
          }
       }
 
-      /* Handle heat. */
-      if (!cooling)
-         Q  += pilot_heatUpdateSlot( pilot, o, dt );
-
       /* Handle lockons. */
       pilot_lockUpdateSlot( pilot, o, target, &a, dt );
    }
 
-   /* Global heat. */
-   if (!cooling)
-      pilot_heatUpdateShip( pilot, Q, dt );
-   else
+   /* Global heat. Normal heat flow is handled in the parallel pass
+    * (pilot_updateParallel); active cooldown refills ammo and thus
+    * must stay serial. */
+   if (cooling)
       pilot_heatUpdateCooldown( pilot );
 
-   /* Update electronic warfare. */
-   pilot_ewUpdateDynamic( pilot, dt );
+   /* Update electronic warfare scanning; may run hooks so has to be
+    * serial. The pure values are computed in the parallel pass. */
+   pilot_ewUpdateScan( pilot, dt );
 
    /* Update stress. */
    if (!pilot_isFlag(pilot, PILOT_DISABLED)) { /* Case pilot is not disabled. */
@@ -2440,7 +2648,7 @@ void pilot_update( Pilot* pilot, double dt )
    }
 
    /* Update weapons. */
-   pilot_weapSetUpdate( pilot );
+   pilot_weapSetUpdate( pilot, dt );
 
    if (!pilot_isFlag(pilot, PILOT_HYPERSPACE)) { /* limit the speed */
 
@@ -2496,10 +2704,6 @@ void pilot_update( Pilot* pilot, double dt )
    gl_getSpriteFromDir( &pilot->tsx, &pilot->tsy,
          pilot->ship->gfx_space, pilot->solid->dir );
 
-   /* See if there is commodities to gather. */
-   if (!pilot_isDisabled(pilot))
-      gatherable_gather( pilot );
-
    /* Update the trail. */
    pilot_sample_trails( pilot, 0 );
 
@@ -2993,11 +3197,15 @@ static void pilot_init( Pilot* pilot, const Ship* ship, const char* name, int fa
    /* Initialize heat. */
    pilot_heatReset( pilot );
 
-   /* Set the pilot stats based on their ship and outfits */
+   /* Set the pilot stats based on their ship and outfits.  The pilot still
+    * has the ship's default loadout here, so the static slot block can be
+    * shared across all pilots of the same ship. */
+   pilot_tmplSeed( pilot );
    pilot_calcStats( pilot );
+   pilot_tmplStore( pilot );
 
    /* Update dynamic electronic warfare (static should have already been done). */
-   pilot_ewUpdateDynamic( pilot, 0. );
+   pilot_ewUpdateDynamic( pilot );
 
    /* Heal up the ship. */
    pilot->armour = pilot->armour_max;
@@ -3063,8 +3271,7 @@ static void pilot_init( Pilot* pilot, const Ship* ship, const char* name, int fa
 void pilot_reset( Pilot* pilot )
 {
    /* Clean up flag.s */
-   for (int i=PILOT_NOCLEAR+1; i<PILOT_FLAGS_MAX; i++)
-      pilot->flags[i] = 0;
+   pilot_clearFlagsFromRaw( pilot->flags, PILOT_NOCLEAR+1 );
 
    /* Initialize heat. */
    pilot_heatReset( pilot );
@@ -3073,7 +3280,7 @@ void pilot_reset( Pilot* pilot )
    pilot_calcStats( pilot );
 
    /* Update dynamic electronic warfare (static should have already been done). */
-   pilot_ewUpdateDynamic( pilot, 0. );
+   pilot_ewUpdateDynamic( pilot );
 
    /* Clear timers. */
    pilot_clearTimers(pilot);
@@ -3114,6 +3321,29 @@ static void pilot_init_trails( Pilot* p )
    array_shrink( &p->trail );
 }
 
+/*
+ * System entry tears the whole pilot stack down and respawns it in one
+ * burst, so freed Pilot structures are kept on a free list and reused
+ * instead of hitting the heap every time. The first bytes of a pooled
+ * pilot hold the next link; pilot_init overwrites them on reuse.
+ */
+static Pilot *pilot_pool = NULL; /**< Free list of pilots for reuse. */
+
+/**
+ * @brief Gets a Pilot structure from the pool, or the heap if empty.
+ */
+static Pilot* pilot_alloc (void)
+{
+   Pilot *dyn;
+   if (pilot_pool != NULL) {
+      dyn        = pilot_pool;
+      pilot_pool = *(Pilot**) dyn;
+   }
+   else
+      dyn = malloc( sizeof(Pilot) );
+   return dyn;
+}
+
 /**
  * @brief Creates a new pilot
  *
@@ -3130,7 +3360,7 @@ unsigned int pilot_create( const Ship* ship, const char* name, int faction, cons
    Pilot *dyn, **p;
 
    /* Allocate pilot memory. */
-   dyn = malloc(sizeof(Pilot));
+   dyn = pilot_alloc();
    if (dyn == NULL) {
       WARN(_("Unable to allocate memory"));
       return 0;
@@ -3154,14 +3384,27 @@ unsigned int pilot_create( const Ship* ship, const char* name, int faction, cons
    /* Initialize AI if applicable. */
    if (ai == NULL)
       ai = faction_default_ai( faction );
-   if (ai != NULL)
+   if (ai != NULL) {
+      /* Bulk spawns (the spawn scheduler) spread the expensive equip and
+       * create Lua over the following frames; the pilot coasts inert in
+       * the meantime. */
+      if (pilot_spawn_defer && !pilot_isFlagRaw(flags, PILOT_PLAYER))
+         pilot_setFlag( dyn, PILOT_AI_DEFER );
       ai_pinit( dyn, ai ); /* Must run before ai_create */
+   }
 
    /* Animated trail. */
    pilot_init_trails( dyn );
 
    /* Run Lua stuff. */
-   pilot_outfitLInitAll( dyn );
+   if (pilot_isFlag( dyn, PILOT_AI_DEFER )) {
+      /* Outfit init must wait for the deferred equip. */
+      if (pilot_defer_queue == NULL)
+         pilot_defer_queue = array_create( unsigned int );
+      array_push_back( &pilot_defer_queue, dyn->id );
+   }
+   else
+      pilot_outfitLInitAll( dyn );
 
    return dyn->id;
 }
@@ -3178,7 +3421,7 @@ unsigned int pilot_create( const Ship* ship, const char* name, int faction, cons
 Pilot* pilot_createEmpty( const Ship* ship, const char* name,
       int faction, PilotFlags flags )
 {
-   Pilot *dyn = malloc(sizeof(Pilot));
+   Pilot *dyn = pilot_alloc();
    if (dyn == NULL) {
       WARN(_("Unable to allocate memory"));
       return 0;
@@ -3202,7 +3445,7 @@ unsigned int pilot_clone( const Pilot *ref )
    pilot_setFlagRaw( pf, PILOT_NO_OUTFITS );
 
    /* Allocate pilot memory. */
-   dyn = malloc(sizeof(Pilot));
+   dyn = pilot_alloc();
    if (dyn == NULL) {
       WARN(_("Unable to allocate memory"));
       return 0;
@@ -3242,6 +3485,9 @@ unsigned int pilot_addStack( Pilot *p )
    pilot_init_trails( p );
 
    array_push_back( &pilot_stack, p );
+   pilots_viewDirty();
+   /* The push may have reallocated the stack the grid indexes into. */
+   pilotgrid_rebuild();
 
 #if DEBUGGING
    for (int i=1; i<array_size(pilot_stack); i++)
@@ -3285,6 +3531,7 @@ Pilot* pilot_setPlayer( Pilot* after )
    }
    after->id = PLAYER_ID;
    qsort( pilot_stack, array_size(pilot_stack), sizeof(Pilot*), pilot_cmp );
+   pilotgrid_rebuild(); /* Stack order changed; stored indices are stale. */
 
    /* Set up stuff. */
    player.p = after;
@@ -3456,7 +3703,9 @@ void pilot_free( Pilot *p )
    memset( p, 0, sizeof(Pilot) );
 #endif /* DEBUGGING */
 
-   free(p);
+   /* Keep the structure around for the next spawn burst. */
+   *(Pilot**) p = pilot_pool;
+   pilot_pool   = p;
 }
 
 /**
@@ -3492,6 +3741,8 @@ void pilot_destroy( Pilot *p )
    /* pilot is eliminated */
    pilot_free(p);
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i+1] );
+   pilots_viewDirty();
+   pilotgrid_rebuild(); /* Indices past the erased slot shifted. */
 }
 
 /**
@@ -3506,6 +3757,7 @@ void pilot_stackRemove( Pilot *p )
 #endif /* DEBUGGING */
    p->id = 0;
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i+1] );
+   pilotgrid_rebuild(); /* Indices past the erased slot shifted. */
 }
 
 /**
@@ -3536,6 +3788,29 @@ void pilots_free (void)
       pilot_free(pilot_stack[i]);
    array_free(pilot_stack);
    pilot_stack = NULL;
+   while (pilot_pool != NULL) {
+      Pilot *next = *(Pilot**) pilot_pool;
+      free( pilot_pool );
+      pilot_pool = next;
+   }
+   array_free( pilot_defer_queue );
+   pilot_defer_queue = NULL;
+   pilot_tmplClear();
+   pilotgrid_exit();
+   array_free( pv_x );      pv_x = NULL;
+   array_free( pv_y );      pv_y = NULL;
+   array_free( pv_vx );     pv_vx = NULL;
+   array_free( pv_vy );     pv_vy = NULL;
+   array_free( pv_radius ); pv_radius = NULL;
+   array_free( pv_d );      pv_d = NULL;
+   array_free( pv_flags );  pv_flags = NULL;
+   array_free( pv_id );     pv_id = NULL;
+   for (int i=0; i < array_size(pilot_enemy_cache); i++)
+      array_free( pilot_enemy_cache[i].idx );
+   array_free( pilot_enemy_cache );
+   pilot_enemy_cache = NULL;
+   pilot_view.n = 0;
+   pilot_view_dirty = 1;
    player.p = NULL;
    free( player.ps.acquired );
    memset( &player.ps, 0, sizeof(PlayerShip_t) );
@@ -3589,6 +3864,9 @@ void pilots_clean( int persist )
    }
    array_erase( &pilot_stack, &pilot_stack[persist_count], array_end(pilot_stack) );
 
+   /* The grid still indexes the old stack contents. */
+   pilotgrid_rebuild();
+
    /* Clear global hooks. */
    pilots_clearGlobalHooks();
 }
@@ -3628,6 +3906,85 @@ void pilots_cleanAll (void)
       memset( &player.ps, 0, sizeof(PlayerShip_t) );
    }
    array_erase( &pilot_stack, array_begin(pilot_stack), array_end(pilot_stack) );
+   pilotgrid_rebuild();
+}
+
+#define PILOT_DEFER_BUDGET 2 /**< Deferred pilot initializations to finish per frame. */
+
+/**
+ * @brief Sets whether new pilots defer their equip/AI create Lua.
+ *
+ * Enabled around the spawn scheduler so fleet spawns don't run all their
+ * init Lua in a single frame; see pilots_updateDeferred().
+ *
+ *    @param enable Whether to defer.
+ */
+void pilots_spawnDeferred( int enable )
+{
+   pilot_spawn_defer = enable;
+}
+
+/**
+ * @brief Finishes the initialization of bulk-spawned pilots, a few per frame.
+ */
+static void pilots_updateDeferred (void)
+{
+   int n = 0;
+   while ((array_size(pilot_defer_queue) > 0) && (n < PILOT_DEFER_BUDGET)) {
+      Pilot *p = pilot_get( pilot_defer_queue[0] );
+      array_erase( &pilot_defer_queue, &pilot_defer_queue[0], &pilot_defer_queue[1] );
+      if (p == NULL)
+         continue; /* Removed before its init came up. */
+      ai_pinitFinish( p );
+      pilot_rmFlag( p, PILOT_AI_DEFER );
+      pilot_outfitLInitAll( p );
+      n++;
+   }
+}
+
+#define PILOT_UPDATE_CHUNK 32 /**< Pilots per parallel-for chunk. */
+
+/**
+ * @brief Per-pilot update work that only touches the pilot itself.
+ *
+ * Must not access other pilots, global stacks nor run hooks, as it is
+ * run concurrently for different pilots.
+ *
+ *    @param pilot Pilot to update.
+ *    @param dt Delta tick for the update.
+ */
+static void pilot_updateParallel( Pilot *pilot, double dt )
+{
+   /* Modify the dt with speedup, same as pilot_update(). */
+   dt *= pilot->stats.time_speedup;
+
+   /* Heat flow is pure per-pilot math. Active cooldown is handled
+    * serially in pilot_update() as it refills ammo. */
+   if (!pilot_isFlag( pilot, PILOT_COOLDOWN ))
+      pilot_heatUpdate( pilot, dt );
+
+   /* Dynamic electronic warfare values; the scanning logic runs hooks
+    * and stays in pilot_update(). The environment terms (asteroid field
+    * and jump point factors) change slowly, so they are refreshed at
+    * EW_ENV_UPDATE_DT and the last values held in between. Stealth
+    * toggles and outfit changes refresh them immediately. */
+   pilot->ew_timer -= dt;
+   if (pilot->ew_timer <= 0.)
+      pilot_ewUpdateDynamic( pilot );
+}
+
+/**
+ * @brief Updates a range of the pilot stack (vpool_for worker).
+ */
+static void pilots_updateChunk( int begin, int end, void *data )
+{
+   double dt = *(double*) data;
+   for (int i=begin; i<end; i++) {
+      Pilot *p = pilot_stack[i];
+      if (pilot_isAnyFlag(p, PILOT_MASK_SKIP))
+         continue;
+      pilot_updateParallel( p, dt );
+   }
 }
 
 /**
@@ -3635,8 +3992,41 @@ void pilots_cleanAll (void)
  *
  *    @param dt Delta tick for the update.
  */
+#define PILOT_THINK_DIST_NEAR 5e3  /**< Within this distance of the player AI thinks every frame. */
+#define PILOT_THINK_DIST_FAR  15e3 /**< Beyond this AI thinks at quarter rate; in between, half rate. */
+
+/**
+ * @brief Gets how many frames pass between AI think ticks for a pilot.
+ *
+ * Far away pilots barely interact with the player and keep their last
+ * steering between ticks, so throttling their Lua is invisible.
+ */
+static int pilot_thinkRate( const Pilot *p )
+{
+   double d2;
+
+   /* Manual control can be driven by mission scripts; don't throttle. */
+   if (pilot_isFlag(p, PILOT_MANUAL_CONTROL))
+      return 1;
+   if (player.p == NULL)
+      return 1;
+
+   d2 = vec2_dist2( &p->solid->pos, &player.p->solid->pos );
+   if (d2 < pow2(PILOT_THINK_DIST_NEAR))
+      return 1;
+   else if (d2 < pow2(PILOT_THINK_DIST_FAR))
+      return 2;
+   return 4;
+}
+
 void pilots_update( double dt )
 {
+   static unsigned int think_frame = 0; /**< For staggering throttled AI ticks. */
+
+   /* Positions change over the frame, so any previous view is stale. */
+   pilots_viewDirty();
+   think_frame++;
+
    /* Delete loop - this should be atomic or we get hook fuckery! */
    for (int i=array_size(pilot_stack)-1; i>=0; i--) {
       Pilot *p = pilot_stack[i];
@@ -3649,6 +4039,9 @@ void pilots_update( double dt )
          pilot_destroy(p);
    }
 
+   /* Finish a few deferred bulk-spawn initializations. */
+   pilots_updateDeferred();
+
    /* Have all the pilots think. */
    for (int i=0; i<array_size(pilot_stack); i++) {
       Pilot *p = pilot_stack[i];
@@ -3663,6 +4056,10 @@ void pilots_update( double dt )
       if (pilot_isFlag(p,PILOT_DEAD))
          continue;
 
+      /* Still waiting on its deferred create Lua; coasts inert. */
+      if (pilot_isFlag(p, PILOT_AI_DEFER))
+         continue;
+
       /* Ignore persisting pilots during simulation since they don't get cleared. */
       if (space_isSimulation() && (pilot_isFlag(p,PILOT_PERSIST)))
          continue;
@@ -3685,11 +4082,24 @@ void pilots_update( double dt )
             !pilot_isFlag(p, PILOT_HYP_END)) {
          if (pilot_isFlag(p, PILOT_PLAYER))
             player_think( p, dt );
-         else
-            ai_think( p, dt );
+         else {
+            /* Throttle far-away pilots, staggered by id so the ticks
+             * spread evenly across frames. */
+            int rate = pilot_thinkRate( p );
+            if ((rate == 1) || (((think_frame + p->id) % (unsigned int)rate) == 0)) {
+               prof_begin( PROF_AI );
+               ai_think( p, dt );
+               prof_end( PROF_AI );
+            }
+         }
       }
    }
 
+   /* Parallel pass: shard the self-contained per-pilot work across the
+    * threadpool before the serial update below. */
+   vpool_for( pilots_updateChunk, 0, array_size(pilot_stack),
+         PILOT_UPDATE_CHUNK, &dt );
+
    /* Now update all the pilots. */
    for (int i=0; i<array_size(pilot_stack); i++) {
       Pilot *p = pilot_stack[i];
@@ -3708,6 +4118,41 @@ void pilots_update( double dt )
       else
          pilot_update( p, dt );
    }
+
+   /* Rebuild the spatial hash now that everyone has moved. */
+   pilotgrid_rebuild();
+   pilots_viewDirty();
+}
+
+/**
+ * @brief Gets the pilots whose bounding circles can touch the screen, in
+ *        stack order.
+ */
+static Pilot *const* pilots_queryVisible (void)
+{
+   double cx, cy, r;
+   vec2 pos;
+
+   cam_getPos( &cx, &cy );
+   vec2_cset( &pos, cx, cy );
+   r = 0.5 * hypot( SCREEN_W, SCREEN_H ) / cam_getZoom();
+   return pilotgrid_queryCircleOrdered( &pos, r );
+}
+
+/**
+ * @brief qsort comparison grouping pilots by sprite sheet, then stack order.
+ */
+static int pilot_cmpRender( const void *a, const void *b )
+{
+   const Pilot *pa = *(Pilot* const*) a;
+   const Pilot *pb = *(Pilot* const*) b;
+   if (pa->ship->gfx_space != pb->ship->gfx_space)
+      return (pa->ship->gfx_space < pb->ship->gfx_space) ? -1 : 1;
+   if (pa->id < pb->id)
+      return -1;
+   else if (pa->id > pb->id)
+      return 1;
+   return 0;
 }
 
 /**
@@ -3715,16 +4160,29 @@ void pilots_update( double dt )
  */
 void pilots_render (void)
 {
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      Pilot *p = pilot_stack[i];
+   static Pilot **render_list = NULL;
+   Pilot *const* visible = pilots_queryVisible();
+
+   /* Gather the pilots that actually get drawn so they can be ordered by
+    * sprite sheet; interleaved fleets would otherwise rebind the texture
+    * on nearly every draw. Ids break ties so overlap stays deterministic. */
+   if (render_list == NULL)
+      render_list = array_create( Pilot* );
+   array_resize( &render_list, 0 );
+   for (int i=0; i<array_size(visible); i++) {
+      Pilot *p = visible[i];
 
       /* Invisible, not doing anything. */
-      if (pilot_isFlag(p, PILOT_HIDE) || pilot_isFlag(p, PILOT_DELETE))
+      if (pilot_isAnyFlag(p, PILOT_MASK_SKIP))
          continue;
 
       if (!pilot_isFlag( p, PILOT_PLAYER ))
-         pilot_render( p );
+         array_push_back( &render_list, p );
    }
+   qsort( render_list, array_size(render_list), sizeof(Pilot*), pilot_cmpRender );
+
+   for (int i=0; i<array_size(render_list); i++)
+      pilot_render( render_list[i] );
 }
 
 /**
@@ -3732,11 +4190,12 @@ void pilots_render (void)
  */
 void pilots_renderOverlay (void)
 {
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      Pilot *p = pilot_stack[i];
+   Pilot *const* visible = pilots_queryVisible();
+   for (int i=0; i<array_size(visible); i++) {
+      Pilot *p = visible[i];
 
       /* Invisible, not doing anything. */
-      if (pilot_isFlag(p, PILOT_HIDE) || pilot_isFlag(p, PILOT_DELETE))
+      if (pilot_isAnyFlag(p, PILOT_MASK_SKIP))
          continue;
 
       if (!pilot_isFlag( p, PILOT_PLAYER ))
@@ -3,6 +3,10 @@
  */
 #pragma once
 
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
 #include "pilot_flags.h"
 
 #include "ai.h"
@@ -157,6 +161,7 @@ typedef struct PilotWeaponSetOutfit_ {
 typedef struct PilotWeaponSet_ {
    int type;      /**< Type of the weaponset. */
    int active;    /**< Whether or not it's currently firing. */
+   double wait;   /**< Time until a blocked set could possibly fire again; fire scans are skipped until then. */
    PilotWeaponSetOutfit *slots; /**< Slots involved with the weapon set. */
    /* Only applicable to weapon type. */
    int inrange;   /**< Whether or not to fire only if the target is inrange. */
@@ -268,6 +273,12 @@ typedef struct Pilot_ {
    double ew_jumppoint; /**< Jump point factor, affects stealth. */
    /* misc. */
    double ew_stealth_timer; /**< Stealth timer. */
+   double ew_timer;     /**< Refresh timer for the environment electronic warfare terms. */
+   double ew_scan_timer; /**< Countdown until the next full stealth proximity scan. */
+   double ew_scan_mod;  /**< Cached proximity modifier from the last scan. */
+   int ew_scan_n;       /**< Cached number of stealth-breaking pilots nearby. */
+   int ew_scan_close;   /**< Cached number of close pilots (player only). */
+   int ew_scan_isplayer; /**< Cached whether the player was among the breakers. */
 
    /* Heat. */
    double heat_T;    /**< Ship temperature. [K] */
@@ -282,6 +293,12 @@ typedef struct Pilot_ {
    /* Ship statistics. */
    ShipStats intrinsic_stats; /**< Intrinsic statistics to the ship create on the fly. */
    ShipStats stats;  /**< Pilot's copy of ship statistics, used for comparisons.. */
+   /* Cached contribution of the static outfit slots (see pilot_calcStats()). */
+   ShipStats stats_static; /**< Merged stats of the slots that can't change without a refit. */
+   double cpu_static;   /**< CPU usage of the static slots. */
+   double mass_static;  /**< Outfit mass of the static slots. */
+   double base_mass_static; /**< Core outfit mass of the static slots. */
+   int stats_static_valid; /**< Whether the static slot cache is up to date. */
 
    /* Ship effects. */
    Effect *effects; /**< Pilot's current activated effects. */
@@ -318,6 +335,7 @@ typedef struct Pilot_ {
 
    /* Hook attached to the pilot */
    PilotHook *hooks; /**< Array (array.h): Pilot hooks. */
+   uint32_t hook_mask; /**< Bitmask of hook types present in hooks, bit is 1<<type. */
 
    /* Escort stuff. */
    unsigned int parent; /**< Pilot's parent. */
@@ -379,6 +397,29 @@ typedef struct Pilot_ {
 #include "pilot_weapon.h"
 #include "pilot_ew.h"
 
+/*
+ * Packed structure-of-arrays mirror of the pilot stack for hot loops
+ * that only need position/velocity/radius. Entries are in stack order.
+ */
+#define PILOT_VIEW_DELETE     (1<<0) /**< Pilot is being deleted. */
+#define PILOT_VIEW_HIDE       (1<<1) /**< Pilot is hidden. */
+#define PILOT_VIEW_DISABLED   (1<<2) /**< Pilot is disabled. */
+/**
+ * @brief Read-only packed view of the pilot stack.
+ */
+typedef struct PilotView_ {
+   int n;                  /**< Number of pilots in the view. */
+   const double *x;        /**< X positions. */
+   const double *y;        /**< Y positions. */
+   const double *vx;       /**< X velocities. */
+   const double *vy;       /**< Y velocities. */
+   const double *radius;   /**< Bounding circle radii. */
+   const uint32_t *flags;  /**< Packed PILOT_VIEW_* flags. */
+   const unsigned int *id; /**< Pilot ids. */
+} PilotView;
+const PilotView* pilots_getView (void);
+void pilots_viewDirty (void);
+
 /*
  * Getting pilot stuff.
  */
@@ -387,6 +428,7 @@ Pilot* pilot_get( unsigned int id );
 Pilot* pilot_getTarget( Pilot *p );
 unsigned int pilot_getNextID( unsigned int id, int mode );
 unsigned int pilot_getPrevID( unsigned int id, int mode );
+const int* pilot_enemyCandidates( const Pilot *p );
 unsigned int pilot_getNearestEnemy( const Pilot* p );
 unsigned int pilot_getNearestEnemy_size( const Pilot* p, double target_mass_LB, double target_mass_UB );
 unsigned int pilot_getNearestEnemy_heuristic(const Pilot* p, double mass_factor, double health_factor, double damage_factor, double range_factor);
@@ -426,6 +468,7 @@ double pilot_aimAngle( Pilot *p, const Pilot *target );
  */
 int pilot_validEnemy( const Pilot* p, const Pilot* target );
 int pilot_validEnemyDist( const Pilot* p, const Pilot* target, double *dist );
+int pilot_validEnemyDist2( const Pilot* p, const Pilot* target, double d2 );
 int pilot_areAllies( const Pilot *p, const Pilot *target );
 int pilot_areEnemies( const Pilot *p, const Pilot *target );
 
@@ -451,6 +494,7 @@ PilotOutfitSlot* pilot_getDockSlot( Pilot* p );
 unsigned int pilot_create( const Ship* ship, const char* name, int faction, const char *ai,
       const double dir, const vec2* pos, const vec2* vel,
       const PilotFlags flags, unsigned int dockpilot, int dockslot );
+void pilots_spawnDeferred( int enable );
 Pilot* pilot_createEmpty( const Ship* ship, const char* name,
       int faction, PilotFlags flags );
 unsigned int pilot_clone( const Pilot *p );
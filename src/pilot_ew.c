@@ -18,11 +18,13 @@
 #include "pilot.h"
 #include "player.h"
 #include "player_autonav.h"
+#include "rng.h"
 #include "space.h"
 
 #define EW_ASTEROID_DIST      7.5e3
 #define EW_JUMPDETECT_DIST    7.5e3
 #define EW_SPOBDETECT_DIST  20e3 /* TODO something better than this. */
+#define EW_STEALTH_SCAN_DT    0.15 /**< Period of the full stealth proximity scan; also the worst-case extra detection latency. */
 
 static double ew_interference = 1.; /**< Interference factor. */
 
@@ -104,18 +106,35 @@ void pilot_ewUpdateStatic( Pilot *p )
 /**
  * @brief Updates the pilot's dynamic electronic warfare properties.
  *
+ * Only touches the pilot itself, so it is safe to run from the parallel
+ * pilot update pass, which calls this at EW_ENV_UPDATE_DT via ew_timer.
+ * Calling it directly refreshes the values immediately.
+ *
  *    @param p Pilot to update.
- *    @param dt Delta time increment (seconds).
  */
-void pilot_ewUpdateDynamic( Pilot *p, double dt )
+void pilot_ewUpdateDynamic( Pilot *p )
 {
-   Pilot *t;
-
    /* Electronic warfare values. */
    p->ew_asteroid = pilot_ewAsteroid( p );
    p->ew_jumppoint = pilot_ewJumpPoint( p );
    pilot_ewUpdate( p );
 
+   /* Restart the refresh period. */
+   p->ew_timer = EW_ENV_UPDATE_DT;
+}
+
+/**
+ * @brief Updates the pilot's scanning of their target.
+ *
+ * Runs the scan hooks, so it has to be called from the serial update.
+ *
+ *    @param p Pilot to update.
+ *    @param dt Delta time increment (seconds).
+ */
+void pilot_ewUpdateScan( Pilot *p, double dt )
+{
+   Pilot *t;
+
    /* Already scanned so skipping. */
    if (p->scantimer < 0.)
       return;
@@ -241,12 +260,25 @@ int pilot_inRange( const Pilot *p, double x, double y )
  */
 int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist2 )
 {
-   double d;
-
-   /* Get distance if needed. */
+   double d = vec2_dist2( &p->solid->pos, &target->solid->pos );
    if (dist2 != NULL)
-      *dist2 = vec2_dist2( &p->solid->pos, &target->solid->pos );
+      *dist2 = d;
+   return pilot_inRangePilotDist( p, target, d );
+}
 
+/**
+ * @brief Same as pilot_inRangePilot, but with the distance squared supplied.
+ *
+ * Lets the batched distance passes over the pilot view reuse their result
+ * instead of recomputing it per pair.
+ *
+ *    @param p Pilot who is trying to check to see if other is in sensor range.
+ *    @param target Target of p to check to see if is in sensor range.
+ *    @param d Distance squared between the two pilots.
+ *    @return 1 if they are in range, 0 if they aren't and -1 if they are detected fuzzily.
+ */
+int pilot_inRangePilotDist( const Pilot *p, const Pilot *target, double d )
+{
    /* Special case player or omni-visible. */
    if ((pilot_isPlayer(p) && pilot_isFlag(target, PILOT_VISPLAYER)) ||
          pilot_isFlag(target, PILOT_VISIBLE) ||
@@ -258,7 +290,6 @@ int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist2 )
       return 0;
 
    /* No stealth so normal detection. */
-   d = (dist2!=NULL ? *dist2 : vec2_dist2( &p->solid->pos, &target->solid->pos ) );
    if (d < pow2( MAX( 0., p->stats.ew_detect * p->stats.ew_track * target->ew_evasion )))
       return 1;
    else if  (d < pow2( MAX( 0., p->stats.ew_detect * target->ew_detection )))
@@ -472,20 +503,33 @@ void pilot_ewUpdateStealth( Pilot *p, double dt )
 
    if (!pilot_isFlag( p, PILOT_STEALTH ))
       return;
+   if (pilot_isPlayer(p) && pilot_isFlag(p, PILOT_NONTARGETABLE))
+      return;
 
-   /* Get nearby pilots. */
-   if (pilot_isPlayer(p)) {
-      if (pilot_isFlag(p, PILOT_NONTARGETABLE))
-         return;
-
-      n = pilot_ewStealthGetNearby( p, &mod, &close, &isplayer );
-
-      /* Stop autonav if pilots are nearby. */
-      if (close>0)
-         player_autonavResetSpeed();
+   /* The full proximity scan is O(pilots) per stealthed pilot, and its
+    * inputs (positions, detection stats) move slowly relative to a frame.
+    * It therefore runs every EW_STEALTH_SCAN_DT with the timer integrating
+    * the cached result in between; the scan phases are staggered across
+    * pilots (see pilot_stealth) so they don't land on the same frame.
+    * Stealth transitions still scan immediately via pilot_stealth. */
+   p->ew_scan_timer -= dt;
+   if (p->ew_scan_timer <= 0.) {
+      p->ew_scan_timer += EW_STEALTH_SCAN_DT;
+      if (pilot_isPlayer(p))
+         p->ew_scan_n = pilot_ewStealthGetNearby( p, &p->ew_scan_mod,
+               &p->ew_scan_close, &p->ew_scan_isplayer );
+      else
+         p->ew_scan_n = pilot_ewStealthGetNearby( p, &p->ew_scan_mod,
+               NULL, &p->ew_scan_isplayer );
    }
-   else
-      n = pilot_ewStealthGetNearby( p, &mod, NULL, &isplayer );
+   n        = p->ew_scan_n;
+   mod      = p->ew_scan_mod;
+   close    = p->ew_scan_close;
+   isplayer = p->ew_scan_isplayer;
+
+   /* Stop autonav if pilots are nearby. */
+   if (pilot_isPlayer(p) && (close > 0))
+      player_autonavResetSpeed();
 
    /* Increases if nobody nearby. */
    if (n == 0) {
@@ -537,6 +581,14 @@ int pilot_stealth( Pilot *p )
       pilot_calcStats(p);
    p->ew_stealth_timer = 0.;
 
+   /* The immediate scan above found nobody; seed the amortized scan cache
+    * with that result and stagger the next scan's phase. */
+   p->ew_scan_n        = 0;
+   p->ew_scan_mod      = 0.;
+   p->ew_scan_close    = 0;
+   p->ew_scan_isplayer = 0;
+   p->ew_scan_timer    = RNGF() * EW_STEALTH_SCAN_DT;
+
    /* Run hook. */
    const HookParam hparam = { .type = HOOK_PARAM_BOOL, .u.b = 1 };
    pilot_runHookParam( p, PILOT_HOOK_STEALTH, &hparam, 1 );
@@ -6,6 +6,7 @@
 #include "pilot.h"
 
 #define EW_JUMP_BONUS_RANGE   2500.
+#define EW_ENV_UPDATE_DT      0.1 /**< Refresh period for the environment EW terms (asteroid/jump factors). */
 
 /*
  * Sensors and range.
@@ -14,6 +15,7 @@ void pilot_updateSensorRange (void);
 double pilot_sensorRange( void );
 int pilot_inRange( const Pilot *p, double x, double y );
 int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist2);
+int pilot_inRangePilotDist( const Pilot *p, const Pilot *target, double d );
 int pilot_inRangeSpob( const Pilot *p, int target );
 int pilot_inRangeAsteroid( const Pilot *p, int ast, int fie );
 int pilot_inRangeJump( const Pilot *p, int target );
@@ -30,7 +32,8 @@ int pilot_ewScanCheck( const Pilot *p );
 double pilot_ewScanTime( const Pilot *p );
 void pilot_ewScanStart( Pilot *p );
 void pilot_ewUpdateStatic( Pilot *p );
-void pilot_ewUpdateDynamic( Pilot *p, double dt );
+void pilot_ewUpdateDynamic( Pilot *p );
+void pilot_ewUpdateScan( Pilot *p, double dt );
 
 /*
  * Stealth.
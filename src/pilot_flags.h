@@ -3,13 +3,32 @@
  */
 #pragma once
 
-#define pilot_clearFlagsRaw(a) memset((a), 0, PILOT_FLAGS_MAX) /**< Clears the pilot flags. */
-#define pilot_copyFlagsRaw(d,s) memcpy((d), (s), PILOT_FLAGS_MAX) /**< Copies the pilot flags from s to d. */
-#define pilot_isFlagRaw(a,f)  ((a)[f]) /**< Checks to see if a pilot flag is set. */
-#define pilot_setFlagRaw(a,f) ((a)[f] = 1) /**< Sets flags rawly. */
-#define pilot_isFlag(p,f)     ((p)->flags[f]) /**< Checks if flag f is set on pilot p. */
-#define pilot_setFlag(p,f)    ((p)->flags[f] = 1) /**< Sets flag f on pilot p. */
-#define pilot_rmFlag(p,f)     ((p)->flags[f] = 0) /**< Removes flag f on pilot p. */
+/** @cond */
+#include <stdint.h>
+#include <string.h>
+/** @endcond */
+
+/*
+ * Flags are stored as a word-wide bitset so hot filters can test several
+ * flags with a single AND through the pilot_isAnyFlag / PILOT_FLAG_BIT
+ * combined-mask interface.
+ */
+#define pilot_clearFlagsRaw(a) memset((a), 0, sizeof(PilotFlags)) /**< Clears the pilot flags. */
+#define pilot_copyFlagsRaw(d,s) memcpy((d), (s), sizeof(PilotFlags)) /**< Copies the pilot flags from s to d. */
+#define pilot_isFlagRaw(a,f)  (((a)[0] >> (f)) & 1ULL) /**< Checks to see if a pilot flag is set. */
+#define pilot_setFlagRaw(a,f) ((a)[0] |= 1ULL << (f)) /**< Sets flags rawly. */
+#define pilot_isFlag(p,f)     pilot_isFlagRaw((p)->flags,f) /**< Checks if flag f is set on pilot p. */
+#define pilot_setFlag(p,f)    pilot_setFlagRaw((p)->flags,f) /**< Sets flag f on pilot p. */
+#define pilot_rmFlag(p,f)     ((p)->flags[0] &= ~(1ULL << (f))) /**< Removes flag f on pilot p. */
+/* Combined-mask tests. */
+#define PILOT_FLAG_BIT(f)     (1ULL << (f)) /**< Mask bit for flag f, for combined tests. */
+#define pilot_isAnyFlag(p,m)  (((p)->flags[0] & (m)) != 0) /**< Checks if any flag of mask m is set on pilot p. */
+/** Clears flag f and every flag declared after it. */
+#define pilot_clearFlagsFromRaw(a,f) ((a)[0] &= PILOT_FLAG_BIT(f) - 1ULL)
+/** Pilots that per-frame loops should skip entirely. */
+#define PILOT_MASK_SKIP (PILOT_FLAG_BIT(PILOT_DELETE) | PILOT_FLAG_BIT(PILOT_HIDE))
+/** Pilots that weapons can never hit. */
+#define PILOT_MASK_NOHIT (PILOT_FLAG_BIT(PILOT_DELETE) | PILOT_FLAG_BIT(PILOT_DEAD) | PILOT_FLAG_BIT(PILOT_HIDE))
 enum {
    /*
     * Creation-time flags
@@ -18,6 +37,7 @@ enum {
    PILOT_PLAYER_FLEET,  /**< Pilot is part of the player's fleet. */
    PILOT_CARRIED,       /**< Pilot usually resides in a fighter bay. */
    PILOT_CREATED_AI,    /**< Pilot has already created AI. */
+   PILOT_AI_DEFER,      /**< Equip/AI create Lua deferred to a later frame; inert until run. */
    PILOT_NO_OUTFITS,    /**< Do not create the pilot with outfits. */
    /*
     * Dynamic flags
@@ -71,6 +91,8 @@ enum {
    PILOT_HILIGHT,       /**< Pilot is hilighted when visible (this does not increase visibility). */
    /* Outfit stuff. */
    PILOT_AFTERBURNER,   /**< Pilot has their afterburner activated. */
+   PILOT_OUTFIT_BATCH,  /**< Refit transaction open: stat recomputes deferred. */
+   PILOT_OUTFIT_DIRTY,  /**< Stats recompute requested during a refit transaction. */
    /* Refueling. */
    PILOT_REFUELING,     /**< Pilot is trying to refueling. */
    PILOT_REFUELBOARDING,/**< Pilot is actively refueling. */
@@ -86,4 +108,5 @@ enum {
    /* Sentinal. */
    PILOT_FLAGS_MAX      /**< Maximum number of flags. */
 };
-typedef char PilotFlags[ PILOT_FLAGS_MAX ];
+_Static_assert( PILOT_FLAGS_MAX <= 64, "pilot flags no longer fit in one word" );
+typedef uint64_t PilotFlags[1];
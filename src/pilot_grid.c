@@ -0,0 +1,423 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file pilot_grid.c
+ *
+ * @brief Maintains a spatial hash over the pilot stack.
+ *
+ * The grid is rebuilt once per frame from pilots_update() after all the
+ * solids have been integrated, and lets hot loops (weapon collision,
+ * explosions, proximity scans) test only the pilots whose bounding
+ * circles overlap a query region instead of walking the whole stack.
+ *
+ * A second cell layer covers asteroids.  It only holds the asteroids of
+ * armed fields (ones a weapon probed recently, see asteroids_arm), so
+ * mining fields with no combat near them cost nothing to the weapon
+ * collision pass happening elsewhere in-system.
+ */
+/** @cond */
+#include <math.h>
+#include <stdlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "pilot_grid.h"
+
+#include "array.h"
+#include "pilot.h"
+#include "space.h"
+
+#define GRID_CELL       512.  /**< Size of a hash cell in units. */
+#define GRID_NBUCKETS   256   /**< Number of hash buckets (power of two). */
+
+/**
+ * @brief A single hash bucket holding indices into the pilot stack.
+ */
+typedef struct GridBucket_ {
+   int *ids; /**< Array (array.h): indices into the snapshotted stack. */
+} GridBucket;
+
+/**
+ * @brief A reference to an asteroid in the asteroid layer.
+ */
+typedef struct AstRef_ {
+   const Asteroid *a; /**< The asteroid itself. */
+   int gid;           /**< Global index for dedup stamping. */
+} AstRef;
+
+/**
+ * @brief A hash bucket of the asteroid layer.
+ */
+typedef struct AstBucket_ {
+   AstRef *refs; /**< Array (array.h): asteroids overlapping the cell. */
+} AstBucket;
+
+static GridBucket grid_buckets[ GRID_NBUCKETS ]; /**< Bucket table. */
+static Pilot *const* grid_stack = NULL; /**< Stack snapshot the grid indexes into. */
+static int *grid_stamp    = NULL; /**< Array (array.h): dedup stamps per pilot. */
+static unsigned int grid_gen = 0; /**< Current dedup generation. */
+static Pilot **grid_result = NULL; /**< Array (array.h): reused query result. */
+
+static AstBucket ast_buckets[ GRID_NBUCKETS ]; /**< Asteroid layer buckets. */
+static int *ast_base      = NULL; /**< Array (array.h): global index base per anchor. */
+static int *ast_stamp     = NULL; /**< Array (array.h): dedup stamps per asteroid. */
+static unsigned int ast_gen = 0;  /**< Current asteroid dedup generation. */
+static Asteroid **ast_result = NULL; /**< Array (array.h): reused query result. */
+
+/*
+ * Prototypes.
+ */
+static int grid_hash( int cx, int cy );
+static double grid_pilotRadius( const Pilot *p );
+static void grid_gather( int cx, int cy );
+static void astgrid_gather( int cx, int cy );
+
+/**
+ * @brief Hashes a cell coordinate into a bucket index.
+ */
+static int grid_hash( int cx, int cy )
+{
+   unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u;
+   return (int)(h & (GRID_NBUCKETS-1));
+}
+
+/**
+ * @brief Gets the bounding circle radius of a pilot.
+ */
+static double grid_pilotRadius( const Pilot *p )
+{
+   const glTexture *gfx = p->ship->gfx_space;
+   return MAX( gfx->sw, gfx->sh ) / 2.;
+}
+
+/**
+ * @brief Rebuilds the spatial hash from the current pilot stack.
+ *
+ * Meant to be called once per frame after the pilots have moved. Any
+ * result from a previous query becomes invalid.
+ */
+void pilotgrid_rebuild (void)
+{
+   Pilot *const* pilot_stack = pilot_getAll();
+
+   /* Lazy initialization. */
+   if (grid_result == NULL) {
+      grid_result = array_create( Pilot* );
+      grid_stamp  = array_create( int );
+      for (int i=0; i<GRID_NBUCKETS; i++)
+         grid_buckets[i].ids = array_create( int );
+   }
+
+   /* Clear previous frame. */
+   for (int i=0; i<GRID_NBUCKETS; i++)
+      array_resize( &grid_buckets[i].ids, 0 );
+   array_resize( &grid_stamp, array_size(pilot_stack) );
+   for (int i=0; i<array_size(grid_stamp); i++)
+      grid_stamp[i] = 0;
+   grid_gen   = 0;
+   grid_stack = pilot_stack;
+
+   /* Insert each pilot into all the cells its bounding circle overlaps. */
+   for (int i=0; i<array_size(pilot_stack); i++) {
+      const Pilot *p = pilot_stack[i];
+      double r;
+      int cx0, cx1, cy0, cy1;
+
+      if (pilot_isAnyFlag( p, PILOT_MASK_SKIP ))
+         continue;
+
+      r   = grid_pilotRadius( p );
+      cx0 = (int)floor( (p->solid->pos.x - r) / GRID_CELL );
+      cx1 = (int)floor( (p->solid->pos.x + r) / GRID_CELL );
+      cy0 = (int)floor( (p->solid->pos.y - r) / GRID_CELL );
+      cy1 = (int)floor( (p->solid->pos.y + r) / GRID_CELL );
+      for (int cy=cy0; cy<=cy1; cy++)
+         for (int cx=cx0; cx<=cx1; cx++)
+            array_push_back( &grid_buckets[ grid_hash(cx,cy) ].ids, i );
+   }
+}
+
+/**
+ * @brief Appends the pilots of a cell to the result, deduplicating.
+ */
+static void grid_gather( int cx, int cy )
+{
+   const GridBucket *b = &grid_buckets[ grid_hash(cx,cy) ];
+   for (int i=0; i<array_size(b->ids); i++) {
+      int id = b->ids[i];
+      if (grid_stamp[id] == (int)grid_gen)
+         continue; /* Already gathered or hash collision of a far cell. */
+      grid_stamp[id] = (int)grid_gen;
+      array_push_back( &grid_result, (Pilot*) grid_stack[id] );
+   }
+}
+
+/**
+ * @brief Gets all the pilots whose bounding circle may overlap a circle.
+ *
+ * The returned array (array.h) is owned by the grid and only valid
+ * until the next query or rebuild.
+ *
+ *    @param pos Centre of the query circle.
+ *    @param radius Radius of the query circle.
+ *    @return Array (array.h) of candidate pilots.
+ */
+Pilot *const* pilotgrid_queryCircle( const vec2 *pos, double radius )
+{
+   int cx0, cx1, cy0, cy1;
+
+   array_resize( &grid_result, 0 );
+   if (grid_stack == NULL)
+      return grid_result;
+   grid_gen++;
+
+   cx0 = (int)floor( (pos->x - radius) / GRID_CELL );
+   cx1 = (int)floor( (pos->x + radius) / GRID_CELL );
+   cy0 = (int)floor( (pos->y - radius) / GRID_CELL );
+   cy1 = (int)floor( (pos->y + radius) / GRID_CELL );
+   for (int cy=cy0; cy<=cy1; cy++)
+      for (int cx=cx0; cx<=cx1; cx++)
+         grid_gather( cx, cy );
+   return grid_result;
+}
+
+/**
+ * @brief qsort comparison by pilot id, which matches stack order.
+ */
+static int grid_cmpID( const void *a, const void *b )
+{
+   const Pilot *pa = *(Pilot* const*) a;
+   const Pilot *pb = *(Pilot* const*) b;
+   if (pa->id < pb->id)
+      return -1;
+   else if (pa->id > pb->id)
+      return 1;
+   return 0;
+}
+
+/**
+ * @brief Like pilotgrid_queryCircle(), but returns the candidates in stack
+ *        order; render paths need a deterministic draw order.
+ */
+Pilot *const* pilotgrid_queryCircleOrdered( const vec2 *pos, double radius )
+{
+   Pilot *const* r = pilotgrid_queryCircle( pos, radius );
+   qsort( grid_result, array_size(grid_result), sizeof(Pilot*), grid_cmpID );
+   return r;
+}
+
+/**
+ * @brief Gets all the pilots whose bounding circle may overlap a segment.
+ *
+ * Walks the cells under the segment's bounding box; good enough for
+ * beam ranges which are short relative to the play field.
+ *
+ *    @param pos Start of the segment.
+ *    @param dir Direction of the segment (radians).
+ *    @param len Length of the segment.
+ *    @return Array (array.h) of candidate pilots.
+ */
+Pilot *const* pilotgrid_queryLine( const vec2 *pos, double dir, double len )
+{
+   double ex, ey;
+   int cx0, cx1, cy0, cy1;
+
+   array_resize( &grid_result, 0 );
+   if (grid_stack == NULL)
+      return grid_result;
+   grid_gen++;
+
+   ex  = pos->x + len * cos(dir);
+   ey  = pos->y + len * sin(dir);
+   cx0 = (int)floor( MIN( pos->x, ex ) / GRID_CELL );
+   cx1 = (int)floor( MAX( pos->x, ex ) / GRID_CELL );
+   cy0 = (int)floor( MIN( pos->y, ey ) / GRID_CELL );
+   cy1 = (int)floor( MAX( pos->y, ey ) / GRID_CELL );
+   for (int cy=cy0; cy<=cy1; cy++)
+      for (int cx=cx0; cx<=cx1; cx++)
+         grid_gather( cx, cy );
+   return grid_result;
+}
+
+/**
+ * @brief Rebuilds the asteroid layer from the current system.
+ *
+ * Meant to be called once per frame after the asteroids have moved.
+ * Only the asteroids of armed fields get inserted; the rest of the
+ * fields cost nothing to subsequent queries.
+ */
+void astgrid_rebuild (void)
+{
+   int total;
+
+   /* Lazy initialization. */
+   if (ast_result == NULL) {
+      ast_result = array_create( Asteroid* );
+      ast_base   = array_create( int );
+      ast_stamp  = array_create( int );
+      for (int i=0; i<GRID_NBUCKETS; i++)
+         ast_buckets[i].refs = array_create( AstRef );
+   }
+
+   /* Clear previous frame. */
+   for (int i=0; i<GRID_NBUCKETS; i++)
+      array_resize( &ast_buckets[i].refs, 0 );
+
+   /* The bases are computed for every anchor so a field armed mid-frame
+    * can insert its asteroids without a full rebuild. */
+   total = 0;
+   array_resize( &ast_base, array_size(cur_system->asteroids) );
+   for (int i=0; i<array_size(cur_system->asteroids); i++) {
+      ast_base[i] = total;
+      total += cur_system->asteroids[i].nb;
+   }
+   array_resize( &ast_stamp, total );
+   for (int i=0; i<total; i++)
+      ast_stamp[i] = 0;
+   ast_gen = 0;
+
+   /* Insert the armed fields. */
+   for (int i=0; i<array_size(cur_system->asteroids); i++) {
+      const AsteroidAnchor *ast = &cur_system->asteroids[i];
+      if (ast->armed > 0.)
+         astgrid_insertAnchor( ast );
+   }
+}
+
+/**
+ * @brief Inserts all the visible asteroids of a field into the layer.
+ *
+ * Used by the rebuild and by asteroids_arm() when a weapon probes a
+ * field that was not armed yet, so the arming shot can still hit.
+ */
+void astgrid_insertAnchor( const AsteroidAnchor *ast )
+{
+   if (ast_base == NULL)
+      return; /* Not built yet this frame. */
+   for (int j=0; j<ast->nb; j++) {
+      const Asteroid *a = &ast->asteroids[j];
+      double r;
+      int cx0, cx1, cy0, cy1;
+
+      if (a->state != ASTEROID_FG)
+         continue;
+
+      r   = MAX( a->gfx->sw, a->gfx->sh ) / 2.;
+      cx0 = (int)floor( (a->pos.x - r) / GRID_CELL );
+      cx1 = (int)floor( (a->pos.x + r) / GRID_CELL );
+      cy0 = (int)floor( (a->pos.y - r) / GRID_CELL );
+      cy1 = (int)floor( (a->pos.y + r) / GRID_CELL );
+      for (int cy=cy0; cy<=cy1; cy++)
+         for (int cx=cx0; cx<=cx1; cx++) {
+            AstRef *ref = &array_grow( &ast_buckets[ grid_hash(cx,cy) ].refs );
+            ref->a   = a;
+            ref->gid = ast_base[ ast->id ] + j;
+         }
+   }
+}
+
+/**
+ * @brief Appends the asteroids of a cell to the result, deduplicating.
+ */
+static void astgrid_gather( int cx, int cy )
+{
+   const AstBucket *b = &ast_buckets[ grid_hash(cx,cy) ];
+   for (int i=0; i<array_size(b->refs); i++) {
+      const AstRef *ref = &b->refs[i];
+      if (ast_stamp[ref->gid] == (int)ast_gen)
+         continue; /* Already gathered or hash collision of a far cell. */
+      ast_stamp[ref->gid] = (int)ast_gen;
+      array_push_back( &ast_result, (Asteroid*) ref->a );
+   }
+}
+
+/**
+ * @brief Gets all the asteroids that may overlap a circle.
+ *
+ * The returned array (array.h) is owned by the layer and only valid
+ * until the next query or rebuild.  Only armed fields are covered.
+ *
+ *    @param pos Centre of the query circle.
+ *    @param radius Radius of the query circle.
+ *    @return Array (array.h) of candidate asteroids.
+ */
+Asteroid *const* astgrid_queryCircle( const vec2 *pos, double radius )
+{
+   int cx0, cx1, cy0, cy1;
+
+   array_resize( &ast_result, 0 );
+   if (ast_base == NULL)
+      return ast_result;
+   ast_gen++;
+
+   cx0 = (int)floor( (pos->x - radius) / GRID_CELL );
+   cx1 = (int)floor( (pos->x + radius) / GRID_CELL );
+   cy0 = (int)floor( (pos->y - radius) / GRID_CELL );
+   cy1 = (int)floor( (pos->y + radius) / GRID_CELL );
+   for (int cy=cy0; cy<=cy1; cy++)
+      for (int cx=cx0; cx<=cx1; cx++)
+         astgrid_gather( cx, cy );
+   return ast_result;
+}
+
+/**
+ * @brief Gets all the asteroids that may overlap a segment.
+ *
+ *    @param pos Start of the segment.
+ *    @param dir Direction of the segment (radians).
+ *    @param len Length of the segment.
+ *    @return Array (array.h) of candidate asteroids.
+ */
+Asteroid *const* astgrid_queryLine( const vec2 *pos, double dir, double len )
+{
+   double ex, ey;
+   int cx0, cx1, cy0, cy1;
+
+   array_resize( &ast_result, 0 );
+   if (ast_base == NULL)
+      return ast_result;
+   ast_gen++;
+
+   ex  = pos->x + len * cos(dir);
+   ey  = pos->y + len * sin(dir);
+   cx0 = (int)floor( MIN( pos->x, ex ) / GRID_CELL );
+   cx1 = (int)floor( MAX( pos->x, ex ) / GRID_CELL );
+   cy0 = (int)floor( MIN( pos->y, ey ) / GRID_CELL );
+   cy1 = (int)floor( MAX( pos->y, ey ) / GRID_CELL );
+   for (int cy=cy0; cy<=cy1; cy++)
+      for (int cx=cx0; cx<=cx1; cx++)
+         astgrid_gather( cx, cy );
+   return ast_result;
+}
+
+/**
+ * @brief Frees all the memory used by the grid.
+ */
+void pilotgrid_exit (void)
+{
+   if (grid_result != NULL) {
+      for (int i=0; i<GRID_NBUCKETS; i++) {
+         array_free( grid_buckets[i].ids );
+         grid_buckets[i].ids = NULL;
+      }
+      array_free( grid_stamp );
+      grid_stamp  = NULL;
+      array_free( grid_result );
+      grid_result = NULL;
+      grid_stack  = NULL;
+   }
+   if (ast_result != NULL) {
+      for (int i=0; i<GRID_NBUCKETS; i++) {
+         array_free( ast_buckets[i].refs );
+         ast_buckets[i].refs = NULL;
+      }
+      array_free( ast_base );
+      ast_base   = NULL;
+      array_free( ast_stamp );
+      ast_stamp  = NULL;
+      array_free( ast_result );
+      ast_result = NULL;
+   }
+}
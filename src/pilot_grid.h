@@ -0,0 +1,29 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "asteroid.h"
+#include "physics.h"
+#include "pilot.h"
+
+/*
+ * Lifetime.
+ */
+void pilotgrid_rebuild (void);
+void pilotgrid_exit (void);
+
+/*
+ * Queries.
+ */
+Pilot *const* pilotgrid_queryCircle( const vec2 *pos, double radius );
+Pilot *const* pilotgrid_queryCircleOrdered( const vec2 *pos, double radius );
+Pilot *const* pilotgrid_queryLine( const vec2 *pos, double dir, double len );
+
+/*
+ * Asteroid layer; only covers armed fields (see asteroids_arm).
+ */
+void astgrid_rebuild (void);
+void astgrid_insertAnchor( const AsteroidAnchor *ast );
+Asteroid *const* astgrid_queryCircle( const vec2 *pos, double radius );
+Asteroid *const* astgrid_queryLine( const vec2 *pos, double dir, double len );
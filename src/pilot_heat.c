@@ -254,6 +254,43 @@ double pilot_heatEfficiencyMod( double T, double Tb, double Tc )
    return CLAMP( 0., 1., 1 - (T - Tb) / Tc );
 }
 
+/**
+ * @brief Updates a pilot's whole heat model for a frame.
+ *
+ * Slots at thermal equilibrium with the chassis are snapped to its
+ * temperature and skipped, and once the chassis itself has settled at the
+ * ambient temperature the radiation integration (with its pow()) is skipped
+ * too. Firing adds heat through pilot_heatAddSlot(), which recreates a
+ * temperature difference and wakes the slot back up automatically.
+ *
+ *    @param p Pilot to update.
+ *    @param dt Delta tick.
+ */
+void pilot_heatUpdate( Pilot *p, double dt )
+{
+   double Q   = 0.;
+   int active = 0;
+
+   for (int i=0; i<array_size(p->outfits); i++) {
+      PilotOutfitSlot *o = p->outfits[i];
+      if ((o->outfit == NULL) || !o->active)
+         continue;
+      if (fabs( o->heat_T - p->heat_T ) <= HEAT_DORMANT_EPS) {
+         o->heat_T = p->heat_T; /* Snap so the slot stays settled. */
+         continue;
+      }
+      Q += pilot_heatUpdateSlot( p, o, dt );
+      active = 1;
+   }
+
+   /* Fully dormant: everything is at ambient and no heat is moving. */
+   if (!active && (fabs( p->heat_T - CONST_SPACE_STAR_TEMP ) <= HEAT_DORMANT_EPS)) {
+      p->heat_T = CONST_SPACE_STAR_TEMP;
+      return;
+   }
+   pilot_heatUpdateShip( p, Q, dt );
+}
+
 /**
  * @brief Overrides the usual heat model during active cooldown.
  *
@@ -18,6 +18,7 @@
 #define CONST_SPACE_TEMP_4          \
 (CONST_SPACE_TEMP*CONST_SPACE_TEMP*CONST_SPACE_TEMP*CONST_SPACE_TEMP) /**< CONST_SPACE_TEMP^4 */
 #define CONST_SPACE_STAR_TEMP       (250.) /**< Aproximation of the black body temperature near a star. */
+#define HEAT_DORMANT_EPS            (1e-3) /**< Temperature delta (K) under which heat flow is considered settled. */
 #define CONST_SPACE_STAR_TEMP_4     \
 (CONST_SPACE_STAR_TEMP*CONST_SPACE_STAR_TEMP*CONST_SPACE_STAR_TEMP*CONST_SPACE_STAR_TEMP) /**< CONST_SPACE_STAR_TEMP^4 */
 
@@ -50,6 +51,7 @@ void pilot_heatAddSlot( const Pilot *p, PilotOutfitSlot *o );
 void pilot_heatAddSlotTime( const Pilot *p, PilotOutfitSlot *o, double dt );
 double pilot_heatUpdateSlot( const Pilot *p, PilotOutfitSlot *o, double dt );
 void pilot_heatUpdateShip( Pilot *p, double Q_cond, double dt );
+void pilot_heatUpdate( Pilot *p, double dt );
 void pilot_heatUpdateCooldown( Pilot *p );
 
 /*
@@ -23,8 +23,20 @@
 #include "nxml.h"
 
 static PilotHook *pilot_globalHooks = NULL; /**< Global hooks that affect all pilots. */
+static uint32_t pilot_globalHookMask = 0; /**< Bitmask of global hook types present. */
 static int pilot_hookCleanup = 0; /**< Are hooks being removed from a pilot? */
 
+/**
+ * @brief Recomputes the type bitmask of a hook array after a removal.
+ */
+static uint32_t pilot_hookMask( const PilotHook *hooks )
+{
+   uint32_t mask = 0;
+   for (int i=0; i<array_size(hooks); i++)
+      mask |= (uint32_t)1 << hooks[i].type;
+   return mask;
+}
+
 /**
  * @brief Tries to run a pilot hook if he has it.
  *
@@ -39,6 +51,11 @@ int pilot_runHookParam( Pilot* p, int hook_type, const HookParam* param, int npa
    int n, run;
    HookParam hstaparam[5], *hdynparam, *hparam;
 
+   /* Most pilots have no hooks of any given type; a single bit test skips
+    * both scans and the parameter setup. */
+   if (!(( p->hook_mask | pilot_globalHookMask ) & ((uint32_t)1 << hook_type)))
+      return 0;
+
    /* Set up hook parameters. */
    if (nparam <= 3) {
       hstaparam[0].type = HOOK_PARAM_PILOT;
@@ -127,6 +144,7 @@ void pilot_addHook( Pilot *pilot, int type, unsigned int hook )
    phook        = &array_grow( &pilot->hooks );
    phook->type  = type;
    phook->id    = hook;
+   pilot->hook_mask |= (uint32_t)1 << type;
 }
 
 /**
@@ -144,6 +162,7 @@ void pilots_addGlobalHook( int type, unsigned int hook )
    phook       = &array_grow( &pilot_globalHooks );
    phook->type = type;
    phook->id   = hook;
+   pilot_globalHookMask |= (uint32_t)1 << type;
 }
 
 /**
@@ -155,6 +174,7 @@ void pilots_rmGlobalHook( unsigned int hook )
       if (pilot_globalHooks[i].id != hook)
          continue;
       array_erase( &pilot_globalHooks, &pilot_globalHooks[i], &pilot_globalHooks[i+1] );
+      pilot_globalHookMask = pilot_hookMask( pilot_globalHooks );
       return;
    }
 }
@@ -165,6 +185,7 @@ void pilots_rmGlobalHook( unsigned int hook )
 void pilots_clearGlobalHooks (void)
 {
    array_erase( &pilot_globalHooks, array_begin(pilot_globalHooks), array_end(pilot_globalHooks) );
+   pilot_globalHookMask = 0;
 }
 
 /**
@@ -193,6 +214,7 @@ void pilots_rmHook( unsigned int hook )
             continue;
 
          array_erase( &p->hooks, &p->hooks[j], &p->hooks[j+1] );
+         p->hook_mask = pilot_hookMask( p->hooks );
          j--; /* Dun like it but we have to keep iterator safe. */
       }
    }
@@ -213,6 +235,7 @@ void pilot_clearHooks( Pilot *p )
 
    array_free(p->hooks);
    p->hooks  = NULL;
+   p->hook_mask = 0;
 }
 
 /**
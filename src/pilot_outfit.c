@@ -27,11 +27,32 @@
 #include "nlua_pilot.h"
 #include "nlua_pilotoutfit.h"
 
+/**
+ * @brief Shared default-loadout template of a ship class.
+ *
+ * Every pilot spawned from the same ship starts with the same default
+ * outfits, so the static slot block they would each compute in
+ * pilot_calcStats() is identical.  The first spawn of a ship stores it
+ * here and later spawns copy it instead of walking their slots; a pilot
+ * that gets refitted afterwards just invalidates its own copy and
+ * recomputes locally like always.
+ */
+typedef struct ShipTemplate_ {
+   const Ship *ship;    /**< Ship the template belongs to. */
+   ShipStats stats;     /**< Merged stats of the static default slots. */
+   double cpu;          /**< CPU usage of the static default slots. */
+   double mass;         /**< Outfit mass of the static default slots. */
+   double base_mass;    /**< Core outfit mass of the static default slots. */
+} ShipTemplate;
+
+static ShipTemplate *pilot_tmpl = NULL; /**< Templates sorted by ship pointer (array.h). */
+
 /*
  * Prototypes.
  */
 static int pilot_hasOutfitLimit( const Pilot *p, const char *limit );
 static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot );
+static int pilot_tmplFind( const Ship *ship );
 
 /**
  * @brief Updates the lockons on the pilot's launchers
@@ -312,6 +333,9 @@ int pilot_addOutfitRaw( Pilot* pilot, const Outfit* outfit, PilotOutfitSlot *s )
    /* Disable lua for now. */
    s->lua_mem = LUA_NOREF;
 
+   /* The static slot cache has to be rebuilt. */
+   pilot->stats_static_valid = 0;
+
    /* Initialize if active thingy if necessary. */
    pilot_outfitLAdd( pilot, s );
 
@@ -459,6 +483,9 @@ int pilot_rmOutfitRaw( Pilot* pilot, PilotOutfitSlot *s )
       s->lua_mem = LUA_NOREF;
    }
 
+   /* The static slot cache has to be rebuilt. */
+   pilot->stats_static_valid = 0;
+
    return ret;
 }
 
@@ -846,6 +873,126 @@ void pilot_fillAmmo( Pilot* pilot )
 /**
  * @brief Computes the stats for a pilot's slot.
  */
+/**
+ * @brief Whether a slot's stat contribution can change without a refit.
+ *
+ * Static slots are folded into a per-pilot cache so toggling an active
+ * outfit doesn't have to re-walk the whole outfit list. The classification
+ * only depends on properties fixed when the outfit is equipped.
+ */
+/**
+ * @brief Finds the lowest template index whose ship is >= ship (binary search).
+ */
+static int pilot_tmplFind( const Ship *ship )
+{
+   int lo = 0, hi = array_size(pilot_tmpl);
+   while (lo < hi) {
+      int mid = (lo+hi)/2;
+      if (pilot_tmpl[mid].ship < ship)
+         lo = mid+1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/**
+ * @brief Seeds a freshly spawned pilot's static slot cache from the template.
+ *
+ * Must only be called while the pilot still has its ship's default
+ *  loadout; does nothing when the ship has no template yet.
+ *
+ *    @param pilot Pilot to seed.
+ */
+void pilot_tmplSeed( Pilot *pilot )
+{
+   int i = pilot_tmplFind( pilot->ship );
+   if ((i >= array_size(pilot_tmpl)) || (pilot_tmpl[i].ship != pilot->ship))
+      return;
+   pilot->stats_static       = pilot_tmpl[i].stats;
+   pilot->cpu_static         = pilot_tmpl[i].cpu;
+   pilot->mass_static        = pilot_tmpl[i].mass;
+   pilot->base_mass_static   = pilot_tmpl[i].base_mass;
+   pilot->stats_static_valid = 1;
+}
+
+/**
+ * @brief Stores a freshly spawned pilot's static slot cache as the template.
+ *
+ * Must only be called while the pilot still has its ship's default
+ *  loadout and a valid static cache.
+ *
+ *    @param pilot Pilot to take the template from.
+ */
+void pilot_tmplStore( const Pilot *pilot )
+{
+   ShipTemplate tmpl;
+   int i;
+
+   if (!pilot->stats_static_valid)
+      return;
+   if (pilot_tmpl == NULL)
+      pilot_tmpl = array_create( ShipTemplate );
+   i = pilot_tmplFind( pilot->ship );
+   if ((i < array_size(pilot_tmpl)) && (pilot_tmpl[i].ship == pilot->ship))
+      return; /* Already stored. */
+
+   tmpl.ship      = pilot->ship;
+   tmpl.stats     = pilot->stats_static;
+   tmpl.cpu       = pilot->cpu_static;
+   tmpl.mass      = pilot->mass_static;
+   tmpl.base_mass = pilot->base_mass_static;
+
+   /* Keep the table sorted by ship pointer. */
+   array_grow( &pilot_tmpl );
+   memmove( &pilot_tmpl[i+1], &pilot_tmpl[i],
+         (array_size(pilot_tmpl)-i-1) * sizeof(ShipTemplate) );
+   pilot_tmpl[i] = tmpl;
+}
+
+/**
+ * @brief Frees all the ship templates.
+ */
+void pilot_tmplClear (void)
+{
+   array_free( pilot_tmpl );
+   pilot_tmpl = NULL;
+}
+
+static int pilot_slotStatsStatic( const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+   if (o==NULL)
+      return 1; /* Contributes nothing, might as well be static. */
+   if (slot->active)
+      return 0; /* Contribution depends on the on/off state. */
+   if ((o->lua_env != LUA_NOREF) || (o->lua_update != LUA_NOREF))
+      return 0; /* Lua outfits change their stats at runtime. */
+   if (outfit_isLauncher(o) || outfit_isFighterBay(o))
+      return 0; /* Ammo mass varies. */
+   return 1;
+}
+
+/**
+ * @brief Accumulates a static slot into the pilot's static slot cache.
+ *
+ * Only handles what static slots can contribute; the dynamic cases
+ * (afterburners, ammo mass, Lua stats) never get here.
+ */
+static void pilot_calcStatsSlotStatic( Pilot *pilot, const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+
+   if (o==NULL)
+      return;
+
+   pilot->cpu_static  += outfit_cpu(o);
+   pilot->mass_static += o->mass;
+   if (sp_required( o->slot.spid ))
+      pilot->base_mass_static += o->mass;
+   ss_statsModFromList( &pilot->stats_static, o->stats );
+}
+
 static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
 {
    const Outfit *o = slot->outfit;
@@ -911,11 +1058,47 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
  *
  *    @param pilot Pilot to recalculate his stats.
  */
+/**
+ * @brief Opens or closes a refit transaction on a pilot.
+ *
+ * While the transaction is open pilot_calcStats() only marks the pilot
+ * dirty; closing it runs the deferred recompute (and the weapon set
+ * update) once. Used by the bulk equip paths so a full loadout costs a
+ * single recompute.
+ *
+ *    @param p Pilot being refit.
+ *    @param enable Whether to open (1) or close (0) the transaction.
+ */
+void pilot_outfitBatch( Pilot *p, int enable )
+{
+   if (enable) {
+      pilot_setFlag( p, PILOT_OUTFIT_BATCH );
+      return;
+   }
+   if (!pilot_isFlag( p, PILOT_OUTFIT_BATCH ))
+      return;
+   pilot_rmFlag( p, PILOT_OUTFIT_BATCH );
+   if (pilot_isFlag( p, PILOT_OUTFIT_DIRTY )) {
+      pilot_rmFlag( p, PILOT_OUTFIT_DIRTY );
+      pilot_calcStats( p );
+      if (p->autoweap)
+         pilot_weaponAuto( p );
+   }
+}
+
 void pilot_calcStats( Pilot* pilot )
 {
    double ac, sc, ec, tm; /* temporary health coefficients to set */
    ShipStats *s;
 
+   /* Inside a refit transaction the recompute is deferred to the closing
+    * pilot_outfitBatch( p, 0 ), so equipping a full loadout costs one
+    * recompute instead of one per outfit. */
+   if (pilot_isFlag( pilot, PILOT_OUTFIT_BATCH )) {
+      pilot_setFlag( pilot, PILOT_OUTFIT_DIRTY );
+      return;
+   }
+
    /*
     * Set up the basic stuff
     */
@@ -960,12 +1143,34 @@ void pilot_calcStats( Pilot* pilot )
    if (pilot_isPlayer(pilot))
       difficulty_apply( s );
 
-   /* Now add outfit changes */
-   pilot->mass_outfit   = 0.;
+   /* Rebuild the static slot cache if a refit invalidated it. */
+   if (!pilot->stats_static_valid) {
+      ss_statsInit( &pilot->stats_static );
+      pilot->cpu_static       = 0.;
+      pilot->mass_static      = 0.;
+      pilot->base_mass_static = 0.;
+      for (int i=0; i<array_size(pilot->outfit_intrinsic); i++)
+         if (pilot_slotStatsStatic( &pilot->outfit_intrinsic[i] ))
+            pilot_calcStatsSlotStatic( pilot, &pilot->outfit_intrinsic[i] );
+      for (int i=0; i<array_size(pilot->outfits); i++)
+         if (pilot_slotStatsStatic( pilot->outfits[i] ))
+            pilot_calcStatsSlotStatic( pilot, pilot->outfits[i] );
+      pilot->stats_static_valid = 1;
+   }
+
+   /* Apply the cached static slots. */
+   pilot->cpu          += pilot->cpu_static;
+   pilot->mass_outfit   = pilot->mass_static;
+   pilot->base_mass    += pilot->base_mass_static;
+   ss_statsMerge( s, &pilot->stats_static );
+
+   /* Now add the dynamic outfit changes. */
    for (int i=0; i<array_size(pilot->outfit_intrinsic); i++)
-      pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i] );
+      if (!pilot_slotStatsStatic( &pilot->outfit_intrinsic[i] ))
+         pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i] );
    for (int i=0; i<array_size(pilot->outfits); i++)
-      pilot_calcStatsSlot( pilot, pilot->outfits[i] );
+      if (!pilot_slotStatsStatic( pilot->outfits[i] ))
+         pilot_calcStatsSlot( pilot, pilot->outfits[i] );
 
    /* Merge stats. */
    ss_statsMerge( &pilot->stats, &pilot->intrinsic_stats );
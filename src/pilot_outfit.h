@@ -39,8 +39,14 @@ const char* pilot_canEquip( const Pilot *p, const PilotOutfitSlot *s, const Outf
 void pilot_lockUpdateSlot( Pilot *p, PilotOutfitSlot *o, Pilot *t, double *a, double dt );
 void pilot_lockClear( Pilot *p );
 
+/* Shared default-loadout templates. */
+void pilot_tmplSeed( Pilot *pilot );
+void pilot_tmplStore( const Pilot *pilot );
+void pilot_tmplClear (void);
+
 /* Other. */
 void pilot_calcStats( Pilot *pilot );
+void pilot_outfitBatch( Pilot *p, int enable );
 void pilot_updateMass( Pilot *pilot );
 void pilot_healLanded( Pilot *pilot );
 PilotOutfitSlot *pilot_getSlotByName( Pilot *pilot, const char *name );
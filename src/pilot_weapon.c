@@ -43,7 +43,7 @@
  */
 static void pilot_weapSetUpdateOutfits( Pilot* p, PilotWeaponSet *ws );
 static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level );
-static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfit *o, int level, double time );
+static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfit *o, int level, double time, double *wake );
 static int pilot_shootWeapon( Pilot* p, PilotOutfitSlot* w, double time );
 static void pilot_weapSetUpdateRange( const Pilot *p, PilotWeaponSet *ws );
 unsigned int pilot_weaponSetShootStop( Pilot* p, PilotWeaponSet *ws, int level );
@@ -74,12 +74,13 @@ static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level )
    Pilot *pt;
    AsteroidAnchor *field;
    Asteroid *ast;
-   double time;
+   double time, wake;
    int isstealth;
 
    isstealth = pilot_isFlag( p, PILOT_STEALTH );
 
-   ret = 0;
+   ret  = 0;
+   wake = INFINITY;
    for (int i=0; i<array_size(ws->slots); i++) {
       const Outfit *o = ws->slots[i].slot->outfit;
 
@@ -106,10 +107,12 @@ static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level )
       if (s!=0)
          continue;
 
-      /* Only "locked on" outfits. */
+      /* Only "locked on" outfits; the lock completing is what wakes us. */
       if (outfit_isSeeker(o) &&
-            (ws->slots[i].slot->u.ammo.lockon_timer > 0.))
+            (ws->slots[i].slot->u.ammo.lockon_timer > 0.)) {
+         wake = MIN( wake, ws->slots[i].slot->u.ammo.lockon_timer );
          continue;
+      }
 
       /* If inrange is set we only fire at targets in range. */
       time = INFINITY;  /* With no target we just set time to infinity. */
@@ -125,14 +128,22 @@ static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level )
          time = pilot_weapFlyTime( o, p, &ast->pos, &ast->vel);
       }
 
-      /* Only "inrange" outfits. */
-      if (ws->inrange && outfit_duration(o) < time)
+      /* Only "inrange" outfits; depends on the target so no prediction. */
+      if (ws->inrange && outfit_duration(o) < time) {
+         wake = 0.;
          continue;
+      }
 
       /* Shoot the weapon of the weaponset. */
-      ret += pilot_shootWeaponSetOutfit( p, ws, o, level, time );
+      ret += pilot_shootWeaponSetOutfit( p, ws, o, level, time, &wake );
    }
 
+   /* Timer-blocked sets sleep until the soonest cooldown or lock can
+    * complete; cap the nap so predictions gone stale from stat changes
+    * stay bounded. */
+   if (level == -1)
+      ws->wait = MIN( wake, 1. );
+
    /* Destealth when attacking. */
    if (isstealth && (ret>0))
       pilot_destealth( p );
@@ -152,6 +163,7 @@ void pilot_weapSetAIClear( Pilot* p )
    for (int i=0; i<PILOT_WEAPON_SETS; i++) {
       PilotWeaponSet *ws = &p->weapon_sets[i];
       ws->active = 0;
+      ws->wait   = 0.;
    }
 }
 
@@ -171,6 +183,9 @@ void pilot_weapSetPress( Pilot* p, int id, int type )
    if (ws->slots == NULL)
       return;
 
+   /* Input must always get a fresh fire attempt. */
+   ws->wait = 0.;
+
    /* Handle fire groups. */
    switch (ws->type) {
       case WEAPSET_TYPE_CHANGE:
@@ -257,8 +272,9 @@ void pilot_weapSetPress( Pilot* p, int id, int type )
  * @brief Updates the pilot's weapon sets.
  *
  *    @param p Pilot to update.
+ *    @param dt Current delta tick.
  */
-void pilot_weapSetUpdate( Pilot* p )
+void pilot_weapSetUpdate( Pilot* p, double dt )
 {
    if (pilot_isFlag( p, PILOT_HYP_BEGIN))
       return;
@@ -270,8 +286,13 @@ void pilot_weapSetUpdate( Pilot* p )
 
       /* Weapons must get "fired" every turn. */
       if (ws->type == WEAPSET_TYPE_WEAPON) {
-         if (ws->active)
-            pilot_weapSetFire( p, ws, -1 );
+         if (ws->active) {
+            /* Blocked sets sleep until something can actually change;
+             * pilot_weapSetFire() computes the next wake time. */
+            ws->wait -= dt;
+            if (ws->wait <= 0.)
+               pilot_weapSetFire( p, ws, -1 );
+         }
       }
    }
 }
@@ -387,6 +408,7 @@ void pilot_weapSetRmSlot( Pilot *p, int id, OutfitSlotType type )
 
    /* Remove surplus. */
    array_erase( &ws->slots, &ws->slots[l-n], &ws->slots[l] );
+   ws->wait = 0.;
 }
 
 /**
@@ -535,6 +557,9 @@ static void pilot_weapSetUpdateRange( const Pilot *p, PilotWeaponSet *ws )
    double speed_accum[PILOT_WEAPSET_MAX_LEVELS];
    int speed_num[PILOT_WEAPSET_MAX_LEVELS];
 
+   /* Composition or stats changed; drop any sleep prediction. */
+   ws->wait = 0.;
+
    /* Calculate ranges. */
    for (int i=0; i<PILOT_WEAPSET_MAX_LEVELS; i++) {
       range_accum[i] = 0.;
@@ -904,19 +929,20 @@ double pilot_weapFlyTime( const Outfit *o, const Pilot *parent, const vec2 *pos,
 /**
  * @brief Calculates and shoots the appropriate weapons in a weapon set matching an outfit.
  */
-static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfit *o, int level, double time )
+static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfit *o, int level, double time, double *wake )
 {
    int ret;
    int is_launcher, is_bay;
    double rate_mod, energy_mod;
    int maxp, minh;
-   double q, maxt;
+   double q, maxt, mint;
 
    /* Store number of shots. */
    ret = 0;
 
    /** @TODO Make beams not fire all at once. */
    if (outfit_isBeam(o)) {
+      *wake = 0.; /* Beams need servicing every frame while on. */
       for (int i=0; i<array_size(ws->slots); i++) {
          if (ws->slots[i].slot->outfit == o && (level == -1 || level == ws->slots[i].level)) {
             ret += pilot_shootWeapon( p, ws->slots[i].slot, 0 );
@@ -937,6 +963,7 @@ static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfi
    /* Find optimal outfit, coolest that can fire. */
    minh  = -1;
    maxt  = 0.;
+   mint  = INFINITY;
    maxp  = -1;
    q     = 0.;
    for (int i=0; i<array_size(ws->slots); i++) {
@@ -954,6 +981,10 @@ static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfi
       if ((is_launcher || is_bay) && (w->u.ammo.quantity <= 0))
          continue;
 
+      /* Soonest cooldown to complete. */
+      if (w->timer > 0.)
+         mint = MIN( mint, w->timer );
+
       /* Get coolest that can fire. */
       if (w->timer <= 0.) {
          if (is_launcher) {
@@ -974,13 +1005,21 @@ static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfi
       q += 1.;
    }
 
-   /* No weapon can fire. */
-   if (minh < 0)
+   /* No weapon can fire; wake when the soonest cooldown completes, or
+    * right away when nothing matched at all (e.g. waiting on ammo). */
+   if (minh < 0) {
+      *wake = MIN( *wake, (maxp < 0) ? 0. : mint );
       return 0;
+   }
 
    /* Only fire if the last weapon to fire fired more than (q-1)/q ago. */
-   if (maxt > rate_mod * outfit_delay(o) * ((q-1.) / q))
+   if (maxt > rate_mod * outfit_delay(o) * ((q-1.) / q)) {
+      *wake = MIN( *wake, maxt - rate_mod * outfit_delay(o) * ((q-1.) / q) );
       return 0;
+   }
+
+   /* Attempting a shot; re-evaluate next frame. */
+   *wake = 0.;
 
    /* Shoot the weapon. */
    ret += pilot_shootWeapon( p, ws->slots[minh].slot, time );
@@ -1209,6 +1248,7 @@ void pilot_weaponClear( Pilot *p )
    for (int i=0; i<PILOT_WEAPON_SETS; i++) {
       PilotWeaponSet *ws = pilot_weapSet( p, i );
       array_erase( &ws->slots, array_begin(ws->slots), array_end(ws->slots) );
+      ws->wait = 0.;
    }
 }
 
@@ -27,7 +27,7 @@ double pilot_weapFlyTime( const Outfit *o, const Pilot *parent,
 void pilot_weapSetUpdateStats( Pilot *p );
 void pilot_weapSetAIClear( Pilot* p );
 void pilot_weapSetPress( Pilot* p, int id, int type );
-void pilot_weapSetUpdate( Pilot* p );
+void pilot_weapSetUpdate( Pilot* p, double dt );
 
 /* Weapon Set. */
 PilotWeaponSet* pilot_weapSet( Pilot* p, int id );
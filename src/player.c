@@ -57,6 +57,7 @@
 #include "player_gui.h"
 #include "player_fleet.h"
 #include "player_inventory.h"
+#include "profiler.h"
 #include "rng.h"
 #include "shiplog.h"
 #include "sound.h"
@@ -143,7 +144,7 @@ static PlayerShip_t* player_newShipMake( const char* name );
 static void player_initSound (void);
 /* save/load */
 static int player_saveEscorts( xmlTextWriterPtr writer );
-static int player_saveShipSlot( xmlTextWriterPtr writer, const PilotOutfitSlot *slot, int i );
+static void player_saveShipSlot( char **buf, const PilotOutfitSlot *slot, int i );
 static int player_saveShip( xmlTextWriterPtr writer, PlayerShip_t *pship );
 static int player_saveMetadata( xmlTextWriterPtr writer );
 static Spob* player_parse( xmlNodePtr parent );
@@ -439,7 +440,7 @@ PlayerShip_t* player_newShip( const Ship* ship, const char *def_name,
    pfleet_update();
 
    /* Update ship list if landed. */
-   if (landed) {
+   if (landed && land_tabGenerated(LAND_WINDOW_EQUIPMENT)) {
       int w = land_getWid( LAND_WINDOW_EQUIPMENT );
       equipment_regenLists( w, 0, 1 );
    }
@@ -674,7 +675,7 @@ void player_rmShip( const char *shipname )
    }
 
    /* Update ship list if landed. */
-   if (landed) {
+   if (landed && land_tabGenerated(LAND_WINDOW_EQUIPMENT)) {
       int w = land_getWid( LAND_WINDOW_EQUIPMENT );
       equipment_regenLists( w, 0, 1 );
    }
@@ -1016,7 +1017,7 @@ static void player_renderStealthUnderlay( double dt )
       gl_gameToScreenCoords( &x, &y, t->solid->pos.x, t->solid->pos.y );
       r = detectz * t->stats.ew_detect;
       if (r > 0.) {
-         glUseProgram( shaders.stealthaura.program );
+         gl_useProgram( shaders.stealthaura.program );
          gl_renderShader( x, y, r, r, 0., &shaders.stealthaura, &col, 1 );
       }
    }
@@ -1038,14 +1039,14 @@ static void player_renderStealthOverlay( double dt )
    st    = player.p->ew_stealth_timer;
 
    /* We do red to yellow. */
-   col_blend( &col, &cYellow, &cRed, st );
+   col   = *col_ramp( cRampRedYellow, st );
    col.a = 0.5;
 
    /* Determine size. */
    r = 1.2/2. * (double)player.p->ship->gfx_space->sw;
 
    /* Draw the main circle. */
-   glUseProgram( shaders.stealthmarker.program );
+   gl_useProgram( shaders.stealthmarker.program );
    glUniform1f( shaders.stealthmarker.paramf, st );
    gl_renderShader( x, y, r*z, r*z, 0., &shaders.stealthmarker, &col, 1 );
 }
@@ -1097,7 +1098,7 @@ static void player_renderAimHelper( double dt )
 
    c2 = cWhite;
    c2.a = 0.7;
-   glUseProgram(shaders.crosshairs.program);
+   gl_useProgram(shaders.crosshairs.program);
    glUniform1f(shaders.crosshairs.paramf, 1.);
    gl_renderShader( x2, y2, 7, 7, 0., &shaders.crosshairs, &c2, 1 );
 
@@ -1137,7 +1138,9 @@ void player_think( Pilot* pplayer, const double dt )
 
    /* We always have to run ai_think in the case the player has escorts so that
     * they properly form formations. */
+   prof_begin( PROF_AI );
    ai_think( pplayer, dt );
+   prof_end( PROF_AI );
 
    /* Under manual control is special. */
    if (pilot_isFlag( pplayer, PILOT_MANUAL_CONTROL ) || pilot_isFlag( pplayer, PILOT_HIDE )) {
@@ -1662,6 +1665,7 @@ int player_land( int loud )
       pilot_calcStats( player.p );
 
    /* Do whatever the spob wants to do. */
+   spob_luaEnsure( spob );
    if (spob->lua_land != LUA_NOREF) {
       lua_rawgeti(naevL, LUA_REGISTRYINDEX, spob->lua_land); /* f */
       lua_pushspob( naevL, spob_index(spob) );
@@ -1674,7 +1678,9 @@ int player_land( int loud )
       return PLAYER_LAND_OK;
    }
 
-   /* Start landing. */
+   /* Start landing. The animation delay hides the land window's data
+    * generation. */
+   land_prepare( spob );
    player_soundPause();
    player.p->landing_delay = PILOT_LANDING_DELAY * player_dt_default();
    player.p->ptimer = player.p->landing_delay;
@@ -2063,6 +2069,10 @@ void player_brokeHyperspace (void)
                   map_npath),
                (sys_isKnown(destsys) ? _(destsys->name) : _("Unknown")),
                map_npath );
+
+         /* Warm the next hop's assets during transit. */
+         if (player.p->nav_hyperspace != -1)
+            space_prefetch( cur_system->jumps[ player.p->nav_hyperspace ].target );
       }
    }
 
@@ -3189,7 +3199,7 @@ static int player_saveEscorts( xmlTextWriterPtr writer )
  */
 int player_save( xmlTextWriterPtr writer )
 {
-   char **guis;
+   char **guis, *bulk;
    int cycles, periods, seconds;
    double rem;
    const PlayerItem *inventory;
@@ -3238,32 +3248,42 @@ int player_save( xmlTextWriterPtr writer )
       xmlw_elem(writer,"gui","%s",guis[i]);
    xmlw_endElem(writer); /* "guis" */
 
-   /* Outfits. */
+   /* Outfits. Bulk-emitted; scales with collection size. */
    xmlw_startElem(writer,"outfits");
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(player_outfits); i++) {
-      xmlw_startElem(writer, "outfit");
-      xmlw_attr(writer, "quantity", "%d", player_outfits[i].q);
-      xmlw_str(writer, "%s", player_outfits[i].o->name);
-      xmlw_endElem(writer); /* "outfit" */
+      xmlw_bulkCat( &bulk, "<outfit quantity=\"%d\">", player_outfits[i].q );
+      xmlw_bulkCatEsc( &bulk, player_outfits[i].o->name );
+      xmlw_bulkCat( &bulk, "</outfit>" );
    }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "outfits" */
 
    /* Licenses. */
    xmlw_startElem(writer, "licenses");
-   for (int i=0; i<array_size(player_licenses); i++)
-      xmlw_elem(writer, "license", "%s", player_licenses[i]);
+   bulk = xmlw_bulkOpen();
+   for (int i=0; i<array_size(player_licenses); i++) {
+      xmlw_bulkCat( &bulk, "<license>" );
+      xmlw_bulkCatEsc( &bulk, player_licenses[i] );
+      xmlw_bulkCat( &bulk, "</license>" );
+   }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "licenses" */
 
    /* Inventory. */
    xmlw_startElem(writer, "inventory");
    inventory = player_inventory();
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(inventory); i++) {
       const PlayerItem *pi = &inventory[i];
-      xmlw_startElem(writer, "item");
-      xmlw_attr(writer, "quantity", "%d", pi->quantity);
-      xmlw_str(writer, "%s", pi->name);
-      xmlw_endElem(writer); /* "item" */
+      xmlw_bulkCat( &bulk, "<item quantity=\"%d\">", pi->quantity );
+      xmlw_bulkCatEsc( &bulk, pi->name );
+      xmlw_bulkCat( &bulk, "</item>" );
    }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "inventory" */
 
    xmlw_endElem(writer); /* "player" */
@@ -3302,17 +3322,16 @@ int player_save( xmlTextWriterPtr writer )
 /**
  * @brief Saves an outfit slot.
  */
-static int player_saveShipSlot( xmlTextWriterPtr writer, const PilotOutfitSlot *slot, int i )
+static void player_saveShipSlot( char **buf, const PilotOutfitSlot *slot, int i )
 {
    const Outfit *o = slot->outfit;
-   xmlw_startElem(writer,"outfit");
-   xmlw_attr(writer,"slot","%d",i);
    if (outfit_isLauncher(o) || outfit_isFighterBay(o))
-      xmlw_attr(writer,"quantity","%d", slot->u.ammo.quantity);
-   xmlw_str(writer,"%s",o->name);
-   xmlw_endElem(writer); /* "outfit" */
-
-   return 0;
+      xmlw_bulkCat( buf, "<outfit slot=\"%d\" quantity=\"%d\">",
+            i, slot->u.ammo.quantity );
+   else
+      xmlw_bulkCat( buf, "<outfit slot=\"%d\">", i );
+   xmlw_bulkCatEsc( buf, o->name );
+   xmlw_bulkCat( buf, "</outfit>" );
 }
 
 /**
@@ -3325,6 +3344,7 @@ static int player_saveShipSlot( xmlTextWriterPtr writer, const PilotOutfitSlot *
 static int player_saveShip( xmlTextWriterPtr writer, PlayerShip_t *pship )
 {
    Pilot *ship = pship->p;
+   char *bulk;
    xmlw_startElem(writer,"ship");
    xmlw_attr(writer,"name","%s",ship->name);
    xmlw_attr(writer,"model","%s",ship->ship->name);
@@ -3359,31 +3379,45 @@ static int player_saveShip( xmlTextWriterPtr writer, PlayerShip_t *pship )
    /* save the fuel */
    xmlw_elem(writer,"fuel","%f",ship->fuel);
 
-   /* save the outfits */
+   /* Save the outfits. Each list is built in a bulk fragment and emitted
+    * through a single raw write so big fleets do not pay one writer call
+    * per outfit. */
    xmlw_startElem(writer,"outfits_intrinsic"); /* Want them to be first. */
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(ship->outfit_intrinsic); i++)
-      player_saveShipSlot( writer, &ship->outfit_intrinsic[i], i );
+      player_saveShipSlot( &bulk, &ship->outfit_intrinsic[i], i );
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "outfits_intrinsic" */
    xmlw_startElem(writer,"outfits_structure");
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(ship->outfit_structure); i++) {
       if (ship->outfit_structure[i].outfit==NULL)
          continue;
-      player_saveShipSlot( writer, &ship->outfit_structure[i], i );
+      player_saveShipSlot( &bulk, &ship->outfit_structure[i], i );
    }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "outfits_structure" */
    xmlw_startElem(writer,"outfits_utility");
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(ship->outfit_utility); i++) {
       if (ship->outfit_utility[i].outfit==NULL)
          continue;
-      player_saveShipSlot( writer, &ship->outfit_utility[i], i );
+      player_saveShipSlot( &bulk, &ship->outfit_utility[i], i );
    }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "outfits_utility" */
    xmlw_startElem(writer,"outfits_weapon");
+   bulk = xmlw_bulkOpen();
    for (int i=0; i<array_size(ship->outfit_weapon); i++) {
       if (ship->outfit_weapon[i].outfit==NULL)
          continue;
-      player_saveShipSlot( writer, &ship->outfit_weapon[i], i );
+      player_saveShipSlot( &bulk, &ship->outfit_weapon[i], i );
    }
+   if (xmlw_bulkWrite( writer, &bulk ))
+      return -1;
    xmlw_endElem(writer); /* "outfits_weapon" */
 
    /* save the commodities */
@@ -91,6 +91,11 @@ void player_autonavStart (void)
    dest = map_getDestination(NULL);
    player_message(_("#oAutonav: travelling to %s."), (sys_isKnown(dest) ? _(dest->name) : _("Unknown")) );
    player.autonav = AUTONAV_JUMP_APPROACH;
+
+   /* Warm the next system's assets during transit so the jump doesn't
+    * stall on loading. */
+   if (player.p->nav_hyperspace != -1)
+      space_prefetch( cur_system->jumps[ player.p->nav_hyperspace ].target );
 }
 
 /**
@@ -0,0 +1,704 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file profiler.c
+ *
+ * @brief Lightweight per-subsystem frame profiler.
+ *
+ * Scoped timers accumulate into per-frame buckets which get pushed into
+ * a ring buffer, so both average cost and 99th-percentile spikes are
+ * visible. Enabled with the "profiler" conf option; when disabled every
+ * entry point is a single branch. The overlay is drawn next to the FPS
+ * counter and the ring history is dumped as CSV on exit.
+ */
+/** @cond */
+#include <stdio.h>
+#include <stdlib.h>
+#include "SDL.h"
+
+#include "naev.h"
+
+#include "ncompat.h"
+#if HAS_POSIX
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL /* macOS; SO_NOSIGPIPE would be the fix if this bites. */
+#define MSG_NOSIGNAL 0
+#endif
+#endif /* HAS_POSIX */
+/** @endcond */
+
+#include "profiler.h"
+
+#include "array.h"
+#include "conf.h"
+#include "font.h"
+#include "log.h"
+#include "nfile.h"
+#include "nstring.h"
+#include "opengl.h"
+#include "pilot.h"
+#include "weapon.h"
+
+#define PROF_RING 256 /**< Frames of history kept. */
+
+/* From ARB_timer_query (core since 3.3); missing from the 3.1 glad header. */
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#define PROF_GPU_SEG 3 /**< Max segments a GPU bucket can reopen per frame. */
+
+/**
+ * @brief Human-readable bucket names, indexed by ProfBucket.
+ */
+static const char *prof_names[PROF_MAX] = {
+   "space", "weapons", "spfx", "pilots", "ai", "render"
+};
+
+static Uint64 prof_accum[PROF_MAX]; /**< Time accumulated this frame (perf counts). */
+static Uint64 prof_open[PROF_MAX];  /**< Counter value at prof_begin, 0 if closed. */
+static Uint64 prof_frame_start = 0; /**< Counter value at frame begin. */
+static double prof_hist[PROF_RING][PROF_MAX+1]; /**< Ring of per-frame times (ms), last column is the whole frame. */
+static int prof_hist_idx = 0;       /**< Next slot to write. */
+static int prof_hist_n   = 0;       /**< Valid entries in the ring. */
+/* Overlay statistics, refreshed periodically. */
+static double prof_avg[PROF_MAX+1]; /**< Average over the ring (ms). */
+static double prof_p99[PROF_MAX+1]; /**< 99th percentile over the ring (ms). */
+static double prof_stat_t = 0.;     /**< Time of last statistics refresh. */
+/* Whole-run totals for the benchmark report; the ring only covers the
+ * last PROF_RING frames. */
+static double prof_total[PROF_MAX+1]; /**< Total ms accumulated over the run. */
+static long prof_frames = 0;          /**< Frames recorded over the run. */
+
+/* Input-to-present latency: events carry the SDL tick they were queued
+ * at; the age of the oldest event handled in a frame is sampled right
+ * after the buffer swap. Frames that saw no input contribute nothing,
+ * so the ring covers the interactive frames only. */
+static double prof_lat[PROF_RING]; /**< Input age at present (ms). */
+static int prof_lat_idx = 0;       /**< Next slot to write. */
+static int prof_lat_n   = 0;       /**< Valid samples in the ring. */
+static Uint32 prof_lat_oldest = 0; /**< Oldest event tick seen this frame. */
+static int prof_lat_seen = 0;      /**< Whether input arrived this frame. */
+static double prof_lat_p50 = 0.;   /**< Median input age (ms). */
+static double prof_lat_p95 = 0.;   /**< 95th-percentile input age (ms). */
+static double prof_lat_max = 0.;   /**< Worst input age in the ring (ms). */
+
+/* Cumulative per-hook Lua timings, keyed by a "script:function" label
+ * reported from hook.c; identifies offender scripts in the field. */
+#define PROF_HOOK_MAX 64 /**< Distinct hook labels tracked. */
+typedef struct ProfHook_ {
+   char name[96];   /**< Label of the hook ("script:function"). */
+   double total;    /**< Total ms accumulated over the run. */
+   double max;      /**< Worst single run in ms. */
+   long runs;       /**< Number of runs. */
+} ProfHook;
+static ProfHook prof_hooks[PROF_HOOK_MAX]; /**< Tracked hooks. */
+static int prof_hook_n = 0; /**< Number of tracked hooks. */
+
+/* GPU pass timing; double-buffered elapsed queries, read back a frame
+ * late so the readback never forces a pipeline flush. */
+static const char *prof_gpu_names[PROFGPU_MAX] = {
+   "gpu bg", "gpu mid", "gpu gui", "gpu pp"
+};
+static int prof_gpu_state = 0; /**< 0 = untried, 1 = available, -1 = unsupported. */
+static GLuint prof_gpu_q[2][PROFGPU_MAX][PROF_GPU_SEG]; /**< Query objects. */
+static int prof_gpu_seg[2][PROFGPU_MAX]; /**< Segments issued per set. */
+static int prof_gpu_parity = 0; /**< Set currently being issued into. */
+static double prof_gpu_ms[PROFGPU_MAX]; /**< Rolling average per pass (ms). */
+static int prof_gpu_open = 0; /**< Whether a scope is currently open. */
+
+/* Stats exporter: latest per-frame sample published as JSON lines over a
+ * loopback TCP socket from a dedicated thread. Opt-in via the stats_port
+ * conf option; sampling piggybacks on the scoped timers, so enabling the
+ * exporter enables those too even without the overlay. */
+typedef struct ProfStats_ {
+   double row[PROF_MAX+1]; /**< Last frame's bucket times (ms). */
+   long frame;             /**< Frame number of the sample. */
+   int pilots;             /**< Pilots in the stack. */
+   int weapons;            /**< In-flight weapons. */
+} ProfStats;
+static ProfStats prof_stats;             /**< Latest sample, under prof_stats_lock. */
+static SDL_mutex *prof_stats_lock = NULL;   /**< Guards prof_stats. */
+static SDL_Thread *prof_stats_thread = NULL; /**< Publisher thread. */
+static int prof_stats_fd    = -1; /**< Listening socket. */
+static int prof_stats_state = 0;  /**< 0 = untried, 1 = running, -1 = failed. */
+static int prof_stats_quit  = 0;  /**< Tells the publisher thread to stop. */
+
+/*
+ * Prototypes.
+ */
+static double prof_toMS( Uint64 counts );
+static int prof_sortCompare( const void *a, const void *b );
+static void prof_refreshStats (void);
+static void prof_statsInit (void);
+static void prof_statsExit (void);
+#if HAS_POSIX
+static int prof_statsThread( void *unused );
+#endif /* HAS_POSIX */
+
+/**
+ * @brief Converts performance counter ticks to milliseconds.
+ */
+static double prof_toMS( Uint64 counts )
+{
+   return 1e3 * (double)counts / (double)SDL_GetPerformanceFrequency();
+}
+
+/**
+ * @brief Marks the start of a frame.
+ */
+void prof_frameBegin (void)
+{
+   if (!conf.profiler && !conf.stats_port)
+      return;
+   memset( prof_accum, 0, sizeof(prof_accum) );
+   memset( prof_open, 0, sizeof(prof_open) );
+   prof_frame_start = SDL_GetPerformanceCounter();
+}
+
+/**
+ * @brief Marks the end of a frame and records it into the ring.
+ */
+void prof_frameEnd (void)
+{
+   double *row;
+
+   if ((!conf.profiler && !conf.stats_port) || (prof_frame_start == 0))
+      return;
+
+   row = prof_hist[ prof_hist_idx ];
+   for (int i=0; i<PROF_MAX; i++)
+      row[i] = prof_toMS( prof_accum[i] );
+   /* AI runs inside pilots_update; report it separately. */
+   row[PROF_PILOTS] = MAX( 0., row[PROF_PILOTS] - row[PROF_AI] );
+   row[PROF_MAX] = prof_toMS( SDL_GetPerformanceCounter() - prof_frame_start );
+
+   prof_hist_idx = (prof_hist_idx+1) % PROF_RING;
+   prof_hist_n   = MIN( prof_hist_n+1, PROF_RING );
+
+   for (int i=0; i<=PROF_MAX; i++)
+      prof_total[i] += row[i];
+   prof_frames++;
+
+   /* Publish for the stats exporter. */
+   if (conf.stats_port > 0) {
+      if (prof_stats_state == 0)
+         prof_statsInit();
+      if (prof_stats_state == 1) {
+         SDL_LockMutex( prof_stats_lock );
+         memcpy( prof_stats.row, row, sizeof(prof_stats.row) );
+         prof_stats.frame   = prof_frames;
+         prof_stats.pilots  = array_size( pilot_getAll() );
+         prof_stats.weapons = weapon_count();
+         SDL_UnlockMutex( prof_stats_lock );
+      }
+   }
+}
+
+/**
+ * @brief Opens a timing scope for a bucket.
+ */
+void prof_begin( ProfBucket b )
+{
+   if (!conf.profiler && !conf.stats_port)
+      return;
+   prof_open[b] = SDL_GetPerformanceCounter();
+}
+
+/**
+ * @brief Closes a timing scope, accumulating into the frame bucket.
+ */
+void prof_end( ProfBucket b )
+{
+   if ((!conf.profiler && !conf.stats_port) || (prof_open[b] == 0))
+      return;
+   prof_accum[b] += SDL_GetPerformanceCounter() - prof_open[b];
+   prof_open[b]   = 0;
+}
+
+/**
+ * @brief Opens a GPU timing scope; initializes lazily on first use.
+ *
+ *    @param b Bucket to attribute the elapsed time to.
+ */
+void prof_gpuBegin( ProfGPUBucket b )
+{
+   int *seg;
+
+   if (!conf.profiler || (prof_gpu_state < 0))
+      return;
+
+   /* First call happens with a live GL context, so probe here. */
+   if (prof_gpu_state == 0) {
+      if (!SDL_GL_ExtensionSupported( "GL_ARB_timer_query" )) {
+         DEBUG(_("GL_ARB_timer_query unsupported; GPU pass timings disabled."));
+         prof_gpu_state = -1;
+         return;
+      }
+      glGenQueries( 2*PROFGPU_MAX*PROF_GPU_SEG, &prof_gpu_q[0][0][0] );
+      prof_gpu_state = 1;
+   }
+
+   seg = &prof_gpu_seg[prof_gpu_parity][b];
+   if (*seg >= PROF_GPU_SEG)
+      return;
+   glBeginQuery( GL_TIME_ELAPSED, prof_gpu_q[prof_gpu_parity][b][(*seg)++] );
+   prof_gpu_open = 1;
+}
+
+/**
+ * @brief Closes the currently open GPU timing scope.
+ */
+void prof_gpuEnd (void)
+{
+   if ((prof_gpu_state != 1) || !prof_gpu_open)
+      return;
+   glEndQuery( GL_TIME_ELAPSED );
+   prof_gpu_open = 0;
+}
+
+/**
+ * @brief Collects last frame's GPU timings and flips the query sets.
+ */
+void prof_gpuFrameEnd (void)
+{
+   int old, ready;
+
+   if (prof_gpu_state != 1)
+      return;
+
+   /* Results of the set issued last frame should be ready by now; if the
+    * driver is still busy just drop the sample rather than stall. */
+   old   = !prof_gpu_parity;
+   ready = 1;
+   for (int b=0; b<PROFGPU_MAX && ready; b++) {
+      for (int s=0; s<prof_gpu_seg[old][b]; s++) {
+         GLuint avail = 0;
+         glGetQueryObjectuiv( prof_gpu_q[old][b][s],
+               GL_QUERY_RESULT_AVAILABLE, &avail );
+         if (!avail) {
+            ready = 0;
+            break;
+         }
+      }
+   }
+   if (ready) {
+      for (int b=0; b<PROFGPU_MAX; b++) {
+         double ms = 0.;
+         if (prof_gpu_seg[old][b] == 0)
+            continue;
+         for (int s=0; s<prof_gpu_seg[old][b]; s++) {
+            GLuint ns = 0;
+            glGetQueryObjectuiv( prof_gpu_q[old][b][s], GL_QUERY_RESULT, &ns );
+            ms += (double)ns * 1e-6;
+         }
+         /* Rolling average; individual frames are too noisy on the GPU. */
+         prof_gpu_ms[b] += 0.05 * (ms - prof_gpu_ms[b]);
+      }
+   }
+
+   /* Reuse the consumed set next frame. */
+   for (int b=0; b<PROFGPU_MAX; b++)
+      prof_gpu_seg[old][b] = 0;
+   prof_gpu_parity = old;
+}
+
+/**
+ * @brief Accumulates one hook run into its cumulative entry.
+ *
+ *    @param name Label identifying the hook's script and function.
+ *    @param ms Duration of the run in milliseconds.
+ */
+void prof_hookTime( const char *name, double ms )
+{
+   ProfHook *ph = NULL;
+
+   if (!conf.profiler)
+      return;
+
+   for (int i=0; i<prof_hook_n; i++) {
+      if (strcmp( prof_hooks[i].name, name )==0) {
+         ph = &prof_hooks[i];
+         break;
+      }
+   }
+   if (ph == NULL) {
+      if (prof_hook_n >= PROF_HOOK_MAX)
+         return; /* Table full; the big offenders are in by now. */
+      ph = &prof_hooks[ prof_hook_n++ ];
+      snprintf( ph->name, sizeof(ph->name), "%s", name );
+   }
+   ph->total += ms;
+   ph->max    = MAX( ph->max, ms );
+   ph->runs++;
+}
+
+/**
+ * @brief Notes an input event being handled this frame.
+ *
+ *    @param timestamp SDL tick (ms) the event was queued at.
+ */
+void prof_inputEvent( unsigned int timestamp )
+{
+   if (!conf.profiler)
+      return;
+   if (!prof_lat_seen || ((Uint32)timestamp < prof_lat_oldest))
+      prof_lat_oldest = timestamp;
+   prof_lat_seen = 1;
+}
+
+/**
+ * @brief Samples input age right after the frame's buffer swap.
+ */
+void prof_inputPresent (void)
+{
+   if (!conf.profiler || !prof_lat_seen)
+      return;
+   prof_lat[ prof_lat_idx ] = (double)(SDL_GetTicks() - prof_lat_oldest);
+   prof_lat_idx  = (prof_lat_idx+1) % PROF_RING;
+   prof_lat_n    = MIN( prof_lat_n+1, PROF_RING );
+   prof_lat_seen = 0;
+}
+
+/**
+ * @brief qsort comparison for doubles.
+ */
+static int prof_sortCompare( const void *a, const void *b )
+{
+   double da = *(const double*)a;
+   double db = *(const double*)b;
+   if (da < db)
+      return -1;
+   else if (da > db)
+      return 1;
+   return 0;
+}
+
+/**
+ * @brief Recomputes the averages and percentiles shown by the overlay.
+ */
+static void prof_refreshStats (void)
+{
+   double sorted[PROF_RING];
+
+   for (int b=0; b<=PROF_MAX; b++) {
+      double sum = 0.;
+      for (int i=0; i<prof_hist_n; i++) {
+         sorted[i] = prof_hist[i][b];
+         sum      += sorted[i];
+      }
+      qsort( sorted, prof_hist_n, sizeof(double), prof_sortCompare );
+      prof_avg[b] = sum / (double)prof_hist_n;
+      prof_p99[b] = sorted[ (prof_hist_n-1) * 99 / 100 ];
+   }
+
+   if (prof_lat_n > 0) {
+      for (int i=0; i<prof_lat_n; i++)
+         sorted[i] = prof_lat[i];
+      qsort( sorted, prof_lat_n, sizeof(double), prof_sortCompare );
+      prof_lat_p50 = sorted[ (prof_lat_n-1) / 2 ];
+      prof_lat_p95 = sorted[ (prof_lat_n-1) * 95 / 100 ];
+      prof_lat_max = sorted[ prof_lat_n-1 ];
+   }
+}
+
+/**
+ * @brief Renders the profiler overlay.
+ *
+ *    @param x X position to render at.
+ *    @param y Y position of the top line; lines grow downwards.
+ */
+void prof_renderOverlay( double x, double y )
+{
+   if (!conf.profiler || (prof_hist_n <= 0))
+      return;
+
+   /* Refresh the statistics a couple of times a second; sorting every
+    * frame would show up in its own numbers. */
+   if (SDL_GetTicks() - prof_stat_t > 500.) {
+      prof_refreshStats();
+      prof_stat_t = SDL_GetTicks();
+   }
+
+   gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-8s %6s %6s", "bucket", "avg", "p99" );
+   y -= gl_defFontMono.h + 5.;
+   for (int b=0; b<PROF_MAX; b++) {
+      gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-8s %6.2f %6.2f",
+            prof_names[b], prof_avg[b], prof_p99[b] );
+      y -= gl_defFontMono.h + 5.;
+   }
+   gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-8s %6.2f %6.2f",
+         "frame", prof_avg[PROF_MAX], prof_p99[PROF_MAX] );
+
+   /* Input age at present: p50/p95/max over the sampled frames. */
+   if (prof_lat_n > 0) {
+      y -= gl_defFontMono.h + 5.;
+      gl_print( &gl_defFontMono, x, y, &cFontWhite,
+            "%-8s %6.1f %6.1f %6.1f", "input", prof_lat_p50, prof_lat_p95,
+            prof_lat_max );
+   }
+
+   /* GPU pass averages, when timer queries are available. */
+   if (prof_gpu_state == 1) {
+      for (int b=0; b<PROFGPU_MAX; b++) {
+         y -= gl_defFontMono.h + 5.;
+         gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-8s %6.2f",
+               prof_gpu_names[b], prof_gpu_ms[b] );
+      }
+   }
+
+   /* Top hook offenders by cumulative time. */
+   if (prof_hook_n > 0) {
+      int shown[3] = { -1, -1, -1 };
+      y -= gl_defFontMono.h + 5.;
+      gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-24s %7s %6s", "hook", "total", "max" );
+      for (int n=0; n<MIN(3,prof_hook_n); n++) {
+         int best = -1;
+         for (int i=0; i<prof_hook_n; i++) {
+            int skip = 0;
+            for (int j=0; j<n; j++)
+               skip |= (shown[j] == i);
+            if (skip)
+               continue;
+            if ((best < 0) || (prof_hooks[i].total > prof_hooks[best].total))
+               best = i;
+         }
+         shown[n] = best;
+         y -= gl_defFontMono.h + 5.;
+         gl_print( &gl_defFontMono, x, y, &cFontWhite, "%-24s %7.1f %6.2f",
+               prof_hooks[best].name, prof_hooks[best].total, prof_hooks[best].max );
+      }
+   }
+}
+
+#if HAS_POSIX
+/**
+ * @brief Publisher thread: serves one client at a time with JSON lines.
+ *
+ * Blocks in accept() until prof_statsExit() closes the listening socket.
+ * Memory figures come from the array allocation tracker, whose counters
+ * are documented as indicative when read off the main thread.
+ */
+static int prof_statsThread( void *unused )
+{
+   (void) unused;
+
+   while (!prof_stats_quit) {
+      int c = accept( prof_stats_fd, NULL, NULL );
+      if (c < 0) {
+         if (prof_stats_quit)
+            break; /* Listener was closed to quit. */
+         SDL_Delay( 100 ); /* Transient failure; do not spin. */
+         continue;
+      }
+
+      while (!prof_stats_quit) {
+         char buf[STRMAX];
+         ProfStats st;
+         int l;
+
+         SDL_LockMutex( prof_stats_lock );
+         st = prof_stats;
+         SDL_UnlockMutex( prof_stats_lock );
+
+         l = scnprintf( buf, sizeof(buf),
+               "{\"frame\":%ld,\"pilots\":%d,\"weapons\":%d,\"ms\":{",
+               st.frame, st.pilots, st.weapons );
+         for (int b=0; b<PROF_MAX; b++)
+            l += scnprintf( &buf[l], sizeof(buf)-l, "\"%s\":%.3f,",
+                  prof_names[b], st.row[b] );
+         l += scnprintf( &buf[l], sizeof(buf)-l, "\"frame\":%.3f}",
+               st.row[PROF_MAX] );
+
+         /* Live array allocation by creating callsite, when tracked. */
+         if (array_tagCount() > 0) {
+            l += scnprintf( &buf[l], sizeof(buf)-l, ",\"mem\":{" );
+            for (int i=0; i<array_tagCount(); i++) {
+               const char *tag;
+               size_t live;
+               ptrdiff_t growth;
+               if (array_tagStats( i, &tag, &live, &growth ))
+                  break;
+               l += scnprintf( &buf[l], sizeof(buf)-l, "%s\"%s\":%zu",
+                     (i > 0) ? "," : "", tag, live );
+            }
+            l += scnprintf( &buf[l], sizeof(buf)-l, "}" );
+         }
+         l += scnprintf( &buf[l], sizeof(buf)-l, "}\n" );
+
+         /* MSG_NOSIGNAL: a vanished client must not SIGPIPE the game. */
+         if (send( c, buf, l, MSG_NOSIGNAL ) != l)
+            break; /* Client went away; back to accepting. */
+         SDL_Delay( 500 );
+      }
+      close( c );
+   }
+   return 0;
+}
+#endif /* HAS_POSIX */
+
+/**
+ * @brief Binds the loopback listener and starts the publisher thread.
+ */
+static void prof_statsInit (void)
+{
+#if HAS_POSIX
+   struct sockaddr_in addr;
+   int one = 1;
+
+   prof_stats_fd = socket( AF_INET, SOCK_STREAM, 0 );
+   if (prof_stats_fd < 0) {
+      WARN(_("stats export: unable to create socket"));
+      prof_stats_state = -1;
+      return;
+   }
+   setsockopt( prof_stats_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one) );
+
+   memset( &addr, 0, sizeof(addr) );
+   addr.sin_family      = AF_INET;
+   addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+   addr.sin_port        = htons( conf.stats_port );
+   if (bind( prof_stats_fd, (struct sockaddr*)&addr, sizeof(addr) ) ||
+         listen( prof_stats_fd, 1 )) {
+      WARN(_("stats export: unable to listen on 127.0.0.1:%d"), conf.stats_port);
+      close( prof_stats_fd );
+      prof_stats_fd    = -1;
+      prof_stats_state = -1;
+      return;
+   }
+
+   prof_stats_lock   = SDL_CreateMutex();
+   prof_stats_thread = SDL_CreateThread( prof_statsThread, "stats-export", NULL );
+   if (prof_stats_thread == NULL) {
+      WARN(_("stats export: unable to start publisher thread"));
+      close( prof_stats_fd );
+      prof_stats_fd    = -1;
+      prof_stats_state = -1;
+      return;
+   }
+   prof_stats_state = 1;
+   DEBUG(_("Publishing runtime statistics on 127.0.0.1:%d"), conf.stats_port);
+#else /* HAS_POSIX */
+   WARN(_("stats export: local sockets unsupported on this platform"));
+   prof_stats_state = -1;
+#endif /* HAS_POSIX */
+}
+
+/**
+ * @brief Stops the publisher thread and closes the listener.
+ */
+static void prof_statsExit (void)
+{
+   if (prof_stats_state != 1)
+      return;
+   prof_stats_quit = 1;
+#if HAS_POSIX
+   /* shutdown() reliably kicks the thread out of accept() — on Linux a
+    * plain close() may leave it blocked; a connected client is noticed
+    * at the next publish interval. */
+   shutdown( prof_stats_fd, SHUT_RDWR );
+   close( prof_stats_fd );
+#endif /* HAS_POSIX */
+   SDL_WaitThread( prof_stats_thread, NULL );
+   SDL_DestroyMutex( prof_stats_lock );
+   prof_stats_fd     = -1;
+   prof_stats_thread = NULL;
+   prof_stats_lock   = NULL;
+   prof_stats_state  = -1;
+}
+
+/**
+ * @brief Dumps the ring history as CSV and cleans up.
+ */
+void prof_exit (void)
+{
+   char file[PATH_MAX];
+   FILE *f;
+   int start;
+
+   prof_statsExit();
+
+   if (!conf.profiler || (prof_hist_n <= 0))
+      return;
+
+   snprintf( file, sizeof(file), "%sprofile.csv", nfile_cachePath() );
+   f = fopen( file, "w" );
+   if (f == NULL) {
+      WARN(_("Unable to write profiler dump to '%s'"), file);
+      return;
+   }
+
+   for (int b=0; b<PROF_MAX; b++)
+      fprintf( f, "%s,", prof_names[b] );
+   fprintf( f, "frame\n" );
+
+   /* Oldest first. */
+   start = (prof_hist_n < PROF_RING) ? 0 : prof_hist_idx;
+   for (int i=0; i<prof_hist_n; i++) {
+      const double *row = prof_hist[ (start+i) % PROF_RING ];
+      for (int b=0; b<PROF_MAX; b++)
+         fprintf( f, "%.3f,", row[b] );
+      fprintf( f, "%.3f\n", row[PROF_MAX] );
+   }
+
+   fclose( f );
+   DEBUG(_("Wrote profiler dump to '%s'"), file);
+
+   /* Benchmark runs also get a machine-readable summary for trend
+    * tracking across releases. */
+   if (conf.benchmark > 0)
+      prof_dumpJSON();
+
+   /* Release the GPU query objects while the context is still alive. */
+   if (prof_gpu_state == 1) {
+      glDeleteQueries( 2*PROFGPU_MAX*PROF_GPU_SEG, &prof_gpu_q[0][0][0] );
+      prof_gpu_state = -1;
+   }
+}
+
+/**
+ * @brief Writes whole-run per-subsystem timings as JSON to the cache path.
+ */
+void prof_dumpJSON (void)
+{
+   char file[PATH_MAX];
+   FILE *f;
+
+   if (prof_frames <= 0)
+      return;
+
+   snprintf( file, sizeof(file), "%sbenchmark.json", nfile_cachePath() );
+   f = fopen( file, "w" );
+   if (f == NULL) {
+      WARN(_("Unable to write benchmark report to '%s'"), file);
+      return;
+   }
+
+   fprintf( f, "{\n  \"frames\": %ld,\n  \"subsystems\": {\n", prof_frames );
+   for (int b=0; b<PROF_MAX; b++)
+      fprintf( f, "    \"%s\": { \"total_ms\": %.3f, \"avg_ms\": %.4f },\n",
+            prof_names[b], prof_total[b], prof_total[b] / (double)prof_frames );
+   fprintf( f, "    \"frame\": { \"total_ms\": %.3f, \"avg_ms\": %.4f }\n  }",
+         prof_total[PROF_MAX], prof_total[PROF_MAX] / (double)prof_frames );
+   if (prof_gpu_state == 1) {
+      fprintf( f, ",\n  \"gpu_passes\": {\n" );
+      for (int b=0; b<PROFGPU_MAX; b++)
+         fprintf( f, "    \"%s\": { \"avg_ms\": %.4f }%s\n",
+               prof_gpu_names[b], prof_gpu_ms[b],
+               (b < PROFGPU_MAX-1) ? "," : "" );
+      fprintf( f, "  }" );
+   }
+   if (prof_hook_n > 0) {
+      fprintf( f, ",\n  \"hooks\": {\n" );
+      for (int i=0; i<prof_hook_n; i++)
+         fprintf( f, "    \"%s\": { \"total_ms\": %.3f, \"max_ms\": %.3f, \"runs\": %ld }%s\n",
+               prof_hooks[i].name, prof_hooks[i].total, prof_hooks[i].max,
+               prof_hooks[i].runs, (i < prof_hook_n-1) ? "," : "" );
+      fprintf( f, "  }" );
+   }
+   fprintf( f, "\n}\n" );
+   fclose( f );
+   LOG(_("Wrote benchmark report to '%s'"), file);
+}
@@ -0,0 +1,69 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/**
+ * @brief Timing buckets for the frame profiler.
+ */
+typedef enum ProfBucket_ {
+   PROF_SPACE,    /**< space_update */
+   PROF_WEAPONS,  /**< weapons_update */
+   PROF_SPFX,     /**< spfx_update */
+   PROF_PILOTS,   /**< pilots_update (minus AI) */
+   PROF_AI,       /**< ai_think, accumulated over all pilots */
+   PROF_RENDER,   /**< render_all */
+   PROF_MAX       /**< Sentinel. */
+} ProfBucket;
+
+/*
+ * Frame boundaries.
+ */
+void prof_frameBegin (void);
+void prof_frameEnd (void);
+
+/*
+ * Scoped timing. Nesting different buckets is fine; times accumulate
+ * over the frame so per-pilot scopes like PROF_AI can reopen.
+ */
+void prof_begin( ProfBucket b );
+void prof_end( ProfBucket b );
+
+/**
+ * @brief GPU timing buckets for the render passes in render_all.
+ */
+typedef enum ProfGPUBucket_ {
+   PROFGPU_BG,    /**< Background: nebula, stars, spobs, back weapons. */
+   PROFGPU_MID,   /**< Pilots, weapons and particles. */
+   PROFGPU_GUI,   /**< GUI, overlays and toolkit. */
+   PROFGPU_PP,    /**< Post-processing chain. */
+   PROFGPU_MAX    /**< Sentinel. */
+} ProfGPUBucket;
+
+/*
+ * GPU pass timing. Scopes must not overlap (GL allows a single elapsed
+ * query at a time) but a bucket may reopen for further segments. Results
+ * are read back a frame late so the pipeline never stalls.
+ */
+void prof_gpuBegin( ProfGPUBucket b );
+void prof_gpuEnd (void);
+void prof_gpuFrameEnd (void);
+
+/*
+ * Per-hook script timing; see hook.c.
+ */
+void prof_hookTime( const char *name, double ms );
+
+/*
+ * Input-to-present latency; input.c stamps events as they are handled
+ * and main_loop reports after the buffer swap.
+ */
+void prof_inputEvent( unsigned int timestamp );
+void prof_inputPresent (void);
+
+/*
+ * Output.
+ */
+void prof_renderOverlay( double x, double y );
+void prof_dumpJSON (void);
+void prof_exit (void);
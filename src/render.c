@@ -13,6 +13,7 @@
 #include "opengl.h"
 #include "pause.h"
 #include "player.h"
+#include "profiler.h"
 #include "space.h"
 #include "spfx.h"
 #include "toolkit.h"
@@ -60,7 +61,7 @@ static void render_fbo( double dt, GLuint fbo, GLuint tex, PPShader *shader )
 
    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-   glUseProgram( shader->program );
+   gl_useProgram( shader->program );
 
    /* Screen size. */
    if (shader->love_ScreenSize >= 0)
@@ -103,12 +104,43 @@ static void render_fbo( double dt, GLuint fbo, GLuint tex, PPShader *shader )
    glDisableVertexAttribArray( shader->VertexPosition );
    if (shader->VertexTexCoord >= 0)
       glDisableVertexAttribArray( shader->VertexTexCoord );
-   glUseProgram( 0 );
+   gl_useProgram( 0 );
 
    /* Restore the default mode. */
    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 }
 
+/**
+ * @brief Upscales the reduced-resolution scene to the current target.
+ *
+ * Used when conf.render_scale < 1.: the world has been rendered into
+ * gl_screen.scene_fbo and gets sharpened back up to native resolution
+ * here, before the GUI renders natively on top.
+ */
+static void render_sceneUpscale (void)
+{
+   const mat4 ortho = mat4_ortho( 0., 1., 1., 0., 1., -1. );
+
+   glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+   glViewport( 0, 0, gl_screen.rw, gl_screen.rh );
+   gl_screen.cvw = gl_screen.rw;
+   gl_screen.cvh = gl_screen.rh;
+
+   glDisable( GL_BLEND );
+   gl_useProgram( shaders.sharpen.program );
+   glUniform4f( shaders.sharpen.love_ScreenSize,
+         gl_screen.scene_rw, gl_screen.scene_rh, 1., 0. );
+   glEnableVertexAttribArray( shaders.sharpen.VertexPosition );
+   gl_vboActivateAttribOffset( gl_squareVBO, shaders.sharpen.VertexPosition, 0, 2, GL_FLOAT, 0 );
+   glBindTexture( GL_TEXTURE_2D, gl_screen.scene_fbo_tex );
+   glUniform1i( shaders.sharpen.MainTex, 0 );
+   gl_uniformMat4( shaders.sharpen.ClipSpaceFromLocal, &ortho );
+   glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   glDisableVertexAttribArray( shaders.sharpen.VertexPosition );
+   gl_useProgram( 0 );
+   glEnable( GL_BLEND );
+}
+
 /**
  * @brief Renders a list of FBOs.
  */
@@ -172,9 +204,13 @@ static void render_fbo_list( double dt, PPShader *list, int *current, int done )
 void render_all( double game_dt, double real_dt )
 {
    double dt;
-   int pp_final, pp_gui, pp_game;
+   int pp_final, pp_gui, pp_game, lowres;
+   GLuint fullres_fbo = 0;
    int cur = 0;
 
+   /* Anything may have touched GL state since the last frame. */
+   gl_stateInvalidate();
+
    /* See what post-processing is up. */
    pp_game  = (array_size(pp_shaders_list[PP_LAYER_GAME]) > 0);
    pp_gui   = (array_size(pp_shaders_list[PP_LAYER_GUI]) > 0);
@@ -205,12 +241,33 @@ void render_all( double game_dt, double real_dt )
    /* Set up the default viewport. */
    gl_defViewport();
 
+   /* World layers optionally render into a reduced-resolution framebuffer;
+    * the projection is unchanged, so the smaller viewport does the
+    * downscale and render_sceneUpscale() sharpens it back up before the
+    * natively rendered GUI. */
+   lowres = (gl_screen.scene_fbo != GL_INVALID_VALUE);
+   if (lowres) {
+      fullres_fbo = gl_screen.current_fbo;
+      gl_screen.current_fbo = gl_screen.scene_fbo;
+      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+      glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+      glViewport( 0, 0, gl_screen.scene_rw, gl_screen.scene_rh );
+      gl_screen.cvw = gl_screen.scene_rw;
+      gl_screen.cvh = gl_screen.scene_rh;
+   }
+
    /* Background stuff */
+   if (conf.profiler)
+      prof_gpuBegin( PROFGPU_BG );
    space_render( real_dt ); /* Nebula looks really weird otherwise. */
    hooks_run( "renderbg" );
    spobs_render();
    spfx_render(SPFX_LAYER_BACK);
    weapons_render(WEAPON_LAYER_BG, dt);
+   if (conf.profiler) {
+      prof_gpuEnd();
+      prof_gpuBegin( PROFGPU_MID );
+   }
    /* Middle stuff */
    player_renderUnderlay(dt);
    pilots_render();
@@ -223,29 +280,63 @@ void render_all( double game_dt, double real_dt )
    gui_renderReticles(dt);
    pilots_renderOverlay();
    hooks_run( "renderfg" );
+   if (conf.profiler)
+      prof_gpuEnd();
+
+   /* Bring the scene back up to native resolution. */
+   if (lowres) {
+      gl_screen.current_fbo = fullres_fbo;
+      render_sceneUpscale();
+   }
 
    /* Process game stuff only. */
-   if (pp_game)
+   if (pp_game) {
+      if (conf.profiler)
+         prof_gpuBegin( PROFGPU_PP );
       render_fbo_list( dt, pp_shaders_list[PP_LAYER_GAME], &cur, !(pp_final || pp_gui) );
+      if (conf.profiler)
+         prof_gpuEnd();
+   }
 
    /* GUi stuff. */
+   if (conf.profiler)
+      prof_gpuBegin( PROFGPU_GUI );
    gui_render(dt);
+   if (conf.profiler)
+      prof_gpuEnd();
 
-   if (pp_gui)
+   if (pp_gui) {
+      if (conf.profiler)
+         prof_gpuBegin( PROFGPU_PP );
       render_fbo_list( dt, pp_shaders_list[PP_LAYER_GUI], &cur, !pp_final );
+      if (conf.profiler)
+         prof_gpuEnd();
+   }
 
    /* We set the to fullscreen, ignoring the GUI modifications. */
    gl_viewport( 0, 0, gl_screen.nw, gl_screen.nh );
 
    /* Top stuff. */
+   if (conf.profiler)
+      prof_gpuBegin( PROFGPU_GUI );
    ovr_render( real_dt ); /* Using real_dt is sort of a hack for now. */
    hooks_run( "rendertop" );
    display_fps( real_dt ); /* Exception using real_dt. */
    toolkit_render( real_dt );
+   if (conf.profiler)
+      prof_gpuEnd();
 
    /* Final post-processing. */
-   if (pp_final)
+   if (pp_final) {
+      if (conf.profiler)
+         prof_gpuBegin( PROFGPU_PP );
       render_fbo_list( dt, pp_shaders_list[PP_LAYER_FINAL], &cur, 1 );
+      if (conf.profiler)
+         prof_gpuEnd();
+   }
+
+   if (conf.profiler)
+      prof_gpuFrameEnd();
 
    /* check error every loop */
    gl_checkErr();
@@ -408,8 +499,8 @@ void render_setGamma( double gamma )
       return;
 
    /* Set gamma and upload. */
-   glUseProgram( shaders.gamma_correction.program );
+   gl_useProgram( shaders.gamma_correction.program );
    glUniform1f( shaders.gamma_correction.gamma, gamma );
-   glUseProgram( 0 );
+   gl_useProgram( 0 );
    pp_gamma_correction = render_postprocessAdd( &gamma_correction_shader, PP_LAYER_FINAL, 98, PP_SHADER_PERMANENT );
 }
@@ -39,10 +39,16 @@ static uint32_t MT[624]; /**< Mersenne twister state. */
 static uint32_t mt_y; /**< Internal mersenne twister variable. */
 static int mt_pos = 0; /**< Current number being used. */
 
+/*
+ * counter-based stream state
+ */
+static uint64_t rng_stream_seed = 0; /**< Session seed mixed into every stream key. */
+
 /*
  * prototypes
  */
 static uint32_t rng_timeEntropy (void);
+static uint64_t rng_mix64( uint64_t x );
 /* mersenne twister */
 static void mt_initArray( uint32_t seed );
 static void mt_genArray (void);
@@ -80,6 +86,10 @@ void rng_init (void)
       mt_initArray( i );
    for (i=0; i<10; i++) /* generate numbers to get away from poor initial values */
       mt_genArray();
+
+   /* Seed the counter-based streams; fixed for the session so every
+    * stream is reproducible within a run. */
+   rng_stream_seed = ((uint64_t)mt_getInt() << 32) | (uint64_t)mt_getInt();
 }
 
 /**
@@ -183,6 +193,75 @@ double randfp (void)
    return m / m_div;
 }
 
+/**
+ * @fn static uint64_t rng_mix64( uint64_t x )
+ *
+ * @brief Finalization mixer (splitmix64); bijective with good avalanche.
+ *
+ *    @param x Value to mix.
+ *    @return Mixed value.
+ */
+static uint64_t rng_mix64( uint64_t x )
+{
+   x ^= x >> 30;
+   x *= 0xbf58476d1ce4e5b9ULL;
+   x ^= x >> 27;
+   x *= 0x94d049bb133111ebULL;
+   x ^= x >> 31;
+   return x;
+}
+
+/**
+ * @fn void rng_streamInit( RNGStream *s, unsigned int subsystem, unsigned int entity, uint64_t tick )
+ *
+ * @brief Initializes a deterministic counter-based stream.
+ *
+ * The sequence drawn from the stream depends only on the session seed and
+ * the three key components, never on global state, so concurrent update
+ * passes get reproducible, race-free randomness.
+ *
+ *    @param s Stream to initialize.
+ *    @param subsystem One of the RNG_STREAM_* identifiers.
+ *    @param entity Entity within the subsystem (e.g. pilot id).
+ *    @param tick Simulation tick or frame counter.
+ */
+void rng_streamInit( RNGStream *s, unsigned int subsystem,
+      unsigned int entity, uint64_t tick )
+{
+   s->key = rng_mix64( rng_stream_seed ^
+         rng_mix64( ((uint64_t)subsystem << 32) ^ (uint64_t)entity ^
+            rng_mix64( tick ) ) );
+   s->ctr = 0;
+}
+
+/**
+ * @fn unsigned int rng_streamInt( RNGStream *s )
+ *
+ * @brief Gets the next integer from a stream.
+ *
+ *    @param s Stream to draw from.
+ *    @return A random 4 byte number.
+ */
+unsigned int rng_streamInt( RNGStream *s )
+{
+   s->ctr += 0x9e3779b97f4a7c15ULL; /* Weyl sequence keeps draws decorrelated. */
+   return (unsigned int)(rng_mix64( s->key ^ s->ctr ) >> 32);
+}
+
+/**
+ * @fn double rng_streamFp( RNGStream *s )
+ *
+ * @brief Gets the next float between 0 and 1 (inclusive) from a stream.
+ *
+ *    @param s Stream to draw from.
+ *    @return A random float between 0 and 1 (inclusive).
+ */
+double rng_streamFp( RNGStream *s )
+{
+   double m = (double)rng_streamInt( s );
+   return m / m_div;
+}
+
 /**
  * @fn double Normal( double x )
  *
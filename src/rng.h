@@ -3,6 +3,10 @@
  */
 #pragma once
 
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
 /**
  * @brief Gets a random number between L and H (L <= RNG <= H).
  *
@@ -38,6 +42,40 @@
  */
 #define RNG_3SIGMA()       NormalInverse(0.0013498985 + RNGF()*(1.-0.0013498985*2.))
 
+/**
+ * @brief Gets a random number between L and H from a stream (L <= RNGS <= H).
+ */
+#define RNGS(s,L,H)  (((L)>(H)) ? RNGS_BASE((s),(H),(L)) : RNGS_BASE((s),(L),(H)))
+/**
+ * @brief Gets a number between L and H from a stream, unspecified if L > H.
+ */
+#define RNGS_BASE(s,L,H) ((int)L + (int)((double)(H-L+1) * rng_streamFp(s)))
+/**
+ * @brief Gets a random float between 0 and 1 from a stream (0. <= RNGSF <= 1.).
+ */
+#define RNGSF(s)  (rng_streamFp(s))
+
+/**
+ * @brief A deterministic counter-based random stream.
+ *
+ * Unlike RNG()/RNGF(), which draw from a single global mersenne twister,
+ * streams are keyed by subsystem, entity and tick, so every entity draws an
+ * independent, reproducible sequence regardless of the order - or thread -
+ * entities are updated in. State is two integers, so creating a stream per
+ * entity per update is free.
+ */
+typedef struct RNGStream_ {
+   uint64_t key; /**< Stream identity. */
+   uint64_t ctr; /**< Position within the stream. */
+} RNGStream;
+
+/* Subsystem identifiers, to keep update passes from sharing sequences. */
+enum {
+   RNG_STREAM_PILOT = 1, /**< Pilot update pass. */
+   RNG_STREAM_WEAPON,    /**< Weapon update pass. */
+   RNG_STREAM_SPFX,      /**< Special effects. */
+};
+
 /* Init */
 void rng_init (void);
 
@@ -45,6 +83,12 @@ void rng_init (void);
 unsigned int randint (void);
 double randfp (void);
 
+/* Counter-based streams. */
+void rng_streamInit( RNGStream *s, unsigned int subsystem,
+      unsigned int entity, uint64_t tick );
+unsigned int rng_streamInt( RNGStream *s );
+double rng_streamFp( RNGStream *s );
+
 /* Probability functions */
 double Normal( double x );
 double NormalInverse( double p );
@@ -39,6 +39,7 @@
 #include "array.h"
 #include "conf.h"
 #include "log.h"
+#include "threadpool.h"
 #include "union_find.h"
 
 /*
@@ -112,6 +113,19 @@ static cholmod_dense **PPl;     /**< Array: (array.h): For each builder faction,
 static double* cmp_key_ref;     /**< To qsort() a list of indices by table value, point this at your table and use cmp_key. */
 static int safelanes_calculated_once = 0; /**< Whether or not the safe lanes have been computed once. */
 
+#define SCORE_CHUNK 16 /**< Candidate edges per parallel-for chunk when scoring. */
+/**
+ * @brief Shared state for the parallel candidate-scoring pass.
+ */
+typedef struct ScoreWork_ {
+   const int *edgeind_opts; /**< Candidate edge ids being scored. */
+   double *scores;          /**< Output scores, one per candidate. */
+   cholmod_dense *lal;      /**< The sliced Lambda_tilde @ PPl matrix. */
+   size_t sys_base;         /**< First utilde row of the system. */
+   size_t lal_base;         /**< First lal row of the system. */
+} ScoreWork;
+static uint64_t *sys_hash_prev = NULL; /**< Malloced: per system, hash of lane-relevant inputs at the last solve. */
+
 /*
  * Prototypes.
  */
@@ -144,6 +158,7 @@ static inline void triplet_entry( cholmod_triplet* m, int i, int j, double v );
 static cholmod_dense* safelanes_sliceByPresence( cholmod_dense* m, double* sysPresence );
 static cholmod_dense* ncholmod_ddmult( cholmod_dense* A, int transA, cholmod_dense* B );
 static double safelanes_row_dot_row( cholmod_dense* A, cholmod_dense* B, int i, int j );
+static void safelanes_scoreChunk( int begin, int end, void *data );
 
 /**
  * @brief Like array_push_back( a, Edge{v0, v1} ), but achievable in C. :-P
@@ -174,6 +189,8 @@ void safelanes_destroy (void)
 {
    safelanes_destroyOptimizer();
    safelanes_destroyStacks();
+   free( sys_hash_prev );
+   sys_hash_prev = NULL;
    cholmod_finish( &C );
 }
 
@@ -243,19 +260,145 @@ SafeLane* safelanes_get( int faction, int standing, const StarSystem* system )
    return out;
 }
 
+/**
+ * @brief Hashes the inputs of a system that influence lane building.
+ *
+ * FNV-1a over the presence tables, the eligible spobs and the jump
+ * topology; if the hash is unchanged since the last solve, the system's
+ * part of the problem is identical.
+ */
+static uint64_t safelanes_systemHash( const StarSystem *sys )
+{
+   uint64_t h = 0xcbf29ce484222325ull;
+#define HASH_BYTES( ptr, len ) \
+   do { \
+      const unsigned char *_b = (const unsigned char*)(ptr); \
+      for (size_t _i=0; _i<(len); _i++) { \
+         h ^= _b[_i]; \
+         h *= 0x100000001b3ull; \
+      } \
+   } while (0)
+   HASH_BYTES( &sys->flags, sizeof(sys->flags) );
+   for (int i=0; i<array_size(sys->presence); i++) {
+      const SystemPresence *sp = &sys->presence[i];
+      HASH_BYTES( &sp->faction, sizeof(sp->faction) );
+      HASH_BYTES( &sp->value, sizeof(sp->value) );
+   }
+   for (int i=0; i<array_size(sys->spobs); i++) {
+      const SpobPresence *ap = &sys->spobs[i]->presence;
+      HASH_BYTES( &ap->faction, sizeof(ap->faction) );
+      HASH_BYTES( &ap->base, sizeof(ap->base) );
+      HASH_BYTES( &ap->bonus, sizeof(ap->bonus) );
+   }
+   for (int i=0; i<array_size(sys->jumps); i++)
+      HASH_BYTES( &sys->jumps[i].targetid, sizeof(sys->jumps[i].targetid) );
+#undef HASH_BYTES
+   return h;
+}
+
 /**
  * @brief Update the safe lane locations in response to the universe changing (e.g., diff applied).
+ *
+ * Incremental behaviour: systems whose lane-relevant inputs are
+ * unchanged since the last solve (and which aren't adjacent to a
+ * changed system, where the potential field shifts the most) keep their
+ * previous lanes and are excluded from the optimization, so only the
+ * affected region pays for re-solving. If nothing changed, the call is
+ * a no-op.
  */
 void safelanes_recalculate (void)
 {
    Uint32 time = SDL_GetTicks();
+   const StarSystem *systems_stack = system_getAll();
+   int nsys = array_size( systems_stack );
+   uint64_t *hash;
+   char *dirty = NULL;
+   int nclean = 0;
+   int **oldlanes = NULL;
+   int *oldlanes_n = NULL;
 
    /* Don't recompute on exit. */
    if (naev_isQuit())
       return;
 
+   /* See which systems actually changed since the last solve. */
+   hash = malloc( nsys * sizeof(uint64_t) );
+   for (int si=0; si<nsys; si++)
+      hash[si] = safelanes_systemHash( &systems_stack[si] );
+   if (safelanes_calculated_once && (sys_hash_prev != NULL) &&
+         (array_size(sys_to_first_edge)-1 == nsys)) {
+      dirty = calloc( nsys, 1 );
+      for (int si=0; si<nsys; si++)
+         if (hash[si] != sys_hash_prev[si])
+            dirty[si] = 1;
+      /* Dirty the first ring of jump neighbours too; that's where the
+       * potential field changes enough to reroute lanes. */
+      for (int si=0; si<nsys; si++) {
+         if (dirty[si] != 1)
+            continue;
+         for (int j=0; j<array_size(systems_stack[si].jumps); j++) {
+            int ti = systems_stack[si].jumps[j].targetid;
+            if ((ti >= 0) && (ti < nsys) && !dirty[ti])
+               dirty[ti] = 2;
+         }
+      }
+      for (int si=0; si<nsys; si++)
+         nclean += !dirty[si];
+
+      /* Nothing changed at all: keep the converged solution. */
+      if (nclean == nsys) {
+         free( dirty );
+         free( hash );
+         return;
+      }
+
+      /* Snapshot the lanes of the clean systems to replay below. */
+      oldlanes = calloc( nsys, sizeof(int*) );
+      oldlanes_n = calloc( nsys, sizeof(int) );
+      for (int si=0; si<nsys; si++) {
+         int n = sys_to_first_edge[1+si] - sys_to_first_edge[si];
+         if (dirty[si] || (n == 0))
+            continue;
+         oldlanes[si] = malloc( n * sizeof(int) );
+         oldlanes_n[si] = n;
+         memcpy( oldlanes[si], &lane_faction[ sys_to_first_edge[si] ],
+               n * sizeof(int) );
+      }
+   }
+   free( sys_hash_prev );
+   sys_hash_prev = hash;
+
    safelanes_initStacks();
    safelanes_initOptimizer();
+
+   /* Replay the previous solution in the clean systems and zero their
+    * budgets so the optimizer only works the affected region. */
+   if (oldlanes != NULL) {
+      for (int si=0; si<nsys; si++) {
+         int base = sys_to_first_edge[si];
+         int n = sys_to_first_edge[1+si] - base;
+         /* If the local edge count changed after all, play it safe and
+          * let the optimizer redo the system. */
+         if ((oldlanes[si] != NULL) && (oldlanes_n[si] == n)) {
+            for (int i=0; i<n; i++) {
+               int f = oldlanes[si][i];
+               if (f == 0)
+                  continue;
+               safelanes_updateConductivity( base+i );
+               vertex_fmask[ edge_stack[base+i][0] ] |= MASK_ONE_FACTION( f );
+               vertex_fmask[ edge_stack[base+i][1] ] |= MASK_ONE_FACTION( f );
+               lane_faction[ base+i ] = f;
+            }
+            for (int fi=0; fi<array_size(faction_stack); fi++)
+               presence_budget[fi][si] = 0.;
+         }
+         free( oldlanes[si] );
+      }
+      free( oldlanes );
+      free( oldlanes_n );
+   }
+   free( dirty );
+
    for (int iters_done=0; safelanes_buildOneTurn(iters_done) > 0; iters_done++)
       ;
    safelanes_destroyOptimizer();
@@ -686,13 +829,14 @@ static void safelanes_initPPl (void)
 static int safelanes_activateByGradient( cholmod_dense* Lambda_tilde, int iters_done )
 {
    int *facind_opts, *edgeind_opts, turns_next_time;
-   double *facind_vals, Linv;
+   double *facind_vals, *edgeind_scores;
    cholmod_dense **lal; /**< Per faction index, the Lambda_tilde[myDofs,:] @ PPl[fi] matrices. Calloced and lazily populated. */
    size_t *lal_bases, lal_base; /**< System si's U and Lambda rows start at sys_base; its lal rows start at lal_base. */
 
    lal = calloc( array_size(faction_stack), sizeof(cholmod_dense*) );
    lal_bases = calloc( array_size(faction_stack), sizeof(size_t) );
    edgeind_opts = array_create( int );
+   edgeind_scores = array_create( double );
    facind_opts = array_create_size( int, array_size(faction_stack) );
    facind_vals = array_create_size( double, array_size(faction_stack) );
    for (int fi=0; fi<array_size(faction_stack); fi++) {
@@ -752,30 +896,31 @@ static int safelanes_activateByGradient( cholmod_dense* Lambda_tilde, int iters_
          cost_cheapest_other = +HUGE_VAL;
          if (array_size(edgeind_opts) > 0) {
             /* There's an actual choice. Search for the best option. Lower is better. */
+            ScoreWork w;
+
+            if (lal[fi] == NULL) { /* Is it time to evaluate the lazily-calculated matrix? */
+               cholmod_dense *lamt = safelanes_sliceByPresence( Lambda_tilde, presence_budget[fi] );
+               lal[fi] = ncholmod_ddmult( lamt, 0, PPl[fi] );
+               cholmod_free_dense( &lamt, &C );
+            }
+
+            /* Candidate scores only read solver state, so they can be
+             * evaluated in parallel; the pick below is the only part that
+             * mutates anything, and its sequential reduction keeps the
+             * result bit-identical to the serial version. */
+            array_resize( &edgeind_scores, array_size(edgeind_opts) );
+            w.edgeind_opts = edgeind_opts;
+            w.scores       = edgeind_scores;
+            w.lal          = lal[fi];
+            w.sys_base     = sys_base;
+            w.lal_base     = lal_base;
+            vpool_for( safelanes_scoreChunk, 0, array_size(edgeind_opts),
+                  SCORE_CHUNK, &w );
+
             for (int eii=0; eii<array_size(edgeind_opts); eii++) {
                int ei = edgeind_opts[eii];
-               int sis = edge_stack[ei][0];
-               int sjs = edge_stack[ei][1];
-               double score = 0.;
-               double cost;
-
-               if (lal[fi] == NULL) { /* Is it time to evaluate the lazily-calculated matrix? */
-                  cholmod_dense *lamt = safelanes_sliceByPresence( Lambda_tilde, presence_budget[fi] );
-                  lal[fi] = ncholmod_ddmult( lamt, 0, PPl[fi] );
-                  cholmod_free_dense( &lamt, &C );
-               }
-
-               /* Evaluate (LUTll[0,0] + LUTll[1,1] - LUTll[0,1] - LUTll[1,0]), */
-               /* where    LUTll = np.dot( lal[[sis,sjs],:] , utilde[[sis,sjs],:].T ) */
-               score += safelanes_row_dot_row( utilde, lal[fi], sis, sis - sys_base + lal_base );
-               score += safelanes_row_dot_row( utilde, lal[fi], sjs, sjs - sys_base + lal_base );
-               score -= safelanes_row_dot_row( utilde, lal[fi], sjs, sis - sys_base + lal_base );
-               score -= safelanes_row_dot_row( utilde, lal[fi], sis, sjs - sys_base + lal_base );
-               Linv = safelanes_initialConductivity(ei);
-               score *= ALPHA * Linv * Linv;
-               score += LAMBDA;
-
-               cost = 1. / safelanes_initialConductivity(ei) / faction_stack[fi].lane_length_per_presence + faction_stack[fi].lane_base_cost;
+               double score = edgeind_scores[eii];
+               double cost = 1. / safelanes_initialConductivity(ei) / faction_stack[fi].lane_length_per_presence + faction_stack[fi].lane_base_cost;
                if (score < score_best) {
                   ei_best = ei;
                   score_best = score;
@@ -817,6 +962,7 @@ static int safelanes_activateByGradient( cholmod_dense* Lambda_tilde, int iters_
       cholmod_free_dense( &lal[fi], &C );
    free( lal );
    free( lal_bases );
+   array_free( edgeind_scores );
    array_free( edgeind_opts );
    array_free( facind_vals );
    array_free( facind_opts );
@@ -824,6 +970,34 @@ static int safelanes_activateByGradient( cholmod_dense* Lambda_tilde, int iters_
    return turns_next_time;
 }
 
+/**
+ * @brief Evaluates candidate lane scores for a subrange (vpool_for worker).
+ *
+ * Reads utilde and the already-built lal matrix only, so chunks are
+ * independent and the order they run in cannot change any score.
+ */
+static void safelanes_scoreChunk( int begin, int end, void *data )
+{
+   const ScoreWork *w = data;
+   for (int eii=begin; eii<end; eii++) {
+      int ei = w->edgeind_opts[eii];
+      int sis = edge_stack[ei][0];
+      int sjs = edge_stack[ei][1];
+      double Linv, score = 0.;
+
+      /* Evaluate (LUTll[0,0] + LUTll[1,1] - LUTll[0,1] - LUTll[1,0]), */
+      /* where    LUTll = np.dot( lal[[sis,sjs],:] , utilde[[sis,sjs],:].T ) */
+      score += safelanes_row_dot_row( utilde, w->lal, sis, sis - w->sys_base + w->lal_base );
+      score += safelanes_row_dot_row( utilde, w->lal, sjs, sjs - w->sys_base + w->lal_base );
+      score -= safelanes_row_dot_row( utilde, w->lal, sjs, sis - w->sys_base + w->lal_base );
+      score -= safelanes_row_dot_row( utilde, w->lal, sis, sjs - w->sys_base + w->lal_base );
+      Linv = safelanes_initialConductivity(ei);
+      score *= ALPHA * Linv * Linv;
+      score += LAMBDA;
+      w->scores[eii] = score;
+   }
+}
+
 /** @brief It's a qsort comparator. Set the cmp_key_ref pointer prior to use, or else. */
 static int cmp_key( const void* p1, const void* p2 )
 {
@@ -9,6 +9,7 @@
 /** @cond */
 #include <errno.h>
 #include "physfs.h"
+#include "SDL.h"
 
 #include "naev.h"
 /** @endcond */
@@ -34,10 +35,31 @@
 #include "plugin.h"
 #include "shiplog.h"
 #include "start.h"
+#include "threadpool.h"
 #include "unidiff.h"
 
 int save_loaded   = 0; /**< Just loaded the saved game. */
 
+/**
+ * @brief An autosave being serialized and written on a worker thread.
+ *
+ * The xmlDoc is the snapshot of the game state; once built the main loop
+ * can keep running while the worker dumps and writes it.
+ */
+typedef struct SaveAsync_ {
+   xmlDocPtr doc;        /**< Snapshotted save document. */
+   char file[PATH_MAX];  /**< Target file. */
+} SaveAsync;
+static SDL_sem *save_done = NULL; /**< Posted when the in-flight save hits disk. */
+static int save_pending   = 0;    /**< Whether an asynchronous save is in flight. */
+
+/* The most recent save document is kept in memory so reloading it (death
+ * and the like) can skip the disk read and XML parse; across process
+ * restarts loading falls back to the file as always. The snapshot owns
+ * the doc and any in-flight writer job only borrows it. */
+static xmlDocPtr save_snapshot = NULL;        /**< Cached copy of the last save document. */
+static char save_snapshot_file[PATH_MAX] = ""; /**< PhysicsFS path the snapshot was saved to. */
+
 /*
  * prototypes
  */
@@ -62,6 +84,11 @@ extern int economy_sysSave( xmlTextWriterPtr writer ); /**< Saves the economy st
 extern int diff_save( xmlTextWriterPtr writer ); /**< Saves the universe diffs. */
 /* static */
 static int save_data( xmlTextWriterPtr writer );
+static int save_all_internal( const char *name, int async );
+static int save_physfsWrite( void *ctx, const char *buf, int len );
+static int save_physfsClose( void *ctx );
+static int save_asyncJob( void *data );
+static void save_snapshotStore( const char *file, xmlDocPtr doc );
 
 /**
  * @brief Saves all the player's game data.
@@ -87,13 +114,113 @@ static int save_data( xmlTextWriterPtr writer )
 }
 
 /**
- * @brief Saves the current game.
+ * @brief PhysFS write callback for the streaming save writer.
+ */
+static int save_physfsWrite( void *ctx, const char *buf, int len )
+{
+   if (PHYSFS_writeBytes( (PHYSFS_File*)ctx, buf, len ) != len)
+      return -1;
+   return len;
+}
+
+/**
+ * @brief PhysFS close callback for the streaming save writer.
+ */
+static int save_physfsClose( void *ctx )
+{
+   return PHYSFS_close( (PHYSFS_File*)ctx ) ? 0 : -1;
+}
+
+/**
+ * @brief Threadpool job: dumps and writes a snapshotted save document.
+ */
+static int save_asyncJob( void *data )
+{
+   SaveAsync *save = data;
+   if (xmlSaveFileEnc( save->file, save->doc, "UTF-8" ) < 0)
+      WARN(_("Failed to write saved game!  You'll most likely have to restore it by copying your backup saved game over your current saved game."));
+   /* The doc is owned by the snapshot cache, not the job. */
+   free( save );
+   SDL_SemPost( save_done );
+   return 0;
+}
+
+/**
+ * @brief Caches a save document in memory, replacing any previous one.
+ *
+ * Must only be called with no asynchronous save in flight.
+ *
+ *    @param file PhysicsFS path the document was saved to.
+ *    @param doc Document to take ownership of.
+ */
+static void save_snapshotStore( const char *file, xmlDocPtr doc )
+{
+   if (save_snapshot != NULL)
+      xmlFreeDoc( save_snapshot );
+   save_snapshot = doc;
+   strncpy( save_snapshot_file, file, sizeof(save_snapshot_file)-1 );
+   save_snapshot_file[ sizeof(save_snapshot_file)-1 ] = '\0';
+}
+
+/**
+ * @brief Hands over the cached save document for a given file, if any.
+ *
+ * Ownership transfers to the caller, who must xmlFreeDoc it. Waits on
+ * any in-flight save first so the disk copy can no longer diverge.
+ *
+ *    @param file PhysicsFS path about to be loaded.
+ *    @return The cached document or NULL if the file is not cached.
+ */
+xmlDocPtr save_snapshotClaim( const char *file )
+{
+   xmlDocPtr doc;
+   save_sync();
+   if ((save_snapshot == NULL) || (strcmp(save_snapshot_file, file) != 0))
+      return NULL;
+   doc = save_snapshot;
+   save_snapshot = NULL;
+   save_snapshot_file[0] = '\0';
+   return doc;
+}
+
+/**
+ * @brief Frees the in-memory save snapshot, waiting on pending writes.
+ */
+void save_exit (void)
+{
+   save_sync();
+   if (save_snapshot != NULL) {
+      xmlFreeDoc( save_snapshot );
+      save_snapshot = NULL;
+   }
+   if (save_done != NULL) {
+      SDL_DestroySemaphore( save_done );
+      save_done = NULL;
+   }
+}
+
+/**
+ * @brief Waits for a pending asynchronous save to hit the disk.
+ *
+ * Must be called before reading the save directory or starting another
+ * save, and on game exit.
+ */
+void save_sync (void)
+{
+   if (!save_pending)
+      return;
+   SDL_SemWait( save_done ); /* Blocks until the worker posts. */
+   save_pending = 0;
+}
+
+/**
+ * @brief Saves the current game, serializing and writing off the main thread.
  *
  *    @return 0 on success.
  */
 int save_all (void)
 {
-   return save_all_with_name( "autosave" );
+   return save_all_internal( "autosave", 1 );
 }
 
 /**
@@ -104,17 +231,93 @@ int save_all (void)
  */
 int save_all_with_name ( char *name )
 {
-   char file[PATH_MAX], backup[PATH_MAX];
+   return save_all_internal( name, 0 );
+}
+
+/**
+ * @brief Saves the current game.
+ *
+ * Synchronous uncompressed saves stream straight to a buffered PhysFS
+ * file; compressed ones build the document in memory as before.
+ * Asynchronous saves snapshot the game state into an xmlDoc and hand it
+ * to a worker thread so the main loop never stalls on disk.
+ *
+ *    @param name Name of the save file (without extension).
+ *    @param async Whether to serialize and write on a worker thread.
+ *    @return 0 on success.
+ */
+static int save_all_internal( const char *name, int async )
+{
+   char file[PATH_MAX], backup[PATH_MAX], rel[PATH_MAX];
    const plugin_t *plugins = plugin_list();
-   xmlDocPtr doc;
+   xmlDocPtr doc = NULL;
    xmlTextWriterPtr writer;
+   int stream;
 
    /* Do not save if saving is off. */
    if (player_isFlag(PLAYER_NOSAVE))
       return 0;
 
+   /* Only one save can be in flight at a time. */
+   save_sync();
+
+   /* Create the directories ahead of time so the writer can stream
+    * directly into the target file. */
+   if (PHYSFS_mkdir("saves") == 0) {
+      snprintf(file, sizeof(file), "%s/saves", PHYSFS_getWriteDir());
+      WARN(_( "Dir '%s' does not exist and unable to create: %s" ), file,
+         _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+   snprintf(file, sizeof(file), "saves/%s", player.name);
+   if (PHYSFS_mkdir(file) == 0) {
+      snprintf(file, sizeof(file), "%s/saves/%s", PHYSFS_getWriteDir(), player.name);
+      WARN(_( "Dir '%s' does not exist and unable to create: %s" ), file,
+         _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+
+   /* Back up old saved game. */
+   if (!strcmp(name, "autosave")) {
+      if (!save_loaded) {
+         snprintf(file, sizeof(file), "saves/%s/autosave.ns", player.name);
+         snprintf(backup, sizeof(backup), "saves/%s/backup.ns", player.name);
+         if (ndata_copyIfExists(file, backup) < 0) {
+            WARN(_("Aborting save..."));
+            return -1;
+         }
+      }
+      save_loaded = 0;
+   }
+
+   /* Invalidate the sidecar index of the save being rewritten; the next
+    * load-menu refresh re-parses and re-indexes just this file. */
+   snprintf(file, sizeof(file), "saves/%s/%s.ns.idx", player.name, name);
+   PHYSFS_delete( file ); /* Best effort; may not exist. */
+
    /* Create the writer. */
-   writer = xmlNewTextWriterDoc(&doc, conf.save_compress);
+   stream = !async && !conf.save_compress;
+   if (stream) {
+      xmlOutputBufferPtr buf;
+      PHYSFS_File *pf;
+      snprintf(file, sizeof(file), "saves/%s/%s.ns", player.name, name);
+      pf = PHYSFS_openWrite( file );
+      if (pf == NULL) {
+         WARN(_( "Unable to open '%s' for writing: %s" ), file,
+            _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+         return -1;
+      }
+      buf = xmlOutputBufferCreateIO( save_physfsWrite, save_physfsClose, pf, NULL );
+      writer = xmlNewTextWriter( buf ); /* The writer owns the buffer. */
+   }
+   else {
+      writer = xmlNewTextWriterDoc(&doc, conf.save_compress);
+      /* Set the mode on the doc itself as well; xmlSaveFileEnc() reads it
+       * from there and not every libxml version forwards the writer
+       * argument, which silently produced uncompressed saves. */
+      if (doc != NULL)
+         xmlSetDocCompressMode( doc, conf.save_compress );
+   }
    if (writer == NULL) {
       ERR(_("testXmlwriterDoc: Error creating the xml writer"));
       return -1;
@@ -152,50 +355,50 @@ int save_all_with_name ( char *name )
    xmlw_endElem(writer); /* "naev_save" */
    xmlw_done(writer);
 
-   /* Write to file. */
-   if (PHYSFS_mkdir("saves") == 0) {
-      snprintf(file, sizeof(file), "%s/saves", PHYSFS_getWriteDir());
-      WARN(_( "Dir '%s' does not exist and unable to create: %s" ), file,
-         _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
-      goto err_writer;
-   }
-   snprintf(file, sizeof(file), "saves/%s", player.name);
-   if (PHYSFS_mkdir(file) == 0) {
-      snprintf(file, sizeof(file), "%s/saves/%s", PHYSFS_getWriteDir(), player.name);
-      WARN(_( "Dir '%s' does not exist and unable to create: %s" ), file,
-         _(PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
-      goto err_writer;
-   }
-
-   /* Back up old saved game. */
-   if (!strcmp(name, "autosave")) {
-      if (!save_loaded) {
-         snprintf(file, sizeof(file), "saves/%s/autosave.ns", player.name);
-         snprintf(backup, sizeof(backup), "saves/%s/backup.ns", player.name);
-         if (ndata_copyIfExists(file, backup) < 0) {
-            WARN(_("Aborting save..."));
-            goto err_writer;
-         }
-      }
-      save_loaded = 0;
+   /* Streaming writers have flushed everything to disk already; freeing
+    * the writer closes the PhysFS file. */
+   if (stream) {
+      xmlFreeTextWriter(writer);
+      /* Streamed saves bypass the snapshot cache; drop any stale copy. */
+      if (strcmp( save_snapshot_file, file ) == 0)
+         save_exit();
+      return 0;
    }
 
    /* Critical section, if crashes here player's game gets corrupted.
     * Luckily we have a copy just in case... */
    xmlFreeTextWriter(writer);
-   snprintf(file, sizeof(file), "%s/saves/%s/%s.ns", PHYSFS_getWriteDir(), player.name, name); /* TODO: write via physfs */
+   snprintf(file, sizeof(file), "%s/saves/%s/%s.ns", PHYSFS_getWriteDir(), player.name, name);
+   snprintf(rel, sizeof(rel), "saves/%s/%s.ns", player.name, name);
+
+   /* Hand the snapshot off to a worker thread. The snapshot cache takes
+    * ownership of the doc so reloading this save can skip the XML parse. */
+   if (async) {
+      SaveAsync *save = malloc( sizeof(SaveAsync) );
+      save->doc = doc;
+      strncpy( save->file, file, sizeof(save->file)-1 );
+      save->file[ sizeof(save->file)-1 ] = '\0';
+      save_snapshotStore( rel, doc );
+      if (save_done == NULL)
+         save_done = SDL_CreateSemaphore( 0 );
+      save_pending = 1;
+      threadpool_newJob( save_asyncJob, save );
+      return 0;
+   }
+
    if (xmlSaveFileEnc(file, doc, "UTF-8") < 0) {
       WARN(_("Failed to write saved game!  You'll most likely have to restore it by copying your backup saved game over your current saved game."));
       goto err;
    }
-   xmlFreeDoc(doc);
+   save_snapshotStore( rel, doc );
 
    return 0;
 
 err_writer:
    xmlFreeTextWriter(writer);
 err:
-   xmlFreeDoc(doc);
+   if (doc != NULL)
+      xmlFreeDoc(doc);
    return -1;
 }
 
@@ -3,6 +3,11 @@
  */
 #pragma once
 
+#include "nxml.h"
+
 int save_all (void);
 int save_all_with_name ( char *name );
+void save_sync (void);
 void save_reload (void);
+xmlDocPtr save_snapshotClaim( const char *file );
+void save_exit (void);
@@ -40,14 +40,22 @@ class Shader:
 
 num_simpleshaders = 0
 class SimpleShader(Shader):
-    def __init__(self, name, fs_path):
+    # defines pre-generates a specialized variant of the fragment shader:
+    # the listed macros are defined at compile time so the shader can use
+    # #ifdef instead of branching on a uniform at runtime.
+    def __init__(self, name, fs_path, defines=None):
         super().__init__( name=name, vs_path="project_pos.vert", fs_path=fs_path, attributes=["vertex"], uniforms=["projection","color","dimensions","dt","paramf","parami","paramv"], subroutines={} )
+        self.defines = defines
         global num_simpleshaders
         num_simpleshaders += 1
     def header_chunks(self):
         yield f"   SimpleShader {self.name};\n"
     def source_chunks(self):
-        yield f"   shaders_loadSimple( \"{self.name}\", &shaders.{self.name}, \"{self.fs_path}\" );"
+        if self.defines:
+            defstr = "".join( f"#define {d} 1\\n" for d in self.defines )
+            yield f"   shaders_loadSimple( \"{self.name}\", &shaders.{self.name}, \"{self.fs_path}\", \"{defstr}\" );"
+        else:
+            yield f"   shaders_loadSimple( \"{self.name}\", &shaders.{self.name}, \"{self.fs_path}\", NULL );"
 
 SHADERS = [
    Shader(
@@ -60,10 +68,10 @@ SHADERS = [
    ),
    Shader(
       name = "trail",
-      vs_path = "project_pos.vert",
+      vs_path = "trail.vert",
       fs_path = "trail.frag",
-      attributes = ["vertex"],
-      uniforms = ["projection", "c1", "c2", "t1", "t2", "dt", "pos1", "pos2", "r", "nebu_col" ],
+      attributes = ["vertex", "vertex_color", "vertex_data"],
+      uniforms = ["projection", "dt", "ttl", "r", "zoom", "nebu_col" ],
       subroutines = {
         "trail_func" : [
             "trail_default",
@@ -92,6 +100,14 @@ SHADERS = [
       uniforms = ["projection", "color", "tex_mat", "sampler"],
       subroutines = {},
    ),
+   Shader(
+      name = "spritebatch",
+      vs_path = "spritebatch.vert",
+      fs_path = "spritebatch.frag",
+      attributes = ["vertex", "tex_uv", "vertex_color"],
+      uniforms = ["projection", "sampler"],
+      subroutines = {},
+   ),
    Shader(
       name = "texture_interpolate",
       vs_path = "texture.vert",
@@ -238,6 +254,14 @@ SHADERS = [
       uniforms = ["ClipSpaceFromLocal", "MainTex", "gamma"],
       subroutines = {},
    ),
+   Shader(
+      name = "sharpen",
+      vs_path = "postprocess.vert",
+      fs_path = "sharpen.frag",
+      attributes = ["VertexPosition"],
+      uniforms = ["ClipSpaceFromLocal", "MainTex", "love_ScreenSize"],
+      subroutines = {},
+   ),
    SimpleShader(
       name = "status",
       fs_path = "status.frag",
@@ -290,6 +314,11 @@ SHADERS = [
       name = "sysmarker",
       fs_path = "sysmarker.frag",
    ),
+   SimpleShader(
+      name = "sysmarker_slashed",
+      fs_path = "sysmarker.frag",
+      defines = ["SYSMARKER_SLASHED"],
+   ),
    SimpleShader(
       name = "notemarker",
       fs_path = "notemarker.frag",
@@ -314,6 +343,11 @@ SHADERS = [
       name = "jumplanegoto",
       fs_path = "jumplanegoto.frag",
    ),
+   SimpleShader(
+      name = "jumplanegoto_active",
+      fs_path = "jumplanegoto.frag",
+      defines = ["JUMPLANE_ACTIVE"],
+   ),
    SimpleShader(
       name = "safelane",
       fs_path = "safelane.frag",
@@ -338,10 +372,23 @@ SHADERS = [
       name = "sdfsolid",
       fs_path = "sdfsolid.frag",
    ),
+   Shader(
+      name = "window",
+      vs_path = "project_pos.vert",
+      fs_path = "window.frag",
+      attributes = ["vertex"],
+      uniforms = ["projection", "color", "dimensions", "colour_dark", "colour_light"],
+      subroutines = {},
+   ),
    SimpleShader(
       name = "circle",
       fs_path = "circle.frag",
    ),
+   SimpleShader(
+      name = "circle_filled",
+      fs_path = "circle.frag",
+      defines = ["CIRCLE_FILLED"],
+   ),
    SimpleShader(
       name = "crosshairs",
       fs_path = "crosshairs.frag",
@@ -425,10 +472,10 @@ static int shaders_cmp( const void *p1, const void *p2 )
    return strcmp( (*s1)->name, (*s2)->name );
 }
 
-static int shaders_loadSimple( const char *name, SimpleShader *shd, const char *fs_path )
+static int shaders_loadSimple( const char *name, SimpleShader *shd, const char *fs_path, const char *defines )
 {
    shd->name   = name;
-   shd->program = gl_program_vert_frag( "project_pos.vert", fs_path );
+   shd->program = gl_program_vert_frag_defines( "project_pos.vert", fs_path, defines );
    shd->vertex = glGetAttribLocation( shd->program, "vertex" );
    shd->projection = glGetUniformLocation( shd->program, "projection" );
    shd->color  = glGetUniformLocation( shd->program, "color" );
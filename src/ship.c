@@ -8,6 +8,7 @@
  */
 /** @cond */
 #include <limits.h>
+#include <stdint.h>
 #include "physfsrwops.h"
 #include "SDL_image.h"
 
@@ -50,6 +51,7 @@ static Ship* ship_stack = NULL; /**< Stack of ships available in the game. */
  */
 static int ship_loadGFX( Ship *temp, const char *buf, int sx, int sy, int engine );
 static int ship_loadPLG( Ship *temp, const char *buf, int size_hint );
+static int ship_genPLGFallback( Ship *temp, SDL_Surface *surface, int sx, int sy );
 static int ship_parse( Ship *temp, const char *filename );
 static void ship_freeSlot( ShipOutfitSlot* s );
 
@@ -391,6 +393,130 @@ static int ship_genTargetGFX( Ship *temp, SDL_Surface *surface, int sx, int sy )
    return 0;
 }
 
+/**
+ * @brief Generates collision polygons from the sprite sheet's alpha channel.
+ *
+ * Fallback for ships (typically from plugins) that ship without
+ * pregenerated polygon XML: each sprite's opaque silhouette becomes a
+ * convex hull via GenPolygonFromAlpha. The results are cached in the
+ * cache directory keyed by a hash of the alpha channel, so only the
+ * first run with a given sprite sheet pays the generation cost.
+ *
+ *    @param temp Ship to load the polygons into.
+ *    @param surface Sprite sheet surface.
+ *    @param sx Number of X sprites in the sheet.
+ *    @param sy Number of Y sprites in the sheet.
+ *    @return 0 on success.
+ */
+static int ship_genPLGFallback( Ship *temp, SDL_Surface *surface, int sx, int sy )
+{
+   SDL_Surface *rgba;
+   unsigned char *alpha, *salpha;
+   const unsigned char *pix;
+   char cachefile[PATH_MAX], dirpath[PATH_MAX];
+   char *cache;
+   unsigned int hash;
+   size_t filesize;
+   int w, h, sw, sh, cached;
+
+   /* Extract the alpha channel. */
+   rgba = SDL_ConvertSurfaceFormat( surface, SDL_PIXELFORMAT_RGBA32, 0 );
+   if (rgba == NULL) {
+      WARN(_("Unable to convert ship '%s' surface: %s"), temp->name, SDL_GetError());
+      return -1;
+   }
+   w = rgba->w;
+   h = rgba->h;
+   sw = w / sx;
+   sh = h / sy;
+   alpha = malloc( (size_t)w*h );
+   SDL_LockSurface( rgba );
+   pix = rgba->pixels;
+   for (int v=0; v<h; v++)
+      for (int u=0; u<w; u++)
+         alpha[ v*w+u ] = pix[ v*rgba->pitch + 4*u + 3 ];
+   SDL_UnlockSurface( rgba );
+   SDL_FreeSurface( rgba );
+
+   /* Key the cache on the alpha content so sprite sheet updates miss. */
+   hash = 5381;
+   for (int i=0; i<w*h; i++)
+      hash = hash*33 + alpha[i];
+   snprintf( cachefile, sizeof(cachefile), "%spolygons/%08x-%dx%d",
+         nfile_cachePath(), hash, sx, sy );
+
+   temp->polygon = array_create_size( CollPoly, sx*sy );
+
+   /* Attempt to load cached polygons. */
+   if (nfile_fileExists( cachefile )) {
+      cache = nfile_readFile( &filesize, cachefile );
+      if (cache != NULL) {
+         size_t off = 0;
+         cached = 1;
+         for (int k=0; k<sx*sy; k++) {
+            uint32_t npt;
+            const float *px, *py;
+            if (off + sizeof(uint32_t) > filesize) {
+               cached = 0;
+               break;
+            }
+            memcpy( &npt, &cache[off], sizeof(uint32_t) );
+            off += sizeof(uint32_t);
+            if ((npt < 1) || (npt > (uint32_t)2*sh) ||
+                  (off + 2*npt*sizeof(float) > filesize)) {
+               cached = 0;
+               break;
+            }
+            px = (const float*)&cache[off];
+            py = (const float*)&cache[off + npt*sizeof(float)];
+            off += 2*npt*sizeof(float);
+            GenPolygonFromPoints( &array_grow( &temp->polygon ), px, py, npt );
+         }
+         free( cache );
+         if (cached) {
+            free( alpha );
+            return 0;
+         }
+         /* Invalid cache; throw away and regenerate. */
+         for (int k=0; k<array_size(temp->polygon); k++)
+            FreePolygon( &temp->polygon[k] );
+         array_resize( &temp->polygon, 0 );
+      }
+   }
+
+   /* Generate; polygon k must match sprite (k%sx, k/sx). */
+   salpha = malloc( (size_t)sw*sh );
+   for (int yy=0; yy<sy; yy++) {
+      for (int xx=0; xx<sx; xx++) {
+         for (int v=0; v<sh; v++)
+            memcpy( &salpha[ v*sw ], &alpha[ (yy*sh+v)*w + xx*sw ], sw );
+         GenPolygonFromAlpha( &array_grow( &temp->polygon ), salpha, sw, sh );
+      }
+   }
+   free( salpha );
+   free( alpha );
+
+   /* Cache the generated polygons. */
+   cache = array_create( char );
+   for (int k=0; k<array_size(temp->polygon); k++) {
+      const CollPoly *p = &temp->polygon[k];
+      uint32_t npt = p->npt;
+      int n = array_size( cache );
+      char *c;
+      array_resize( &cache, n + sizeof(uint32_t) + 2*npt*sizeof(float) );
+      c = &cache[n];
+      memcpy( c, &npt, sizeof(uint32_t) );
+      memcpy( &c[ sizeof(uint32_t) ], p->x, npt*sizeof(float) );
+      memcpy( &c[ sizeof(uint32_t) + npt*sizeof(float) ], p->y, npt*sizeof(float) );
+   }
+   snprintf( dirpath, sizeof(dirpath), "%spolygons/", nfile_cachePath() );
+   nfile_dirMakeExist( dirpath );
+   nfile_writeFile( cache, array_size(cache), cachefile );
+   array_free( cache );
+
+   return 0;
+}
+
 /**
  * @brief Loads the space graphics for a ship from an image.
  *
@@ -427,6 +553,11 @@ static int ship_loadSpaceImage( Ship *temp, char *str, int sx, int sy )
             OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_VFLIP,
             surface->w, surface->h, sx, sy, 0 );
 
+   /* Ships without pregenerated polygon data get convex polygons built
+    * from the sprite alpha channel. */
+   if (temp->polygon == NULL)
+      ship_genPLGFallback( temp, surface, sx, sy );
+
    /* Create the target graphic. */
    ret = ship_genTargetGFX( temp, surface, sx, sy );
    if (ret != 0)
@@ -475,14 +606,14 @@ static int ship_loadGFX( Ship *temp, const char *buf, int sx, int sy, int engine
 
    /* Load the 3d model */
    snprintf(str, sizeof(str), SHIP_3DGFX_PATH"%s/%s/%s.obj", base, buf, buf);
-   if (PHYSFS_exists(str)) {
+   if (ndata_exists(str)) {
       temp->gfx_3d = object_loadFromFile(str);
    }
 
    /* Load the space sprite. */
    ext = ".webp";
    snprintf( str, sizeof(str), SHIP_GFX_PATH"%s/%s%s", base, buf, ext );
-   if (!PHYSFS_exists(str)) {
+   if (!ndata_exists(str)) {
       ext = ".png";
       snprintf( str, sizeof(str), SHIP_GFX_PATH"%s/%s%s", base, buf, ext );
    }
@@ -520,7 +651,7 @@ static int ship_loadPLG( Ship *temp, const char *buf, int size_hint )
    snprintf( file, sizeof(file), "%s%s.xml", SHIP_POLYGON_PATH, buf );
 
    /* See if the file does exist. */
-   if (!PHYSFS_exists(file)) {
+   if (!ndata_exists(file)) {
       WARN(_("%s xml collision polygon does not exist!\n \
                Please use the script 'polygon_from_sprite.py' if sprites are used,\n \
                And 'polygonSTL.py' if 3D model is used in game.\n \
@@ -529,7 +660,7 @@ static int ship_loadPLG( Ship *temp, const char *buf, int size_hint )
    }
 
    /* Load the XML. */
-   doc  = xml_parsePhysFS( file );
+   doc  = xml_parsePhysFSCached( file );
    if (doc == NULL)
       return 0;
 
@@ -660,7 +791,7 @@ static int ship_parse( Ship *temp, const char *filename )
    ShipTrailEmitter trail;
 
    /* Load the XML. */
-   doc  = xml_parsePhysFS( filename );
+   doc  = xml_parsePhysFSCached( filename );
    if (doc == NULL)
       return -1;
 
@@ -885,13 +1016,29 @@ static int ship_parse( Ship *temp, const char *filename )
          continue;
       }
       if (xml_isNode(node,"slots")) {
+         int nstructure, nutility, nweapon;
+         xmlNodePtr cur;
+
+         /* Count the slots first so each array allocates exactly once. */
+         nstructure = nutility = nweapon = 0;
+         cur = node->children;
+         do {
+            xml_onlyNodes(cur);
+            if (xml_isNode(cur,"structure"))
+               nstructure++;
+            else if (xml_isNode(cur,"utility"))
+               nutility++;
+            else if (xml_isNode(cur,"weapon"))
+               nweapon++;
+         } while (xml_nextNode(cur));
+
          /* Allocate the space. */
-         temp->outfit_structure  = array_create( ShipOutfitSlot );
-         temp->outfit_utility    = array_create( ShipOutfitSlot );
-         temp->outfit_weapon     = array_create( ShipOutfitSlot );
+         temp->outfit_structure  = array_create_size( ShipOutfitSlot, nstructure );
+         temp->outfit_utility    = array_create_size( ShipOutfitSlot, nutility );
+         temp->outfit_weapon     = array_create_size( ShipOutfitSlot, nweapon );
 
          /* Initialize the mounts. */
-         xmlNodePtr cur = node->children;
+         cur = node->children;
          do {
             xml_onlyNodes(cur);
             if (xml_isNode(cur,"structure"))
@@ -950,7 +1097,7 @@ static int ship_parse( Ship *temp, const char *filename )
             if (xml_isNode(cur, "tag")) {
                char *tmp = xml_get(cur);
                if (tmp != NULL)
-                  array_push_back( &temp->tags, strdup(tmp) );
+                  array_push_back( &temp->tags, (char*)strintern(tmp) );
                continue;
             }
             WARN(_("Ship '%s' has unknown node in tags '%s'."), temp->name, cur->name );
@@ -1103,18 +1250,13 @@ void ships_free (void)
       array_free(s->gfx_overlays);
 
       /* Free collision polygons. */
-      for (int j=0; j<array_size(s->polygon); j++) {
-         free(s->polygon[j].x);
-         free(s->polygon[j].y);
-      }
+      for (int j=0; j<array_size(s->polygon); j++)
+         FreePolygon( &s->polygon[j] );
 
       array_free(s->trail_emitters);
       array_free(s->polygon);
 
-      /* Free tags. */
-      for (int j=0; j<array_size(s->tags); j++)
-         free(s->tags[j]);
-      array_free(s->tags);
+      array_free(s->tags); /* Tags are interned. */
    }
 
    array_free(ship_stack);
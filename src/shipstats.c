@@ -7,6 +7,8 @@
  * @brief Handles the ship statistics.
  */
 /** @cond */
+#include <stdlib.h>
+
 #include "naev.h"
 /** @endcond */
 
@@ -187,9 +189,20 @@ static const ShipStatsLookup ss_lookup[] = {
    N__ELEM( SS_TYPE_SENTINEL )
 };
 
+/**
+ * @brief Entry of the sorted name index used by ss_typeFromName().
+ */
+typedef struct ShipStatsNameIdx_ {
+   const char *name;    /**< Stat name, from ss_lookup. */
+   ShipStatsType type;  /**< Matching type. */
+} ShipStatsNameIdx;
+static ShipStatsNameIdx ss_nameIdx[ SS_TYPE_SENTINEL ]; /**< Sorted name index. */
+static int ss_nameIdx_n = 0; /**< Named stats in the index, 0 until ss_check(). */
+
 /*
  * Prototypes.
  */
+static int ss_nameIdxCmp( const void *a, const void *b );
 static const char* ss_printD_colour( double d, const ShipStatsLookup *sl );
 static const char* ss_printI_colour( int i, const ShipStatsLookup *sl );
 static int ss_printD( char *buf, int len, int newline, double d, const ShipStatsLookup *sl );
@@ -321,6 +334,16 @@ int ss_sort( ShipStatList **ll )
 }
 
 
+/**
+ * @brief qsort/bsearch comparison for the name index.
+ */
+static int ss_nameIdxCmp( const void *a, const void *b )
+{
+   const ShipStatsNameIdx *na = a;
+   const ShipStatsNameIdx *nb = b;
+   return strcmp( na->name, nb->name );
+}
+
 /**
  * @brief Checks for validity.
  */
@@ -334,6 +357,17 @@ int ss_check (void)
       }
    }
 
+   /* Build the sorted name index so name resolution can binary search. */
+   ss_nameIdx_n = 0;
+   for (int i=0; i<SS_TYPE_SENTINEL; i++) {
+      if (ss_lookup[i].name == NULL)
+         continue;
+      ss_nameIdx[ ss_nameIdx_n ].name = ss_lookup[i].name;
+      ss_nameIdx[ ss_nameIdx_n ].type = ss_lookup[i].type;
+      ss_nameIdx_n++;
+   }
+   qsort( ss_nameIdx, ss_nameIdx_n, sizeof(ShipStatsNameIdx), ss_nameIdxCmp );
+
    return 0;
 }
 
@@ -591,9 +625,22 @@ size_t ss_offsetFromType( ShipStatsType type )
  */
 ShipStatsType ss_typeFromName( const char *name )
 {
-   for (int i=0; i<SS_TYPE_SENTINEL; i++)
-      if ((ss_lookup[i].name != NULL) && (strcmp(name,ss_lookup[i].name)==0))
-         return ss_lookup[i].type;
+   const ShipStatsNameIdx *found;
+   ShipStatsNameIdx q;
+
+   /* Linear fallback in case something resolves before ss_check(). */
+   if (ss_nameIdx_n == 0) {
+      for (int i=0; i<SS_TYPE_SENTINEL; i++)
+         if ((ss_lookup[i].name != NULL) && (strcmp(name,ss_lookup[i].name)==0))
+            return ss_lookup[i].type;
+      WARN(_("ss_typeFromName: No ship stat matching '%s'"), name);
+      return SS_TYPE_NIL;
+   }
+
+   q.name = name;
+   found  = bsearch( &q, ss_nameIdx, ss_nameIdx_n, sizeof(ShipStatsNameIdx), ss_nameIdxCmp );
+   if (found != NULL)
+      return found->type;
 
    WARN(_("ss_typeFromName: No ship stat matching '%s'"), name);
    return SS_TYPE_NIL;
@@ -58,6 +58,14 @@
 #include "nlua_spfx.h"
 
 #define SOUND_FADEOUT         100
+
+/* Positional voices are serviced in two zones around the listener: near
+ * ones every frame, far ones every SOUND_ZONE_PERIOD frames (staggered
+ * by voice id). Far voices sit on the flat part of the OpenAL distance
+ * curve, so deferring their position and state pushes is inaudible. */
+#define SOUND_ZONE_NEAR       4e3 /**< Distance below which voices are serviced every frame. */
+#define SOUND_DISTANT_MAX     4   /**< Distant voices admitted per frame when zoomed out. */
+#define SOUND_ZONE_PERIOD     6   /**< Frames between services of far-zone voices. */
 #define SOUND_VOICES          128   /**< Maximum number of simultaneous sounds to play, must be at least 16. */
 #define SOUND_BUFFER_SIZE     128   /**< Size of the buffer (in KiB) to use for music. */
 
@@ -110,6 +118,8 @@ typedef struct alVoice_ {
 
    ALfloat pos[3]; /**< Position of the voice. */
    ALfloat vel[3]; /**< Velocity of the voice. */
+   int updated; /**< Whether position/velocity changed since last upload. */
+   int relative; /**< Whether the voice plays listener-relative (UI sounds). */
    ALuint source; /**< Source current in use. */
    ALuint buffer; /**< Buffer attached to the voice. */
 } alVoice;
@@ -814,6 +824,8 @@ int sound_play( int sound )
    return v->id;
 }
 
+static int sound_ndistant = 0; /**< Distant voices admitted since the last sound_update. */
+
 /**
  * @brief Plays a sound based on position.
  *
@@ -829,7 +841,7 @@ int sound_playPos( int sound, double px, double py, double vx, double vy )
    alVoice *v;
    alSound *s;
    Pilot *p;
-   double cx, cy, dist;
+   double cx, cy, dist, z;
    int target;
 
    if (sound_disabled)
@@ -839,6 +851,8 @@ int sound_playPos( int sound, double px, double py, double vx, double vy )
       return -1;
 
    target = cam_getTarget();
+   cam_getPos(&cx, &cy);
+   dist = pow2(px - cx) + pow2(py - cy);
 
    /* Following a pilot. */
    p = pilot_get(target);
@@ -848,12 +862,22 @@ int sound_playPos( int sound, double px, double py, double vx, double vy )
    }
    /* Set to a position. */
    else {
-      cam_getPos(&cx, &cy);
-      dist = pow2(px - cx) + pow2(py - cy);
       if (dist > pilot_sensorRange())
          return 0;
    }
 
+   /* Zoomed out, distant point sources are individually inaudible on the
+    * flat part of the OpenAL distance curve; admit only a few per frame
+    * as representatives so a zoomed-out fleet battle mixes a handful of
+    * voices instead of saturating the source pool. The near zone shrinks
+    * with the zoom so zooming back in restores every source. */
+   z = cam_getZoom();
+   if ((z < 1.) && (dist > pow2( SOUND_ZONE_NEAR * z ))) {
+      if (sound_ndistant >= SOUND_DISTANT_MAX)
+         return 0;
+      sound_ndistant++;
+   }
+
    /* Gets a new voice. */
    v = voice_new();
 
@@ -897,6 +921,7 @@ int sound_updatePos( int voice, double px, double py, double vx, double vy )
    v->pos[1] = py;
    v->vel[0] = vx;
    v->vel[1] = vy;
+   v->updated = 1;
    return 0;
 }
 
@@ -915,6 +940,9 @@ int sound_update( double dt )
    if (sound_disabled)
       return 0;
 
+   /* New frame, new budget of distant representative voices. */
+   sound_ndistant = 0;
+
    /* System update. */
    for (int i=0; i<al_ngroups; i++) {
       unsigned int f;
@@ -962,11 +990,24 @@ int sound_update( double dt )
    if (voice_active == NULL)
       return 0;
 
+   /* Zone servicing; see SOUND_ZONE_NEAR. */
+   static unsigned int voice_frame = 0;
+   double cx, cy;
+   cam_getPos( &cx, &cy );
+   voice_frame++;
+
    voiceLock();
 
    /* The actual control loop. */
    for (alVoice *v=voice_active; v!=NULL; v=v->next) {
 
+      /* Far-zone voices only get their OpenAL state pushed and polled
+       * every few frames; they just recycle their source a bit later. */
+      if (!v->relative &&
+            (pow2(v->pos[0]-cx) + pow2(v->pos[1]-cy) > pow2(SOUND_ZONE_NEAR)) &&
+            (((unsigned int)v->id + voice_frame) % SOUND_ZONE_PERIOD != 0))
+         continue;
+
       /* Run first to clear in same iteration. */
       al_updateVoice( v );
 
@@ -2096,12 +2137,44 @@ static int al_playVoice( alVoice *v, alSound *s,
    ALuint source;
 
    /* Make sure there's enough. */
-   if (source_nstack <= 0)
-      return 0;
-
-   /* Pull one off the stack. */
-   source_nstack--;
-   source = source_stack[source_nstack];
+   if (source_nstack <= 0) {
+      /* All real sources are busy; steal one from the farthest active
+       * voice if it is more distant than the new sound, so nearby
+       * effects take priority when big battles exhaust the pool. */
+      alVoice *far = NULL;
+      double cx, cy, fdist;
+      cam_getPos( &cx, &cy );
+      fdist = (relative==AL_TRUE) ? 0. : pow2(px-cx) + pow2(py-cy);
+      voiceLock();
+      for (alVoice *t=voice_active; t!=NULL; t=t->next) {
+         double d;
+         if (t->source == 0)
+            continue;
+         d = pow2(t->pos[0]-cx) + pow2(t->pos[1]-cy);
+         if (d > fdist) {
+            far   = t;
+            fdist = d;
+         }
+      }
+      if (far == NULL) {
+         voiceUnlock();
+         return 0;
+      }
+      soundLock();
+      alSourceStop( far->source );
+      alSourcei( far->source, AL_BUFFER, AL_NONE );
+      al_checkErr();
+      soundUnlock();
+      source      = far->source;
+      far->source = 0;
+      far->state  = VOICE_STOPPED;
+      voiceUnlock();
+   }
+   else {
+      /* Pull one off the stack. */
+      source_nstack--;
+      source = source_stack[source_nstack];
+   }
 
    /* Set up the source and buffer. */
    v->source = source;
@@ -2130,6 +2203,8 @@ static int al_playVoice( alVoice *v, alSound *s,
    v->vel[0] = vx;
    v->vel[1] = vy;
    v->vel[2] = 0.;
+   v->updated = 0;
+   v->relative = (relative == AL_TRUE);
 
    /* Set up properties. */
    alSourcef(  v->source, AL_GAIN, svolume*svolume_speed );
@@ -2202,10 +2277,14 @@ void al_updateVoice( alVoice *v )
       return;
    }
 
-   /* Set up properties. */
-   alSourcef(  v->source, AL_GAIN, svolume*svolume_speed );
-   alSourcefv( v->source, AL_POSITION, v->pos );
-   alSourcefv( v->source, AL_VELOCITY, v->vel );
+   /* Only push position and velocity when they changed since the last
+    * upload; gain is handled by al_volumeUpdate on volume or game speed
+    * changes, so stationary voices cost a single state query here. */
+   if (v->updated) {
+      alSourcefv( v->source, AL_POSITION, v->pos );
+      alSourcefv( v->source, AL_VELOCITY, v->vel );
+      v->updated = 0;
+   }
 
    /* Check for errors. */
    al_checkErr();
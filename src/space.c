@@ -18,6 +18,7 @@
 #include "space.h"
 
 #include "background.h"
+#include "camera.h"
 #include "conf.h"
 #include "damagetype.h"
 #include "dev_uniedit.h"
@@ -57,6 +58,7 @@
 #include "start.h"
 #include "toolkit.h"
 #include "weapon.h"
+#include "worldsim.h"
 
 #define XML_SPOB_TAG   "spob" /**< Individual spob xml tag. */
 #define XML_SYSTEM_TAG  "ssys" /**< Individual systems xml tag. */
@@ -90,6 +92,16 @@ static char** systemname_stack = NULL; /**< System name stack corresponding to s
  * Arrays.
  */
 StarSystem *systems_stack = NULL; /**< Star system stack. */
+
+/*
+ * Presence propagation bookkeeping. The generation counter bumps whenever
+ * any propagated presence changes so consumers (safelanes, spawn, ...) can
+ * cache derived data against it; the mask restricts a rebuild to the
+ * systems actually in range of a changed asset.
+ */
+static unsigned int presence_gen = 1; /**< Presence generation counter. */
+static int presence_mask = 0; /**< When set, presence writes only touch dirty systems. */
+static int presence_max_range = 0; /**< Largest spill range seen on any asset. */
 static Spob *spob_stack = NULL; /**< Spob stack. */
 static VirtualSpob *vspob_stack = NULL; /**< Virtual spob stack. */
 #ifdef DEBUGGING
@@ -97,6 +109,7 @@ static int systemstack_changed = 0; /**< Whether or not the systems_stack was ch
 static int spobstack_changed = 0; /**< Whether or not the spob_stack was changed after loading. */
 #endif /* DEBUGGING */
 static MapShader **mapshaders = NULL; /**< Map shaders. */
+static StarSystem *space_prefetched = NULL; /**< System whose assets were prefetched for autonav. */
 
 /*
  * Misc.
@@ -106,6 +119,24 @@ StarSystem *cur_system = NULL; /**< Current star system. */
 glTexture *jumppoint_gfx = NULL; /**< Jump point graphics. */
 static glTexture *jumpbuoy_gfx = NULL; /**< Jump buoy graphics. */
 static int space_fchg = 0; /**< Faction change counter, to avoid unnecessary calls. */
+/*
+ * Background render cache. The star/nebula background only changes with
+ * camera motion (and, slowly, with nebula animation), so it is rendered
+ * into an FBO and composited as a single quad while it stays valid.
+ * Mostly pays off at high resolutions where the nebula is fill-rate bound.
+ */
+#define BKG_CACHE_REFRESH   0.5 /**< Forced refresh period (s) of a static starry background, for animated Lua layers. */
+#define NEBU_CACHE_REFRESH  0.1 /**< Forced refresh period (s) of a static nebula background; keeps the animation smooth. */
+static GLuint space_bkg_fbo = GL_INVALID_VALUE; /**< Background cache framebuffer. */
+static GLuint space_bkg_tex = GL_INVALID_VALUE; /**< Background cache texture. */
+static int space_bkg_valid  = 0;  /**< Whether the cached background can be reused. */
+static GLsizei space_bkg_w  = 0;  /**< Width the cache was created at. */
+static GLsizei space_bkg_h  = 0;  /**< Height the cache was created at. */
+static double space_bkg_camx = 0.; /**< Camera X position the cache was rendered at. */
+static double space_bkg_camy = 0.; /**< Camera Y position the cache was rendered at. */
+static double space_bkg_zoom = 0.; /**< Camera zoom the cache was rendered at. */
+static int space_bkg_menu   = 0;  /**< Main menu state the cache was rendered at. */
+static double space_bkg_dt  = 0.; /**< Time accumulated since the cache was rendered. */
 static int space_simulating = 0; /**< Are we simulating space? */
 static int space_simulating_effects = 0; /**< Are we doing special effects? */
 static Spob *space_landQueueSpob = NULL;
@@ -114,6 +145,11 @@ static Spob *space_landQueueSpob = NULL;
  * Fleet spawning.
  */
 int space_spawn = 1; /**< Spawn enabled by default. */
+#define SPACE_SPAWN_DT 0.1 /**< Game seconds between spawn scheduler ticks. */
+static double space_spawnAccum = 0.; /**< Game time accumulated towards the next tick. */
+static double space_nebuDmgAccum = 0.; /**< Volatility damage accumulated towards the next tick. */
+static double space_nebuDmgTimer = 0.; /**< Game time since the last volatility damage tick. */
+#define NEBU_DMG_INTERVAL 0.5 /**< Seconds between volatility damage ticks. */
 
 /*
  * Internal Prototypes.
@@ -345,6 +381,7 @@ void system_updateAsteroids( StarSystem *sys )
 int spob_setFaction( Spob *p, int faction )
 {
    p->presence.faction = faction;
+   spob_invalidateLand( p );
    return 0;
 }
 
@@ -372,6 +409,7 @@ int spob_addCommodity( Spob *p, Commodity *c )
 int spob_addService( Spob *p, int service )
 {
    p->services |= service;
+   spob_invalidateLand( p );
 
    if (service & SPOB_SERVICE_COMMODITY) {
       /* Only try to add standard commodities if there aren't any. */
@@ -398,6 +436,7 @@ int spob_addService( Spob *p, int service )
 int spob_rmService( Spob *p, int service )
 {
    p->services &= ~service;
+   spob_invalidateLand( p );
    return 0;
 }
 
@@ -781,6 +820,43 @@ int space_sysReachable( const StarSystem *sys )
    return 0;
 }
 
+/* Indices of systems the map has any business drawing: known, marked or
+ * reachable. Rebuilt lazily after discovery/marker events so the per-frame
+ * map loops skip the (early game, vast) undiscovered remainder. */
+static int *systems_known_idx  = NULL; /**< Discovery index; NULL when stale. */
+
+/**
+ * @brief Drops the discovery index; call after known or marker state changes.
+ */
+void space_knownInvalidate (void)
+{
+   array_free( systems_known_idx );
+   systems_known_idx = NULL;
+}
+
+/**
+ * @brief Gets the indices of all systems that are known, marked or reachable.
+ *
+ * Supersets every filter the map render loops apply, so iterating it in
+ *  place of systems_stack only skips systems no loop would draw anyway.
+ *
+ *    @return Array (array.h) of indices into the system stack.
+ */
+const int *space_getKnownSystems (void)
+{
+   if (systems_known_idx == NULL) {
+      systems_known_idx = array_create( int );
+      for (int i=0; i<array_size(systems_stack); i++) {
+         const StarSystem *sys = &systems_stack[i];
+         if (sys_isKnown(sys) ||
+               sys_isFlag(sys, SYSTEM_MARKED | SYSTEM_CMARKED | SYSTEM_PMARKED) ||
+               space_sysReachable(sys))
+            array_push_back( &systems_known_idx, i );
+      }
+   }
+   return systems_known_idx;
+}
+
 /**
  * @brief Sees if a system can be reached via jumping.
  *
@@ -1199,6 +1275,12 @@ const char *jump_getSymbol( const JumpPoint *jp )
  */
 static void system_scheduler( double dt, int init )
 {
+   int ran = 0;
+
+   /* Live spawns spread their init Lua over the next frames; during
+    * system-entry simulation pilots must come up fully initialized. */
+   pilots_spawnDeferred( !space_simulating && !init );
+
    /* Go through all the factions and reduce the timer. */
    for (int i=0; i < array_size(cur_system->presence); i++) {
       int n;
@@ -1234,6 +1316,13 @@ static void system_scheduler( double dt, int init )
          if (p->timer >= 0.)
             continue;
 
+         /* At most one faction spawns per tick; the rest keep their
+          * timer deficit and catch up on the following ticks, so a
+          * pile-up of expired timers can't spike a single frame. */
+         if (ran)
+            continue;
+         ran = 1;
+
          nlua_getenv( naevL, env, "spawn" ); /* f */
          if (lua_isnil(naevL,-1)) {
             WARN(_("Lua Spawn script for faction '%s' missing obligatory entry point 'spawn'."),
@@ -1244,7 +1333,10 @@ static void system_scheduler( double dt, int init )
          lua_pushnumber( naevL, p->curUsed ); /* f, presence */
          n = 1;
       }
-      lua_pushnumber( naevL, p->value ); /* f, [arg,], max */
+      /* The coarse world simulation shifts faction strength around the
+       * static presence; it only becomes real pilots right here. */
+      lua_pushnumber( naevL, p->value
+            * worldsim_strength( cur_system, p->faction ) ); /* f, [arg,], max */
 
       /* Actually run the function. */
       if (nlua_pcall(env, n+1, 2)) { /* error has occurred */
@@ -1311,6 +1403,8 @@ static void system_scheduler( double dt, int init )
       }
       lua_pop(naevL,2);
    }
+
+   pilots_spawnDeferred( 0 );
 }
 
 /**
@@ -1344,26 +1438,41 @@ void space_update( double dt, double real_dt )
    if (cur_system == NULL)
       return;
 
-   /* If spawning is enabled, call the scheduler. */
-   if (space_spawn)
-      system_scheduler( dt, 0 );
+   /* If spawning is enabled, call the scheduler. Spawn decisions don't
+    * need frame granularity, so the Lua side runs at a fixed cadence on
+    * the accumulated time instead of once per frame. */
+   space_spawnAccum += dt;
+   if (space_spawn && (space_spawnAccum >= SPACE_SPAWN_DT)) {
+      system_scheduler( space_spawnAccum, 0 );
+      space_spawnAccum = 0.;
+   }
 
    /*
     * Nebula.
     */
    nebu_update( dt );
    if (cur_system->nebu_volatility > 0.) {
-      Pilot *const* pilot_stack;
-      Damage dmg;
-      dmg.type          = dtype_get("nebula");
-      dmg.damage        = cur_system->nebu_volatility * dt;
-      dmg.penetration   = 1.; /* Full penetration. */
-      dmg.disable       = 0.;
-
-      /* Damage pilots in volatile systems. */
-      pilot_stack = pilot_getAll();
-      for (int i=0; i<array_size(pilot_stack); i++)
-         pilot_hit( pilot_stack[i], NULL, NULL, &dmg, NULL, LUA_NOREF, 0 );
+      /* Volatility is a slow burn but pilot_hit() is not cheap with many
+       * pilots around, so the damage is accumulated and dealt in coarse
+       * ticks with the same total. */
+      space_nebuDmgAccum += cur_system->nebu_volatility * dt;
+      space_nebuDmgTimer += dt;
+      if (space_nebuDmgTimer >= NEBU_DMG_INTERVAL) {
+         Pilot *const* pilot_stack;
+         Damage dmg;
+         dmg.type          = dtype_get("nebula");
+         dmg.damage        = space_nebuDmgAccum;
+         dmg.penetration   = 1.; /* Full penetration. */
+         dmg.disable       = 0.;
+
+         /* Damage pilots in volatile systems. */
+         pilot_stack = pilot_getAll();
+         for (int i=0; i<array_size(pilot_stack); i++)
+            pilot_hit( pilot_stack[i], NULL, NULL, &dmg, NULL, LUA_NOREF, 0 );
+
+         space_nebuDmgAccum = 0.;
+         space_nebuDmgTimer = 0.;
+      }
    }
 
    /* Faction updates. */
@@ -1440,8 +1549,10 @@ void space_update( double dt, double real_dt )
          jp->map_alpha = 0.;
       }
 
-      if (found_something)
+      if (found_something) {
          ovr_refresh();
+         space_knownInvalidate();
+      }
    }
 
    /* Update the gatherable objects. */
@@ -1487,6 +1598,7 @@ void space_init( const char* sysname, int do_simulate )
    spfx_clear(); /* get rid of the explosions */
    gatherable_free(); /* get rid of gatherable stuff. */
    background_clear(); /* Get rid of the background. */
+   space_bkg_valid = 0; /* The cached background belongs to the old system. */
    factions_clearDynamic(); /* get rid of dynamic factions. */
    space_spawn = 1; /* spawn is enabled by default. */
    /* Clear persistent pilot stuff. */
@@ -1546,6 +1658,7 @@ void space_init( const char* sysname, int do_simulate )
    for (int i=0; i<array_size(cur_system->spobs); i++) {
       Spob *pnt = cur_system->spobs[i];
       pnt->land_override = 0;
+      spob_invalidateLand( pnt ); /* New system context; force a recompute. */
       spob_updateLand( pnt );
    }
 
@@ -1557,20 +1670,28 @@ void space_init( const char* sysname, int do_simulate )
    pilots_newSystem();
 
    /* Reset any schedules and used presence. */
+   space_spawnAccum = 0.;
+   space_nebuDmgAccum = 0.;
+   space_nebuDmgTimer = 0.;
    for (int i=0; i<array_size(cur_system->presence); i++) {
       cur_system->presence[i].curUsed  = 0;
       cur_system->presence[i].timer    = 0.;
       cur_system->presence[i].disabled = 0;
    }
 
-   /* Load graphics. */
+   /* Load graphics. If autonav prefetched this system the textures are
+    * already resident (or decoding) and this is a no-op. */
    space_gfxLoad( cur_system );
+   if ((space_prefetched != NULL) && (space_prefetched != cur_system))
+      space_gfxUnload( space_prefetched );
+   space_prefetched = NULL;
 
    /* Call the scheduler. */
    system_scheduler( 0., 1 );
 
    /* we now know this system */
    sys_setFlag(cur_system,SYSTEM_KNOWN);
+   space_knownInvalidate();
 
    /* Simulate system. */
    space_simulating = 1;
@@ -1749,7 +1870,7 @@ static int virtualspobs_load (void)
          continue;
       }
 
-      doc = xml_parsePhysFS( spob_files[i] );
+      doc = xml_parsePhysFSCached( spob_files[i] );
       if (doc == NULL) {
          free( spob_files[i] );
          continue;
@@ -1865,12 +1986,20 @@ const glColour* spob_getColour( const Spob *p )
  */
 void spob_updateLand( Spob *p )
 {
+   /* The map and HUD query this every frame; only recompute when
+    * something that can affect the result changed (standing changes,
+    * service/faction edits and the Lua-side setters all invalidate). */
+   if (p->land_computed)
+      return;
+   p->land_computed = 1;
+
    /* Clean up old stuff. */
    free( p->land_msg );
    p->can_land    = 0;
    p->land_msg    = NULL;
 
    /* Run custom Lua. */
+   spob_luaEnsure( p );
    if (p->lua_can_land != LUA_NOREF) {
       spob_luaInitMem( p );
       lua_rawgeti(naevL, LUA_REGISTRYINDEX, p->lua_can_land); /* f */
@@ -1894,6 +2023,42 @@ void spob_updateLand( Spob *p )
    }
 }
 
+/**
+ * @brief Marks a spob's cached land permission as stale.
+ *
+ *    @param p Spob to invalidate.
+ */
+void spob_invalidateLand( Spob *p )
+{
+   p->land_computed = 0;
+}
+
+/**
+ * @brief Marks every spob's cached land permission as stale.
+ *
+ * Used when something global changes, notably player faction standing.
+ */
+void space_invalidateLand (void)
+{
+   for (int i=0; i<array_size(spob_stack); i++)
+      spob_stack[i].land_computed = 0;
+}
+
+/**
+ * @brief Marks the cached land permission of every spob of a faction as stale.
+ *
+ * Cheaper alternative to space_invalidateLand() when only one faction's
+ * standing band changed; spobs of other factions keep their cached result.
+ *
+ *    @param f Faction whose spobs to invalidate.
+ */
+void space_invalidateLandFaction( int f )
+{
+   for (int i=0; i<array_size(spob_stack); i++)
+      if (spob_stack[i].presence.faction == f)
+         spob_stack[i].land_computed = 0;
+}
+
 void spob_luaInitMem( const Spob *spob )
 {
    if (spob->lua_mem != LUA_NOREF) {
@@ -1980,11 +2145,40 @@ int spob_luaInit( Spob *spob )
    return 0;
 }
 
+/**
+ * @brief Makes sure a spob's Lua state has been initialized.
+ *
+ * Spob Lua is hydrated on demand, the first time something actually
+ * touches the spob (entering its system, hailing, landing, ...), so
+ * huge universes don't pay for thousands of environments and init
+ * chunks at load.
+ *
+ *    @param spob Spob to hydrate.
+ *    @return 0 on success.
+ */
+int spob_luaEnsure( Spob *spob )
+{
+   if ((spob->lua_file == NULL) || (spob->lua_env != LUA_NOREF))
+      return 0;
+   return spob_luaInit( spob );
+}
+
+/**
+ * @brief Completion callback for asynchronously loaded spob graphics.
+ */
+static void spob_gfxSpaceLoaded( glTexture *tex, void *data )
+{
+   Spob *spob = data;
+   if (spob->radius < 0.)
+      spob->radius = (tex->w + tex->h)/4.;
+}
+
 /**
  * @brief Loads a spob's graphics (and radius).
  */
 void spob_gfxLoad( Spob *spob )
 {
+   spob_luaEnsure( spob );
    if (spob->lua_load) {
       spob_luaInitMem( spob );
       lua_rawgeti(naevL, LUA_REGISTRYINDEX, spob->lua_load); /* f */
@@ -2007,8 +2201,13 @@ void spob_gfxLoad( Spob *spob )
    }
 
    if (spob->gfx_space==NULL) {
-      if (spob->gfx_spaceName != NULL)
-         spob->gfx_space = gl_newImage( spob->gfx_spaceName, OPENGL_TEX_MIPMAPS );
+      if (spob->gfx_spaceName != NULL) {
+         /* Decode in the background so entering a system doesn't stall
+          * on art; the radius is fixed up when the pixels arrive. */
+         spob->gfx_space = gl_newImageAsync( spob->gfx_spaceName,
+               OPENGL_TEX_MIPMAPS, spob_gfxSpaceLoaded, spob );
+         return;
+      }
    }
    /* Set default size if applicable. */
    if ((spob->gfx_space!=NULL) && (spob->radius < 0.))
@@ -2026,6 +2225,32 @@ void space_gfxLoad( StarSystem *sys )
       spob_gfxLoad( sys->spobs[i] );
 }
 
+/**
+ * @brief Prefetches a system's assets ahead of an expected jump.
+ *
+ * Meant to be called when autonav picks a jump target so the spob art
+ * decodes on the loader thread and the spob Lua environments compile
+ * during transit instead of stalling system entry. A previous prefetch
+ * that was not consumed is released first; the Lua environments are kept
+ * since they are hydrated once per session anyway.
+ *
+ *    @param sys System the player is expected to jump to, or NULL to just
+ *               release the current prefetch.
+ */
+void space_prefetch( StarSystem *sys )
+{
+   if ((sys == space_prefetched) || ((sys != NULL) && (sys == cur_system)))
+      return;
+   if ((space_prefetched != NULL) && (space_prefetched != cur_system))
+      space_gfxUnload( space_prefetched );
+   space_prefetched = sys;
+   if (sys == NULL)
+      return;
+   space_gfxLoad( sys );
+   for (int i=0; i<array_size(sys->spobs); i++)
+      spob_luaEnsure( sys->spobs[i] );
+}
+
 /**
  * @brief Unloads all the graphics for a star system.
  *
@@ -2089,7 +2314,7 @@ static int spob_parse( Spob *spob, const char *filename, Commodity **stdList )
    unsigned int flags;
    Commodity **comms;
 
-   doc = xml_parsePhysFS( filename );
+   doc = xml_parsePhysFSCached( filename );
    if (doc == NULL)
       return -1;
 
@@ -2250,7 +2475,7 @@ static int spob_parse( Spob *spob, const char *filename, Commodity **stdList )
             if (xml_isNode(cur, "tag")) {
                char *tmp = xml_get(cur);
                if (tmp != NULL)
-                  array_push_back( &spob->tags, strdup(tmp) );
+                  array_push_back( &spob->tags, (char*)strintern(tmp) );
                continue;
             }
             WARN(_("Spob '%s' has unknown node in tags '%s'."), spob->name, cur->name );
@@ -2396,8 +2621,8 @@ int system_rmSpob( StarSystem *sys, const char *spobname )
    array_erase( &sys->spobs, &sys->spobs[i], &sys->spobs[i+1] );
    array_erase( &sys->spobsid, &sys->spobsid[i], &sys->spobsid[i+1] );
 
-   /* Remove the presence. */
-   space_reconstructPresences(); /* TODO defer this if removing multiple spobs at once. */
+   /* Remove the presence; only the systems in spill range can change. */
+   space_reconstructPresencesLocal( sys );
 
    /* Remove from the name stack thingy. */
    found = 0;
@@ -2472,8 +2697,8 @@ int system_rmVirtualSpob( StarSystem *sys, const char *spobname )
    /* Remove virtual spob. */
    array_erase( &sys->spobs_virtual, &sys->spobs_virtual[i], &sys->spobs_virtual[i+1] );
 
-   /* Remove the presence. */
-   space_reconstructPresences(); /* TODO defer this if removing multiple spobs at once. */
+   /* Remove the presence; only the systems in spill range can change. */
+   space_reconstructPresencesLocal( sys );
    system_setFaction(sys);
 
    economy_addQueuedUpdate();
@@ -2792,7 +3017,7 @@ static int system_parse( StarSystem *sys, const char *filename )
    uint32_t flags;
 
    /* Load the file. */
-   doc = xml_parsePhysFS( filename );
+   doc = xml_parsePhysFSCached( filename );
    if (doc == NULL)
       return -1;
 
@@ -2904,7 +3129,7 @@ static int system_parse( StarSystem *sys, const char *filename )
             if (xml_isNode(cur, "tag")) {
                char *tmp = xml_get(cur);
                if (tmp != NULL)
-                  array_push_back( &sys->tags, strdup(tmp) );
+                  array_push_back( &sys->tags, (char*)strintern(tmp) );
                continue;
             }
             WARN(_("System '%s' has unknown node in tags '%s'."), sys->name, cur->name );
@@ -3163,7 +3388,7 @@ static int system_parseJumps( StarSystem *sys )
    xmlNodePtr parent, cur, node;
    xmlDocPtr doc;
 
-   doc = xml_parsePhysFS( sys->filename );
+   doc = xml_parsePhysFSCached( sys->filename );
    if (doc == NULL)
       return -1;
 
@@ -3261,17 +3486,6 @@ int space_load (void)
    return 0;
 }
 
-/**
- * @brief initializes the Lua for all the spobs.
- */
-int space_loadLua (void)
-{
-   int ret = 0;
-   for (int i=0; i<array_size(spob_stack); i++)
-      ret |= spob_luaInit( &spob_stack[i] );
-   return ret;
-}
-
 /**
  * @brief Loads the entire systems, needs to be called after spobs_load.
  *
@@ -3352,13 +3566,90 @@ static int systems_load (void)
  */
 void space_render( const double dt )
 {
+   double cx, cy, z;
+   int redraw, menu;
+   mat4 ortho, I;
+
    if (cur_system == NULL)
       return;
 
+   /* See if the cached background is still usable. */
+   cam_getPos( &cx, &cy );
+   z    = cam_getZoom();
+   menu = menu_isOpen( MENU_MAIN );
+   space_bkg_dt += dt;
+   redraw = (!space_bkg_valid ||
+         (space_bkg_w != (GLsizei)gl_screen.rw) ||
+         (space_bkg_h != (GLsizei)gl_screen.rh) ||
+         (cx != space_bkg_camx) || (cy != space_bkg_camy) ||
+         (z != space_bkg_zoom) || (menu != space_bkg_menu));
+   /* Even with a static camera the background animates (nebula time,
+    * Lua layers), just much slower than the frame rate. */
    if (cur_system->nebu_density > 0.)
-      nebu_render(dt);
+      redraw = redraw || (space_bkg_dt > NEBU_CACHE_REFRESH);
    else
-      background_render(dt);
+      redraw = redraw || (space_bkg_dt > BKG_CACHE_REFRESH);
+
+   if (redraw) {
+      GLuint prev_fbo;
+
+      /* (Re)create the cache at the current resolution. */
+      if ((space_bkg_fbo == GL_INVALID_VALUE) ||
+            (space_bkg_w != (GLsizei)gl_screen.rw) ||
+            (space_bkg_h != (GLsizei)gl_screen.rh)) {
+         if (space_bkg_fbo != GL_INVALID_VALUE) {
+            glDeleteFramebuffers( 1, &space_bkg_fbo );
+            glDeleteTextures( 1, &space_bkg_tex );
+         }
+         gl_fboCreate( &space_bkg_fbo, &space_bkg_tex, gl_screen.rw, gl_screen.rh );
+         space_bkg_w = gl_screen.rw;
+         space_bkg_h = gl_screen.rh;
+      }
+
+      /* Redirect the current draw target so the renderers (including the
+       * internal nebula FBO blit) land in the cache. */
+      prev_fbo = gl_screen.current_fbo;
+      gl_screen.current_fbo = space_bkg_fbo;
+      glBindFramebuffer( GL_FRAMEBUFFER, space_bkg_fbo );
+      glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+      /* Feed the renderers the time accumulated while cached, so the
+       * animation advances at the right speed. */
+      if (cur_system->nebu_density > 0.)
+         nebu_render( space_bkg_dt );
+      else
+         background_render( space_bkg_dt );
+
+      gl_screen.current_fbo = prev_fbo;
+      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+
+      space_bkg_valid = 1;
+      space_bkg_camx  = cx;
+      space_bkg_camy  = cy;
+      space_bkg_zoom  = z;
+      space_bkg_menu  = menu;
+      space_bkg_dt    = 0.;
+   }
+
+   /* Composite the cached background as a single quad. The background is
+    * the bottom layer, so blending is disabled to copy the cached pixels
+    * verbatim instead of blending them against the clear colour again. */
+   glDisable( GL_BLEND );
+   gl_useProgram( shaders.texture.program );
+   glBindTexture( GL_TEXTURE_2D, space_bkg_tex );
+   glEnableVertexAttribArray( shaders.texture.vertex );
+   gl_vboActivateAttribOffset( gl_squareVBO, shaders.texture.vertex,
+         0, 2, GL_FLOAT, 0 );
+   ortho = mat4_ortho( 0., 1., 0., 1., 1., -1. );
+   I     = mat4_identity();
+   gl_uniformColor( shaders.texture.color, &cWhite );
+   gl_uniformMat4( shaders.texture.projection, &ortho );
+   gl_uniformMat4( shaders.texture.tex_mat, &I );
+   glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   glDisableVertexAttribArray( shaders.texture.vertex );
+   gl_useProgram(0);
+   glEnable( GL_BLEND );
+   gl_checkErr();
 }
 
 /**
@@ -3434,14 +3725,35 @@ static void space_renderJumpPoint( const JumpPoint *jp, int i )
    }
 }
 
+/**
+ * @brief Checks whether a spob can possibly touch the camera rectangle.
+ *
+ * Plain sprites get culled inside gl_renderSprite() anyway, but for
+ * Lua-rendered spobs this saves setting up and calling into Lua at all.
+ */
+static int space_spobOnScreen( const Spob *p )
+{
+   double cx, cy, z, hw, hh, r;
+
+   cam_getPos( &cx, &cy );
+   z  = cam_getZoom();
+   hw = SCREEN_W/2. / z;
+   hh = SCREEN_H/2. / z;
+   /* The radius is lazy-loaded with the graphic; be generous without it. */
+   r  = (p->radius > 0.) ? 2.*p->radius : 1e3;
+   return (FABS( p->pos.x - cx ) <= hw + r) &&
+          (FABS( p->pos.y - cy ) <= hh + r);
+}
+
 /**
  * @brief Renders a spob.
  */
 static void space_renderSpob( const Spob *p )
 {
+   if (!space_spobOnScreen( p ))
+      return;
    if (p->lua_render != LUA_NOREF) {
       spob_luaInitMem( p );
-      /* TODO do a clip test first. */
       lua_rawgeti(naevL, LUA_REGISTRYINDEX, p->lua_render); /* f */
       if (nlua_pcall( p->lua_env, 0, 0 )) {
          WARN(_("Spob '%s' failed to run '%s':\n%s"), p->name, "render", lua_tostring(naevL,-1));
@@ -3475,6 +3787,17 @@ static void space_updateSpob( const Spob *p, double dt, double real_dt )
  */
 void space_exit (void)
 {
+   space_knownInvalidate();
+
+   /* Free the background cache. */
+   if (space_bkg_fbo != GL_INVALID_VALUE) {
+      glDeleteFramebuffers( 1, &space_bkg_fbo );
+      glDeleteTextures( 1, &space_bkg_tex );
+      space_bkg_fbo = GL_INVALID_VALUE;
+      space_bkg_tex = GL_INVALID_VALUE;
+      space_bkg_valid = 0;
+   }
+
    /* Free standalone graphic textures */
    gl_freeTexture(jumppoint_gfx);
    jumppoint_gfx = NULL;
@@ -3496,9 +3819,7 @@ void space_exit (void)
       free(spb->class);
       free(spb->description);
       free(spb->bar_description);
-      for (int j=0; j<array_size(spb->tags); j++)
-         free( spb->tags[j] );
-      array_free(spb->tags);
+      array_free(spb->tags); /* Tags are interned. */
 
       /* graphics */
       if (spb->gfx_spaceName != NULL) {
@@ -3554,9 +3875,7 @@ void space_exit (void)
       array_free(sys->spobsid);
       array_free(sys->spobs_virtual);
 
-      for (int j=0; j<array_size(sys->tags); j++)
-         free( sys->tags[j] );
-      array_free(sys->tags);
+      array_free(sys->tags); /* Tags are interned. */
 
       /* Free the asteroids. */
       for (int j=0; j < array_size(sys->asteroids); j++)
@@ -3580,6 +3899,7 @@ void space_exit (void)
       MapShader *ms = mapshaders[i];
       free( ms->name );
       glDeleteProgram( ms->program );
+      gl_stateInvalidate(); /* Program ids can get reused. */
       free(ms);
    }
    array_free( mapshaders );
@@ -3601,6 +3921,7 @@ void space_clearKnown (void)
    }
    for (int j=0; j<array_size(spob_stack); j++)
       spob_rmFlag(&spob_stack[j],SPOB_KNOWN);
+   space_knownInvalidate();
 }
 
 /**
@@ -3621,6 +3942,7 @@ void space_clearMarkers (void)
       spob_rmFlag( pnt, SPOB_MARKED );
       pnt->markers = 0;
    }
+   space_knownInvalidate();
 }
 
 /**
@@ -3630,6 +3952,7 @@ void space_clearComputerMarkers (void)
 {
    for (int i=0; i<array_size(systems_stack); i++)
       sys_rmFlag(&systems_stack[i],SYSTEM_CMARKED);
+   space_knownInvalidate();
 }
 
 static int space_addMarkerSystem( int sysid, MissionMarkerType type )
@@ -3664,6 +3987,7 @@ static int space_addMarkerSystem( int sysid, MissionMarkerType type )
    /* Decrement markers. */
    (*markers)++;
    sys_setFlag(ssys, SYSTEM_MARKED);
+   space_knownInvalidate();
 
    return 0;
 }
@@ -3751,6 +4075,7 @@ static int space_rmMarkerSystem( int sys, MissionMarkerType type )
    if (*markers <= 0) {
       sys_rmFlag(ssys, SYSTEM_MARKED);
       (*markers) = 0;
+      space_knownInvalidate();
    }
 
    return 0;
@@ -3898,6 +4223,8 @@ int space_sysLoad( xmlNodePtr parent )
       } while (xml_nextNode(cur));
    } while (xml_nextNode(node));
 
+   space_knownInvalidate();
+
    return 0;
 }
 
@@ -3994,16 +4321,22 @@ void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
    /* Get secondary if applicable. */
    fgens = faction_generators( faction );
 
+   /* Track the largest range so partial rebuilds know how far to look. */
+   if ((int)range > presence_max_range)
+      presence_max_range = (int)range;
+
    /* Add the presence to the current system. */
-   id = getPresenceIndex(sys, faction);
-   sys->presence[id].base   = MAX( sys->presence[id].base, base );
-   sys->presence[id].bonus += bonus;
-   sys->presence[id].value  = sys->presence[id].base + sys->presence[id].bonus;
-   for (int i=0; i<array_size(fgens); i++) {
-      int x = getPresenceIndex(sys, fgens[i].id);
-      sys->presence[x].base   = MAX( sys->presence[x].base, MAX(0., base*fgens[i].weight) );
-      sys->presence[x].bonus += MAX(0., bonus*fgens[i].weight);
-      sys->presence[x].value  = sys->presence[x].base + sys->presence[x].bonus;
+   if (!presence_mask || sys->presence_dirty) {
+      id = getPresenceIndex(sys, faction);
+      sys->presence[id].base   = MAX( sys->presence[id].base, base );
+      sys->presence[id].bonus += bonus;
+      sys->presence[id].value  = sys->presence[id].base + sys->presence[id].bonus;
+      for (int i=0; i<array_size(fgens); i++) {
+         int x = getPresenceIndex(sys, fgens[i].id);
+         sys->presence[x].base   = MAX( sys->presence[x].base, MAX(0., base*fgens[i].weight) );
+         sys->presence[x].bonus += MAX(0., bonus*fgens[i].weight);
+         sys->presence[x].value  = sys->presence[x].base + sys->presence[x].bonus;
+      }
    }
 
    /* If there's no range, we're done here. */
@@ -4053,17 +4386,19 @@ void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
       }
 
       /* Spill some presence. */
-      x = getPresenceIndex(cur, faction);
-      spillfactor = 1. / (2. + (double)curSpill);
-      cur->presence[x].base   = MAX( cur->presence[x].base, base * spillfactor );
-      cur->presence[x].bonus += bonus * spillfactor;
-      cur->presence[x].value  = cur->presence[x].base + cur->presence[x].bonus;
-
-      for (int i=0; i<array_size(fgens); i++) {
-         int y = getPresenceIndex(cur, fgens[i].id);
-         cur->presence[y].base   = MAX( cur->presence[y].base, MAX(0., base*spillfactor*fgens[i].weight) );
-         cur->presence[y].bonus += MAX(0., bonus*spillfactor*fgens[i].weight );
-         cur->presence[y].value  = cur->presence[y].base + cur->presence[y].bonus;
+      if (!presence_mask || cur->presence_dirty) {
+         x = getPresenceIndex(cur, faction);
+         spillfactor = 1. / (2. + (double)curSpill);
+         cur->presence[x].base   = MAX( cur->presence[x].base, base * spillfactor );
+         cur->presence[x].bonus += bonus * spillfactor;
+         cur->presence[x].value  = cur->presence[x].base + cur->presence[x].bonus;
+
+         for (int i=0; i<array_size(fgens); i++) {
+            int y = getPresenceIndex(cur, fgens[i].id);
+            cur->presence[y].base   = MAX( cur->presence[y].base, MAX(0., base*spillfactor*fgens[i].weight) );
+            cur->presence[y].bonus += MAX(0., bonus*spillfactor*fgens[i].weight );
+            cur->presence[y].value  = cur->presence[y].base + cur->presence[y].bonus;
+         }
       }
 
       /* Check to see if we've finished this range and grab the next queue. */
@@ -4198,6 +4533,109 @@ void space_reconstructPresences( void )
    /* TODO this actually ignores existing presence and will temporarily increase system presence more than normal... */
    if (cur_system != NULL)
       system_scheduler( 0., 1 );
+
+   presence_gen++;
+}
+
+/**
+ * @brief Rebuilds the presence of only the systems in range of a changed asset.
+ *
+ * Presence spills at most presence_max_range jumps, so a change in one
+ * system can only affect systems within that radius, and those systems can
+ * only receive presence from assets within another radius beyond. This
+ * rebuilds exactly that neighbourhood instead of the whole universe.
+ *
+ *    @param sys System whose assets changed.
+ */
+void space_reconstructPresencesLocal( StarSystem *sys )
+{
+   StarSystem **stk;
+   int *dist;
+   int r = presence_max_range;
+
+   /* Without range information just do the full rebuild. */
+   if ((sys == NULL) || (r <= 0)) {
+      space_reconstructPresences();
+      return;
+   }
+
+   /* Collect the neighbourhood: systems within r jumps may change, and
+    * assets up to 2*r jumps away can spill into those. Jump flags are
+    * ignored here so the set stays a superset of what any faction uses. */
+   stk  = array_create( StarSystem* );
+   dist = array_create( int );
+   array_push_back( &stk, sys );
+   array_push_back( &dist, 0 );
+   sys->spilled = 1;
+   for (int i=0; i<array_size(stk); i++) {
+      StarSystem *cur = stk[i];
+      if (dist[i] >= 2*r)
+         continue;
+      for (int j=0; j<array_size(cur->jumps); j++) {
+         StarSystem *t = cur->jumps[j].target;
+         if (t->spilled)
+            continue;
+         t->spilled = 1;
+         array_push_back( &stk, t );
+         array_push_back( &dist, dist[i]+1 );
+      }
+   }
+   for (int i=0; i<array_size(stk); i++)
+      stk[i]->spilled = 0; /* system_presenceAddSpob() reuses the marker. */
+
+   /* Reset the systems that may actually change. */
+   for (int i=0; i<array_size(stk); i++) {
+      if (dist[i] > r)
+         continue;
+      array_free( stk[i]->presence );
+      stk[i]->presence = array_create( SystemPresence );
+      stk[i]->ownerpresence = 0.;
+      stk[i]->presence_dirty = 1;
+   }
+
+   /* Re-add every asset in the neighbourhood; the mask makes the spill
+    * only write into the systems that were reset. */
+   presence_mask = 1;
+   for (int i=0; i<array_size(stk); i++)
+      system_addAllSpobsPresence( stk[i] );
+   presence_mask = 0;
+
+   /* Refresh the dominant faction of the changed systems. */
+   for (int i=0; i<array_size(stk); i++) {
+      if (!stk[i]->presence_dirty)
+         continue;
+      stk[i]->presence_dirty = 0;
+      system_setFaction( stk[i] );
+      stk[i]->ownerpresence = system_getPresence( stk[i], stk[i]->faction );
+   }
+
+   /* Redo the scheduler if the current system was touched. */
+   if (cur_system != NULL) {
+      for (int i=0; i<array_size(stk); i++) {
+         if ((stk[i] == cur_system) && (dist[i] <= r)) {
+            system_scheduler( 0., 1 );
+            break;
+         }
+      }
+   }
+
+   array_free( stk );
+   array_free( dist );
+
+   presence_gen++;
+}
+
+/**
+ * @brief Gets the presence generation counter.
+ *
+ * Bumped whenever any propagated presence changes; consumers can cache
+ * presence-derived data and recompute only when the counter moves.
+ *
+ *    @return The current generation.
+ */
+unsigned int space_presenceGeneration (void)
+{
+   return presence_gen;
 }
 
 /**
@@ -104,6 +104,7 @@ typedef struct Spob_ {
 
    /* Landing details. */
    int can_land;        /**< Whether or not the player can land. */
+   int land_computed;   /**< Whether can_land/land_msg are current; see spob_updateLand(). */
    int land_override;   /**< Forcibly allows the player to either be able to land or not (+1 is land, -1 is not, 0 otherwise). */
    char *land_msg;      /**< Message on landing. */
 
@@ -267,6 +268,7 @@ struct StarSystem_ {
    /* Presence. */
    SystemPresence *presence; /**< Array (array.h): Pointer to an array of presences in this system. */
    int spilled;         /**< If the system has been spilled to yet. */
+   int presence_dirty;  /**< Masked presence rebuilds only write to flagged systems. */
    double ownerpresence;/**< Amount of presence the owning faction has in a system. */
 
    /* Markers. */
@@ -299,7 +301,6 @@ extern int space_spawn; /**< 1 if spawning is enabled. */
  */
 void space_init( const char* sysname, int do_simulate );
 int space_load (void);
-int space_loadLua (void);
 void space_exit (void);
 
 /*
@@ -308,6 +309,7 @@ void space_exit (void);
 Spob *spob_new (void);
 const char *spob_name( const Spob *p );
 int spob_luaInit( Spob *spb );
+int spob_luaEnsure( Spob *spb );
 void spob_gfxLoad( Spob *p );
 int spob_hasSystem( const char* spobname );
 char* spob_getSystem( const char* spobname );
@@ -336,6 +338,9 @@ char spob_getColourChar( const Spob *p );
 const char *spob_getSymbol( const Spob *p );
 const glColour* spob_getColour( const Spob *p );
 void spob_updateLand( Spob *p );
+void spob_invalidateLand( Spob *p );
+void space_invalidateLand (void);
+void space_invalidateLandFaction( int f );
 /* Lua stuff. */
 void spob_luaInitMem( const Spob *spob );
 
@@ -382,6 +387,8 @@ double system_getPresence( const StarSystem *sys, int faction );
 double system_getPresenceFull( const StarSystem *sys, int faction, double *base, double *bonus );
 void system_addAllSpobsPresence( StarSystem *sys );
 void space_reconstructPresences( void );
+void space_reconstructPresencesLocal( StarSystem *sys );
+unsigned int space_presenceGeneration (void);
 void system_rmCurrentPresence( StarSystem *sys, int faction, double amount );
 
 /*
@@ -396,6 +403,7 @@ int space_isSimulationEffects (void);
  */
 void space_gfxLoad( StarSystem *sys );
 void space_gfxUnload( StarSystem *sys );
+void space_prefetch( StarSystem *sys );
 
 /*
  * Getting stuff.
@@ -407,6 +415,8 @@ StarSystem* system_get( const char* sysname );
 StarSystem* system_getIndex( int id );
 int system_index( const StarSystem *sys );
 int space_sysReachable( const StarSystem *sys );
+void space_knownInvalidate (void);
+const int *space_getKnownSystems (void);
 int space_sysReallyReachable( char* sysname );
 int space_sysReachableFromSys( const StarSystem *target, const StarSystem *sys );
 char** space_getFactionSpob( int *factions, int landable );
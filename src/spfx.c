@@ -8,6 +8,7 @@
  */
 /** @cond */
 #include <inttypes.h>
+#include <stddef.h>
 #include "SDL.h"
 #include "SDL_haptic.h"
 
@@ -20,6 +21,7 @@
 #include "array.h"
 #include "camera.h"
 #include "debris.h"
+#include "gui.h"
 #include "log.h"
 #include "ndata.h"
 #include "nxml.h"
@@ -30,6 +32,7 @@
 #include "render.h"
 #include "rng.h"
 #include "space.h"
+#include "threadpool.h"
 #include "nlua_shader.h"
 #include "nlua_spfx.h"
 
@@ -45,10 +48,28 @@
 #define HAPTIC_UPDATE_INTERVAL   0.1 /**< Time between haptic updates. */
 
 /* Trail stuff. */
-#define TRAIL_UPDATE_DT       0.05  /**< Rate (in seconds) at which trail is updated. */
+#define TRAIL_UPDATE_DT       0.05  /**< Minimum time (in seconds) between trail control points. */
+#define TRAIL_UPDATE_MAXDT    0.5   /**< Maximum time (in seconds) between control points on a straight, steady stretch. */
+#define TRAIL_DEV_ANGLE       0.02  /**< Relative cross product past which headings count as deviating. */
+#define TRAIL_DEV_SPEED       0.05  /**< Relative speed change past which speeds count as deviating. */
 static TrailSpec* trail_spec_stack; /**< Trail specifications. */
 static Trail_spfx** trail_spfx_stack; /**< Active trail effects. */
 
+/**
+ * @brief GPU-side representation of a trail point; the ring buffer is
+ *        mirrored into a VBO with two of these per point (one per edge) and
+ *        the vertex shader expands them into the trail geometry.
+ */
+typedef struct TrailVertex_ {
+   GLfloat x, y;     /**< Control point (game coordinates). */
+   GLfloat nx, ny;   /**< Unit normal to expand the trail along. */
+   GLfloat r, g, b, a; /**< Style colour at this point. */
+   GLfloat birth;    /**< Trail timer when the point was emitted. */
+   GLfloat thick;    /**< Style thickness at this point. */
+   GLfloat len;      /**< Arc length from the start of the trail. */
+   GLfloat side;     /**< -1. or 1.: which edge of the trail this vertex is. */
+} TrailVertex;
+
 /*
  * Special hard-coded special effects
  */
@@ -120,7 +141,7 @@ typedef struct SPFX_ {
    vec2 pos; /**< Current position. */
    vec2 vel; /**< Current velocity. */
 
-   int lastframe; /**< Needed when paused */
+   int lastframe; /**< Animation frame, precomputed by the update worker. */
    int effect; /**< The real effect */
 
    double timer; /**< Time left */
@@ -135,19 +156,43 @@ static SPFX *spfx_stack_front = NULL; /**< Frontal special effect layer. */
 static SPFX *spfx_stack_middle = NULL; /**< Middle special effect layer. */
 static SPFX *spfx_stack_back = NULL; /**< Back special effect layer. */
 
+/*
+ * The particle layers are double-buffered and advanced on a threadpool
+ * worker: spfx_update() swaps in the buffers the worker produced last
+ * frame, then kicks a job that writes the next state into the spare
+ * buffers while the rest of the frame (GUI, render) runs. The layers
+ * are purely cosmetic, so nothing downstream depends on them being
+ * current within the frame. New effects land in a pending stack the
+ * worker never touches and get merged at the swap.
+ */
+static SPFX *spfx_next_front = NULL; /**< Front layer being written by the worker. */
+static SPFX *spfx_next_middle = NULL; /**< Middle layer being written by the worker. */
+static SPFX *spfx_next_back = NULL; /**< Back layer being written by the worker. */
+static SPFX *spfx_pending_front = NULL; /**< Front effects added this frame. */
+static SPFX *spfx_pending_middle = NULL; /**< Middle effects added this frame. */
+static SPFX *spfx_pending_back = NULL; /**< Back effects added this frame. */
+static SDL_sem *spfx_layer_sem = NULL; /**< Posted when the worker finishes. */
+static int spfx_layer_job = 0; /**< Whether a worker job is outstanding. */
+static double spfx_layer_dt = 0.; /**< Delta tick handed to the worker. */
+
 /*
  * prototypes
  */
 /* General. */
 static int spfx_base_parse( SPFX_Base *temp, const char *filename );
 static void spfx_base_free( SPFX_Base *effect );
-static void spfx_update_layer( SPFX *layer, const double dt );
+static void spfx_update_layer( const SPFX *src, SPFX **dst, const double dt );
+static int spfx_layerWorker( void *data );
+static void spfx_layerSync (void);
 /* Haptic. */
 static int spfx_hapticInit (void);
 static void spfx_hapticRumble( double mod );
 /* Trail. */
 static void spfx_update_trails( double dt );
 static void spfx_trail_update( Trail_spfx* trail, double dt );
+static void spfx_trail_vboInit( Trail_spfx* trail );
+static int spfx_trail_deviates( const Trail_spfx *trail, const TrailPoint *p );
+static void spfx_trail_vboWrite( Trail_spfx* trail, size_t i );
 static void spfx_trail_free( Trail_spfx* trail );
 
 /**
@@ -231,7 +276,7 @@ static int spfx_base_parse( SPFX_Base *temp, const char *filename )
       temp->u_time      = glGetUniformLocation( temp->shader, "u_time" );
       temp->u_size      = glGetUniformLocation( temp->shader, "u_size" );
       if (uniforms != NULL) {
-         glUseProgram( temp->shader );
+         gl_useProgram( temp->shader );
          node = uniforms->xmlChildrenNode;
          do {
             xml_onlyNodes(node);
@@ -291,7 +336,7 @@ static int spfx_base_parse( SPFX_Base *temp, const char *filename )
                }
             }
          } while (xml_nextNode(node));
-         glUseProgram( 0 );
+         gl_useProgram( 0 );
       }
       gl_checkErr();
    }
@@ -390,10 +435,17 @@ int spfx_load (void)
    damage_shader.ClipSpaceFromLocal = shaders.damage.ClipSpaceFromLocal;
    damage_shader.MainTex       = shaders.damage.MainTex;
 
-   /* Stacks. */
+   /* Stacks, including the worker's write buffers and the pending adds. */
    spfx_stack_front = array_create( SPFX );
    spfx_stack_middle = array_create( SPFX );
    spfx_stack_back = array_create( SPFX );
+   spfx_next_front = array_create( SPFX );
+   spfx_next_middle = array_create( SPFX );
+   spfx_next_back = array_create( SPFX );
+   spfx_pending_front = array_create( SPFX );
+   spfx_pending_middle = array_create( SPFX );
+   spfx_pending_back = array_create( SPFX );
+   spfx_layer_sem = SDL_CreateSemaphore( 0 );
 
    if (conf.devmode) {
       time = SDL_GetTicks() - time;
@@ -413,6 +465,10 @@ void spfx_free (void)
    /* Clean up the debris. */
    debris_cleanup();
 
+   /* Let the update worker finish before pulling the buffers out from
+    * under it. */
+   spfx_layerSync();
+
    /* get rid of all the particles and free the stacks */
    spfx_clear();
    array_free(spfx_stack_front);
@@ -421,6 +477,22 @@ void spfx_free (void)
    spfx_stack_middle = NULL;
    array_free(spfx_stack_back);
    spfx_stack_back = NULL;
+   array_free(spfx_next_front);
+   spfx_next_front = NULL;
+   array_free(spfx_next_middle);
+   spfx_next_middle = NULL;
+   array_free(spfx_next_back);
+   spfx_next_back = NULL;
+   array_free(spfx_pending_front);
+   spfx_pending_front = NULL;
+   array_free(spfx_pending_middle);
+   spfx_pending_middle = NULL;
+   array_free(spfx_pending_back);
+   spfx_pending_back = NULL;
+   if (spfx_layer_sem != NULL) {
+      SDL_DestroySemaphore( spfx_layer_sem );
+      spfx_layer_sem = NULL;
+   }
 
    /* now clear the effects */
    for (int i=0; i<array_size(spfx_effects); i++)
@@ -475,12 +547,14 @@ void spfx_add( int effect,
    /*
     * Select the Layer
     */
+   /* New effects go to a pending stack the update worker never touches;
+    * they get merged into the visible layer at the next buffer swap. */
    if (layer == SPFX_LAYER_FRONT) /* front layer */
-      cur_spfx = &array_grow( &spfx_stack_front );
+      cur_spfx = &array_grow( &spfx_pending_front );
    else if (layer == SPFX_LAYER_MIDDLE) /* middle layer */
-      cur_spfx = &array_grow( &spfx_stack_middle );
+      cur_spfx = &array_grow( &spfx_pending_middle );
    else if (layer == SPFX_LAYER_BACK) /* back layer */
-      cur_spfx = &array_grow( &spfx_stack_back );
+      cur_spfx = &array_grow( &spfx_pending_back );
    else {
       WARN(_("Invalid SPFX layer."));
       return;
@@ -501,6 +575,7 @@ void spfx_add( int effect,
    /* Shader magic. */
    cur_spfx->unique = RNGF();
    cur_spfx->time = 0.0;
+   cur_spfx->lastframe = 0;
 }
 
 /**
@@ -536,9 +611,15 @@ void spfx_clear (void)
  */
 void spfx_update( const double dt, const double real_dt )
 {
-   spfx_update_layer( spfx_stack_front, dt );
-   spfx_update_layer( spfx_stack_middle, dt );
-   spfx_update_layer( spfx_stack_back, dt );
+   /* Swap in the layer state the worker produced last frame and merge
+    * the effects added since, then kick off this frame's update to run
+    * in the background while the GUI and render phases go on. */
+   spfx_layerSync();
+   spfx_layer_dt  = dt;
+   spfx_layer_job = 1;
+   threadpool_newJob( spfx_layerWorker, NULL );
+
+   /* Trails write into VBOs, so they stay on the main thread. */
    spfx_update_trails( dt );
 
    /* Decrement the haptic timer. */
@@ -556,29 +637,82 @@ void spfx_update( const double dt, const double real_dt )
 }
 
 /**
- * @brief Updates an individual spfx.
+ * @brief Advances a layer by writing the surviving effects into dst.
  *
- *    @param layer Layer the spfx is on.
+ * Runs on a threadpool worker; only touches the two buffers and the
+ * immutable effect definitions.
+ *
+ *    @param src Layer state being read.
+ *    @param dst Buffer the new state is written into.
  *    @param dt Current delta tick.
  */
-static void spfx_update_layer( SPFX *layer, const double dt )
+static void spfx_update_layer( const SPFX *src, SPFX **dst, const double dt )
 {
-   for (int i=0; i<array_size(layer); i++) {
-      layer[i].timer -= dt; /* less time to live */
+   array_erase( dst, array_begin(*dst), array_end(*dst) );
+   for (int i=0; i<array_size(src); i++) {
+      SPFX sp = src[i];
+      const SPFX_Base *effect = &spfx_effects[ sp.effect ];
 
-      /* time to die! */
-      if (layer[i].timer < 0.) {
-         array_erase( &layer, &layer[i], &layer[i+1] );
-         i--;
+      sp.timer -= dt; /* less time to live */
+      if (sp.timer < 0.) /* time to die! */
          continue;
-      }
-      layer[i].time  += dt; /* Shader timer. */
+      sp.time += dt; /* Shader timer. */
 
       /* actually update it */
-      vec2_cadd( &layer[i].pos, dt*VX(layer[i].vel), dt*VY(layer[i].vel) );
+      vec2_cadd( &sp.pos, dt*VX(sp.vel), dt*VY(sp.vel) );
+
+      /* Precompute the animation frame here so the render loop doesn't
+       * have to write into the layer the worker may be reading. */
+      if (effect->shader < 0) {
+         double t = 1. - fmod( sp.timer, effect->anim ) / effect->anim;
+         sp.lastframe = (int)effect->gfx->sx * (int)effect->gfx->sy * MIN( t, 1. );
+      }
+
+      array_push_back( dst, sp );
    }
 }
 
+/**
+ * @brief Threadpool job advancing all three particle layers.
+ */
+static int spfx_layerWorker( void *data )
+{
+   (void) data;
+   spfx_update_layer( spfx_stack_front,  &spfx_next_front,  spfx_layer_dt );
+   spfx_update_layer( spfx_stack_middle, &spfx_next_middle, spfx_layer_dt );
+   spfx_update_layer( spfx_stack_back,   &spfx_next_back,   spfx_layer_dt );
+   SDL_SemPost( spfx_layer_sem );
+   return 0;
+}
+
+/**
+ * @brief Waits for the outstanding layer update, swaps the buffers in
+ *        and merges the effects added since the job was kicked off.
+ */
+static void spfx_layerSync (void)
+{
+   SPFX *tmp;
+
+   if (!spfx_layer_job)
+      return;
+   SDL_SemWait( spfx_layer_sem );
+   spfx_layer_job = 0;
+
+   tmp = spfx_stack_front;  spfx_stack_front  = spfx_next_front;  spfx_next_front  = tmp;
+   tmp = spfx_stack_middle; spfx_stack_middle = spfx_next_middle; spfx_next_middle = tmp;
+   tmp = spfx_stack_back;   spfx_stack_back   = spfx_next_back;   spfx_next_back   = tmp;
+
+   for (int i=0; i<array_size(spfx_pending_front); i++)
+      array_push_back( &spfx_stack_front, spfx_pending_front[i] );
+   for (int i=0; i<array_size(spfx_pending_middle); i++)
+      array_push_back( &spfx_stack_middle, spfx_pending_middle[i] );
+   for (int i=0; i<array_size(spfx_pending_back); i++)
+      array_push_back( &spfx_stack_back, spfx_pending_back[i] );
+   array_erase( &spfx_pending_front, array_begin(spfx_pending_front), array_end(spfx_pending_front) );
+   array_erase( &spfx_pending_middle, array_begin(spfx_pending_middle), array_end(spfx_pending_middle) );
+   array_erase( &spfx_pending_back, array_begin(spfx_pending_back), array_end(spfx_pending_back) );
+}
+
 /**
  * @brief Updates the shake position.
  */
@@ -635,11 +769,11 @@ static void spfx_updateShake( double dt )
    vec2_cadd( &shake_pos, shake_vel.x * dt, shake_vel.y * dt );
 
    /* Set the uniform. */
-   glUseProgram( shaders.shake.program );
+   gl_useProgram( shaders.shake.program );
    glUniform2f( shaders.shake.shake_pos, shake_pos.x / SCREEN_W, shake_pos.y / SCREEN_H );
    glUniform2f( shaders.shake.shake_vel, shake_vel.x / SCREEN_W, shake_vel.y / SCREEN_H );
    glUniform1f( shaders.shake.shake_force, shake_force_mean );
-   glUseProgram( 0 );
+   gl_useProgram( 0 );
 
    gl_checkErr();
 }
@@ -660,9 +794,9 @@ static void spfx_updateDamage( double dt )
    }
 
    /* Set the uniform. */
-   glUseProgram( shaders.damage.program );
+   gl_useProgram( shaders.damage.program );
    glUniform1f( shaders.damage.damage_strength, damage_strength );
-   glUseProgram( 0 );
+   gl_useProgram( 0 );
 
    gl_checkErr();
 }
@@ -682,6 +816,7 @@ Trail_spfx* spfx_trail_create( const TrailSpec* spec )
    trail->refcount   = 1;
    trail->r          = RNGF();
    trail->ontop      = 0;
+   spfx_trail_vboInit( trail );
 
    if ( trail_spfx_stack == NULL )
       trail_spfx_stack = array_create( Trail_spfx* );
@@ -731,6 +866,103 @@ static void spfx_trail_update( Trail_spfx* trail, double dt )
    trail->dt += dt;
 }
 
+/**
+ * @brief (Re)creates a trail's VBO and uploads all of its current points.
+ *
+ * The VBO has one extra point slot at the end mirroring slot 0, so a range
+ * wrapping around the ring buffer can be drawn as two contiguous strips.
+ *
+ *    @param trail Trail whose VBO to create.
+ */
+static void spfx_trail_vboInit( Trail_spfx* trail )
+{
+   gl_vboDestroy( trail->vbo );
+   trail->vbo = gl_vboCreateDynamic( (trail->capacity+1) * 2 * sizeof(TrailVertex), NULL );
+   for (size_t i=trail->iread; i < trail->iwrite; i++)
+      spfx_trail_vboWrite( trail, i );
+}
+
+/**
+ * @brief Uploads a single trail point to its slot in the trail's VBO.
+ *
+ * The point's timer is not stored; the vertex shader rebuilds it from the
+ * emission time and the trail timer, so points need no per-frame updates.
+ *
+ *    @param trail Trail the point belongs to.
+ *    @param i Index of the point in the ring buffer (not reduced modulo capacity).
+ */
+static void spfx_trail_vboWrite( Trail_spfx* trail, size_t i )
+{
+   TrailVertex v[2];
+   const TrailPoint *tp  = &trail_at( trail, i );
+   const TrailStyle *s   = &trail->spec->style[ tp->mode ];
+   size_t slot           = i & (trail->capacity-1);
+
+   v[0].x     = tp->x;
+   v[0].y     = tp->y;
+   v[0].nx    = tp->nx;
+   v[0].ny    = tp->ny;
+   v[0].r     = s->col.r;
+   v[0].g     = s->col.g;
+   v[0].b     = s->col.b;
+   v[0].a     = (tp->mode == MODE_NONE) ? 0. : s->col.a;
+   v[0].birth = trail->dt + (tp->t - 1.) * trail->spec->ttl;
+   v[0].thick = (tp->mode == MODE_NONE) ? 0. : s->thick;
+   v[0].len   = tp->len;
+   v[0].side  = -1.;
+   v[1]       = v[0];
+   v[1].side  = 1.;
+
+   gl_vboSubData( trail->vbo, slot * 2 * sizeof(TrailVertex), sizeof(v), v );
+   /* Keep the wrap-around copy of slot 0 in sync. */
+   if (slot == 0)
+      gl_vboSubData( trail->vbo, trail->capacity * 2 * sizeof(TrailVertex), sizeof(v), v );
+}
+
+/**
+ * @brief Whether a new sample deviates from the straight, steady
+ *        extrapolation of the last two control points.
+ *
+ *    @param trail Trail the sample belongs to.
+ *    @param p Candidate control point (fields already computed).
+ *    @return 1 if a control point should be emitted at the base rate.
+ */
+static int spfx_trail_deviates( const Trail_spfx *trail, const TrailPoint *p )
+{
+   const TrailPoint *last, *prev;
+   double ux,uy, vx,vy, lu, lv, su, sv;
+
+   if (trail_size(trail) < 3)
+      return 1; /* Not enough history to extrapolate. */
+   last = &trail_at( trail, trail->iwrite-2 );
+   prev = &trail_at( trail, trail->iwrite-3 );
+   if (p->mode != last->mode)
+      return 1; /* Style changes must become visible right away. */
+
+   ux = last->x - prev->x;
+   uy = last->y - prev->y;
+   vx = p->x - last->x;
+   vy = p->y - last->y;
+   lu = hypot( ux, uy );
+   lv = hypot( vx, vy );
+   if ((lu <= 0.) || (lv <= 0.))
+      return (lu != lv); /* Starting or stopping deviates; idling does not. */
+
+   /* Heading delta. */
+   if (fabs( ux*vy - uy*vx ) > TRAIL_DEV_ANGLE * lu * lv)
+      return 1;
+   if (ux*vx + uy*vy < 0.)
+      return 1; /* Reversals always deviate. */
+
+   /* Speed delta, from the timestamps the points carry. */
+   su = lu / MAX( 1e-8, last->t - prev->t );
+   sv = lv / MAX( 1e-8, p->t - last->t );
+   if (fabs( su - sv ) > TRAIL_DEV_SPEED * MAX( su, sv ))
+      return 1;
+
+   return 0;
+}
+
 /**
  * @brief Makes a trail grow.
  *
@@ -752,12 +984,53 @@ void spfx_trail_sample( Trail_spfx* trail, double x, double y, TrailMode mode, i
    p.t = 1.;
    p.mode = mode;
 
+   /* Compute the data the vertex shader expands the trail from, relative to
+    * the previous control point. */
+   if (trail_size(trail) > 1) {
+      TrailPoint *prev = &trail_at( trail, trail->iwrite-2 );
+      double dx  = x - prev->x;
+      double dy  = y - prev->y;
+      double s   = hypot( dx, dy );
+      p.len = prev->len + s;
+      if (s > 0.) {
+         p.nx = -dy / s;
+         p.ny =  dx / s;
+         /* Backfill points emitted before the trail had a direction. */
+         if ((prev->nx == 0.) && (prev->ny == 0.)) {
+            prev->nx = p.nx;
+            prev->ny = p.ny;
+            spfx_trail_vboWrite( trail, trail->iwrite-2 );
+         }
+      }
+      else {
+         p.nx = prev->nx;
+         p.ny = prev->ny;
+      }
+   }
+   else {
+      p.len = 0.;
+      p.nx  = 0.;
+      p.ny  = 0.;
+   }
+
    /* The "back" of the trail should always reflect our most recent state.  */
    trail_back( trail ) = p;
+   if (trail_size(trail) > 0)
+      spfx_trail_vboWrite( trail, trail->iwrite-1 );
 
    /* We may need to insert a control point, but not if our last sample was recent enough. */
-   if (!force && trail_size(trail) > 1 && trail_at( trail, trail->iwrite-2 ).t >= 1.-TRAIL_UPDATE_DT)
-      return;
+   if (!force && trail_size(trail) > 1) {
+      const TrailPoint *last = &trail_at( trail, trail->iwrite-2 );
+      if (last->t >= 1.-TRAIL_UPDATE_DT)
+         return;
+      /* Straight, steady stretches emit control points at a far lower
+       * rate: the floating back point keeps tracking the emitter, so the
+       * skipped samples collapse into one long segment instead of piling
+       * up collinear points with flight time. */
+      if ((last->t >= 1.-MIN( TRAIL_UPDATE_MAXDT, trail->spec->ttl/8. )) &&
+            !spfx_trail_deviates( trail, &p ))
+         return;
+   }
 
    /* If the last time we inserted a control point was recent enough, we don't need a new one. */
    if (trail_size(trail) == trail->capacity) {
@@ -767,8 +1040,11 @@ void spfx_trail_sample( Trail_spfx* trail, double x, double y, TrailMode mode, i
       trail->iwrite = trail->iread + trail->capacity;
       memmove( &trail->point_ringbuf[trail->capacity], trail->point_ringbuf, trail->iread * sizeof(TrailPoint) );
       trail->capacity *= 2;
+      /* The ring layout changed, so the GPU mirror must be rebuilt. */
+      spfx_trail_vboInit( trail );
    }
    trail_at( trail, trail->iwrite++ ) = p;
+   spfx_trail_vboWrite( trail, trail->iwrite-1 );
 }
 
 /**
@@ -788,85 +1064,72 @@ void spfx_trail_remove( Trail_spfx* trail )
 static void spfx_trail_free( Trail_spfx* trail )
 {
    assert(trail->refcount == 0);
+   gl_vboDestroy( trail->vbo );
    free(trail->point_ringbuf);
    free(trail);
 }
 
 /**
  * @brief Draws a trail on screen.
+ *
+ * The geometry lives in the trail's VBO and is expanded by the vertex shader,
+ * so this only sets the trail-wide uniforms and issues one draw per
+ * contiguous range of the ring buffer.
  */
 void spfx_trail_draw( const Trail_spfx* trail )
 {
-   double x1, y1, x2, y2, z;
-   const TrailStyle *sp, *spp, *styles;
-   size_t n;
-   GLfloat len;
+   double cx, cy, gx, gy, z;
    mat4 projection;
-   double s;
+   size_t r, w;
 
-   n = trail_size(trail);
-   if (n==0)
+   if (trail_size(trail) < 2)
       return;
-   styles = trail->spec->style;
 
-   /* Stuff that doesn't change for the entire trail. */
-   glUseProgram( shaders.trail.program );
+   /* Build the game-to-screen transformation (see gl_gameToScreenCoords()). */
+   cam_getPos( &cx, &cy );
+   z = cam_getZoom();
+   gui_getOffset( &gx, &gy );
+   projection = gl_view_matrix;
+   mat4_translate( &projection, gx + SCREEN_W/2., gy + SCREEN_H/2., 0. );
+   mat4_scale( &projection, z, z, 1. );
+   mat4_translate( &projection, -cx, -cy, 0. );
+
+   gl_useProgram( shaders.trail.program );
    if (gl_has( OPENGL_SUBROUTINES ))
       glUniformSubroutinesuiv( GL_FRAGMENT_SHADER, 1, &trail->spec->type );
+
    glEnableVertexAttribArray( shaders.trail.vertex );
-   gl_vboActivateAttribOffset( gl_squareVBO, shaders.trail.vertex, 0, 2, GL_FLOAT, 0 );
+   glEnableVertexAttribArray( shaders.trail.vertex_color );
+   glEnableVertexAttribArray( shaders.trail.vertex_data );
+   gl_vboActivateAttribOffset( trail->vbo, shaders.trail.vertex,
+         offsetof(TrailVertex,x), 4, GL_FLOAT, sizeof(TrailVertex) );
+   gl_vboActivateAttribOffset( trail->vbo, shaders.trail.vertex_color,
+         offsetof(TrailVertex,r), 4, GL_FLOAT, sizeof(TrailVertex) );
+   gl_vboActivateAttribOffset( trail->vbo, shaders.trail.vertex_data,
+         offsetof(TrailVertex,birth), 4, GL_FLOAT, sizeof(TrailVertex) );
+
+   gl_uniformMat4( shaders.trail.projection, &projection );
    glUniform1f( shaders.trail.dt, trail->dt );
+   glUniform1f( shaders.trail.ttl, trail->spec->ttl );
    glUniform1f( shaders.trail.r, trail->r );
-
-   z   = cam_getZoom();
-   len = 0.;
-   for (size_t i=trail->iread + 1; i < trail->iwrite; i++) {
-      TrailPoint *tp  = &trail_at( trail, i );
-      TrailPoint *tpp = &trail_at( trail, i-1 );
-
-      /* Ignore none modes. */
-      if (tp->mode == MODE_NONE || tpp->mode == MODE_NONE)
-         continue;
-
-      gl_gameToScreenCoords( &x1, &y1,  tp->x,  tp->y );
-      gl_gameToScreenCoords( &x2, &y2, tpp->x, tpp->y );
-
-      s = hypot( x2-x1, y2-y1 );
-
-      /* Make sure in bounds. */
-      if ((MAX(x1,x2) < 0.) || (MIN(x1,x2) > (double)SCREEN_W) ||
-         (MAX(y1,y2) < 0.) || (MIN(y1,y2) > (double)SCREEN_H)) {
-         len += s;
-         continue;
-      }
-
-      sp  = &styles[tp->mode];
-      spp = &styles[tpp->mode];
-
-      /* Set vertex. */
-      projection = gl_view_matrix;
-      mat4_translate( &projection, x1, y1, 0. );
-      mat4_rotate2dv( &projection, (x2-x1)/s, (y2-y1)/s );
-      mat4_scale( &projection, s, z*(sp->thick+spp->thick), 1. );
-      mat4_translate( &projection, 0., -0.5, 0. );
-
-      /* Set uniforms. */
-      gl_uniformMat4(shaders.trail.projection, &projection);
-      gl_uniformColor(shaders.trail.c1, &sp->col);
-      gl_uniformColor(shaders.trail.c2, &spp->col);
-      glUniform1f(shaders.trail.t1, tp->t);
-      glUniform1f(shaders.trail.t2, tpp->t);
-      glUniform2f(shaders.trail.pos2, len, sp->thick);
-      len += s;
-      glUniform2f(shaders.trail.pos1, len, spp->thick);
-
-      /* Draw. */
-      glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   glUniform1f( shaders.trail.zoom, z );
+
+   /* A wrapped range is drawn as two strips; the first one runs through the
+    * copy of slot 0 at the end of the VBO. */
+   r = trail->iread & (trail->capacity-1);
+   w = (trail->iwrite-1) & (trail->capacity-1);
+   if (r <= w)
+      glDrawArrays( GL_TRIANGLE_STRIP, 2*r, 2*(w-r+1) );
+   else {
+      glDrawArrays( GL_TRIANGLE_STRIP, 2*r, 2*(trail->capacity-r+1) );
+      glDrawArrays( GL_TRIANGLE_STRIP, 0, 2*(w+1) );
    }
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.trail.vertex );
-   glUseProgram(0);
+   glDisableVertexAttribArray( shaders.trail.vertex_color );
+   glDisableVertexAttribArray( shaders.trail.vertex_data );
+   gl_useProgram(0);
 
    /* Check errors. */
    gl_checkErr();
@@ -1001,8 +1264,7 @@ void spfx_cinematic (void)
 void spfx_render( int layer )
 {
    SPFX *spfx_stack;
-   int sx, sy;
-   double time;
+   int sx;
 
    /* get the appropriate layer */
    switch (layer) {
@@ -1057,7 +1319,8 @@ void spfx_render( int layer )
             continue;
 
          /* Let's get to business. */
-         glUseProgram( effect->shader );
+         gl_renderSpriteBatchFlush();
+         gl_useProgram( effect->shader );
 
          /* Set up the vertex. */
          projection = gl_view_matrix;
@@ -1082,28 +1345,29 @@ void spfx_render( int layer )
          /* anything failed? */
          gl_checkErr();
 
-         glUseProgram(0);
+         gl_useProgram(0);
 
       }
       /* No shader. */
       else {
          /* Simplifies */
          sx = (int)effect->gfx->sx;
-         sy = (int)effect->gfx->sy;
 
-         if (!paused) { /* don't calculate frame if paused */
-            time = 1. - fmod(spfx_stack[i].timer,effect->anim) / effect->anim;
-            spfx_stack[i].lastframe = sx * sy * MIN(time, 1.);
-         }
+         /* The frame is precomputed by the update worker (and thus
+          * naturally frozen while paused), so rendering doesn't write
+          * into a layer the worker may be reading. */
 
          /* Renders */
-         gl_renderSprite( effect->gfx,
+         gl_renderSpriteBatch( effect->gfx,
                VX(spfx_stack[i].pos), VY(spfx_stack[i].pos),
                spfx_stack[i].lastframe % sx,
                spfx_stack[i].lastframe / sx,
                NULL );
       }
    }
+
+   /* Submit whatever quads are still queued. */
+   gl_renderSpriteBatchFlush();
 }
 
 /**
@@ -53,6 +53,8 @@ typedef struct TrailSpec_ {
 typedef struct TrailPoint {
    GLfloat x, y;     /**< Control points for the trail. */
    GLfloat t;        /**< Timer, normalized to the time to live of the trail (starts at 1, ends at 0). */
+   GLfloat len;      /**< Arc length from the start of the trail to this point. */
+   GLfloat nx, ny;   /**< Unit normal the vertex shader expands the trail along. */
    TrailMode mode;   /**< Type of trail emission at this point. */
 } TrailPoint;
 
@@ -64,6 +66,7 @@ typedef struct TrailPoint {
 typedef struct Trail_spfx_ {
    const TrailSpec *spec;
    TrailPoint *point_ringbuf; /**< Circular buffer (malloced/freed) of trail points. */
+   gl_vbo *vbo;      /**< GPU mirror of the ring buffer, two vertices per point. */
    size_t capacity;  /**< Buffer size, guaranteed to be a power of 2. */
    size_t iread;     /**< Start index (NOT reduced modulo capacity). */
    size_t iwrite;    /**< End index (NOT reduced modulo capacity). */
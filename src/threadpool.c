@@ -4,21 +4,13 @@
 /*
  * @brief A simple threadpool implementation using a single queue.
  *
- * The queue is inspired by this paper (look for the queue with two locks):
- *
- * Maged M. Michael and Michael L. Scott. 1998. Nonblocking algorithms and
- * preemption-safe locking on multiprogrammed shared memory multiprocessors. J.
- * Parallel Distrib. Comput. 51, 1 (May 1998), 1-26. DOI=10.1006/jpdc.1998.1446
- * http://dx.doi.org/10.1006/jpdc.1998.1446
- *
- * @ARTICLE{Michael98non-blockingalgorithms,
- *    author = {Maged M. Michael and Michael L. Scott},
- *    title = {Non-Blocking Algorithms and Preemption-Safe Locking on Multiprogrammed Shared Memory Multiprocessors},
- *    journal = {Journal of Parallel and Distributed Computing},
- *    year = {1998},
- *    volume = {51},
- *    pages = {1--26},
- * }
+ * The queue is a lock-free multi-producer single-consumer linked list in
+ * the style of Vyukov's intrusive MPSC queue: producers atomically swap
+ * themselves in at the tail and consumers chase the next pointers from a
+ * dummy head. Every queue here (global job queue, idle/stopped worker
+ * queues, vpools) has exactly one consumer, so the single-consumer
+ * restriction costs nothing. A semaphore still counts the elements so
+ * consumers can block instead of spinning.
  *
  * @note The algorithm/strategy for killing idle workers should be moved into
  *       the threadhandler and it should also be improved (the current strategy
@@ -29,6 +21,7 @@
 /** @cond */
 #include <stdlib.h>
 #include "SDL.h"
+#include "SDL_atomic.h"
 #include "SDL_error.h"
 #include "SDL_thread.h"
 /** @endcond */
@@ -61,12 +54,10 @@ typedef struct Node_ {
  * @brief Threadqueue itself.
  */
 struct ThreadQueue_ {
-   Node *first;         /* The first node */
-   Node *last;          /* The second node */
+   Node *first;         /* Dummy head; only the (single) consumer touches it. */
+   void *last;          /* Tail; producers swap themselves in atomically. */
    /* A semaphore to ensure reads only happen when the queue is not empty */
    SDL_sem *semaphore;
-   SDL_mutex *t_lock;   /* Tail lock. Lock when reading/updating tail */
-   SDL_mutex *h_lock;   /* Same as tail lock, except it's head lock */
 };
 
 /**
@@ -101,8 +92,10 @@ typedef struct vpoolThreadData_ {
    ThreadQueueData *node;  /* The job to be done */
 } vpoolThreadData;
 
-/* The global threadpool queue */
-static ThreadQueue *global_queue = NULL;
+/* The global job lanes, one queue per priority, plus one semaphore
+ * counting jobs across all of them for the handler to block on. */
+static ThreadQueue *global_queues[ THREADPOOL_PRIORITY_MAX ];
+static SDL_sem *global_sem = NULL;
 
 
 /*
@@ -140,44 +133,39 @@ static ThreadQueue* tq_create (void)
    q->first = n;
    q->last  = n;
 
-   /* Create locks. */
-   q->t_lock      = SDL_CreateMutex();
-   q->h_lock      = SDL_CreateMutex();
-   q->semaphore   = SDL_CreateSemaphore( 0 );
+   q->semaphore = SDL_CreateSemaphore( 0 );
 
    return q;
 }
 
 /**
- * @brief Enqueue data to the ThreadQueue q.
+ * @brief Enqueue data to the ThreadQueue q. Safe from any thread.
  *
  *    @param q The queue to be inserted into.
  *    @param data The element to be stored in the queue.
  */
 static void tq_enqueue( ThreadQueue *q, void *data )
 {
-   Node *n;
+   Node *n, *prev;
 
    /* Allocate new struct. */
    n        = calloc( 1, sizeof(Node) );
    n->data  = data;
    n->next  = NULL;
 
-   /* Lock */
-   SDL_mutexP( q->t_lock );
-
-   /* Enqueue. */
-   q->last->next  = n;
-   q->last        = n;
+   /* Swap ourselves in at the tail, then link the old tail to us. Between
+    * the two steps the queue is briefly unlinked; the consumer spins for
+    * the link since the semaphore already promised it an element. */
+   prev = SDL_AtomicSetPtr( &q->last, n );
+   SDL_AtomicSetPtr( (void**) &prev->next, n );
 
-   /* Signal and unlock. This wil break if someone tries to enqueue 2^32+1
+   /* Signal. This wil break if someone tries to enqueue 2^32+1
     * elements or something. */
    SDL_SemPost( q->semaphore );
-   SDL_mutexV( q->t_lock );
 }
 
 /**
- * @brief Dequeue from the ThreadQueue q.
+ * @brief Dequeue from the ThreadQueue q. Single consumer only.
  *
  * @attention The callee should ALWAYS have called SDL_SemWait() on the semaphore.
  *
@@ -189,35 +177,18 @@ static void* tq_dequeue( ThreadQueue *q )
    void *d;
    Node *newhead, *node;
 
-   /* Lock the head. */
-   SDL_mutexP( q->h_lock );
-
-   /* Start running. */
    node     = q->first;
-   newhead  = node->next;
+   newhead  = SDL_AtomicGetPtr( (void**) &node->next );
 
-   /* Head not consistent. */
-   if (newhead == NULL) {
-      WARN(_("Tried to dequeue while the queue was empty!"));
-      /* Ugly fix :/ */
-      /*
-      SDL_mutexV(q->h_lock);
-      return NULL;
-      */
-      /* We prefer to wait until the cache updates :/ */
-      do {
-         node     = q->first;
-         newhead  = node->next;
-      } while (newhead == NULL);
-   }
+   /* The semaphore guarantees an element was pushed, but the producer may
+    * not have linked it yet; wait for the pointer to land. */
+   while (newhead == NULL)
+      newhead = SDL_AtomicGetPtr( (void**) &node->next );
 
    /* Remember the value and assign newhead as the new dummy element. */
    d        = newhead->data;
    q->first = newhead;
 
-   /* Unlock */
-   SDL_mutexV( q->h_lock );
-
    free( node );
    return d;
 }
@@ -232,14 +203,10 @@ static void* tq_dequeue( ThreadQueue *q )
 static void tq_destroy( ThreadQueue *q )
 {
    /* Iterate through the list and free the nodes */
-   while (q->first->next != NULL)
-      free( tq_dequeue(q) ); /* Locks q->t_lock, so we must destroy mutex after. */
+   while (SDL_SemTryWait( q->semaphore ) == 0)
+      free( tq_dequeue(q) );
 
-   /* Clean up threading structures. */
    SDL_DestroySemaphore( q->semaphore );
-   SDL_DestroyMutex( q->h_lock );
-   SDL_DestroyMutex( q->t_lock );
-
    free( q->first );
    free( q );
 }
@@ -256,10 +223,27 @@ static void tq_destroy( ThreadQueue *q )
  *    @return Returns 0 on success and -2 if there was no threadpool.
  */
 int threadpool_newJob( int (*function)(void *), void *data )
+{
+   return threadpool_newJobPriority( function, data, THREADPOOL_PRIORITY_ASYNC );
+}
+
+/**
+ * @brief Enqueues a new job for the threadpool in an explicit priority lane.
+ *
+ * Same deadlock warning as threadpool_newJob. Critical jobs get picked
+ *  before async ones, which get picked before bulk ones; see
+ *  threadpool_handler for the anti-starvation scan.
+ *
+ *    @param function The function (job) to be called (executed).
+ *    @param data The arguments for the function.
+ *    @param priority Lane to enqueue in.
+ *    @return Returns 0 on success and -2 if there was no threadpool.
+ */
+int threadpool_newJobPriority( int (*function)(void *), void *data, ThreadPriority priority )
 {
    ThreadQueueData *node;
 
-   if (global_queue == NULL) {
+   if (global_sem == NULL) {
       WARN(_("Threadpool has not been initialized yet!"));
       return -2;
    }
@@ -270,7 +254,8 @@ int threadpool_newJob( int (*function)(void *), void *data )
    node->function = function;
 
    /* Actually enque. */
-   tq_enqueue( global_queue, node );
+   tq_enqueue( global_queues[priority], node );
+   SDL_SemPost( global_sem );
 
    return 0;
 }
@@ -338,6 +323,7 @@ static int threadpool_handler( void *data )
 {
    (void) data;
    int i, nrunning, newthread;
+   unsigned int dispatched;
    ThreadData *threadargs, *threadarg;
    /* Queues for idle workers and stopped workers */
    ThreadQueue *idle, *stopped;
@@ -364,6 +350,7 @@ static int threadpool_handler( void *data )
 
    /* Set the number of running threads to 0 */
    nrunning = 0;
+   dispatched = 0;
 
    /*
     * Thread handler main loop.
@@ -379,7 +366,7 @@ static int threadpool_handler( void *data )
           * Here we'll wait until thread gets work to do. If it doesn't it will
           * just stop a worker thread and wait until it gets something to do.
           */
-         if (SDL_SemWaitTimeout( global_queue->semaphore, THREADPOOL_TIMEOUT ) != 0) {
+         if (SDL_SemWaitTimeout( global_sem, THREADPOOL_TIMEOUT ) != 0) {
             /* There weren't any new jobs so we'll start killing threads ;) */
             if (SDL_SemTryWait( idle->semaphore ) == 0) {
                threadarg         = tq_dequeue( idle );
@@ -401,7 +388,7 @@ static int threadpool_handler( void *data )
           * Here we wait for a new job. No threads are alive at this point and the
           * threadpool is just patiently waiting for work to arrive.
           */
-         if (SDL_SemWait( global_queue->semaphore ) == -1) {
+         if (SDL_SemWait( global_sem ) == -1) {
              WARN(_("SDL_SemWait failed! Error: %s"), SDL_GetError());
              continue;
          }
@@ -410,10 +397,27 @@ static int threadpool_handler( void *data )
       }
 
       /*
-       * Get a new job from the queue. This should be safe as we have received
-       * a permission from the global_queue->semaphore.
+       * Claim a job from the lanes. This should be safe as we have received
+       * a permission from global_sem, so at least one lane is non-empty.
+       * Normally the highest-priority lane wins, but every fourth dispatch
+       * scans backwards so a sustained stream of critical jobs can not
+       * starve the bulk lane.
        */
-      node        = tq_dequeue( global_queue );
+      node = NULL;
+      dispatched++;
+      if ((dispatched & 3) == 0) {
+         for (i=THREADPOOL_PRIORITY_MAX-1; i>=0; i--)
+            if (SDL_SemTryWait( global_queues[i]->semaphore ) == 0) {
+               node = tq_dequeue( global_queues[i] );
+               break;
+            }
+      }
+      if (node == NULL)
+         for (i=0; i<THREADPOOL_PRIORITY_MAX; i++)
+            if (SDL_SemTryWait( global_queues[i]->semaphore ) == 0) {
+               node = tq_dequeue( global_queues[i] );
+               break;
+            }
       newthread   = 0;
 
       /*
@@ -475,13 +479,15 @@ int threadpool_init (void)
    MAXTHREADS = SDL_GetCPUCount() + 1; /* SDL 1.3 is pretty cool. */
 
    /* There's already a queue */
-   if (global_queue != NULL) {
+   if (global_sem != NULL) {
       WARN(_("Threadpool has already been initialized!"));
       return -1;
    }
 
-   /* Create the global queue queue */
-   global_queue = tq_create();
+   /* Create the priority lanes. */
+   for (int i=0; i<THREADPOOL_PRIORITY_MAX; i++)
+      global_queues[i] = tq_create();
+   global_sem = SDL_CreateSemaphore( 0 );
 
    /* Initialize the threadpool handler. */
    if ( SDL_CreateThread( threadpool_handler, "threadpool_handler", NULL ) == NULL ) {
@@ -492,6 +498,20 @@ int threadpool_init (void)
    return 0;
 }
 
+/**
+ * @brief Number of workers the pool scales to.
+ *
+ * Subsystems should size their parallelism to this instead of calling
+ *  SDL_GetCPUCount() themselves, so there is one policy for how many
+ *  cores the game claims.
+ *
+ *    @return Worker count (core count derived), at least 1.
+ */
+int threadpool_cores (void)
+{
+   return MAXTHREADS;
+}
+
 /**
  * @brief Creates a new vpool queue.
  *
@@ -612,3 +632,79 @@ void vpool_wait( ThreadQueue *queue )
    tq_destroy( queue );
    free( arg );
 }
+
+/**
+ * @brief Shared state for a vpool_for call.
+ */
+typedef struct vpoolForData_ {
+   void (*function)( int begin, int end, void *data ); /* Range worker. */
+   void *data;          /* User data passed through. */
+   int end;             /* One past the last index. */
+   int chunk;           /* Indices claimed per grab. */
+   SDL_atomic_t next;   /* Next unclaimed index. */
+} vpoolForData;
+
+/**
+ * @brief Worker for vpool_for; grabs chunks until the range is exhausted.
+ */
+static int vpool_forWorker( void *data )
+{
+   vpoolForData *f = data;
+   while (1) {
+      int begin = SDL_AtomicAdd( &f->next, f->chunk );
+      int end   = begin + f->chunk;
+      if (begin >= f->end)
+         break;
+      if (end > f->end)
+         end = f->end;
+      f->function( begin, end, f->data );
+   }
+   return 0;
+}
+
+/**
+ * @brief Runs function over [begin, end) in parallel and blocks until done.
+ *
+ * The range is claimed in chunks off a shared atomic counter, so fast
+ * workers keep grabbing work instead of waiting on a static partition.
+ *
+ * @warning The same deadlock rules as vpool_enqueue apply to function.
+ *
+ *    @param function Called with disjoint [begin, end) subranges.
+ *    @param begin First index of the range.
+ *    @param end One past the last index of the range.
+ *    @param chunk Indices to hand out per grab (minimum 1).
+ *    @param data User data passed to every call.
+ */
+void vpool_for( void (*function)( int begin, int end, void *data ), int begin, int end, int chunk, void *data )
+{
+   vpoolForData f;
+   ThreadQueue *tq;
+   int nworkers;
+
+   if (end <= begin)
+      return;
+   if (chunk < 1)
+      chunk = 1;
+
+   /* Not enough work to be worth the queue round trip. */
+   if (end-begin <= chunk) {
+      function( begin, end, data );
+      return;
+   }
+
+   f.function = function;
+   f.data     = data;
+   f.end      = end;
+   f.chunk    = chunk;
+   SDL_AtomicSet( &f.next, begin );
+
+   nworkers = (end-begin+chunk-1) / chunk;
+   if (nworkers > threadpool_cores())
+      nworkers = threadpool_cores();
+
+   tq = vpool_create();
+   for (int i=0; i<nworkers; i++)
+      vpool_enqueue( tq, vpool_forWorker, &f );
+   vpool_wait( tq ); /* Blocks until done and destroys the queue. */
+}
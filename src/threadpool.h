@@ -17,12 +17,28 @@
 struct ThreadQueue_;
 typedef struct ThreadQueue_ ThreadQueue;
 
+/* Priority lanes for jobs. Workers drain higher lanes first, with
+ * periodic backwards scans so bulk work can not starve. */
+typedef enum ThreadPriority_ {
+   THREADPOOL_PRIORITY_CRITICAL = 0, /* Needed for the current frame, e.g. texture decode. */
+   THREADPOOL_PRIORITY_ASYNC    = 1, /* Default: latency matters but nothing blocks on it. */
+   THREADPOOL_PRIORITY_BULK     = 2, /* Background loading and other throughput work. */
+   THREADPOOL_PRIORITY_MAX      = 3  /* Sentinel. */
+} ThreadPriority;
+
 /* Initializes the threadpool */
 int threadpool_init( void );
 
-/* Enqueues a new job */
+/* Number of workers the pool scales to; subsystems should size their
+ * parallelism (job counts, chunking) to this. */
+int threadpool_cores( void );
+
+/* Enqueues a new job in the async lane */
 int threadpool_newJob( int (*function)(void *), void *data );
 
+/* Enqueues a new job in an explicit priority lane */
+int threadpool_newJobPriority( int (*function)(void *), void *data, ThreadPriority priority );
+
 /* Creates a new vpool queue */
 ThreadQueue* vpool_create( void );
 
@@ -33,3 +49,7 @@ void vpool_enqueue( ThreadQueue* queue, int (*function)(void *), void *data );
 /* Run every job in the vpool queue and block until every job in the queue is
  * done. It destroys the queue when it's done. */
 void vpool_wait( ThreadQueue* queue );
+
+/* Run function over [begin, end) in parallel, handing out chunk-sized
+ * subranges from a shared counter, and block until the range is done. */
+void vpool_for( void (*function)( int begin, int end, void *data ), int begin, int end, int chunk, void *data );
@@ -140,8 +140,8 @@ static void iar_render( Widget* iar, double bx, double by )
 {
    int pos;
    double x,y, w,h, xcurs,ycurs, xspace,yspace;
-   double scroll_pos;
-   int xelem, yelem;
+   double scroll_pos, stride;
+   int xelem, yelem, jfirst, jlast;
    const glColour *dc, *lc;
    const glColour *fontcolour, *bgcolour;
    int is_selected;
@@ -178,11 +178,15 @@ static void iar_render( Widget* iar, double bx, double by )
     * Main drawing loop.
     */
    gl_clipRect( x, y, iar->w, iar->h );
-   for (int j=0; j<yelem; j++) {
+   /* Only lay out the rows that can intersect the viewport, plus one row
+    * of overscan on each side; with hundreds of elements walking the full
+    * grid every frame costs real time. */
+   stride = h + yspace;
+   jfirst = MAX( 0, (int)floor( iar->dat.iar.pos / stride ) - 1 );
+   jlast  = MIN( yelem - 1,
+         (int)floor( (iar->dat.iar.pos + iar->h) / stride ) + 1 );
+   for (int j=jfirst; j<=jlast; j++) {
       ycurs = floor(y + iar->h - (j+1)*(h+yspace) + iar->dat.iar.pos);
-      /*  Skip rows that are wholly outside of the viewport. */
-      if ((ycurs > y + iar->h) || (ycurs + h < y))
-         continue;
 
       for (int i=0; i<xelem; i++) {
          xcurs = floor(x + i * w + (i+.5) * xspace);
@@ -275,13 +279,19 @@ static void iar_renderOverlay( Widget* iar, double bx, double by )
     */
    if ((iar->dat.iar.alt >= 0) &&
          (iar->dat.iar.altx != -1) && (iar->dat.iar.alty != -1)) {
+      ImageArrayCell *cell = &iar->dat.iar.images[ iar->dat.iar.alt ];
 
       /* Calculate position. */
       x = bx + iar->x + iar->dat.iar.altx;
       y = by + iar->y + iar->dat.iar.alty;
 
+      /* Generate the alt text on first hover; building it eagerly for
+       * every cell makes opening large lists stutter. */
+      if ((cell->alt == NULL) && (cell->altfunc != NULL))
+         cell->alt = cell->altfunc( cell->altdata );
+
       /* Draw alt text. */
-      alt = iar->dat.iar.images[iar->dat.iar.alt].alt;
+      alt = cell->alt;
       if (alt != NULL)
          toolkit_drawAltText( x, y, alt );
    }
@@ -10,7 +10,9 @@
 typedef struct ImageArrayCell_ {
    glTexture* image; /**< Image to display. */
    char *caption; /**< Corresponding caption. */
-   char *alt; /**< Corresponding alt text. */
+   char *alt; /**< Corresponding alt text (NULL until generated when altfunc is set). */
+   char* (*altfunc)( const void* ); /**< Generates alt text on first hover; returns malloc'd string. */
+   const void *altdata; /**< Opaque data passed to altfunc. */
    int quantity; /**< Corresponding quantity. */
    glColour bg; /**< Background colour. */
    char *slottype; /**< Type of slot. */
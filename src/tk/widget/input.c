@@ -20,7 +20,11 @@
 #include "font.h"
 
 
+#define INPUT_BLINK_MS  500 /**< Half period of the caret blink. */
+
 static void inp_render( Widget* inp, double bx, double by );
+static void inp_renderOverlay( Widget* inp, double bx, double by );
+static void inp_layoutCaret( Widget *inp );
 static int inp_isBreaker(char c);
 static int inp_key( Widget* inp, SDL_Keycode key, SDL_Keymod mod );
 static int inp_text( Widget* inp, const char *buf );
@@ -65,6 +69,7 @@ void window_addInput( unsigned int wid,
 
    /* specific */
    wgt->render          = inp_render;
+   wgt->renderOverlay   = inp_renderOverlay;
    wgt->cleanup         = inp_cleanup;
    wgt_setFlag(wgt, WGT_FLAG_CANFOCUS);
    wgt->keyevent        = inp_key;
@@ -77,6 +82,11 @@ void window_addInput( unsigned int wid,
    wgt->dat.inp.oneline = oneline;
    wgt->dat.inp.pos     = 0;
    wgt->dat.inp.view    = 0;
+   wgt->dat.inp.caret_w          = 0;
+   wgt->dat.inp.caret_line       = 1;
+   wgt->dat.inp.caret_scan       = 0;
+   wgt->dat.inp.caret_scan_line  = 0;
+   wgt->dat.inp.caret_dirty      = 1;
    wgt->dat.inp.input   = calloc( wgt->dat.inp.byte_max, 1 ); /* Maximum length of a unicode character is 4 bytes. */
    wgt->dat.inp.fptr    = NULL;
 
@@ -98,9 +108,6 @@ static void inp_render( Widget* inp, double bx, double by )
 {
    double x, y, ty;
    char *str;
-   int s;
-   size_t p, w;
-   int lines;
    const glColour *col;
 
    x = bx + inp->x;
@@ -134,39 +141,8 @@ static void inp_render( Widget* inp, double bx, double by )
             x+5., ty, 0, col, -1., str );
    }
 
-   /* Draw cursor. */
-   if (wgt_isFlag( inp, WGT_FLAG_FOCUSED )) {
-      if (inp->dat.inp.oneline) {
-         w = inp_rangeToWidth( inp, inp->dat.inp.view, inp->dat.inp.pos );
-         toolkit_drawRect( x + 5. + w, y + (inp->h - inp->dat.inp.font->h - 4.)/2.,
-               1., inp->dat.inp.font->h + 4., &cGreen, &cGreen );
-      }
-      else {
-         /* Wrap the cursor around if the text is longer than the width of the widget. */
-         str   = inp->dat.inp.input;
-         w     = 0;
-         p     = 0;
-         lines = 0;
-         s     = 0;
-         do {
-            p     += w;
-            if ((s != 0) && ((str[p] == '\n') || (str[p] == ' ')))
-               p++;
-            s      = 1;
-            w      = inp_rangeFromWidth( inp, p, -1 );
-            lines += 1;
-            if (str[p+w] == '\0')
-               break;
-         } while (p+w < inp->dat.inp.pos);
-
-         /* On the final line, no word-wrap is possible. */
-         w = inp_rangeToWidth( inp, p, inp->dat.inp.pos );
-
-         /* Get the actual width now. */
-         toolkit_drawRect( x + 5. + w, y + inp->h - lines * (inp->dat.inp.font->h + 5) - 3.,
-               1., inp->dat.inp.font->h + 4., &cGreen, &cGreen );
-      }
-   }
+   /* Cursor is drawn live in inp_renderOverlay so blinking does not
+    * invalidate the window cache. */
 
    /* inner outline */
    /* toolkit_drawOutline( x, y, inp->w, inp->h, 0.,
@@ -177,6 +153,102 @@ static void inp_render( Widget* inp, double bx, double by )
 }
 
 
+/**
+ * @brief Recomputes the cached caret position if it is stale.
+ *
+ * Word-wrap is forward greedy, so line starts before the edit point are
+ * stable; the scan resumes from the last known caret line start instead of
+ * re-shaping the whole buffer on every keystroke.
+ *
+ *    @param inp Input widget to lay the caret out for.
+ */
+static void inp_layoutCaret( Widget *inp )
+{
+   char *str;
+   size_t p, w, prev;
+   int lines, prev_lines;
+
+   if (!inp->dat.inp.caret_dirty)
+      return;
+   inp->dat.inp.caret_dirty = 0;
+
+   if (inp->dat.inp.oneline) {
+      inp->dat.inp.caret_line = 1;
+      inp->dat.inp.caret_w = inp_rangeToWidth( inp, inp->dat.inp.view, inp->dat.inp.pos );
+      return;
+   }
+
+   /* Resume only if the caret is still at or past the cached line start. */
+   if (inp->dat.inp.caret_scan > inp->dat.inp.pos) {
+      inp->dat.inp.caret_scan       = 0;
+      inp->dat.inp.caret_scan_line  = 0;
+   }
+
+   /* Wrap the cursor around if the text is longer than the width of the widget. */
+   str        = inp->dat.inp.input;
+   p          = inp->dat.inp.caret_scan;
+   lines      = inp->dat.inp.caret_scan_line;
+   prev       = p;
+   prev_lines = lines;
+   while (1) {
+      w      = inp_rangeFromWidth( inp, p, -1 );
+      lines += 1;
+      if ((str[p+w] == '\0') || (p+w >= inp->dat.inp.pos))
+         break;
+      prev       = p;
+      prev_lines = lines-1;
+      p += w;
+      if ((str[p] == '\n') || (str[p] == ' '))
+         p++;
+   }
+
+   /* Resume one line early next time: an edit at the caret can pull its
+    * first word up into the line above, so that line must be re-wrapped. */
+   inp->dat.inp.caret_scan       = prev;
+   inp->dat.inp.caret_scan_line  = prev_lines;
+
+   /* On the final line, no word-wrap is possible. */
+   inp->dat.inp.caret_line = lines;
+   inp->dat.inp.caret_w    = inp_rangeToWidth( inp, p, inp->dat.inp.pos );
+}
+
+
+/**
+ * @brief Renders the input widget caret.
+ *
+ * Drawn as an overlay so it stays live on top of the cached window texture;
+ * a blink only redraws this rect, never the text.
+ *
+ *    @param inp Input widget to render the caret of.
+ *    @param bx Base X position.
+ *    @param by Base Y position.
+ */
+static void inp_renderOverlay( Widget* inp, double bx, double by )
+{
+   double x, y;
+
+   if (!wgt_isFlag( inp, WGT_FLAG_FOCUSED ))
+      return;
+
+   /* Blink phase where the caret is hidden. */
+   if ((SDL_GetTicks() / INPUT_BLINK_MS) & 1)
+      return;
+
+   inp_layoutCaret( inp );
+
+   x = bx + inp->x;
+   y = by + inp->y;
+   if (inp->dat.inp.oneline)
+      toolkit_drawRect( x + 5. + inp->dat.inp.caret_w,
+            y + (inp->h - inp->dat.inp.font->h - 4.)/2.,
+            1., inp->dat.inp.font->h + 4., &cGreen, &cGreen );
+   else
+      toolkit_drawRect( x + 5. + inp->dat.inp.caret_w,
+            y + inp->h - inp->dat.inp.caret_line * (inp->dat.inp.font->h + 5) - 3.,
+            1., inp->dat.inp.font->h + 4., &cGreen, &cGreen );
+}
+
+
 /**
  * @brief Handles input text.
  *
@@ -470,6 +542,7 @@ static int inp_key( Widget* inp, SDL_Keycode key, SDL_Keymod mod )
             inp->dat.inp.byte_max-1 - inp->dat.inp.pos - 1 );
       inp->dat.inp.input[ inp->dat.inp.pos++ ] = '\n';
       assert(inp->dat.inp.input[ inp->dat.inp.byte_max-1 ] == '\0');
+      inp->dat.inp.caret_dirty = 1;
 
       if (inp->dat.inp.fptr != NULL)
          inp->dat.inp.fptr( inp->wdw, inp->name );
@@ -537,6 +610,10 @@ static void inp_clampView( Widget *inp )
 {
    size_t v;
 
+   /* All the edit paths come through here, so this doubles as the caret
+    * layout invalidation point. */
+   inp->dat.inp.caret_dirty = 1;
+
    /* @todo Handle multiline input widgets. */
    if (!inp->dat.inp.oneline)
       return;
@@ -623,6 +700,11 @@ const char* window_setInput( unsigned int wid, const char* name, const char *msg
       wgt->dat.inp.pos = strlen( wgt->dat.inp.input );
    }
 
+   /* The whole buffer may have changed; restart the caret scan. */
+   wgt->dat.inp.caret_scan       = 0;
+   wgt->dat.inp.caret_scan_line  = 0;
+   wgt->dat.inp.caret_dirty      = 1;
+
    /* Get the value. */
    if (wgt->dat.inp.fptr != NULL)
       wgt->dat.inp.fptr( wid, name );
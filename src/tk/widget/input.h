@@ -17,6 +17,11 @@ typedef struct WidgetInputData_ {
    size_t byte_max; /**< Byte size of the buffer. */
    size_t view; /**< View position. */
    size_t pos; /**< Cursor position. */
+   int caret_w; /**< Cached caret x offset from the text origin (pixels). */
+   int caret_line; /**< Cached caret line number (1-based; 1 in one-liners). */
+   size_t caret_scan; /**< Line start the caret layout can resume from. */
+   int caret_scan_line; /**< Number of lines before caret_scan. */
+   int caret_dirty; /**< Caret layout must be recomputed before rendering. */
    glFont *font; /**< Font to use. */
    void (*fptr) (unsigned int,const char*); /**< Modify callback - triggered on text input. */
 } WidgetInputData;
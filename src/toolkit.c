@@ -67,6 +67,17 @@ const glColour* tab_background= &cBlack; /**< Dark outline colour. */
 static gl_vbo *toolkit_vbo; /**< Toolkit VBO. */
 static GLsizei toolkit_vboColourOffset; /**< Colour offset. */
 
+/*
+ * Damage tracking. When every open window is static (no fades, no custom
+ * widgets) the composited windows are kept in a cache framebuffer and
+ * idle frames just blit it; any state change marks the cache dirty.
+ */
+static int toolkit_needsRender = 1; /**< Whether the window cache is stale. */
+static GLuint toolkit_cacheFBO = GL_INVALID_VALUE; /**< Window cache framebuffer. */
+static GLuint toolkit_cacheTex = GL_INVALID_VALUE; /**< Window cache texture. */
+static GLsizei toolkit_cacheW = 0; /**< Width the cache was created at. */
+static GLsizei toolkit_cacheH = 0; /**< Height the cache was created at. */
+
 /*
  * static prototypes
  */
@@ -144,6 +155,8 @@ void toolkit_setWindowPos( Window *wdw, int x, int y )
    wdw->xrel = -1.;
    wdw->yrel = -1.;
 
+   toolkit_rerender();
+
    window_rmFlag( wdw, WINDOW_CENTERX );
    window_rmFlag( wdw, WINDOW_CENTERY );
 
@@ -203,6 +216,7 @@ void window_resize( unsigned int wid, int w, int h )
 
    wdw->w = (w == -1) ? gl_screen.nw : (double) w;
    wdw->h = (h == -1) ? gl_screen.nh : (double) h;
+   toolkit_rerender();
    if ((w == -1) && (h == -1)) {
       window_setFlag( wdw, WINDOW_FULLSCREEN );
       wdw->x = 0.;
@@ -233,6 +247,8 @@ Widget* window_newWidget( Window* w, const char *name )
    if (w==NULL)
       return NULL;
 
+   toolkit_rerender();
+
    /* Try to find one with the same name first. */
    wlast = NULL;
    for (wgt=w->widgets; wgt!=NULL; wgt=wgt->next) {
@@ -352,10 +368,13 @@ Widget* window_getwgt( unsigned int wid, const char* name )
       return NULL;
    }
 
-   /* Find the widget. */
+   /* Find the widget. Callers are mostly mutators, so conservatively
+    * assume the widget is about to change. */
    for (Widget *wgt=wdw->widgets; wgt!=NULL; wgt=wgt->next)
-      if (strcmp(wgt->name, name)==0)
+      if (strcmp(wgt->name, name)==0) {
+         toolkit_rerender();
          return wgt;
+      }
 
    WARN(_("Widget '%s' not found in window '%u'!"), name, wid );
    return NULL;
@@ -1005,6 +1024,8 @@ void window_handleEvents( unsigned int wid,
  */
 void widget_cleanup( Widget *widget )
 {
+   toolkit_rerender();
+
    /* Type specific clean up. */
    if (widget->cleanup != NULL)
       widget->cleanup(widget);
@@ -1093,6 +1114,7 @@ void window_kill( Window *wdw )
       if (w->parent == wdw->id)
          window_kill( w );
    window_setFlag( wdw, WINDOW_KILL );
+   toolkit_rerender();
 }
 
 /**
@@ -1484,9 +1506,25 @@ static void window_renderBorder( Window* w )
       return;
    }
 
-   toolkit_drawRect( x, y, w->w, w->h, toolkit_col, NULL );
-   toolkit_drawOutlineThick( x, y, w->w, w->h, 1, 2, toolkit_colDark, NULL );
-   toolkit_drawOutline( x + 3, y + 2, w->w - 5, w->h - 5, 1, toolkit_colLight, NULL );
+   /* Background, thick border and inner outline in a single SDF draw;
+    * this used to be three primitive batches per window. */
+   mat4 projection = gl_view_matrix;
+   double hw = w->w/2. + 2.;
+   double hh = w->h/2. + 2.;
+   mat4_translate( &projection, x + w->w/2., y + w->h/2., 0. );
+   mat4_scale( &projection, hw, hh, 1. );
+   gl_useProgram( shaders.window.program );
+   glEnableVertexAttribArray( shaders.window.vertex );
+   gl_vboActivateAttribOffset( gl_circleVBO, shaders.window.vertex, 0, 2, GL_FLOAT, 0 );
+   gl_uniformColor( shaders.window.color, toolkit_col );
+   gl_uniformColor( shaders.window.colour_dark, toolkit_colDark );
+   gl_uniformColor( shaders.window.colour_light, toolkit_colLight );
+   glUniform2f( shaders.window.dimensions, hw, hh );
+   gl_uniformMat4( shaders.window.projection, &projection );
+   glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   glDisableVertexAttribArray( shaders.window.vertex );
+   gl_useProgram(0);
+   gl_checkErr();
 
    /*
     * render window name
@@ -1584,11 +1622,113 @@ void toolkit_drawScrollbar( int x, int y, int w, int h, double pos )
    toolkit_drawOutline( x+1, sy, w-2, 30., 0., toolkit_colDark, NULL );
 }
 
+/**
+ * @brief Marks the toolkit as needing a re-render.
+ *
+ * Called whenever window or widget state changes; idle frames composite
+ * the windows from a cached framebuffer instead of re-rasterizing them.
+ */
+void toolkit_rerender (void)
+{
+   toolkit_needsRender = 1;
+}
+
+/**
+ * @brief Whether all open windows can be rendered from the cache.
+ *
+ * Fading windows and custom widgets draw differently every frame, so
+ * their windows can not be cached.
+ */
+static int toolkit_isStatic (void)
+{
+   for (Window *w = windows; w!=NULL; w = w->next) {
+      if (window_isFlag(w, WINDOW_KILL))
+         continue;
+      if (window_isFlag(w, WINDOW_FADEIN | WINDOW_FADEOUT))
+         return 0;
+      for (Widget *wgt=w->widgets; wgt!=NULL; wgt=wgt->next)
+         if ((wgt->type == WIDGET_CUST) && !wgt_isFlag(wgt, WGT_FLAG_KILL))
+            return 0;
+   }
+   return 1;
+}
+
+/**
+ * @brief Composites a full-screen texture onto the current framebuffer.
+ */
+void toolkit_renderFBOTex( GLuint tex, double alpha )
+{
+   const glColour col = { 1., 1., 1., alpha };
+   const mat4 ortho = mat4_ortho(0., 1., 0., 1., 1., -1.);
+   const mat4 I = mat4_identity();
+
+   gl_useProgram(shaders.texture.program);
+
+   glActiveTexture( GL_TEXTURE0 );
+   glBindTexture( GL_TEXTURE_2D, tex );
+   glUniform1i(shaders.texture.sampler, 0);
+
+   glEnableVertexAttribArray( shaders.texture.vertex );
+   gl_vboActivateAttribOffset( gl_squareVBO, shaders.texture.vertex,
+         0, 2, GL_FLOAT, 0 );
+
+   gl_uniformColor(shaders.texture.color, &col);
+   gl_uniformMat4(shaders.texture.projection, &ortho);
+   gl_uniformMat4(shaders.texture.tex_mat, &I);
+
+   glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+
+   glDisableVertexAttribArray( shaders.texture.vertex );
+   gl_checkErr();
+   gl_useProgram(0);
+}
+
 /**
  * @brief Renders the windows.
  */
 void toolkit_render( double dt )
 {
+   /* When nothing animates, composite from the cache and only
+    * re-rasterize the windows when something marked them dirty. */
+   if (toolkit_isStatic()) {
+      if (toolkit_needsRender || (toolkit_cacheW != gl_screen.rw) ||
+            (toolkit_cacheH != gl_screen.rh)) {
+         /* (Re)create the cache at the current resolution. */
+         if ((toolkit_cacheFBO == GL_INVALID_VALUE) ||
+               (toolkit_cacheW != gl_screen.rw) || (toolkit_cacheH != gl_screen.rh)) {
+            if (toolkit_cacheFBO != GL_INVALID_VALUE) {
+               glDeleteFramebuffers( 1, &toolkit_cacheFBO );
+               glDeleteTextures( 1, &toolkit_cacheTex );
+            }
+            gl_fboCreate( &toolkit_cacheFBO, &toolkit_cacheTex, gl_screen.rw, gl_screen.rh );
+            toolkit_cacheW = gl_screen.rw;
+            toolkit_cacheH = gl_screen.rh;
+         }
+
+         glBindFramebuffer( GL_FRAMEBUFFER, toolkit_cacheFBO );
+         glClearColor( 0., 0., 0., 0. );
+         glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+         for (Window *w = windows; w!=NULL; w = w->next) {
+            if (window_isFlag(w, WINDOW_NORENDER | WINDOW_KILL))
+               continue;
+            window_render(w);
+         }
+         glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+         glClearColor( 0., 0., 0., 1. );
+         toolkit_needsRender = 0;
+      }
+
+      /* Blit the cache; overlays (tooltips and the likes) track the
+       * mouse so they stay live. */
+      toolkit_renderFBOTex( toolkit_cacheTex, 1. );
+      for (Window *w = windows; w!=NULL; w = w->next) {
+         if (window_isFlag(w, WINDOW_NORENDER | WINDOW_KILL))
+            continue;
+         window_renderOverlay(w);
+      }
+      return;
+   }
+
    /* Render base. */
    for (Window *w = windows; w!=NULL; w = w->next) {
       if (window_isFlag(w, WINDOW_NORENDER | WINDOW_KILL))
@@ -1631,37 +1771,9 @@ void toolkit_render( double dt )
          continue;
 
       /* Must draw onto the main screen. */
-      glColour col = { 1., 1., 1., alpha };
-
       glBindFramebuffer(GL_FRAMEBUFFER, gl_screen.current_fbo);
       glClearColor( 0., 0., 0., 1. );
-
-      glUseProgram(shaders.texture.program);
-
-      /* Set texture. */
-      glActiveTexture( GL_TEXTURE0 );
-      glBindTexture( GL_TEXTURE_2D, gl_screen.fbo_tex[2] );
-      glUniform1i(shaders.texture.sampler, 0);
-
-      /* Set vertex data. */
-      glEnableVertexAttribArray( shaders.texture.vertex );
-      gl_vboActivateAttribOffset( gl_squareVBO, shaders.texture.vertex,
-            0, 2, GL_FLOAT, 0 );
-
-      /* Set shader uniforms. */
-      gl_uniformColor(shaders.texture.color, &col);
-      const mat4 ortho = mat4_ortho(0., 1., 0., 1., 1., -1.);
-      const mat4 I = mat4_identity();
-      gl_uniformMat4(shaders.texture.projection, &ortho);
-      gl_uniformMat4(shaders.texture.tex_mat, &I);
-
-      /* Draw. */
-      glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
-
-      /* Clean up. */
-      glDisableVertexAttribArray( shaders.texture.vertex );
-      gl_checkErr();
-      glUseProgram(0);
+      toolkit_renderFBOTex( gl_screen.fbo_tex[2], alpha );
    }
 }
 
@@ -1689,6 +1801,9 @@ int toolkit_inputWindow( Window *wdw, SDL_Event *event, int purge )
 {
    int ret;
 
+   /* Any input can change hover/press/focus state. */
+   toolkit_rerender();
+
    /* See if widget needs event. */
    for (Widget *wgt=wdw->widgets; wgt!=NULL; wgt=wgt->next) {
       if (wgt_isFlag( wgt, WGT_FLAG_RAWINPUT )) {
@@ -2378,6 +2493,7 @@ void toolkit_focusWidget( Window *wdw, Widget *wgt )
 
    wdw->focus = wgt->id;
    wgt_setFlag( wgt, WGT_FLAG_FOCUSED );
+   toolkit_rerender();
    if (wgt->focusGain != NULL)
       wgt->focusGain( wgt );
 }
@@ -2393,6 +2509,7 @@ void toolkit_defocusWidget( Window *wdw, Widget *wgt )
 
    wdw->focus = -1;
    wgt_rmFlag( wgt, WGT_FLAG_FOCUSED );
+   toolkit_rerender();
    if (wgt->focusLose != NULL)
       wgt->focusLose( wgt );
 }
@@ -2581,6 +2698,7 @@ void window_lower( unsigned int wid )
  */
 void toolkit_reposition (void)
 {
+   toolkit_rerender();
    for (Window *w = windows; w != NULL; w = w->next) {
       int xorig, yorig, xdiff, ydiff;
 
@@ -2662,4 +2780,13 @@ void toolkit_exit (void)
    /* Free the VBO. */
    gl_vboDestroy( toolkit_vbo );
    toolkit_vbo = NULL;
+
+   /* Free the window cache. */
+   if (toolkit_cacheFBO != GL_INVALID_VALUE) {
+      glDeleteFramebuffers( 1, &toolkit_cacheFBO );
+      glDeleteTextures( 1, &toolkit_cacheTex );
+      toolkit_cacheFBO = GL_INVALID_VALUE;
+      toolkit_cacheTex = GL_INVALID_VALUE;
+      toolkit_cacheW = toolkit_cacheH = 0;
+   }
 }
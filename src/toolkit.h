@@ -83,6 +83,8 @@ void* window_getData( unsigned int wid );
  * render
  */
 void toolkit_render( double dt );
+void toolkit_rerender (void);
+void toolkit_renderFBOTex( GLuint tex, double alpha );
 
 /*
  * input
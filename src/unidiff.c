@@ -22,6 +22,7 @@
 #include "array.h"
 #include "economy.h"
 #include "log.h"
+#include "map.h"
 #include "map_overlay.h"
 #include "ndata.h"
 #include "nstring.h"
@@ -1784,9 +1785,14 @@ static int diff_checkUpdateUniverse (void)
    space_reconstructPresences();
    safelanes_recalculate();
 
-   /* Re-compute the economy. */
+   /* The map may be showing stale systems or jumps. */
+   map_cacheInvalidate();
+
+   /* Re-compute the economy. Prices are just invalidated here and
+    * recomputed on the next query, so a burst of applied diffs does
+    * not redo the whole universe each time. */
    economy_execQueued();
-   economy_initialiseCommodityPrices();
+   economy_invalidatePrices();
 
    /* Have to update planet graphics if necessary. */
    if (cur_system != NULL) {
@@ -1822,3 +1828,13 @@ void unidiff_universeDefer( int enable )
    if (defer && !enable)
       diff_checkUpdateUniverse();
 }
+
+/**
+ * @brief Gets whether or not universe change stuff is being deferred.
+ *
+ *    @return Whether or not deferring is enabled.
+ */
+int unidiff_universeDeferred (void)
+{
+   return diff_universe_defer;
+}
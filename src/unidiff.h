@@ -12,3 +12,4 @@ void diff_clear (void);
 void diff_free (void);
 NONNULL( 1 ) int diff_isApplied( const char *name );
 void unidiff_universeDefer( int enable );
+int unidiff_universeDeferred (void);
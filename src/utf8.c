@@ -32,6 +32,13 @@ static const uint32_t offsetsFromUTF8[6] = {
     0x03C82080UL, 0xFA082080UL, 0x82082080UL
 };
 
+/* Word-at-a-time helpers for skipping runs of ASCII (the bulk of game
+   text). An aligned word load never crosses a page boundary, so scanning
+   past a terminator within the word is safe. */
+#define U8_WORD_ONES    ((size_t)-1 / 0xFF)
+#define U8_WORD_HIGHS   (U8_WORD_ONES * 0x80)
+#define U8_WORD_HASZERO(x) (((x) - U8_WORD_ONES) & ~(x) & U8_WORD_HIGHS)
+
 static const char trailingBytesForUTF8[256] = {
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -231,6 +238,12 @@ size_t u8_strlen(const char *s)
 
     while (1) {
         lasti = i;
+        while (((uintptr_t)(s+i) % sizeof(size_t)) && s[i] > 0)
+            i++;
+        if (!((uintptr_t)(s+i) % sizeof(size_t)))
+            while (!(U8_WORD_HASZERO(*(const size_t*)(s+i))
+                        || (*(const size_t*)(s+i) & U8_WORD_HIGHS)))
+                i += sizeof(size_t);
         while (s[i] > 0)
             i++;
         count += (i-lasti);
@@ -247,6 +260,15 @@ uint32_t u8_nextchar(const char *s, size_t *i)
     uint32_t ch = 0;
     size_t sz = 0;
 
+    /* ASCII fast path; the overwhelming majority of rendered text. */
+    ch = (unsigned char)s[*i];
+    if (ch < 0x80) {
+        if (ch != 0)
+            (*i)++;
+        return ch;
+    }
+    ch = 0;
+
     do {
         ch <<= 6;
         ch += (unsigned char)s[(*i)];
@@ -263,6 +285,14 @@ uint32_t u8_nextmemchar(const char *s, size_t *i)
     uint32_t ch = 0;
     size_t sz = 0;
 
+    /* ASCII fast path. */
+    ch = (unsigned char)s[*i];
+    if (ch < 0x80) {
+        (*i)++;
+        return ch;
+    }
+    ch = 0;
+
     do {
         ch <<= 6;
         ch += (unsigned char)s[(*i)++];
@@ -464,8 +494,15 @@ int u8_isvalid(const char *str, size_t length)
 
     for (p = (unsigned char*)str; p < pend; p++) {
         c = *p;
-        if (c < 128)
+        if (c < 128) {
+            /* Chunked ASCII fast path: once the next byte is aligned, skip
+               whole words with no high bit set. */
+            if (((uintptr_t)(p+1) % sizeof(size_t)) == 0)
+                while ((p+1 + sizeof(size_t) <= pend)
+                        && !(*(const size_t*)(p+1) & U8_WORD_HIGHS))
+                    p += sizeof(size_t);
             continue;
+        }
         ret = 2; /* non-ASCII UTF-8 */
         if ((c & 0xc0) != 0xc0)
             return 0;
@@ -30,6 +30,7 @@
 #include "nlua_vec2.h"
 #include "opengl.h"
 #include "pilot.h"
+#include "pilot_grid.h"
 #include "player.h"
 #include "rng.h"
 #include "spfx.h"
@@ -47,10 +48,55 @@ typedef enum WeaponStatus_ {
 
 /* Weapon flags. */
 #define WEAPON_FLAG_DESTROYED    1
+#define WEAPON_FLAG_LOD          2 /**< Far from everything; integrates on coarse ticks. */
 #define weapon_isFlag(w,f)    ((w)->flags & (f))
 #define weapon_setFlag(w,f)   ((w)->flags |= (f))
 #define weapon_rmFlag(w,f)    ((w)->flags &= ~(f))
 
+/*
+ * Projectile LOD: weapons far from both the camera and any pilot coalesce
+ * frames and integrate on coarse ticks so off-screen NPC fights don't cost
+ * full collision testing per projectile per frame.
+ */
+#define WEAPON_LOD_DIST    3000.    /**< Distance from the camera beyond which projectiles may throttle. */
+#define WEAPON_LOD_STEP    (1./10.) /**< Coarse integration tick for throttled projectiles. */
+#define WEAPON_LOD_WAKE    1000.    /**< Extra pilot-proximity margin that forces full fidelity. */
+
+/*
+ * Beam collision caching: beams test the same line against the same (often
+ * capital-ship sized) polygons every frame for their whole duration. Results
+ * are keyed on the quantized beam-to-target offset, beam direction and target
+ * sprite, and only recomputed when one of those moves past its quantum.
+ * Collision points are stored relative to the target so the pair drifting in
+ * formation still hits the cache.
+ */
+#define BEAM_CACHE_SIZE    4           /**< Cached target results per beam. */
+#define BEAM_CACHE_QPOS    3.          /**< Position quantum in units. */
+#define BEAM_CACHE_QDIR    (M_PI/512.) /**< Direction quantum in radians. */
+
+/**
+ * @brief Cached beam-vs-pilot collision result.
+ */
+typedef struct BeamColl_ {
+   unsigned int target; /**< Pilot the result is for, 0 if the slot is free. */
+   int qx;        /**< Quantized beam-to-target X offset. */
+   int qy;        /**< Quantized beam-to-target Y offset. */
+   int qdir;      /**< Quantized beam direction. */
+   int sx;        /**< Target sprite tested against. */
+   int sy;        /**< Target sprite tested against. */
+   unsigned int coll; /**< Cached collision result. */
+   vec2 crash[2]; /**< Collision points, relative to the target. */
+} BeamColl;
+
+/*
+ * Seeker shared-target caching: missile-boat volleys put 100+ seekers on
+ * the same pilot, and each one resolved the target id with pilot_get()
+ * every frame. The last resolution is memoized for the frame, so a volley
+ * chasing one capital collapses to a single lookup, and jam rolls are
+ * staggered on a coarse per-missile phase instead of every frame.
+ */
+#define WEAPON_JAM_INTERVAL 0.25 /**< Seconds between seeker jam checks. */
+
 /**
  * @struct Weapon
  *
@@ -76,6 +122,7 @@ typedef struct Weapon_ {
    double timer; /**< mainly used to see when the weapon was fired */
    double anim; /**< Used for beam weapon graphics and others. */
    GLfloat r; /**< Unique random value . */
+   double jam_timer; /**< Time until the next jam check (seekers). */
    int sprite; /**< Used for spinning outfits. */
    PilotOutfitSlot *mount; /**< Used for beam weapons. */
    int lua_mem; /**< Mem table, in case of a Pilot Outfit. */
@@ -84,9 +131,12 @@ typedef struct Weapon_ {
    int sx; /**< Current X sprite to use. */
    int sy; /**< Current Y sprite to use. */
    Trail_spfx *trail; /**< Trail graphic if applicable, else NULL. */
+   double lod_dt; /**< Time coalesced since the last full update (LOD throttling). */
+   BeamColl bcache[BEAM_CACHE_SIZE]; /**< Beam collision cache. */
+   int bcache_idx; /**< Next beam cache slot to evict. */
 
    /* position update and render */
-   void (*update)(struct Weapon_*, const double, WeaponLayer); /**< Updates the weapon */
+   void (*tick)(struct Weapon_*, double); /**< Per-type timer/decay update. */
    void (*think)(struct Weapon_*, const double); /**< for the smart missiles */
 
    WeaponStatus status; /**< Weapon status - to check for jamming */
@@ -95,6 +145,36 @@ typedef struct Weapon_ {
 /* Weapon layers. */
 static Weapon** wbackLayer = NULL; /**< behind pilots */
 static Weapon** wfrontLayer = NULL; /**< in front of pilots, behind player */
+/*
+ * Destroyed weapons are kept on a free list and reused by weapon_create,
+ * so steady-state combat does not hit the heap for every shot. The first
+ * bytes of a pooled weapon hold the next link; reuse clears the memory.
+ */
+static Weapon* weapon_pool = NULL; /**< Free list of weapon memory for reuse. */
+
+/**
+ * @brief Accumulated AI attack notification for a (victim, attacker) pair.
+ *
+ * Damage application stays immediate, but the Lua-side notifications are
+ * coalesced so a salvo landing in one frame runs the attacked hooks once
+ * per pair instead of once per bolt.
+ */
+typedef struct WeaponHitAI_ {
+   unsigned int p; /**< ID of the pilot that was hit. */
+   unsigned int shooter; /**< ID of the pilot that shot. */
+   double dmg; /**< Total damage accumulated this frame. */
+} WeaponHitAI;
+static WeaponHitAI *weapon_hitai = NULL; /**< Array (array.h): pending AI notifications. */
+
+/*
+ * Weapons surviving the layer pass have their solids integrated together
+ * afterwards: projectiles are uniform Euler solids, so handing them to
+ * solid_updateBatch in one go lets the math vectorize instead of going
+ * through the per-solid update pointer.
+ */
+static Weapon **weapon_batch       = NULL; /**< Array (array.h): weapons pending integration. */
+static Solid **weapon_batch_solids = NULL; /**< Array (array.h): their solids. */
+static double *weapon_batch_dts    = NULL; /**< Array (array.h): their time steps. */
 
 /* Graphics. */
 static gl_vbo  *weapon_vbo     = NULL; /**< Weapon VBO. */
@@ -123,7 +203,14 @@ static double weapon_computeTimes( double rdir, double rx, double ry, double dvx
 /* Updating. */
 static void weapon_render( Weapon* w, const double dt );
 static void weapons_updateLayer( const double dt, const WeaponLayer layer );
+static void weapon_expire( Weapon *w );
+static void weapon_tickLauncher( Weapon *w, double dt );
+static void weapon_tickBolt( Weapon *w, double dt );
+static void weapon_tickBeam( Weapon *w, double dt );
 static void weapon_update( Weapon* w, const double dt, WeaponLayer layer );
+static void weapon_updateLOD( Weapon* w );
+static void weapon_hitAIBatch( unsigned int p, unsigned int shooter, double dmg );
+static void weapon_hitAIFlush (void);
 static void weapon_sample_trail( Weapon* w );
 /* Destruction. */
 static void weapon_destroy( Weapon* w );
@@ -134,6 +221,9 @@ static void weapon_explodeLayer( WeaponLayer layer,
 static void weapons_purgeLayer( Weapon** layer );
 /* Hitting. */
 static int weapon_checkCanHit( const Weapon* w, const Pilot *p );
+static BeamColl* weapon_beamCacheGet( Weapon *w, const Pilot *p );
+static void weapon_beamCacheStore( Weapon *w, const Pilot *p,
+      unsigned int coll, const vec2 crash[2] );
 static void weapon_hit( Weapon* w, Pilot* p, vec2* pos );
 static void weapon_miss( Weapon *w );
 static void weapon_hitAst( Weapon* w, Asteroid* a, WeaponLayer layer, vec2* pos );
@@ -282,7 +372,7 @@ void weapon_minimap( const double res, const double w,
       gl_vboSubData( weapon_vbo, offset * sizeof(GLfloat),
             sizeof(GLfloat) * 4*p, &weapon_vboData[offset] );
 
-      glUseProgram(shaders.points.program);
+      gl_useProgram(shaders.points.program);
       glEnableVertexAttribArray(shaders.points.vertex);
       glEnableVertexAttribArray(shaders.points.vertex_color);
       gl_uniformMat4(shaders.points.projection, &gl_view_matrix);
@@ -291,7 +381,7 @@ void weapon_minimap( const double res, const double w,
       glDrawArrays( GL_POINTS, 0, p );
       glDisableVertexAttribArray(shaders.points.vertex);
       glDisableVertexAttribArray(shaders.points.vertex_color);
-      glUseProgram(0);
+      gl_useProgram(0);
       gl_checkErr();
    }
 }
@@ -318,6 +408,21 @@ static void weapon_setTurn( Weapon *w, double turn )
  *    @param w Weapon to do the thinking.
  *    @param dt Current delta tick.
  */
+static unsigned int seek_cache_id = 0; /**< Target id of the memoized resolution. */
+static Pilot *seek_cache_p = NULL; /**< Memoized target, only valid within the frame. */
+
+/**
+ * @brief pilot_get() memoized over the current frame for seeker targets.
+ */
+static Pilot *weapon_getTarget( unsigned int id )
+{
+   if (id != seek_cache_id) {
+      seek_cache_id = id;
+      seek_cache_p  = pilot_get( id );
+   }
+   return seek_cache_p;
+}
+
 static void think_seeker( Weapon* w, const double dt )
 {
    double diff;
@@ -328,7 +433,7 @@ static void think_seeker( Weapon* w, const double dt )
    if (w->target == w->parent)
       return; /* no self shooting */
 
-   p = pilot_get(w->target); /* no null pilot */
+   p = weapon_getTarget(w->target); /* no null pilot */
    if (p==NULL) {
       weapon_setThrust( w, 0. );
       weapon_setTurn( w, 0. );
@@ -349,6 +454,11 @@ static void think_seeker( Weapon* w, const double dt )
          break;
 
       case WEAPON_STATUS_OK: /* Check to see if can get jammed */
+         /* Staggered so a whole volley doesn't roll on the same frame. */
+         w->jam_timer -= dt;
+         if (w->jam_timer > 0.)
+            goto seek; /* Still guide in the meantime. */
+         w->jam_timer += WEAPON_JAM_INTERVAL;
          jc = p->stats.jam_chance - w->outfit->u.lau.resist;
          if (jc > 0.) {
             /* Roll based on distance. */
@@ -378,6 +488,7 @@ static void think_seeker( Weapon* w, const double dt )
 
       case WEAPON_STATUS_JAMMED_SLOWED: /* Slowed down. */
       case WEAPON_STATUS_UNJAMMED: /* Work as expected */
+seek:
          /* Smart seekers take into account ship velocity. */
          if (w->outfit->u.lau.ai == AMMO_AI_SMART) {
 
@@ -497,6 +608,7 @@ static void think_beam( Weapon* w, const double dt )
 
    /* Use mount position. */
    pilot_getMount( p, slot, &v );
+   w->solid->pre   = w->solid->pos; /* Beams skip the integrator, keep interpolation working. */
    w->solid->pos.x = p->solid->pos.x + v.x;
    w->solid->pos.y = p->solid->pos.y + v.y;
 
@@ -542,6 +654,10 @@ static void think_beam( Weapon* w, const double dt )
  */
 void weapons_update( const double dt )
 {
+   /* The memoized seeker target must not live past the frame. */
+   seek_cache_id = 0;
+   seek_cache_p  = NULL;
+
    /* When updating, just mark weapons for deletion. */
    weapons_updateLayer(dt,WEAPON_LAYER_BG);
    weapons_updateLayer(dt,WEAPON_LAYER_FG);
@@ -549,6 +665,89 @@ void weapons_update( const double dt )
    /* Actually purge and remove weapons. */
    weapons_purgeLayer( wbackLayer );
    weapons_purgeLayer( wfrontLayer );
+
+   /* Run the coalesced AI attack notifications now that collisions are
+    * fully resolved. */
+   weapon_hitAIFlush();
+}
+
+/**
+ * @brief Expires a projectile whose life ran out, with its death sprite
+ *        and sound when the outfit has them.
+ */
+static void weapon_expire( Weapon *w )
+{
+   int spfx = -1;
+   /* See if we need armour death sprite. */
+   if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR))
+      spfx = outfit_spfxArmour(w->outfit);
+   /* See if we need shield death sprite. */
+   else if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_SHIELD))
+      spfx = outfit_spfxShield(w->outfit);
+   /* Add death sprite if needed. */
+   if (spfx != -1) {
+      int s;
+      spfx_add( spfx, w->solid->pos.x, w->solid->pos.y,
+            w->solid->vel.x, w->solid->vel.y,
+            SPFX_LAYER_MIDDLE ); /* presume middle. */
+      /* Add sound if explodes and has it. */
+      s = outfit_soundHit(w->outfit);
+      if (s != -1)
+         w->voice = sound_playPos(s,
+               w->solid->pos.x,
+               w->solid->pos.y,
+               w->solid->vel.x,
+               w->solid->vel.y);
+   }
+   weapon_miss(w);
+}
+
+/**
+ * @brief Timer update for launcher ammo.
+ */
+static void weapon_tickLauncher( Weapon *w, double dt )
+{
+   w->timer -= dt;
+   if (w->timer < 0.)
+      weapon_expire( w );
+}
+
+/**
+ * @brief Timer and falloff update for bolts.
+ */
+static void weapon_tickBolt( Weapon *w, double dt )
+{
+   w->timer -= dt;
+   if (w->timer < 0.)
+      weapon_expire( w );
+   else if (w->timer < w->falloff)
+      w->strength = w->timer / w->falloff;
+}
+
+/**
+ * @brief Duration and explosion-timer update for beams.
+ */
+static void weapon_tickBeam( Weapon *w, double dt )
+{
+   /* Beams don't have inherent accuracy, so we use the
+    * heatAccuracyMod to modulate duration. */
+   w->timer -= dt / (1.-pilot_heatAccuracyMod(w->mount->heat_T));
+   if (w->timer < 0. || (w->outfit->u.bem.min_duration > 0. &&
+         w->mount->stimer < 0.)) {
+      Pilot *p = pilot_get(w->parent);
+      if (p != NULL)
+         pilot_stopBeam(p, w->mount);
+      weapon_miss(w);
+      return;
+   }
+   /* We use the explosion timer to tell when we have to create explosions. */
+   w->timer2 -= dt;
+   if (w->timer2 < 0.) {
+      if (w->timer2 < -1.)
+         w->timer2 = 0.100;
+      else
+         w->timer2 = -1.;
+   }
 }
 
 /**
@@ -560,6 +759,7 @@ void weapons_update( const double dt )
 static void weapons_updateLayer( const double dt, const WeaponLayer layer )
 {
    Weapon **wlayer;
+   double cx, cy;
 
    /* Choose layer. */
    switch (layer) {
@@ -575,6 +775,12 @@ static void weapons_updateLayer( const double dt, const WeaponLayer layer )
          return;
    }
 
+   if (weapon_batch == NULL) {
+      weapon_batch        = array_create( Weapon* );
+      weapon_batch_solids = array_create( Solid* );
+      weapon_batch_dts    = array_create( double );
+   }
+
    for (int i=0; i<array_size(wlayer); i++) {
       Weapon *w = wlayer[i];
 
@@ -582,107 +788,96 @@ static void weapons_updateLayer( const double dt, const WeaponLayer layer )
       if (weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
          continue;
 
-      /* Handle types. */
-      switch (w->outfit->type) {
-
-         /* most missiles behave the same */
-         case OUTFIT_TYPE_LAUNCHER:
-         case OUTFIT_TYPE_TURRET_LAUNCHER:
-            w->timer -= dt;
-            if (w->timer < 0.) {
-               int spfx = -1;
-               /* See if we need armour death sprite. */
-               if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR))
-                  spfx = outfit_spfxArmour(w->outfit);
-               /* See if we need shield death sprite. */
-               else if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_SHIELD))
-                  spfx = outfit_spfxShield(w->outfit);
-               /* Add death sprite if needed. */
-               if (spfx != -1) {
-                  int s;
-                  spfx_add( spfx, w->solid->pos.x, w->solid->pos.y,
-                        w->solid->vel.x, w->solid->vel.y,
-                        SPFX_LAYER_MIDDLE ); /* presume middle. */
-                  /* Add sound if explodes and has it. */
-                  s = outfit_soundHit(w->outfit);
-                  if (s != -1)
-                     w->voice = sound_playPos(s,
-                           w->solid->pos.x,
-                           w->solid->pos.y,
-                           w->solid->vel.x,
-                           w->solid->vel.y);
-               }
-               weapon_miss(w);
-               break;
-            }
-            break;
-
-         case OUTFIT_TYPE_BOLT:
-         case OUTFIT_TYPE_TURRET_BOLT:
-            w->timer -= dt;
-            if (w->timer < 0.) {
-               int spfx = -1;
-               /* See if we need armour death sprite. */
-               if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_ARMOUR))
-                  spfx = outfit_spfxArmour(w->outfit);
-               /* See if we need shield death sprite. */
-               else if (outfit_isProp(w->outfit, OUTFIT_PROP_WEAP_BLOWUP_SHIELD))
-                  spfx = outfit_spfxShield(w->outfit);
-               /* Add death sprite if needed. */
-               if (spfx != -1) {
-                  int s;
-                  spfx_add( spfx, w->solid->pos.x, w->solid->pos.y,
-                        w->solid->vel.x, w->solid->vel.y,
-                        SPFX_LAYER_MIDDLE ); /* presume middle. */
-                  /* Add sound if explodes and has it. */
-                  s = outfit_soundHit(w->outfit);
-                  if (s != -1)
-                     w->voice = sound_playPos(s,
-                           w->solid->pos.x,
-                           w->solid->pos.y,
-                           w->solid->vel.x,
-                           w->solid->vel.y);
-               }
-               weapon_miss(w);
-               break;
-            }
-            else if (w->timer < w->falloff)
-               w->strength = w->timer / w->falloff;
-            break;
-
-         /* Beam weapons handled a part. */
-         case OUTFIT_TYPE_BEAM:
-         case OUTFIT_TYPE_TURRET_BEAM:
-            /* Beams don't have inherent accuracy, so we use the
-             * heatAccuracyMod to modulate duration. */
-            w->timer -= dt / (1.-pilot_heatAccuracyMod(w->mount->heat_T));
-            if (w->timer < 0. || (w->outfit->u.bem.min_duration > 0. &&
-                  w->mount->stimer < 0.)) {
-               Pilot *p = pilot_get(w->parent);
-               if (p != NULL)
-                  pilot_stopBeam(p, w->mount);
-               weapon_miss(w);
-               break;
-            }
-            /* We use the explosion timer to tell when we have to create explosions. */
-            w->timer2 -= dt;
-            if (w->timer2 < 0.) {
-               if (w->timer2 < -1.)
-                  w->timer2 = 0.100;
-               else
-                  w->timer2 = -1.;
-            }
-            break;
-         default:
-            WARN(_("Weapon of type '%s' has no update implemented yet!"),
-                  w->outfit->name);
-            break;
-      }
+      /* Per-type timer/decay update; resolved at creation so the loop
+       * has no type dispatch. */
+      w->tick( w, dt );
 
       /* Only increment if weapon wasn't destroyed. */
-      if (!weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
-         weapon_update(w,dt,layer);
+      if (weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
+         continue;
+
+      /* Anything on or near the screen always runs at full fidelity. */
+      cam_getPos( &cx, &cy );
+      if (pow2( w->solid->pos.x - cx ) + pow2( w->solid->pos.y - cy ) <
+            pow2( WEAPON_LOD_DIST ))
+         weapon_rmFlag( w, WEAPON_FLAG_LOD );
+
+      if (weapon_isFlag(w, WEAPON_FLAG_LOD)) {
+         /* Throttled: coalesce frames and integrate on the coarse tick.
+          * The wake margin guarantees nothing can close to collision
+          * range in between, so no hit is ever missed while sleeping. */
+         double wdt;
+         w->lod_dt += dt;
+         if (w->lod_dt < WEAPON_LOD_STEP)
+            continue;
+         wdt = w->lod_dt;
+         weapon_update( w, wdt, layer );
+         w->lod_dt = 0.;
+         if (!weapon_isFlag(w, WEAPON_FLAG_DESTROYED)) {
+            weapon_updateLOD( w );
+            array_push_back( &weapon_batch, w );
+            array_push_back( &weapon_batch_solids, w->solid );
+            array_push_back( &weapon_batch_dts, wdt );
+         }
+      }
+      else {
+         weapon_update( w, dt, layer );
+         /* Re-evaluate throttling at the coarse rate; the check costs a
+          * grid query so it is not worth doing per frame. */
+         w->lod_dt += dt;
+         if (w->lod_dt >= WEAPON_LOD_STEP) {
+            w->lod_dt = 0.;
+            if (!weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
+               weapon_updateLOD( w );
+         }
+         if (!weapon_isFlag(w, WEAPON_FLAG_DESTROYED)) {
+            array_push_back( &weapon_batch, w );
+            array_push_back( &weapon_batch_solids, w->solid );
+            array_push_back( &weapon_batch_dts, dt );
+         }
+      }
    }
+
+   /* Integrate the survivors together, then run the bookkeeping that
+    * needs the new positions. */
+   solid_updateBatch( weapon_batch_solids, weapon_batch_dts,
+         array_size(weapon_batch) );
+   for (int i=0; i<array_size(weapon_batch); i++) {
+      Weapon *w = weapon_batch[i];
+      sound_updatePos( w->voice, w->solid->pos.x, w->solid->pos.y,
+            w->solid->vel.x, w->solid->vel.y );
+      if (w->trail != NULL)
+         weapon_sample_trail( w );
+   }
+   array_resize( &weapon_batch, 0 );
+   array_resize( &weapon_batch_solids, 0 );
+   array_resize( &weapon_batch_dts, 0 );
+}
+
+/**
+ * @brief Re-evaluates whether a distant projectile can run throttled.
+ *
+ * A projectile only sleeps while no pilot can possibly reach collision
+ * range before the next coarse tick: the wake radius covers the distance
+ * the projectile itself travels in a tick plus a generous margin for the
+ * other party, so throttling is conservative.
+ *
+ *    @param w Weapon to re-evaluate.
+ */
+static void weapon_updateLOD( Weapon* w )
+{
+   Pilot *const* candidates;
+
+   /* Beams are anchored to their mount and always run at full rate. */
+   if (outfit_isBeam(w->outfit))
+      return;
+
+   candidates = pilotgrid_queryCircle( &w->solid->pos,
+         WEAPON_LOD_WAKE + VMOD( w->solid->vel ) * WEAPON_LOD_STEP );
+   if (array_size(candidates) == 0)
+      weapon_setFlag( w, WEAPON_FLAG_LOD );
+   else
+      weapon_rmFlag( w, WEAPON_FLAG_LOD );
 }
 
 /**
@@ -692,13 +887,18 @@ static void weapons_updateLayer( const double dt, const WeaponLayer layer )
  */
 static void weapons_purgeLayer( Weapon** layer )
 {
+   int n = 0;
+
+   /* Single compaction pass: freeing k weapons out of n moves each
+    * survivor at most once, instead of memmoving the tail per erase. */
    for (int i=0; i<array_size(layer); i++) {
       if (weapon_isFlag(layer[i],WEAPON_FLAG_DESTROYED)) {
          weapon_free(layer[i]);
-         array_erase( &layer, &layer[i], &layer[i+1] );
-         i--;
+         continue;
       }
+      layer[n++] = layer[i];
    }
+   array_resize( &layer, n );
 }
 
 /**
@@ -726,24 +926,28 @@ void weapons_render( const WeaponLayer layer, const double dt )
 
    for (int i=0; i<array_size(wlayer); i++)
       weapon_render( wlayer[i], dt );
+
+   /* Submit whatever quads are still queued. */
+   gl_renderSpriteBatchFlush();
 }
 
 static void weapon_renderBeam( Weapon* w, const double dt )
 {
-   double x, y, z;
+   double x, y, z, rx, ry;
    mat4 projection;
 
    /* Animation. */
    w->anim += dt;
 
    /* Load GLSL program */
-   glUseProgram(shaders.beam.program);
+   gl_useProgram(shaders.beam.program);
 
    /* Zoom. */
    z = cam_getZoom();
 
    /* Position. */
-   gl_gameToScreenCoords( &x, &y, w->solid->pos.x, w->solid->pos.y );
+   solid_renderPos( w->solid, &rx, &ry );
+   gl_gameToScreenCoords( &x, &y, rx, ry );
 
    projection = gl_view_matrix;
    mat4_translate( &projection, x, y, 0. );
@@ -772,7 +976,7 @@ static void weapon_renderBeam( Weapon* w, const double dt )
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.beam.vertex );
-   glUseProgram(0);
+   gl_useProgram(0);
 
    /* anything failed? */
    gl_checkErr();
@@ -787,28 +991,31 @@ static void weapon_renderBeam( Weapon* w, const double dt )
 static void weapon_render( Weapon* w, const double dt )
 {
    const glTexture *gfx;
-   double x, y, z, r, st;
+   double x, y, z, r, st, rx, ry;
    glColour col, c = { .r=1., .g=1., .b=1. };
 
    /* Don't render destroyed weapons. */
    if (weapon_isFlag(w,WEAPON_FLAG_DESTROYED))
       return;
 
+   solid_renderPos( w->solid, &rx, &ry );
+
    switch (w->outfit->type) {
       /* Weapons that use sprites. */
       case OUTFIT_TYPE_LAUNCHER:
       case OUTFIT_TYPE_TURRET_LAUNCHER:
          if (w->status == WEAPON_STATUS_LOCKING) {
             z = cam_getZoom();
-            gl_gameToScreenCoords( &x, &y, w->solid->pos.x, w->solid->pos.y );
+            gl_gameToScreenCoords( &x, &y, rx, ry );
             gfx = outfit_gfx(w->outfit);
             r = gfx->sw * z * 0.75; /* Assume square. */
 
             st = 1. - w->timer2 / w->paramf;
-            col_blend( &col, &cYellow, &cRed, st );
+            col   = *col_ramp( cRampRedYellow, st );
             col.a = 0.5;
 
-            glUseProgram( shaders.iflockon.program );
+            gl_renderSpriteBatchFlush();
+            gl_useProgram( shaders.iflockon.program );
             glUniform1f( shaders.iflockon.paramf, st );
             gl_renderShader( x, y, r, r, r, &shaders.iflockon, &col, 1 );
          }
@@ -834,29 +1041,34 @@ static void weapon_render( Weapon* w, const double dt )
             }
 
             /* Render. */
-            if (outfit_isBolt(w->outfit) && w->outfit->u.blt.gfx_end)
+            if (outfit_isBolt(w->outfit) && w->outfit->u.blt.gfx_end) {
+               gl_renderSpriteBatchFlush();
                gl_renderSpriteInterpolate( gfx, w->outfit->u.blt.gfx_end,
                      w->timer / w->life,
-                     w->solid->pos.x, w->solid->pos.y,
+                     rx, ry,
                      w->sprite % (int)gfx->sx, w->sprite / (int)gfx->sx, &c );
+            }
             else
-               gl_renderSprite( gfx, w->solid->pos.x, w->solid->pos.y,
+               gl_renderSpriteBatch( gfx, rx, ry,
                      w->sprite % (int)gfx->sx, w->sprite / (int)gfx->sx, &c );
          }
          /* Outfit faces direction. */
          else {
-            if (outfit_isBolt(w->outfit) && w->outfit->u.blt.gfx_end)
+            if (outfit_isBolt(w->outfit) && w->outfit->u.blt.gfx_end) {
+               gl_renderSpriteBatchFlush();
                gl_renderSpriteInterpolate( gfx, w->outfit->u.blt.gfx_end,
                      w->timer / w->life,
-                     w->solid->pos.x, w->solid->pos.y, w->sx, w->sy, &c );
+                     rx, ry, w->sx, w->sy, &c );
+            }
             else
-               gl_renderSprite( gfx, w->solid->pos.x, w->solid->pos.y, w->sx, w->sy, &c );
+               gl_renderSpriteBatch( gfx, rx, ry, w->sx, w->sy, &c );
          }
          break;
 
       /* Beam weapons. */
       case OUTFIT_TYPE_BEAM:
       case OUTFIT_TYPE_TURRET_BEAM:
+         gl_renderSpriteBatchFlush();
          weapon_renderBeam(w, dt);
          break;
 
@@ -936,6 +1148,76 @@ static int weapon_checkCanHit( const Weapon* w, const Pilot *p )
    return 0;
 }
 
+/**
+ * @brief Looks up a cached beam collision result that is still valid.
+ *
+ *    @param w Beam weapon doing the testing.
+ *    @param p Pilot being tested against.
+ *    @return The valid cache entry, or NULL if it must be recomputed.
+ */
+static BeamColl* weapon_beamCacheGet( Weapon *w, const Pilot *p )
+{
+   int qx, qy, qdir;
+
+   qx   = (int)floor( (p->solid->pos.x - w->solid->pos.x) / BEAM_CACHE_QPOS );
+   qy   = (int)floor( (p->solid->pos.y - w->solid->pos.y) / BEAM_CACHE_QPOS );
+   qdir = (int)floor( w->solid->dir / BEAM_CACHE_QDIR );
+
+   for (int i=0; i<BEAM_CACHE_SIZE; i++) {
+      BeamColl *bc = &w->bcache[i];
+      if (bc->target != p->id)
+         continue;
+      if ((bc->qx == qx) && (bc->qy == qy) && (bc->qdir == qdir) &&
+            (bc->sx == p->tsx) && (bc->sy == p->tsy))
+         return bc;
+      /* Stale; the caller recomputes and overwrites this slot. */
+      return NULL;
+   }
+   return NULL;
+}
+
+/**
+ * @brief Stores a beam collision result in the beam's cache.
+ *
+ *    @param w Beam weapon that did the testing.
+ *    @param p Pilot that was tested against.
+ *    @param coll Whether there was a collision.
+ *    @param crash Collision points if there was a collision.
+ */
+static void weapon_beamCacheStore( Weapon *w, const Pilot *p,
+      unsigned int coll, const vec2 crash[2] )
+{
+   BeamColl *bc = NULL;
+
+   /* Prefer the target's existing slot, then a free one, else round-robin. */
+   for (int i=0; i<BEAM_CACHE_SIZE; i++) {
+      if (w->bcache[i].target == p->id) {
+         bc = &w->bcache[i];
+         break;
+      }
+      if ((bc == NULL) && (w->bcache[i].target == 0))
+         bc = &w->bcache[i];
+   }
+   if (bc == NULL) {
+      bc = &w->bcache[ w->bcache_idx ];
+      w->bcache_idx = (w->bcache_idx + 1) % BEAM_CACHE_SIZE;
+   }
+
+   bc->target = p->id;
+   bc->qx   = (int)floor( (p->solid->pos.x - w->solid->pos.x) / BEAM_CACHE_QPOS );
+   bc->qy   = (int)floor( (p->solid->pos.y - w->solid->pos.y) / BEAM_CACHE_QPOS );
+   bc->qdir = (int)floor( w->solid->dir / BEAM_CACHE_QDIR );
+   bc->sx   = p->tsx;
+   bc->sy   = p->tsy;
+   bc->coll = coll;
+   if (coll) {
+      vec2_csetmin( &bc->crash[0], crash[0].x - p->solid->pos.x,
+            crash[0].y - p->solid->pos.y );
+      vec2_csetmin( &bc->crash[1], crash[1].x - p->solid->pos.x,
+            crash[1].y - p->solid->pos.y );
+   }
+}
+
 /**
  * @brief Updates an individual weapon.
  *
@@ -950,12 +1232,11 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
    const glTexture *gfx;
    const CollPoly *plg, *polygon;
    vec2 crash[2];
-   Pilot *const* pilot_stack;
+   Pilot *const* candidates;
    int isjammed;
 
    gfx = NULL;
    polygon = NULL;
-   pilot_stack = pilot_getAll();
 
    /* Get the sprite direction to speed up calculations. */
    b     = outfit_isBeam(w->outfit);
@@ -992,18 +1273,26 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
       }
    }
 
-   for (int i=0; i<array_size(pilot_stack); i++) {
-      Pilot *p = pilot_stack[i];
+   /* Only test the pilots near the weapon via the spatial hash. */
+   if (b)
+      candidates = pilotgrid_queryLine( &w->solid->pos, w->solid->dir,
+            w->outfit->u.bem.range );
+   else
+      candidates = pilotgrid_queryCircle( &w->solid->pos,
+            MAX( gfx->sw, gfx->sh ) / 2. );
+
+   for (int i=0; i<array_size(candidates); i++) {
+      Pilot *p = candidates[i];
 
       /* Ignore pilots being deleted. */
       if (pilot_isFlag(p, PILOT_DELETE))
          continue;
 
-      if (w->parent == pilot_stack[i]->id)
+      if (w->parent == p->id)
          continue; /* pilot is self */
 
-      psx = pilot_stack[i]->tsx;
-      psy = pilot_stack[i]->tsy;
+      psx = p->tsx;
+      psy = p->tsy;
 
       /* See if the ship has a collision polygon. */
       usePoly = usePolyW;
@@ -1014,16 +1303,29 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
       if (b) {
          /* Check for collision. */
          if (weapon_checkCanHit(w,p)) {
-            if (usePoly) {
-               int k = p->ship->gfx_space->sx * psy + psx;
-               coll = CollideLinePolygon( &w->solid->pos, w->solid->dir,
-                     w->outfit->u.bem.range, &p->ship->polygon[k],
-                     &p->solid->pos, crash);
+            const BeamColl *bc = weapon_beamCacheGet( w, p );
+            if (bc != NULL) {
+               coll = bc->coll;
+               if (coll) {
+                  vec2_csetmin( &crash[0], p->solid->pos.x + bc->crash[0].x,
+                        p->solid->pos.y + bc->crash[0].y );
+                  vec2_csetmin( &crash[1], p->solid->pos.x + bc->crash[1].x,
+                        p->solid->pos.y + bc->crash[1].y );
+               }
             }
             else {
-               coll = CollideLineSprite( &w->solid->pos, w->solid->dir,
-                     w->outfit->u.bem.range, p->ship->gfx_space, psx, psy,
-                     &p->solid->pos, crash);
+               if (usePoly) {
+                  int k = p->ship->gfx_space->sx * psy + psx;
+                  coll = CollideLinePolygon( &w->solid->pos, w->solid->dir,
+                        w->outfit->u.bem.range, &p->ship->polygon[k],
+                        &p->solid->pos, crash);
+               }
+               else {
+                  coll = CollideLineSprite( &w->solid->pos, w->solid->dir,
+                        w->outfit->u.bem.range, p->ship->gfx_space, psx, psy,
+                        &p->solid->pos, crash);
+               }
+               weapon_beamCacheStore( w, p, coll, crash );
             }
             if (coll)
                weapon_hitBeam( w, p, layer, crash, dt );
@@ -1034,7 +1336,7 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
       /* smart weapons only collide with their target */
       else if (weapon_isSmart(w)) {
          isjammed = ((w->status == WEAPON_STATUS_JAMMED) || (w->status == WEAPON_STATUS_JAMMED_SLOWED));
-         if ((((pilot_stack[i]->id == w->target) && !isjammed) || isjammed) &&
+         if ((((p->id == w->target) && !isjammed) || isjammed) &&
                weapon_checkCanHit(w,p) ) {
             if (usePoly) {
                int k = p->ship->gfx_space->sx * psy + psx;
@@ -1074,8 +1376,11 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
       }
    }
 
-   /* Collide with asteroids*/
-   if (outfit_isLauncher(w->outfit)) {
+   /* Collide with asteroids.  Fields a weapon gets close to get armed,
+    * which puts their asteroids into the spatial layer; fields with no
+    * combat near them never register for collision at all. */
+   if (outfit_isLauncher(w->outfit) || outfit_isBolt(w->outfit)) {
+      int near = 0;
       for (int i=0; i<array_size(cur_system->asteroids); i++) {
          AsteroidAnchor *ast = &cur_system->asteroids[i];
 
@@ -1083,36 +1388,18 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
          if (vec2_dist2( &w->solid->pos, &ast->pos ) >
             pow2( ast->radius + ast->margin + gfx->sw/2. ))
             continue;
-
-         for (int j=0; j<ast->nb; j++) {
-            Asteroid *a = &ast->asteroids[j];
-            if (a->state != ASTEROID_FG)
-               continue;
-            if (CollideSprite( gfx, w->sx, w->sy, &w->solid->pos,
-                     a->gfx, 0, 0, &a->pos,
-                     &crash[0] )) {
-               weapon_hitAst( w, a, layer, &crash[0] );
-               return; /* Weapon is destroyed. */
-            }
-         }
+         asteroids_arm( ast );
+         near = 1;
       }
-   }
-   else if (outfit_isBolt(w->outfit)) {
-      for (int i=0; i<array_size(cur_system->asteroids); i++) {
-         AsteroidAnchor *ast = &cur_system->asteroids[i];
-
-         /* Early in-range check. */
-         if (vec2_dist2( &w->solid->pos, &ast->pos ) >
-            pow2( ast->radius + ast->margin + gfx->sw/2. ))
-            continue;
-
-         for (int j=0; j<ast->nb; j++) {
-            Asteroid *a = &ast->asteroids[j];
+      if (near) {
+         Asteroid *const* close = astgrid_queryCircle( &w->solid->pos, gfx->sw/2. );
+         for (int j=0; j<array_size(close); j++) {
+            Asteroid *a = close[j];
             if (a->state != ASTEROID_FG)
-               continue;
+               continue; /* Might have been mined out this frame. */
             if (CollideSprite( gfx, w->sx, w->sy, &w->solid->pos,
                      a->gfx, 0, 0, &a->pos,
-                     &crash[0] ) ) {
+                     &crash[0] )) {
                weapon_hitAst( w, a, layer, &crash[0] );
                return; /* Weapon is destroyed. */
             }
@@ -1120,6 +1407,7 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
       }
    }
    else if (b) { /* Beam */
+      int near = 0;
       for (int i=0; i<array_size(cur_system->asteroids); i++) {
          AsteroidAnchor *ast = &cur_system->asteroids[i];
 
@@ -1127,11 +1415,16 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
          if (vec2_dist2( &w->solid->pos, &ast->pos ) >
             pow2( ast->radius + ast->margin + w->outfit->u.bem.range ))
             continue;
-
-         for (int j=0; j<ast->nb; j++) {
-            Asteroid *a = &ast->asteroids[j];
+         asteroids_arm( ast );
+         near = 1;
+      }
+      if (near) {
+         Asteroid *const* close = astgrid_queryLine( &w->solid->pos,
+               w->solid->dir, w->outfit->u.bem.range );
+         for (int j=0; j<array_size(close); j++) {
+            Asteroid *a = close[j];
             if (a->state != ASTEROID_FG)
-               continue;
+               continue; /* Might have been mined out this frame. */
             if (CollideLineSprite( &w->solid->pos, w->solid->dir,
                      w->outfit->u.bem.range,
                      a->gfx, 0, 0, &a->pos,
@@ -1148,16 +1441,8 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
    if (weapon_isSmart(w))
       (*w->think)(w,dt);
 
-   /* Update the solid position. */
-   (*w->solid->update)(w->solid, dt);
-
-   /* Update the sound. */
-   sound_updatePos(w->voice, w->solid->pos.x, w->solid->pos.y,
-         w->solid->vel.x, w->solid->vel.y);
-
-   /* Update the trail. */
-   if (w->trail != NULL)
-      weapon_sample_trail( w );
+   /* The solid is integrated in a batch with the rest of the layer once
+    * every weapon has had its turn; see weapons_updateLayer. */
 }
 
 /**
@@ -1207,7 +1492,7 @@ void weapon_hitAI( Pilot *p, const Pilot *shooter, double dmg )
       return;
 
    /* Must not be deleting. */
-   if (pilot_isFlag(p, PILOT_DELETE) || pilot_isFlag(p, PILOT_DEAD) || pilot_isFlag( p, PILOT_HIDE ))
+   if (pilot_isAnyFlag(p, PILOT_MASK_NOHIT))
       return;
 
    /* Player is handled differently. */
@@ -1220,12 +1505,70 @@ void weapon_hitAI( Pilot *p, const Pilot *shooter, double dmg )
             (shooter->target==p->id)) {
          /* Inform attacked. */
          pilot_setHostile(p);
-         ai_attacked( p, shooter->id, dmg );
+         weapon_hitAIBatch( p->id, shooter->id, dmg );
       }
    }
    /* Otherwise just inform of being attacked. */
    else
-      ai_attacked( p, shooter->id, dmg );
+      weapon_hitAIBatch( p->id, shooter->id, dmg );
+}
+
+/**
+ * @brief Queues an AI attack notification, merging with a pending one for
+ *        the same (victim, attacker) pair.
+ *
+ *    @param p ID of the pilot being hit.
+ *    @param shooter ID of the pilot that shot.
+ *    @param dmg Damage done this hit.
+ */
+static void weapon_hitAIBatch( unsigned int p, unsigned int shooter, double dmg )
+{
+   WeaponHitAI *hit;
+
+   if (weapon_hitai == NULL)
+      weapon_hitai = array_create( WeaponHitAI );
+
+   for (int i=0; i<array_size(weapon_hitai); i++) {
+      hit = &weapon_hitai[i];
+      if ((hit->p == p) && (hit->shooter == shooter)) {
+         hit->dmg += dmg;
+         return;
+      }
+   }
+
+   hit          = &array_grow( &weapon_hitai );
+   hit->p       = p;
+   hit->shooter = shooter;
+   hit->dmg     = dmg;
+}
+
+/**
+ * @brief Flushes the queued AI attack notifications.
+ *
+ * Run once per frame after collisions are resolved, so the Lua attacked
+ * hooks can not re-enter the collision loop and a salvo costs one
+ * notification per (victim, attacker) pair.
+ */
+static void weapon_hitAIFlush (void)
+{
+   if (weapon_hitai == NULL)
+      return;
+
+   for (int i=0; i<array_size(weapon_hitai); i++) {
+      const WeaponHitAI *hit = &weapon_hitai[i];
+      Pilot *p = pilot_get( hit->p );
+
+      /* Conditions may have changed since the hit landed. */
+      if (p == NULL)
+         continue;
+      if (pilot_isDisabled(p))
+         continue;
+      if (pilot_isAnyFlag(p, PILOT_MASK_NOHIT))
+         continue;
+
+      ai_attacked( p, hit->shooter, hit->dmg );
+   }
+   array_resize( &weapon_hitai, 0 );
 }
 
 /**
@@ -1754,6 +2097,7 @@ static void weapon_createAmmo( Weapon *w, const Outfit* outfit, double T,
 
       w->think = think_seeker; /* AI is the same atm. */
       w->r     = RNGF(); /* Used for jamming. */
+      w->jam_timer = WEAPON_JAM_INTERVAL * w->r; /* Spread the check phase. */
 
       /* If they are seeking a pilot, increment lockon counter. */
       if (pilot_target == NULL)
@@ -1805,7 +2149,13 @@ static Weapon* weapon_create( PilotOutfitSlot *po, double T,
    const Outfit *outfit = po->outfit;
 
    /* Create basic features */
-   w           = calloc( 1, sizeof(Weapon) );
+   if (weapon_pool != NULL) {
+      w           = weapon_pool;
+      weapon_pool = *(Weapon**) w;
+      memset( w, 0, sizeof(Weapon) );
+   }
+   else
+      w        = calloc( 1, sizeof(Weapon) );
    w->dam_mod  = 1.; /* Default of 100% damage. */
    w->dam_as_dis_mod = 0.; /* Default of 0% damage to disable. */
    w->faction  = parent->faction; /* non-changeable */
@@ -1817,7 +2167,6 @@ static Weapon* weapon_create( PilotOutfitSlot *po, double T,
       w->lua_mem = luaL_ref( naevL, LUA_REGISTRYINDEX );
    }
    w->outfit   = outfit; /* non-changeable */
-   w->update   = weapon_update;
    w->strength = 1.;
 
    /* Inform the target. */
@@ -1832,12 +2181,14 @@ static Weapon* weapon_create( PilotOutfitSlot *po, double T,
       /* Bolts treated together */
       case OUTFIT_TYPE_BOLT:
       case OUTFIT_TYPE_TURRET_BOLT:
+         w->tick = weapon_tickBolt;
          weapon_createBolt( w, outfit, T, dir, pos, vel, parent, time );
          break;
 
       /* Beam weapons are treated together. */
       case OUTFIT_TYPE_BEAM:
       case OUTFIT_TYPE_TURRET_BEAM:
+         w->tick = weapon_tickBeam;
          rdir = dir;
          if (outfit->type == OUTFIT_TYPE_TURRET_BEAM) {
             pilot_target = pilot_get(target);
@@ -1880,6 +2231,7 @@ static Weapon* weapon_create( PilotOutfitSlot *po, double T,
       /* Treat seekers together. */
       case OUTFIT_TYPE_LAUNCHER:
       case OUTFIT_TYPE_TURRET_LAUNCHER:
+         w->tick = weapon_tickLauncher;
          weapon_createAmmo( w, outfit, T, dir, pos, vel, parent, time );
          break;
 
@@ -1887,6 +2239,7 @@ static Weapon* weapon_create( PilotOutfitSlot *po, double T,
       default:
          WARN(_("Weapon of type '%s' has no create implemented yet!"),
                w->outfit->name);
+         w->tick  = weapon_tickLauncher; /* Plain life timer. */
          w->solid = solid_create( 1., dir, pos, vel, SOLID_UPDATE_EULER );
          break;
    }
@@ -2110,12 +2463,22 @@ static void weapon_free( Weapon* w )
    memset(w, 0, sizeof(Weapon));
 #endif /* DEBUGGING */
 
-   free(w);
+   /* Return the memory to the pool for the next shot. */
+   *(Weapon**) w = weapon_pool;
+   weapon_pool   = w;
 }
 
 /**
  * @brief Clears all the weapons, does NOT free the layers.
  */
+/**
+ * @brief Gets the number of in-flight weapons across both layers.
+ */
+int weapon_count (void)
+{
+   return array_size(wbackLayer) + array_size(wfrontLayer);
+}
+
 void weapon_clear (void)
 {
    /* Don't forget to stop the sounds. */
@@ -2138,6 +2501,20 @@ void weapon_exit (void)
 {
    weapon_clear();
 
+   /* Drain the reuse pool. */
+   while (weapon_pool != NULL) {
+      Weapon *next = *(Weapon**) weapon_pool;
+      free( weapon_pool );
+      weapon_pool = next;
+   }
+
+   /* Destroy pending AI notifications. */
+   array_free( weapon_hitai );
+   array_free( weapon_batch );
+   array_free( weapon_batch_solids );
+   array_free( weapon_batch_dts );
+   weapon_hitai = NULL;
+
    /* Destroy front layer. */
    array_free(wbackLayer);
 
@@ -48,4 +48,5 @@ void weapons_render( const WeaponLayer layer, const double dt );
  */
 void weapon_init (void);
 void weapon_clear (void);
+int weapon_count (void);
 void weapon_exit (void);
@@ -0,0 +1,218 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file worldsim.c
+ *
+ * @brief Coarse statistical simulation of off-screen systems.
+ *
+ * Simulating other systems with real pilots would be O(pilots) over the
+ *  whole universe; instead the world tier keeps a single scalar per
+ *  (system, faction) pair: a relative strength shift around the static
+ *  presence value. Each in-game period the shift is pulled towards the
+ *  faction's strength in jump-connected systems, pushed down by hostile
+ *  presence sharing the system, and relaxed back towards the baseline.
+ *  The abstract state only materializes into real pilots where the player
+ *  actually is: system_scheduler() scales the presence ceiling it hands
+ *  the faction spawn scripts by worldsim_strength().
+ */
+/** @cond */
+#include "naev.h"
+/** @endcond */
+
+#include "worldsim.h"
+
+#include "array.h"
+#include "faction.h"
+
+#define WORLDSIM_TICK      ntime_create( 0, 1, 0 ) /**< One period per simulation tick. */
+#define WORLDSIM_MAX_CATCHUP 32    /**< Ticks to run at once before saturating; a huge
+                                        time skip shouldn't stall on thousands of ticks. */
+#define WORLDSIM_MAX       0.5     /**< Maximum relative strength shift. */
+#define WORLDSIM_SPILL     0.05    /**< Per-tick pull towards neighbouring shifts. */
+#define WORLDSIM_CONFLICT  0.03    /**< Per-tick pressure from in-system hostiles. */
+#define WORLDSIM_DECAY     0.02    /**< Per-tick relaxation back to the baseline. */
+
+/**
+ * @brief Abstract strength of one faction in one system.
+ */
+typedef struct WorldSimPresence_ {
+   int faction;   /**< Faction being tracked. */
+   double shift;  /**< Relative shift in [-WORLDSIM_MAX, +WORLDSIM_MAX]. */
+   double dshift; /**< Shift delta of the current tick (two-pass update). */
+} WorldSimPresence;
+
+/**
+ * @brief Abstract state of one system.
+ */
+typedef struct WorldSimSys_ {
+   WorldSimPresence *fcts; /**< Array (array.h): tracked faction strengths. */
+} WorldSimSys;
+
+static WorldSimSys *worldsim_sys = NULL; /**< Array (array.h): parallel to system_getAll(). */
+static ntime_t worldsim_accum = 0;       /**< Time not yet simulated. */
+
+/*
+ * Prototypes.
+ */
+static void worldsim_init (void);
+static void worldsim_tick (void);
+static const WorldSimPresence *worldsim_get( int sysid, int faction );
+
+/**
+ * @brief Lazily sets up the abstract state from the loaded universe.
+ */
+static void worldsim_init (void)
+{
+   const StarSystem *systems = system_getAll();
+
+   worldsim_sys = array_create_size( WorldSimSys, array_size(systems) );
+   for (int i=0; i<array_size(systems); i++) {
+      const StarSystem *sys = &systems[i];
+      WorldSimSys *ws = &array_grow( &worldsim_sys );
+      ws->fcts = array_create( WorldSimPresence );
+      for (int j=0; j<array_size(sys->presence); j++) {
+         WorldSimPresence wp;
+         if (sys->presence[j].value <= 0.)
+            continue;
+         wp.faction = sys->presence[j].faction;
+         wp.shift   = 0.;
+         wp.dshift  = 0.;
+         array_push_back( &ws->fcts, wp );
+      }
+   }
+}
+
+/**
+ * @brief Gets the tracked entry of a faction in a system, if any.
+ */
+static const WorldSimPresence *worldsim_get( int sysid, int faction )
+{
+   const WorldSimSys *ws;
+   if ((sysid < 0) || (sysid >= array_size(worldsim_sys)))
+      return NULL;
+   ws = &worldsim_sys[sysid];
+   for (int i=0; i<array_size(ws->fcts); i++)
+      if (ws->fcts[i].faction == faction)
+         return &ws->fcts[i];
+   return NULL;
+}
+
+/**
+ * @brief Advances the abstract state by one period.
+ */
+static void worldsim_tick (void)
+{
+   const StarSystem *systems = system_getAll();
+
+   /* First pass computes all deltas from the previous tick's shifts so the
+    * system iteration order doesn't leak into the result. */
+   for (int i=0; i<array_size(worldsim_sys); i++) {
+      const StarSystem *sys = &systems[i];
+      WorldSimSys *ws = &worldsim_sys[i];
+      for (int j=0; j<array_size(ws->fcts); j++) {
+         WorldSimPresence *wp = &ws->fcts[j];
+         double avg, own, hostile;
+         int n;
+
+         /* Pull towards the faction's shift in jump-connected systems:
+          * strength propagates along the jump network over time. */
+         avg = 0.;
+         n   = 0;
+         for (int k=0; k<array_size(sys->jumps); k++) {
+            const WorldSimPresence *o = worldsim_get(
+                  sys->jumps[k].targetid, wp->faction );
+            if (o == NULL)
+               continue; /* No presence there; nothing to propagate. */
+            avg += o->shift;
+            n++;
+         }
+         if (n > 0)
+            avg /= (double)n;
+
+         /* Hostile presence sharing the system grinds strength down,
+          * proportionally to how outmatched the faction is. */
+         own = system_getPresence( sys, wp->faction ) * (1.+wp->shift);
+         hostile = 0.;
+         for (int k=0; k<array_size(ws->fcts); k++) {
+            const WorldSimPresence *o = &ws->fcts[k];
+            if (!areEnemies( wp->faction, o->faction ))
+               continue;
+            hostile += system_getPresence( sys, o->faction ) * (1.+o->shift);
+         }
+
+         wp->dshift = WORLDSIM_SPILL * (avg - wp->shift)
+                    - WORLDSIM_DECAY * wp->shift;
+         if (hostile > 0.)
+            wp->dshift -= WORLDSIM_CONFLICT * hostile / (hostile + own);
+      }
+   }
+
+   /* Second pass applies them. */
+   for (int i=0; i<array_size(worldsim_sys); i++) {
+      WorldSimSys *ws = &worldsim_sys[i];
+      for (int j=0; j<array_size(ws->fcts); j++) {
+         WorldSimPresence *wp = &ws->fcts[j];
+         wp->shift = CLAMP( -WORLDSIM_MAX, WORLDSIM_MAX, wp->shift + wp->dshift );
+      }
+   }
+}
+
+/**
+ * @brief Advances the world simulation with the game time.
+ *
+ * O(systems) per elapsed period, so it just runs inline with the time
+ *  increment like economy_update() does.
+ *
+ *    @param dt Elapsed time in NTIME.
+ */
+void worldsim_update( ntime_t dt )
+{
+   int n;
+
+   if (dt <= 0)
+      return;
+   if (worldsim_sys == NULL)
+      worldsim_init();
+
+   worldsim_accum += dt;
+   n = 0;
+   while (worldsim_accum >= WORLDSIM_TICK) {
+      worldsim_tick();
+      worldsim_accum -= WORLDSIM_TICK;
+      if (++n >= WORLDSIM_MAX_CATCHUP) {
+         worldsim_accum = 0;
+         break;
+      }
+   }
+}
+
+/**
+ * @brief Gets the abstract strength multiplier of a faction in a system.
+ *
+ *    @param sys System to check.
+ *    @param faction Faction to check.
+ *    @return Multiplier to apply to the static presence value.
+ */
+double worldsim_strength( const StarSystem *sys, int faction )
+{
+   const WorldSimPresence *wp;
+   if (worldsim_sys == NULL)
+      return 1.;
+   wp = worldsim_get( sys->id, faction );
+   if (wp == NULL)
+      return 1.;
+   return 1. + wp->shift;
+}
+
+/**
+ * @brief Frees the world simulation state.
+ */
+void worldsim_exit (void)
+{
+   for (int i=0; i<array_size(worldsim_sys); i++)
+      array_free( worldsim_sys[i].fcts );
+   array_free( worldsim_sys );
+   worldsim_sys   = NULL;
+   worldsim_accum = 0;
+}
@@ -0,0 +1,11 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "ntime.h"
+#include "space.h"
+
+void worldsim_update( ntime_t dt );
+double worldsim_strength( const StarSystem *sys, int faction );
+void worldsim_exit (void);
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+
+# Generates a perfect-hash dispatch for the XML tags the data parsers match
+# per node. The xml_isNode() macro chains cost one strcmp per candidate tag
+# per node; parsers converted to switch on xml_tagId() pay one hash and at
+# most one strcmp per node instead. Adding a tag here and regenerating is
+# all that is needed to extend the dispatch.
+
+TAGS = [
+    # Weapon core.
+    "speed",
+    "delay",
+    "energy",
+    "heatup",
+    "warmup",
+    "trackmin",
+    "trackmax",
+    "swivel",
+    "turn",
+    "arc",
+    "range",
+    "falloff",
+    "dispersion",
+    "speed_dispersion",
+    "shots",
+    "damage",
+    "duration",
+    "mining_rarity",
+    # Launcher / ammo.
+    "amount",
+    "reload_time",
+    "lockon",
+    "iflockon",
+    "resist",
+    "thrust",
+    "speed_max",
+    "ammo_mass",
+    "trail_generator",
+    "ai",
+    # Graphics and effects.
+    "gfx",
+    "gfx_end",
+    "shader",
+    "spfx_armour",
+    "spfx_shield",
+    # Sound.
+    "sound",
+    "sound_warmup",
+    "sound_hit",
+    "sound_off",
+    # Misc.
+    "lua",
+    "active",
+]
+
+
+def find_hash(tags):
+    """Searches for parameters making h(tag) injective over all tags."""
+    n = len(tags)
+    for m in range(n, 8 * n):
+        for p1 in range(1, 16):
+            for p2 in range(1, 16):
+                for p3 in range(1, 16):
+                    for p4 in range(1, 16):
+                        seen = {}
+                        for tag in tags:
+                            h = (len(tag) * p1 + ord(tag[0]) * p2
+                                 + ord(tag[1]) * p3
+                                 + ord(tag[-1]) * p4) % m
+                            if h in seen:
+                                break
+                            seen[h] = tag
+                        else:
+                            return m, p1, p2, p3, p4
+    raise RuntimeError("no perfect hash found; add a discriminating term")
+
+
+M, P1, P2, P3, P4 = find_hash(TAGS)
+
+
+def tag_enum(tag):
+    return "XML_TAG_" + tag.upper()
+
+
+def generate_h_file(f):
+    f.write(f"""/* FILE GENERATED BY xmltags_c_gen.py */
+#pragma once
+
+/**
+ * @brief Identifiers for the XML tags known to the perfect-hash dispatch.
+ */
+typedef enum XmlTag_ {{
+   XML_TAG_NONE = 0, /**< Tag is not in the dispatch table. */
+""")
+    for tag in TAGS:
+        f.write(f"   {tag_enum(tag)},\n")
+    f.write("""} XmlTag;
+
+XmlTag xml_tagId( const char *name );
+""")
+
+
+def generate_c_file(f):
+    f.write(f"""/* FILE GENERATED BY xmltags_c_gen.py */
+
+#include <string.h>
+
+#include "xmltags.gen.h"
+
+typedef struct XmlTagEntry_ {{
+   const char *name; /**< Tag name, NULL for empty slots. */
+   XmlTag id;        /**< Corresponding identifier. */
+}} XmlTagEntry;
+
+static const XmlTagEntry xml_tagTable[ {M} ] = {{
+""")
+    slots = {}
+    for tag in TAGS:
+        h = (len(tag) * P1 + ord(tag[0]) * P2 + ord(tag[1]) * P3
+             + ord(tag[-1]) * P4) % M
+        slots[h] = tag
+    for i in range(M):
+        if i in slots:
+            tag = slots[i]
+            f.write(f"   [{i}] = {{ \"{tag}\", {tag_enum(tag)} }},\n")
+    f.write(f"""}};
+
+/**
+ * @brief Maps an XML tag name to its identifier in one hash and at most one
+ *        string comparison.
+ *
+ *    @param name Tag name to look up.
+ *    @return Matching identifier, or XML_TAG_NONE if unknown.
+ */
+XmlTag xml_tagId( const char *name )
+{{
+   const XmlTagEntry *e;
+   size_t len = strlen( name );
+   if (len < 2)
+      return XML_TAG_NONE;
+   e = &xml_tagTable[ (len*{P1}
+         + (unsigned char)name[0]*{P2}
+         + (unsigned char)name[1]*{P3}
+         + (unsigned char)name[len-1]*{P4}) % {M} ];
+   if ((e->name != NULL) && (strcmp( e->name, name )==0))
+      return e->id;
+   return XML_TAG_NONE;
+}}
+""")
+
+
+with open("xmltags.gen.h", "w") as xmltags_gen_h:
+    generate_h_file(xmltags_gen_h)
+
+with open("xmltags.gen.c", "w") as xmltags_gen_c:
+    generate_c_file(xmltags_gen_c)